@@ -69,6 +69,13 @@ public:
 
     std::vector<megamol::core::param::ParamSlot*> EnumerateModuleParameterSlots(std::string const& moduleName) const;
 
+    /**
+     * Answers the newest change epoch (see Module::ChangeEpoch) of the given module and all modules it
+     * (indirectly) pulls data from via its caller slots. If the result did not increase since the module
+     * was last executed, executing it again would produce the same result.
+     */
+    uint64_t UpstreamChangeEpoch(std::string const& moduleName) const;
+
     CallList_t const& ListCalls() const;
 
     ModuleList_t const& ListModules() const;
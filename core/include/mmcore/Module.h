@@ -13,6 +13,9 @@
 
 #include "mmcore/AbstractNamedObjectContainer.h"
 #include "mmcore/api/MegaMolCore.std.h"
+#include "mmcore/utility/TaskScheduler.h"
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -172,6 +175,37 @@ public:
         return this->created;
     }
 
+    /**
+     * Marks the output of this module as changed, so that graph entry points depending on this module get
+     * executed again. Parameter changes do this automatically. Modules whose output changes without a
+     * parameter change, e.g. when data finished loading in the background, need to call this themselves.
+     */
+    void NotifyOutputChanged(void);
+
+    /**
+     * Answers the value of the global change counter at the last change of this module's output.
+     *
+     * @return The change epoch of this module.
+     */
+    inline uint64_t ChangeEpoch(void) const {
+        return this->changeEpoch.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Answers the current value of the global change counter. Every output change of any module increments it.
+     *
+     * @return The current change epoch.
+     */
+    static uint64_t CurrentChangeEpoch(void);
+
+    /**
+     * Answers the account of the task scheduler the CPU time of tasks spawned by this module is charged to.
+     * The core activates it while callbacks of this module run.
+     *
+     * @return The task account of this module.
+     */
+    utility::TaskScheduler::Account* TaskAccount(void);
+
 protected:
     /**
      * Implementation of 'Create'.
@@ -225,6 +259,12 @@ private:
     /** Flag whether this module is created or not */
     bool created;
 
+    /** The value of the global change counter at the last output change */
+    std::atomic<uint64_t> changeEpoch;
+
+    /** The task account of this module, created on first use */
+    std::atomic<utility::TaskScheduler::Account*> taskAccount;
+
     const char* className;
 
     /* Allow the container to access the internal create flag */
@@ -1,11 +1,11 @@
 #pragma once
 
-#include <algorithm>
 #include <array>
 #include <cstdint>
-#include <list>
+#include <limits>
 #include <string>
-#include <vector>
+
+#include "mmcore/utility/StreamingStatistics.h"
 
 namespace megamol {
 namespace core {
@@ -91,13 +91,14 @@ private:
                 reset();
                 curr_frame = f;
             }
-            values.push_back(t);
+            ++num_values;
+            median.push(t);
             if (t < minimum)
                 minimum = t;
             if (t > maximum)
                 maximum = t;
             total += t;
-            average = total / static_cast<perf_type>(values.size());
+            average = total / static_cast<perf_type>(num_values);
         }
         perf_type min() const {
             return minimum;
@@ -109,109 +110,35 @@ private:
             return average;
         }
         uint32_t count() const {
-            return values.size();
+            return num_values;
         }
         perf_type sum() const {
             return total;
         }
         perf_type med() const {
-            if (curr_frame != median_computed) {
-                std::vector<perf_type> copy(values);
-                std::sort(copy.begin(), copy.end());
-                median = copy[copy.size() / 2];
-                median_computed = curr_frame;
-            }
-            return median;
+            return median.value();
         }
         frame_type frame() const {
             return curr_frame;
         }
         void reset() {
-            values.clear();
-            average = median = total = 0;
+            num_values = 0;
+            median.reset();
+            average = total = 0;
             minimum = std::numeric_limits<perf_type>::max();
             maximum = std::numeric_limits<perf_type>::lowest();
         }
 
     private:
-        std::vector<perf_type> values;
+        // regions entered many times per frame must not allocate, so the median is estimated in constant memory
+        utility::P2Quantile<perf_type> median{0.5};
+        uint32_t num_values = 0;
         perf_type minimum = std::numeric_limits<perf_type>::max(), maximum = std::numeric_limits<perf_type>::lowest();
         perf_type average = 0, total = 0;
-        mutable perf_type median = 0;
         frame_type curr_frame = std::numeric_limits<frame_type>::max();
-        mutable frame_type median_computed = std::numeric_limits<frame_type>::max();
     };
 
-    class windowed_frame_statistics {
-    public:
-        void push_value(perf_type t) {
-            values.push_back(t);
-            if (values.size() > window_size)
-                values.pop_front();
-            moments_ok = false;
-        }
-        perf_type min() {
-            compute_moments();
-            return minimum;
-        };
-        perf_type max() {
-            compute_moments();
-            return maximum;
-        }
-        perf_type avg() {
-            compute_moments();
-            return average;
-        }
-        uint32_t count() const {
-            return values.size();
-        }
-        perf_type sum() {
-            compute_moments();
-            return total;
-        }
-        perf_type med() {
-            compute_moments();
-            return median;
-        }
-        void reset(bool clear_values = true) {
-            if (clear_values)
-                values.clear();
-            average = median = total = 0;
-            minimum = std::numeric_limits<perf_type>::max();
-            maximum = std::numeric_limits<perf_type>::lowest();
-        }
-
-    private:
-        void compute_moments() {
-            if (!moments_ok) {
-                reset(false);
-                if (!values.empty()) {
-                    std::vector<perf_type> copy(values.begin(), values.end());
-                    std::sort(copy.begin(), copy.end());
-                    median = copy[copy.size() / 2];
-                    for (auto& v : copy) {
-                        total += v;
-                        if (v < minimum)
-                            minimum = v;
-                        if (v > maximum)
-                            maximum = v;
-                    }
-                    if (copy.size() > 1)
-                        average = total / copy.size();
-                    else
-                        average = total;
-                }
-                moments_ok = true;
-            }
-        }
-
-        std::list<perf_type> values;
-        perf_type minimum = std::numeric_limits<perf_type>::max(), maximum = std::numeric_limits<perf_type>::lowest();
-        perf_type average = 0, total = 0;
-        mutable perf_type median = 0;
-        mutable bool moments_ok = false;
-        uint32_t window_size = buffer_length;
-    };
+    using windowed_frame_statistics = utility::RollingStatistics<perf_type, buffer_length>;
 
     std::array<frame_statistics, buffer_length> time_buffer{};
     std::string name;
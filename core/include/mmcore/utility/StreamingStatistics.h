@@ -0,0 +1,327 @@
+/*
+ * StreamingStatistics.h
+ *
+ * Copyright (C) 2022 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace megamol {
+namespace core {
+namespace utility {
+
+/**
+ * Streaming estimator for a single quantile using the P-square algorithm
+ * (Jain and Chlamtac, "The P2 algorithm for dynamic calculation of quantiles and histograms without storing
+ * observations", 1985). Uses constant memory and O(1) time per sample. Results are exact for up to five samples.
+ */
+template<typename T>
+class P2Quantile {
+public:
+    explicit P2Quantile(double quantile = 0.5) : p(quantile) {
+        reset();
+    }
+
+    void reset() {
+        num = 0;
+    }
+
+    void push(T sample) {
+        const double x = static_cast<double>(sample);
+
+        if (num < 5) {
+            heights[num++] = x;
+            if (num == 5) {
+                std::sort(heights.begin(), heights.end());
+                positions = {0.0, 1.0, 2.0, 3.0, 4.0};
+                desired = {0.0, 2.0 * p, 4.0 * p, 2.0 + 2.0 * p, 4.0};
+                increments = {0.0, p / 2.0, p, (1.0 + p) / 2.0, 1.0};
+            }
+            return;
+        }
+
+        // find cell k with heights[k] <= x < heights[k + 1], extending the extreme markers if needed
+        int k = 0;
+        if (x < heights[0]) {
+            heights[0] = x;
+        } else if (x >= heights[4]) {
+            heights[4] = x;
+            k = 3;
+        } else {
+            while (x >= heights[k + 1])
+                ++k;
+        }
+
+        for (int i = k + 1; i < 5; ++i)
+            positions[i] += 1.0;
+        for (int i = 0; i < 5; ++i)
+            desired[i] += increments[i];
+        ++num;
+
+        // adjust the middle markers if they are off their desired positions
+        for (int i = 1; i <= 3; ++i) {
+            const double d = desired[i] - positions[i];
+            if ((d >= 1.0 && positions[i + 1] - positions[i] > 1.0) ||
+                (d <= -1.0 && positions[i - 1] - positions[i] < -1.0)) {
+                const int s = d >= 0.0 ? 1 : -1;
+                const double candidate = parabolic(i, s);
+                heights[i] = (heights[i - 1] < candidate && candidate < heights[i + 1]) ? candidate : linear(i, s);
+                positions[i] += s;
+            }
+        }
+    }
+
+    T value() const {
+        if (num == 0)
+            return T{};
+
+        if (num <= 5) {
+            auto sorted = heights;
+            std::sort(sorted.begin(), sorted.begin() + num);
+            return static_cast<T>(sorted[static_cast<uint32_t>(p * (num - 1) + 0.5)]);
+        }
+
+        return static_cast<T>(heights[2]);
+    }
+
+    uint64_t count() const {
+        return num;
+    }
+
+private:
+    double parabolic(int i, int s) const {
+        const double n_prev = positions[i - 1], n = positions[i], n_next = positions[i + 1];
+        return heights[i] + s / (n_next - n_prev) *
+                                ((n - n_prev + s) * (heights[i + 1] - heights[i]) / (n_next - n) +
+                                    (n_next - n - s) * (heights[i] - heights[i - 1]) / (n - n_prev));
+    }
+
+    double linear(int i, int s) const {
+        return heights[i] + s * (heights[i + s] - heights[i]) / (positions[i + s] - positions[i]);
+    }
+
+    double p;
+    uint64_t num = 0;
+    std::array<double, 5> heights{};
+    std::array<double, 5> positions{};
+    std::array<double, 5> desired{};
+    std::array<double, 5> increments{};
+};
+
+/**
+ * Approximates a quantile over roughly the last 'window' samples. Two P-square estimators are restarted
+ * alternately every window/2 samples and the one with the longer history answers queries.
+ */
+template<typename T>
+class SlidingP2Quantile {
+public:
+    explicit SlidingP2Quantile(double quantile = 0.5, uint32_t window = 256)
+            : estimators{P2Quantile<T>(quantile), P2Quantile<T>(quantile)}
+            , half_window(std::max<uint32_t>(window / 2, 5)) {}
+
+    void push(T sample) {
+        estimators[0].push(sample);
+        estimators[1].push(sample);
+
+        if (++since_restart >= half_window) {
+            since_restart = 0;
+            const auto younger = estimators[0].count() < estimators[1].count() ? 0 : 1;
+            // restart the older one, the younger one now holds the longer history
+            estimators[1 - younger].reset();
+        }
+    }
+
+    T value() const {
+        return estimators[0].count() >= estimators[1].count() ? estimators[0].value() : estimators[1].value();
+    }
+
+    void reset() {
+        estimators[0].reset();
+        estimators[1].reset();
+        since_restart = 0;
+    }
+
+private:
+    std::array<P2Quantile<T>, 2> estimators;
+    uint32_t half_window;
+    uint32_t since_restart = 0;
+};
+
+/**
+ * Statistics over the last Capacity values of a stream, stored in a fixed-size ring buffer.
+ * Sum, mean, min and max are maintained in amortized O(1) without heap allocations.
+ * The exact median needs a partial sort of a stack copy of the window and is computed lazily.
+ */
+template<typename T, std::size_t Capacity>
+class RollingStatistics {
+public:
+    static_assert(Capacity > 0, "RollingStatistics needs a positive capacity");
+
+    void push(T value) {
+        if (num == Capacity) {
+            total -= values[head];
+        } else {
+            ++num;
+        }
+        values[head] = value;
+        head = (head + 1) % Capacity;
+        total += value;
+        if (head == 0) {
+            // re-sum once per round trip so floating point drift of the running sum stays bounded
+            total = T{};
+            for (std::size_t i = 0; i < num; ++i)
+                total += values[i];
+        }
+
+        // monotonic queues: entries older than the window drop out at the front,
+        // entries dominated by the new value drop out at the back. Expiring first
+        // leaves at most Capacity - 1 entries, so the new one never overwrites a live slot.
+        const uint64_t index = pushed++;
+        if (index >= Capacity) {
+            minimum_queue.expire(index - Capacity);
+            maximum_queue.expire(index - Capacity);
+        }
+        minimum_queue.push(index, value, [](T a, T b) { return a >= b; });
+        maximum_queue.push(index, value, [](T a, T b) { return a <= b; });
+        median_valid = false;
+    }
+
+    void reset() {
+        num = head = 0;
+        pushed = 0;
+        total = T{};
+        minimum_queue.clear();
+        maximum_queue.clear();
+        median_valid = false;
+    }
+
+    uint32_t count() const {
+        return static_cast<uint32_t>(num);
+    }
+
+    T sum() const {
+        return total;
+    }
+
+    T avg() const {
+        return num > 0 ? static_cast<T>(total / static_cast<T>(num)) : T{};
+    }
+
+    T min() const {
+        return num > 0 ? minimum_queue.front() : std::numeric_limits<T>::max();
+    }
+
+    T max() const {
+        return num > 0 ? maximum_queue.front() : std::numeric_limits<T>::lowest();
+    }
+
+    T med() const {
+        if (!median_valid) {
+            median = quantile(0.5);
+            median_valid = true;
+        }
+        return median;
+    }
+
+    /** Exact quantile of the current window, q in [0, 1]. */
+    T quantile(double q) const {
+        if (num == 0)
+            return T{};
+        std::array<T, Capacity> scratch;
+        std::copy_n(values.begin(), num, scratch.begin());
+        const auto nth = static_cast<std::size_t>(std::clamp(q, 0.0, 1.0) * (num - 1) + 0.5);
+        std::nth_element(scratch.begin(), scratch.begin() + nth, scratch.begin() + num);
+        return scratch[nth];
+    }
+
+    /** Value pushed 'age' samples ago, 0 is the newest one. */
+    T at(std::size_t age) const {
+        return values[(head + Capacity - 1 - (age % Capacity)) % Capacity];
+    }
+
+private:
+    class MonotonicQueue {
+    public:
+        template<typename Dominates>
+        void push(uint64_t index, T value, Dominates dominates) {
+            while (size > 0 && dominates(entries[back()].second, value))
+                --size;
+            entries[(first + size) % Capacity] = {index, value};
+            ++size;
+        }
+        void expire(uint64_t index) {
+            while (size > 0 && entries[first].first <= index) {
+                first = (first + 1) % Capacity;
+                --size;
+            }
+        }
+        T front() const {
+            return entries[first].second;
+        }
+        void clear() {
+            first = size = 0;
+        }
+
+    private:
+        std::size_t back() const {
+            return (first + size - 1) % Capacity;
+        }
+        std::array<std::pair<uint64_t, T>, Capacity> entries{};
+        std::size_t first = 0, size = 0;
+    };
+
+    std::array<T, Capacity> values{};
+    std::size_t num = 0, head = 0;
+    uint64_t pushed = 0;
+    T total = T{};
+    MonotonicQueue minimum_queue, maximum_queue;
+    mutable T median = T{};
+    mutable bool median_valid = false;
+};
+
+/**
+ * Single writer, multiple reader snapshot of a trivially copyable value using a sequence lock.
+ * The writer never blocks and readers retry until they got a consistent copy, so no mutex is involved.
+ */
+template<typename T>
+class SeqLockSnapshot {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLockSnapshot needs a trivially copyable type");
+
+    void publish(T const& value) {
+        const auto seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&data, &value, sizeof(T));
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    T read() const {
+        T result;
+        uint32_t before, after;
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            std::memcpy(&result, &data, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) != 0 || before != after);
+        return result;
+    }
+
+private:
+    std::atomic<uint32_t> sequence{0};
+    T data{};
+};
+
+} // namespace utility
+} // namespace core
+} // namespace megamol
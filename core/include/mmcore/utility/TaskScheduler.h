@@ -0,0 +1,398 @@
+/*
+ * TaskScheduler.h
+ *
+ * Copyright (C) 2022 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace megamol {
+namespace core {
+namespace utility {
+
+/** Priorities of tasks. Low priority tasks are background work that only runs on worker threads. */
+enum class TaskPriority : unsigned int { High = 0, Normal = 1, Low = 2 };
+
+/** Thrown into the futures of tasks that got cancelled before they started. */
+class TaskCancelled : public std::runtime_error {
+public:
+    TaskCancelled() : std::runtime_error("task cancelled") {}
+};
+
+/**
+ * Read-only view on a cancellation flag. Cancellation is cooperative: long running tasks are expected to
+ * poll IsCancelled() and return early. A default constructed token is never cancelled.
+ */
+class CancellationToken {
+public:
+    CancellationToken() = default;
+
+    bool IsCancelled() const {
+        return this->flag != nullptr && this->flag->load(std::memory_order_relaxed);
+    }
+
+    /** Throws TaskCancelled if the token is cancelled. */
+    void ThrowIfCancelled() const {
+        if (this->IsCancelled()) {
+            throw TaskCancelled();
+        }
+    }
+
+private:
+    friend class CancellationSource;
+
+    explicit CancellationToken(std::shared_ptr<std::atomic<bool>> flag) : flag(std::move(flag)) {}
+
+    std::shared_ptr<std::atomic<bool>> flag;
+};
+
+/** Owner of a cancellation flag, hands out tokens and cancels them. */
+class CancellationSource {
+public:
+    CancellationSource() : flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void Cancel() {
+        this->flag->store(true, std::memory_order_relaxed);
+    }
+
+    bool IsCancelled() const {
+        return this->flag->load(std::memory_order_relaxed);
+    }
+
+    CancellationToken Token() const {
+        return CancellationToken(this->flag);
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> flag;
+};
+
+/**
+ * Process-wide work-stealing task scheduler.
+ *
+ * Every worker thread owns a queue per priority. Tasks spawned on a worker go to its own queue, the worker takes
+ * the newest task first for cache locality while idle workers steal the oldest tasks of others. Tasks submitted
+ * by other threads go to a shared queue. Threads waiting for tasks (futures via Wait(), TaskGroup::Wait(),
+ * ParallelFor) execute pending tasks in the meantime, so nested parallelism does not deadlock.
+ *
+ * The CPU time spent in tasks is accounted per account, usually a module. Tasks inherit the account of the thread
+ * submitting them, see AccountScope. The core sets the account of a module while its callbacks run.
+ *
+ * There is one scheduler per process, accessed through TaskScheduler::Instance().
+ */
+class TaskScheduler {
+public:
+    /** CPU time accounting of tasks, identified by name. Accounts live as long as the scheduler. */
+    class Account {
+    public:
+        explicit Account(std::string name) : name(std::move(name)) {}
+
+        std::string const& Name() const {
+            return this->name;
+        }
+
+        /** CPU time of all finished tasks of this account in nanoseconds. */
+        uint64_t CpuTimeNs() const {
+            return this->cpuTimeNs.load(std::memory_order_relaxed);
+        }
+
+        /** Number of finished tasks of this account. */
+        uint64_t TaskCount() const {
+            return this->tasks.load(std::memory_order_relaxed);
+        }
+
+    private:
+        friend class TaskScheduler;
+
+        std::string name;
+        std::atomic<uint64_t> cpuTimeNs{0};
+        std::atomic<uint64_t> tasks{0};
+    };
+
+    /** Sets the account of the calling thread for its lifetime. Tasks submitted meanwhile inherit it. */
+    class AccountScope {
+    public:
+        explicit AccountScope(Account* account);
+        ~AccountScope();
+
+        AccountScope(AccountScope const&) = delete;
+        AccountScope& operator=(AccountScope const&) = delete;
+
+    private:
+        Account* previous;
+    };
+
+    /**
+     * Answers the process-wide scheduler. It is created on first use with one worker less than there are
+     * hardware threads, because the threads waiting for results also execute tasks.
+     */
+    static TaskScheduler& Instance();
+
+    /**
+     * Ctor.
+     *
+     * @param workerCount The number of worker threads, at least one.
+     */
+    explicit TaskScheduler(unsigned int workerCount);
+
+    /** Dtor. Pending tasks are dropped, running tasks are completed. */
+    ~TaskScheduler();
+
+    TaskScheduler(TaskScheduler const&) = delete;
+    TaskScheduler& operator=(TaskScheduler const&) = delete;
+
+    /** Answers the number of worker threads. */
+    unsigned int WorkerCount() const;
+
+    /** Answers whether the calling thread is a worker of this scheduler. */
+    bool IsWorkerThread() const;
+
+    /**
+     * Queues a task without a way to wait for it. Exceptions escaping the task are logged.
+     *
+     * @param task     The task to run.
+     * @param priority The priority of the task.
+     */
+    void Schedule(std::function<void()> task, TaskPriority priority = TaskPriority::Normal) const;
+
+    /**
+     * Queues a task and answers a future for its result.
+     *
+     * @param func     The task to run.
+     * @param priority The priority of the task.
+     * @param token    If cancelled before the task started, the task is skipped and its future throws TaskCancelled.
+     *
+     * @return The future for the result of the task.
+     */
+    template<typename Func>
+    auto Submit(Func&& func, TaskPriority priority = TaskPriority::Normal, CancellationToken token = {}) const
+        -> std::future<std::invoke_result_t<std::decay_t<Func>>> {
+        using Result = std::invoke_result_t<std::decay_t<Func>>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(
+            [f = std::forward<Func>(func), token]() mutable -> Result {
+                token.ThrowIfCancelled();
+                return f();
+            });
+        auto future = task->get_future();
+        this->Schedule([task]() { (*task)(); }, priority);
+        return future;
+    }
+
+    /**
+     * Waits for a future while executing pending tasks on the calling thread.
+     *
+     * @param future The future to wait for.
+     */
+    template<typename Result>
+    void Wait(std::future<Result> const& future) const {
+        while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            if (!this->RunPendingTask()) {
+                future.wait_for(std::chrono::microseconds(100));
+            }
+        }
+    }
+
+    /**
+     * Executes one pending task of at least the given priority on the calling thread.
+     *
+     * @param lowest The lowest priority to consider. Low priority tasks can be long running background work,
+     *               so only workers pick them up by default.
+     *
+     * @return true if a task was executed, false if there was nothing to do.
+     */
+    bool RunPendingTask(TaskPriority lowest = TaskPriority::Normal) const;
+
+    /**
+     * Answers the account with the given name, creating it if needed.
+     *
+     * @param name The name of the account, e.g. the full name of a module.
+     *
+     * @return The account, valid as long as the scheduler.
+     */
+    Account* GetAccount(std::string const& name) const;
+
+    /** Answers the account of the calling thread, nullptr if there is none. */
+    static Account* CurrentAccount();
+
+    /** Answers name, CPU time in ns and task count of all accounts. */
+    std::vector<std::tuple<std::string, uint64_t, uint64_t>> AccountStatistics() const;
+
+    /** Resets the CPU times and task counts of all accounts. */
+    void ResetAccounts() const;
+
+private:
+    class Impl;
+
+    std::unique_ptr<Impl> impl;
+};
+
+/**
+ * Group of tasks that can be waited for and cancelled together. The waiting thread helps executing tasks.
+ * If tasks throw, Wait() rethrows the first exception after all tasks finished.
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(
+        TaskScheduler const& scheduler = TaskScheduler::Instance(), TaskPriority priority = TaskPriority::Normal)
+            : scheduler(scheduler)
+            , priority(priority) {}
+
+    /** Dtor. Waits for outstanding tasks, exceptions are dropped. */
+    ~TaskGroup() {
+        try {
+            this->Wait();
+        } catch (...) {}
+    }
+
+    TaskGroup(TaskGroup const&) = delete;
+    TaskGroup& operator=(TaskGroup const&) = delete;
+
+    /**
+     * Runs a task as part of the group. The task is skipped if the group was cancelled before it started.
+     *
+     * @param func The task to run.
+     */
+    template<typename Func>
+    void Run(Func&& func) {
+        this->pending.fetch_add(1, std::memory_order_relaxed);
+        this->scheduler.Schedule(
+            [this, f = std::forward<Func>(func)]() mutable {
+                if (!this->cancellation.IsCancelled()) {
+                    try {
+                        f();
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(this->lock);
+                        if (!this->error) {
+                            this->error = std::current_exception();
+                        }
+                    }
+                }
+                this->finished();
+            },
+            this->priority);
+    }
+
+    /** Waits for all tasks of the group and rethrows the first exception of any of them. */
+    void Wait() {
+        while (this->pending.load(std::memory_order_acquire) > 0) {
+            if (!this->scheduler.RunPendingTask(std::max(this->priority, TaskPriority::Normal))) {
+                std::unique_lock<std::mutex> lock(this->lock);
+                this->done.wait_for(lock, std::chrono::microseconds(100),
+                    [this]() { return this->pending.load(std::memory_order_acquire) == 0; });
+            }
+        }
+        std::exception_ptr e;
+        {
+            // also waits for the last task to leave finished()
+            std::lock_guard<std::mutex> lock(this->lock);
+            std::swap(e, this->error);
+        }
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+
+    /** Requests cancellation: tasks not yet started are skipped, running tasks should poll Token(). */
+    void Cancel() {
+        this->cancellation.Cancel();
+    }
+
+    bool IsCancelled() const {
+        return this->cancellation.IsCancelled();
+    }
+
+    CancellationToken Token() const {
+        return this->cancellation.Token();
+    }
+
+private:
+    void finished() {
+        // decrement under the lock: Wait() takes the lock after it saw no pending tasks, so the group cannot be
+        // destroyed before the last task released the lock and notified, and no notification gets lost
+        std::lock_guard<std::mutex> lock(this->lock);
+        if (this->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            this->done.notify_all();
+        }
+    }
+
+    TaskScheduler const& scheduler;
+    TaskPriority priority;
+    CancellationSource cancellation;
+    std::atomic<std::size_t> pending{0};
+    std::mutex lock;
+    std::condition_variable done;
+    std::exception_ptr error;
+};
+
+/**
+ * Calls body(first, last) for chunks [first, last) covering [begin, end) in parallel. The range is split
+ * recursively down to 'grain' elements, idle workers steal the larger halves. Remaining chunks are skipped once
+ * the token is cancelled. Exceptions of the body are rethrown.
+ *
+ * @param begin     The first index.
+ * @param end       One past the last index.
+ * @param grain     The minimum number of indices per chunk, 0 picks one based on the number of workers.
+ * @param body      The function processing a chunk.
+ * @param token     Token for cancelling the loop.
+ * @param scheduler The scheduler to run on.
+ */
+template<typename Index, typename Body>
+void ParallelFor(Index begin, Index end, Index grain, Body const& body, CancellationToken token = {},
+    TaskScheduler const& scheduler = TaskScheduler::Instance()) {
+    static_assert(std::is_integral_v<Index>, "ParallelFor needs an integral index type");
+    if (end <= begin) {
+        return;
+    }
+    if (grain <= 0) {
+        // a few chunks per thread keep load balancing working without drowning in tasks
+        grain = std::max<Index>(1, static_cast<Index>((end - begin) / (4 * (scheduler.WorkerCount() + 1))));
+    }
+
+    TaskGroup group(scheduler);
+    std::function<void(Index, Index)> split = [&](Index first, Index last) {
+        while (last - first > grain) {
+            if (token.IsCancelled() || group.IsCancelled()) {
+                return;
+            }
+            const Index middle = first + (last - first) / 2;
+            group.Run([&split, middle, last]() { split(middle, last); });
+            last = middle;
+        }
+        if (!token.IsCancelled() && !group.IsCancelled()) {
+            body(first, last);
+        }
+    };
+    try {
+        split(begin, end);
+    } catch (...) {
+        // the queued halves still reference split, they have to finish before it goes out of scope
+        group.Cancel();
+        try {
+            group.Wait();
+        } catch (...) {}
+        throw;
+    }
+    group.Wait();
+}
+
+} // namespace utility
+} // namespace core
+} // namespace megamol
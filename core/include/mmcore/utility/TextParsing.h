@@ -0,0 +1,206 @@
+/*
+ * TextParsing.h
+ *
+ * Copyright (C) 2022 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace megamol {
+namespace core {
+namespace utility {
+
+/**
+ * Read-only memory mapping of a whole file. Parsers work directly on the mapped bytes, the operating system pages
+ * the file in as it is touched.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    /**
+     * Maps the given file, a previously mapped file is closed.
+     *
+     * @param filename The file to map.
+     *
+     * @return 'true' on success, 'false' if the file could not be opened or mapped.
+     */
+    bool open(std::string const& filename);
+
+    void close();
+
+    char const* data() const {
+        return m_data;
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+    std::string_view text() const {
+        return std::string_view(m_data, m_size);
+    }
+
+private:
+    char const* m_data = nullptr;
+    size_t m_size = 0;
+
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+};
+
+/**
+ * Splits text into chunks for parallel parsing. Every chunk starts at the beginning of a line, so no line is
+ * split between chunks.
+ *
+ * @param data      The text.
+ * @param size      The length of the text.
+ * @param min_chunk The minimum length of a chunk in bytes.
+ *
+ * @return The start offsets of the chunks followed by size.
+ */
+std::vector<size_t> chunkAtLines(char const* data, size_t size, size_t min_chunk = 1 << 20);
+
+/**
+ * Answers the start offsets of all lines of a text, searched in parallel.
+ * A trailing line break does not start another line.
+ */
+std::vector<size_t> lineOffsets(char const* data, size_t size);
+
+/**
+ * Random access to the lines of a text. The lines are views into the text without the line break and a
+ * preceding carriage return, so the text has to outlive the index.
+ */
+class LineIndex {
+public:
+    LineIndex() = default;
+
+    /** Indexes the lines of the text in parallel. */
+    explicit LineIndex(std::string_view text) : m_text(text), m_starts(lineOffsets(text.data(), text.size())) {}
+
+    size_t size() const {
+        return m_starts.size();
+    }
+
+    bool empty() const {
+        return m_starts.empty();
+    }
+
+    std::string_view operator[](size_t line) const;
+
+    /** Answers the offset of the line in the text. */
+    size_t offset(size_t line) const {
+        return m_starts[line];
+    }
+
+private:
+    std::string_view m_text;
+    std::vector<size_t> m_starts;
+};
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+inline bool isWhitespace(char c) {
+    return isBlank(c) || c == '\n';
+}
+
+/** Removes leading and trailing whitespace. */
+std::string_view trim(std::string_view text);
+
+/**
+ * Answers a fixed-width field of a line, e.g. a column range of a PDB record, trimmed. Fields beyond the end of
+ * the line are clamped, so short lines yield empty fields.
+ */
+std::string_view field(std::string_view line, size_t begin, size_t length);
+
+/**
+ * Number parsers working on views without terminating zero. The whole view has to be a number, surrounding
+ * whitespace is not skipped. Decimal numbers of up to 19 significant digits with small exponents take a fast
+ * exact path, all others are parsed by the standard library.
+ *
+ * @return 'true' on success, 'false' if the text is no number. The value is unchanged on failure.
+ */
+bool parseDouble(std::string_view text, double& value);
+bool parseFloat(std::string_view text, float& value);
+bool parseInt(std::string_view text, int64_t& value);
+bool parseUInt(std::string_view text, uint64_t& value);
+
+/**
+ * Minimal tokenizer over a text range. Tokens are separated by blanks, tabs and line breaks.
+ * No memory is allocated, numbers are parsed from the text bytes.
+ */
+class TextCursor {
+public:
+    TextCursor(char const* begin, char const* end) : m_cur(begin), m_end(end) {}
+
+    explicit TextCursor(std::string_view text) : m_cur(text.data()), m_end(text.data() + text.size()) {}
+
+    bool atEnd() const {
+        return m_cur >= m_end;
+    }
+
+    char const* position() const {
+        return m_cur;
+    }
+
+    /** Skips blanks and tabs, but not line breaks. */
+    void skipBlanks();
+
+    /** Skips blanks, tabs and line breaks. */
+    void skipWhitespace();
+
+    /** Moves behind the next line break. */
+    void skipLine();
+
+    /** Answers the rest of the current line without the line break and moves behind it. */
+    std::string_view line();
+
+    /** Answers whether the current line has no more tokens. */
+    bool atLineEnd();
+
+    /** Reads the next token of the current line, returns an empty token at the end of the line. */
+    std::string_view token();
+
+    /** Consumes the character c if it is the next one, without skipping blanks. */
+    bool consume(char c) {
+        if (m_cur < m_end && *m_cur == c) {
+            ++m_cur;
+            return true;
+        }
+        return false;
+    }
+
+    /** Compares the next token case-insensitively with keyword and consumes it on a match. */
+    bool keyword(char const* keyword);
+
+    /** Parse the next token as number. */
+    bool parseFloat(float& value);
+    bool parseDouble(double& value);
+
+    /** Parses the integer at the cursor, it ends at the first non-digit, e.g. at the slashes of OBJ faces. */
+    bool parseInt(int64_t& value);
+
+private:
+    char const* m_cur;
+    char const* m_end;
+};
+
+} // namespace utility
+} // namespace core
+} // namespace megamol
@@ -16,11 +16,10 @@
 
 #include "mmcore/api/MegaMolCore.std.h"
 
-#include "mmcore/utility/sys/RunnableThread.h"
 #include "vislib/SingleLinkedList.h"
 #include "vislib/sys/CriticalSection.h"
 #include "vislib/sys/Event.h"
-#include "vislib/sys/Semaphore.h"
+#include "vislib/sys/Runnable.h"
 #include "vislib/sys/ThreadPoolListener.h"
 #include "vislib/types.h"
 
@@ -44,6 +43,11 @@ namespace sys {
  * be completed or aborted. The listener will receive the pointer to the
  * Runnable and to the input data in both cases. Release the memory in the
  * event handling methods.
+ *
+ * The pool does not own threads anymore, the work items are executed as low
+ * priority tasks of the process-wide megamol::core::utility::TaskScheduler.
+ * The "threads" of the pool are the number of work items the pool executes
+ * concurrently at most.
  */
 class MEGAMOLCORE_API ThreadPool {
 
@@ -193,38 +197,6 @@ public:
     }
 
 private:
-    /**
-     * This is the worker Runnable that executes other Runnables that
-     * have been queued as user work items. The runnable runs until the
-     * 'semBlockWorker' member of 'pool' is in signaled state, but the work
-     * item queue is empty at the same time.
-     */
-    class Worker : public Runnable {
-
-    public:
-        /** Ctor. */
-        Worker(void);
-
-        /** Dtor. */
-        virtual ~Worker(void);
-
-        /**
-         * Perform the work of a thread.
-         *
-         * @param pool Pointer to the thread pool that the worker is
-         *             working for. The caller remains owner of the memory
-         *             designated by 'pool' and must ensure it lives as long
-         *             as the worker..
-         *
-         * @return 0, always.
-         */
-        virtual DWORD Run(void* pool);
-
-    private:
-        /** The pool to get the work items from. */
-        ThreadPool* pool;
-    }; /* end class Worker */
-
     /** Used to store the work items and their input data. */
     typedef struct WorkItem_t {
         Runnable* runnable;
@@ -285,6 +257,12 @@ private:
      */
     void queueUserWorkItem(WorkItem& workItem, const bool createDefaultThreads);
 
+    /**
+     * Executes queued work items until the queue is empty. This is the body
+     * of the scheduler tasks the pool spawns, at most one per pool thread.
+     */
+    void runUserWorkItems(void);
+
     /**
      * Forbidden assignment.
      *
@@ -299,7 +277,10 @@ private:
     /** The number of threads currently working on some work item. */
     SIZE_T cntActiveThreads;
 
-    /** The total number of threads (active and idling). */
+    /** The number of scheduler tasks currently executing work items. */
+    SIZE_T cntRunners;
+
+    /** The maximum number of work items executed concurrently. */
     SIZE_T cntTotalThreads;
 
     /**
@@ -330,7 +311,7 @@ private:
     mutable CriticalSection lockQueue;
 
     /**
-     * Critical section for protecting 'cntActiveThreads' and
+     * Critical section for protecting 'cntActiveThreads', 'cntRunners' and
      * 'cntTotalThreads'. The lock must be hold if any of the counters
      * is accessed to ensure a consistent view of the total number of
      * threads.
@@ -342,9 +323,6 @@ private:
      * When accessing this attribute, 'lockQueue' must be held.
      */
     SingleLinkedList<WorkItem> queue;
-
-    /** Semaphore for waiting while 'queue' is empty. */
-    Semaphore semBlockWorker;
 };
 
 } /* end namespace sys */
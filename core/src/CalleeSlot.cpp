@@ -10,6 +10,7 @@
 #include "mmcore/AbstractNamedObjectContainer.h"
 #include "mmcore/CallerSlot.h"
 #include "mmcore/CoreInstance.h"
+#include "mmcore/Module.h"
 #include "mmcore/profiler/Manager.h"
 #include "stdafx.h"
 
@@ -120,7 +121,10 @@ bool CalleeSlot::ConnectCall(megamol::core::Call* call, factories::CallDescripti
 bool CalleeSlot::InCall(unsigned int func, Call& call) {
     if (func >= this->callbacks.Count())
         return false;
-    return this->callbacks[func]->CallMe(const_cast<Module*>(reinterpret_cast<const Module*>(this->Owner())), call);
+    auto* owner = const_cast<Module*>(reinterpret_cast<const Module*>(this->Owner()));
+    // tasks spawned by the callback are charged to the called module
+    utility::TaskScheduler::AccountScope account(owner->TaskAccount());
+    return this->callbacks[func]->CallMe(owner, call);
 }
 
 
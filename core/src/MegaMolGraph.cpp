@@ -10,6 +10,8 @@
 #include <iostream>
 #include <numeric> // std::accumulate
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 
 // splits a string of the form "::one::two::three::" into an array of strings {"one", "two", "three"}
@@ -290,6 +292,42 @@ std::vector<megamol::core::param::ParamSlot*> megamol::core::MegaMolGraph::Enume
     return parameters;
 }
 
+uint64_t megamol::core::MegaMolGraph::UpstreamChangeEpoch(std::string const& moduleName) const {
+    auto module_it = find_module(clean(moduleName));
+    if (module_it == module_list_.end())
+        return Module::CurrentChangeEpoch();
+
+    // data flows from the callee to the caller of a call,
+    // so the modules a module depends on are found at the callee side of its outgoing calls
+    std::unordered_multimap<Module const*, Module const*> upstream;
+    for (auto const& call : call_list_) {
+        auto const* caller = call.callPtr->PeekCallerSlot();
+        auto const* callee = call.callPtr->PeekCalleeSlot();
+        if (caller == nullptr || callee == nullptr)
+            continue;
+        upstream.emplace(dynamic_cast<Module const*>(caller->Parent().get()),
+            dynamic_cast<Module const*>(callee->Parent().get()));
+    }
+
+    uint64_t epoch = 0;
+    std::unordered_set<Module const*> visited;
+    std::vector<Module const*> pending = {module_it->modulePtr.get()};
+    while (!pending.empty()) {
+        auto const* module = pending.back();
+        pending.pop_back();
+        if (module == nullptr || !visited.insert(module).second)
+            continue;
+
+        epoch = std::max(epoch, module->ChangeEpoch());
+
+        auto [from, to] = upstream.equal_range(module);
+        for (; from != to; ++from)
+            pending.push_back(from->second);
+    }
+
+    return epoch;
+}
+
 megamol::core::CallList_t const& megamol::core::MegaMolGraph::ListCalls() const {
     return call_list_;
 }
@@ -25,15 +25,54 @@
 
 using namespace megamol::core;
 
+namespace {
+/** Global change counter, incremented on every output change of any module */
+std::atomic<uint64_t> globalChangeEpoch{0};
+} // namespace
+
 
 /*
  * Module::Module
  */
-Module::Module(void) : AbstractNamedObjectContainer(), created(false) {
+Module::Module(void)
+        : AbstractNamedObjectContainer()
+        , created(false)
+        , changeEpoch(globalChangeEpoch.fetch_add(1, std::memory_order_acq_rel) + 1)
+        , taskAccount(nullptr) {
     // intentionally empty ATM
 }
 
 
+/*
+ * Module::NotifyOutputChanged
+ */
+void Module::NotifyOutputChanged(void) {
+    this->changeEpoch.store(globalChangeEpoch.fetch_add(1, std::memory_order_acq_rel) + 1, std::memory_order_release);
+}
+
+
+/*
+ * Module::CurrentChangeEpoch
+ */
+uint64_t Module::CurrentChangeEpoch(void) {
+    return globalChangeEpoch.load(std::memory_order_acquire);
+}
+
+
+/*
+ * Module::TaskAccount
+ */
+utility::TaskScheduler::Account* Module::TaskAccount(void) {
+    auto account = this->taskAccount.load(std::memory_order_acquire);
+    if (account == nullptr) {
+        // accounts are shared by name, so a racing second lookup yields the same one
+        account = utility::TaskScheduler::Instance().GetAccount(std::string(this->FullName().PeekBuffer()));
+        this->taskAccount.store(account, std::memory_order_release);
+    }
+    return account;
+}
+
+
 /*
  * Module::~Module
  */
@@ -17,12 +17,12 @@ void MultiPerformanceHistory::push_sample(frame_type frame, frame_index_type idx
     if (idx == 0) {
         // before we advance, use the frame for full-window statistics
         auto& buf = time_buffer[next_index];
-        window_metrics[static_cast<uint32_t>(metric_type::MIN)].push_value(buf.min());
-        window_metrics[static_cast<uint32_t>(metric_type::MAX)].push_value(buf.max());
-        window_metrics[static_cast<uint32_t>(metric_type::AVERAGE)].push_value(buf.avg());
-        window_metrics[static_cast<uint32_t>(metric_type::MEDIAN)].push_value(buf.med());
-        window_metrics[static_cast<uint32_t>(metric_type::COUNT)].push_value(buf.count());
-        window_metrics[static_cast<uint32_t>(metric_type::SUM)].push_value(buf.sum());
+        window_metrics[static_cast<uint32_t>(metric_type::MIN)].push(buf.min());
+        window_metrics[static_cast<uint32_t>(metric_type::MAX)].push(buf.max());
+        window_metrics[static_cast<uint32_t>(metric_type::AVERAGE)].push(buf.avg());
+        window_metrics[static_cast<uint32_t>(metric_type::MEDIAN)].push(buf.med());
+        window_metrics[static_cast<uint32_t>(metric_type::COUNT)].push(buf.count());
+        window_metrics[static_cast<uint32_t>(metric_type::SUM)].push(buf.sum());
         next_index = next_wrap(next_index);
         num_frames++;
     }
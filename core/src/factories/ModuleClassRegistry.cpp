@@ -11,6 +11,7 @@
 #include "mmcore/factories/ModuleDescription.h"
 #include "mmcore/factories/ModuleDescriptionManager.h"
 
+#include "job/StreamingStatisticsCheck.h"
 #include "job/TickSwitch.h"
 #include "mmcore/EventStorage.h"
 #include "mmcore/FileStreamProvider.h"
@@ -55,6 +56,7 @@ void factories::register_module_classes(factories::ModuleDescriptionManager& ins
     instance.RegisterAutoDescription<job::JobThread>();
     instance.RegisterAutoDescription<core::utility::LuaHostSettingsModule>();
     instance.RegisterAutoDescription<core::job::TickSwitch>();
+    instance.RegisterAutoDescription<core::job::StreamingStatisticsCheck>();
     instance.RegisterAutoDescription<core::FileStreamProvider>();
     instance.RegisterAutoDescription<view::light::AmbientLight>();
     instance.RegisterAutoDescription<view::light::DistantLight>();
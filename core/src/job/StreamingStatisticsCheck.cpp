@@ -0,0 +1,157 @@
+/*
+ * StreamingStatisticsCheck.cpp
+ *
+ * Copyright (C) 2022 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+#include "StreamingStatisticsCheck.h"
+#include "stdafx.h"
+
+#include "mmcore/param/IntParam.h"
+#include "mmcore/utility/StreamingStatistics.h"
+#include "mmcore/utility/log/Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <random>
+#include <vector>
+
+using megamol::core::utility::log::Log;
+
+namespace megamol {
+namespace core {
+namespace job {
+
+namespace {
+
+/**
+ * Pushes 'samples' values of 'series' into a window of the given capacity and compares it to a brute-force window
+ * after every sample.
+ *
+ * @return The number of mismatching samples.
+ */
+template<std::size_t Capacity>
+unsigned int checkWindow(const char* name, int samples, std::function<double(int)> const& series) {
+    utility::RollingStatistics<double, Capacity> stats;
+    std::deque<double> window;
+    unsigned int errors = 0;
+    for (int i = 0; i < samples; ++i) {
+        const double value = series(i);
+        stats.push(value);
+        window.push_back(value);
+        if (window.size() > Capacity) {
+            window.pop_front();
+        }
+
+        std::vector<double> sorted(window.begin(), window.end());
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (auto v : window) {
+            sum += v;
+        }
+        const double median = sorted[static_cast<std::size_t>(0.5 * (sorted.size() - 1) + 0.5)];
+
+        bool match = (stats.count() == window.size()) && (stats.min() == sorted.front()) &&
+                     (stats.max() == sorted.back()) && (stats.med() == median) &&
+                     (std::abs(stats.sum() - sum) <= 1.0e-9 * std::max(1.0, std::abs(sum)));
+        for (std::size_t age = 0; age < window.size(); ++age) {
+            match = match && (stats.at(age) == window[window.size() - 1 - age]);
+        }
+        if (!match) {
+            if (errors == 0) {
+                Log::DefaultLog.WriteError(
+                    "StreamingStatisticsCheck: %s, capacity %u, sample %d: min %f (expected %f), max %f (expected %f), "
+                    "median %f (expected %f), sum %f (expected %f)",
+                    name, static_cast<unsigned int>(Capacity), i, stats.min(), sorted.front(), stats.max(),
+                    sorted.back(), stats.med(), median, stats.sum(), sum);
+            }
+            ++errors;
+        }
+    }
+    return errors;
+}
+
+/** Checks all series with a window of the given capacity. */
+template<std::size_t Capacity>
+unsigned int checkCapacity(int samples) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> dist(0.0, 100.0);
+    std::vector<double> random(samples);
+    std::generate(random.begin(), random.end(), [&]() { return dist(rng); });
+
+    unsigned int errors = 0;
+    errors += checkWindow<Capacity>("ascending", samples, [](int i) { return static_cast<double>(i + 1); });
+    errors +=
+        checkWindow<Capacity>("descending", samples, [samples](int i) { return static_cast<double>(samples - i); });
+    errors += checkWindow<Capacity>("random", samples, [&random](int i) { return random[i]; });
+    // few distinct values, so equal minima and maxima have to expire in order
+    errors += checkWindow<Capacity>("plateaus", samples, [&random](int i) { return std::floor(random[i] / 25.0); });
+    return errors;
+}
+
+} // namespace
+
+
+/*
+ * StreamingStatisticsCheck::StreamingStatisticsCheck
+ */
+StreamingStatisticsCheck::StreamingStatisticsCheck(void)
+        : AbstractThreadedJob()
+        , Module()
+        , samplesSlot("samples", "number of samples pushed per series") {
+    this->samplesSlot << new param::IntParam(1000, 1);
+    this->MakeSlotAvailable(&this->samplesSlot);
+}
+
+
+/*
+ * StreamingStatisticsCheck::~StreamingStatisticsCheck
+ */
+StreamingStatisticsCheck::~StreamingStatisticsCheck(void) {
+    this->Release();
+}
+
+
+/*
+ * StreamingStatisticsCheck::create
+ */
+bool StreamingStatisticsCheck::create(void) {
+    // intentionally empty
+    return true;
+}
+
+
+/*
+ * StreamingStatisticsCheck::release
+ */
+void StreamingStatisticsCheck::release(void) {
+    // intentionally empty
+}
+
+
+/*
+ * StreamingStatisticsCheck::Run
+ */
+DWORD StreamingStatisticsCheck::Run(void* userData) {
+    const int samples = this->samplesSlot.Param<param::IntParam>()->Value();
+
+    unsigned int errors = 0;
+    errors += checkCapacity<1>(samples);
+    errors += checkCapacity<4>(samples);
+    errors += checkCapacity<7>(samples);
+    errors += checkCapacity<64>(samples);
+    errors += checkCapacity<1000>(samples);
+
+    if (errors > 0) {
+        Log::DefaultLog.WriteError("StreamingStatisticsCheck: %u samples did not match the brute-force window", errors);
+        return -1;
+    }
+    Log::DefaultLog.WriteInfo("StreamingStatisticsCheck: all windows match");
+    return 0;
+}
+
+} /* end namespace job */
+} /* end namespace core */
+} /* end namespace megamol */
@@ -0,0 +1,86 @@
+/*
+ * StreamingStatisticsCheck.h
+ *
+ * Copyright (C) 2022 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+#pragma once
+
+#include "mmcore/Module.h"
+#include "mmcore/job/AbstractThreadedJob.h"
+#include "mmcore/param/ParamSlot.h"
+
+namespace megamol {
+namespace core {
+namespace job {
+
+/**
+ * Checks utility::RollingStatistics against a brute-force evaluation of the same window. Ascending, descending and
+ * random series are pushed into windows of several capacities, and after every sample count, sum, minimum, maximum,
+ * median and the stored values have to match. Mismatches are logged and fail the job.
+ */
+class StreamingStatisticsCheck : public AbstractThreadedJob, public Module {
+public:
+    /**
+     * Answer the name of this module.
+     *
+     * @return The name of this module.
+     */
+    static const char* ClassName(void) {
+        return "StreamingStatisticsCheck";
+    }
+
+    /**
+     * Answer a human readable description of this module.
+     *
+     * @return A human readable description of this module.
+     */
+    static const char* Description(void) {
+        return "Checks the rolling frame statistics against a brute-force window";
+    }
+
+    /**
+     * Answers whether this module is available on the current system.
+     *
+     * @return 'true' if the module is available, 'false' otherwise.
+     */
+    static bool IsAvailable(void) {
+        return true;
+    }
+
+    /** Ctor. */
+    StreamingStatisticsCheck(void);
+
+    /** Dtor. */
+    virtual ~StreamingStatisticsCheck(void);
+
+protected:
+    /**
+     * Implementation of 'Create'.
+     *
+     * @return 'true' on success, 'false' otherwise.
+     */
+    virtual bool create(void);
+
+    /**
+     * Implementation of 'Release'.
+     */
+    virtual void release(void);
+
+    /**
+     * Perform the work of a thread.
+     *
+     * @param userData Unused.
+     *
+     * @return 0 if all checks passed, -1 otherwise.
+     */
+    virtual DWORD Run(void* userData);
+
+private:
+    /** number of samples pushed per series */
+    param::ParamSlot samplesSlot;
+};
+
+} /* end namespace job */
+} /* end namespace core */
+} /* end namespace megamol */
@@ -82,6 +82,11 @@ void param::ParamSlot::update(void) {
     bool oldDirty = this->IsDirty();
     AbstractParamSlot::update();
 
+    // everything depending on the owning module needs to be updated, see MegaMolGraph::UpstreamChangeEpoch
+    if (Module* m = dynamic_cast<Module*>(this->Parent().get()); m != nullptr) {
+        m->NotifyOutputChanged();
+    }
+
     QueueUpdateNotification(true);
 
     if (oldDirty != this->IsDirty()) {
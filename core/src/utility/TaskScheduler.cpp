@@ -0,0 +1,351 @@
+/*
+ * TaskScheduler.cpp
+ *
+ * Copyright (C) 2022 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#include "mmcore/utility/TaskScheduler.h"
+
+#include <array>
+#include <deque>
+#include <map>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
+#include "mmcore/utility/log/Log.h"
+
+using namespace megamol::core::utility;
+
+namespace {
+
+constexpr std::size_t PriorityCount = 3;
+
+struct TaskEntry {
+    std::function<void()> run;
+    TaskScheduler::Account* account;
+};
+
+struct TaskQueue {
+    std::mutex lock;
+    std::array<std::deque<TaskEntry>, PriorityCount> tasks;
+};
+
+/** The task currently executed by this thread and the thread CPU time its last time slice started at. */
+struct RunningTask {
+    TaskScheduler::Account* account = nullptr;
+    uint64_t start = 0;
+};
+
+thread_local void const* currentScheduler = nullptr;
+thread_local unsigned int currentWorker = 0;
+thread_local TaskScheduler::Account* currentAccount = nullptr;
+thread_local RunningTask runningTask;
+
+uint64_t threadCpuTimeNs() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+        return 0;
+    }
+    const uint64_t k = (static_cast<uint64_t>(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+    const uint64_t u = (static_cast<uint64_t>(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+    return (k + u) * 100;
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+#endif
+}
+
+} // namespace
+
+
+class TaskScheduler::Impl {
+public:
+    explicit Impl(unsigned int workerCount) : local(std::max(1u, workerCount)) {
+        for (auto& queue : this->local) {
+            queue = std::make_unique<TaskQueue>();
+        }
+        for (unsigned int i = 0; i < this->local.size(); ++i) {
+            this->threads.emplace_back(&Impl::work, this, i);
+        }
+    }
+
+    ~Impl() {
+        {
+            std::lock_guard<std::mutex> lock(this->sleepLock);
+            this->stopping = true;
+        }
+        this->wake.notify_all();
+        for (auto& thread : this->threads) {
+            thread.join();
+        }
+    }
+
+    bool isWorker() const {
+        return currentScheduler == this;
+    }
+
+    void push(TaskEntry&& entry, TaskPriority priority) {
+        auto& queue = this->isWorker() ? *this->local[currentWorker] : this->global;
+        {
+            std::lock_guard<std::mutex> lock(queue.lock);
+            queue.tasks[static_cast<std::size_t>(priority)].push_back(std::move(entry));
+        }
+        this->queued.fetch_add(1, std::memory_order_release);
+        {
+            // an idle worker might have just checked 'queued', make sure it is waiting before notifying
+            std::lock_guard<std::mutex> lock(this->sleepLock);
+        }
+        this->wake.notify_one();
+    }
+
+    bool pop(TaskPriority lowest, TaskEntry& entry) {
+        if (this->queued.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+        const bool worker = this->isWorker();
+        const auto count = static_cast<unsigned int>(this->local.size());
+        for (std::size_t p = 0; p <= static_cast<std::size_t>(lowest); ++p) {
+            // newest own task first, it is likely still in cache
+            if (worker && takeBack(*this->local[currentWorker], p, entry)) {
+                return true;
+            }
+            if (takeFront(this->global, p, entry)) {
+                return true;
+            }
+            // steal the oldest tasks of other workers, they usually represent the largest chunks of work
+            const unsigned int first = worker ? currentWorker + 1 : 0;
+            for (unsigned int i = 0; i < count; ++i) {
+                const unsigned int victim = (first + i) % count;
+                if (worker && victim == currentWorker) {
+                    continue;
+                }
+                if (takeFront(*this->local[victim], p, entry)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void execute(TaskEntry& entry) {
+        const auto start = threadCpuTimeNs();
+        // a task executed while another one waits gets its own time slice, the waiting one is charged until now
+        const auto outer = runningTask;
+        if (outer.account != nullptr) {
+            outer.account->cpuTimeNs.fetch_add(start - outer.start, std::memory_order_relaxed);
+        }
+        const auto previousAccount = currentAccount;
+        currentAccount = entry.account;
+        runningTask = {entry.account, start};
+
+        try {
+            entry.run();
+        } catch (std::exception const& e) {
+            log::Log::DefaultLog.WriteError("TaskScheduler: task failed: %s", e.what());
+        } catch (...) {
+            log::Log::DefaultLog.WriteError("TaskScheduler: task failed with an unknown exception");
+        }
+
+        const auto end = threadCpuTimeNs();
+        if (entry.account != nullptr) {
+            entry.account->cpuTimeNs.fetch_add(end - runningTask.start, std::memory_order_relaxed);
+            entry.account->tasks.fetch_add(1, std::memory_order_relaxed);
+        }
+        currentAccount = previousAccount;
+        runningTask = {outer.account, end};
+    }
+
+    std::vector<std::unique_ptr<TaskQueue>> local;
+    TaskQueue global;
+    std::vector<std::thread> threads;
+
+    mutable std::mutex accountsLock;
+    std::map<std::string, std::unique_ptr<Account>> accounts;
+
+private:
+    bool takeBack(TaskQueue& queue, std::size_t priority, TaskEntry& entry) {
+        std::lock_guard<std::mutex> lock(queue.lock);
+        auto& tasks = queue.tasks[priority];
+        if (tasks.empty()) {
+            return false;
+        }
+        entry = std::move(tasks.back());
+        tasks.pop_back();
+        this->queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool takeFront(TaskQueue& queue, std::size_t priority, TaskEntry& entry) {
+        std::lock_guard<std::mutex> lock(queue.lock);
+        auto& tasks = queue.tasks[priority];
+        if (tasks.empty()) {
+            return false;
+        }
+        entry = std::move(tasks.front());
+        tasks.pop_front();
+        this->queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void work(unsigned int index) {
+        currentScheduler = this;
+        currentWorker = index;
+
+        TaskEntry entry;
+        while (true) {
+            if (this->pop(TaskPriority::Low, entry)) {
+                this->execute(entry);
+                entry = TaskEntry{};
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(this->sleepLock);
+            this->wake.wait(lock, [this]() {
+                return this->stopping || this->queued.load(std::memory_order_acquire) > 0;
+            });
+            if (this->stopping) {
+                break;
+            }
+        }
+    }
+
+    std::atomic<std::size_t> queued{0};
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+
+/*
+ * TaskScheduler::AccountScope::AccountScope
+ */
+TaskScheduler::AccountScope::AccountScope(Account* account) : previous(currentAccount) {
+    currentAccount = account;
+}
+
+
+/*
+ * TaskScheduler::AccountScope::~AccountScope
+ */
+TaskScheduler::AccountScope::~AccountScope() {
+    currentAccount = this->previous;
+}
+
+
+/*
+ * TaskScheduler::Instance
+ */
+TaskScheduler& TaskScheduler::Instance() {
+    static TaskScheduler instance(std::max(2u, std::thread::hardware_concurrency()) - 1);
+    return instance;
+}
+
+
+/*
+ * TaskScheduler::TaskScheduler
+ */
+TaskScheduler::TaskScheduler(unsigned int workerCount) : impl(std::make_unique<Impl>(workerCount)) {}
+
+
+/*
+ * TaskScheduler::~TaskScheduler
+ */
+TaskScheduler::~TaskScheduler() = default;
+
+
+/*
+ * TaskScheduler::WorkerCount
+ */
+unsigned int TaskScheduler::WorkerCount() const {
+    return static_cast<unsigned int>(this->impl->threads.size());
+}
+
+
+/*
+ * TaskScheduler::IsWorkerThread
+ */
+bool TaskScheduler::IsWorkerThread() const {
+    return this->impl->isWorker();
+}
+
+
+/*
+ * TaskScheduler::Schedule
+ */
+void TaskScheduler::Schedule(std::function<void()> task, TaskPriority priority) const {
+    this->impl->push(TaskEntry{std::move(task), currentAccount}, priority);
+}
+
+
+/*
+ * TaskScheduler::RunPendingTask
+ */
+bool TaskScheduler::RunPendingTask(TaskPriority lowest) const {
+    // workers may block in a wait for tasks of any priority, so they have to help with all of them
+    if (this->impl->isWorker()) {
+        lowest = TaskPriority::Low;
+    }
+    TaskEntry entry;
+    if (!this->impl->pop(lowest, entry)) {
+        return false;
+    }
+    this->impl->execute(entry);
+    return true;
+}
+
+
+/*
+ * TaskScheduler::GetAccount
+ */
+TaskScheduler::Account* TaskScheduler::GetAccount(std::string const& name) const {
+    std::lock_guard<std::mutex> lock(this->impl->accountsLock);
+    auto& account = this->impl->accounts[name];
+    if (account == nullptr) {
+        account = std::make_unique<Account>(name);
+    }
+    return account.get();
+}
+
+
+/*
+ * TaskScheduler::CurrentAccount
+ */
+TaskScheduler::Account* TaskScheduler::CurrentAccount() {
+    return currentAccount;
+}
+
+
+/*
+ * TaskScheduler::AccountStatistics
+ */
+std::vector<std::tuple<std::string, uint64_t, uint64_t>> TaskScheduler::AccountStatistics() const {
+    std::vector<std::tuple<std::string, uint64_t, uint64_t>> statistics;
+    std::lock_guard<std::mutex> lock(this->impl->accountsLock);
+    statistics.reserve(this->impl->accounts.size());
+    for (auto const& [name, account] : this->impl->accounts) {
+        statistics.emplace_back(name, account->CpuTimeNs(), account->TaskCount());
+    }
+    return statistics;
+}
+
+
+/*
+ * TaskScheduler::ResetAccounts
+ */
+void TaskScheduler::ResetAccounts() const {
+    std::lock_guard<std::mutex> lock(this->impl->accountsLock);
+    for (auto const& entry : this->impl->accounts) {
+        entry.second->cpuTimeNs.store(0, std::memory_order_relaxed);
+        entry.second->tasks.store(0, std::memory_order_relaxed);
+    }
+}
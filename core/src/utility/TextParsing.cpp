@@ -0,0 +1,442 @@
+/*
+ * TextParsing.cpp
+ *
+ * Copyright (C) 2022 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#include "mmcore/utility/TextParsing.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "mmcore/utility/TaskScheduler.h"
+
+using namespace megamol::core::utility;
+
+namespace {
+
+inline char toLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+/** Powers of ten that are exactly representable as double. */
+constexpr double exactPowersOfTen[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13,
+    1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+/** Parses numbers the fast path does not handle, e.g. long mantissas, large exponents, inf and nan. */
+bool parseDoubleSlow(char const* begin, size_t length, double& value) {
+#ifdef __cpp_lib_to_chars
+    double result;
+    auto const res = std::from_chars(begin, begin + length, result);
+    if (res.ec != std::errc() || res.ptr != begin + length)
+        return false;
+#else
+    // the text is not terminated, strtod needs a terminated copy
+    char buffer[64];
+    if (length >= sizeof(buffer))
+        return false;
+    std::memcpy(buffer, begin, length);
+    buffer[length] = '\0';
+    char* parse_end = nullptr;
+    double const result = std::strtod(buffer, &parse_end);
+    if (parse_end != buffer + length)
+        return false;
+#endif
+    value = result;
+    return true;
+}
+
+} // namespace
+
+
+/*
+ * MappedFile
+ */
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(std::string const& filename) {
+    close();
+#ifdef _WIN32
+    auto const path = std::filesystem::u8path(filename);
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    m_file = file;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        close();
+        return false;
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+    if (m_size == 0) {
+        return true;
+    }
+    m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping == nullptr) {
+        close();
+        return false;
+    }
+    m_data = static_cast<char const*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr) {
+        close();
+        return false;
+    }
+#else
+    m_fd = ::open(filename.c_str(), O_RDONLY);
+    if (m_fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(m_fd, &info) != 0) {
+        close();
+        return false;
+    }
+    m_size = static_cast<size_t>(info.st_size);
+    if (m_size == 0) {
+        return true;
+    }
+    void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (mapping == MAP_FAILED) {
+        close();
+        return false;
+    }
+    m_data = static_cast<char const*>(mapping);
+    // text is parsed front to back
+    madvise(mapping, m_size, MADV_SEQUENTIAL);
+#endif
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping != nullptr) {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != nullptr) {
+        CloseHandle(m_file);
+    }
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    if (m_data != nullptr) {
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+    m_fd = -1;
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+
+/*
+ * Text splitting
+ */
+std::vector<size_t> megamol::core::utility::chunkAtLines(char const* data, size_t size, size_t min_chunk) {
+    auto const workers = TaskScheduler::Instance().WorkerCount() + 1;
+    auto const count = std::max<size_t>(1, std::min<size_t>(size / std::max<size_t>(1, min_chunk), 8 * workers));
+
+    std::vector<size_t> chunks;
+    chunks.reserve(count + 1);
+    chunks.push_back(0);
+    for (size_t c = 1; c < count; ++c) {
+        auto pos = std::max(chunks.back(), c * (size / count));
+        auto const* newline = static_cast<char const*>(std::memchr(data + pos, '\n', size - pos));
+        if (newline == nullptr)
+            break;
+        pos = static_cast<size_t>(newline - data) + 1;
+        if (pos > chunks.back() && pos < size) {
+            chunks.push_back(pos);
+        }
+    }
+    chunks.push_back(size);
+    return chunks;
+}
+
+std::vector<size_t> megamol::core::utility::lineOffsets(char const* data, size_t size) {
+    if (size == 0) {
+        return {};
+    }
+    auto const chunks = chunkAtLines(data, size);
+    std::vector<std::vector<size_t>> starts(chunks.size() - 1);
+    ParallelFor<size_t>(0, chunks.size() - 1, 1, [&](size_t first, size_t last) {
+        for (auto c = first; c < last; ++c) {
+            auto& local = starts[c];
+            local.push_back(chunks[c]);
+            auto const* cur = data + chunks[c];
+            auto const* const end = data + chunks[c + 1];
+            while (cur < end) {
+                auto const* newline = static_cast<char const*>(std::memchr(cur, '\n', end - cur));
+                if (newline == nullptr || newline + 1 >= end)
+                    break;
+                local.push_back(static_cast<size_t>(newline + 1 - data));
+                cur = newline + 1;
+            }
+        }
+    });
+
+    std::vector<size_t> lines;
+    size_t total = 0;
+    for (auto const& local : starts) {
+        total += local.size();
+    }
+    lines.reserve(total);
+    for (auto const& local : starts) {
+        lines.insert(lines.end(), local.begin(), local.end());
+    }
+    return lines;
+}
+
+std::string_view LineIndex::operator[](size_t line) const {
+    auto const begin = m_starts[line];
+    auto end = line + 1 < m_starts.size() ? m_starts[line + 1] - 1 : m_text.size();
+    if (end > begin && m_text[end - 1] == '\n')
+        --end;
+    if (end > begin && m_text[end - 1] == '\r')
+        --end;
+    return m_text.substr(begin, end - begin);
+}
+
+
+/*
+ * Fields and numbers
+ */
+std::string_view megamol::core::utility::trim(std::string_view text) {
+    size_t begin = 0;
+    size_t end = text.size();
+    while (begin < end && isWhitespace(text[begin]))
+        ++begin;
+    while (end > begin && isWhitespace(text[end - 1]))
+        --end;
+    return text.substr(begin, end - begin);
+}
+
+std::string_view megamol::core::utility::field(std::string_view line, size_t begin, size_t length) {
+    if (begin >= line.size())
+        return std::string_view();
+    return trim(line.substr(begin, length));
+}
+
+bool megamol::core::utility::parseDouble(std::string_view text, double& value) {
+    auto const* cur = text.data();
+    auto const* const end = cur + text.size();
+    // from_chars does not accept a leading '+'
+    if (cur < end && *cur == '+') {
+        ++cur;
+        if (cur < end && *cur == '-')
+            return false;
+    }
+    auto const* const number = cur;
+    bool const negative = cur < end && *cur == '-';
+    if (negative)
+        ++cur;
+
+    uint64_t mantissa = 0;
+    int significant = 0;
+    int exponent = 0;
+    bool digits = false;
+    bool exact = true;
+    for (; cur < end && *cur >= '0' && *cur <= '9'; ++cur) {
+        digits = true;
+        if (significant < 19) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*cur - '0');
+            significant += mantissa != 0;
+        } else {
+            exact = false;
+        }
+    }
+    if (cur < end && *cur == '.') {
+        ++cur;
+        for (; cur < end && *cur >= '0' && *cur <= '9'; ++cur) {
+            digits = true;
+            if (significant < 19) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*cur - '0');
+                significant += mantissa != 0;
+                --exponent;
+            } else {
+                exact = false;
+            }
+        }
+    }
+    if (!digits) {
+        // inf, nan or no number at all
+        return parseDoubleSlow(number, static_cast<size_t>(end - number), value);
+    }
+    if (cur < end && (*cur == 'e' || *cur == 'E')) {
+        ++cur;
+        bool const negativeExponent = cur < end && *cur == '-';
+        if (cur < end && (*cur == '-' || *cur == '+'))
+            ++cur;
+        if (cur == end || *cur < '0' || *cur > '9')
+            return false;
+        int e = 0;
+        for (; cur < end && *cur >= '0' && *cur <= '9'; ++cur) {
+            if (e < 100000)
+                e = e * 10 + (*cur - '0');
+        }
+        exponent += negativeExponent ? -e : e;
+    }
+    if (cur != end)
+        return false;
+
+    // Clinger's fast path: mantissa and power of ten are exact doubles, so one operation rounds correctly
+    if (exact && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+        double result = static_cast<double>(mantissa);
+        result = exponent < 0 ? result / exactPowersOfTen[-exponent] : result * exactPowersOfTen[exponent];
+        value = negative ? -result : result;
+        return true;
+    }
+    return parseDoubleSlow(number, static_cast<size_t>(end - number), value);
+}
+
+bool megamol::core::utility::parseFloat(std::string_view text, float& value) {
+    double tmp;
+    if (!parseDouble(text, tmp))
+        return false;
+    value = static_cast<float>(tmp);
+    return true;
+}
+
+bool megamol::core::utility::parseUInt(std::string_view text, uint64_t& value) {
+    auto const* cur = text.data();
+    auto const* const end = cur + text.size();
+    if (cur < end && *cur == '+')
+        ++cur;
+    if (cur == end)
+        return false;
+    uint64_t result = 0;
+    for (; cur < end; ++cur) {
+        if (*cur < '0' || *cur > '9')
+            return false;
+        auto const digit = static_cast<uint64_t>(*cur - '0');
+        if (result > (std::numeric_limits<uint64_t>::max() - digit) / 10)
+            return false;
+        result = result * 10 + digit;
+    }
+    value = result;
+    return true;
+}
+
+bool megamol::core::utility::parseInt(std::string_view text, int64_t& value) {
+    bool const negative = !text.empty() && text.front() == '-';
+    if (negative)
+        text.remove_prefix(1);
+    uint64_t magnitude;
+    if (!parseUInt(text, magnitude))
+        return false;
+    auto const limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + (negative ? 1 : 0);
+    if (magnitude > limit)
+        return false;
+    value = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+    return true;
+}
+
+
+/*
+ * TextCursor
+ */
+void TextCursor::skipBlanks() {
+    while (m_cur < m_end && isBlank(*m_cur)) {
+        ++m_cur;
+    }
+}
+
+void TextCursor::skipWhitespace() {
+    while (m_cur < m_end && isWhitespace(*m_cur)) {
+        ++m_cur;
+    }
+}
+
+void TextCursor::skipLine() {
+    auto const* newline = static_cast<char const*>(std::memchr(m_cur, '\n', m_end - m_cur));
+    m_cur = newline == nullptr ? m_end : newline + 1;
+}
+
+std::string_view TextCursor::line() {
+    auto const* begin = m_cur;
+    auto const* newline = static_cast<char const*>(std::memchr(m_cur, '\n', m_end - m_cur));
+    auto const* end = newline == nullptr ? m_end : newline;
+    m_cur = newline == nullptr ? m_end : newline + 1;
+    if (end > begin && end[-1] == '\r')
+        --end;
+    return std::string_view(begin, static_cast<size_t>(end - begin));
+}
+
+bool TextCursor::atLineEnd() {
+    skipBlanks();
+    return m_cur >= m_end || *m_cur == '\n';
+}
+
+std::string_view TextCursor::token() {
+    skipBlanks();
+    auto const* begin = m_cur;
+    while (m_cur < m_end && !isWhitespace(*m_cur)) {
+        ++m_cur;
+    }
+    return std::string_view(begin, static_cast<size_t>(m_cur - begin));
+}
+
+bool TextCursor::keyword(char const* keyword) {
+    skipBlanks();
+    auto const* cur = m_cur;
+    for (; *keyword != '\0'; ++keyword, ++cur) {
+        if (cur >= m_end || toLower(*cur) != *keyword)
+            return false;
+    }
+    if (cur < m_end && !isWhitespace(*cur))
+        return false;
+    m_cur = cur;
+    return true;
+}
+
+bool TextCursor::parseFloat(float& value) {
+    return megamol::core::utility::parseFloat(token(), value);
+}
+
+bool TextCursor::parseDouble(double& value) {
+    return megamol::core::utility::parseDouble(token(), value);
+}
+
+bool TextCursor::parseInt(int64_t& value) {
+    skipBlanks();
+    auto const* cur = m_cur;
+    bool negative = false;
+    if (cur < m_end && (*cur == '-' || *cur == '+')) {
+        negative = *cur == '-';
+        ++cur;
+    }
+    auto const* digits = cur;
+    int64_t result = 0;
+    while (cur < m_end && *cur >= '0' && *cur <= '9') {
+        result = result * 10 + (*cur - '0');
+        ++cur;
+    }
+    if (cur == digits)
+        return false;
+    value = negative ? -result : result;
+    m_cur = cur;
+    return true;
+}
@@ -7,12 +7,10 @@
 
 #include "mmcore/utility/sys/ThreadPool.h"
 
-#include <climits>
-#ifndef _WIN32
-#include <sched.h>
-#endif /* _WIN32 */
+#include <thread>
 
-#include "mmcore/utility/sys/SystemInformation.h"
+#include "mmcore/utility/TaskScheduler.h"
+#include "mmcore/utility/sys/Thread.h"
 #include "vislib/IllegalParamException.h"
 #include "vislib/IllegalStateException.h"
 #include "vislib/Trace.h"
@@ -26,10 +24,10 @@
  */
 vislib::sys::ThreadPool::ThreadPool(void)
         : cntActiveThreads(0)
+        , cntRunners(0)
         , cntTotalThreads(0)
         , evtAllCompleted(true)
-        , isQueueOpen(true)
-        , semBlockWorker(0l, LONG_MAX) {
+        , isQueueOpen(true) {
     // Nothing to do.
 }
 
@@ -51,14 +49,16 @@ SIZE_T vislib::sys::ThreadPool::AbortPendingUserWorkItems(void) {
     AutoLock lock(this->lockQueue);
 
     SingleLinkedList<WorkItem>::Iterator it = this->queue.GetIterator();
-    while (it.HasNext() && this->semBlockWorker.TryLock()) {
+    while (it.HasNext()) {
         WorkItem& workItem = it.Next();
         retval++;
         this->fireUserWorkItemAborted(workItem);
     }
+    this->queue.Clear();
 
-    for (SIZE_T i = 0; i < retval; i++) {
-        this->queue.RemoveFirst();
+    AutoLock counterLock(this->lockThreadCounters);
+    if (this->cntActiveThreads == 0) {
+        this->evtAllCompleted.Set();
     }
 
     return retval;
@@ -158,6 +158,7 @@ void vislib::sys::ThreadPool::RemoveListener(ThreadPoolListener* listener) {
  * vislib::sys::ThreadPool::SetThreadCount
  */
 void vislib::sys::ThreadPool::SetThreadCount(const SIZE_T threadCount) {
+    AutoLock queueLock(this->lockQueue);
     AutoLock lock(this->lockThreadCounters);
 
     if (threadCount < this->cntTotalThreads) {
@@ -166,8 +167,13 @@ void vislib::sys::ThreadPool::SetThreadCount(const SIZE_T threadCount) {
             __FILE__, __LINE__);
     }
 
-    for (; this->cntTotalThreads < threadCount; this->cntTotalThreads++) {
-        (new RunnableThread<Worker>())->Start(this);
+    this->cntTotalThreads = threadCount;
+
+    /* Start runners for work items which have been queued before. */
+    while ((this->cntRunners < this->cntTotalThreads) && (this->cntRunners < this->queue.Count())) {
+        this->cntRunners++;
+        megamol::core::utility::TaskScheduler::Instance().Schedule(
+            [this]() { this->runUserWorkItems(); }, megamol::core::utility::TaskPriority::Low);
     }
 }
 
@@ -182,123 +188,78 @@ void vislib::sys::ThreadPool::Terminate(const bool abortPending) {
     if (abortPending) {
         this->AbortPendingUserWorkItems();
     }
+    this->lockQueue.Unlock();
 
-    this->lockThreadCounters.Lock();
-    if (this->cntTotalThreads > 0) {
-        this->lockThreadCounters.Unlock();
-        this->lockQueue.Unlock();
-
-        this->Wait();
+    this->Wait();
 
-        this->lockQueue.Lock();
+    /* Runners signal completion before they leave, wait until none of them uses the pool anymore. */
+    while (true) {
         this->lockThreadCounters.Lock();
-        ASSERT(this->queue.IsEmpty());
-        ASSERT(!this->semBlockWorker.TryLock());
-
-        this->evtAllCompleted.Reset();
-        for (SIZE_T i = 0; i < this->cntTotalThreads; i++) {
-            this->semBlockWorker.Unlock();
+        const SIZE_T runners = this->cntRunners;
+        if (runners == 0) {
+            this->cntTotalThreads = 0;
         }
-
-        this->lockThreadCounters.Unlock();
-        this->lockQueue.Unlock();
-
-        this->evtAllCompleted.Wait();
-
-    } else {
         this->lockThreadCounters.Unlock();
-        this->lockQueue.Unlock();
+        if (runners == 0) {
+            break;
+        }
+        std::this_thread::yield();
     }
 }
 
 
 /*
- * vislib::sys::ThreadPool::Worker::Worker
- */
-vislib::sys::ThreadPool::Worker::Worker(void) : Runnable(), pool(NULL) {
-    // Nothing to do.
-}
-
-
-/*
- * vislib::sys::ThreadPool::Worker::~Worker
+ * vislib::sys::ThreadPool::runUserWorkItems
  */
-vislib::sys::ThreadPool::Worker::~Worker(void) {
-    // Nothing to do.
-}
-
-
-/*
- * DWORD vislib::sys::ThreadPool::Worker::Run
- */
-DWORD vislib::sys::ThreadPool::Worker::Run(void* pool) {
-    ASSERT(pool != NULL);
-    this->pool = static_cast<ThreadPool*>(pool);
-
-    VLTRACE(Trace::LEVEL_VL_INFO, "Worker thread [%u] started.\n", Thread::CurrentID());
+void vislib::sys::ThreadPool::runUserWorkItems(void) {
+    VLTRACE(Trace::LEVEL_VL_INFO, "ThreadPool runner started on thread [%u].\n", Thread::CurrentID());
 
     while (true) {
-
-        /* Wait for work. */
-        VLTRACE(Trace::LEVEL_VL_INFO,
-            "ThreadPool thread [%u] is waiting for "
-            "work ...\n",
-            Thread::CurrentID());
-        this->pool->semBlockWorker.Lock();
-
         /* Acquire locks. */
-        this->pool->lockQueue.Lock();
-        this->pool->lockThreadCounters.Lock();
-
-        /*
-         * We use an empty queue as trigger for a thread to leave: If we wake a
-         * thread and it does not find any work to do, it should exit.
-         */
-        if (this->pool->queue.IsEmpty()) {
-            VLTRACE(Trace::LEVEL_VL_INFO,
-                "ThreadPool thread [%u] is "
-                "exiting ...\n",
-                Thread::CurrentID());
-            if (--this->pool->cntTotalThreads == 0) {
-                this->pool->evtAllCompleted.Set();
+        this->lockQueue.Lock();
+        this->lockThreadCounters.Lock();
+
+        /* The runner leaves as soon as there is nothing left to do. */
+        if (this->queue.IsEmpty()) {
+            VLTRACE(Trace::LEVEL_VL_INFO, "ThreadPool runner on thread [%u] is exiting ...\n", Thread::CurrentID());
+            this->cntRunners--;
+            if (this->cntActiveThreads == 0) {
+                this->evtAllCompleted.Set();
             }
-            this->pool->lockThreadCounters.Unlock();
-            this->pool->lockQueue.Unlock();
-            delete this;
-            return 0;
+            this->lockThreadCounters.Unlock();
+            this->lockQueue.Unlock();
+            return;
         }
 
-        /* Get the work item and mark thread as active. */
-        ASSERT(!this->pool->queue.IsEmpty());
-        WorkItem workItem = this->pool->queue.First();
-        this->pool->queue.RemoveFirst();
-        this->pool->cntActiveThreads++;
+        /* Get the work item and mark runner as active. */
+        WorkItem workItem = this->queue.First();
+        this->queue.RemoveFirst();
+        this->cntActiveThreads++;
 
         /* Release locks while working. */
-        this->pool->lockThreadCounters.Unlock();
-        this->pool->lockQueue.Unlock();
+        this->lockThreadCounters.Unlock();
+        this->lockQueue.Unlock();
 
         /* Do the work. */
-        VLTRACE(Trace::LEVEL_VL_INFO, "ThreadPool thread [%u] is working ...\n", Thread::CurrentID());
         ASSERT((workItem.runnable != NULL) || (workItem.runnableFunction != NULL));
         DWORD exitCode = (workItem.runnable != NULL) ? workItem.runnable->Run(workItem.userData)
                                                      : workItem.runnableFunction(workItem.userData);
         VLTRACE(Trace::LEVEL_VL_INFO,
-            "ThreadPool thread [%u] completed work "
+            "ThreadPool runner on thread [%u] completed work "
             "item with exit code %u\n",
             Thread::CurrentID(), exitCode);
 
-        this->pool->fireUserWorkItemCompleted(workItem, exitCode);
+        this->fireUserWorkItemCompleted(workItem, exitCode);
 
-        /* Mark the thread as inactive and signal event if necessary. */
-        this->pool->lockQueue.Lock();
-        this->pool->lockThreadCounters.Lock();
-        if ((--this->pool->cntActiveThreads == 0) // SFX. Must be first!
-            && this->pool->queue.IsEmpty()) {
-            this->pool->evtAllCompleted.Set();
+        /* Mark the runner as inactive and signal event if necessary. */
+        this->lockQueue.Lock();
+        this->lockThreadCounters.Lock();
+        if ((--this->cntActiveThreads == 0) // SFX. Must be first!
+            && this->queue.IsEmpty()) {
+            this->evtAllCompleted.Set();
         }
-        this->pool->lockThreadCounters.Unlock();
-        this->pool->lockQueue.Unlock();
+        this->lockThreadCounters.Unlock();
+        this->lockQueue.Unlock();
     }
 }
 
@@ -368,12 +329,7 @@ void vislib::sys::ThreadPool::queueUserWorkItem(WorkItem& workItem, const bool c
     if (this->isQueueOpen) {
         this->queue.Append(workItem);
         this->evtAllCompleted.Reset(); // Signal unfinished work.
-        this->semBlockWorker.Unlock(); // Wake workers.
         this->lockQueue.Unlock();
-#ifndef _WIN32
-        // Linux has the most crap scheduler I have ever seen ...
-        sched_yield();
-#endif /* _WIN32 */
     } else {
         this->lockQueue.Unlock();
         throw IllegalStateException("The user work item queue has been closed, "
@@ -381,12 +337,16 @@ void vislib::sys::ThreadPool::queueUserWorkItem(WorkItem& workItem, const bool c
             __FILE__, __LINE__);
     }
 
-    /* Create threads if requested. */
+    /*
+     * Start another runner if the pool may execute more items concurrently.
+     * By default, the pool uses all workers of the task scheduler.
+     */
     this->lockThreadCounters.Lock();
-    if (createDefaultThreads && (this->cntTotalThreads < 1)) {
-        this->SetThreadCount(SystemInformation::ProcessorCount());
-    }
+    const SIZE_T threadCount = (createDefaultThreads && (this->cntTotalThreads < 1))
+                                   ? megamol::core::utility::TaskScheduler::Instance().WorkerCount()
+                                   : this->cntTotalThreads;
     this->lockThreadCounters.Unlock();
+    this->SetThreadCount(threadCount);
 }
 
 
@@ -133,6 +133,12 @@ view::AnimDataModule::Frame* view::AnimDataModule::requestLockedFrame(unsigned i
     }
     this->stateLock.Unlock();
 
+    if (((retval == NULL) || (retval->frame != idx)) && (idx < this->frameCnt)) {
+        // a substitute is returned while the loader thread fetches the requested frame,
+        // so callers need to ask again once it arrived
+        this->NotifyOutputChanged();
+    }
+
     if (deadlockwarning
 #if !(defined(DEBUG) || defined(_DEBUG))
         && (this->cacheSize < this->frameCnt)
@@ -0,0 +1,119 @@
+/*
+ * FrameScheduler.h
+ *
+ * Copyright (C) 2022 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include "FrontendResource.h"
+#include "FrontendResourcesLookup.h"
+
+#include "mmcore/CoreInstance.h"
+#include "mmcore/MegaMolGraph.h"
+#include "mmcore/param/ParamUpdateListener.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace megamol {
+namespace frontend {
+
+/**
+ * Decides for each iteration of the main loop which parts of a frame need to be executed.
+ *
+ * In lockstep mode the main loop renders every entry point, presents the images and starts over.
+ * The FrameScheduler decouples graph execution from UI and presentation:
+ * graph entry points (views) only get executed when something happened that may change their output,
+ * i.e. parameter changes, graph modifications, input events not consumed by the GUI, or a running animation.
+ * Parameter changes only re-execute the views whose upstream modules actually changed (see Module::ChangeEpoch),
+ * the other views keep presenting their previous image without touching their subgraph.
+ * Animation driven updates are capped to a configurable data update rate,
+ * so the GUI keeps running at its own rate while the graph updates at the rate of the data.
+ * When nothing happens at all, the main loop only polls for new inputs at a low rate and sleeps otherwise.
+ */
+class FrameScheduler : public megamol::core::param::ParamUpdateListener {
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct Config {
+        // max rate of graph updates caused by parameter changes or animations, 0 means unbounded
+        float data_update_fps = 0.0f;
+        // rate at which the main loop polls for inputs when nothing changes
+        float idle_fps = 10.0f;
+        // even an unchanged graph gets executed at this interval, e.g. to pick up data loaded in the background
+        float idle_graph_refresh_seconds = 1.0f;
+    };
+
+    enum class FrameKind {
+        Idle,   // nothing changed: neither execute entry points nor present images
+        UIOnly,      // execute non-graph entry points (GUI), present last graph images
+        Invalidated, // execute non-graph entry points and graph entry points whose upstream modules changed
+        Full,        // execute all entry points
+    };
+
+    FrameScheduler(megamol::core::CoreInstance& core, megamol::core::MegaMolGraph const& graph,
+        std::vector<megamol::frontend::FrontendResource> const& resources, Config const& config);
+    ~FrameScheduler() override;
+
+    FrameScheduler(FrameScheduler const&) = delete;
+    FrameScheduler& operator=(FrameScheduler const&) = delete;
+
+    // ParamUpdateListener
+    void ParamUpdated(megamol::core::param::ParamSlot& slot) override;
+
+    // call after services updated their provided resources, i.e. after new inputs have been polled
+    void observe_raw_inputs();
+
+    // call after services digested changed resources, i.e. after the GUI consumed the inputs it handles
+    FrameKind next_frame();
+
+    // the next call to next_frame() returns FrameKind::Full, e.g. requested via Lua
+    void request_full_frame();
+
+    // true if given entry point name belongs to a graph entry point (view)
+    bool is_graph_entry_point(std::string const& entry_point_name) const;
+
+    // true if the entry point needs to be executed in the current frame, see next_frame()
+    bool execute_entry_point(std::string const& entry_point_name);
+
+    // sleeps until the next poll if the current frame was idle
+    void wait_for_next_frame();
+
+private:
+    bool inputs_pending() const;
+    bool animation_running() const;
+    bool graph_structure_changed();
+    void update_entry_point_cache();
+
+    megamol::core::CoreInstance& m_core;
+    megamol::core::MegaMolGraph const& m_graph;
+    Config m_config;
+
+    std::vector<megamol::frontend::FrontendResource> m_input_resources;
+
+    std::atomic<bool> m_params_changed = true;
+    bool m_full_frame_requested = true;
+    bool m_ui_inputs = false;
+    bool m_ui_settle = false;
+    size_t m_module_count = 0;
+    size_t m_call_count = 0;
+    // graph entry points and their animation play parameters, updated when the graph structure changes
+    std::vector<std::weak_ptr<megamol::core::Module>> m_entry_points;
+    std::vector<megamol::core::param::ParamSlot*> m_play_slots;
+
+    FrameKind m_last_frame = FrameKind::Full;
+    // global change epoch at the start of the current frame and at the last execution of each graph entry point
+    uint64_t m_frame_epoch = 0;
+    std::unordered_map<std::string, uint64_t> m_executed_epochs;
+    clock::time_point m_last_graph_update;
+    clock::time_point m_next_wakeup;
+};
+
+} // namespace frontend
+} // namespace megamol
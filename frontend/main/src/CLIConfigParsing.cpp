@@ -122,7 +122,11 @@ static std::string remote_rendernode_zmq_source_option = "rendernode-zmq-source"
 static std::string remote_headnode_broadcast_quit_option = "headnode-broadcast-quit";
 static std::string remote_headnode_broadcast_project_option = "headnode-broadcast-project";
 static std::string remote_headnode_connect_at_start_option = "headnode-connect-at-start";
+static std::string decoupled_frames_option = "decoupled-frames";
+static std::string data_update_fps_option = "data-update-fps";
+static std::string idle_fps_option = "idle-fps";
 static std::string framebuffer_option = "framebuffer";
+static std::string shared_memory_sink_option = "shm-sink";
 static std::string viewport_tile_option = "tile";
 static std::string help_option = "h,help";
 
@@ -429,6 +433,38 @@ static void window_handler(
     }
 };
 
+static void decoupled_frames_handler(
+    std::string const& option_name, cxxopts::ParseResult const& parsed_options, RuntimeConfig& config) {
+    config.frame_scheduling_decoupled = parsed_options[option_name].as<bool>();
+};
+
+static void data_update_fps_handler(
+    std::string const& option_name, cxxopts::ParseResult const& parsed_options, RuntimeConfig& config) {
+    auto fps = parsed_options[option_name].as<float>();
+    if (fps < 0.0f) {
+        exit("data update fps must not be negative");
+    }
+    config.frame_scheduling_data_update_fps = fps;
+};
+
+static void idle_fps_handler(
+    std::string const& option_name, cxxopts::ParseResult const& parsed_options, RuntimeConfig& config) {
+    auto fps = parsed_options[option_name].as<float>();
+    if (fps <= 0.0f) {
+        exit("idle fps must be positive");
+    }
+    config.frame_scheduling_idle_fps = fps;
+};
+
+static void shared_memory_sink_handler(
+    std::string const& option_name, cxxopts::ParseResult const& parsed_options, RuntimeConfig& config) {
+    auto name = parsed_options[option_name].as<std::string>();
+    if (name.empty() || name.find('/', 1) != std::string::npos) {
+        exit("shared memory sink name must not be empty and must not contain '/' besides a leading one");
+    }
+    config.shared_memory_sink_name = name;
+};
+
 static void framebuffer_handler(
     std::string const& option_name, cxxopts::ParseResult const& parsed_options, RuntimeConfig& config) {
     auto string = parsed_options[option_name].as<std::string>();
@@ -545,8 +581,20 @@ std::vector<OptionsListEntry> cli_options_list =
             remote_head_broadcast_project_handler},
         {remote_headnode_connect_at_start_option, "Headnode starts sender thread at startup", cxxopts::value<bool>(),
             remote_head_connect_at_start_handler},
+        {decoupled_frames_option,
+            "Execute graph views only on input, parameter changes or running animations, keep GUI responsive "
+            "and sleep when idle",
+            cxxopts::value<bool>(), decoupled_frames_handler},
+        {data_update_fps_option, "Max rate of graph updates caused by animations or parameter changes, 0 = unbounded",
+            cxxopts::value<float>(), data_update_fps_handler},
+        {idle_fps_option, "Rate of input polling while nothing changes, default: 10", cxxopts::value<float>(),
+            idle_fps_handler},
         {framebuffer_option, "Size of framebuffer, syntax: --framebuffer WIDTHxHEIGHT", cxxopts::value<std::string>(),
             framebuffer_handler},
+        {shared_memory_sink_option,
+            "Publish rendered images to a POSIX shared memory ring buffer of given name, "
+            "see utils/shmimageconsumer for a consumer",
+            cxxopts::value<std::string>(), shared_memory_sink_handler},
         {viewport_tile_option,
             "Geometry of local viewport tile, syntax: --tile x,y:LWIDTHxLHEIGHT:GWIDTHxGHEIGHT"
             "where x,y is the lower left start pixel of the local tile, "
@@ -0,0 +1,246 @@
+/*
+ * FrameScheduler.cpp
+ *
+ * Copyright (C) 2022 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include "FrameScheduler.h"
+
+#include "Framebuffer_Events.h"
+#include "KeyboardMouse_Events.h"
+#include "Window_Events.h"
+
+#include "mmcore/param/BoolParam.h"
+#include "mmcore/utility/log/Log.h"
+
+#include <algorithm>
+#include <thread>
+
+static void log(std::string const& text) {
+    const std::string msg = "FrameScheduler: " + text;
+    megamol::core::utility::log::Log::DefaultLog.WriteInfo(msg.c_str());
+}
+
+namespace {
+using namespace megamol::frontend_resources;
+
+bool has_events(KeyboardEvents const& events) {
+    return !events.key_events.empty() || !events.codepoint_events.empty();
+}
+
+bool has_events(MouseEvents const& events) {
+    return !events.buttons_events.empty() || !events.position_events.empty() || !events.enter_events.empty() ||
+           !events.scroll_events.empty();
+}
+
+bool has_events(WindowEvents const& events) {
+    return !events.size_events.empty() || !events.is_focused_events.empty() || !events.is_iconified_events.empty() ||
+           !events.content_scale_events.empty() || !events.dropped_path_events.empty();
+}
+
+bool has_events(FramebufferEvents const& events) {
+    return !events.size_events.empty();
+}
+
+template<typename T>
+bool has_events(megamol::frontend::FrontendResource const& resource) {
+    auto maybe_events = resource.getOptionalResource<T>();
+    return maybe_events.has_value() && has_events(maybe_events.value().get());
+}
+
+std::chrono::duration<double> rate_to_interval(float fps) {
+    return std::chrono::duration<double>(fps > 0.0f ? 1.0 / fps : 0.0);
+}
+} // namespace
+
+namespace megamol {
+namespace frontend {
+
+FrameScheduler::FrameScheduler(megamol::core::CoreInstance& core, megamol::core::MegaMolGraph const& graph,
+    std::vector<megamol::frontend::FrontendResource> const& resources, Config const& config)
+        : m_core{core}
+        , m_graph{graph}
+        , m_config{config}
+        , m_last_graph_update{clock::now()}
+        , m_next_wakeup{clock::now()} {
+    // input resources may be missing in headless mode, so request them as optional
+    auto [success, input_resources] = megamol::frontend_resources::FrontendResourcesLookup{resources}
+                                          .get_requested_resources({"optional<KeyboardEvents>", "optional<MouseEvents>",
+                                              "optional<WindowEvents>", "optional<FramebufferEvents>"});
+    if (success && input_resources.size() == 4) {
+        m_input_resources = input_resources;
+    } else {
+        megamol::core::utility::log::Log::DefaultLog.WriteWarn(
+            "FrameScheduler: input resources not available, views only get executed on data changes");
+    }
+
+    m_core.RegisterParamUpdateListener(this);
+
+    log("decoupled frame scheduling with data update rate " +
+        (m_config.data_update_fps > 0.0f ? std::to_string(m_config.data_update_fps) + " fps" : "unbounded") +
+        ", idle poll rate " + std::to_string(m_config.idle_fps) + " fps");
+}
+
+FrameScheduler::~FrameScheduler() {
+    m_core.UnregisterParamUpdateListener(this);
+}
+
+void FrameScheduler::ParamUpdated(megamol::core::param::ParamSlot& slot) {
+    m_params_changed = true;
+}
+
+void FrameScheduler::observe_raw_inputs() {
+    // before the GUI consumed inputs: any input at all needs the GUI to run
+    m_ui_inputs = inputs_pending();
+}
+
+FrameScheduler::FrameKind FrameScheduler::next_frame() {
+    const auto now = clock::now();
+
+    // inputs left over after the GUI consumed its share go to the views and must not wait
+    const bool view_inputs = inputs_pending();
+    const bool structure_changed = graph_structure_changed();
+
+    const bool immediate_update = m_full_frame_requested || view_inputs || structure_changed;
+    const bool animation = animation_running();
+    // modules may also change their output without parameter changes, e.g. after loading data in the background
+    const bool modules_changed = megamol::core::Module::CurrentChangeEpoch() != m_frame_epoch;
+    const bool data_update = m_params_changed || modules_changed || animation;
+    const bool data_update_due = (now - m_last_graph_update) >= rate_to_interval(m_config.data_update_fps);
+    const bool refresh_due =
+        (now - m_last_graph_update) >= std::chrono::duration<double>(m_config.idle_graph_refresh_seconds);
+
+    FrameKind frame = FrameKind::Idle;
+    if (immediate_update || refresh_due || (data_update && data_update_due && animation)) {
+        frame = FrameKind::Full;
+    } else if (data_update && data_update_due) {
+        // parameter changes invalidate only the views depending on the changed modules
+        frame = FrameKind::Invalidated;
+    } else if (m_ui_inputs || m_ui_settle) {
+        // the GUI needs one more frame after the last input to settle, e.g. hover states
+        frame = FrameKind::UIOnly;
+    }
+    m_ui_settle = m_ui_inputs;
+
+    if (frame == FrameKind::Full || frame == FrameKind::Invalidated) {
+        m_frame_epoch = megamol::core::Module::CurrentChangeEpoch();
+        m_last_graph_update = now;
+        m_full_frame_requested = false;
+        m_params_changed = false;
+    }
+
+    // idle main loop wakes up for the next poll, or earlier if a pending data update becomes due
+    m_next_wakeup = now + std::chrono::duration_cast<clock::duration>(rate_to_interval(m_config.idle_fps));
+    if (data_update && !data_update_due) {
+        m_next_wakeup = std::min(m_next_wakeup,
+            m_last_graph_update +
+                std::chrono::duration_cast<clock::duration>(rate_to_interval(m_config.data_update_fps)));
+    }
+
+    m_last_frame = frame;
+    return frame;
+}
+
+void FrameScheduler::request_full_frame() {
+    m_full_frame_requested = true;
+}
+
+bool FrameScheduler::is_graph_entry_point(std::string const& entry_point_name) const {
+    auto const& modules = m_graph.ListModules();
+    return std::any_of(modules.begin(), modules.end(),
+        [&](auto const& module) { return module.isGraphEntryPoint && module.request.id == entry_point_name; });
+}
+
+bool FrameScheduler::execute_entry_point(std::string const& entry_point_name) {
+    if (!is_graph_entry_point(entry_point_name))
+        return m_last_frame != FrameKind::Idle;
+
+    switch (m_last_frame) {
+    case FrameKind::Full:
+        break;
+    case FrameKind::Invalidated: {
+        // changes made while the entry point executes have a newer epoch than the frame and invalidate it again
+        auto executed = m_executed_epochs.find(entry_point_name);
+        if (executed != m_executed_epochs.end() && m_graph.UpstreamChangeEpoch(entry_point_name) <= executed->second)
+            return false;
+        break;
+    }
+    default:
+        return false;
+    }
+
+    m_executed_epochs[entry_point_name] = m_frame_epoch;
+    return true;
+}
+
+void FrameScheduler::wait_for_next_frame() {
+    if (m_last_frame != FrameKind::Idle)
+        return;
+
+    std::this_thread::sleep_until(m_next_wakeup);
+}
+
+bool FrameScheduler::inputs_pending() const {
+    if (m_input_resources.size() != 4)
+        return false;
+
+    return has_events<KeyboardEvents>(m_input_resources[0]) || has_events<MouseEvents>(m_input_resources[1]) ||
+           has_events<WindowEvents>(m_input_resources[2]) || has_events<FramebufferEvents>(m_input_resources[3]);
+}
+
+bool FrameScheduler::animation_running() const {
+    // views own the TimeControl which advances the animation time without marking the parameter dirty
+    for (auto const* slot : m_play_slots) {
+        auto play = slot->Param<megamol::core::param::BoolParam>();
+        if (play != nullptr && play->Value())
+            return true;
+    }
+
+    return false;
+}
+
+bool FrameScheduler::graph_structure_changed() {
+    auto const& modules = m_graph.ListModules();
+    const auto module_count = modules.size();
+    const auto call_count = m_graph.ListCalls().size();
+
+    bool changed = module_count != m_module_count || call_count != m_call_count;
+    m_module_count = module_count;
+    m_call_count = call_count;
+
+    // counts stay the same if an entry point gets replaced within one frame, so also compare the entry points
+    size_t entry_point = 0;
+    for (auto const& module : modules) {
+        if (!module.isGraphEntryPoint)
+            continue;
+        changed = changed || entry_point >= m_entry_points.size() ||
+                  m_entry_points[entry_point].lock() != module.modulePtr;
+        ++entry_point;
+    }
+    changed = changed || entry_point != m_entry_points.size();
+
+    if (changed)
+        update_entry_point_cache();
+
+    return changed;
+}
+
+void FrameScheduler::update_entry_point_cache() {
+    m_entry_points.clear();
+    m_play_slots.clear();
+
+    for (auto const& module : m_graph.ListModules()) {
+        if (!module.isGraphEntryPoint)
+            continue;
+        m_entry_points.push_back(module.modulePtr);
+
+        auto slot =
+            std::dynamic_pointer_cast<megamol::core::param::ParamSlot>(module.modulePtr->FindChild("anim::play"));
+        if (slot != nullptr)
+            m_play_slots.push_back(slot.get());
+    }
+}
+
+} // namespace frontend
+} // namespace megamol
@@ -1,4 +1,5 @@
 #include "CLIConfigParsing.h"
+#include "FrameScheduler.h"
 #include "mmcore/LuaAPI.h"
 
 #include "mmcore/utility/log/DefaultTarget.h"
@@ -6,6 +7,7 @@
 
 #include "mmcore/CoreInstance.h"
 #include "mmcore/MegaMolGraph.h"
+#include "mmcore/utility/TaskScheduler.h"
 
 #include "GlobalValueStore.h"
 #include "RuntimeConfig.h"
@@ -131,6 +133,8 @@ int main(const int argc, const char** argv) {
     megamol::frontend::ImagePresentation_Service imagepresentation_service;
     megamol::frontend::ImagePresentation_Service::Config imagepresentationConfig;
     imagepresentationConfig.local_framebuffer_resolution = config.local_framebuffer_resolution;
+    if (!config.shared_memory_sink_name.empty())
+        imagepresentationConfig.shared_memory_sink_name = config.shared_memory_sink_name;
 
     // when there is no GL we should make sure the user defined some initial framebuffer size via CLI
     if (!with_gl) {
@@ -237,14 +241,24 @@ int main(const int argc, const char** argv) {
     };
     services.getProvidedResources().push_back({"FrontendResourcesList", resource_lister});
 
+    // with decoupled frame scheduling the scheduler decides which parts of a frame actually need to run.
+    // it gets created once all frontend resources are known, see below.
+    std::unique_ptr<megamol::frontend::FrameScheduler> frame_scheduler;
+    const auto scheduled_entry_points = [&](std::string const& entry_point) -> bool {
+        return frame_scheduler->execute_entry_point(entry_point);
+    };
+
     uint32_t frameID = 0;
-    const auto render_next_frame = [&]() -> bool {
+    const auto render_next_frame = [&](const bool force_graph_execution) -> bool {
         // set global Frame Counter
         core.SetFrameID(frameID++);
 
         // services: receive inputs (GLFW poll events [keyboard, mouse, window], network, lua)
         services.updateProvidedResources();
 
+        if (frame_scheduler)
+            frame_scheduler->observe_raw_inputs();
+
         // aka simulation step
         // services: digest new inputs via FrontendResources (GUI digest user inputs, lua digest inputs, network ?)
         // e.g. graph updates, module and call creation via lua and GUI happen here
@@ -254,26 +268,37 @@ int main(const int argc, const char** argv) {
         if (services.shouldShutdown())
             return false;
 
+        using FrameKind = megamol::frontend::FrameScheduler::FrameKind;
+        if (frame_scheduler && force_graph_execution)
+            frame_scheduler->request_full_frame();
+        const FrameKind frame_kind = frame_scheduler ? frame_scheduler->next_frame() : FrameKind::Full;
+
         // actual rendering
-        {
+        if (frame_kind != FrameKind::Idle) {
             services.preGraphRender(); // e.g. start frame timer, clear render buffers
 
-            imagepresentation_service
-                .RenderNextFrame(); // executes graph views, those digest input events like keyboard/mouse, then render
+            // executes graph views, those digest input events like keyboard/mouse, then render
+            if (frame_scheduler)
+                imagepresentation_service.RenderNextFrame(scheduled_entry_points);
+            else
+                imagepresentation_service.RenderNextFrame();
 
             services.postGraphRender(); // render GUI, glfw swap buffers, stop frame timer
-        }
 
-        imagepresentation_service
-            .PresentRenderedImages(); // draws rendering results to GLFW window, writes images to disk, sends images via network...
+            imagepresentation_service
+                .PresentRenderedImages(); // draws rendering results to GLFW window, writes images to disk, sends images via network...
+        }
 
         services.resetProvidedResources(); // clear buffers holding glfw keyboard+mouse input
 
+        if (frame_scheduler)
+            frame_scheduler->wait_for_next_frame(); // caps CPU usage while nothing changes
+
         return true;
     };
 
     // lua can issue rendering of frames, we provide a resource for this
-    const std::function<bool()> render_next_frame_func = [&]() -> bool { return render_next_frame(); };
+    const std::function<bool()> render_next_frame_func = [&]() -> bool { return render_next_frame(true); };
     services.getProvidedResources().push_back({"RenderNextFrame", render_next_frame_func});
 
     // image presentation service needs to assign frontend resources to entry points
@@ -297,6 +322,14 @@ int main(const int argc, const char** argv) {
         run_megamol = false;
     }
 
+    if (config.frame_scheduling_decoupled) {
+        megamol::frontend::FrameScheduler::Config schedulerConfig;
+        schedulerConfig.data_update_fps = config.frame_scheduling_data_update_fps;
+        schedulerConfig.idle_fps = config.frame_scheduling_idle_fps;
+        frame_scheduler =
+            std::make_unique<megamol::frontend::FrameScheduler>(core, graph, frontend_resources, schedulerConfig);
+    }
+
     // load project files via lua
     if (run_megamol && graph_resources_ok)
         for (auto& file : config.project_files) {
@@ -324,11 +357,19 @@ int main(const int argc, const char** argv) {
         }
 
     while (run_megamol) {
-        run_megamol = render_next_frame();
+        run_megamol = render_next_frame(false);
     }
 
+    frame_scheduler.reset();
     graph.Clear();
 
+    for (auto const& [account, cpu_time_ns, tasks] :
+        megamol::core::utility::TaskScheduler::Instance().AccountStatistics()) {
+        if (tasks > 0)
+            log("task CPU time of " + account + ": " + std::to_string(cpu_time_ns / 1000000) + " ms in " +
+                std::to_string(tasks) + " tasks");
+    }
+
     // close glfw context, network connections, other system resources
     services.close();
 
@@ -9,6 +9,8 @@
 
 #include <vector>
 
+#include "mmcore/utility/StreamingStatistics.h"
+
 namespace megamol {
 namespace frontend_resources {
 
@@ -19,7 +21,18 @@ struct FrameStatistics {
     double last_rendered_frame_time_milliseconds = 0.0;
     double last_averaged_fps = 0.0;
     double last_averaged_mspf = 0.0;
+
+    // frame time distribution over roughly the last few hundred frames
+    double frame_time_p50_milliseconds = 0.0;
+    double frame_time_p95_milliseconds = 0.0;
+    double frame_time_p99_milliseconds = 0.0;
+    double frame_time_min_milliseconds = 0.0;
+    double frame_time_max_milliseconds = 0.0;
 };
 
+// copy of the latest FrameStatistics that may be read from any thread without locking,
+// provided as resource "FrameStatisticsSnapshot"
+using FrameStatisticsSnapshot = megamol::core::utility::SeqLockSnapshot<FrameStatistics>;
+
 } /* end namespace frontend_resources */
 } /* end namespace megamol */
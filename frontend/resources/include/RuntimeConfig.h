@@ -77,6 +77,11 @@ struct RuntimeConfig {
     bool show_version_note = true;
     std::string profiling_output_file;
 
+    // decoupled frame scheduling: graph views only get executed when inputs, parameters or animations demand it
+    bool frame_scheduling_decoupled = false;
+    float frame_scheduling_data_update_fps = 0.0f; // 0 => graph updates as fast as the main loop runs
+    float frame_scheduling_idle_fps = 10.0f;       // input polling rate when nothing changes
+
     struct Tile {
         UintPair global_framebuffer_resolution; // e.g. whole powerwall resolution, needed for tiling
         UintPair tile_start_pixel;
@@ -87,6 +92,9 @@ struct RuntimeConfig {
     // e.g. window resolution or powerwall projector resolution, will be applied to all views/entry points
     std::optional<UintPair> local_framebuffer_resolution = std::nullopt;
 
+    // publish rendered images to POSIX shared memory segment of this name, empty => disabled
+    std::string shared_memory_sink_name = "";
+
     bool remote_headnode = false;
     bool remote_rendernode = false;
     bool remote_mpirendernode = false;
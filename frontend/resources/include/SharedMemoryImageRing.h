@@ -0,0 +1,93 @@
+/*
+ * SharedMemoryImageRing.h
+ *
+ * Copyright (C) 2022 by VISUS (Universitaet Stuttgart).
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace megamol {
+namespace frontend_resources {
+namespace shared_memory_image_ring {
+
+// Memory layout of the shared memory segment written by the shared memory image presentation sink.
+// This header has no dependencies besides the standard library so that external consumer processes
+// (video encoders, streaming servers) can include it directly.
+//
+// The segment starts with a RingHeader, followed by slot_count image slots of slot_capacity bytes each.
+// Every image presented by MegaMol goes into the next slot of the ring, images of the same frame share the frame_id.
+// Each slot is protected by a sequence lock: the sequence is odd while the producer writes the slot.
+// A consumer reads the sequence, copies the pixels and checks afterwards that the sequence did not change before it
+// uses the copy, otherwise the producer overwrote the slot in the meantime and the copy may be torn.
+// After each presented frame the producer posts the named POSIX semaphore semaphore_name(segment name).
+
+constexpr uint32_t Magic = 0x48534d4d; // "MMSH"
+constexpr uint32_t Version = 1;
+constexpr uint32_t MaxSlots = 16;
+constexpr std::size_t DataAlignment = 4096;
+
+enum class PixelFormat : uint32_t {
+    RGB8 = 0,
+    RGBA8 = 1,
+};
+
+enum class RingState : uint32_t {
+    Active = 1,
+    // the producer replaced the segment, e.g. because images got larger, or shut down. consumers need to reopen.
+    Closed = 2,
+};
+
+struct SlotHeader {
+    std::atomic<uint64_t> sequence;
+    uint64_t frame_id;
+    int64_t timestamp_ns; // steady clock of the producer, CLOCK_MONOTONIC on Linux
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;      // PixelFormat
+    uint32_t image_index; // index of this image within its frame
+    uint32_t image_count; // number of images of the frame
+    uint32_t padding;
+    uint64_t data_size;   // bytes of pixel data, rows are tightly packed, GL rendered images start with the bottom row
+    uint64_t data_offset; // offset of pixel data from start of the segment
+};
+
+struct RingHeader {
+    uint32_t magic;
+    uint32_t version;
+    std::atomic<uint32_t> state; // RingState
+    uint32_t slot_count;
+    uint64_t slot_capacity;
+    uint64_t segment_size;
+    // number of images written so far, the latest image is in slot (published - 1) % slot_count
+    std::atomic<uint64_t> published;
+    SlotHeader slots[MaxSlots];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+    "shared memory image ring needs address free atomics");
+
+inline std::size_t data_offset() {
+    return (sizeof(RingHeader) + DataAlignment - 1) / DataAlignment * DataAlignment;
+}
+
+inline std::size_t segment_size(uint32_t slot_count, uint64_t slot_capacity) {
+    return data_offset() + static_cast<std::size_t>(slot_count * slot_capacity);
+}
+
+inline std::string semaphore_name(std::string const& segment_name) {
+    return segment_name + "_frames";
+}
+
+inline uint32_t bytes_per_pixel(PixelFormat format) {
+    return format == PixelFormat::RGB8 ? 3 : 4;
+}
+
+} // namespace shared_memory_image_ring
+} /* end namespace frontend_resources */
+} /* end namespace megamol */
@@ -9,7 +9,7 @@
 // you should also delete the FAQ comments in these template files after you read and understood them
 #include "FrameStatistics_Service.hpp"
 
-#include <numeric>
+#include "LuaCallbacksCollection.h"
 
 
 // local logging wrapper for your convenience until central MegaMol logger established
@@ -40,6 +40,7 @@ bool FrameStatistics_Service::init(const Config& config) {
 
     this->m_requestedResourcesNames = {
         //"IOpenGL_Context", // for GL-specific measures?
+        "RegisterLuaCallbacks",
     };
 
     m_program_start_time = std::chrono::high_resolution_clock::now();
@@ -51,7 +52,8 @@ bool FrameStatistics_Service::init(const Config& config) {
 void FrameStatistics_Service::close() {}
 
 std::vector<FrontendResource>& FrameStatistics_Service::getProvidedResources() {
-    m_providedResourceReferences = {{"FrameStatistics", m_statistics}};
+    m_providedResourceReferences = {
+        {"FrameStatistics", m_statistics}, {"FrameStatisticsSnapshot", m_statistics_snapshot}};
 
     return m_providedResourceReferences;
 }
@@ -62,6 +64,8 @@ const std::vector<std::string> FrameStatistics_Service::getRequestedResourceName
 
 void FrameStatistics_Service::setRequestedResources(std::vector<FrontendResource> resources) {
     this->m_requestedResourceReferences = resources;
+
+    fill_lua_callbacks();
 }
 
 void FrameStatistics_Service::updateProvidedResources() {
@@ -98,12 +102,60 @@ void FrameStatistics_Service::finish_frame() {
 
     m_statistics.last_rendered_frame_time_milliseconds = last_frame_till_now_micro / static_cast<double>(1000);
 
-    m_frame_times_micro[m_ring_buffer_ptr] = last_frame_till_now_micro;
-    m_ring_buffer_ptr = (m_ring_buffer_ptr + 1) % m_frame_times_micro.size();
+    m_frame_times_micro.push(static_cast<double>(last_frame_till_now_micro));
+    m_frame_times_window_micro.push(static_cast<double>(last_frame_till_now_micro));
+    m_frame_time_p50.push(m_statistics.last_rendered_frame_time_milliseconds);
+    m_frame_time_p95.push(m_statistics.last_rendered_frame_time_milliseconds);
+    m_frame_time_p99.push(m_statistics.last_rendered_frame_time_milliseconds);
 
-    m_statistics.last_averaged_mspf = std::accumulate(m_frame_times_micro.begin(), m_frame_times_micro.end(), 0) /
-                                      m_frame_times_micro.size() / static_cast<double>(1000);
+    m_statistics.last_averaged_mspf = m_frame_times_micro.avg() / static_cast<double>(1000);
     m_statistics.last_averaged_fps = 1000.0 / m_statistics.last_averaged_mspf;
+
+    m_statistics.frame_time_p50_milliseconds = m_frame_time_p50.value();
+    m_statistics.frame_time_p95_milliseconds = m_frame_time_p95.value();
+    m_statistics.frame_time_p99_milliseconds = m_frame_time_p99.value();
+    m_statistics.frame_time_min_milliseconds = m_frame_times_window_micro.min() / static_cast<double>(1000);
+    m_statistics.frame_time_max_milliseconds = m_frame_times_window_micro.max() / static_cast<double>(1000);
+
+    m_statistics_snapshot.publish(m_statistics);
+}
+
+void FrameStatistics_Service::fill_lua_callbacks() {
+    using megamol::frontend_resources::LuaCallbacksCollection;
+    using Error = megamol::frontend_resources::LuaCallbacksCollection::Error;
+    using DoubleResult = megamol::frontend_resources::LuaCallbacksCollection::DoubleResult;
+
+    LuaCallbacksCollection callbacks;
+
+    callbacks.add<DoubleResult, std::string>("mmGetFrameTime",
+        "(string metric)\n\tReturns frame time statistics in milliseconds over the recent frames. metric is one of: "
+        "last, average, min, max, p50, p95, p99",
+        {[&](std::string metric) -> DoubleResult {
+            const auto statistics = m_statistics_snapshot.read();
+
+            if (metric == "last")
+                return DoubleResult{statistics.last_rendered_frame_time_milliseconds};
+            if (metric == "average")
+                return DoubleResult{statistics.last_averaged_mspf};
+            if (metric == "min")
+                return DoubleResult{statistics.frame_time_min_milliseconds};
+            if (metric == "max")
+                return DoubleResult{statistics.frame_time_max_milliseconds};
+            if (metric == "p50")
+                return DoubleResult{statistics.frame_time_p50_milliseconds};
+            if (metric == "p95")
+                return DoubleResult{statistics.frame_time_p95_milliseconds};
+            if (metric == "p99")
+                return DoubleResult{statistics.frame_time_p99_milliseconds};
+
+            return Error{"unknown frame time metric: " + metric};
+        }});
+
+    auto& register_callbacks =
+        m_requestedResourceReferences[0]
+            .getResource<std::function<void(megamol::frontend_resources::LuaCallbacksCollection const&)>>();
+
+    register_callbacks(callbacks);
 }
 
 } // namespace frontend
@@ -11,7 +11,6 @@
 
 #include "FrameStatistics.h"
 
-#include <array>
 #include <chrono>
 
 namespace megamol {
@@ -66,11 +65,17 @@ private:
     std::chrono::high_resolution_clock::time_point m_program_start_time;
     std::chrono::high_resolution_clock::time_point m_frame_start_time;
 
-    std::array<long long, 30> m_frame_times_micro = {};
-    unsigned int m_ring_buffer_ptr = 0;
+    // all statistics live in fixed-size storage, so finishing a frame does not touch the heap
+    megamol::core::utility::RollingStatistics<double, 30> m_frame_times_micro;
+    megamol::core::utility::RollingStatistics<double, 300> m_frame_times_window_micro;
+    megamol::core::utility::SlidingP2Quantile<double> m_frame_time_p50{0.50, 1000};
+    megamol::core::utility::SlidingP2Quantile<double> m_frame_time_p95{0.95, 1000};
+    megamol::core::utility::SlidingP2Quantile<double> m_frame_time_p99{0.99, 1000};
+    megamol::frontend_resources::FrameStatisticsSnapshot m_statistics_snapshot;
 
     void start_frame();
     void finish_frame();
+    void fill_lua_callbacks();
 
     std::vector<FrontendResource> m_providedResourceReferences;
     std::vector<std::string> m_requestedResourcesNames;
@@ -11,6 +11,7 @@
 #include "WindowManipulation.h"
 
 #include "ImagePresentation_Sinks.hpp"
+#include "SharedMemoryImageSink.hpp"
 #include "ImageWrapper_to_GLTexture.hpp"
 #include "OpenGL_Context.h"
 
@@ -120,6 +121,8 @@ bool ImagePresentation_Service::init(const Config& config) {
         m_framebuffer_size_handler = [=]() -> UintPair { return {value.first, value.second}; };
     }
 
+    m_shared_memory_sink_name = config.shared_memory_sink_name;
+
     auto initial_fbo_size = m_framebuffer_size_handler();
     m_global_framebuffer_events.size_events.push_back(
         {static_cast<int>(initial_fbo_size.first), static_cast<int>(initial_fbo_size.second)});
@@ -149,6 +152,7 @@ void ImagePresentation_Service::setRequestedResources(std::vector<FrontendResour
     m_window_framebuffer_size = {framebuffer_events.previous_state.width, framebuffer_events.previous_state.height};
 
     add_glfw_sink();
+    add_shared_memory_sink();
 
     fill_lua_callbacks();
 }
@@ -180,6 +184,17 @@ void ImagePresentation_Service::RenderNextFrame() {
     }
 }
 
+void ImagePresentation_Service::RenderNextFrame(EntryPointFilter const& filter) {
+    for (auto& entry : m_entry_points) {
+        if (!filter(entry.moduleName))
+            continue;
+
+        entry.entry_point_data->update();
+
+        entry.execute(entry.modulePtr, entry.entry_point_resources, entry.execution_result_image);
+    }
+}
+
 void ImagePresentation_Service::PresentRenderedImages() {
     // before presenting to the sinks, we need to apply the latest global fbo size changes
     // this way sinks can access the current fbo size as previous_state
@@ -372,6 +387,21 @@ void ImagePresentation_Service::add_glfw_sink() {
         {"GLFW Window Presentation Sink", [&](auto const& images) { this->present_images_to_glfw_window(images); }});
 }
 
+void ImagePresentation_Service::add_shared_memory_sink() {
+    if (!m_shared_memory_sink_name.has_value())
+        return;
+
+    m_shared_memory_sink = std::make_shared<shared_memory_image_sink>(m_shared_memory_sink_name.value());
+    if (!m_shared_memory_sink->is_available()) {
+        log_warning("shared memory sink " + m_shared_memory_sink_name.value() + " not available");
+        m_shared_memory_sink.reset();
+        return;
+    }
+
+    m_presentation_sinks.push_back({"Shared Memory Presentation Sink",
+        [sink = m_shared_memory_sink](auto const& images) { sink->present_images(images); }});
+}
+
 void ImagePresentation_Service::present_images_to_glfw_window(std::vector<ImageWrapper> const& images) {
     static auto const& window_manipulation = m_requestedResourceReferences[1]
                                                  .getOptionalResource<megamol::frontend_resources::WindowManipulation>()
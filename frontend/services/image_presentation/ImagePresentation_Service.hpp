@@ -19,10 +19,13 @@
 #include "Framebuffer_Events.h"
 
 #include <list>
+#include <memory>
 
 namespace megamol {
 namespace frontend {
 
+struct shared_memory_image_sink;
+
 class ImagePresentation_Service final : public AbstractFrontendService {
 public:
     using UintPair = std::pair<unsigned int, unsigned int>;
@@ -44,6 +47,9 @@ public:
 
         // e.g. window resolution or powerwall projector resolution, will be applied to all views/entry points
         std::optional<UintPair> local_framebuffer_resolution = std::nullopt;
+
+        // name of POSIX shared memory segment to publish rendered images to, for local video encoders etc.
+        std::optional<std::string> shared_memory_sink_name = std::nullopt;
     };
 
     std::string serviceName() const override {
@@ -73,6 +79,11 @@ public:
     void RenderNextFrame();
     void PresentRenderedImages();
 
+    // executes only the entry points accepted by the filter, the others keep presenting their last result image.
+    // used by the main loop to keep the GUI running while graph views wait for new data.
+    using EntryPointFilter = std::function<bool(std::string const& /*entry point name*/)>;
+    void RenderNextFrame(EntryPointFilter const& filter);
+
     // int setPriority(const int p) // priority initially 0
     // int getPriority() const;
     //
@@ -111,6 +122,10 @@ private:
     void add_glfw_sink();
     void present_images_to_glfw_window(std::vector<ImageWrapper> const& images);
 
+    std::optional<std::string> m_shared_memory_sink_name;
+    std::shared_ptr<shared_memory_image_sink> m_shared_memory_sink;
+    void add_shared_memory_sink();
+
     std::tuple<bool,                                            // success
         std::vector<FrontendResource>,                          // resources
         std::unique_ptr<frontend_resources::RenderInputsUpdate> // unique_data for entry point
@@ -0,0 +1,266 @@
+/*
+ * SharedMemoryImageSink.cpp
+ *
+ * Copyright (C) 2022 by VISUS (Universitaet Stuttgart).
+ * Alle Rechte vorbehalten.
+ */
+
+#include "SharedMemoryImageSink.hpp"
+
+#include "ImageWrapper_Conversion_Helpers.hpp"
+
+#include "mmcore/utility/log/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace megamol::frontend_resources;
+namespace ring = megamol::frontend_resources::shared_memory_image_ring;
+
+#ifdef WITH_GL
+// implemented in ImageWrapper_to_GLTexture.cpp
+namespace gl_wrapper_impl {
+void gl_download_texture_to_buffer(unsigned int handle, ImageWrapper::ImageSize size,
+    ImageWrapper::DataChannels channels, void* target, size_t target_size);
+} // namespace gl_wrapper_impl
+#endif
+
+static const std::string sink_name = "SharedMemoryImageSink: ";
+static void log(std::string const& text) {
+    const std::string msg = sink_name + text;
+    megamol::core::utility::log::Log::DefaultLog.WriteInfo(msg.c_str());
+}
+
+static void log_error(std::string const& text) {
+    const std::string msg = sink_name + text;
+    megamol::core::utility::log::Log::DefaultLog.WriteError(msg.c_str());
+}
+
+namespace {
+bool pixel_format(ImageWrapper::DataChannels channels, ring::PixelFormat& format) {
+    switch (channels) {
+    case ImageWrapper::DataChannels::RGB8:
+        format = ring::PixelFormat::RGB8;
+        return true;
+    case ImageWrapper::DataChannels::RGBA8:
+        format = ring::PixelFormat::RGBA8;
+        return true;
+    default:
+        return false;
+    }
+}
+
+uint64_t image_bytes(ImageWrapper const& image) {
+    ring::PixelFormat format;
+    if (!pixel_format(image.channels, format))
+        return 0;
+    return static_cast<uint64_t>(image.size.width) * image.size.height * ring::bytes_per_pixel(format);
+}
+} // namespace
+
+namespace megamol::frontend {
+
+#ifndef _WIN32
+
+shared_memory_image_sink::shared_memory_image_sink(std::string const& segment_name)
+        : m_segment_name{segment_name.empty() || segment_name[0] != '/' ? "/" + segment_name : segment_name} {
+    const auto semaphore_name = ring::semaphore_name(m_segment_name);
+    sem_unlink(semaphore_name.c_str());
+    sem_t* semaphore = sem_open(semaphore_name.c_str(), O_CREAT, 0600, 0);
+    if (semaphore == SEM_FAILED) {
+        log_error("could not create semaphore " + semaphore_name + ": " + std::strerror(errno));
+        m_failed = true;
+        return;
+    }
+    m_semaphore = semaphore;
+
+    log("publishing images to shared memory segment " + m_segment_name + ", notifying via semaphore " +
+        semaphore_name);
+}
+
+shared_memory_image_sink::~shared_memory_image_sink() {
+    close_segment();
+
+    if (m_semaphore != nullptr) {
+        sem_close(static_cast<sem_t*>(m_semaphore));
+        sem_unlink(ring::semaphore_name(m_segment_name).c_str());
+        m_semaphore = nullptr;
+    }
+}
+
+bool shared_memory_image_sink::is_available() const {
+    return !m_failed;
+}
+
+bool shared_memory_image_sink::open_segment(uint32_t slot_count, uint64_t slot_capacity) {
+    const auto size = ring::segment_size(slot_count, slot_capacity);
+
+    shm_unlink(m_segment_name.c_str());
+    m_segment_fd = shm_open(m_segment_name.c_str(), O_CREAT | O_RDWR, 0600);
+    if (m_segment_fd < 0) {
+        log_error("could not create shared memory segment " + m_segment_name + ": " + std::strerror(errno));
+        return false;
+    }
+
+    void* mapping = MAP_FAILED;
+    if (ftruncate(m_segment_fd, static_cast<off_t>(size)) == 0) {
+        mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_segment_fd, 0);
+    }
+    if (mapping == MAP_FAILED) {
+        log_error("could not map shared memory segment " + m_segment_name + " of " + std::to_string(size) +
+                  " bytes: " + std::strerror(errno));
+        close(m_segment_fd);
+        m_segment_fd = -1;
+        shm_unlink(m_segment_name.c_str());
+        return false;
+    }
+
+    m_segment_size = size;
+    m_header = new (mapping) ring::RingHeader{};
+    m_header->magic = ring::Magic;
+    m_header->version = ring::Version;
+    m_header->slot_count = slot_count;
+    m_header->slot_capacity = slot_capacity;
+    m_header->segment_size = size;
+    for (uint32_t i = 0; i < slot_count; ++i) {
+        m_header->slots[i].data_offset = ring::data_offset() + i * slot_capacity;
+    }
+    m_header->state.store(static_cast<uint32_t>(ring::RingState::Active), std::memory_order_release);
+
+    log("created shared memory segment with " + std::to_string(slot_count) + " slots of " +
+        std::to_string(slot_capacity) + " bytes");
+    return true;
+}
+
+void shared_memory_image_sink::close_segment() {
+    if (m_header == nullptr)
+        return;
+
+    // consumers still mapping the unlinked segment learn that they need to reopen it
+    m_header->state.store(static_cast<uint32_t>(ring::RingState::Closed), std::memory_order_release);
+    if (m_semaphore != nullptr)
+        sem_post(static_cast<sem_t*>(m_semaphore));
+
+    munmap(m_header, m_segment_size);
+    close(m_segment_fd);
+    shm_unlink(m_segment_name.c_str());
+
+    m_header = nullptr;
+    m_segment_fd = -1;
+    m_segment_size = 0;
+}
+
+bool shared_memory_image_sink::write_image(ImageWrapper const& image, unsigned char* target, uint64_t size) {
+    switch (image.type) {
+    case WrappedImageType::ByteArray: {
+        auto const& bytes = *conversion::to_vector(image.referenced_image_handle);
+        std::memcpy(target, bytes.data(), std::min<uint64_t>(size, bytes.size()));
+        return true;
+    }
+    case WrappedImageType::GLTexureHandle:
+#ifdef WITH_GL
+        gl_wrapper_impl::gl_download_texture_to_buffer(
+            conversion::to_uint(image.referenced_image_handle), image.size, image.channels, target, size);
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+void shared_memory_image_sink::present_images(std::vector<ImageWrapper> const& images) {
+    if (m_failed || images.empty())
+        return;
+
+    uint64_t needed_capacity = 0;
+    for (auto const& image : images) {
+        needed_capacity = std::max(needed_capacity, image_bytes(image));
+    }
+    needed_capacity = (needed_capacity + ring::DataAlignment - 1) / ring::DataAlignment * ring::DataAlignment;
+    // keep a few frames in the ring so a consumer may lag behind a bit
+    const auto slot_count = std::clamp<uint32_t>(static_cast<uint32_t>(3 * images.size()), 3, ring::MaxSlots);
+
+    if (m_header == nullptr || needed_capacity > m_header->slot_capacity || slot_count > m_header->slot_count) {
+        close_segment();
+        if (!open_segment(slot_count, needed_capacity)) {
+            m_failed = true;
+            return;
+        }
+    }
+
+    const auto frame_id = m_frame_id++;
+    const auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+                               .count();
+    auto* const segment = reinterpret_cast<unsigned char*>(m_header);
+
+    for (uint32_t i = 0; i < images.size(); ++i) {
+        auto const& image = images[i];
+        ring::PixelFormat format;
+        if (!pixel_format(image.channels, format))
+            continue;
+
+        const auto published = m_header->published.load(std::memory_order_relaxed);
+        auto& slot = m_header->slots[published % m_header->slot_count];
+
+        const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.frame_id = frame_id;
+        slot.timestamp_ns = timestamp;
+        slot.width = static_cast<uint32_t>(image.size.width);
+        slot.height = static_cast<uint32_t>(image.size.height);
+        slot.format = static_cast<uint32_t>(format);
+        slot.image_index = i;
+        slot.image_count = static_cast<uint32_t>(images.size());
+        slot.data_size = image_bytes(image);
+        if (!write_image(image, segment + slot.data_offset, slot.data_size))
+            slot.data_size = 0;
+
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+        m_header->published.store(published + 1, std::memory_order_release);
+    }
+
+    sem_post(static_cast<sem_t*>(m_semaphore));
+}
+
+#else // _WIN32
+
+shared_memory_image_sink::shared_memory_image_sink(std::string const& segment_name) : m_segment_name{segment_name} {
+    log_error("shared memory image presentation is only supported on POSIX systems");
+    m_failed = true;
+}
+
+shared_memory_image_sink::~shared_memory_image_sink() {}
+
+bool shared_memory_image_sink::is_available() const {
+    return false;
+}
+
+bool shared_memory_image_sink::open_segment(uint32_t slot_count, uint64_t slot_capacity) {
+    return false;
+}
+
+void shared_memory_image_sink::close_segment() {}
+
+bool shared_memory_image_sink::write_image(ImageWrapper const& image, unsigned char* target, uint64_t size) {
+    return false;
+}
+
+void shared_memory_image_sink::present_images(std::vector<ImageWrapper> const& images) {}
+
+#endif // _WIN32
+
+} // namespace megamol::frontend
@@ -0,0 +1,49 @@
+/*
+ * SharedMemoryImageSink.hpp
+ *
+ * Copyright (C) 2022 by VISUS (Universitaet Stuttgart).
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include "ImageWrapper.h"
+#include "SharedMemoryImageRing.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace megamol::frontend {
+
+// Presents images by publishing them into a POSIX shared memory ring buffer (see SharedMemoryImageRing.h),
+// so local processes like video encoders or streaming servers can read the pixels without further copies.
+// GL textures are downloaded directly into the shared memory slots, byte images are copied once.
+// The segment is created with the first presented frame and recreated if the images do not fit anymore.
+struct shared_memory_image_sink {
+    explicit shared_memory_image_sink(std::string const& segment_name);
+    ~shared_memory_image_sink();
+
+    shared_memory_image_sink(shared_memory_image_sink const&) = delete;
+    shared_memory_image_sink& operator=(shared_memory_image_sink const&) = delete;
+
+    // false if shared memory is not supported on this platform
+    bool is_available() const;
+
+    void present_images(std::vector<frontend_resources::ImageWrapper> const& images);
+
+private:
+    bool open_segment(uint32_t slot_count, uint64_t slot_capacity);
+    void close_segment();
+    bool write_image(frontend_resources::ImageWrapper const& image, unsigned char* target, uint64_t size);
+
+    std::string m_segment_name;
+    int m_segment_fd = -1;
+    void* m_semaphore = nullptr;
+    frontend_resources::shared_memory_image_ring::RingHeader* m_header = nullptr;
+    std::size_t m_segment_size = 0;
+    uint64_t m_frame_id = 0;
+    bool m_failed = false;
+};
+
+} // namespace megamol::frontend
@@ -79,6 +79,18 @@ void gl_download_texture_to_vector(
     //glGetTextureImage(handle, 0, format, type, target.size(), target.data());
 }
 
+void gl_download_texture_to_buffer(unsigned int handle, ImageWrapper::ImageSize size,
+    ImageWrapper::DataChannels channels, void* target, size_t target_size) {
+    const auto [internalformat, format, type] = getInternalformatFormatType(channels);
+
+    // rows of RGB8 images are not 4 byte aligned, request tightly packed rows
+    int old_alignment = 0;
+    glGetIntegerv(GL_PACK_ALIGNMENT, &old_alignment);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTextureSubImage(handle, 0, 0, 0, 0, size.width, size.height, 1, format, type, target_size, target);
+    glPixelStorei(GL_PACK_ALIGNMENT, old_alignment);
+}
+
 void gl_upload_texture_from_vector(unsigned int& handle, ImageWrapper::ImageSize size,
     ImageWrapper::DataChannels channels, std::vector<byte> const& source) {
     gl_set_and_resize_texture(handle, size, channels, source.data());
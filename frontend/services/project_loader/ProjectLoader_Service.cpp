@@ -12,6 +12,9 @@
 #include "mmcore/utility/graphics/ScreenShotComments.h"
 
 #include "mmcore/utility/log/Log.h"
+
+#include <chrono>
+
 static void log(const char* text) {
     const std::string msg = "ProjectLoader_Service: " + std::string(text);
     megamol::core::utility::log::Log::DefaultLog.WriteInfo(msg.c_str());
@@ -55,7 +58,23 @@ bool ProjectLoader_Service::init(const Config& config) {
     return true;
 }
 
+bool ProjectLoader_Service::cached_script(std::filesystem::path const& filename, std::string& script) const {
+    std::error_code ec;
+    const auto write_time = std::filesystem::last_write_time(filename, ec);
+    if (ec)
+        return false;
+
+    auto it = m_script_cache.find(filename);
+    if (it == m_script_cache.end() || it->second.write_time != write_time)
+        return false;
+
+    script = it->second.script;
+    return true;
+}
+
 bool ProjectLoader_Service::load_file(std::filesystem::path const& filename) const {
+    const auto start_time = std::chrono::steady_clock::now();
+
     // file loaders
     const auto load_lua = [](std::filesystem::path const& filename, std::string& script) -> bool {
         std::ifstream input(filename, std::ios::in);
@@ -95,12 +114,19 @@ bool ProjectLoader_Service::load_file(std::filesystem::path const& filename) con
 
     // extract script from file
     std::string script;
-    auto& file_opener = std::get<1>(*found_it);
-    bool file_ok = file_opener(filename, script);
+    if (!cached_script(filename, script)) {
+        auto& file_opener = std::get<1>(*found_it);
+        bool file_ok = file_opener(filename, script);
 
-    if (!file_ok) {
-        log_error("error opening file: " + filename.generic_u8string());
-        return false;
+        if (!file_ok) {
+            log_error("error opening file: " + filename.generic_u8string());
+            return false;
+        }
+
+        std::error_code ec;
+        const auto write_time = std::filesystem::last_write_time(filename, ec);
+        if (!ec)
+            m_script_cache[filename] = {write_time, script};
     }
 
     // run lua
@@ -123,7 +149,10 @@ bool ProjectLoader_Service::load_file(std::filesystem::path const& filename) con
         return false;
     }
 
-    log("loaded file " + filename.generic_u8string() + ((script_error.size()) ? "\n\t" + script_error : ""));
+    const auto load_ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+    log("loaded file " + filename.generic_u8string() + " in " + std::to_string(static_cast<int>(load_ms)) + " ms" +
+        ((script_error.size()) ? "\n\t" + script_error : ""));
     return true;
 }
 
@@ -11,6 +11,10 @@
 
 #include "ProjectLoader.h"
 
+#include <filesystem>
+#include <map>
+#include <string>
+
 namespace megamol {
 namespace frontend {
 
@@ -47,7 +51,15 @@ public:
     // void setShutdown(const bool s = true);
 
 private:
+    // extracting the script from a PNG means decoding the whole image, so reloading the same file reuses the script
+    struct CachedScript {
+        std::filesystem::file_time_type write_time;
+        std::string script;
+    };
+    bool cached_script(std::filesystem::path const& filename, std::string& script) const;
+
     megamol::frontend_resources::ProjectLoader m_loader;
+    mutable std::map<std::filesystem::path, CachedScript> m_script_cache;
 
     std::vector<FrontendResource> m_providedResourceReferences;
     std::vector<std::string> m_requestedResourcesNames;
@@ -11,16 +11,68 @@
 #include "mmcore/param/FilePathParam.h"
 #include "mmcore/param/FloatParam.h"
 #include "mmcore/param/IntParam.h"
+#include "mmcore/utility/TaskScheduler.h"
 #include "mmcore/utility/log/Log.h"
 #include "stdafx.h"
 #include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <nanoflann.hpp>
 
 using namespace megamol::core;
 using namespace megamol::astro;
 
 #define MAX_MISSED_FILE_NUMBER 5
 
+namespace {
+
+/** Size of the blocks in which frames are converted, a multiple of the word size of the flag bitsets */
+constexpr uint64_t conversionBlockSize = 4096;
+
+/** Adaptor for nanoflann over the periodic images of the AGNs */
+struct AGNCloud {
+    std::vector<glm::vec3> pts;
+
+    inline size_t kdtree_get_point_count() const {
+        return pts.size();
+    }
+
+    inline float kdtree_get_pt(const size_t idx, const size_t dim) const {
+        return pts[idx][static_cast<int>(dim)];
+    }
+
+    template<class BBOX>
+    bool kdtree_get_bbox(BBOX& /* bb */) const {
+        return false;
+    }
+};
+
+typedef nanoflann::KDTreeSingleIndexAdaptor<nanoflann::L2_Simple_Adaptor<float, AGNCloud>, AGNCloud, 3> agn_kd_tree_t;
+
+/*
+ * Layout of the derived quantity files: magic, version, sections, particle count, frame key, neighbour key and an
+ * index of offset and size of every section, followed by the sections.
+ */
+constexpr char derivedMagic[8] = {'C', '1', '9', 'D', 'E', 'R', 'I', 'V'};
+constexpr uint32_t derivedVersion = 1;
+constexpr unsigned int derivedSectionCount = 2;
+
+/** Answers a key that changes whenever the file changes, 0 if there is no such file */
+uint64_t fileKey(std::string const& path) {
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return 0;
+    }
+    const auto time = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    uint64_t key = std::hash<std::string>()(path);
+    key = (key ^ static_cast<uint64_t>(size)) * 0x9e3779b97f4a7c15ull;
+    key = (key ^ static_cast<uint64_t>(time)) * 0x9e3779b97f4a7c15ull;
+    return key;
+}
+
+} // namespace
+
 /*
  * Contest2019DataLoader::Frame::Frame
  */
@@ -164,49 +216,70 @@ bool Contest2019DataLoader::Frame::LoadFrame(std::string filepath, unsigned int
     this->entropyDerivatives->resize(partCount);
 
     // copy the data over
-
+    // the blocks cover whole words of the flag bitsets, so no two threads write the same word
     this->redshift = redshift;
-    for (uint64_t i = 0; i < partCount; ++i) {
-        const auto& s = readDataVec[i];
-        this->positions->operator[](i) = glm::vec3(s.x, s.y, s.z);
-        this->velocities->operator[](i) = glm::vec3(s.vx, s.vy, s.vz);
-        this->temperatures->operator[](i) = 0.0f; // oops, we do not have temperatures
-        this->masses->operator[](i) = s.mass;
-        this->internalEnergies->operator[](i) = s.internalEnergy;
-        this->smoothingLengths->operator[](i) = s.smoothingLength;
-        this->molecularWeights->operator[](i) = s.molecularWeight;
-        this->densities->operator[](i) = s.density;
-        this->gravitationalPotentials->operator[](i) = s.gravitationalPotential;
-        this->entropy->operator[](i) = 0.0f; // we calculate it later
-        this->isBaryonFlags->operator[](i) = (s.bitmask >> 1) & 0x1;
-        this->isStarFlags->operator[](i) = (s.bitmask >> 5) & 0x1;
-        this->isWindFlags->operator[](i) = (s.bitmask >> 6) & 0x1;
-        this->isStarFormingGasFlags->operator[](i) = (s.bitmask >> 7) & 0x1;
-        this->isAGNFlags->operator[](i) = (s.bitmask >> 8) & 0x1;
-        this->particleIDs->operator[](i) = s.particleID;
-
-        // calculate the temperature ourselves
-        // formula out of the mail of J.D Emberson 20.6.2019
-        if (this->isBaryonFlags->at(i)) {
-            this->temperatures->operator[](i) =
-                4.8e5f * this->internalEnergies->at(i) / std::pow(1.0f + redshift, 3.0f);
-        }
+    const uint64_t blockCount = (partCount + conversionBlockSize - 1) / conversionBlockSize;
+    core::utility::ParallelFor<uint64_t>(0, blockCount, 1, [&](uint64_t firstBlock, uint64_t lastBlock) {
+        auto& positions = *this->positions;
+        auto& velocities = *this->velocities;
+        auto& temperatures = *this->temperatures;
+        auto& masses = *this->masses;
+        auto& internalEnergies = *this->internalEnergies;
+        auto& smoothingLengths = *this->smoothingLengths;
+        auto& molecularWeights = *this->molecularWeights;
+        auto& densities = *this->densities;
+        auto& gravitationalPotentials = *this->gravitationalPotentials;
+        auto& entropy = *this->entropy;
+        auto& isBaryonFlags = *this->isBaryonFlags;
+        auto& isStarFlags = *this->isStarFlags;
+        auto& isWindFlags = *this->isWindFlags;
+        auto& isStarFormingGasFlags = *this->isStarFormingGasFlags;
+        auto& isAGNFlags = *this->isAGNFlags;
+        auto& particleIDs = *this->particleIDs;
+
+        const uint64_t end = std::min(partCount, lastBlock * conversionBlockSize);
+        for (uint64_t i = firstBlock * conversionBlockSize; i < end; ++i) {
+            const auto& s = readDataVec[i];
+            positions[i] = glm::vec3(s.x, s.y, s.z);
+            velocities[i] = glm::vec3(s.vx, s.vy, s.vz);
+            temperatures[i] = 0.0f; // oops, we do not have temperatures
+            masses[i] = s.mass;
+            internalEnergies[i] = s.internalEnergy;
+            smoothingLengths[i] = s.smoothingLength;
+            molecularWeights[i] = s.molecularWeight;
+            densities[i] = s.density;
+            gravitationalPotentials[i] = s.gravitationalPotential;
+            entropy[i] = 0.0f; // we calculate it later
+            const bool isBaryon = (s.bitmask >> 1) & 0x1;
+            isBaryonFlags[i] = isBaryon;
+            isStarFlags[i] = (s.bitmask >> 5) & 0x1;
+            isWindFlags[i] = (s.bitmask >> 6) & 0x1;
+            isStarFormingGasFlags[i] = (s.bitmask >> 7) & 0x1;
+            isAGNFlags[i] = (s.bitmask >> 8) & 0x1;
+            particleIDs[i] = s.particleID;
+
+            // calculate the temperature ourselves
+            // formula out of the mail of J.D Emberson 20.6.2019
+            if (isBaryon) {
+                temperatures[i] = 4.8e5f * internalEnergies[i] / std::pow(1.0f + redshift, 3.0f);
+            }
 
-        // calculate the entropy ourselves
-        // formula directly from the contest description
-        if (this->isBaryonFlags->at(i) && this->temperatures->at(i) > 0.0f && this->densities->at(i) > 0.0f) {
-            auto t = (*this->temperatures)[i];
-            auto p = (*this->densities)[i];
-            this->entropy->operator[](i) = std::log(t / std::pow(p, 2.0f / 3.0f));
-
-            // This is Juhans formula:
-            // auto mu = (*this->masses)[i];
-            // auto eps = (*this->internalEnergies)[i];
-            //(*this->entropy)[i] = std::log((mu * eps) / std::pow(p, 2.0f / 3.0f));
-        }
+            // calculate the entropy ourselves
+            // formula directly from the contest description
+            if (isBaryon && temperatures[i] > 0.0f && densities[i] > 0.0f) {
+                auto t = temperatures[i];
+                auto p = densities[i];
+                entropy[i] = std::log(t / std::pow(p, 2.0f / 3.0f));
+
+                // This is Juhans formula:
+                // auto mu = masses[i];
+                // auto eps = internalEnergies[i];
+                // entropy[i] = std::log((mu * eps) / std::pow(p, 2.0f / 3.0f));
+            }
 
-        // the derivatives will be calculated later, when the frame before and after are known
-    }
+            // the derivatives will be calculated later, when the frame before and after are known
+        }
+    });
     return true;
 }
 
@@ -469,31 +542,169 @@ void Contest2019DataLoader::Frame::CalculateAGNDistances(void) {
         }
     }
     // add all mirrored version to account for cyclic boundary conditions
-    std::vector<glm::vec3> apos;
+    AGNCloud apos;
     for (size_t i = 0; i < agnPositions.size(); i++) {
         const auto& pos = agnPositions.at(i);
         for (int x = -1; x <= 1; x++) {
             for (int y = -1; y <= 1; y++) {
                 for (int z = -1; z <= 1; z++) {
-                    apos.push_back(pos + glm::vec3(static_cast<float>(x * 64.0f), static_cast<float>(y * 64.0f),
-                                             static_cast<float>(z * 64.0f)));
+                    apos.pts.push_back(pos + glm::vec3(static_cast<float>(x * 64.0f), static_cast<float>(y * 64.0f),
+                                                 static_cast<float>(z * 64.0f)));
                 }
             }
         }
     }
 
-    if (apos.size() == 0)
+    if (apos.pts.size() == 0)
         return;
-    for (size_t i = 0; i < this->positions->size(); ++i) {
-        float mindist = std::numeric_limits<float>::max();
-        auto& myPos = this->positions->at(i);
-        for (const auto& agnPos : apos) {
-            float dist = glm::distance(myPos, agnPos);
-            if (dist < mindist)
-                mindist = dist;
+
+    // nearest neighbour queries on a kd-tree over the images instead of testing every image for every particle
+    agn_kd_tree_t agnTree(3, apos, nanoflann::KDTreeSingleIndexAdaptorParams(10));
+    agnTree.buildIndex();
+    core::utility::ParallelFor<size_t>(0, this->positions->size(), 0, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            const auto& myPos = (*this->positions)[i];
+            const float query[3] = {myPos.x, myPos.y, myPos.z};
+            size_t nearest = 0;
+            float sqrDist = 0.0f;
+            agnTree.knnSearch(query, 1, &nearest, &sqrDist);
+            (*this->agnDistances)[i] = std::sqrt(sqrDist);
+        }
+    });
+}
+
+/*
+ * Contest2019DataLoader::Frame::ReadDerivedQuantities
+ */
+bool Contest2019DataLoader::Frame::ReadDerivedQuantities(std::filesystem::path const& path, uint64_t frameKey,
+    uint64_t neighbourKey, unsigned int sections, unsigned int& loaded) {
+    loaded = 0;
+    if (this->positions == nullptr)
+        return false;
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    char magic[8];
+    uint32_t version = 0, available = 0;
+    uint64_t count = 0, storedFrameKey = 0, storedNeighbourKey = 0;
+    uint64_t index[2 * derivedSectionCount];
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&available), sizeof(available));
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    file.read(reinterpret_cast<char*>(&storedFrameKey), sizeof(storedFrameKey));
+    file.read(reinterpret_cast<char*>(&storedNeighbourKey), sizeof(storedNeighbourKey));
+    file.read(reinterpret_cast<char*>(index), sizeof(index));
+    if (!file || std::memcmp(magic, derivedMagic, sizeof(magic)) != 0 || version != derivedVersion ||
+        count != this->positions->size() || storedFrameKey != frameKey) {
+        return false;
+    }
+    // the derivatives also depend on the neighbouring frames
+    if (storedNeighbourKey != neighbourKey) {
+        available &= ~DERIVED_DERIVATIVES;
+    }
+    sections &= available;
+
+    const auto readArray = [&file](auto& vec) {
+        file.read(reinterpret_cast<char*>(vec->data()),
+            vec->size() * sizeof(typename std::decay_t<decltype(*vec)>::value_type));
+    };
+    if ((sections & DERIVED_DERIVATIVES) != 0) {
+        file.seekg(index[0]);
+        readArray(this->velocityDerivatives);
+        readArray(this->temperatureDerivatives);
+        readArray(this->internalEnergyDerivatives);
+        readArray(this->smoothingLengthDerivatives);
+        readArray(this->molecularWeightDerivatives);
+        readArray(this->densityDerivatives);
+        readArray(this->gravitationalPotentialDerivatives);
+        readArray(this->entropyDerivatives);
+        if (!file)
+            return false;
+        loaded |= DERIVED_DERIVATIVES;
+    }
+    if ((sections & DERIVED_AGN_DISTANCES) != 0) {
+        file.seekg(index[2]);
+        readArray(this->agnDistances);
+        if (!file)
+            return false;
+        loaded |= DERIVED_AGN_DISTANCES;
+    }
+    return true;
+}
+
+/*
+ * Contest2019DataLoader::Frame::WriteDerivedQuantities
+ */
+bool Contest2019DataLoader::Frame::WriteDerivedQuantities(
+    std::filesystem::path const& path, uint64_t frameKey, uint64_t neighbourKey, unsigned int sections) const {
+    if (this->positions == nullptr)
+        return false;
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    const uint64_t count = this->positions->size();
+    const uint64_t headerSize =
+        sizeof(derivedMagic) + 2 * sizeof(uint32_t) + 3 * sizeof(uint64_t) + 2 * derivedSectionCount * sizeof(uint64_t);
+    uint64_t index[2 * derivedSectionCount] = {0, 0, 0, 0};
+    uint64_t offset = headerSize;
+    if ((sections & DERIVED_DERIVATIVES) != 0) {
+        index[0] = offset;
+        index[1] = count * (sizeof(glm::vec3) + 7 * sizeof(float));
+        offset += index[1];
+    }
+    if ((sections & DERIVED_AGN_DISTANCES) != 0) {
+        index[2] = offset;
+        index[3] = count * sizeof(float);
+    }
+
+    // written under a temporary name, so a concurrently loading instance never sees a partial file
+    auto tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+        const uint32_t version = derivedVersion;
+        const uint32_t available = sections;
+        file.write(derivedMagic, sizeof(derivedMagic));
+        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        file.write(reinterpret_cast<const char*>(&available), sizeof(available));
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        file.write(reinterpret_cast<const char*>(&frameKey), sizeof(frameKey));
+        file.write(reinterpret_cast<const char*>(&neighbourKey), sizeof(neighbourKey));
+        file.write(reinterpret_cast<const char*>(index), sizeof(index));
+
+        const auto writeArray = [&file](const auto& vec) {
+            file.write(reinterpret_cast<const char*>(vec->data()),
+                vec->size() * sizeof(typename std::decay_t<decltype(*vec)>::value_type));
+        };
+        if ((sections & DERIVED_DERIVATIVES) != 0) {
+            writeArray(this->velocityDerivatives);
+            writeArray(this->temperatureDerivatives);
+            writeArray(this->internalEnergyDerivatives);
+            writeArray(this->smoothingLengthDerivatives);
+            writeArray(this->molecularWeightDerivatives);
+            writeArray(this->densityDerivatives);
+            writeArray(this->gravitationalPotentialDerivatives);
+            writeArray(this->entropyDerivatives);
+        }
+        if ((sections & DERIVED_AGN_DISTANCES) != 0) {
+            writeArray(this->agnDistances);
+        }
+        if (!file) {
+            file.close();
+            std::filesystem::remove(tmp, ec);
+            return false;
         }
-        this->agnDistances->at(i) = mindist;
     }
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    return true;
 }
 
 /*
@@ -513,7 +724,10 @@ Contest2019DataLoader::Contest2019DataLoader(void)
         , calculateAGNDistances("calculateAGNDistances",
               "Enables the calculation of the distance to the AGNs. This option increases the frame loading time "
               "significantly. The effect of this slot might be delayed as already existing frames are not "
-              "re-evaluated.") {
+              "re-evaluated.")
+        , cacheDirectory("cacheDirectory",
+              "Directory in which the derived quantities (derivatives and AGN distances) of every frame are stored, "
+              "so they are only calculated on the first visit of a frame. Empty to disable.") {
 
     this->getDataSlot.SetCallback(AstroDataCall::ClassName(),
         AstroDataCall::FunctionName(AstroDataCall::CallForGetData), &Contest2019DataLoader::getDataCallback);
@@ -535,6 +749,9 @@ Contest2019DataLoader::Contest2019DataLoader(void)
     this->calculateAGNDistances.SetParameter(new param::BoolParam(true));
     this->MakeSlotAvailable(&this->calculateAGNDistances);
 
+    this->cacheDirectory.SetParameter(new param::FilePathParam("", param::FilePathParam::Flag_Directory_ToBeCreated));
+    this->MakeSlotAvailable(&this->cacheDirectory);
+
     // static bounding box size, because we know (TM)
     this->boundingBox = vislib::math::Cuboid<float>(0.0f, 0.0f, 0.0f, 64.0f, 64.0f, 64.0f);
     this->clipBox = this->boundingBox;
@@ -600,29 +817,58 @@ void Contest2019DataLoader::loadFrame(view::AnimDataModule::Frame* frame, unsign
         filenameAfter = this->filenames.at(frameIDAfter);
         redshiftAfter = this->redshiftsForFilename.at(frameIDAfter);
     }
+    bool loaded = false;
     if (!filename.empty()) {
-        if (!f->LoadFrame(filename, frameID, redshift)) {
+        loaded = f->LoadFrame(filename, frameID, redshift);
+        if (!loaded) {
             Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to read frame %d from file\n", idx);
         }
     }
     bool calcDerivatives = this->calculateDerivatives.Param<param::BoolParam>()->Value();
-    if (!filenameBefore.empty() && calcDerivatives) {
+    bool calcAGNDistances = this->calculateAGNDistances.Param<param::BoolParam>()->Value();
+
+    // look up the derived quantities of earlier visits of the frame
+    const unsigned int wanted =
+        (calcDerivatives ? Frame::DERIVED_DERIVATIVES : 0u) | (calcAGNDistances ? Frame::DERIVED_AGN_DISTANCES : 0u);
+    unsigned int cached = 0;
+    std::filesystem::path cacheFile;
+    uint64_t frameKey = 0, neighbourKey = 0;
+    const auto cacheDir = this->cacheDirectory.Param<param::FilePathParam>()->Value();
+    if (loaded && wanted != 0 && !cacheDir.empty()) {
+        cacheFile = cacheDir / (std::filesystem::path(filename).filename().u8string() + ".derived");
+        frameKey = fileKey(filename);
+        neighbourKey = fileKey(filenameBefore) * 0x9e3779b97f4a7c15ull ^ fileKey(filenameAfter);
+        f->ReadDerivedQuantities(cacheFile, frameKey, neighbourKey, wanted, cached);
+    }
+
+    const bool needNeighbours = calcDerivatives && (cached & Frame::DERIVED_DERIVATIVES) == 0;
+    if (!filenameBefore.empty() && needNeighbours) {
         if (!fbefore->LoadFrame(filenameBefore, frameIDBefore, redshiftBefore)) {
             Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to read frame before frame %d from file\n", idx);
         }
     }
-    if (!filenameAfter.empty() && calcDerivatives) {
+    if (!filenameAfter.empty() && needNeighbours) {
         if (!fafter->LoadFrame(filenameAfter, frameIDAfter, redshiftAfter)) {
             Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to read frame after frame %d from file\n", idx);
         }
     }
-    f->ZeroDerivatives();
-    if (calcDerivatives) {
-        f->CalculateDerivatives(fbefore, fafter);
+    if ((cached & Frame::DERIVED_DERIVATIVES) == 0) {
+        f->ZeroDerivatives();
+        if (calcDerivatives) {
+            f->CalculateDerivatives(fbefore, fafter);
+        }
     }
-    f->ZeroAGNDistances();
-    if (this->calculateAGNDistances.Param<param::BoolParam>()->Value()) {
-        f->CalculateAGNDistances();
+    if ((cached & Frame::DERIVED_AGN_DISTANCES) == 0) {
+        f->ZeroAGNDistances();
+        if (calcAGNDistances) {
+            f->CalculateAGNDistances();
+        }
+    }
+    if (!cacheFile.empty() && cached != wanted) {
+        if (!f->WriteDerivedQuantities(cacheFile, frameKey, neighbourKey, wanted)) {
+            Log::DefaultLog.WriteWarn("Unable to write the derived quantities of frame %d to \"%s\"", idx,
+                cacheFile.u8string().c_str());
+        }
     }
     delete fbefore;
     delete fafter;
@@ -16,6 +16,7 @@
 #include "mmcore/param/ParamSlot.h"
 #include "mmcore/view/AnimDataModule.h"
 #include "vislib/math/Cuboid.h"
+#include <filesystem>
 #include <map>
 
 namespace megamol {
@@ -178,6 +179,36 @@ protected:
 
         void ZeroAGNDistances(void);
 
+        /** Sections of the derived quantity files */
+        enum DerivedQuantities : unsigned int { DERIVED_DERIVATIVES = 1, DERIVED_AGN_DISTANCES = 2 };
+
+        /**
+         * Loads derived quantities of this frame that were stored by WriteDerivedQuantities
+         *
+         * @param path The file to load from.
+         * @param frameKey The key of the file of this frame.
+         * @param neighbourKey The key of the files of the frames before and after, the derivatives depend on them.
+         * @param sections The requested sections.
+         * @param loaded The sections that were loaded.
+         *
+         * @return True if the file belongs to this frame, false otherwise.
+         */
+        bool ReadDerivedQuantities(std::filesystem::path const& path, uint64_t frameKey, uint64_t neighbourKey,
+            unsigned int sections, unsigned int& loaded);
+
+        /**
+         * Stores derived quantities of this frame together with an index of the sections
+         *
+         * @param path The file to write to.
+         * @param frameKey The key of the file of this frame.
+         * @param neighbourKey The key of the files of the frames before and after.
+         * @param sections The sections to store.
+         *
+         * @return True on success, false otherwise.
+         */
+        bool WriteDerivedQuantities(
+            std::filesystem::path const& path, uint64_t frameKey, uint64_t neighbourKey, unsigned int sections) const;
+
     private:
 #pragma pack(push, 1)
         /**
@@ -347,6 +378,9 @@ protected:
     /** Slot determining whether the distances to the AGNs should be calculated */
     core::param::ParamSlot calculateAGNDistances;
 
+    /** Slot containing the directory of the stored derived quantities */
+    core::param::ParamSlot cacheDirectory;
+
     /** Slot to send the data over */
     core::CalleeSlot getDataSlot;
 
@@ -5,12 +5,14 @@
 #include <math.h>
 
 #include <atomic>
-#include <fstream>
+#include <mutex>
 #include <random>
+#include <sstream>
 
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/FloatParam.h"
 #include "mmcore/param/IntParam.h"
+#include "mmcore/param/StringParam.h"
 
 #include "mmcore/utility/sys/ConsoleProgressBar.h"
 
@@ -18,6 +20,33 @@
 
 #include "simultaneous_sort.h"
 
+namespace {
+
+/**
+ * Counter-based generator of uniform numbers in [0, 1). The n-th number of a stream is a SplitMix64 hash of the
+ * stream and n, so a particle gets its own reproducible stream without seeding a generator with a large state.
+ */
+class CounterRandom {
+public:
+    explicit CounterRandom(uint64_t stream) : counter_(mix(stream)) {}
+
+    double operator()() {
+        counter_ += 0x9E3779B97F4A7C15ull;
+        return static_cast<double>(mix(counter_) >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+private:
+    static uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t counter_;
+};
+
+} // namespace
+
 megamol::astro::SpectralIntensityVolume::SpectralIntensityVolume()
         : volume_in_slot_("volumeIn", "Input of volume containing optical depth")
         , temp_in_slot_("tempIn", "Input of volume containing temperature")
@@ -34,12 +63,17 @@ megamol::astro::SpectralIntensityVolume::SpectralIntensityVolume()
         , cyclYSlot("cyclY", "Considers cyclic boundary conditions in Y direction")
         , cyclZSlot("cyclZ", "Considers cyclic boundary conditions in Z direction")
         , normalizeSlot("normalize", "Normalize the output volume")
-        //, wavelength_slot_("wavelength", "Set the wavelength for the spectral intensity (in nm)")
         , numSamplesSlot("numSamples", "Number of samples per particle in the darth volume case")
         , absorptionBiasSlot(
               "absorptionBias", "Determines influence of absorption coefficient in the darth volume case")
         , coneSampleNumSlot("coneNumSamples", "Number of samples for cone tracing in darth volume case")
-        , coneAngleSlot("coneAngle", "Angle of the cone in the darth volume case (degree)") {
+        , coneAngleSlot("coneAngle", "Angle of the cone in the darth volume case (degree)")
+        , wavelengthsSlot("wavelengths",
+              "Wavelengths (in nm, separated by blanks or semicolons) of the spectral intensity, one component each. "
+              "Empty for a single grey component.")
+        , temperatureBinsSlot("temperatureBins",
+              "Number of temperature bins the particles are sorted into for the spectral intensity. Changing the "
+              "wavelengths reuses the cone sampling of the bins.") {
     volume_in_slot_.SetCompatibleCall<geocalls::VolumetricDataCallDescription>();
     MakeSlotAvailable(&volume_in_slot_);
 
@@ -132,8 +166,11 @@ megamol::astro::SpectralIntensityVolume::SpectralIntensityVolume()
     this->normalizeSlot << new core::param::BoolParam(true);
     this->MakeSlotAvailable(&this->normalizeSlot);
 
-    /*this->wavelength_slot_ << new core::param::FloatParam(1.0f, std::numeric_limits<float>::min(), 1000.f);
-    MakeSlotAvailable(&wavelength_slot_);*/
+    wavelengthsSlot << new core::param::StringParam("");
+    MakeSlotAvailable(&wavelengthsSlot);
+
+    temperatureBinsSlot << new core::param::IntParam(16, 1, 256);
+    MakeSlotAvailable(&temperatureBinsSlot);
 
     numSamplesSlot << new core::param::IntParam(256, 1);
     MakeSlotAvailable(&numSamplesSlot);
@@ -292,28 +329,35 @@ bool megamol::astro::SpectralIntensityVolume::getDataCallback(core::Call& c) {
     }
     if (this->time != ast->FrameID() || this->time != vdc->FrameID() || this->time != tdc->FrameID() ||
         this->time != mdc->FrameID() || this->time != mwdc->FrameID() || this->in_datahash != ast->DataHash() ||
-        this->anythingDirty()) {
+        this->anythingDirty() || this->basis_.empty()) {
         if (!this->createVolumeCPU(*vdc, *tdc, *mdc, *mwdc, *ast))
             return false;
+        this->combineWavelengths();
         this->time = ast->FrameID();
         this->in_datahash = ast->DataHash();
         ++this->datahash;
         this->resetDirty();
+    } else if (this->spectrumDirty()) {
+        // only the combination of the cached bins changes
+        this->combineWavelengths();
+        ++this->datahash;
+        this->resetDirty();
     }
 
-    // TODO set data
-    outVol->SetData(this->vol_[0].data());
-    metadata.Components = 1; //< TODO Maybe we want several wavelengths simultaneously
+    outVol->SetData(this->intensity_.data());
+    metadata.Components = this->components_;
     metadata.GridType = geocalls::GridType_t::CARTESIAN;
     metadata.Resolution[0] = static_cast<size_t>(this->xResSlot.Param<core::param::IntParam>()->Value());
     metadata.Resolution[1] = static_cast<size_t>(this->yResSlot.Param<core::param::IntParam>()->Value());
     metadata.Resolution[2] = static_cast<size_t>(this->zResSlot.Param<core::param::IntParam>()->Value());
     metadata.ScalarType = geocalls::ScalarType_t::FLOATING_POINT;
     metadata.ScalarLength = sizeof(float);
-    metadata.MinValues = new double[1];
-    metadata.MinValues[0] = this->min_dens_;
-    metadata.MaxValues = new double[1];
-    metadata.MaxValues[0] = this->max_dens_;
+    delete[] metadata.MinValues;
+    delete[] metadata.MaxValues;
+    metadata.MinValues = new double[this->components_];
+    metadata.MaxValues = new double[this->components_];
+    std::fill(metadata.MinValues, metadata.MinValues + this->components_, this->min_dens_);
+    std::fill(metadata.MaxValues, metadata.MaxValues + this->components_, this->max_dens_);
     auto const bbox = ast->AccessBoundingBoxes().ObjectSpaceBBox();
     metadata.Extents[0] = bbox.Width();
     metadata.Extents[1] = bbox.Height();
@@ -648,8 +692,6 @@ bool megamol::astro::SpectralIntensityVolume::createVolumeCPU(geocalls::Volumetr
     auto const sy = this->yResSlot.Param<core::param::IntParam>()->Value();
     auto const sz = this->zResSlot.Param<core::param::IntParam>()->Value();
 
-    // float const wl = this->wavelength_slot_.Param<core::param::FloatParam>()->Value() / 1000000000.0f;
-
     auto const numSamples = numSamplesSlot.Param<core::param::IntParam>()->Value();
     double const bias = absorptionBiasSlot.Param<core::param::FloatParam>()->Value();
 
@@ -658,12 +700,7 @@ bool megamol::astro::SpectralIntensityVolume::createVolumeCPU(geocalls::Volumetr
 
     auto const numCells = sx * sy * sz;
 
-    vol_.resize(omp_get_max_threads());
-#pragma omp parallel for
-    for (int init = 0; init < omp_get_max_threads(); ++init) {
-        vol_[init].resize(numCells);
-        std::fill(vol_[init].begin(), vol_[init].end(), 0.0f);
-    }
+    auto const numBins = temperatureBinsSlot.Param<core::param::IntParam>()->Value();
 
     auto const cycl_x = this->cyclXSlot.Param<core::param::BoolParam>()->Value();
     auto const cycl_y = this->cyclYSlot.Param<core::param::BoolParam>()->Value();
@@ -744,6 +781,22 @@ bool megamol::astro::SpectralIntensityVolume::createVolumeCPU(geocalls::Volumetr
     std::transform(radiance.cbegin(), radiance.cend(), radiance.begin(),
         [min_rad, minmax_rad_rcp](auto& val) { return (val - min_rad) * minmax_rad_rcp; });
 
+    // sort the particles into logarithmic temperature bins, each bin gets its own intensity volume
+    std::vector<int> bins(temps.size(), 0);
+    bin_temps_.assign(numBins, 0.0);
+    {
+        auto const log_min_temp = std::log(std::max(min_temp, 1.0));
+        auto const log_max_temp = std::log(std::max(*minmax_temp.second, 1.0));
+        auto const bin_width = std::max(log_max_temp - log_min_temp, 1e-6) / static_cast<double>(numBins);
+        for (size_t idx = 0; idx < temps.size(); ++idx) {
+            auto const bin = static_cast<int>((std::log(std::max(temps[idx], 1.0)) - log_min_temp) / bin_width);
+            bins[idx] = std::clamp(bin, 0, numBins - 1);
+        }
+        for (int bin = 0; bin < numBins; ++bin) {
+            bin_temps_[bin] = std::exp(log_min_temp + (static_cast<double>(bin) + 0.5) * bin_width);
+        }
+    }
+
 
     // prepare input volume
     auto metadata = volumeIn.GetMetadata();
@@ -909,8 +962,6 @@ bool megamol::astro::SpectralIntensityVolume::createVolumeCPU(geocalls::Volumetr
         }
     }*/
 
-    std::uniform_real_distribution<> distr(0.0, 1.0);
-    std::mt19937_64 rng(42);
 
     // Implements the Bump Function from
     // https://en.wikipedia.org/wiki/Radial_basis_function
@@ -920,14 +971,52 @@ bool megamol::astro::SpectralIntensityVolume::createVolumeCPU(geocalls::Volumetr
         return std::exp(-1.0f / (1.0f - std::pow((1.0f / epsilon) * dist, 2.0f)));
     };
 
+    // The volume is split into bricks that own their voxels. Rays collect their deposits per brick and add them
+    // under the lock of the brick when they leave it, instead of every thread accumulating into a full volume.
+    // A bin only allocates the bricks its particles deposit into, so the bins together need far less than one full
+    // volume each.
+    constexpr int brick_shift = basis_brick_shift_;
+    constexpr int brick_mask = (1 << brick_shift) - 1;
+    auto const bricks_x = (sx + brick_mask) >> brick_shift;
+    auto const bricks_y = (sy + brick_mask) >> brick_shift;
+    auto const bricks_z = (sz + brick_mask) >> brick_shift;
+    std::vector<std::mutex> brick_locks(static_cast<size_t>(bricks_x) * bricks_y * bricks_z);
+
+    basis_.clear();
+    basis_.resize(numBins);
+    for (auto& b : basis_) {
+        b.resize(brick_locks.size());
+    }
+    basis_res_ = {sx, sy, sz};
+
 #if 1
     cpb.Start("Volume Creation", positions.size());
     auto const cone_factor = std::tan(coneAngleDeg * M_PI / 180.0f);
     auto const cone_angle = coneAngleDeg * M_PI / 180.0;
 
-#pragma omp parallel for
+#pragma omp parallel for schedule(dynamic, 16)
     for (int64_t idx = 0; idx < positions.size(); ++idx) {
         auto const pos = positions[idx];
+        auto& target = basis_[bins[idx]];
+
+        // every particle has its own sequence, so the result does not depend on the thread scheduling
+        CounterRandom rng(42 + idx);
+
+        std::vector<std::pair<int, float>> pending;
+        int pending_brick = -1;
+        auto const flush = [&]() {
+            if (!pending.empty()) {
+                std::lock_guard<std::mutex> lock(brick_locks[pending_brick]);
+                auto& brick = target[pending_brick];
+                if (!brick) {
+                    brick = std::make_unique<float[]>(basis_brick_voxels_);
+                }
+                for (auto const& dep : pending) {
+                    brick[dep.first] += dep.second;
+                }
+                pending.clear();
+            }
+        };
         /*auto x_base = pos.x;
         auto x = voxel_idx[idx].x;
         auto y_base = pos.y;
@@ -939,8 +1028,8 @@ bool megamol::astro::SpectralIntensityVolume::createVolumeCPU(geocalls::Volumetr
 
         for (int iter = 0; iter < numSamples; ++iter) {
             // https://corysimon.github.io/articles/uniformdistn-on-sphere/
-            auto phi = 2.0 * M_PI * distr(rng);
-            auto theta = std::acos(1.0 - 2.0 * distr(rng));
+            auto phi = 2.0 * M_PI * rng();
+            auto theta = std::acos(1.0 - 2.0 * rng());
             glm::vec3 dir = glm::vec3(
                 rad * std::sin(theta) * std::cos(phi), rad * std::sin(theta) * std::sin(phi), rad * std::cos(theta));
             glm::vec3 org = pos + dir;
@@ -953,8 +1042,8 @@ bool megamol::astro::SpectralIntensityVolume::createVolumeCPU(geocalls::Volumetr
                 // modify dir
                 // https://stackoverflow.com/questions/38997302/create-random-unit-vector-inside-a-defined-conical-region
                 try {
-                    auto const z = distr(rng) * (1.0 - std::cos(cone_angle)) + std::cos(cone_angle);
-                    auto const phi = distr(rng) * 2.0 * M_PI;
+                    auto const z = rng() * (1.0 - std::cos(cone_angle)) + std::cos(cone_angle);
+                    auto const phi = rng() * 2.0 * M_PI;
                     auto const y = std::sqrt(1.0 - z * z) * sin(phi);
                     auto const x = std::sqrt(1.0 - z * z) * cos(phi);
                     glm::vec3 rand(x, y, z);
@@ -994,7 +1083,20 @@ bool megamol::astro::SpectralIntensityVolume::createVolumeCPU(geocalls::Volumetr
                     e -= e * aps;
                     // att += aps * (1.0 - att);
 
-                    vol_[omp_get_thread_num()][(vz * sy + vy) * sx + vx] += e;
+                    // index of the voxel within its brick
+                    auto const cell =
+                        ((((vz & brick_mask) << brick_shift) + (vy & brick_mask)) << brick_shift) + (vx & brick_mask);
+                    auto const brick =
+                        ((vz >> brick_shift) * bricks_y + (vy >> brick_shift)) * bricks_x + (vx >> brick_shift);
+                    if (brick != pending_brick) {
+                        flush();
+                        pending_brick = brick;
+                    }
+                    if (!pending.empty() && pending.back().first == cell) {
+                        pending.back().second += e;
+                    } else {
+                        pending.emplace_back(cell, e);
+                    }
 
                     /*auto const cone = cone_factor * t;
                     auto const voxel_diff_x = static_cast<int>(cone / sliceDistX);
@@ -1020,6 +1122,7 @@ bool megamol::astro::SpectralIntensityVolume::createVolumeCPU(geocalls::Volumetr
                 }
             }
         }
+        flush();
 
         ++counter;
         if (omp_get_thread_num() == 0) {
@@ -1029,35 +1132,99 @@ bool megamol::astro::SpectralIntensityVolume::createVolumeCPU(geocalls::Volumetr
     cpb.Stop();
 #endif
 
-    for (int i = 1; i < omp_get_max_threads(); ++i) {
-        std::transform(vol_[i].begin(), vol_[i].end(), vol_[0].begin(), vol_[0].begin(), std::plus<>());
+    megamol::core::utility::log::Log::DefaultLog.WriteInfo(
+        "SpectralIntensityVolume: Captured intensity of %d temperature bins.", numBins);
+
+    return true;
+}
+
+
+std::vector<float> megamol::astro::SpectralIntensityVolume::parseWavelengths() const {
+    auto str = this->wavelengthsSlot.Param<core::param::StringParam>()->Value();
+    std::replace(str.begin(), str.end(), ';', ' ');
+    std::replace(str.begin(), str.end(), ',', ' ');
+    std::istringstream stream(str);
+    std::vector<float> wavelengths;
+    float wl = 0.0f;
+    while (stream >> wl) {
+        if (wl > 0.0f) {
+            wavelengths.push_back(wl);
+        }
     }
+    return wavelengths;
+}
 
-    max_dens_ = *std::max_element(vol_[0].begin(), vol_[0].end());
-    min_dens_ = *std::min_element(vol_[0].begin(), vol_[0].end());
+
+void megamol::astro::SpectralIntensityVolume::combineWavelengths() {
+    auto const wavelengths = parseWavelengths();
+    auto const numBins = basis_.size();
+    if (numBins == 0) {
+        return;
+    }
+    auto const sx = basis_res_[0];
+    auto const sy = basis_res_[1];
+    auto const sz = basis_res_[2];
+    auto const numCells = static_cast<size_t>(sx) * sy * sz;
+
+    // weight of every bin for every wavelength, interleaved like the output. A grey volume is the sum of all bins.
+    // The spectral shape of thermal bremsstrahlung is exp(-h c / (lambda k T)), with hc/k = 1.4388e-2 m K.
+    components_ = wavelengths.empty() ? 1 : static_cast<unsigned int>(wavelengths.size());
+    std::vector<float> weights(numBins * components_, 1.0f);
+    if (!wavelengths.empty()) {
+        for (size_t bin = 0; bin < numBins; ++bin) {
+            for (unsigned int c = 0; c < components_; ++c) {
+                auto const wl = static_cast<double>(wavelengths[c]) * 1e-9;
+                weights[bin * components_ + c] = static_cast<float>(std::exp(-1.4388e-2 / (wl * bin_temps_[bin])));
+            }
+        }
+    }
+
+    intensity_.assign(numCells * components_, 0.0f);
+    auto const comps = static_cast<int64_t>(components_);
+    constexpr int brick_shift = basis_brick_shift_;
+    constexpr int brick_size = 1 << brick_shift;
+    auto const bricks_x = (sx + brick_size - 1) >> brick_shift;
+    auto const bricks_y = (sy + brick_size - 1) >> brick_shift;
+    auto const numBricks = static_cast<int64_t>(basis_[0].size());
+#pragma omp parallel for schedule(dynamic)
+    for (int64_t brick = 0; brick < numBricks; ++brick) {
+        int const bx = static_cast<int>(brick % bricks_x) << brick_shift;
+        int const by = static_cast<int>((brick / bricks_x) % bricks_y) << brick_shift;
+        int const bz = static_cast<int>(brick / (static_cast<int64_t>(bricks_x) * bricks_y)) << brick_shift;
+        for (size_t bin = 0; bin < numBins; ++bin) {
+            float const* b = basis_[bin][brick].get();
+            if (b == nullptr) {
+                continue;
+            }
+            float const* w = weights.data() + bin * comps;
+            for (int z = 0; z < brick_size && bz + z < sz; ++z) {
+                for (int y = 0; y < brick_size && by + y < sy; ++y) {
+                    for (int x = 0; x < brick_size && bx + x < sx; ++x) {
+                        auto const v = b[(z * brick_size + y) * brick_size + x];
+                        float* out = intensity_.data() + (((bz + z) * sy + (by + y)) * sx + (bx + x)) * comps;
+#pragma omp simd
+                        for (int64_t c = 0; c < comps; ++c) {
+                            out[c] += w[c] * v;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    max_dens_ = *std::max_element(intensity_.begin(), intensity_.end());
+    min_dens_ = *std::min_element(intensity_.begin(), intensity_.end());
     megamol::core::utility::log::Log::DefaultLog.WriteInfo(
-        "SpectralIntensityVolume: Captured intensity %f -> %f", min_dens_, max_dens_);
+        "SpectralIntensityVolume: Captured intensity %f -> %f in %u components", min_dens_, max_dens_, components_);
 
     if (this->normalizeSlot.Param<core::param::BoolParam>()->Value()) {
         auto const rcpValRange = 1.0f / (max_dens_ - min_dens_);
-        std::transform(vol_[0].begin(), vol_[0].end(), vol_[0].begin(),
+        std::transform(intensity_.begin(), intensity_.end(), intensity_.begin(),
             [this, rcpValRange](float const& a) { return (a - min_dens_) * rcpValRange; });
         min_dens_ = 0.0f;
         max_dens_ = 1.0f;
     }
 
-//#define SIV_DEBUG_OUTPUT
-#ifdef SIV_DEBUG_OUTPUT
-    std::ofstream raw_file{"int.raw", std::ios::binary};
-    raw_file.write(reinterpret_cast<char const*>(vol_[0].data()), vol_[0].size() * sizeof(float));
-    raw_file.close();
-    megamol::core::utility::log::Log::DefaultLog.WriteInfo("SpectralIntensityVolume: Debug file written\n");
-#endif
-
-    // Cleanup
-    vol_.resize(1);
-
-    return true;
 }
 
 
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "mmcore/Call.h"
@@ -65,11 +68,24 @@ private:
         geocalls::VolumetricDataCall const& tempIn, geocalls::VolumetricDataCall const& massIn,
         geocalls::VolumetricDataCall const& mwIn, AstroDataCall& astroIn);
 
+    /**
+     * Combines the basis volumes of the temperature bins into the spectral intensity volume, one component per
+     * wavelength. Cheap compared to createVolumeCPU, so wavelength changes only run this step.
+     */
+    void combineWavelengths();
+
+    /** Answers the wavelengths (in nm) of the wavelengths slot, empty for a grey volume */
+    std::vector<float> parseWavelengths() const;
+
     bool anythingDirty() const {
         return this->xResSlot.IsDirty() || this->yResSlot.IsDirty() || this->zResSlot.IsDirty() ||
                this->cyclXSlot.IsDirty() || this->cyclYSlot.IsDirty() || this->cyclZSlot.IsDirty() ||
-               this->normalizeSlot.IsDirty() /*|| wavelength_slot_.IsDirty()*/ || numSamplesSlot.IsDirty() ||
-               absorptionBiasSlot.IsDirty();
+               numSamplesSlot.IsDirty() || absorptionBiasSlot.IsDirty() || coneSampleNumSlot.IsDirty() ||
+               coneAngleSlot.IsDirty() || temperatureBinsSlot.IsDirty();
+    }
+
+    bool spectrumDirty() const {
+        return this->normalizeSlot.IsDirty() || wavelengthsSlot.IsDirty();
     }
 
     void resetDirty() {
@@ -80,9 +96,12 @@ private:
         this->cyclYSlot.ResetDirty();
         this->cyclZSlot.ResetDirty();
         this->normalizeSlot.ResetDirty();
-        //wavelength_slot_.ResetDirty();
+        wavelengthsSlot.ResetDirty();
         numSamplesSlot.ResetDirty();
         absorptionBiasSlot.ResetDirty();
+        coneSampleNumSlot.ResetDirty();
+        coneAngleSlot.ResetDirty();
+        temperatureBinsSlot.ResetDirty();
     }
 
     inline glm::quat quat_from_vectors(glm::vec3 base, glm::vec3 org_dir) {
@@ -132,10 +151,35 @@ private:
 
     core::param::ParamSlot coneAngleSlot;
 
-    // core::param::ParamSlot wavelength_slot_;
+    core::param::ParamSlot wavelengthsSlot;
+
+    core::param::ParamSlot temperatureBinsSlot;
 
     std::vector<std::vector<float>> vol_;
 
+    /** Edge length of the bricks of the basis volumes, as a power of two */
+    static constexpr int basis_brick_shift_ = 3;
+
+    /** Number of voxels of a brick of the basis volumes */
+    static constexpr size_t basis_brick_voxels_ = size_t(1) << (3 * basis_brick_shift_);
+
+    /**
+     * Intensity captured from the particles of each temperature bin, the cached result of the cone sampling. The
+     * volume of a bin is stored as bricks, which are only allocated where the particles of the bin deposit intensity.
+     */
+    std::vector<std::vector<std::unique_ptr<float[]>>> basis_;
+
+    /** Resolution of the basis volumes */
+    std::array<int, 3> basis_res_ = {0, 0, 0};
+
+    /** Representative temperature of each bin */
+    std::vector<double> bin_temps_;
+
+    /** Spectral intensity volume, the wavelengths are interleaved per voxel */
+    std::vector<float> intensity_;
+
+    unsigned int components_ = 1;
+
     float max_dens_ = 0.0f;
     float min_dens_ = std::numeric_limits<float>::max();
 
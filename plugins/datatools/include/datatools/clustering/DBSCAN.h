@@ -1,12 +1,20 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <functional>
+#include <limits>
+#include <list>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
+#include "mmcore/utility/TaskScheduler.h"
 #include "mmcore/utility/sys/ConsoleProgressBar.h"
 
 #include "datatools/PointcloudHelpers.h"
+#include "datatools/clustering/UnionFind.h"
 
 #include <nanoflann.hpp>
 
@@ -489,4 +497,463 @@ inline cluster_result_t GROWING_with_similarity_and_score(std::shared_ptr<kd_tre
 }
 
 
+/** Predicate for the parallel DBSCAN variants that accepts all neighbors. */
+struct no_similarity {
+    constexpr bool operator()(index_t, index_t) const {
+        return true;
+    }
+};
+
+/** Neighborhood queries against a kd-tree, used by DBSCAN_parallel. */
+template<typename T, int DIM>
+class kd_tree_neighbors {
+public:
+    using buffer_t = search_res_t<T>;
+
+    kd_tree_neighbors(std::shared_ptr<kd_tree_t<T, DIM>> const& D, T eps) : _D(D), _eps(eps) {
+        _params.sorted = false;
+    }
+
+    index_t size() const {
+        return _D->dataset.kdtree_get_point_count();
+    }
+
+    template<typename Func>
+    void operator()(index_t idx, buffer_t& buffer, Func&& func) const {
+        _D->radiusSearch(_D->dataset.get_position(idx), _eps, buffer, _params);
+        for (auto const& el : buffer) {
+            func(el.first);
+        }
+    }
+
+private:
+    std::shared_ptr<kd_tree_t<T, DIM>> _D;
+    T _eps;
+    nanoflann::SearchParams _params;
+};
+
+/**
+ * Neighborhood queries on a uniform grid with cells at least as large as the weighted search radius,
+ * so only the adjacent cells need to be visited. Faster to build and query than a kd-tree for low dimensions.
+ * Dimensions with zero weight are ignored by the grid.
+ */
+template<typename T, int DIM>
+class grid_neighbors {
+public:
+    static_assert(DIM >= 1 && DIM <= 4, "grid_neighbors supports up to four dimensions");
+
+    struct buffer_t {};
+
+    grid_neighbors(std::shared_ptr<genericPointcloud<T, DIM>> const& data, T eps) : _data(data), _eps(eps) {
+        auto const num_points = data->kdtree_get_point_count();
+        auto const& weights = data->get_weights();
+
+        std::array<T, DIM> maxs;
+        _mins.fill(std::numeric_limits<T>::max());
+        maxs.fill(std::numeric_limits<T>::lowest());
+        for (index_t idx = 0; idx < num_points; ++idx) {
+            auto const pos = data->get_position(idx);
+            for (int d = 0; d < DIM; ++d) {
+                _mins[d] = std::min(_mins[d], pos[d]);
+                maxs[d] = std::max(maxs[d], pos[d]);
+            }
+        }
+
+        // weighted distance w * dx^2 < eps means |dx| < sqrt(eps / w)
+        for (int d = 0; d < DIM; ++d) {
+            auto const extent = std::max(maxs[d] - _mins[d], static_cast<T>(0));
+            _cell_size[d] = weights[d] > 0 ? std::sqrt(eps / weights[d]) : std::numeric_limits<T>::max();
+            _cell_size[d] = std::max(_cell_size[d], extent * static_cast<T>(1e-6));
+            _cell_count[d] = weights[d] > 0 && eps > 0 ? static_cast<uint64_t>(extent / _cell_size[d]) + 1 : 1;
+        }
+        // keep linear cell keys in 64 bit by coarsening the grid, larger cells only cost query time
+        auto const total_cells = [this]() {
+            double total = 1.0;
+            for (int d = 0; d < DIM; ++d) {
+                total *= static_cast<double>(_cell_count[d]);
+            }
+            return total;
+        };
+        while (total_cells() > static_cast<double>(std::numeric_limits<uint64_t>::max() / 4)) {
+            for (int d = 0; d < DIM; ++d) {
+                if (_cell_count[d] > 1) {
+                    _cell_size[d] *= 2;
+                    _cell_count[d] = (_cell_count[d] + 1) / 2;
+                }
+            }
+        }
+
+        std::vector<std::pair<uint64_t, index_t>> keys(num_points);
+        core::utility::ParallelFor<index_t>(0, num_points, 0, [&](index_t begin, index_t end) {
+            for (index_t idx = begin; idx < end; ++idx) {
+                keys[idx] = std::make_pair(cell_key(cell_of(data->get_position(idx))), idx);
+            }
+        });
+        std::sort(keys.begin(), keys.end());
+
+        _order.resize(num_points);
+        for (index_t i = 0; i < num_points; ++i) {
+            _order[i] = keys[i].second;
+            if (i == 0 || keys[i].first != keys[i - 1].first) {
+                _cell_keys.push_back(keys[i].first);
+                _cell_starts.push_back(i);
+            }
+        }
+        _cell_starts.push_back(num_points);
+    }
+
+    index_t size() const {
+        return _data->kdtree_get_point_count();
+    }
+
+    template<typename Func>
+    void operator()(index_t idx, buffer_t&, Func&& func) const {
+        auto const pos = _data->get_position(idx);
+        auto const center = cell_of(pos);
+
+        std::array<uint64_t, DIM> cell;
+        visit_cells(center, cell, 0, [&](std::array<uint64_t, DIM> const& neighbor_cell) {
+            auto const key = cell_key(neighbor_cell);
+            auto const it = std::lower_bound(_cell_keys.cbegin(), _cell_keys.cend(), key);
+            if (it == _cell_keys.cend() || *it != key)
+                return;
+            auto const cell_idx = std::distance(_cell_keys.cbegin(), it);
+            for (auto i = _cell_starts[cell_idx]; i < _cell_starts[cell_idx + 1]; ++i) {
+                auto const other = _order[i];
+                if (_data->kdtree_distance(pos, other, DIM) < _eps) {
+                    func(other);
+                }
+            }
+        });
+    }
+
+private:
+    std::array<uint64_t, DIM> cell_of(T const* pos) const {
+        std::array<uint64_t, DIM> cell;
+        for (int d = 0; d < DIM; ++d) {
+            auto const c = _cell_count[d] > 1 ? static_cast<uint64_t>((pos[d] - _mins[d]) / _cell_size[d]) : 0;
+            cell[d] = std::min(c, _cell_count[d] - 1);
+        }
+        return cell;
+    }
+
+    uint64_t cell_key(std::array<uint64_t, DIM> const& cell) const {
+        uint64_t key = 0;
+        for (int d = DIM - 1; d >= 0; --d) {
+            key = key * _cell_count[d] + cell[d];
+        }
+        return key;
+    }
+
+    template<typename Func>
+    void visit_cells(std::array<uint64_t, DIM> const& center, std::array<uint64_t, DIM>& cell, int dim,
+        Func const& func) const {
+        if (dim == DIM) {
+            func(cell);
+            return;
+        }
+        auto const first = center[dim] > 0 ? center[dim] - 1 : 0;
+        auto const last = std::min(center[dim] + 1, _cell_count[dim] - 1);
+        for (auto c = first; c <= last; ++c) {
+            cell[dim] = c;
+            visit_cells(center, cell, dim + 1, func);
+        }
+    }
+
+    std::shared_ptr<genericPointcloud<T, DIM>> _data;
+    T _eps;
+    std::array<T, DIM> _mins;
+    std::array<T, DIM> _cell_size;
+    std::array<uint64_t, DIM> _cell_count;
+    std::vector<index_t> _order;
+    std::vector<uint64_t> _cell_keys;
+    std::vector<index_t> _cell_starts;
+};
+
+/**
+ * Parallel DBSCAN with a lock-free union-find over arbitrary neighborhood queries.
+ * The points are processed in batches on the task scheduler, each batch reuses its query buffer.
+ * A first pass counts the similar neighbors of every point to find the core points, a second pass unites
+ * neighboring core points and assigns border points to their smallest core neighbor.
+ * Cluster ids start after NOISE and are ordered by the smallest core point of each cluster. Core points and noise
+ * are the same as in the sequential DBSCAN, border points reachable from several clusters may differ.
+ *
+ * @param neighbors  The neighborhood queries, e.g. kd_tree_neighbors or grid_neighbors.
+ * @param minPts     The minimum number of similar neighbors of a core point, including itself.
+ * @param similarity Predicate bool(index_t, index_t) filtering the neighbors. Called concurrently.
+ *
+ * @return The cluster id of each point.
+ */
+template<typename Neighbors, typename Predicate = no_similarity>
+inline cluster_result_t DBSCAN_union_find(
+    Neighbors const& neighbors, index_t minPts, Predicate const& similarity = Predicate()) {
+    constexpr index_t batch_size = 1024;
+    constexpr auto none = std::numeric_limits<index_t>::max();
+    auto const num_points = neighbors.size();
+
+    std::vector<char> core(num_points, 0);
+    core::utility::ParallelFor<index_t>(0, num_points, batch_size, [&](index_t begin, index_t end) {
+        typename Neighbors::buffer_t buffer;
+        for (index_t idx = begin; idx < end; ++idx) {
+            index_t count = 0;
+            neighbors(idx, buffer, [&](index_t other) {
+                if (similarity(idx, other))
+                    ++count;
+            });
+            core[idx] = count >= minPts ? 1 : 0;
+        }
+    });
+
+    concurrent_disjoint_sets<index_t> sets(num_points);
+    std::unique_ptr<std::atomic<index_t>[]> owner(new std::atomic<index_t>[num_points]);
+    for (index_t idx = 0; idx < num_points; ++idx) {
+        owner[idx].store(none, std::memory_order_relaxed);
+    }
+    core::utility::ParallelFor<index_t>(0, num_points, batch_size, [&](index_t begin, index_t end) {
+        typename Neighbors::buffer_t buffer;
+        for (index_t idx = begin; idx < end; ++idx) {
+            if (core[idx] == 0)
+                continue;
+            neighbors(idx, buffer, [&](index_t other) {
+                if (other == idx || !similarity(idx, other))
+                    return;
+                if (core[other] != 0) {
+                    sets.unite(idx, other);
+                } else {
+                    auto current = owner[other].load(std::memory_order_relaxed);
+                    while (idx < current &&
+                           !owner[other].compare_exchange_weak(current, idx, std::memory_order_relaxed)) {}
+                }
+            });
+        }
+    });
+
+    cluster_result_t clusters(num_points, static_cast<cluster_type_ut>(cluster_type::NOISE));
+    index_t cluster_idx = static_cast<cluster_type_ut>(cluster_type::NOISE);
+    for (index_t idx = 0; idx < num_points; ++idx) {
+        if (core[idx] != 0 && sets.find(idx) == idx) {
+            clusters[idx] = ++cluster_idx;
+        }
+    }
+    core::utility::ParallelFor<index_t>(0, num_points, 0, [&](index_t begin, index_t end) {
+        for (index_t idx = begin; idx < end; ++idx) {
+            if (core[idx] != 0) {
+                clusters[idx] = clusters[sets.find(idx)];
+            } else {
+                auto const core_idx = owner[idx].load(std::memory_order_relaxed);
+                if (core_idx != none)
+                    clusters[idx] = clusters[sets.find(core_idx)];
+            }
+        }
+    });
+
+    return clusters;
+}
+
+/** Parallel DBSCAN on a kd-tree, eps is squared like the distances of the kd-tree. */
+template<typename T, int DIM, typename Predicate = no_similarity>
+inline cluster_result_t DBSCAN_parallel(std::shared_ptr<kd_tree_t<T, DIM>> const& D, T eps, index_t minPts,
+    Predicate const& similarity = Predicate()) {
+    return DBSCAN_union_find(kd_tree_neighbors<T, DIM>(D, eps), minPts, similarity);
+}
+
+/** Parallel DBSCAN on a uniform grid, eps is squared like the distances of the kd-tree. */
+template<typename T, int DIM, typename Predicate = no_similarity>
+inline cluster_result_t DBSCAN_grid(std::shared_ptr<genericPointcloud<T, DIM>> const& data, T eps, index_t minPts,
+    Predicate const& similarity = Predicate()) {
+    return DBSCAN_union_find(grid_neighbors<T, DIM>(data, eps), minPts, similarity);
+}
+
+
+/**
+ * Sparse similarity graph in compressed row storage. The neighbors of node i are
+ * neighbors[offsets[i]..offsets[i + 1]) with the dissimilarity of each edge in weights, smaller is more similar.
+ */
+struct similarity_graph_t {
+    std::vector<index_t> offsets;
+    std::vector<index_t> neighbors;
+    std::vector<float> weights;
+
+    index_t node_count() const {
+        return offsets.empty() ? 0 : offsets.size() - 1;
+    }
+
+    index_t degree(index_t idx) const {
+        return offsets[idx + 1] - offsets[idx];
+    }
+};
+
+/**
+ * Builds the similarity graph over the spatial neighborhoods of all points in parallel.
+ * Only pairs within the search radius are evaluated, so the cost grows with the number of points times the
+ * neighborhood size instead of quadratically.
+ *
+ * @param D      The search structure over the points.
+ * @param eps    The search radius, squared like the distances of the kd-tree.
+ * @param k      The maximum number of edges per node, the k most similar neighbors are kept. 0 keeps all.
+ * @param weight Functor bool(index_t a, index_t b, float& weight) that answers whether a and b are similar and
+ *               writes their dissimilarity into weight. Called concurrently.
+ *
+ * @return The graph, edges are directed from each node to the neighbors it considers similar.
+ */
+template<typename T, int DIM, typename Weight>
+inline similarity_graph_t build_similarity_graph(
+    std::shared_ptr<kd_tree_t<T, DIM>> const& D, T eps, index_t k, Weight const& weight) {
+    auto const& data = D->dataset;
+    auto const num_points = data.kdtree_get_point_count();
+
+    std::vector<std::vector<std::pair<index_t, float>>> edges(num_points);
+
+    core::utility::ParallelFor<index_t>(0, num_points, 0, [&](index_t begin, index_t end) {
+        nanoflann::SearchParams params;
+        params.sorted = false;
+        search_res_t<T> tmp_res;
+        for (index_t idx = begin; idx < end; ++idx) {
+            D->radiusSearch(data.get_position(idx), eps, tmp_res, params);
+            auto& cur_edges = edges[idx];
+            for (auto const& el : tmp_res) {
+                float w = 0.0f;
+                if (el.first != idx && weight(idx, el.first, w)) {
+                    cur_edges.emplace_back(el.first, w);
+                }
+            }
+            if (k > 0 && cur_edges.size() > k) {
+                std::nth_element(cur_edges.begin(), cur_edges.begin() + k, cur_edges.end(),
+                    [](auto const& lhs, auto const& rhs) { return lhs.second < rhs.second; });
+                cur_edges.resize(k);
+            }
+        }
+    });
+
+    similarity_graph_t graph;
+    graph.offsets.resize(num_points + 1, 0);
+    for (index_t idx = 0; idx < num_points; ++idx) {
+        graph.offsets[idx + 1] = graph.offsets[idx] + edges[idx].size();
+    }
+    graph.neighbors.resize(graph.offsets.back());
+    graph.weights.resize(graph.offsets.back());
+    core::utility::ParallelFor<index_t>(0, num_points, 0, [&](index_t begin, index_t end) {
+        for (index_t idx = begin; idx < end; ++idx) {
+            auto out = graph.offsets[idx];
+            for (auto const& el : edges[idx]) {
+                graph.neighbors[out] = el.first;
+                graph.weights[out] = el.second;
+                ++out;
+            }
+            std::vector<std::pair<index_t, float>>().swap(edges[idx]);
+        }
+    });
+
+    return graph;
+}
+
+/**
+ * DBSCAN-like region growing on a similarity graph. Nodes with at least minPts similar neighbors are core nodes,
+ * connected core nodes form a cluster. Other nodes that share an edge with a core node join the cluster of that node
+ * as border nodes (the one with the smallest cluster id if there are several), all remaining nodes stay UNDEFINED.
+ * Core nodes are merged in parallel with a lock-free union-find. Cluster ids start after NOISE and are assigned in
+ * order of the smallest core node of each cluster, which for minPts <= 1 gives the same result as the sequential
+ * GROWING_with_similarity_and_score for symmetric similarities and k = 0.
+ *
+ * @param graph  The similarity graph.
+ * @param minPts The minimum number of similar neighbors of a core node, values below 1 are treated as 1.
+ *
+ * @return The cluster id of each node.
+ */
+inline cluster_result_t GROWING_on_graph(similarity_graph_t const& graph, index_t minPts) {
+    auto const num_points = graph.node_count();
+    auto const min_degree = std::max<index_t>(minPts, 1);
+    cluster_result_t clusters(num_points, static_cast<cluster_type_ut>(cluster_type::UNDEFINED));
+    concurrent_disjoint_sets<index_t> sets(num_points);
+    std::vector<char> core(num_points, 0);
+
+    core::utility::ParallelFor<index_t>(0, num_points, 0, [&](index_t begin, index_t end) {
+        for (index_t idx = begin; idx < end; ++idx) {
+            core[idx] = graph.degree(idx) >= min_degree ? 1 : 0;
+        }
+    });
+    core::utility::ParallelFor<index_t>(0, num_points, 0, [&](index_t begin, index_t end) {
+        for (index_t idx = begin; idx < end; ++idx) {
+            if (core[idx] == 0)
+                continue;
+            for (auto e = graph.offsets[idx]; e < graph.offsets[idx + 1]; ++e) {
+                if (core[graph.neighbors[e]] != 0) {
+                    sets.unite(idx, graph.neighbors[e]);
+                }
+            }
+        }
+    });
+
+    // roots are the smallest members, so numbering the roots in order numbers clusters by their smallest member
+    index_t cluster_idx = static_cast<cluster_type_ut>(cluster_type::NOISE);
+    for (index_t idx = 0; idx < num_points; ++idx) {
+        if (core[idx] != 0 && sets.find(idx) == idx) {
+            clusters[idx] = ++cluster_idx;
+        }
+    }
+    core::utility::ParallelFor<index_t>(0, num_points, 0, [&](index_t begin, index_t end) {
+        for (index_t idx = begin; idx < end; ++idx) {
+            if (core[idx] != 0) {
+                clusters[idx] = clusters[sets.find(idx)];
+            }
+        }
+    });
+
+    // the graph may be directed, so border nodes are looked up along the edges in both directions
+    auto const undefined = static_cast<cluster_type_ut>(cluster_type::UNDEFINED);
+    auto const attach = [&clusters, undefined](index_t border, index_t cluster) {
+        if (clusters[border] == undefined || cluster < clusters[border]) {
+            clusters[border] = cluster;
+        }
+    };
+    for (index_t idx = 0; idx < num_points; ++idx) {
+        for (auto e = graph.offsets[idx]; e < graph.offsets[idx + 1]; ++e) {
+            auto const other = graph.neighbors[e];
+            if (core[idx] != 0 && core[other] == 0) {
+                attach(other, clusters[idx]);
+            } else if (core[idx] == 0 && core[other] != 0) {
+                attach(idx, clusters[other]);
+            }
+        }
+    }
+
+    return clusters;
+}
+
+/**
+ * Scores every node by the mean dissimilarity to its neighbors in the same cluster. Each edge is visited once,
+ * instead of comparing all pairs of cluster members. Nodes without such neighbors get the maximum float.
+ *
+ * @param graph    The similarity graph.
+ * @param clusters The cluster ids of the nodes.
+ *
+ * @return The score of each node, smaller is more representative.
+ */
+inline std::vector<float> cluster_scores(similarity_graph_t const& graph, cluster_result_t const& clusters) {
+    auto const num_points = graph.node_count();
+    std::vector<float> sums(num_points, 0.0f);
+    std::vector<index_t> counts(num_points, 0);
+
+    // the graph may be directed, so edges are accumulated at both ends
+    for (index_t idx = 0; idx < num_points; ++idx) {
+        for (auto e = graph.offsets[idx]; e < graph.offsets[idx + 1]; ++e) {
+            auto const other = graph.neighbors[e];
+            if (clusters[idx] != clusters[other])
+                continue;
+            sums[idx] += graph.weights[e];
+            sums[other] += graph.weights[e];
+            ++counts[idx];
+            ++counts[other];
+        }
+    }
+
+    std::vector<float> scores(num_points, std::numeric_limits<float>::max());
+    for (index_t idx = 0; idx < num_points; ++idx) {
+        if (counts[idx] > 0) {
+            scores[idx] = sums[idx] / static_cast<float>(counts[idx]);
+        }
+    }
+    return scores;
+}
+
 } // namespace megamol::datatools::clustering
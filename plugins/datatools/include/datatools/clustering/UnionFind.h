@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace megamol::datatools::clustering {
+
+/**
+ * Disjoint sets that support concurrent unite and find operations without locks.
+ * Sets are always linked below the smaller root index, so the root of a set is its smallest element.
+ * This keeps the result independent of the order in which threads unite the sets.
+ */
+template<typename I>
+class concurrent_disjoint_sets {
+public:
+    explicit concurrent_disjoint_sets(std::size_t size) : _size(size), _parents(new std::atomic<I>[size]) {
+        for (std::size_t i = 0; i < size; ++i) {
+            _parents[i].store(static_cast<I>(i), std::memory_order_relaxed);
+        }
+    }
+
+    std::size_t size() const {
+        return _size;
+    }
+
+    I find(I idx) const {
+        while (true) {
+            auto parent = _parents[idx].load(std::memory_order_acquire);
+            if (parent == idx)
+                return idx;
+            auto const grand_parent = _parents[parent].load(std::memory_order_acquire);
+            if (parent != grand_parent) {
+                // path halving, failing is fine since another thread shortened the path already
+                _parents[idx].compare_exchange_weak(parent, grand_parent, std::memory_order_acq_rel);
+            }
+            idx = grand_parent;
+        }
+    }
+
+    void unite(I lhs, I rhs) {
+        while (true) {
+            lhs = find(lhs);
+            rhs = find(rhs);
+            if (lhs == rhs)
+                return;
+            if (lhs < rhs)
+                std::swap(lhs, rhs);
+            // link the larger root below the smaller one, retry if lhs got linked meanwhile
+            auto expected = lhs;
+            if (_parents[lhs].compare_exchange_strong(expected, rhs, std::memory_order_acq_rel))
+                return;
+        }
+    }
+
+    bool same(I lhs, I rhs) const {
+        while (true) {
+            lhs = find(lhs);
+            rhs = find(rhs);
+            if (lhs == rhs)
+                return true;
+            // lhs is still a root, so the sets were different at this point in time
+            if (_parents[lhs].load(std::memory_order_acquire) == lhs)
+                return false;
+        }
+    }
+
+private:
+    std::size_t _size;
+
+    std::unique_ptr<std::atomic<I>[]> _parents;
+};
+
+} // namespace megamol::datatools::clustering
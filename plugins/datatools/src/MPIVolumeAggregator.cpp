@@ -6,6 +6,7 @@
  */
 #include "MPIVolumeAggregator.h"
 #include "geometry_calls/MultiParticleDataCall.h"
+#include "geometry_calls/VolumetricStatistics.h"
 #include "mmcore/cluster/mpi/MpiCall.h"
 #include "mmcore/param/EnumParam.h"
 #include "mmcore/utility/sys/SystemInformation.h"
@@ -99,12 +100,6 @@ bool datatools::MPIVolumeAggregator::manipulateData(
 
     MPI_Op op = MPI_SUM;
     const auto opVal = this->operatorSlot.Param<core::param::EnumParam>()->Value();
-    if (comp > 1) {
-        megamol::core::utility::log::Log::DefaultLog.WriteWarn(
-            "MPIVolumeAggregator: multi-component volume detected! Computing min/max density on the first component "
-            "only. Op %s is applied on all components.",
-            this->operatorSlot.Param<core::param::EnumParam>()->getMap()[opVal].PeekBuffer());
-    }
     switch (opVal) {
     case 0:
         op = MPI_MAX;
@@ -132,25 +127,25 @@ bool datatools::MPIVolumeAggregator::manipulateData(
     const auto endTime = std::chrono::high_resolution_clock::now();
     std::chrono::duration<float, std::milli> diffMillis = endTime - startTime;
 
-    const int chunkSize = (numFloats) / this->mpiSize + 1;
-    float min = std::numeric_limits<float>::max();
-    float max = 0.0f;
-    float globalmin = min;
-    float globalmax = max;
-    const int end = std::min<int>((this->mpiRank + 1) * chunkSize, numFloats);
-    for (int x = this->mpiRank * chunkSize; x < end; x += comp) {
-        auto& d = this->theVolume.data()[x];
-        if (d < min) {
-            min = d;
-        }
-        if (d > max) {
-            max = d;
+    // every rank computes the range of its share of the voxels, which is then made global
+    const size_t numVoxels = numFloats / comp;
+    const size_t chunkSize = numVoxels / this->mpiSize + 1;
+    const size_t begin = std::min<size_t>(this->mpiRank * chunkSize, numVoxels);
+    const size_t end = std::min<size_t>(begin + chunkSize, numVoxels);
+    const auto stats = geocalls::VolumetricStatistics::Compute(
+        this->theVolume.data() + begin * comp, geocalls::FLOATING_POINT, sizeof(float), comp, end - begin, 0);
+
+    std::vector<float> mins(comp, std::numeric_limits<float>::max());
+    std::vector<float> maxs(comp, std::numeric_limits<float>::lowest());
+    if (end > begin) {
+        for (size_t c = 0; c < comp; ++c) {
+            mins[c] = static_cast<float>(stats.GetMinValue(c));
+            maxs[c] = static_cast<float>(stats.GetMaxValue(c));
         }
     }
-
-    // now make min max global
-    MPI_Allreduce(&min, &globalmin, 1, MPI_FLOAT, MPI_MIN, this->comm);
-    MPI_Allreduce(&max, &globalmax, 1, MPI_FLOAT, MPI_MAX, this->comm);
+    std::vector<float> globalmins(comp), globalmaxs(comp);
+    MPI_Allreduce(mins.data(), globalmins.data(), comp, MPI_FLOAT, MPI_MIN, this->comm);
+    MPI_Allreduce(maxs.data(), globalmaxs.data(), comp, MPI_FLOAT, MPI_MAX, this->comm);
 
     const auto endAllTime = std::chrono::high_resolution_clock::now();
     std::chrono::duration<float, std::milli> diffAllMillis = endAllTime - startAllTime;
@@ -162,8 +157,10 @@ bool datatools::MPIVolumeAggregator::manipulateData(
         metadata.Resolution[1], metadata.Resolution[2], diffAllMillis.count());
 
     outData.SetData(this->theVolume.data());
-    metadata.MinValues[0] = globalmin;
-    metadata.MaxValues[0] = globalmax;
+    for (size_t c = 0; c < comp; ++c) {
+        metadata.MinValues[c] = globalmins[c];
+        metadata.MaxValues[c] = globalmaxs[c];
+    }
     outData.SetMetadata(&metadata);
 #endif /* WITH_MPI */
 
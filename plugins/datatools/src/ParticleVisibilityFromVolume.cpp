@@ -13,6 +13,7 @@
 #include <chrono>
 #include <omp.h>
 
+#include "geometry_calls/VolumetricBrickSampler.h"
 #include "geometry_calls/VolumetricDataCall.h"
 
 using namespace megamol;
@@ -92,7 +93,10 @@ bool datatools::ParticleVisibilityFromVolume::manipulateData(
             "ParticleVisibilityFromVolume: cannot get extents of volume");
         return false;
     }
-    if (!(*inVol)(0)) {
+    // Bricked sources only deliver the parts of the volume the particles are in.
+    geocalls::VolumetricBrickSampler sampler;
+    const bool bricked = sampler.Open(*inVol);
+    if (!bricked && !(*inVol)(0)) {
         megamol::core::utility::log::Log::DefaultLog.WriteError("ParticleVisibilityFromVolume: cannot get volume data");
         return false;
     }
@@ -119,7 +123,6 @@ bool datatools::ParticleVisibilityFromVolume::manipulateData(
     megamol::core::utility::log::Log::DefaultLog.WriteInfo("Computing Visibility from Volume...");
 
     const VolumetricDataCall::Metadata* volMeta = inVol->GetMetadata();
-    const auto theVol = inVol->GetData();
 
     if (!volMeta->GridType == VolumetricDataCall::GridType::CARTESIAN ||
         !volMeta->GridType == VolumetricDataCall::GridType::RECTILINEAR) {
@@ -148,6 +151,21 @@ bool datatools::ParticleVisibilityFromVolume::manipulateData(
         getFun = &VolumetricDataCall::GetRelativeVoxelValue;
     }
 
+    const auto minValue = volMeta->MinValues[channel];
+    const auto maxValue = volMeta->MaxValues[channel];
+    auto getVoxel = [&](const uint32_t x, const uint32_t y, const uint32_t z) -> float {
+        if (!bricked) {
+            return ((inVol)->*(getFun))(x, y, z, channel);
+        }
+        auto retval = static_cast<float>(sampler.Value(std::min<size_t>(x, volMeta->Resolution[0] - 1),
+            std::min<size_t>(y, volMeta->Resolution[1] - 1), std::min<size_t>(z, volMeta->Resolution[2] - 1), channel));
+        if (!absolute) {
+            retval -= minValue;
+            retval /= (maxValue - minValue);
+        }
+        return retval;
+    };
+
     megamol::core::utility::log::Log::DefaultLog.WriteInfo("ParticleVisibilityFromVolume: starting filtering");
     const auto startTime = std::chrono::high_resolution_clock::now();
 
@@ -201,6 +219,37 @@ bool datatools::ParticleVisibilityFromVolume::manipulateData(
         auto const& yAcc = parStore.GetYAcc();
         auto const& zAcc = parStore.GetZAcc();
 
+        if (bricked) {
+            // Fetch the bricks holding the voxels around any particle before sampling in parallel.
+            const auto& index = sampler.GetIndex();
+            std::vector<char> isTouched(index.Count(), 0);
+            for (INT64 j = 0; j < cnt; ++j) {
+                const auto rx = (xAcc->Get_f(j) - volMeta->Origin[0]) / volMeta->SliceDists[0][0];
+                const auto ry = (yAcc->Get_f(j) - volMeta->Origin[1]) / volMeta->SliceDists[1][0];
+                const auto rz = (zAcc->Get_f(j) - volMeta->Origin[2]) / volMeta->SliceDists[2][0];
+                const size_t quant[3] = {static_cast<size_t>(std::max(0.0f, rx)),
+                    static_cast<size_t>(std::max(0.0f, ry)), static_cast<size_t>(std::max(0.0f, rz))};
+                for (int k = 0; k < 8; ++k) {
+                    const auto bx = std::min<size_t>(volMeta->Resolution[0] - 1, quant[0] + (k & 1));
+                    const auto by = std::min<size_t>(volMeta->Resolution[1] - 1, quant[1] + ((k >> 1) & 1));
+                    const auto bz = std::min<size_t>(volMeta->Resolution[2] - 1, quant[2] + ((k >> 2) & 1));
+                    isTouched[index.GetBrickAt(0, bx, by, bz)] = 1;
+                }
+            }
+
+            std::vector<size_t> bricks;
+            for (size_t b = 0; b < isTouched.size(); ++b) {
+                if (isTouched[b]) {
+                    bricks.push_back(b);
+                }
+            }
+            if (!sampler.Fetch(bricks)) {
+                megamol::core::utility::log::Log::DefaultLog.WriteError(
+                    "ParticleVisibilityFromVolume: cannot get volume bricks");
+                return false;
+            }
+        }
+
 // todo: is this OK?
 #pragma omp parallel for
         for (INT64 j = 0; j < cnt; ++j) {
@@ -238,14 +287,14 @@ bool datatools::ParticleVisibilityFromVolume::manipulateData(
             quantY2 = std::max<size_t>(0, std::min<size_t>(volMeta->Resolution[1] - 1, quantY + 1));
             quantZ2 = std::max<size_t>(0, std::min<size_t>(volMeta->Resolution[2] - 1, quantZ + 1));
 
-            const float c000 = ((inVol)->*(getFun))(quantX, quantY, quantZ, channel);
-            const float c100 = ((inVol)->*(getFun))(quantX2, quantY, quantZ, channel);
-            const float c010 = ((inVol)->*(getFun))(quantX, quantY2, quantZ, channel);
-            const float c110 = ((inVol)->*(getFun))(quantX2, quantY2, quantZ, channel);
-            const float c001 = ((inVol)->*(getFun))(quantX, quantY, quantZ2, channel);
-            const float c101 = ((inVol)->*(getFun))(quantX2, quantY, quantZ2, channel);
-            const float c011 = ((inVol)->*(getFun))(quantX, quantY2, quantZ2, channel);
-            const float c111 = ((inVol)->*(getFun))(quantX2, quantY2, quantZ2, channel);
+            const float c000 = getVoxel(quantX, quantY, quantZ);
+            const float c100 = getVoxel(quantX2, quantY, quantZ);
+            const float c010 = getVoxel(quantX, quantY2, quantZ);
+            const float c110 = getVoxel(quantX2, quantY2, quantZ);
+            const float c001 = getVoxel(quantX, quantY, quantZ2);
+            const float c101 = getVoxel(quantX2, quantY, quantZ2);
+            const float c011 = getVoxel(quantX, quantY2, quantZ2);
+            const float c111 = getVoxel(quantX2, quantY2, quantZ2);
 
             float volVal = (1.0f - diffX) * (1.0f - diffY) * (1.0f - diffZ) * c000 +
                            diffX * (1.0f - diffY) * (1.0f - diffZ) * c100 +
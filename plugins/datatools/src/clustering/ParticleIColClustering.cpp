@@ -1,6 +1,7 @@
 #include "datatools/clustering/ParticleIColClustering.h"
 #include "stdafx.h"
 
+#include "mmcore/param/EnumParam.h"
 #include "mmcore/param/FloatParam.h"
 #include "mmcore/param/IntParam.h"
 
@@ -9,7 +10,8 @@ megamol::datatools::clustering::ParticleIColClustering::ParticleIColClustering()
         : AbstractParticleManipulator("outData", "inData")
         , _eps_slot("eps", "")
         , _minpts_slot("minpts", "")
-        , _icol_weight("icol weight", "") {
+        , _icol_weight("icol weight", "")
+        , _search_slot("search structure", "Spatial search structure for the neighborhood queries") {
     _eps_slot << new core::param::FloatParam(0.1f, 0.0f, 1.0f);
     MakeSlotAvailable(&_eps_slot);
 
@@ -18,6 +20,12 @@ megamol::datatools::clustering::ParticleIColClustering::ParticleIColClustering()
 
     _icol_weight << new core::param::FloatParam(0.5f, 0.0f, 1.0f);
     MakeSlotAvailable(&_icol_weight);
+
+    auto ep = new core::param::EnumParam(0);
+    ep->SetTypePair(0, "kd-tree");
+    ep->SetTypePair(1, "grid");
+    _search_slot << ep;
+    MakeSlotAvailable(&_search_slot);
 }
 
 
@@ -38,6 +46,9 @@ bool megamol::datatools::clustering::ParticleIColClustering::manipulateData(
         auto const eps = _eps_slot.Param<core::param::FloatParam>()->Value();
         auto const minpts = static_cast<index_t>(_minpts_slot.Param<core::param::IntParam>()->Value());
         auto const icol_weight = _icol_weight.Param<core::param::FloatParam>()->Value();
+        auto const use_grid = _search_slot.Param<core::param::EnumParam>()->Value() == 1;
+        auto const rebuild = _frame_id != inData.FrameID() || _in_data_hash != inData.DataHash() ||
+                             _icol_weight.IsDirty();
 
         std::array<float, 4> weights = {(1.0f - icol_weight), (1.0f - icol_weight), (1.0f - icol_weight), icol_weight};
 
@@ -56,8 +67,8 @@ bool megamol::datatools::clustering::ParticleIColClustering::manipulateData(
 
             auto const p_count = parts.GetCount();
 
-            if (_frame_id != inData.FrameID() || _in_data_hash != inData.DataHash()) {
-                // rebuild search structure
+            if (rebuild || _points[pl_idx] == nullptr) {
+                // rebuild point cloud, the weights scale the data
 
                 std::vector<float> cur_points(p_count * 4);
 
@@ -79,13 +90,17 @@ bool megamol::datatools::clustering::ParticleIColClustering::manipulateData(
 
                 _points[pl_idx] = std::make_shared<genericPointcloud<float, 4>>(cur_points, bbox, weights);
                 _points[pl_idx]->normalize_data();
+                _kd_trees[pl_idx] = nullptr;
+            }
 
+            if (!use_grid && _kd_trees[pl_idx] == nullptr) {
                 _kd_trees[pl_idx] = std::make_shared<kd_tree_t<float, 4>>(
                     4, *_points[pl_idx], nanoflann::KDTreeSingleIndexAdaptorParams());
                 _kd_trees[pl_idx]->buildIndex();
             }
 
-            auto const cluster_res = DBSCAN(_kd_trees[pl_idx], eps * eps, minpts);
+            auto const cluster_res = use_grid ? DBSCAN_grid<float, 4>(_points[pl_idx], eps * eps, minpts)
+                                              : DBSCAN_parallel<float, 4>(_kd_trees[pl_idx], eps * eps, minpts);
 
             _ret_cols[pl_idx].resize(p_count);
             std::transform(cluster_res.cbegin(), cluster_res.cend(), _ret_cols[pl_idx].begin(),
@@ -11,6 +11,10 @@
 #include "mmcore/param/FilePathParam.h"
 #include "mmcore/param/FlexEnumParam.h"
 #include "mmcore/param/FloatParam.h"
+#include "mmcore/utility/TaskScheduler.h"
+#include "mesh/MeshIngest.h"
+#include <atomic>
+#include <mutex>
 #include <array>
 #include <fstream>
 #include <sstream>
@@ -240,9 +244,9 @@ bool io::PLYDataSource::assertData() {
     if (posPointers.pos_double != nullptr || posPointers.pos_float != nullptr)
         return true;
 
-    instream.close();
-    instream.open(filename.Param<core::param::FilePathParam>()->Value(), std::ios::binary);
-    if (instream.fail()) {
+    mesh::ingest::MappedFile file;
+    if (!file.open(filename.Param<core::param::FilePathParam>()->Value().generic_u8string()) ||
+        file.size() < this->data_offset) {
         megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_ERROR,
             "Unable to open PLY File \"%s\".",
             filename.Param<core::param::FilePathParam>()->Value().generic_u8string().c_str());
@@ -251,8 +255,6 @@ bool io::PLYDataSource::assertData() {
     // if one of these pointers is not null, we already have read the data
     //if (posPointers.pos_double != nullptr || posPointers.pos_float != nullptr) return true;
 
-    // jump to the data in the file
-    instream.seekg(this->data_offset, instream.beg);
     size_t vertexCount = 0;
     size_t faceCount = 0;
 
@@ -341,15 +343,11 @@ bool io::PLYDataSource::assertData() {
         }
     }
 
-    auto const flt_max = std::numeric_limits<float>::max();
-    auto const flt_min = std::numeric_limits<float>::lowest();
-    this->boundingBox.Set(flt_max, flt_max, flt_max, flt_min, flt_min, flt_min);
-    float* bbPointer = const_cast<float*>(boundingBox.PeekBounds()); // hackedihack
-
     if (this->hasBinaryFormat) {
-        // vector storing the read data seperately
-        std::vector<std::vector<char>> readData(this->elementCount.size());
-        for (size_t i = 0; i < readData.size(); i++) {
+        // locate the elements in the mapped file, the data is read from there directly
+        std::vector<char const*> elementData(this->elementCount.size());
+        uint64_t offset = this->data_offset;
+        for (size_t i = 0; i < elementData.size(); i++) {
             // maybe TODO: skip unnecessary elements
             uint64_t readsize = elementSizes[i];
             if (elementIndexMap.count(selectedIndices) > 0) {
@@ -359,20 +357,30 @@ bool io::PLYDataSource::assertData() {
                     readsize = listSizes[idx.first][idx.second] + 3 * propertySizes[idx.first][idx.second];
                 }
             }
-            readData[i].resize(elementCount[i] * readsize);
-            auto ms = readData[i].max_size();
-            instream.read(reinterpret_cast<char*>(readData[i].data()), elementCount[i] * readsize);
-            if (instream.fail()) {
+            if (offset + elementCount[i] * readsize > file.size()) {
                 megamol::core::utility::log::Log::DefaultLog.WriteError(
                     "Reading of the field with index %i failed", static_cast<int>(i));
                 this->clearAllFields();
                 return false;
             }
+            elementData[i] = file.data() + offset;
+            offset += elementCount[i] * readsize;
         }
 
         // copy the data into the vectors (this is necessary because the data may be interleaved, which is not always
-        // the case)
-        // this could be done partially in parallel
+        // the case) and change the endianness if necessary
+        auto const copyComponent = [this](auto* target, size_t component, size_t count, char const* source,
+                                       uint64_t elemSize, uint64_t stride, uint64_t size) {
+            core::utility::ParallelFor<size_t>(0, count, 0, [&](size_t begin, size_t end) {
+                for (size_t v = begin; v < end; v++) {
+                    std::memcpy(&target[3 * v + component], source + v * elemSize + stride, size);
+                    if (!isLittleEndian) {
+                        changeEndianness(target[3 * v + component]);
+                    }
+                }
+            });
+        };
+
         for (size_t i = 0; i < selectedPos.size(); i++) {
             if (elementIndexMap.count(selectedPos[i]) > 0) {
                 auto idx = elementIndexMap[selectedPos[i]];
@@ -380,28 +388,12 @@ bool io::PLYDataSource::assertData() {
                 auto size = propertySizes[idx.first][idx.second];
                 auto stride = propertyStrides[idx.first][idx.second];
                 if (posPointers.pos_float != nullptr) {
-                    for (size_t v = 0; v < vertex_count; v++) {
-                        std::memcpy(
-                            &posPointers.pos_float[3 * v + i], &readData[idx.first][v * elemSize + stride], size);
-                        if (posPointers.pos_float[3 * v + i] < bbPointer[i]) {
-                            bbPointer[i] = posPointers.pos_float[3 * v + i];
-                        }
-                        if (posPointers.pos_float[3 * v + i] > bbPointer[i + 3]) {
-                            bbPointer[i + 3] = posPointers.pos_float[3 * v + i];
-                        }
-                    }
+                    copyComponent(
+                        posPointers.pos_float, i, vertex_count, elementData[idx.first], elemSize, stride, size);
                 }
                 if (posPointers.pos_double != nullptr) {
-                    for (size_t v = 0; v < vertex_count; v++) {
-                        std::memcpy(
-                            &posPointers.pos_double[3 * v + i], &readData[idx.first][v * elemSize + stride], size);
-                        if (posPointers.pos_double[3 * v + i] < bbPointer[i]) {
-                            bbPointer[i] = static_cast<float>(posPointers.pos_double[3 * v + i]);
-                        }
-                        if (posPointers.pos_double[3 * v + i] > bbPointer[i + 3]) {
-                            bbPointer[i + 3] = static_cast<float>(posPointers.pos_double[3 * v + i]);
-                        }
-                    }
+                    copyComponent(
+                        posPointers.pos_double, i, vertex_count, elementData[idx.first], elemSize, stride, size);
                 }
             }
         }
@@ -413,16 +405,12 @@ bool io::PLYDataSource::assertData() {
                 auto size = propertySizes[idx.first][idx.second];
                 auto stride = propertyStrides[idx.first][idx.second];
                 if (normalPointers.norm_float != nullptr) {
-                    for (size_t v = 0; v < vertex_count; v++) {
-                        std::memcpy(
-                            &normalPointers.norm_float[3 * v + i], &readData[idx.first][v * elemSize + stride], size);
-                    }
+                    copyComponent(
+                        normalPointers.norm_float, i, vertex_count, elementData[idx.first], elemSize, stride, size);
                 }
                 if (normalPointers.norm_double != nullptr) {
-                    for (size_t v = 0; v < vertex_count; v++) {
-                        std::memcpy(
-                            &normalPointers.norm_double[3 * v + i], &readData[idx.first][v * elemSize + stride], size);
-                    }
+                    copyComponent(
+                        normalPointers.norm_double, i, vertex_count, elementData[idx.first], elemSize, stride, size);
                 }
             }
         }
@@ -436,220 +424,205 @@ bool io::PLYDataSource::assertData() {
                 auto size = propertySizes[idx.first][idx.second];
                 auto stride = propertyStrides[idx.first][idx.second];
                 if (colorPointers.col_uchar != nullptr) {
-                    for (size_t v = 0; v < vertex_count; v++) {
-                        std::memcpy(
-                            &colorPointers.col_uchar[3 * v + i], &readData[idx.first][v * elemSize + stride], size);
-                    }
+                    copyComponent(
+                        colorPointers.col_uchar, i, vertex_count, elementData[idx.first], elemSize, stride, size);
                 }
                 if (colorPointers.col_float != nullptr) {
-                    for (size_t v = 0; v < vertex_count; v++) {
-                        std::memcpy(
-                            &colorPointers.col_float[3 * v + i], &readData[idx.first][v * elemSize + stride], size);
-                    }
+                    copyComponent(
+                        colorPointers.col_float, i, vertex_count, elementData[idx.first], elemSize, stride, size);
                 }
                 if (colorPointers.col_double != nullptr) {
-                    for (size_t v = 0; v < vertex_count; v++) {
-                        std::memcpy(
-                            &colorPointers.col_double[3 * v + i], &readData[idx.first][v * elemSize + stride], size);
-                    }
+                    copyComponent(
+                        colorPointers.col_double, i, vertex_count, elementData[idx.first], elemSize, stride, size);
                 }
             }
         }
 
         if (elementIndexMap.count(selectedIndices) > 0) {
             auto idx = elementIndexMap[selectedIndices];
-            auto elemSize = elementSizes[idx.first];
             auto size = propertySizes[idx.first][idx.second];
             auto stride = propertyStrides[idx.first][idx.second];
             auto listStartSize = listSizes[idx.first][idx.second];
             auto totSize = listStartSize + 3 * size;
+            auto const copyFaces = [&](auto* target) {
+                core::utility::ParallelFor<size_t>(0, face_count, 0, [&](size_t begin, size_t end) {
+                    for (size_t f = begin; f < end; f++) {
+                        std::memcpy(
+                            &target[f * 3], elementData[idx.first] + f * totSize + stride + listStartSize, 3 * size);
+                        if (!isLittleEndian) {
+                            changeEndianness(target[3 * f + 0]);
+                            changeEndianness(target[3 * f + 1]);
+                            changeEndianness(target[3 * f + 2]);
+                        }
+                    }
+                });
+            };
             if (facePointers.face_uchar != nullptr) {
-                for (size_t f = 0; f < face_count; f++) {
-                    std::memcpy(&facePointers.face_uchar[f * 3],
-                        &readData[idx.first][f * totSize + stride + listStartSize], 3 * size);
-                }
-            }
-            if (facePointers.face_u16 != nullptr) {
-                for (size_t f = 0; f < face_count; f++) {
-                    std::memcpy(&facePointers.face_u16[f * 3],
-                        &readData[idx.first][f * totSize + stride + listStartSize], 3 * size);
-                }
-            }
-            if (facePointers.face_u32 != nullptr) {
-                for (size_t f = 0; f < face_count; f++) {
-                    std::memcpy(&facePointers.face_u32[f * 3],
-                        &readData[idx.first][f * totSize + stride + listStartSize], 3 * size);
-                }
-            }
-        }
-        // change endianness if necessary
-        if (!isLittleEndian) {
-            // this could be done in parallel
-            if (posPointers.pos_float != nullptr) {
-                for (size_t v = 0; v < vertex_count; v++) {
-                    changeEndianness(posPointers.pos_float[3 * v + 0]);
-                    changeEndianness(posPointers.pos_float[3 * v + 1]);
-                    changeEndianness(posPointers.pos_float[3 * v + 2]);
-                }
-            }
-            if (posPointers.pos_double != nullptr) {
-                for (size_t v = 0; v < vertex_count; v++) {
-                    changeEndianness(posPointers.pos_double[3 * v + 0]);
-                    changeEndianness(posPointers.pos_double[3 * v + 1]);
-                    changeEndianness(posPointers.pos_double[3 * v + 2]);
-                }
-            }
-            if (normalPointers.norm_float != nullptr) {
-                for (size_t v = 0; v < vertex_count; v++) {
-                    changeEndianness(normalPointers.norm_float[3 * v + 0]);
-                    changeEndianness(normalPointers.norm_float[3 * v + 1]);
-                    changeEndianness(normalPointers.norm_float[3 * v + 2]);
-                }
-            }
-            if (normalPointers.norm_double != nullptr) {
-                for (size_t v = 0; v < vertex_count; v++) {
-                    changeEndianness(normalPointers.norm_double[3 * v + 0]);
-                    changeEndianness(normalPointers.norm_double[3 * v + 1]);
-                    changeEndianness(normalPointers.norm_double[3 * v + 2]);
-                }
-            }
-            if (colorPointers.col_uchar != nullptr) {
-                for (size_t v = 0; v < vertex_count; v++) {
-                    changeEndianness(colorPointers.col_uchar[3 * v + 0]);
-                    changeEndianness(colorPointers.col_uchar[3 * v + 1]);
-                    changeEndianness(colorPointers.col_uchar[3 * v + 2]);
-                }
-            }
-            if (colorPointers.col_float != nullptr) {
-                for (size_t v = 0; v < vertex_count; v++) {
-                    changeEndianness(colorPointers.col_float[3 * v + 0]);
-                    changeEndianness(colorPointers.col_float[3 * v + 1]);
-                    changeEndianness(colorPointers.col_float[3 * v + 2]);
-                }
-            }
-            if (colorPointers.col_double != nullptr) {
-                for (size_t v = 0; v < vertex_count; v++) {
-                    changeEndianness(colorPointers.col_double[3 * v + 0]);
-                    changeEndianness(colorPointers.col_double[3 * v + 1]);
-                    changeEndianness(colorPointers.col_double[3 * v + 2]);
-                }
-            }
-            if (facePointers.face_uchar != nullptr) {
-                for (size_t f = 0; f < face_count; f++) {
-                    changeEndianness(facePointers.face_uchar[3 * f + 0]);
-                    changeEndianness(facePointers.face_uchar[3 * f + 1]);
-                    changeEndianness(facePointers.face_uchar[3 * f + 2]);
-                }
+                copyFaces(facePointers.face_uchar);
             }
             if (facePointers.face_u16 != nullptr) {
-                for (size_t f = 0; f < face_count; f++) {
-                    changeEndianness(facePointers.face_u16[3 * f + 0]);
-                    changeEndianness(facePointers.face_u16[3 * f + 1]);
-                    changeEndianness(facePointers.face_u16[3 * f + 2]);
-                }
+                copyFaces(facePointers.face_u16);
             }
             if (facePointers.face_u32 != nullptr) {
-                for (size_t f = 0; f < face_count; f++) {
-                    changeEndianness(facePointers.face_u32[3 * f + 0]);
-                    changeEndianness(facePointers.face_u32[3 * f + 1]);
-                    changeEndianness(facePointers.face_u32[3 * f + 2]);
-                }
+                copyFaces(facePointers.face_u32);
             }
         }
     } else { // ascii format
-        std::string line;
+        // every element occupies one line per entry, in the order of the header
+        auto const lines = mesh::ingest::lineOffsets(file.data() + this->data_offset, file.size() - this->data_offset);
+        auto const lineRange = [&](size_t line) {
+            auto const* begin = file.data() + this->data_offset + lines[line];
+            auto const* end = line + 1 < lines.size() ? file.data() + this->data_offset + lines[line + 1]
+                                                      : file.data() + file.size();
+            return mesh::ingest::TextCursor(begin, end);
+        };
+
+        size_t firstLine = 0;
         for (size_t elm = 0; elm < this->elementCount.size(); elm++) {
+            bool const isVertices = icompare(elementNames[elm], selectedVertices);
+            bool const isFaces = icompare(elementNames[elm], selectedFaces) && elementIndexMap.count(selectedIndices);
+            auto const count = isVertices ? vertexCount : (isFaces ? faceCount : this->elementCount[elm]);
+            if (firstLine + count > lines.size()) {
+                megamol::core::utility::log::Log::DefaultLog.WriteError(
+                    isFaces ? "Unexpected file ending during face parsing"
+                            : "Unexpected file ending during vertex parsing");
+                return false;
+            }
+
             // parse vertices
-            if (icompare(elementNames[elm], selectedVertices)) {
-                for (size_t i = 0; i < vertexCount; i++) {
-                    if (std::getline(instream, line)) {
-                        auto split = isplit(line);
-                        for (size_t j = 0; j < selectedPos.size(); j++) {
-                            if (elementIndexMap.count(selectedPos[j]) > 0) {
-                                auto idx = elementIndexMap[selectedPos[j]];
+            if (isVertices) {
+                // the column of every component, -1 if not present
+                std::array<int64_t, 9> columns;
+                columns.fill(-1);
+                int64_t maxColumn = -1;
+                auto const assignColumns = [&](std::vector<std::string> const& selected, size_t first) {
+                    for (size_t j = 0; j < selected.size() && j < 3; j++) {
+                        if (elementIndexMap.count(selected[j]) > 0) {
+                            columns[first + j] = static_cast<int64_t>(elementIndexMap[selected[j]].second);
+                            maxColumn = std::max(maxColumn, columns[first + j]);
+                        }
+                    }
+                };
+                assignColumns(selectedPos, 0);
+                assignColumns(selectedNormal, 3);
+                assignColumns(selectedColor, 6);
+
+                std::atomic<bool> failed{false};
+                core::utility::ParallelFor<size_t>(0, vertexCount, 0, [&](size_t begin, size_t end) {
+                    std::vector<std::string_view> tokens(maxColumn + 1);
+                    for (size_t i = begin; i < end && !failed.load(std::memory_order_relaxed); i++) {
+                        auto cursor = lineRange(firstLine + i);
+                        for (auto& token : tokens) {
+                            token = cursor.token();
+                        }
+                        for (size_t c = 0; c < columns.size(); c++) {
+                            if (columns[c] < 0)
+                                continue;
+                            double d = 0.0;
+                            if (!core::utility::parseDouble(tokens[columns[c]], d)) {
+                                failed.store(true, std::memory_order_relaxed);
+                                break;
+                            }
+                            auto const target = 3 * i + c % 3;
+                            if (c < 3) {
                                 if (posPointers.pos_float != nullptr) {
-                                    posPointers.pos_float[3 * i + j] = std::stof(split[idx.second]);
+                                    posPointers.pos_float[target] = static_cast<float>(d);
                                 }
                                 if (posPointers.pos_double != nullptr) {
-                                    posPointers.pos_double[3 * i + j] = std::stod(split[idx.second]);
-                                }
-                                if (std::stof(split[idx.second]) < bbPointer[j]) {
-                                    bbPointer[j] = std::stof(split[idx.second]);
-                                }
-                                if (std::stof(split[idx.second]) > bbPointer[j + 3]) {
-                                    bbPointer[j + 3] = std::stof(split[idx.second]);
+                                    posPointers.pos_double[target] = d;
                                 }
-                            }
-                        }
-                        for (size_t j = 0; j < selectedNormal.size(); j++) {
-                            if (elementIndexMap.count(selectedNormal[j]) > 0) {
-                                auto idx = elementIndexMap[selectedNormal[j]];
+                            } else if (c < 6) {
                                 if (normalPointers.norm_float != nullptr) {
-                                    normalPointers.norm_float[3 * i + j] = std::stof(split[idx.second]);
+                                    normalPointers.norm_float[target] = static_cast<float>(d);
                                 }
                                 if (normalPointers.norm_double != nullptr) {
-                                    normalPointers.norm_double[3 * i + j] = std::stod(split[idx.second]);
+                                    normalPointers.norm_double[target] = d;
                                 }
-                            }
-                        }
-                        for (size_t j = 0; j < selectedColor.size(); j++) {
-                            if (elementIndexMap.count(selectedColor[j]) > 0) {
-                                auto idx = elementIndexMap[selectedColor[j]];
+                            } else {
                                 if (colorPointers.col_uchar != nullptr) {
-                                    colorPointers.col_uchar[3 * i + j] =
-                                        static_cast<unsigned char>(std::stoul(split[idx.second]));
+                                    colorPointers.col_uchar[target] = static_cast<unsigned char>(d);
                                 }
                                 if (colorPointers.col_float != nullptr) {
-                                    colorPointers.col_float[3 * i + j] = std::stof(split[idx.second]);
+                                    colorPointers.col_float[target] = static_cast<float>(d);
                                 }
                                 if (colorPointers.col_double != nullptr) {
-                                    colorPointers.col_double[3 * i + j] = std::stod(split[idx.second]);
+                                    colorPointers.col_double[target] = d;
                                 }
                             }
                         }
-                    } else {
-                        megamol::core::utility::log::Log::DefaultLog.WriteError(
-                            "Unexpected file ending during vertex parsing");
-                        return false;
                     }
+                });
+                if (failed.load()) {
+                    megamol::core::utility::log::Log::DefaultLog.WriteError("Invalid value during vertex parsing");
+                    return false;
                 }
             }
             // parse faces
-            if (icompare(elementNames[elm], selectedFaces)) {
-                for (size_t i = 0; i < faceCount; i++) {
-                    if (std::getline(instream, line)) {
-                        auto split = isplit(line);
-                        if (elementIndexMap.count(selectedIndices)) {
-                            uint64_t faceSize = static_cast<uint64_t>(std::stoul(split[0]));
-                            if (faceSize != 3) {
-                                megamol::core::utility::log::Log::DefaultLog.WriteError(
-                                    "The PlyDataSource is currently only able to handle triangular faces");
-                                return false;
+            if (isFaces) {
+                std::atomic<bool> failed{false};
+                core::utility::ParallelFor<size_t>(0, faceCount, 0, [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end && !failed.load(std::memory_order_relaxed); i++) {
+                        auto cursor = lineRange(firstLine + i);
+                        int64_t faceSize = 0;
+                        std::array<int64_t, 3> face;
+                        if (!cursor.parseInt(faceSize) || faceSize != 3 || !cursor.parseInt(face[0]) ||
+                            !cursor.parseInt(face[1]) || !cursor.parseInt(face[2])) {
+                            failed.store(true, std::memory_order_relaxed);
+                            break;
+                        }
+                        for (size_t j = 0; j < 3; j++) {
+                            if (facePointers.face_uchar != nullptr) {
+                                facePointers.face_uchar[3 * i + j] = static_cast<unsigned char>(face[j]);
                             }
-                            for (size_t j = 1; j < faceSize + 1; j++) {
-                                unsigned long bla = std::stoul(split[j]);
-                                if (facePointers.face_uchar != nullptr) {
-                                    facePointers.face_uchar[3 * i + j - 1] = static_cast<unsigned char>(bla);
-                                }
-                                if (facePointers.face_u16 != nullptr) {
-                                    facePointers.face_u16[3 * i + j - 1] = static_cast<uint16_t>(bla);
-                                }
-                                if (facePointers.face_u32 != nullptr) {
-                                    facePointers.face_u32[3 * i + j - 1] = static_cast<uint32_t>(bla);
-                                }
+                            if (facePointers.face_u16 != nullptr) {
+                                facePointers.face_u16[3 * i + j] = static_cast<uint16_t>(face[j]);
+                            }
+                            if (facePointers.face_u32 != nullptr) {
+                                facePointers.face_u32[3 * i + j] = static_cast<uint32_t>(face[j]);
                             }
                         }
-                    } else {
-                        megamol::core::utility::log::Log::DefaultLog.WriteError(
-                            "Unexpected file ending during face parsing");
-                        return false;
                     }
+                });
+                if (failed.load()) {
+                    megamol::core::utility::log::Log::DefaultLog.WriteError(
+                        "The PlyDataSource is currently only able to handle triangular faces");
+                    return false;
                 }
             }
+
+            firstLine += count;
         }
     }
 
-    instream.close();
+    // bounding box over the selected position components
+    auto const flt_max = std::numeric_limits<float>::max();
+    auto const flt_min = std::numeric_limits<float>::lowest();
+    this->boundingBox.Set(flt_max, flt_max, flt_max, flt_min, flt_min, flt_min);
+    float* bbPointer = const_cast<float*>(boundingBox.PeekBounds()); // hackedihack
+    std::mutex bbLock;
+    auto const growBoundingBox = [&](auto const* positions) {
+        core::utility::ParallelFor<size_t>(0, vertex_count, 0, [&](size_t begin, size_t end) {
+            std::array<float, 6> local = {flt_max, flt_max, flt_max, flt_min, flt_min, flt_min};
+            for (size_t v = begin; v < end; v++) {
+                for (size_t i = 0; i < 3; i++) {
+                    local[i] = std::min(local[i], static_cast<float>(positions[3 * v + i]));
+                    local[i + 3] = std::max(local[i + 3], static_cast<float>(positions[3 * v + i]));
+                }
+            }
+            std::lock_guard<std::mutex> lock(bbLock);
+            for (size_t i = 0; i < 3; i++) {
+                bbPointer[i] = std::min(bbPointer[i], local[i]);
+                bbPointer[i + 3] = std::max(bbPointer[i + 3], local[i + 3]);
+            }
+        });
+    };
+    if (posPointers.pos_float != nullptr) {
+        growBoundingBox(posPointers.pos_float);
+    }
+    if (posPointers.pos_double != nullptr) {
+        growBoundingBox(posPointers.pos_double);
+    }
+
     return true;
 }
 
@@ -24,7 +24,6 @@
 #include <algorithm>
 #include <array>
 #include <cstring>
-#include <fstream>
 #include <limits>
 #include <memory>
 #include <numeric>
@@ -253,25 +252,14 @@ bool STLDataSource::get_ngmesh_data_callback(core::Call& caller) {
 void STLDataSource::release() {}
 
 void STLDataSource::read(const std::string& filename) {
-    std::ifstream ifs(filename, std::ofstream::in | std::ofstream::binary);
+    mesh::ingest::MappedFile file;
 
-    if (ifs.good()) {
-        // Read first non-white characters to identify an ASCII file
-        std::string line;
-
-        while (line.empty() && !ifs.eof()) {
-            // Read and convert line to lower case
-            std::getline(ifs, line);
-            std::transform(line.begin(), line.end(), line.begin(), ::tolower);
-
-            line.erase(0, line.find_first_not_of("\f\n\r\t\v "));
-        }
-
-        // Read file
-        if (line.substr(0, line.find_first_of("\f\n\r\t\v ")).compare("solid") == 0) {
-            read_ascii(filename);
+    if (file.open(filename)) {
+        // The size of binary files matches their triangle count, even if their header starts with 'solid'
+        if (mesh::ingest::isBinaryStl(file)) {
+            read_binary(file);
         } else {
-            read_binary(filename);
+            read_ascii(file);
         }
     } else {
         std::stringstream ss;
@@ -281,328 +269,76 @@ void STLDataSource::read(const std::string& filename) {
     }
 }
 
-void STLDataSource::read_binary(const std::string& filename) {
-    std::ifstream ifs(filename, std::ofstream::in | std::ofstream::binary);
+void STLDataSource::allocate_buffers() {
+    const std::size_t header_block_size = sizeof(uint32_t);
+    const std::size_t data_block_size = 9 * this->num_triangles * sizeof(float);
 
-    if (ifs.good()) {
-        // Get number of triangles from header
-        ifs.ignore(80 * sizeof(uint8_t));
-        ifs.read(reinterpret_cast<char*>(&this->num_triangles), sizeof(uint32_t));
+    const std::size_t data_offset_1 = 2 * header_block_size;
+    const std::size_t data_offset_2 = 2 * header_block_size + data_block_size;
 
-        // Sanity check for file size
-        ifs.ignore(std::numeric_limits<std::streamsize>::max());
-        std::streamsize file_size = ifs.gcount();
+    this->vertex_normal_buffer.resize(2 * data_block_size + 2 * header_block_size);
 
-        if (file_size != this->num_triangles * 50) {
-            throw std::runtime_error("File size does not match the number of triangles.");
-        }
-
-        megamol::core::utility::log::Log::DefaultLog.WriteInfo(
-            "Number of triangles from binary STL file: %d", this->num_triangles);
+    reinterpret_cast<uint32_t&>(this->vertex_normal_buffer[0 * header_block_size]) =
+        static_cast<uint32_t>(data_offset_1);
+    reinterpret_cast<uint32_t&>(this->vertex_normal_buffer[1 * header_block_size]) =
+        static_cast<uint32_t>(data_offset_2);
 
-        // Read data
-        ifs.seekg(80 * sizeof(uint8_t) + sizeof(uint32_t));
+    // Fill index buffer
+    this->index_buffer.resize(this->num_triangles * 3);
 
-        const std::size_t header_block_size = sizeof(uint32_t);
-        const std::size_t data_block_size = 9 * this->num_triangles * sizeof(float);
+    std::iota(this->index_buffer.begin(), this->index_buffer.end(), 0);
+}
 
-        const std::size_t data_offset_1 = 2 * header_block_size;
-        const std::size_t data_offset_2 = 2 * header_block_size + data_block_size;
+void STLDataSource::read_binary(const mesh::ingest::MappedFile& file) {
+    // Sanity check for file size, also covers files with an invalid header
+    this->num_triangles = mesh::ingest::binaryStlTriangleCount(file);
 
-        this->vertex_normal_buffer.resize(2 * data_block_size + 2 * header_block_size);
+    if (this->num_triangles == 0 && file.size() != 84) {
+        throw std::runtime_error("File size does not match the number of triangles.");
+    }
 
-        reinterpret_cast<uint32_t&>(this->vertex_normal_buffer[0 * header_block_size]) =
-            static_cast<uint32_t>(data_offset_1);
-        reinterpret_cast<uint32_t&>(this->vertex_normal_buffer[1 * header_block_size]) =
-            static_cast<uint32_t>(data_offset_2);
+    megamol::core::utility::log::Log::DefaultLog.WriteInfo(
+        "Number of triangles from binary STL file: %d", this->num_triangles);
 
-        std::size_t vertex_position = data_offset_1;
-        std::size_t normal_position = data_offset_2;
+    // Read data directly from the mapped file into the buffers
+    allocate_buffers();
 
-        for (std::size_t triangle_index = 0; triangle_index < static_cast<std::size_t>(this->num_triangles);
-             ++triangle_index) {
-            ifs.read(reinterpret_cast<char*>(&this->vertex_normal_buffer[normal_position]), 3 * sizeof(float));
-            ifs.read(reinterpret_cast<char*>(&this->vertex_normal_buffer[vertex_position]), 9 * sizeof(float));
-            ifs.ignore(sizeof(uint16_t));
+    auto* vertices = reinterpret_cast<float*>(&this->vertex_normal_buffer[2 * sizeof(uint32_t)]);
+    mesh::ingest::readBinaryStl(file, vertices, vertices + 9 * static_cast<std::size_t>(this->num_triangles));
+}
 
-            std::memcpy(&this->vertex_normal_buffer[normal_position + 3 * sizeof(float)],
-                &this->vertex_normal_buffer[normal_position], 3 * sizeof(float));
-            std::memcpy(&this->vertex_normal_buffer[normal_position + 6 * sizeof(float)],
-                &this->vertex_normal_buffer[normal_position], 3 * sizeof(float));
+void STLDataSource::read_ascii(const mesh::ingest::MappedFile& file) {
+    // Parse file, or load the parsed triangles from the mesh cache
+    mesh::ingest::IngestedScene scene;
+    std::string error;
 
-            vertex_position += 9 * sizeof(float);
-            normal_position += 9 * sizeof(float);
+    const auto parse = [](const mesh::ingest::MappedFile& file, mesh::ingest::IngestedScene& scene,
+                           std::string& error) {
+        scene.meshes.resize(1);
+        if (!mesh::ingest::parseAsciiStl(file, scene.meshes.front(), error)) {
+            return false;
         }
+        scene.computeBoundingBox();
+        return true;
+    };
 
-        // Fill index buffer
-        this->index_buffer.resize(this->num_triangles * 3);
-
-        std::iota(this->index_buffer.begin(), this->index_buffer.end(), 0);
-    } else {
-        std::stringstream ss;
-        ss << "STL file '" << filename << "' not found or inaccessible";
-
-        throw std::runtime_error(ss.str());
+    if (!mesh::ingest::loadCached(file, "stl-ascii-1", scene, error, parse) || scene.meshes.size() != 1) {
+        throw std::runtime_error("Invalid ASCII STL file: " + error);
     }
-}
-
-void STLDataSource::read_ascii(const std::string& filename) {
-    std::ifstream ifs(filename, std::ofstream::in);
-
-    if (ifs.good()) {
-        // Get file size and estimate number of triangles
-        ifs.ignore(std::numeric_limits<std::streamsize>::max());
-        std::streamsize file_size = ifs.gcount();
-        ifs.seekg(ifs.beg);
-
-        const std::size_t estimated_num_triangles =
-            static_cast<std::size_t>(1.5f * (static_cast<float>(file_size) / 256.0f));
-
-        std::vector<float> vertices, normals;
-        vertices.reserve(9 * estimated_num_triangles);
-        normals.reserve(3 * estimated_num_triangles);
-
-        // Parse file
-        parser_states_t state = EXPECT_SOLID;
-
-        std::string line;
-        std::string name;
-
-        while (!ifs.eof()) {
-            // Read and convert line to lower case
-            std::getline(ifs, line);
-            std::transform(line.begin(), line.end(), line.begin(), ::tolower);
-
-            line.erase(0, line.find_first_not_of("\f\n\r\t\v "));
-
-            while (!line.empty()) {
-                // Extract word from line
-                const std::string word = line.substr(0, line.find_first_of("\f\n\r\t\v "));
-
-                line.erase(0, word.size());
-                line.erase(0, line.find_first_not_of("\f\n\r\t\v "));
-
-                // Parse word
-                switch (state) {
-                case EXPECT_SOLID:
-                    if (word.compare("solid") == 0) {
-                        state = EXPECT_NAME;
-                    } else {
-                        throw std::runtime_error("Expected ASCII STL file to begin with keyword 'solid'");
-                    }
-
-                    break;
-                case EXPECT_NAME:
-                    name = word;
-
-                    state = EXPECT_FACET_OR_ENDSOLID;
-
-                    break;
-                case EXPECT_FACET_OR_ENDSOLID:
-                    if (word.compare("facet") == 0) {
-                        state = EXPECT_NORMAL;
-                    } else if (word.compare("endsolid") == 0) {
-                        state = EXPECT_ENDNAME;
-                    } else {
-                        throw std::runtime_error("Expected keyword 'facet' or 'endsolid' after solid name or "
-                                                 "'endfacet' in ASCII STL file");
-                    }
-
-                    break;
-                case EXPECT_NORMAL:
-                    if (word.compare("normal") == 0) {
-                        state = EXPECT_NORMAL_I;
-                    } else {
-                        throw std::runtime_error("Expected keyword 'normal' after keyword 'facet' in ASCII STL file");
-                    }
-
-                    break;
-                case EXPECT_NORMAL_I:
-                    normals.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = EXPECT_NORMAL_J;
-
-                    break;
-                case EXPECT_NORMAL_J:
-                    normals.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = EXPECT_NORMAL_K;
-
-                    break;
-                case EXPECT_NORMAL_K:
-                    normals.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = EXPECT_OUTER;
-
-                    break;
-                case EXPECT_OUTER:
-                    if (word.compare("outer") == 0) {
-                        state = EXPECT_LOOP;
-                    } else {
-                        throw std::runtime_error("Expected keyword 'outer' after the normal values in ASCII STL file");
-                    }
-
-                    break;
-                case EXPECT_LOOP:
-                    if (word.compare("loop") == 0) {
-                        state = EXPECT_VERTEX_1;
-                    } else {
-                        throw std::runtime_error("Expected keyword 'loop' after keyword 'outer' in ASCII STL file");
-                    }
-
-                    break;
-                case EXPECT_VERTEX_1:
-                    if (word.compare("vertex") == 0) {
-                        state = EXPECT_VERTEX_1_X;
-                    } else {
-                        throw std::runtime_error("Expected keyword 'vertex' after keyword 'loop' in ASCII STL file");
-                    }
-
-                    break;
-                case EXPECT_VERTEX_1_X:
-                    vertices.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = EXPECT_VERTEX_1_Y;
-
-                    break;
-                case EXPECT_VERTEX_1_Y:
-                    vertices.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = EXPECT_VERTEX_1_Z;
-
-                    break;
-                case EXPECT_VERTEX_1_Z:
-                    vertices.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = EXPECT_VERTEX_2;
-
-                    break;
-                case EXPECT_VERTEX_2:
-                    if (word.compare("vertex") == 0) {
-                        state = EXPECT_VERTEX_2_X;
-                    } else {
-                        throw std::runtime_error(
-                            "Expected keyword 'vertex' after the first vertex values in ASCII STL file");
-                    }
-
-                    break;
-                case EXPECT_VERTEX_2_X:
-                    vertices.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = EXPECT_VERTEX_2_Y;
-
-                    break;
-                case EXPECT_VERTEX_2_Y:
-                    vertices.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = EXPECT_VERTEX_2_Z;
-
-                    break;
-                case EXPECT_VERTEX_2_Z:
-                    vertices.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = EXPECT_VERTEX_3;
-
-                    break;
-                case EXPECT_VERTEX_3:
-                    if (word.compare("vertex") == 0) {
-                        state = EXPECT_VERTEX_3_X;
-                    } else {
-                        throw std::runtime_error(
-                            "Expected keyword 'vertex' after the second vertex values in ASCII STL file");
-                    }
-
-                    break;
-                case EXPECT_VERTEX_3_X:
-                    vertices.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = EXPECT_VERTEX_3_Y;
-
-                    break;
-                case EXPECT_VERTEX_3_Y:
-                    vertices.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = EXPECT_VERTEX_3_Z;
-
-                    break;
-                case EXPECT_VERTEX_3_Z:
-                    vertices.push_back(static_cast<float>(atof(word.c_str())));
-
-                    state = EXPECT_ENDLOOP;
-
-                    break;
-                case EXPECT_ENDLOOP:
-                    if (word.compare("endloop") == 0) {
-                        state = EXPECT_ENDFACET;
-                    } else {
-                        throw std::runtime_error(
-                            "Expected keyword 'endloop' after the third vertex values in ASCII STL file");
-                    }
-
-                    break;
-                case EXPECT_ENDFACET:
-                    if (word.compare("endfacet") == 0) {
-                        state = EXPECT_FACET_OR_ENDSOLID;
-                    } else {
-                        throw std::runtime_error(
-                            "Expected keyword 'endfacet' after keyword 'endloop' in ASCII STL file");
-                    }
-
-                    break;
-                case EXPECT_ENDNAME:
-                    if (word.compare(name) == 0) {
-                        state = EXPECT_EOF;
-                    } else {
-                        throw std::runtime_error("Expected same solid name after keyword 'endsolid' in ASCII STL file");
-                    }
-
-                    break;
-                case EXPECT_EOF:
-                default:
-                    megamol::core::utility::log::Log::DefaultLog.WriteWarn(
-                        "Found more text after keyword 'endsolid' in ASCII STL file. %s",
-                        "Maybe more than one object is stored in the file. This is not supported by this "
-                        "reader.");
-                }
-            }
-        }
-
-        this->num_triangles = static_cast<uint32_t>(vertices.size() / 9);
-        megamol::core::utility::log::Log::DefaultLog.WriteInfo(
-            "Number of triangles from ASCII STL file: %d", this->num_triangles);
 
-        // Fill buffer
-        this->vertex_normal_buffer.resize(2 * sizeof(uint32_t) + 18 * this->num_triangles * sizeof(float));
+    const auto& triangles = scene.meshes.front();
 
-        reinterpret_cast<uint32_t*>(this->vertex_normal_buffer.data())[0] = 2 * sizeof(uint32_t);
-        reinterpret_cast<uint32_t*>(this->vertex_normal_buffer.data())[1] =
-            2 * sizeof(uint32_t) + 9 * this->num_triangles * sizeof(float);
+    this->num_triangles = static_cast<uint32_t>(triangles.positions.size() / 9);
+    megamol::core::utility::log::Log::DefaultLog.WriteInfo(
+        "Number of triangles from ASCII STL file: %d", this->num_triangles);
 
-        std::memcpy(&this->vertex_normal_buffer[2 * sizeof(uint32_t)], vertices.data(),
-            9 * this->num_triangles * sizeof(float));
+    // Fill buffer
+    allocate_buffers();
 
-        const std::size_t offset = 2 * sizeof(uint32_t) + 9 * this->num_triangles * sizeof(float);
-        std::size_t position = 0;
-
-        for (std::size_t triangle_index = 0; triangle_index < this->num_triangles; ++triangle_index) {
-            reinterpret_cast<float*>(&this->vertex_normal_buffer[offset])[position++] = normals[triangle_index * 3 + 0];
-            reinterpret_cast<float*>(&this->vertex_normal_buffer[offset])[position++] = normals[triangle_index * 3 + 1];
-            reinterpret_cast<float*>(&this->vertex_normal_buffer[offset])[position++] = normals[triangle_index * 3 + 2];
-
-            reinterpret_cast<float*>(&this->vertex_normal_buffer[offset])[position++] = normals[triangle_index * 3 + 0];
-            reinterpret_cast<float*>(&this->vertex_normal_buffer[offset])[position++] = normals[triangle_index * 3 + 1];
-            reinterpret_cast<float*>(&this->vertex_normal_buffer[offset])[position++] = normals[triangle_index * 3 + 2];
-
-            reinterpret_cast<float*>(&this->vertex_normal_buffer[offset])[position++] = normals[triangle_index * 3 + 0];
-            reinterpret_cast<float*>(&this->vertex_normal_buffer[offset])[position++] = normals[triangle_index * 3 + 1];
-            reinterpret_cast<float*>(&this->vertex_normal_buffer[offset])[position++] = normals[triangle_index * 3 + 2];
-        }
-
-        // Fill index buffer
-        this->index_buffer.resize(this->num_triangles * 3);
-
-        std::iota(this->index_buffer.begin(), this->index_buffer.end(), 0);
-    }
+    std::memcpy(&this->vertex_normal_buffer[2 * sizeof(uint32_t)], triangles.positions.data(),
+        9 * this->num_triangles * sizeof(float));
+    std::memcpy(&this->vertex_normal_buffer[2 * sizeof(uint32_t) + 9 * this->num_triangles * sizeof(float)],
+        triangles.normals.data(), 9 * this->num_triangles * sizeof(float));
 }
 
 uint32_t STLDataSource::hash() const {
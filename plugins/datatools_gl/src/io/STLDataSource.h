@@ -16,6 +16,8 @@
 
 #include "geometry_calls_gl/CallTriMeshDataGL.h"
 
+#include "mesh/MeshIngest.h"
+
 #ifdef MEGAMOL_NG_MESH
 #include "ng_mesh/CallNGMeshRenderBatches.h"
 #endif
@@ -99,54 +101,28 @@ protected:
     virtual void release() override;
 
 private:
-    /// <summary>
-    /// States for the ascii parser
-    /// </summary>
-    enum parser_states_t {
-        EXPECT_SOLID,
-        EXPECT_NAME,
-        EXPECT_FACET_OR_ENDSOLID,
-        EXPECT_NORMAL,
-        EXPECT_NORMAL_I,
-        EXPECT_NORMAL_J,
-        EXPECT_NORMAL_K,
-        EXPECT_OUTER,
-        EXPECT_LOOP,
-        EXPECT_VERTEX_1,
-        EXPECT_VERTEX_1_X,
-        EXPECT_VERTEX_1_Y,
-        EXPECT_VERTEX_1_Z,
-        EXPECT_VERTEX_2,
-        EXPECT_VERTEX_2_X,
-        EXPECT_VERTEX_2_Y,
-        EXPECT_VERTEX_2_Z,
-        EXPECT_VERTEX_3,
-        EXPECT_VERTEX_3_X,
-        EXPECT_VERTEX_3_Y,
-        EXPECT_VERTEX_3_Z,
-        EXPECT_ENDLOOP,
-        EXPECT_ENDFACET,
-        EXPECT_ENDNAME,
-        EXPECT_EOF
-    };
-
     /// <summary>
     /// Read an STL file
     /// </summary>
     /// <param name="filename">File name of the STL file</param>
     void read(const std::string& filename);
 
+    /// <summary>
+    /// Resize the vertex and normal buffer and the index buffer for num_triangles triangles
+    /// </summary>
+    void allocate_buffers();
+
     /// <summary>
     /// Read a binary file
     /// </summary>
-    /// <param name="filename">File name of the STL file</param>
-    void read_binary(const std::string& filename);
+    /// <param name="file">Mapped STL file</param>
+    void read_binary(const mesh::ingest::MappedFile& file);
 
     /// <summary>
     /// Read a textual file
     /// </summary>
-    /// <param name="filename">File name of the STL file</param>
-    void read_ascii(const std::string& filename);
+    /// <param name="file">Mapped STL file</param>
+    void read_ascii(const mesh::ingest::MappedFile& file);
 
     /// <summary>
     /// Calculate the data hash
@@ -665,6 +665,25 @@ public:
         return this->isVAO;
     }
 
+    /**
+     * Marks the particles as stored in PKD order, i.e. as the balanced kd-tree built by the PkdBuilder of mmospray.
+     * The flag is not copied by the assignment operator, so every module has to set it for the lists it outputs.
+     *
+     * @param sorted 'true' if the particles are in PKD order
+     */
+    void SetIsPkdSorted(bool sorted) {
+        this->pkdSorted = sorted;
+    }
+
+    /**
+     * Answers whether the particles are stored in PKD order.
+     *
+     * @return 'true' if the particles are in PKD order
+     */
+    bool IsPkdSorted() const {
+        return this->pkdSorted;
+    }
+
     /**
      * If we handle clusters this could be useful
      */
@@ -776,6 +795,9 @@ private:
     /** do we use a VertexArrayObject? */
     bool isVAO;
 
+    /** are the particles in PKD order? */
+    bool pkdSorted = false;
+
     /** Vertex Array Object to transport */
     unsigned int glVAO;
     /** Vertex Buffer to transport */
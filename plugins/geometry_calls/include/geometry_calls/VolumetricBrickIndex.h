@@ -0,0 +1,253 @@
+/*
+ * VolumetricBrickIndex.h
+ *
+ * Copyright (C) 2022 by Visualisierungsinstitut der Universität Stuttgart.
+ * Alle rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "geometry_calls/VolumetricDataCallTypes.h"
+
+
+namespace megamol::geocalls {
+
+/**
+ * Describes a volume that is split into cubic bricks on several levels of
+ * detail. Level 0 is the full resolution, every further level halves the
+ * resolution of the previous one. The bricks of all levels are numbered
+ * consecutively, level by level and x fastest within a level.
+ *
+ * Besides the layout, the index holds the value range of every brick for one
+ * frame, which allows consumers to skip bricks without loading them.
+ */
+class VolumetricBrickIndex {
+
+public:
+    /** Initialise an empty index. */
+    VolumetricBrickIndex(void);
+
+    /**
+     * Computes the layout of the bricks.
+     *
+     * @param resolution   The resolution of level 0.
+     * @param scalarType   The type of the scalars stored in the bricks.
+     * @param scalarLength The length of a scalar in bytes.
+     * @param components   The number of components per voxel.
+     * @param brickSize    The edge length of a brick in voxels, must be a
+     *                     power of two.
+     * @param levels       The number of levels. If zero, levels are added
+     *                     until a single brick covers the whole volume.
+     *
+     * @return 'true' on success, 'false' if the parameters are invalid.
+     */
+    bool Layout(const size_t resolution[3], ScalarType_t scalarType, size_t scalarLength, size_t components,
+        size_t brickSize, unsigned int levels);
+
+    /** Removes all bricks. */
+    void Clear(void);
+
+    /**
+     * Answer the number of bricks of all levels.
+     */
+    inline size_t Count(void) const {
+        return this->bricks.size();
+    }
+
+    /**
+     * Answer whether the index does not contain bricks.
+     */
+    inline bool IsEmpty(void) const {
+        return this->bricks.empty();
+    }
+
+    /**
+     * Answer a brick.
+     *
+     * @param brick The number of the brick.
+     */
+    inline const VolumetricBrick_t& GetBrick(size_t brick) const {
+        return this->bricks[brick];
+    }
+
+    /**
+     * Answer the number of the brick at the given brick position.
+     */
+    inline size_t GetBrick(unsigned int level, size_t bx, size_t by, size_t bz) const {
+        const auto& l = this->levels[level];
+        return l.First + (bz * l.Bricks[1] + by) * l.Bricks[0] + bx;
+    }
+
+    /**
+     * Answer the number of the brick containing the given voxel.
+     */
+    inline size_t GetBrickAt(unsigned int level, size_t x, size_t y, size_t z) const {
+        return this->GetBrick(level, x >> this->brickShift, y >> this->brickShift, z >> this->brickShift);
+    }
+
+    /**
+     * Answer the bricks of a level that overlap the box of voxels from
+     * 'first' to 'last', both inclusive. The box is clamped to the level.
+     */
+    std::vector<size_t> GetBricksInBox(unsigned int level, const size_t first[3], const size_t last[3]) const;
+
+    /**
+     * Answer the bricks of a level whose value range of component 'c'
+     * overlaps [minValue, maxValue].
+     */
+    std::vector<size_t> GetBricksInRange(unsigned int level, double minValue, double maxValue, size_t c = 0) const;
+
+    /**
+     * Answer the number of bricks along each axis of a level.
+     */
+    inline const size_t* GetBrickCount(unsigned int level) const {
+        return this->levels[level].Bricks;
+    }
+
+    /**
+     * Answer the edge length of a brick in voxels.
+     */
+    inline size_t GetBrickSize(void) const {
+        return static_cast<size_t>(1) << this->brickShift;
+    }
+
+    /**
+     * Answer the size of a brick in bytes.
+     */
+    inline size_t GetBrickBytes(size_t brick) const {
+        const auto& b = this->bricks[brick];
+        return b.Size[0] * b.Size[1] * b.Size[2] * this->GetVoxelSize();
+    }
+
+    /**
+     * Answer the number of components per voxel.
+     */
+    inline size_t GetComponents(void) const {
+        return this->components;
+    }
+
+    /**
+     * Answer the size of all bricks of a frame in bytes.
+     */
+    inline uint64_t GetFrameSize(void) const {
+        return this->frameSize;
+    }
+
+    /**
+     * Answer the number of levels.
+     */
+    inline unsigned int GetLevels(void) const {
+        return static_cast<unsigned int>(this->levels.size());
+    }
+
+    /**
+     * Answer the resolution of a level.
+     */
+    inline const size_t* GetResolution(unsigned int level) const {
+        return this->levels[level].Resolution;
+    }
+
+    /**
+     * Answer the length of a scalar in bytes.
+     */
+    inline size_t GetScalarLength(void) const {
+        return this->scalarLength;
+    }
+
+    /**
+     * Answer the type of the scalars.
+     */
+    inline ScalarType_t GetScalarType(void) const {
+        return this->scalarType;
+    }
+
+    /**
+     * Answer the size of a voxel in bytes.
+     */
+    inline size_t GetVoxelSize(void) const {
+        return this->scalarLength * this->components;
+    }
+
+    /**
+     * Answer the minimum of component 'c' in a brick.
+     */
+    inline double GetMinValue(size_t brick, size_t c = 0) const {
+        return this->ranges[2 * (brick * this->components + c)];
+    }
+
+    /**
+     * Answer the maximum of component 'c' in a brick.
+     */
+    inline double GetMaxValue(size_t brick, size_t c = 0) const {
+        return this->ranges[2 * (brick * this->components + c) + 1];
+    }
+
+    /**
+     * Answer the frame the value ranges belong to.
+     */
+    inline unsigned int GetFrameID(void) const {
+        return this->frameID;
+    }
+
+    /**
+     * Grants access to the value ranges, which hold the minimum and the
+     * maximum of every component of every brick, in this order.
+     */
+    inline std::vector<double>& AccessRanges(void) {
+        return this->ranges;
+    }
+
+    /**
+     * Answer the value ranges, see AccessRanges.
+     */
+    inline const std::vector<double>& GetRanges(void) const {
+        return this->ranges;
+    }
+
+    /**
+     * Set the frame the value ranges belong to.
+     */
+    inline void SetFrameID(unsigned int frameID) {
+        this->frameID = frameID;
+    }
+
+private:
+    /** The layout of one level. */
+    struct Level {
+        size_t Resolution[3];
+        size_t Bricks[3];
+        size_t First;
+    };
+
+    /** The bricks of all levels. */
+    std::vector<VolumetricBrick_t> bricks;
+
+    /** log2 of the edge length of a brick. */
+    unsigned int brickShift;
+
+    /** The number of components per voxel. */
+    size_t components;
+
+    /** The frame the value ranges belong to. */
+    unsigned int frameID;
+
+    /** The size of all bricks of a frame in bytes. */
+    uint64_t frameSize;
+
+    /** The layout of the levels. */
+    std::vector<Level> levels;
+
+    /** The value ranges of the bricks. */
+    std::vector<double> ranges;
+
+    /** The length of a scalar in bytes. */
+    size_t scalarLength;
+
+    /** The type of the scalars. */
+    ScalarType_t scalarType;
+};
+
+} // namespace megamol::geocalls
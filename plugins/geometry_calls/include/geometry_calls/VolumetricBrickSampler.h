@@ -0,0 +1,197 @@
+/*
+ * VolumetricBrickSampler.h
+ *
+ * Copyright (C) 2022 by Visualisierungsinstitut der Universität Stuttgart.
+ * Alle rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "geometry_calls/VolumetricDataCall.h"
+
+
+namespace megamol::geocalls {
+
+/**
+ * Voxel access to a bricked volume for consumers that only touch parts of
+ * the volume. The sampler keeps the bricks it fetched through a
+ * VolumetricDataCall and maps voxel coordinates of one level of detail to
+ * them.
+ *
+ * Fetching bricks is not thread-safe. The Peek and Sample methods only read
+ * bricks that have been fetched before and can be used concurrently, so
+ * parallel consumers fetch the bricks they need up front.
+ */
+class VolumetricBrickSampler {
+
+public:
+    /** Initialise a closed sampler. */
+    VolumetricBrickSampler(void);
+
+    /** Finalise the instance. */
+    ~VolumetricBrickSampler(void);
+
+    /**
+     * Retrieves the brick index of the frame requested in 'call'. The call
+     * must not be changed until the sampler is closed.
+     *
+     * @param call  The call to the data source.
+     * @param level The level of detail to sample, clamped to the available
+     *              levels.
+     *
+     * @return 'true' if the data source provides bricks, 'false' otherwise.
+     */
+    bool Open(VolumetricDataCall& call, unsigned int level = 0);
+
+    /** Releases all bricks and the call. */
+    void Close(void);
+
+    /**
+     * Answer whether the sampler has been opened successfully.
+     */
+    inline bool IsOpen(void) const {
+        return (this->call != nullptr);
+    }
+
+    /**
+     * Answer the brick index. Only valid if the sampler is open.
+     */
+    inline const VolumetricBrickIndex& GetIndex(void) const {
+        return *this->index;
+    }
+
+    /**
+     * Answer the sampled level of detail.
+     */
+    inline unsigned int GetLevel(void) const {
+        return this->level;
+    }
+
+    /**
+     * Answer the resolution of the sampled level of detail.
+     */
+    inline const size_t* GetResolution(void) const {
+        return this->index->GetResolution(this->level);
+    }
+
+    /**
+     * Loads the given bricks unless they have been loaded before.
+     *
+     * @param bricks The numbers of the bricks in the brick index.
+     *
+     * @return 'true' on success, 'false' otherwise.
+     */
+    bool Fetch(const std::vector<size_t>& bricks);
+
+    /**
+     * Loads the bricks of the sampled level that overlap the box of voxels
+     * from 'first' to 'last', both inclusive.
+     *
+     * @return 'true' on success, 'false' otherwise.
+     */
+    bool FetchBox(const size_t first[3], const size_t last[3]);
+
+    /**
+     * Releases all loaded bricks.
+     */
+    void Evict(void);
+
+    /**
+     * Answer the voxels of a brick, loading it if necessary.
+     *
+     * @return The voxels or nullptr if loading failed.
+     */
+    const uint8_t* GetBrick(size_t brick);
+
+    /**
+     * Answer the voxels of a brick if it has been loaded before.
+     */
+    inline const uint8_t* PeekBrick(size_t brick) const {
+        const auto& b = this->bricks[brick];
+        return (b != nullptr) ? b->data() : nullptr;
+    }
+
+    /**
+     * Answer the first component of a voxel of the sampled level, loading
+     * its brick if necessary.
+     *
+     * @return The voxel or nullptr if loading failed.
+     */
+    const void* GetVoxel(size_t x, size_t y, size_t z);
+
+    /**
+     * Answer the first component of a voxel of the sampled level if its
+     * brick has been loaded before.
+     */
+    inline const void* PeekVoxel(size_t x, size_t y, size_t z) const {
+        const auto b = this->index->GetBrickAt(this->level, x, y, z);
+        const auto* data = this->PeekBrick(b);
+        if (data == nullptr) {
+            return nullptr;
+        }
+        return data + this->voxelOffset(b, x, y, z);
+    }
+
+    /**
+     * Answer component 'c' of a voxel whose brick has been loaded before.
+     * The scalar type of the volume must be T.
+     *
+     * @return The value or zero if the brick has not been loaded.
+     */
+    template<class T>
+    inline T Sample(size_t x, size_t y, size_t z, size_t c = 0) const {
+        const auto* voxel = static_cast<const T*>(this->PeekVoxel(x, y, z));
+        return (voxel != nullptr) ? voxel[c] : static_cast<T>(0);
+    }
+
+    /**
+     * Answer component 'c' of a voxel whose brick has been loaded before,
+     * converted from the scalar type of the volume.
+     *
+     * @return The value or zero if the brick has not been loaded or the
+     *         scalar type is not supported.
+     */
+    double Value(size_t x, size_t y, size_t z, size_t c = 0) const;
+
+    /**
+     * Copies a box of voxels of the sampled level to contiguous memory,
+     * x fastest. The bricks are fetched one layer at a time and all loaded
+     * bricks are released afterwards, so the box does not need to fit into
+     * memory twice.
+     *
+     * @param first The first voxel of the box.
+     * @param size  The number of voxels along each axis.
+     * @param dst   Receives the voxels, must hold the whole box.
+     *
+     * @return 'true' on success, 'false' otherwise.
+     */
+    bool Read(const size_t first[3], const size_t size[3], void* dst);
+
+private:
+    /** Answer the offset of a voxel in its brick in bytes. */
+    inline size_t voxelOffset(size_t brick, size_t x, size_t y, size_t z) const {
+        const auto& b = this->index->GetBrick(brick);
+        return (((z - b.Origin[2]) * b.Size[1] + (y - b.Origin[1])) * b.Size[0] + (x - b.Origin[0])) *
+               this->voxelSize;
+    }
+
+    /** The loaded bricks, indexed by their number. */
+    std::vector<VolumetricDataCall::BrickData> bricks;
+
+    /** The call the bricks are fetched through. */
+    VolumetricDataCall* call;
+
+    /** The brick index provided by the data source. */
+    const VolumetricBrickIndex* index;
+
+    /** The sampled level of detail. */
+    unsigned int level;
+
+    /** The size of a voxel in bytes. */
+    size_t voxelSize;
+};
+
+} // namespace megamol::geocalls
@@ -7,6 +7,11 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "geometry_calls/VolumetricBrickIndex.h"
 #include "geometry_calls/VolumetricDataCallTypes.h"
 #include "mmcore/AbstractGetData3DCall.h"
 #include "mmcore/factories/CallAutoDescription.h"
@@ -30,6 +35,12 @@ public:
     /** Structure containing all required metadata about a data set. */
     typedef struct VolumetricMetadata_t Metadata;
 
+    /**
+     * The voxels of a brick. The data source and the caller share the
+     * ownership, so bricks remain valid when the source evicts them.
+     */
+    typedef std::shared_ptr<const std::vector<uint8_t>> BrickData;
+
     /**
      * Answer the name of this module.
      *
@@ -95,6 +106,18 @@ public:
     /** Index of the function retrieving data that might be unavailable. */
     static const unsigned int IDX_TRY_GET_DATA;
 
+    /**
+     * Index of the function retrieving the brick index of the requested
+     * frame. Fails if the data source does not provide bricked access.
+     */
+    static const unsigned int IDX_GET_BRICK_INDEX;
+
+    /**
+     * Index of the function retrieving the bricks set by SetBrickRequest
+     * for the requested frame.
+     */
+    static const unsigned int IDX_GET_BRICKS;
+
     /**
      * Initialises a new instance.
      */
@@ -121,6 +144,34 @@ public:
         return this->FrameCount();
     }
 
+    /**
+     * Gets the brick index set by the data source in IDX_GET_BRICK_INDEX.
+     *
+     * @return The brick index or nullptr if the volume is not bricked.
+     */
+    inline const VolumetricBrickIndex* GetBrickIndex(void) const {
+        return this->brickIndex;
+    }
+
+    /**
+     * Gets the bricks requested by the caller.
+     *
+     * @return The numbers of the bricks in the brick index.
+     */
+    inline const std::vector<size_t>& GetBrickRequest(void) const {
+        return this->brickRequest;
+    }
+
+    /**
+     * Gets the bricks set by the data source in IDX_GET_BRICKS, in the
+     * order of the request.
+     *
+     * @return The voxels of the requested bricks.
+     */
+    inline const std::vector<BrickData>& GetBricks(void) const {
+        return this->bricks;
+    }
+
     /**
      * Gets the number of components per grid point.
      *
@@ -266,6 +317,33 @@ public:
      */
     bool IsUniform(const int axis) const;
 
+    /**
+     * Sets the brick index. The data source remains owner of the index.
+     *
+     * @param index The brick index or nullptr if the volume is not bricked.
+     */
+    inline void SetBrickIndex(const VolumetricBrickIndex* index) {
+        this->brickIndex = index;
+    }
+
+    /**
+     * Sets the bricks to be retrieved by IDX_GET_BRICKS.
+     *
+     * @param bricks The numbers of the bricks in the brick index.
+     */
+    inline void SetBrickRequest(std::vector<size_t> bricks) {
+        this->brickRequest = std::move(bricks);
+    }
+
+    /**
+     * Sets the voxels of the requested bricks.
+     *
+     * @param bricks The voxels of the bricks in the order of the request.
+     */
+    inline void SetBricks(std::vector<BrickData> bricks) {
+        this->bricks = std::move(bricks);
+    }
+
     /**
      * Sets the data pointer.
      *
@@ -313,7 +391,16 @@ private:
     typedef AbstractGetData3DCall Base;
 
     /** The functions that are provided by the call. */
-    static const char* FUNCTIONS[6];
+    static const char* FUNCTIONS[8];
+
+    /** The brick index of a bricked volume, owned by the data source. */
+    const VolumetricBrickIndex* brickIndex;
+
+    /** The numbers of the bricks the caller requests. */
+    std::vector<size_t> brickRequest;
+
+    /** The voxels of the requested bricks. */
+    std::vector<BrickData> bricks;
 
     /** The pointer to the raw data. The call does not own this memory! */
     void* data;
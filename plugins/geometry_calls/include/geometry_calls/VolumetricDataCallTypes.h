@@ -133,4 +133,24 @@ struct VolumetricMetadata_t {
     enum MemoryLocation MemLoc;
 };
 
+/**
+ * A brick of a bricked volume, ie a box of voxels of one level of detail.
+ * The voxels of a brick are stored x fastest with all components of a voxel
+ * next to each other, like the voxels of a whole frame.
+ */
+struct VolumetricBrick_t {
+
+    /** The level of detail, 0 being the full resolution. */
+    unsigned int Level;
+
+    /** The first voxel of the brick in the grid of its level. */
+    size_t Origin[3];
+
+    /** The number of voxels of the brick along each axis. */
+    size_t Size[3];
+
+    /** The offset of the brick from the begin of its frame in bytes. */
+    unsigned long long Offset;
+};
+
 } // namespace megamol::geocalls
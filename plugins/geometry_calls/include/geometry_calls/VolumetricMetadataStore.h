@@ -13,6 +13,7 @@
 #include "mmcore/api/MegaMolCore.std.h"
 
 #include "geometry_calls/VolumetricDataCallTypes.h"
+#include "geometry_calls/VolumetricStatistics.h"
 
 
 namespace megamol::geocalls {
@@ -20,6 +21,10 @@ namespace megamol::geocalls {
 /**
  * A self-contained storage class for VolumetricMetadata_t to be used if the
  * metadata are not obtained from the datRaw library.
+ *
+ * The store also caches the statistics of the data it describes, so that
+ * producers do not need to scan their data for the value ranges themselves
+ * and consumers can obtain histograms without rescanning.
  */
 class VolumetricMetadataStore : public VolumetricMetadata_t {
 
@@ -38,12 +43,35 @@ public:
 
     VolumetricMetadataStore& operator=(const VolumetricMetadata_t& rhs);
 
+    /**
+     * Answer the statistics computed by the last call to UpdateStatistics.
+     */
+    inline const VolumetricStatistics& GetStatistics(void) const {
+        return this->statistics;
+    }
+
+    /**
+     * Computes the statistics of the data described by the store unless they
+     * have been computed for the same data hash and frame before, and sets
+     * MinValues and MaxValues to the range of the data.
+     *
+     * @param data    The voxels of the frame.
+     * @param hash    The data hash of the producer.
+     * @param frameID The frame the data belong to.
+     * @param bins    The number of histogram bins.
+     *
+     * @return The statistics of the data.
+     */
+    const VolumetricStatistics& UpdateStatistics(const void* data, std::size_t hash, unsigned int frameID,
+        std::size_t bins = VolumetricStatistics::DEFAULT_BINS);
+
 private:
     void rewrire(void);
 
     std::vector<double> maxValues;
     std::vector<double> minValues;
     std::array<std::vector<float>, 3> sliceDists;
+    VolumetricStatistics statistics;
 };
 
 } // namespace megamol::geocalls
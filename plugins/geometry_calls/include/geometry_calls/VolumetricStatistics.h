@@ -0,0 +1,194 @@
+/*
+ * VolumetricStatistics.h
+ *
+ * Copyright (C) 2022 by Visualisierungsinstitut der Universität Stuttgart.
+ * Alle rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "geometry_calls/VolumetricDataCallTypes.h"
+
+
+namespace megamol::geocalls {
+
+/**
+ * Value statistics of one frame of a volume: the range, mean and variance
+ * of every component and a histogram with a fixed number of bins over the
+ * range of every component.
+ *
+ * The statistics remember the data hash and frame they have been computed
+ * for, so that producers can call Update whenever they deliver data and
+ * only pay for a scan if the data have actually changed.
+ */
+class VolumetricStatistics {
+
+public:
+    /** The default number of histogram bins. */
+    static constexpr size_t DEFAULT_BINS = 256;
+
+    /**
+     * Computes the statistics of a frame. Range, mean and variance of all
+     * components are computed in one parallel pass over the data, the
+     * histogram in a second one once the range is known.
+     *
+     * @param data         The voxels of the frame, components interleaved.
+     * @param scalarType   The type of the scalars.
+     * @param scalarLength The size of a scalar in bytes.
+     * @param components   The number of components per voxel.
+     * @param voxels       The number of voxels.
+     * @param bins         The number of histogram bins, zero for skipping the
+     *                     histogram.
+     *
+     * @return The statistics, which are empty if the scalar type is not
+     *         supported.
+     */
+    static VolumetricStatistics Compute(const void* data, ScalarType_t scalarType, size_t scalarLength,
+        size_t components, size_t voxels, size_t bins = DEFAULT_BINS);
+
+    /**
+     * Computes the statistics of a frame described by 'metadata'.
+     */
+    static VolumetricStatistics Compute(
+        const void* data, const VolumetricMetadata_t& metadata, size_t bins = DEFAULT_BINS);
+
+    /** Initialise empty statistics. */
+    VolumetricStatistics(void);
+
+    /** Clears the statistics. */
+    void Clear(void);
+
+    /**
+     * Answer the number of histogram bins per component.
+     */
+    inline size_t GetBins(void) const {
+        return this->bins;
+    }
+
+    /**
+     * Answer the number of components.
+     */
+    inline size_t GetComponents(void) const {
+        return this->minValues.size();
+    }
+
+    /**
+     * Answer the histogram of component 'c', which has GetBins() bins
+     * evenly dividing [GetMinValue(c), GetMaxValue(c)].
+     */
+    inline const uint64_t* GetHistogram(size_t c = 0) const {
+        return this->histograms.data() + c * this->bins;
+    }
+
+    /**
+     * Answer the largest value of component 'c'.
+     */
+    inline double GetMaxValue(size_t c = 0) const {
+        return this->maxValues[c];
+    }
+
+    /**
+     * Answer the mean of component 'c'.
+     */
+    inline double GetMean(size_t c = 0) const {
+        return this->means[c];
+    }
+
+    /**
+     * Answer the smallest value of component 'c'.
+     */
+    inline double GetMinValue(size_t c = 0) const {
+        return this->minValues[c];
+    }
+
+    /**
+     * Answer the (population) variance of component 'c'.
+     */
+    inline double GetVariance(size_t c = 0) const {
+        return this->variances[c];
+    }
+
+    /**
+     * Answer the number of voxels the statistics have been computed for.
+     */
+    inline size_t GetVoxels(void) const {
+        return this->voxels;
+    }
+
+    /**
+     * Answer whether no statistics have been computed.
+     */
+    inline bool IsEmpty(void) const {
+        return this->minValues.empty();
+    }
+
+    /**
+     * Computes the statistics of a frame unless they have been computed for
+     * the same data hash, frame and format before.
+     *
+     * @param data     The voxels of the frame.
+     * @param metadata The format of the frame.
+     * @param hash     The data hash of the producer.
+     * @param frameID  The frame the data belong to.
+     * @param bins     The number of histogram bins.
+     *
+     * @return 'true' if the statistics have been recomputed, 'false' if the
+     *         cached ones are still valid or the format is not supported.
+     */
+    bool Update(const void* data, const VolumetricMetadata_t& metadata, size_t hash, unsigned int frameID,
+        size_t bins = DEFAULT_BINS);
+
+private:
+    /** The key of the cached statistics. */
+    struct Key {
+        size_t Hash;
+        unsigned int FrameID;
+        ScalarType_t ScalarType;
+        size_t ScalarLength;
+        size_t Components;
+        size_t Voxels;
+        size_t Bins;
+
+        inline bool operator==(const Key& rhs) const {
+            return (this->Hash == rhs.Hash) && (this->FrameID == rhs.FrameID) &&
+                   (this->ScalarType == rhs.ScalarType) && (this->ScalarLength == rhs.ScalarLength) &&
+                   (this->Components == rhs.Components) && (this->Voxels == rhs.Voxels) && (this->Bins == rhs.Bins);
+        }
+    };
+
+    /** Computes the statistics of data of type T. */
+    template<class T>
+    static VolumetricStatistics compute(const T* data, size_t components, size_t voxels, size_t bins);
+
+    /** The number of histogram bins per component. */
+    size_t bins;
+
+    /** The histograms of all components, one after the other. */
+    std::vector<uint64_t> histograms;
+
+    /** The key of the data the statistics have been computed for. */
+    Key key;
+
+    /** Whether 'key' is valid. */
+    bool isKeyValid;
+
+    /** The largest value of every component. */
+    std::vector<double> maxValues;
+
+    /** The mean of every component. */
+    std::vector<double> means;
+
+    /** The smallest value of every component. */
+    std::vector<double> minValues;
+
+    /** The variance of every component. */
+    std::vector<double> variances;
+
+    /** The number of voxels. */
+    size_t voxels;
+};
+
+} // namespace megamol::geocalls
@@ -0,0 +1,168 @@
+/*
+ * VolumetricBrickIndex.cpp
+ *
+ * Copyright (C) 2022 by Visualisierungsinstitut der Universität Stuttgart.
+ * Alle rechte vorbehalten.
+ */
+
+#include "geometry_calls/VolumetricBrickIndex.h"
+#include "stdafx.h"
+
+#include <algorithm>
+
+
+namespace megamol::geocalls {
+
+/*
+ * VolumetricBrickIndex::VolumetricBrickIndex
+ */
+VolumetricBrickIndex::VolumetricBrickIndex(void)
+        : brickShift(0)
+        , components(0)
+        , frameID(0)
+        , frameSize(0)
+        , scalarLength(0)
+        , scalarType(ScalarType_t::UNKNOWN) {}
+
+
+/*
+ * VolumetricBrickIndex::Layout
+ */
+bool VolumetricBrickIndex::Layout(const size_t resolution[3], ScalarType_t scalarType, size_t scalarLength,
+    size_t components, size_t brickSize, unsigned int levels) {
+    this->Clear();
+
+    if ((brickSize < 2) || ((brickSize & (brickSize - 1)) != 0) || (scalarLength == 0) || (components == 0)) {
+        return false;
+    }
+    for (int i = 0; i < 3; ++i) {
+        if (resolution[i] == 0) {
+            return false;
+        }
+    }
+
+    while ((static_cast<size_t>(1) << this->brickShift) < brickSize) {
+        ++this->brickShift;
+    }
+    this->scalarType = scalarType;
+    this->scalarLength = scalarLength;
+    this->components = components;
+
+    /* Halve the resolution until the requested number of levels or a single brick is reached. */
+    Level level;
+    std::copy(resolution, resolution + 3, level.Resolution);
+    level.First = 0;
+    while (true) {
+        bool isSingle = true;
+        for (int i = 0; i < 3; ++i) {
+            level.Bricks[i] = (level.Resolution[i] + brickSize - 1) >> this->brickShift;
+            isSingle = isSingle && (level.Bricks[i] == 1);
+        }
+        this->levels.push_back(level);
+        level.First += level.Bricks[0] * level.Bricks[1] * level.Bricks[2];
+
+        if ((levels != 0) ? (this->levels.size() >= levels) : isSingle) {
+            break;
+        }
+        for (int i = 0; i < 3; ++i) {
+            level.Resolution[i] = std::max<size_t>(1, (level.Resolution[i] + 1) / 2);
+        }
+    }
+
+    /* Enumerate the bricks, which are stored in this order. */
+    this->bricks.reserve(level.First);
+    for (unsigned int l = 0; l < this->levels.size(); ++l) {
+        const auto& lvl = this->levels[l];
+        for (size_t bz = 0; bz < lvl.Bricks[2]; ++bz) {
+            for (size_t by = 0; by < lvl.Bricks[1]; ++by) {
+                for (size_t bx = 0; bx < lvl.Bricks[0]; ++bx) {
+                    VolumetricBrick_t brick;
+                    brick.Level = l;
+                    brick.Origin[0] = bx << this->brickShift;
+                    brick.Origin[1] = by << this->brickShift;
+                    brick.Origin[2] = bz << this->brickShift;
+                    for (int i = 0; i < 3; ++i) {
+                        brick.Size[i] = std::min(brickSize, lvl.Resolution[i] - brick.Origin[i]);
+                    }
+                    brick.Offset = this->frameSize;
+                    this->bricks.push_back(brick);
+                    this->frameSize += this->GetBrickBytes(this->bricks.size() - 1);
+                }
+            }
+        }
+    }
+
+    this->ranges.assign(2 * this->bricks.size() * this->components, 0.0);
+    return true;
+}
+
+
+/*
+ * VolumetricBrickIndex::Clear
+ */
+void VolumetricBrickIndex::Clear(void) {
+    this->bricks.clear();
+    this->brickShift = 0;
+    this->components = 0;
+    this->frameID = 0;
+    this->frameSize = 0;
+    this->levels.clear();
+    this->ranges.clear();
+    this->scalarLength = 0;
+    this->scalarType = ScalarType_t::UNKNOWN;
+}
+
+
+/*
+ * VolumetricBrickIndex::GetBricksInBox
+ */
+std::vector<size_t> VolumetricBrickIndex::GetBricksInBox(
+    unsigned int level, const size_t first[3], const size_t last[3]) const {
+    std::vector<size_t> retval;
+    if (level >= this->levels.size()) {
+        return retval;
+    }
+
+    const auto& lvl = this->levels[level];
+    size_t lo[3], hi[3];
+    for (int i = 0; i < 3; ++i) {
+        if (first[i] > last[i] || first[i] >= lvl.Resolution[i]) {
+            return retval;
+        }
+        lo[i] = first[i] >> this->brickShift;
+        hi[i] = std::min(last[i], lvl.Resolution[i] - 1) >> this->brickShift;
+    }
+
+    retval.reserve((hi[0] - lo[0] + 1) * (hi[1] - lo[1] + 1) * (hi[2] - lo[2] + 1));
+    for (size_t bz = lo[2]; bz <= hi[2]; ++bz) {
+        for (size_t by = lo[1]; by <= hi[1]; ++by) {
+            for (size_t bx = lo[0]; bx <= hi[0]; ++bx) {
+                retval.push_back(this->GetBrick(level, bx, by, bz));
+            }
+        }
+    }
+    return retval;
+}
+
+
+/*
+ * VolumetricBrickIndex::GetBricksInRange
+ */
+std::vector<size_t> VolumetricBrickIndex::GetBricksInRange(
+    unsigned int level, double minValue, double maxValue, size_t c) const {
+    std::vector<size_t> retval;
+    if ((level >= this->levels.size()) || (c >= this->components)) {
+        return retval;
+    }
+
+    const auto& lvl = this->levels[level];
+    const auto end = lvl.First + lvl.Bricks[0] * lvl.Bricks[1] * lvl.Bricks[2];
+    for (size_t b = lvl.First; b < end; ++b) {
+        if ((this->GetMinValue(b, c) <= maxValue) && (this->GetMaxValue(b, c) >= minValue)) {
+            retval.push_back(b);
+        }
+    }
+    return retval;
+}
+
+} // namespace megamol::geocalls
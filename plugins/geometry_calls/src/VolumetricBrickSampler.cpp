@@ -0,0 +1,274 @@
+/*
+ * VolumetricBrickSampler.cpp
+ *
+ * Copyright (C) 2022 by Visualisierungsinstitut der Universität Stuttgart.
+ * Alle rechte vorbehalten.
+ */
+
+#include "geometry_calls/VolumetricBrickSampler.h"
+#include "stdafx.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "mmcore/utility/log/Log.h"
+
+
+namespace megamol::geocalls {
+
+/*
+ * VolumetricBrickSampler::VolumetricBrickSampler
+ */
+VolumetricBrickSampler::VolumetricBrickSampler(void)
+        : call(nullptr)
+        , index(nullptr)
+        , level(0)
+        , voxelSize(0) {}
+
+
+/*
+ * VolumetricBrickSampler::~VolumetricBrickSampler
+ */
+VolumetricBrickSampler::~VolumetricBrickSampler(void) {
+    this->Close();
+}
+
+
+/*
+ * VolumetricBrickSampler::Open
+ */
+bool VolumetricBrickSampler::Open(VolumetricDataCall& call, unsigned int level) {
+    this->Close();
+
+    call.SetBrickIndex(nullptr);
+    if (!call(VolumetricDataCall::IDX_GET_BRICK_INDEX)) {
+        return false;
+    }
+    auto index = call.GetBrickIndex();
+    if ((index == nullptr) || index->IsEmpty()) {
+        return false;
+    }
+
+    this->call = &call;
+    this->index = index;
+    this->level = std::min(level, index->GetLevels() - 1);
+    this->voxelSize = index->GetVoxelSize();
+    this->bricks.resize(index->Count());
+    return true;
+}
+
+
+/*
+ * VolumetricBrickSampler::Close
+ */
+void VolumetricBrickSampler::Close(void) {
+    this->bricks.clear();
+    this->bricks.shrink_to_fit();
+    this->call = nullptr;
+    this->index = nullptr;
+    this->level = 0;
+    this->voxelSize = 0;
+}
+
+
+/*
+ * VolumetricBrickSampler::Fetch
+ */
+bool VolumetricBrickSampler::Fetch(const std::vector<size_t>& bricks) {
+    using megamol::core::utility::log::Log;
+
+    if (this->call == nullptr) {
+        return false;
+    }
+
+    std::vector<size_t> missing;
+    for (auto b : bricks) {
+        if ((b < this->bricks.size()) && (this->bricks[b] == nullptr)) {
+            missing.push_back(b);
+        }
+    }
+    if (missing.empty()) {
+        return true;
+    }
+    std::sort(missing.begin(), missing.end());
+    missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+
+    this->call->SetBrickRequest(missing);
+    if (!(*this->call)(VolumetricDataCall::IDX_GET_BRICKS)) {
+        Log::DefaultLog.WriteError("%hs::%hs failed for %u bricks.", VolumetricDataCall::ClassName(),
+            VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_GET_BRICKS), missing.size());
+        return false;
+    }
+
+    const auto& data = this->call->GetBricks();
+    bool retval = (data.size() == missing.size());
+    for (size_t i = 0; retval && (i < missing.size()); ++i) {
+        if ((data[i] == nullptr) || (data[i]->size() != this->index->GetBrickBytes(missing[i]))) {
+            retval = false;
+        } else {
+            this->bricks[missing[i]] = data[i];
+        }
+    }
+
+    // The sampler becomes the only user of the bricks besides the cache of the source.
+    this->call->SetBricks({});
+    this->call->SetBrickRequest({});
+
+    if (!retval) {
+        Log::DefaultLog.WriteError("%hs::%hs returned invalid bricks.", VolumetricDataCall::ClassName(),
+            VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_GET_BRICKS));
+    }
+    return retval;
+}
+
+
+/*
+ * VolumetricBrickSampler::FetchBox
+ */
+bool VolumetricBrickSampler::FetchBox(const size_t first[3], const size_t last[3]) {
+    if (this->call == nullptr) {
+        return false;
+    }
+    return this->Fetch(this->index->GetBricksInBox(this->level, first, last));
+}
+
+
+/*
+ * VolumetricBrickSampler::Evict
+ */
+void VolumetricBrickSampler::Evict(void) {
+    std::fill(this->bricks.begin(), this->bricks.end(), nullptr);
+}
+
+
+/*
+ * VolumetricBrickSampler::GetBrick
+ */
+const uint8_t* VolumetricBrickSampler::GetBrick(size_t brick) {
+    if ((this->call == nullptr) || (brick >= this->bricks.size())) {
+        return nullptr;
+    }
+    if ((this->bricks[brick] == nullptr) && !this->Fetch({brick})) {
+        return nullptr;
+    }
+    return this->PeekBrick(brick);
+}
+
+
+/*
+ * VolumetricBrickSampler::GetVoxel
+ */
+const void* VolumetricBrickSampler::GetVoxel(size_t x, size_t y, size_t z) {
+    if (this->call == nullptr) {
+        return nullptr;
+    }
+    const auto b = this->index->GetBrickAt(this->level, x, y, z);
+    const auto* data = this->GetBrick(b);
+    if (data == nullptr) {
+        return nullptr;
+    }
+    return data + this->voxelOffset(b, x, y, z);
+}
+
+
+/*
+ * VolumetricBrickSampler::Value
+ */
+double VolumetricBrickSampler::Value(size_t x, size_t y, size_t z, size_t c) const {
+    const auto* voxel = this->PeekVoxel(x, y, z);
+    if (voxel == nullptr) {
+        return 0.0;
+    }
+
+    switch (this->index->GetScalarType()) {
+    case SIGNED_INTEGER:
+        switch (this->index->GetScalarLength()) {
+        case 1:
+            return static_cast<const int8_t*>(voxel)[c];
+        case 2:
+            return static_cast<const int16_t*>(voxel)[c];
+        case 4:
+            return static_cast<const int32_t*>(voxel)[c];
+        case 8:
+            return static_cast<double>(static_cast<const int64_t*>(voxel)[c]);
+        }
+        break;
+
+    case UNSIGNED_INTEGER:
+        switch (this->index->GetScalarLength()) {
+        case 1:
+            return static_cast<const uint8_t*>(voxel)[c];
+        case 2:
+            return static_cast<const uint16_t*>(voxel)[c];
+        case 4:
+            return static_cast<const uint32_t*>(voxel)[c];
+        case 8:
+            return static_cast<double>(static_cast<const uint64_t*>(voxel)[c]);
+        }
+        break;
+
+    case FLOATING_POINT:
+        switch (this->index->GetScalarLength()) {
+        case 4:
+            return static_cast<const float*>(voxel)[c];
+        case 8:
+            return static_cast<const double*>(voxel)[c];
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return 0.0;
+}
+
+
+/*
+ * VolumetricBrickSampler::Read
+ */
+bool VolumetricBrickSampler::Read(const size_t first[3], const size_t size[3], void* dst) {
+    if (this->call == nullptr) {
+        return false;
+    }
+
+    const auto* resolution = this->GetResolution();
+    for (int i = 0; i < 3; ++i) {
+        if ((size[i] == 0) || (first[i] + size[i] > resolution[i])) {
+            return false;
+        }
+    }
+
+    const auto brickSize = this->index->GetBrickSize();
+    const size_t last[3] = {first[0] + size[0] - 1, first[1] + size[1] - 1, first[2] + size[2] - 1};
+    auto* out = static_cast<uint8_t*>(dst);
+
+    bool retval = true;
+    for (size_t z0 = first[2]; retval && (z0 <= last[2]); z0 = (z0 / brickSize + 1) * brickSize) {
+        /* Fetch one layer of bricks and copy the rows of the box that lie in it. */
+        const size_t z1 = std::min(last[2], (z0 / brickSize + 1) * brickSize - 1);
+        const size_t layerFirst[3] = {first[0], first[1], z0};
+        const size_t layerLast[3] = {last[0], last[1], z1};
+        retval = this->FetchBox(layerFirst, layerLast);
+
+        for (size_t z = z0; retval && (z <= z1); ++z) {
+            for (size_t y = first[1]; y <= last[1]; ++y) {
+                auto* row = out + (((z - first[2]) * size[1] + (y - first[1])) * size[0]) * this->voxelSize;
+                for (size_t x = first[0]; x <= last[0];) {
+                    const auto b = this->index->GetBrickAt(this->level, x, y, z);
+                    const auto& brick = this->index->GetBrick(b);
+                    const auto cnt = std::min(last[0] + 1, brick.Origin[0] + brick.Size[0]) - x;
+                    ::memcpy(row + (x - first[0]) * this->voxelSize, this->PeekBrick(b) + this->voxelOffset(b, x, y, z),
+                        cnt * this->voxelSize);
+                    x += cnt;
+                }
+            }
+        }
+
+        this->Evict();
+    }
+
+    return retval;
+}
+
+} // namespace megamol::geocalls
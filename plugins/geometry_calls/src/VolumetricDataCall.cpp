@@ -111,17 +111,34 @@ const unsigned int VolumetricDataCall::IDX_STOP_ASYNC = 4;
 const unsigned int VolumetricDataCall::IDX_TRY_GET_DATA = 5;
 
 
+/*
+ * VolumetricDataCall::IDX_GET_BRICK_INDEX
+ */
+const unsigned int VolumetricDataCall::IDX_GET_BRICK_INDEX = 6;
+
+
+/*
+ * VolumetricDataCall::IDX_GET_BRICKS
+ */
+const unsigned int VolumetricDataCall::IDX_GET_BRICKS = 7;
+
+
 /*
  * VolumetricDataCall::VolumetricDataCall
  */
-VolumetricDataCall::VolumetricDataCall(void) : data(nullptr), metadata(nullptr), vram_volume_name(0) {}
+VolumetricDataCall::VolumetricDataCall(void)
+        : brickIndex(nullptr)
+        , data(nullptr)
+        , metadata(nullptr)
+        , vram_volume_name(0) {}
 
 
 /*
  * VolumetricDataCall::VolumetricDataCall
  */
 VolumetricDataCall::VolumetricDataCall(const VolumetricDataCall& rhs)
-        : data(nullptr)
+        : brickIndex(nullptr)
+        , data(nullptr)
         , metadata(nullptr)
         , vram_volume_name(0) {
     *this = rhs;
@@ -321,6 +338,9 @@ void VolumetricDataCall::SetMetadata(const Metadata* metadata) {
 VolumetricDataCall& VolumetricDataCall::operator=(const VolumetricDataCall& rhs) {
     if (this != &rhs) {
         Base::operator=(rhs);
+        this->brickIndex = rhs.brickIndex;
+        this->brickRequest = rhs.brickRequest;
+        this->bricks = rhs.bricks;
         this->data = rhs.data;
         this->metadata = rhs.metadata;
     }
@@ -332,5 +352,5 @@ VolumetricDataCall& VolumetricDataCall::operator=(const VolumetricDataCall& rhs)
  * VolumetricDataCall::FUNCTIONS
  */
 const char* VolumetricDataCall::FUNCTIONS[] = {
-    "GetExtents", "GetData", "GetMetadata", "StartAsync", "StopAsync", "TryGetData"};
+    "GetExtents", "GetData", "GetMetadata", "StartAsync", "StopAsync", "TryGetData", "GetBrickIndex", "GetBricks"};
 } // namespace megamol::geocalls
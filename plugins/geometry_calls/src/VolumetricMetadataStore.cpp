@@ -18,7 +18,9 @@ namespace megamol::geocalls {
 VolumetricMetadataStore::VolumetricMetadataStore(const VolumetricMetadataStore& rhs)
         : maxValues(rhs.maxValues)
         , minValues(rhs.minValues)
-        , sliceDists(rhs.sliceDists) {
+        , sliceDists(rhs.sliceDists)
+        , statistics(rhs.statistics) {
+    ::memcpy(this, std::addressof(rhs), sizeof(VolumetricMetadata_t));
     this->rewrire();
 }
 
@@ -29,7 +31,9 @@ VolumetricMetadataStore::VolumetricMetadataStore(const VolumetricMetadataStore&
 VolumetricMetadataStore::VolumetricMetadataStore(VolumetricMetadataStore&& rhs) noexcept
         : maxValues(std::move(rhs.maxValues))
         , minValues(std::move(rhs.minValues))
-        , sliceDists(std::move(rhs.sliceDists)) {
+        , sliceDists(std::move(rhs.sliceDists))
+        , statistics(std::move(rhs.statistics)) {
+    ::memcpy(this, std::addressof(rhs), sizeof(VolumetricMetadata_t));
     this->rewrire();
     rhs.rewrire();
     assert(rhs.MinValues == nullptr);
@@ -51,6 +55,10 @@ VolumetricMetadataStore::VolumetricMetadataStore(const VolumetricMetadata_t& rhs
 VolumetricMetadataStore& VolumetricMetadataStore::operator=(const VolumetricMetadataStore& rhs) {
     if (this != std::addressof(rhs)) {
         ::memcpy(this, std::addressof(rhs), sizeof(VolumetricMetadata_t));
+        this->maxValues = rhs.maxValues;
+        this->minValues = rhs.minValues;
+        this->sliceDists = rhs.sliceDists;
+        this->statistics = rhs.statistics;
         this->rewrire();
     }
     return *this;
@@ -63,6 +71,10 @@ VolumetricMetadataStore& VolumetricMetadataStore::operator=(const VolumetricMeta
 VolumetricMetadataStore& VolumetricMetadataStore::operator=(VolumetricMetadataStore&& rhs) noexcept {
     if (this != std::addressof(rhs)) {
         ::memcpy(this, std::addressof(rhs), sizeof(VolumetricMetadata_t));
+        this->maxValues = std::move(rhs.maxValues);
+        this->minValues = std::move(rhs.minValues);
+        this->sliceDists = std::move(rhs.sliceDists);
+        this->statistics = std::move(rhs.statistics);
         this->rewrire();
         rhs.rewrire();
         assert(rhs.MinValues == nullptr);
@@ -115,6 +127,7 @@ VolumetricMetadataStore& VolumetricMetadataStore::operator=(const VolumetricMeta
             break;
         }
 
+        this->statistics.Clear();
         this->rewrire();
     }
 
@@ -122,6 +135,27 @@ VolumetricMetadataStore& VolumetricMetadataStore::operator=(const VolumetricMeta
 }
 
 
+/*
+ * VolumetricMetadataStore::UpdateStatistics
+ */
+const VolumetricStatistics& VolumetricMetadataStore::UpdateStatistics(
+    const void* data, std::size_t hash, unsigned int frameID, std::size_t bins) {
+    this->statistics.Update(data, *this, hash, frameID, bins);
+
+    if (this->statistics.GetComponents() == this->Components) {
+        this->minValues.resize(this->Components);
+        this->maxValues.resize(this->Components);
+        for (std::size_t i = 0; i < this->Components; ++i) {
+            this->minValues[i] = this->statistics.GetMinValue(i);
+            this->maxValues[i] = this->statistics.GetMaxValue(i);
+        }
+        this->rewrire();
+    }
+
+    return this->statistics;
+}
+
+
 /*
  * VolumetricMetadataStore::rewrire
  */
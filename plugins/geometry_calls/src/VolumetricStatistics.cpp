@@ -0,0 +1,310 @@
+/*
+ * VolumetricStatistics.cpp
+ *
+ * Copyright (C) 2022 by Visualisierungsinstitut der Universität Stuttgart.
+ * Alle rechte vorbehalten.
+ */
+
+#include "geometry_calls/VolumetricStatistics.h"
+#include "stdafx.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+#include "mmcore/utility/TaskScheduler.h"
+
+
+namespace {
+
+/** The number of voxels a task processes at once. */
+constexpr size_t BLOCK_VOXELS = 1 << 16;
+
+/**
+ * The number of independent accumulators in the scan of a block. Besides
+ * breaking the dependency chains of the reductions, this allows the compiler
+ * to map the lanes to vector registers.
+ */
+constexpr size_t LANES = 8;
+
+/** Range and moments of a part of a component. */
+struct Moments {
+    double Min = std::numeric_limits<double>::max();
+    double Max = std::numeric_limits<double>::lowest();
+    double Count = 0.0;
+    double Mean = 0.0;
+    double M2 = 0.0;
+};
+
+/**
+ * Adds the moments of 'src' to 'dst' using the pairwise update of Chan et
+ * al., which keeps the variance accurate for large volumes.
+ */
+void merge(Moments& dst, const Moments& src) {
+    dst.Min = (std::min)(dst.Min, src.Min);
+    dst.Max = (std::max)(dst.Max, src.Max);
+    if (src.Count == 0.0) {
+        return;
+    }
+    if (dst.Count == 0.0) {
+        dst.Count = src.Count;
+        dst.Mean = src.Mean;
+        dst.M2 = src.M2;
+        return;
+    }
+
+    const auto count = dst.Count + src.Count;
+    const auto delta = src.Mean - dst.Mean;
+    dst.Mean += delta * src.Count / count;
+    dst.M2 += src.M2 + delta * delta * dst.Count * src.Count / count;
+    dst.Count = count;
+}
+
+/**
+ * Scans 'cnt' values that are 'stride' scalars apart. The sums are taken
+ * relative to the first value to avoid cancellation in the variance.
+ */
+template<class T>
+Moments scan(const T* data, const size_t cnt, const size_t stride) {
+    Moments retval;
+    if (cnt == 0) {
+        return retval;
+    }
+
+    const auto shift = std::isfinite(static_cast<double>(data[0])) ? static_cast<double>(data[0]) : 0.0;
+    double mins[LANES], maxs[LANES], sums[LANES], squares[LANES];
+    std::fill(mins, mins + LANES, retval.Min);
+    std::fill(maxs, maxs + LANES, retval.Max);
+    std::fill(sums, sums + LANES, 0.0);
+    std::fill(squares, squares + LANES, 0.0);
+
+    size_t i = 0;
+    for (; i + LANES <= cnt; i += LANES) {
+        for (size_t l = 0; l < LANES; ++l) {
+            const auto v = static_cast<double>(data[(i + l) * stride]);
+            mins[l] = (v < mins[l]) ? v : mins[l];
+            maxs[l] = (v > maxs[l]) ? v : maxs[l];
+            const auto d = v - shift;
+            sums[l] += d;
+            squares[l] += d * d;
+        }
+    }
+    for (; i < cnt; ++i) {
+        const auto v = static_cast<double>(data[i * stride]);
+        mins[0] = (v < mins[0]) ? v : mins[0];
+        maxs[0] = (v > maxs[0]) ? v : maxs[0];
+        const auto d = v - shift;
+        sums[0] += d;
+        squares[0] += d * d;
+    }
+
+    double sum = 0.0, square = 0.0;
+    for (size_t l = 0; l < LANES; ++l) {
+        retval.Min = (std::min)(retval.Min, mins[l]);
+        retval.Max = (std::max)(retval.Max, maxs[l]);
+        sum += sums[l];
+        square += squares[l];
+    }
+    retval.Count = static_cast<double>(cnt);
+    retval.Mean = shift + sum / retval.Count;
+    retval.M2 = (std::max)(0.0, square - sum * sum / retval.Count);
+    return retval;
+}
+
+/**
+ * Counts 'cnt' values that are 'stride' scalars apart into 'bins' bins
+ * evenly dividing [minValue, maxValue].
+ */
+template<class T>
+void count(const T* data, const size_t cnt, const size_t stride, const double minValue, const double maxValue,
+    const size_t bins, uint64_t* histogram) {
+    const auto scale = (maxValue > minValue) ? static_cast<double>(bins) / (maxValue - minValue) : 0.0;
+    for (size_t i = 0; i < cnt; ++i) {
+        const auto v = static_cast<double>(data[i * stride]);
+        if ((v >= minValue) && (v <= maxValue)) {
+            const auto b = static_cast<size_t>((v - minValue) * scale);
+            ++histogram[(std::min)(b, bins - 1)];
+        }
+    }
+}
+
+} // namespace
+
+
+namespace megamol::geocalls {
+
+/*
+ * VolumetricStatistics::Compute
+ */
+VolumetricStatistics VolumetricStatistics::Compute(const void* data, ScalarType_t scalarType, size_t scalarLength,
+    size_t components, size_t voxels, size_t bins) {
+    if ((data == nullptr) || (components == 0)) {
+        return VolumetricStatistics();
+    }
+
+    switch (scalarType) {
+    case SIGNED_INTEGER:
+        switch (scalarLength) {
+        case 1:
+            return compute(static_cast<const int8_t*>(data), components, voxels, bins);
+        case 2:
+            return compute(static_cast<const int16_t*>(data), components, voxels, bins);
+        case 4:
+            return compute(static_cast<const int32_t*>(data), components, voxels, bins);
+        case 8:
+            return compute(static_cast<const int64_t*>(data), components, voxels, bins);
+        }
+        break;
+
+    case UNSIGNED_INTEGER:
+        switch (scalarLength) {
+        case 1:
+            return compute(static_cast<const uint8_t*>(data), components, voxels, bins);
+        case 2:
+            return compute(static_cast<const uint16_t*>(data), components, voxels, bins);
+        case 4:
+            return compute(static_cast<const uint32_t*>(data), components, voxels, bins);
+        case 8:
+            return compute(static_cast<const uint64_t*>(data), components, voxels, bins);
+        }
+        break;
+
+    case FLOATING_POINT:
+        switch (scalarLength) {
+        case 4:
+            return compute(static_cast<const float*>(data), components, voxels, bins);
+        case 8:
+            return compute(static_cast<const double*>(data), components, voxels, bins);
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return VolumetricStatistics();
+}
+
+
+/*
+ * VolumetricStatistics::Compute
+ */
+VolumetricStatistics VolumetricStatistics::Compute(
+    const void* data, const VolumetricMetadata_t& metadata, size_t bins) {
+    const auto voxels = metadata.Resolution[0] * metadata.Resolution[1] * metadata.Resolution[2];
+    return Compute(data, metadata.ScalarType, metadata.ScalarLength, metadata.Components, voxels, bins);
+}
+
+
+/*
+ * VolumetricStatistics::VolumetricStatistics
+ */
+VolumetricStatistics::VolumetricStatistics(void) : bins(0), isKeyValid(false), voxels(0) {}
+
+
+/*
+ * VolumetricStatistics::Clear
+ */
+void VolumetricStatistics::Clear(void) {
+    this->bins = 0;
+    this->histograms.clear();
+    this->isKeyValid = false;
+    this->maxValues.clear();
+    this->means.clear();
+    this->minValues.clear();
+    this->variances.clear();
+    this->voxels = 0;
+}
+
+
+/*
+ * VolumetricStatistics::Update
+ */
+bool VolumetricStatistics::Update(
+    const void* data, const VolumetricMetadata_t& metadata, size_t hash, unsigned int frameID, size_t bins) {
+    const Key key = {hash, frameID, metadata.ScalarType, metadata.ScalarLength, metadata.Components,
+        metadata.Resolution[0] * metadata.Resolution[1] * metadata.Resolution[2], bins};
+    if (this->isKeyValid && (this->key == key)) {
+        return false;
+    }
+
+    *this = Compute(data, metadata, bins);
+    if (this->IsEmpty()) {
+        return false;
+    }
+
+    this->key = key;
+    this->isKeyValid = true;
+    return true;
+}
+
+
+/*
+ * VolumetricStatistics::compute
+ */
+template<class T>
+VolumetricStatistics VolumetricStatistics::compute(
+    const T* data, size_t components, size_t voxels, size_t bins) {
+    VolumetricStatistics retval;
+    const auto blocks = (voxels + BLOCK_VOXELS - 1) / BLOCK_VOXELS;
+
+    /* Range and moments of every block, merged in order to be reproducible. */
+    std::vector<Moments> partials(blocks * components);
+    core::utility::ParallelFor<size_t>(0, blocks, 1, [&](size_t begin, size_t end) {
+        for (auto b = begin; b < end; ++b) {
+            const auto first = b * BLOCK_VOXELS;
+            const auto cnt = (std::min)(voxels - first, BLOCK_VOXELS);
+            for (size_t c = 0; c < components; ++c) {
+                partials[b * components + c] = scan(data + first * components + c, cnt, components);
+            }
+        }
+    });
+
+    std::vector<Moments> moments(components);
+    for (size_t b = 0; b < blocks; ++b) {
+        for (size_t c = 0; c < components; ++c) {
+            merge(moments[c], partials[b * components + c]);
+        }
+    }
+
+    retval.voxels = voxels;
+    retval.minValues.resize(components);
+    retval.maxValues.resize(components);
+    retval.means.resize(components);
+    retval.variances.resize(components);
+    for (size_t c = 0; c < components; ++c) {
+        const auto& m = moments[c];
+        retval.minValues[c] = (m.Count > 0.0) ? m.Min : 0.0;
+        retval.maxValues[c] = (m.Count > 0.0) ? m.Max : 0.0;
+        retval.means[c] = m.Mean;
+        retval.variances[c] = (m.Count > 0.0) ? m.M2 / m.Count : 0.0;
+    }
+
+    /* The histogram needs the range, so it takes a second pass. */
+    retval.bins = bins;
+    retval.histograms.assign(bins * components, 0);
+    if ((bins > 0) && (voxels > 0)) {
+        std::mutex lock;
+        core::utility::ParallelFor<size_t>(0, blocks, 0, [&](size_t begin, size_t end) {
+            std::vector<uint64_t> histograms(bins * components, 0);
+            for (auto b = begin; b < end; ++b) {
+                const auto first = b * BLOCK_VOXELS;
+                const auto cnt = (std::min)(voxels - first, BLOCK_VOXELS);
+                for (size_t c = 0; c < components; ++c) {
+                    count(data + first * components + c, cnt, components, retval.minValues[c], retval.maxValues[c],
+                        bins, histograms.data() + c * bins);
+                }
+            }
+
+            std::lock_guard<std::mutex> l(lock);
+            for (size_t i = 0; i < histograms.size(); ++i) {
+                retval.histograms[i] += histograms[i];
+            }
+        });
+    }
+
+    return retval;
+}
+
+} // namespace megamol::geocalls
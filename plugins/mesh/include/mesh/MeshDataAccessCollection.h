@@ -9,6 +9,8 @@
 #ifndef MESH_DATA_ACCESS_COLLECTION_H_INCLUDED
 #define MESH_DATA_ACCESS_COLLECTION_H_INCLUDED
 
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -163,20 +165,48 @@ public:
         // TODO interleaved flag?
     };
 
+    /** Integer handle of a mesh, stays valid until the mesh is deleted. Handles of deleted meshes are reused. */
+    using MeshHandle = uint32_t;
+    static constexpr MeshHandle InvalidHandle = std::numeric_limits<MeshHandle>::max();
+
     MeshDataAccessCollection() = default;
     ~MeshDataAccessCollection() = default;
 
-    void addMesh(std::string const& identifier, std::vector<VertexAttribute> const& attribs, IndexData const& indices,
-        PrimitiveType primitive_type = TRIANGLES);
-    void addMesh(std::string const& identifier, std::vector<VertexAttribute>&& attribs, IndexData const& indices,
+    MeshDataAccessCollection(MeshDataAccessCollection const& other);
+    MeshDataAccessCollection(MeshDataAccessCollection&& other) = default;
+    MeshDataAccessCollection& operator=(MeshDataAccessCollection const& other);
+    MeshDataAccessCollection& operator=(MeshDataAccessCollection&& other) = default;
+
+    /**
+     * Adds a mesh, an existing mesh with the same identifier is kept.
+     *
+     * @return The handle of the mesh with the given identifier.
+     */
+    MeshHandle addMesh(std::string const& identifier, std::vector<VertexAttribute> const& attribs,
+        IndexData const& indices, PrimitiveType primitive_type = TRIANGLES);
+    MeshHandle addMesh(std::string const& identifier, std::vector<VertexAttribute>&& attribs, IndexData const& indices,
         PrimitiveType primitive_type = TRIANGLES);
 
     void deleteMesh(std::string const& identifier);
 
+    void deleteMesh(MeshHandle handle);
+
+    /**
+     * Answer the mesh map. Meshes must not be added or removed through it, as that would bypass the handles.
+     */
     std::unordered_map<std::string, Mesh>& accessMeshes();
 
     Mesh const& accessMesh(std::string const& identifier);
 
+    /** Access a mesh without hashing its identifier. */
+    Mesh const& accessMesh(MeshHandle handle) const;
+
+    /** Answer the handle of a mesh, InvalidHandle if there is no mesh with this identifier. */
+    MeshHandle findMesh(std::string const& identifier) const;
+
+    /** Answer the identifier of a mesh. */
+    std::string const& identifier(MeshHandle handle) const;
+
     /**
      * Get attributes of a mesh grouped by vertex buffer format (non-interleaved vs interleaved mostly).
      * Is computed by checking the data pointers of individual attributes.
@@ -189,29 +219,91 @@ public:
     std::vector<std::vector<unsigned int>> getFormattedAttributeIndices(std::string const& identifier);
 
 private:
+    MeshHandle insertMesh(std::string const& identifier, Mesh&& mesh);
+
+    bool validHandle(MeshHandle handle) const {
+        return handle < handle_entries.size() && handle_entries[handle] != nullptr;
+    }
+
     std::unordered_map<std::string, Mesh> meshes;
+
+    /** Map entries by handle, entries of an unordered_map keep their address when the map grows */
+    std::vector<std::pair<std::string const, Mesh>*> handle_entries;
+    std::unordered_map<std::string, MeshHandle> handles;
+    std::vector<MeshHandle> free_handles;
 };
 
-inline void MeshDataAccessCollection::addMesh(std::string const& identifier,
+inline MeshDataAccessCollection::MeshDataAccessCollection(MeshDataAccessCollection const& other)
+        : meshes(other.meshes)
+        , handle_entries(other.handle_entries.size(), nullptr)
+        , handles(other.handles)
+        , free_handles(other.free_handles) {
+    // the handles stay the same, but have to point to the copied entries
+    for (auto const& entry : handles) {
+        handle_entries[entry.second] = &*meshes.find(entry.first);
+    }
+}
+
+inline MeshDataAccessCollection& MeshDataAccessCollection::operator=(MeshDataAccessCollection const& other) {
+    if (this != &other) {
+        *this = MeshDataAccessCollection(other);
+    }
+    return *this;
+}
+
+inline MeshDataAccessCollection::MeshHandle MeshDataAccessCollection::insertMesh(
+    std::string const& identifier, Mesh&& mesh) {
+    auto const result = meshes.insert({identifier, std::move(mesh)});
+    if (!result.second) {
+        return handles.at(identifier);
+    }
+
+    MeshHandle handle;
+    if (!free_handles.empty()) {
+        handle = free_handles.back();
+        free_handles.pop_back();
+        handle_entries[handle] = &*result.first;
+    } else {
+        handle = static_cast<MeshHandle>(handle_entries.size());
+        handle_entries.push_back(&*result.first);
+    }
+    handles.insert({identifier, handle});
+    return handle;
+}
+
+inline MeshDataAccessCollection::MeshHandle MeshDataAccessCollection::addMesh(std::string const& identifier,
     std::vector<VertexAttribute> const& attribs, IndexData const& indices, PrimitiveType primitive_type) {
-    meshes.insert({identifier, {attribs, indices, primitive_type}});
+    return insertMesh(identifier, {attribs, indices, primitive_type});
 }
 
-inline void MeshDataAccessCollection::addMesh(std::string const& identifier, std::vector<VertexAttribute>&& attribs,
-    IndexData const& indices, PrimitiveType primitive_type) {
-    meshes.insert({identifier, {attribs, indices, primitive_type}});
+inline MeshDataAccessCollection::MeshHandle MeshDataAccessCollection::addMesh(std::string const& identifier,
+    std::vector<VertexAttribute>&& attribs, IndexData const& indices, PrimitiveType primitive_type) {
+    return insertMesh(identifier, {std::move(attribs), indices, primitive_type});
 }
 
 inline void MeshDataAccessCollection::deleteMesh(std::string const& identifier) {
-    auto query = meshes.find(identifier);
+    auto query = handles.find(identifier);
 
-    if (query != meshes.end()) {
-        meshes.erase(query);
+    if (query != handles.end()) {
+        deleteMesh(query->second);
     } else {
         megamol::core::utility::log::Log::DefaultLog.WriteError("deleteMesh error: identifier not found.");
     }
 }
 
+inline void MeshDataAccessCollection::deleteMesh(MeshHandle handle) {
+    if (!validHandle(handle)) {
+        megamol::core::utility::log::Log::DefaultLog.WriteError("deleteMesh error: invalid handle.");
+        return;
+    }
+
+    auto const identifier = handle_entries[handle]->first;
+    meshes.erase(identifier);
+    handles.erase(identifier);
+    handle_entries[handle] = nullptr;
+    free_handles.push_back(handle);
+}
+
 inline std::unordered_map<std::string, MeshDataAccessCollection::Mesh>& MeshDataAccessCollection::accessMeshes() {
     return meshes;
 }
@@ -230,6 +322,33 @@ inline MeshDataAccessCollection::Mesh const& MeshDataAccessCollection::accessMes
     return retval;
 }
 
+inline MeshDataAccessCollection::Mesh const& MeshDataAccessCollection::accessMesh(MeshHandle handle) const {
+    static Mesh const invalid_mesh = {{}, {nullptr, 0, UNSIGNED_INT}, TRIANGLES};
+
+    if (!validHandle(handle)) {
+        megamol::core::utility::log::Log::DefaultLog.WriteError("accessMesh error: invalid handle.");
+        return invalid_mesh;
+    }
+
+    return handle_entries[handle]->second;
+}
+
+inline MeshDataAccessCollection::MeshHandle MeshDataAccessCollection::findMesh(std::string const& identifier) const {
+    auto query = handles.find(identifier);
+    return query != handles.end() ? query->second : InvalidHandle;
+}
+
+inline std::string const& MeshDataAccessCollection::identifier(MeshHandle handle) const {
+    static std::string const invalid_identifier;
+
+    if (!validHandle(handle)) {
+        megamol::core::utility::log::Log::DefaultLog.WriteError("identifier error: invalid handle.");
+        return invalid_identifier;
+    }
+
+    return handle_entries[handle]->first;
+}
+
 inline std::vector<std::vector<unsigned int>> MeshDataAccessCollection::getFormattedAttributeIndices(
     std::string const& identifier) {
     auto retval = std::vector<std::vector<unsigned int>>();
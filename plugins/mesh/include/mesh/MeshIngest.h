@@ -0,0 +1,129 @@
+/*
+ * MeshIngest.h
+ * Copyright (C) 2022 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+#ifndef MESH_INGEST_H_INCLUDED
+#define MESH_INGEST_H_INCLUDED
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "mesh/MeshDataAccessCollection.h"
+#include "mmcore/utility/TextParsing.h"
+
+namespace megamol {
+namespace mesh {
+namespace ingest {
+
+// the text parsing layer is shared with the particle loaders
+using core::utility::chunkAtLines;
+using core::utility::lineOffsets;
+using core::utility::MappedFile;
+using core::utility::TextCursor;
+
+/**
+ * Triangle or line mesh with separate attribute arrays and a shared index buffer.
+ * Attribute arrays are either empty or hold one entry per vertex.
+ */
+struct IngestedMesh {
+    std::string name;
+    std::vector<float> positions; // xyz
+    std::vector<float> normals;   // xyz
+    std::vector<float> texcoords; // uv
+    std::vector<uint32_t> indices;
+    MeshDataAccessCollection::PrimitiveType primitive_type = MeshDataAccessCollection::TRIANGLES;
+
+    size_t vertexCount() const {
+        return positions.size() / 3;
+    }
+
+    /**
+     * Adds the mesh to a collection. The collection references the buffers of this mesh, so it has to outlive
+     * the collection.
+     */
+    void addTo(MeshDataAccessCollection& collection, std::string const& identifier);
+};
+
+struct IngestedScene {
+    std::vector<IngestedMesh> meshes;
+
+    /** min x, y, z, max x, y, z over all meshes */
+    std::array<float, 6> bbox;
+
+    void computeBoundingBox();
+};
+
+/**
+ * Parses a Wavefront OBJ file in parallel chunks. Faces are triangulated as fans, every object or group becomes a
+ * mesh, line elements end up in an additional line mesh of their group. Corners sharing position, texture
+ * coordinate and normal are merged into one vertex via hashing.
+ *
+ * @param file  The mapped file.
+ * @param scene The parsed meshes.
+ * @param error Description of the problem if parsing failed.
+ *
+ * @return 'true' on success.
+ */
+bool parseObj(MappedFile const& file, IngestedScene& scene, std::string& error);
+
+/** Answers whether the STL file is binary, i.e. its size matches the triangle count of the binary header. */
+bool isBinaryStl(MappedFile const& file);
+
+/** Answers the triangle count of a binary STL file, 0 if the file is not binary STL. */
+uint32_t binaryStlTriangleCount(MappedFile const& file);
+
+/**
+ * Reads a binary STL file in parallel directly into the given buffers. The face normal is replicated to the three
+ * vertices of a triangle.
+ *
+ * @param file      The mapped file.
+ * @param positions Buffer for 9 floats per triangle.
+ * @param normals   Buffer for 9 floats per triangle.
+ */
+void readBinaryStl(MappedFile const& file, float* positions, float* normals);
+
+/**
+ * Parses an ASCII STL file in parallel chunks into a mesh without index buffer, three vertices per triangle.
+ *
+ * @param file  The mapped file.
+ * @param mesh  The parsed triangles, the face normal is replicated to the three vertices.
+ * @param error Description of the problem if parsing failed.
+ *
+ * @return 'true' on success.
+ */
+bool parseAsciiStl(MappedFile const& file, IngestedMesh& mesh, std::string& error);
+
+/**
+ * Hashes the content of the file in parallel.
+ *
+ * @param file The mapped file.
+ *
+ * @return The hash value.
+ */
+uint64_t contentHash(MappedFile const& file);
+
+/**
+ * Loads a scene through the binary mesh cache. If a cache entry exists for the file content and parser, it is read
+ * instead of parsing the file. Otherwise the file is parsed and the result is written to the cache.
+ * The cache lives in the directory 'megamol_mesh_cache' in the temporary directory of the system.
+ *
+ * @param file   The mapped file.
+ * @param parser Name and version of the parser, part of the cache key.
+ * @param scene  The loaded scene.
+ * @param error  Description of the problem if parsing failed.
+ * @param parse  The parser.
+ *
+ * @return 'true' on success.
+ */
+bool loadCached(MappedFile const& file, std::string const& parser, IngestedScene& scene, std::string& error,
+    std::function<bool(MappedFile const&, IngestedScene&, std::string&)> const& parse);
+
+} // namespace ingest
+} // namespace mesh
+} // namespace megamol
+
+#endif // !MESH_INGEST_H_INCLUDED
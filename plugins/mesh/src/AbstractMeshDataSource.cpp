@@ -78,6 +78,7 @@ void megamol::mesh::AbstractMeshDataSource::syncMeshAccessCollection(CallMesh* l
             for (auto const& identifier : m_mesh_access_collection.second) {
                 MeshDataAccessCollection::Mesh mesh = m_mesh_access_collection.first->accessMesh(identifier);
                 mesh_access_collection.first->addMesh(identifier, mesh.attributes, mesh.indices, mesh.primitive_type);
+                mesh_access_collection.second.push_back(identifier);
                 m_mesh_access_collection.first->deleteMesh(identifier);
             }
 
@@ -0,0 +1,905 @@
+/*
+ * MeshIngest.cpp
+ * Copyright (C) 2022 by MegaMol Team
+ * Alle Rechte vorbehalten.
+ */
+
+#include "mesh/MeshIngest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <set>
+
+#include "mmcore/utility/TaskScheduler.h"
+#include "mmcore/utility/log/Log.h"
+
+namespace megamol {
+namespace mesh {
+namespace ingest {
+
+namespace {
+
+using core::utility::isBlank;
+
+inline uint64_t mix(uint64_t h) {
+    // finalizer of splitmix64
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return h;
+}
+
+template<typename Func>
+void forEachChunk(std::vector<size_t> const& chunks, Func const& func) {
+    core::utility::ParallelFor<size_t>(0, chunks.size() - 1, 1, [&](size_t begin, size_t end) {
+        for (auto c = begin; c < end; ++c) {
+            func(c, chunks[c], chunks[c + 1]);
+        }
+    });
+}
+
+/** Keeps the first error reported by any of the parallel parsers. */
+class ErrorSlot {
+public:
+    void set(std::string const& error) {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_error.empty()) {
+            m_error = error;
+        }
+        m_failed.store(true, std::memory_order_relaxed);
+    }
+
+    bool failed() const {
+        return m_failed.load(std::memory_order_relaxed);
+    }
+
+    std::string const& error() const {
+        return m_error;
+    }
+
+private:
+    std::mutex m_lock;
+    std::string m_error;
+    std::atomic<bool> m_failed{false};
+};
+
+} // namespace
+
+
+/*
+ * IngestedMesh / IngestedScene
+ */
+void IngestedMesh::addTo(MeshDataAccessCollection& collection, std::string const& identifier) {
+    auto const vertex_cnt = vertexCount();
+    std::vector<MeshDataAccessCollection::VertexAttribute> attributes;
+    attributes.push_back({reinterpret_cast<uint8_t*>(positions.data()),
+        3 * vertex_cnt * MeshDataAccessCollection::getByteSize(MeshDataAccessCollection::FLOAT), 3,
+        MeshDataAccessCollection::FLOAT, 12, 0, MeshDataAccessCollection::POSITION});
+    if (!normals.empty()) {
+        attributes.push_back({reinterpret_cast<uint8_t*>(normals.data()),
+            3 * vertex_cnt * MeshDataAccessCollection::getByteSize(MeshDataAccessCollection::FLOAT), 3,
+            MeshDataAccessCollection::FLOAT, 12, 0, MeshDataAccessCollection::NORMAL});
+    }
+    if (!texcoords.empty()) {
+        attributes.push_back({reinterpret_cast<uint8_t*>(texcoords.data()),
+            2 * vertex_cnt * MeshDataAccessCollection::getByteSize(MeshDataAccessCollection::FLOAT), 2,
+            MeshDataAccessCollection::FLOAT, 8, 0, MeshDataAccessCollection::TEXCOORD});
+    }
+
+    MeshDataAccessCollection::IndexData mesh_indices;
+    mesh_indices.data = reinterpret_cast<uint8_t*>(indices.data());
+    mesh_indices.byte_size = indices.size() * MeshDataAccessCollection::getByteSize(MeshDataAccessCollection::UNSIGNED_INT);
+    mesh_indices.type = MeshDataAccessCollection::UNSIGNED_INT;
+
+    collection.addMesh(identifier, std::move(attributes), mesh_indices, primitive_type);
+}
+
+void IngestedScene::computeBoundingBox() {
+    std::array<float, 6> const empty = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+        std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+        std::numeric_limits<float>::lowest()};
+    bbox = empty;
+    std::mutex lock;
+    for (auto const& mesh : meshes) {
+        core::utility::ParallelFor<size_t>(0, mesh.vertexCount(), 0, [&](size_t begin, size_t end) {
+            std::array<float, 6> local = empty;
+            for (auto v = begin; v < end; ++v) {
+                for (int i = 0; i < 3; ++i) {
+                    local[i] = std::min(local[i], mesh.positions[3 * v + i]);
+                    local[i + 3] = std::max(local[i + 3], mesh.positions[3 * v + i]);
+                }
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            for (int i = 0; i < 3; ++i) {
+                bbox[i] = std::min(bbox[i], local[i]);
+                bbox[i + 3] = std::max(bbox[i + 3], local[i + 3]);
+            }
+        });
+    }
+}
+
+
+/*
+ * Wavefront OBJ
+ */
+namespace {
+
+/** Marks indices relative to the vertex count of the chunk until the counts of preceding chunks are known. */
+constexpr int64_t relative_tag = int64_t(1) << 61;
+constexpr int64_t missing_index = std::numeric_limits<int64_t>::min();
+constexpr uint32_t no_index = std::numeric_limits<uint32_t>::max();
+
+struct ObjCorner {
+    int64_t v, vt, vn;
+};
+
+struct ObjGroup {
+    std::string name;
+    size_t first_corner;
+    size_t first_line_corner;
+};
+
+struct ObjChunk {
+    std::vector<float> v, vt, vn;
+    std::vector<ObjCorner> corners;
+    std::vector<ObjCorner> line_corners;
+    std::vector<ObjGroup> groups;
+    std::string error;
+};
+
+/** Position, texture coordinate and normal index of a corner, no_index if missing. */
+using CornerKey = std::array<uint32_t, 3>;
+
+
+bool parseObjCorner(TextCursor& cursor, std::array<size_t, 3> const& counts, ObjCorner& corner) {
+    // v, v/vt, v//vn or v/vt/vn, negative indices count backwards from the current element
+    corner = {missing_index, missing_index, missing_index};
+    std::array<int64_t*, 3> const out = {&corner.v, &corner.vt, &corner.vn};
+    for (int i = 0; i < 3; ++i) {
+        if (i > 0) {
+            if (!cursor.consume('/'))
+                break;
+            auto const next = cursor.atEnd() ? '\0' : *cursor.position();
+            if (next != '-' && next != '+' && (next < '0' || next > '9'))
+                continue;
+        }
+        int64_t idx = 0;
+        if (!cursor.parseInt(idx))
+            return false;
+        if (idx > 0) {
+            *out[i] = idx - 1;
+        } else if (idx < 0) {
+            *out[i] = static_cast<int64_t>(counts[i]) + idx + relative_tag;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void parseObjChunk(char const* data, size_t begin, size_t end, ObjChunk& chunk) {
+    TextCursor cursor(data + begin, data + end);
+    std::vector<ObjCorner> polygon;
+
+    auto const fail = [&](char const* what) {
+        chunk.error = std::string("invalid ") + what + " at byte " + std::to_string(cursor.position() - data);
+    };
+    auto const counts = [&chunk]() {
+        return std::array<size_t, 3>{chunk.v.size() / 3, chunk.vt.size() / 2, chunk.vn.size() / 3};
+    };
+    auto const read_polygon = [&]() {
+        polygon.clear();
+        auto const current = counts();
+        ObjCorner corner;
+        while (!cursor.atLineEnd()) {
+            if (!parseObjCorner(cursor, current, corner))
+                return false;
+            polygon.push_back(corner);
+        }
+        return true;
+    };
+
+    while (true) {
+        cursor.skipWhitespace();
+        if (cursor.atEnd())
+            break;
+        auto const token = cursor.token();
+        auto const is = [token](char const* keyword) { return token == keyword; };
+
+        if (is("v")) {
+            float x, y, z;
+            if (!cursor.parseFloat(x) || !cursor.parseFloat(y) || !cursor.parseFloat(z)) {
+                fail("vertex");
+                return;
+            }
+            // an optional w or vertex colors follow, both are ignored
+            chunk.v.insert(chunk.v.end(), {x, y, z});
+        } else if (is("vn")) {
+            float x, y, z;
+            if (!cursor.parseFloat(x) || !cursor.parseFloat(y) || !cursor.parseFloat(z)) {
+                fail("normal");
+                return;
+            }
+            chunk.vn.insert(chunk.vn.end(), {x, y, z});
+        } else if (is("vt")) {
+            float u, v = 0.0f;
+            if (!cursor.parseFloat(u) || (!cursor.atLineEnd() && !cursor.parseFloat(v))) {
+                fail("texture coordinate");
+                return;
+            }
+            chunk.vt.insert(chunk.vt.end(), {u, v});
+        } else if (is("f")) {
+            if (!read_polygon() || polygon.size() < 3) {
+                fail("face");
+                return;
+            }
+            for (size_t k = 1; k + 1 < polygon.size(); ++k) {
+                chunk.corners.insert(chunk.corners.end(), {polygon[0], polygon[k], polygon[k + 1]});
+            }
+        } else if (is("l")) {
+            if (!read_polygon() || polygon.size() < 2) {
+                fail("line");
+                return;
+            }
+            for (size_t k = 0; k + 1 < polygon.size(); ++k) {
+                chunk.line_corners.insert(chunk.line_corners.end(), {polygon[k], polygon[k + 1]});
+            }
+        } else if (is("o") || is("g")) {
+            cursor.skipBlanks();
+            auto const* name_begin = cursor.position();
+            while (!cursor.atLineEnd()) {
+                cursor.token();
+            }
+            auto const* name_end = cursor.position();
+            while (name_end > name_begin && isBlank(name_end[-1])) {
+                --name_end;
+            }
+            chunk.groups.push_back(
+                {std::string(name_begin, name_end), chunk.corners.size(), chunk.line_corners.size()});
+        }
+        // comments, materials and smoothing groups are skipped
+        cursor.skipLine();
+    }
+}
+
+/**
+ * Builds an indexed mesh from a range of corners. Corners with the same key share a vertex.
+ * The corners are partitioned by hash, every partition is deduplicated independently with an open addressing table.
+ * Vertices are numbered in order of their first use afterwards, so neighboring triangles stay close in memory.
+ */
+IngestedMesh buildObjMesh(std::vector<CornerKey> const& keys, size_t begin, size_t end,
+    std::vector<float> const& positions, std::vector<float> const& texcoords, std::vector<float> const& normals,
+    MeshDataAccessCollection::PrimitiveType type) {
+    auto const n = end - begin;
+    auto const* corners = keys.data() + begin;
+    auto const hash = [](CornerKey const& key) {
+        return mix(((static_cast<uint64_t>(key[0]) << 32) | key[1]) ^ mix(key[2] + 0x9e3779b97f4a7c15ull));
+    };
+
+    unsigned int const partition_bits = n < (1u << 16) ? 0 : 6;
+    size_t const partitions = size_t(1) << partition_bits;
+    auto const partition_of = [partition_bits](uint64_t h) {
+        return partition_bits == 0 ? size_t(0) : static_cast<size_t>(h >> (64 - partition_bits));
+    };
+    auto const workers = core::utility::TaskScheduler::Instance().WorkerCount() + 1;
+    size_t const slices = std::max<size_t>(1, std::min<size_t>(n >> 16, 4 * workers));
+    auto const slice_begin = [n, slices](size_t s) { return n * s / slices; };
+
+    std::vector<uint64_t> hashes(n);
+    std::vector<size_t> offsets(slices * partitions, 0);
+    std::atomic<bool> has_texcoords{false}, has_normals{false};
+    core::utility::ParallelFor<size_t>(0, slices, 1, [&](size_t first, size_t last) {
+        for (auto s = first; s < last; ++s) {
+            bool tex = false, norm = false;
+            for (auto i = slice_begin(s); i < slice_begin(s + 1); ++i) {
+                hashes[i] = hash(corners[i]);
+                ++offsets[s * partitions + partition_of(hashes[i])];
+                tex = tex || corners[i][1] != no_index;
+                norm = norm || corners[i][2] != no_index;
+            }
+            if (tex)
+                has_texcoords.store(true, std::memory_order_relaxed);
+            if (norm)
+                has_normals.store(true, std::memory_order_relaxed);
+        }
+    });
+
+    // corners of a partition are ordered by slice, so they keep their relative order
+    std::vector<size_t> partition_begin(partitions + 1, 0);
+    size_t running = 0;
+    for (size_t p = 0; p < partitions; ++p) {
+        partition_begin[p] = running;
+        for (size_t s = 0; s < slices; ++s) {
+            auto const count = offsets[s * partitions + p];
+            offsets[s * partitions + p] = running;
+            running += count;
+        }
+    }
+    partition_begin[partitions] = running;
+
+    std::vector<uint32_t> order(n);
+    core::utility::ParallelFor<size_t>(0, slices, 1, [&](size_t first, size_t last) {
+        for (auto s = first; s < last; ++s) {
+            auto* slice_offsets = offsets.data() + s * partitions;
+            for (auto i = slice_begin(s); i < slice_begin(s + 1); ++i) {
+                order[slice_offsets[partition_of(hashes[i])]++] = static_cast<uint32_t>(i);
+            }
+        }
+    });
+
+    std::vector<uint32_t> vertex_of(n);
+    std::vector<uint32_t> partition_vertices(partitions + 1, 0);
+    core::utility::ParallelFor<size_t>(0, partitions, 1, [&](size_t first, size_t last) {
+        for (auto p = first; p < last; ++p) {
+            auto const count = partition_begin[p + 1] - partition_begin[p];
+            size_t capacity = 16;
+            while (capacity < 2 * count) {
+                capacity *= 2;
+            }
+            std::vector<uint32_t> slots(capacity, no_index);
+            uint32_t next = 0;
+            for (auto j = partition_begin[p]; j < partition_begin[p + 1]; ++j) {
+                auto const i = order[j];
+                auto slot = hashes[i] & (capacity - 1);
+                while (true) {
+                    auto const other = slots[slot];
+                    if (other == no_index) {
+                        slots[slot] = i;
+                        vertex_of[i] = next++;
+                        break;
+                    }
+                    if (corners[other] == corners[i]) {
+                        vertex_of[i] = vertex_of[other];
+                        break;
+                    }
+                    slot = (slot + 1) & (capacity - 1);
+                }
+            }
+            partition_vertices[p + 1] = next;
+        }
+    });
+    for (size_t p = 0; p < partitions; ++p) {
+        partition_vertices[p + 1] += partition_vertices[p];
+    }
+    core::utility::ParallelFor<size_t>(0, partitions, 1, [&](size_t first, size_t last) {
+        for (auto p = first; p < last; ++p) {
+            for (auto j = partition_begin[p]; j < partition_begin[p + 1]; ++j) {
+                vertex_of[order[j]] += partition_vertices[p];
+            }
+        }
+    });
+    std::vector<uint32_t>().swap(order);
+    std::vector<uint64_t>().swap(hashes);
+
+    auto const vertex_count = partition_vertices[partitions];
+    IngestedMesh mesh;
+    mesh.primitive_type = type;
+    mesh.indices.resize(n);
+    std::vector<uint32_t> renumber(vertex_count, no_index);
+    std::vector<uint32_t> first_corner(vertex_count);
+    uint32_t next = 0;
+    for (size_t i = 0; i < n; ++i) {
+        auto& v = renumber[vertex_of[i]];
+        if (v == no_index) {
+            v = next;
+            first_corner[next++] = static_cast<uint32_t>(i);
+        }
+        mesh.indices[i] = v;
+    }
+
+    mesh.positions.resize(3 * static_cast<size_t>(vertex_count));
+    if (has_normals.load()) {
+        mesh.normals.resize(3 * static_cast<size_t>(vertex_count), 0.0f);
+    }
+    if (has_texcoords.load()) {
+        mesh.texcoords.resize(2 * static_cast<size_t>(vertex_count), 0.0f);
+    }
+    core::utility::ParallelFor<size_t>(0, vertex_count, 0, [&](size_t first, size_t last) {
+        for (auto v = first; v < last; ++v) {
+            auto const& key = corners[first_corner[v]];
+            std::copy_n(&positions[3 * static_cast<size_t>(key[0])], 3, &mesh.positions[3 * v]);
+            if (!mesh.normals.empty() && key[2] != no_index) {
+                std::copy_n(&normals[3 * static_cast<size_t>(key[2])], 3, &mesh.normals[3 * v]);
+            }
+            if (!mesh.texcoords.empty() && key[1] != no_index) {
+                std::copy_n(&texcoords[2 * static_cast<size_t>(key[1])], 2, &mesh.texcoords[2 * v]);
+            }
+        }
+    });
+
+    return mesh;
+}
+
+} // namespace
+
+
+bool parseObj(MappedFile const& file, IngestedScene& scene, std::string& error) {
+    scene.meshes.clear();
+    auto const* data = file.data();
+
+    auto const chunk_offsets = chunkAtLines(data, file.size());
+    std::vector<ObjChunk> chunks(chunk_offsets.size() - 1);
+    forEachChunk(chunk_offsets, [&](size_t c, size_t begin, size_t end) { parseObjChunk(data, begin, end, chunks[c]); });
+    for (auto const& chunk : chunks) {
+        if (!chunk.error.empty()) {
+            error = chunk.error;
+            return false;
+        }
+    }
+
+    // elements are indexed over the whole file, so every chunk gets the counts of its predecessors as base
+    std::vector<std::array<size_t, 3>> element_base(chunks.size());
+    std::vector<size_t> corner_base(chunks.size()), line_base(chunks.size());
+    std::array<size_t, 3> element_count = {0, 0, 0};
+    size_t corner_count = 0, line_count = 0;
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        element_base[c] = element_count;
+        corner_base[c] = corner_count;
+        line_base[c] = line_count;
+        element_count[0] += chunks[c].v.size() / 3;
+        element_count[1] += chunks[c].vt.size() / 2;
+        element_count[2] += chunks[c].vn.size() / 3;
+        corner_count += chunks[c].corners.size();
+        line_count += chunks[c].line_corners.size();
+    }
+    if (element_count[0] >= no_index || corner_count >= no_index || line_count >= no_index) {
+        error = "too many elements for 32 bit indices";
+        return false;
+    }
+
+    std::vector<float> positions(3 * element_count[0]), texcoords(2 * element_count[1]), normals(3 * element_count[2]);
+    std::vector<CornerKey> corners(corner_count), line_corners(line_count);
+    std::atomic<bool> invalid_index{false};
+    core::utility::ParallelFor<size_t>(0, chunks.size(), 1, [&](size_t first, size_t last) {
+        for (auto c = first; c < last; ++c) {
+            auto& chunk = chunks[c];
+            auto const& base = element_base[c];
+            std::copy(chunk.v.begin(), chunk.v.end(), positions.begin() + 3 * base[0]);
+            std::copy(chunk.vt.begin(), chunk.vt.end(), texcoords.begin() + 2 * base[1]);
+            std::copy(chunk.vn.begin(), chunk.vn.end(), normals.begin() + 3 * base[2]);
+
+            auto const resolve = [&](int64_t idx, int e) {
+                if (idx == missing_index)
+                    return no_index;
+                if (idx >= relative_tag / 2) {
+                    idx = idx - relative_tag + static_cast<int64_t>(base[e]);
+                }
+                if (idx < 0 || static_cast<size_t>(idx) >= element_count[e]) {
+                    invalid_index.store(true, std::memory_order_relaxed);
+                    return uint32_t(0);
+                }
+                return static_cast<uint32_t>(idx);
+            };
+            auto const convert = [&](ObjCorner const& corner) {
+                return CornerKey{resolve(corner.v, 0), resolve(corner.vt, 1), resolve(corner.vn, 2)};
+            };
+            std::transform(
+                chunk.corners.begin(), chunk.corners.end(), corners.begin() + corner_base[c], convert);
+            std::transform(chunk.line_corners.begin(), chunk.line_corners.end(),
+                line_corners.begin() + line_base[c], convert);
+
+            std::vector<float>().swap(chunk.v);
+            std::vector<float>().swap(chunk.vt);
+            std::vector<float>().swap(chunk.vn);
+            std::vector<ObjCorner>().swap(chunk.corners);
+            std::vector<ObjCorner>().swap(chunk.line_corners);
+        }
+    });
+    if (invalid_index.load()) {
+        error = "face or line references an undefined element";
+        return false;
+    }
+    // corners without position are invalid, but the check above only covers defined indices
+    if (element_count[0] == 0 && (corner_count > 0 || line_count > 0)) {
+        error = "faces without vertices";
+        return false;
+    }
+
+    std::vector<ObjGroup> groups = {{"", 0, 0}};
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        for (auto& group : chunks[c].groups) {
+            groups.push_back(
+                {std::move(group.name), corner_base[c] + group.first_corner, line_base[c] + group.first_line_corner});
+        }
+    }
+    groups.push_back({"", corner_count, line_count});
+
+    std::set<std::string> used_names;
+    auto const unique_name = [&used_names](std::string const& name) {
+        auto const base = name.empty() ? std::string("mesh") : name;
+        auto candidate = base;
+        for (int n = 1; !used_names.insert(candidate).second; ++n) {
+            candidate = base + "_" + std::to_string(n);
+        }
+        return candidate;
+    };
+
+    for (size_t g = 0; g + 1 < groups.size(); ++g) {
+        auto const& group = groups[g];
+        auto const& next = groups[g + 1];
+        if (next.first_corner > group.first_corner) {
+            scene.meshes.push_back(buildObjMesh(corners, group.first_corner, next.first_corner, positions, texcoords,
+                normals, MeshDataAccessCollection::TRIANGLES));
+            scene.meshes.back().name = unique_name(group.name);
+        }
+        if (next.first_line_corner > group.first_line_corner) {
+            scene.meshes.push_back(buildObjMesh(line_corners, group.first_line_corner, next.first_line_corner,
+                positions, texcoords, normals, MeshDataAccessCollection::LINES));
+            scene.meshes.back().name = unique_name(next.first_corner > group.first_corner ? group.name + "_lines"
+                                                                                          : group.name);
+        }
+    }
+
+    scene.computeBoundingBox();
+    return true;
+}
+
+
+/*
+ * STL
+ */
+uint32_t binaryStlTriangleCount(MappedFile const& file) {
+    if (file.size() < 84) {
+        return 0;
+    }
+    uint32_t count = 0;
+    std::memcpy(&count, file.data() + 80, sizeof(uint32_t));
+    return file.size() == 84 + 50 * static_cast<size_t>(count) ? count : 0;
+}
+
+bool isBinaryStl(MappedFile const& file) {
+    // ASCII files start with 'solid', but so do the headers of some binary files, the size check decides
+    if (binaryStlTriangleCount(file) > 0) {
+        return true;
+    }
+    TextCursor cursor(file.data(), file.data() + file.size());
+    cursor.skipWhitespace();
+    return !cursor.keyword("solid");
+}
+
+void readBinaryStl(MappedFile const& file, float* positions, float* normals) {
+    auto const count = binaryStlTriangleCount(file);
+    auto const* data = file.data() + 84;
+    core::utility::ParallelFor<size_t>(0, count, 0, [&](size_t first, size_t last) {
+        for (auto t = first; t < last; ++t) {
+            // normal, three vertices, attribute byte count
+            auto const* triangle = data + 50 * t;
+            std::memcpy(&normals[9 * t + 0], triangle, 3 * sizeof(float));
+            std::memcpy(&normals[9 * t + 3], triangle, 3 * sizeof(float));
+            std::memcpy(&normals[9 * t + 6], triangle, 3 * sizeof(float));
+            std::memcpy(&positions[9 * t], triangle + 3 * sizeof(float), 9 * sizeof(float));
+        }
+    });
+}
+
+bool parseAsciiStl(MappedFile const& file, IngestedMesh& mesh, std::string& error) {
+    auto const* data = file.data();
+    auto const size = file.size();
+
+    // facets must not be split between chunks, so chunks start at the next facet
+    auto chunk_offsets = chunkAtLines(data, size);
+    for (size_t c = 1; c + 1 < chunk_offsets.size(); ++c) {
+        TextCursor cursor(data + std::max(chunk_offsets[c], chunk_offsets[c - 1]), data + size);
+        while (true) {
+            cursor.skipWhitespace();
+            auto const* line = cursor.position();
+            if (cursor.atEnd() || cursor.keyword("facet")) {
+                chunk_offsets[c] = static_cast<size_t>(line - data);
+                break;
+            }
+            cursor.skipLine();
+        }
+    }
+
+    struct StlChunk {
+        std::vector<float> positions;
+        std::vector<float> normals;
+    };
+    std::vector<StlChunk> chunks(chunk_offsets.size() - 1);
+    ErrorSlot errors;
+    forEachChunk(chunk_offsets, [&](size_t c, size_t begin, size_t end) {
+        auto& chunk = chunks[c];
+        TextCursor cursor(data + begin, data + end);
+        auto const fail = [&](char const* what) {
+            errors.set(std::string("expected ") + what + " at byte " + std::to_string(cursor.position() - data));
+        };
+        auto const read_vector = [&cursor](std::vector<float>& out) {
+            float x, y, z;
+            if (!cursor.parseFloat(x) || !cursor.parseFloat(y) || !cursor.parseFloat(z))
+                return false;
+            out.insert(out.end(), {x, y, z});
+            return true;
+        };
+
+        while (!errors.failed()) {
+            cursor.skipWhitespace();
+            if (cursor.atEnd())
+                break;
+            if (cursor.keyword("facet")) {
+                cursor.skipWhitespace();
+                if (!cursor.keyword("normal") || !read_vector(chunk.normals)) {
+                    fail("facet normal");
+                    return;
+                }
+                cursor.skipWhitespace();
+                if (!cursor.keyword("outer")) {
+                    fail("outer loop");
+                    return;
+                }
+                cursor.skipWhitespace();
+                if (!cursor.keyword("loop")) {
+                    fail("outer loop");
+                    return;
+                }
+                for (int v = 0; v < 3; ++v) {
+                    cursor.skipWhitespace();
+                    if (!cursor.keyword("vertex") || !read_vector(chunk.positions)) {
+                        fail("vertex");
+                        return;
+                    }
+                }
+                cursor.skipWhitespace();
+                if (!cursor.keyword("endloop")) {
+                    fail("endloop");
+                    return;
+                }
+                cursor.skipWhitespace();
+                if (!cursor.keyword("endfacet")) {
+                    fail("endfacet");
+                    return;
+                }
+            } else if (cursor.keyword("solid") || cursor.keyword("endsolid")) {
+                // the name of the solid
+                cursor.skipLine();
+            } else {
+                fail("facet");
+                return;
+            }
+        }
+    });
+    if (errors.failed()) {
+        error = errors.error();
+        return false;
+    }
+
+    std::vector<size_t> triangle_base(chunks.size() + 1, 0);
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        triangle_base[c + 1] = triangle_base[c] + chunks[c].normals.size() / 3;
+    }
+    mesh.primitive_type = MeshDataAccessCollection::TRIANGLES;
+    mesh.indices.clear();
+    mesh.texcoords.clear();
+    mesh.positions.resize(9 * triangle_base.back());
+    mesh.normals.resize(9 * triangle_base.back());
+    core::utility::ParallelFor<size_t>(0, chunks.size(), 1, [&](size_t first, size_t last) {
+        for (auto c = first; c < last; ++c) {
+            auto const& chunk = chunks[c];
+            auto const base = triangle_base[c];
+            std::copy(chunk.positions.begin(), chunk.positions.end(), mesh.positions.begin() + 9 * base);
+            for (size_t t = 0; t < chunk.normals.size() / 3; ++t) {
+                for (int v = 0; v < 3; ++v) {
+                    std::copy_n(&chunk.normals[3 * t], 3, &mesh.normals[9 * (base + t) + 3 * v]);
+                }
+            }
+        }
+    });
+    return true;
+}
+
+
+/*
+ * Content hash and cache
+ */
+uint64_t contentHash(MappedFile const& file) {
+    constexpr size_t block_size = 4 << 20;
+    auto const size = file.size();
+    auto const blocks = (size + block_size - 1) / block_size;
+    std::vector<uint64_t> hashes(blocks);
+
+    core::utility::ParallelFor<size_t>(0, blocks, 1, [&](size_t first, size_t last) {
+        for (auto b = first; b < last; ++b) {
+            auto const* cur = file.data() + b * block_size;
+            auto const* const end = file.data() + std::min(size, (b + 1) * block_size);
+            uint64_t h = mix(b + 1);
+            for (; cur + sizeof(uint64_t) <= end; cur += sizeof(uint64_t)) {
+                uint64_t word;
+                std::memcpy(&word, cur, sizeof(uint64_t));
+                h ^= word;
+                h = (h << 29 | h >> 35) * 0x9e3779b97f4a7c15ull;
+            }
+            for (; cur < end; ++cur) {
+                h = (h ^ static_cast<unsigned char>(*cur)) * 0x100000001b3ull;
+            }
+            hashes[b] = mix(h);
+        }
+    });
+
+    uint64_t h = mix(size);
+    for (auto const block_hash : hashes) {
+        h = mix(h ^ block_hash);
+    }
+    return h;
+}
+
+namespace {
+
+constexpr char cache_magic[8] = {'M', 'M', 'M', 'E', 'S', 'H', 'C', '\0'};
+constexpr uint32_t cache_version = 1;
+
+template<typename T>
+void writeValue(std::ostream& out, T const& value) {
+    out.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+template<typename T>
+void writeArray(std::ostream& out, std::vector<T> const& values) {
+    writeValue(out, static_cast<uint64_t>(values.size()));
+    out.write(reinterpret_cast<char const*>(values.data()), values.size() * sizeof(T));
+}
+
+void writeString(std::ostream& out, std::string const& value) {
+    writeValue(out, static_cast<uint32_t>(value.size()));
+    out.write(value.data(), value.size());
+}
+
+class CacheReader {
+public:
+    explicit CacheReader(std::filesystem::path const& path) : m_in(path, std::ios::binary) {
+        std::error_code ec;
+        m_remaining = static_cast<uint64_t>(std::filesystem::file_size(path, ec));
+        if (ec) {
+            m_in.setstate(std::ios::failbit);
+        }
+    }
+
+    bool good() const {
+        return m_in.good();
+    }
+
+    template<typename T>
+    bool read(T& value) {
+        return readBytes(reinterpret_cast<char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    bool readArray(std::vector<T>& values) {
+        uint64_t count = 0;
+        // the size check protects against huge allocations for corrupt files
+        if (!read(count) || count > m_remaining / sizeof(T))
+            return false;
+        values.resize(static_cast<size_t>(count));
+        return readBytes(reinterpret_cast<char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    bool readString(std::string& value) {
+        uint32_t length = 0;
+        if (!read(length) || length > m_remaining)
+            return false;
+        value.resize(length);
+        return readBytes(value.data(), length);
+    }
+
+private:
+    bool readBytes(char* data, size_t count) {
+        if (count > m_remaining)
+            return false;
+        m_in.read(data, count);
+        m_remaining -= count;
+        return m_in.good();
+    }
+
+    std::ifstream m_in;
+    uint64_t m_remaining = 0;
+};
+
+bool readCache(std::filesystem::path const& path, uint64_t key, std::string const& parser, IngestedScene& scene) {
+    CacheReader in(path);
+    if (!in.good())
+        return false;
+
+    char magic[sizeof(cache_magic)];
+    uint32_t version = 0, mesh_count = 0;
+    uint64_t stored_key = 0;
+    std::string stored_parser;
+    if (!in.read(magic) || std::memcmp(magic, cache_magic, sizeof(cache_magic)) != 0 || !in.read(version) ||
+        version != cache_version || !in.read(stored_key) || stored_key != key || !in.readString(stored_parser) ||
+        stored_parser != parser || !in.read(scene.bbox) || !in.read(mesh_count)) {
+        return false;
+    }
+
+    scene.meshes.clear();
+    scene.meshes.resize(mesh_count);
+    for (auto& mesh : scene.meshes) {
+        uint32_t type = 0;
+        if (!in.readString(mesh.name) || !in.read(type) || !in.readArray(mesh.positions) ||
+            !in.readArray(mesh.normals) || !in.readArray(mesh.texcoords) || !in.readArray(mesh.indices)) {
+            scene.meshes.clear();
+            return false;
+        }
+        mesh.primitive_type = static_cast<MeshDataAccessCollection::PrimitiveType>(type);
+    }
+    return true;
+}
+
+bool writeCache(std::filesystem::path const& path, uint64_t key, std::string const& parser, IngestedScene const& scene) {
+    // write to a temporary file first, so concurrent readers never see a partial entry
+    auto tmp_path = path;
+    tmp_path += "." + std::to_string(mix(reinterpret_cast<uintptr_t>(&scene) ^ key)) + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary);
+        if (!out.good())
+            return false;
+        out.write(cache_magic, sizeof(cache_magic));
+        writeValue(out, cache_version);
+        writeValue(out, key);
+        writeString(out, parser);
+        writeValue(out, scene.bbox);
+        writeValue(out, static_cast<uint32_t>(scene.meshes.size()));
+        for (auto const& mesh : scene.meshes) {
+            writeString(out, mesh.name);
+            writeValue(out, static_cast<uint32_t>(mesh.primitive_type));
+            writeArray(out, mesh.positions);
+            writeArray(out, mesh.normals);
+            writeArray(out, mesh.texcoords);
+            writeArray(out, mesh.indices);
+        }
+        if (!out.good()) {
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(tmp_path, ec);
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool loadCached(MappedFile const& file, std::string const& parser, IngestedScene& scene, std::string& error,
+    std::function<bool(MappedFile const&, IngestedScene&, std::string&)> const& parse) {
+    auto const key = contentHash(file);
+
+    std::error_code ec;
+    auto const cache_dir = std::filesystem::temp_directory_path(ec) / "megamol_mesh_cache";
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.mmesh", static_cast<unsigned long long>(key));
+    auto const cache_file = cache_dir / name;
+
+    if (!ec && readCache(cache_file, key, parser, scene)) {
+        core::utility::log::Log::DefaultLog.WriteInfo(
+            "[MeshIngest]: Loaded %zu meshes from cache %s", scene.meshes.size(), cache_file.u8string().c_str());
+        return true;
+    }
+
+    if (!parse(file, scene, error)) {
+        return false;
+    }
+
+    if (!ec) {
+        std::filesystem::create_directories(cache_dir, ec);
+    }
+    if (ec || !writeCache(cache_file, key, parser, scene)) {
+        core::utility::log::Log::DefaultLog.WriteWarn(
+            "[MeshIngest]: Could not write mesh cache %s", cache_file.u8string().c_str());
+    }
+    return true;
+}
+
+} // namespace ingest
+} // namespace mesh
+} // namespace megamol
@@ -11,12 +11,11 @@
 #include "mesh/AbstractMeshDataSource.h"
 #include "mesh/MeshCalls.h"
 #include "mesh/MeshDataAccessCollection.h"
+#include "mesh/MeshIngest.h"
 
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/param/ParamSlot.h"
 
-#include "tiny_obj_loader.h"
-
 namespace megamol {
 namespace mesh {
 
@@ -77,45 +76,19 @@ protected:
     void release();
 
 private:
-    struct TinyObjModel {
-        tinyobj::attrib_t attrib;
-        std::vector<tinyobj::shape_t> shapes;
-        std::vector<tinyobj::material_t> materials;
-    };
-
     uint32_t m_version;
 
     /**
-     * Representation of obj model as loaded by tinyobjloader
-     */
-    std::shared_ptr<TinyObjModel> m_obj_model;
-
-    /**
-     * Internal storage for unpacked positions, i.e one position per vertex, three vertices per triangle
-     */
-    std::vector<std::vector<float>> m_positions;
-
-    /**
-     * Internal storage for unpacked normals, i.e one normal per vertex, three vertices per triangle
-     */
-    std::vector<std::vector<float>> m_normals;
-
-    /**
-     * Internal storage for unpacked texcoords, i.e one texcoord per vertex, three vertices per triangle
-     */
-    std::vector<std::vector<float>> m_texcoords;
-
-    /**
-     *
+     * Meshes of the obj file, referenced by the mesh access collection
      */
-    std::vector<std::vector<unsigned int>> m_indices;
+    std::shared_ptr<ingest::IngestedScene> m_scene;
 
     /**
      * Meta data for communicating data updates, as well as data size
      */
     core::Spatial3DMetaData m_meta_data;
 
-    /** The gltf file name */
+    /** The obj file name */
     core::param::ParamSlot m_filename_slot;
 };
 
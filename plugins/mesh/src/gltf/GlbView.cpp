@@ -0,0 +1,385 @@
+#include "stdafx.h"
+
+#include "GlbView.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#include <json.hpp>
+
+#include "mmcore/utility/TaskScheduler.h"
+
+namespace megamol {
+namespace mesh {
+
+namespace {
+
+constexpr uint32_t glb_magic = 0x46546C67;      // "glTF"
+constexpr uint32_t glb_chunk_json = 0x4E4F534A; // "JSON"
+constexpr uint32_t glb_chunk_bin = 0x004E4942;  // "BIN\0"
+
+constexpr unsigned int gl_float = 0x1406;
+
+unsigned int componentCount(std::string const& type) {
+    if (type == "SCALAR")
+        return 1;
+    if (type == "VEC2")
+        return 2;
+    if (type == "VEC3")
+        return 3;
+    if (type == "VEC4" || type == "MAT2")
+        return 4;
+    if (type == "MAT3")
+        return 9;
+    if (type == "MAT4")
+        return 16;
+    return 0;
+}
+
+size_t componentSize(unsigned int component_type) {
+    return MeshDataAccessCollection::getByteSize(MeshDataAccessCollection::covertToValueType(component_type));
+}
+
+uint32_t readIndex(uint8_t const* data, unsigned int component_type) {
+    switch (componentSize(component_type)) {
+    case 1:
+        return *data;
+    case 2: {
+        uint16_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    default: {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    }
+}
+
+/** Converts a normalized integer component to float following the glTF specification. */
+float normalizedToFloat(uint8_t const* data, unsigned int component_type) {
+    switch (MeshDataAccessCollection::covertToValueType(component_type)) {
+    case MeshDataAccessCollection::BYTE:
+        return std::max(static_cast<float>(*reinterpret_cast<int8_t const*>(data)) / 127.0f, -1.0f);
+    case MeshDataAccessCollection::UNSIGNED_BYTE:
+        return static_cast<float>(*data) / 255.0f;
+    case MeshDataAccessCollection::SHORT: {
+        int16_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return std::max(static_cast<float>(value) / 32767.0f, -1.0f);
+    }
+    case MeshDataAccessCollection::UNSIGNED_SHORT: {
+        uint16_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return static_cast<float>(value) / 65535.0f;
+    }
+    default: {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return static_cast<float>(static_cast<double>(value) / 4294967295.0);
+    }
+    }
+}
+
+} // namespace
+
+
+bool GlbView::open(std::string const& filename, std::string& error) {
+    m_bin = nullptr;
+    m_bin_size = 0;
+    m_views.clear();
+    m_accessors.clear();
+    m_primitives.clear();
+    m_decoded.clear();
+    m_sequential.clear();
+
+    if (!m_file.open(filename)) {
+        error = "cannot open file";
+        return false;
+    }
+
+    auto const* data = m_file.data();
+    auto const size = m_file.size();
+    auto const read_u32 = [data](size_t offset) {
+        uint32_t value;
+        std::memcpy(&value, data + offset, sizeof(value));
+        return value;
+    };
+
+    if (size < 20 || read_u32(0) != glb_magic || read_u32(4) != 2 || read_u32(8) > size) {
+        error = "no binary glTF 2.0 file";
+        return false;
+    }
+    auto const json_length = read_u32(12);
+    if (read_u32(16) != glb_chunk_json || 20 + static_cast<size_t>(json_length) > size) {
+        error = "missing JSON chunk";
+        return false;
+    }
+    // the binary chunk is optional, chunks are 4 byte aligned
+    auto const bin_header = 20 + ((static_cast<size_t>(json_length) + 3) & ~size_t(3));
+    if (bin_header + 8 <= size && read_u32(bin_header + 4) == glb_chunk_bin) {
+        m_bin = data + bin_header + 8;
+        m_bin_size = std::min<size_t>(read_u32(bin_header), size - bin_header - 8);
+    }
+
+    try {
+        auto const json = nlohmann::json::parse(data + 20, data + 20 + json_length);
+
+        if (json.contains("buffers")) {
+            auto const& buffers = json["buffers"];
+            if (buffers.size() > 1 || (buffers.size() == 1 && buffers[0].contains("uri"))) {
+                error = "external buffers are not supported";
+                return false;
+            }
+        }
+
+        for (auto const& view : json.value("bufferViews", nlohmann::json::array())) {
+            BufferView v;
+            v.offset = view.value("byteOffset", size_t(0));
+            v.length = view.at("byteLength").get<size_t>();
+            v.stride = view.value("byteStride", size_t(0));
+            if (view.value("buffer", 0) != 0 || v.offset + v.length > m_bin_size) {
+                error = "buffer view out of range";
+                return false;
+            }
+            m_views.push_back(v);
+        }
+
+        auto const view_range_valid = [this](int view, size_t offset, size_t count, size_t element, size_t stride) {
+            if (view < 0 || static_cast<size_t>(view) >= m_views.size())
+                return false;
+            return count == 0 || offset + (count - 1) * stride + element <= m_views[view].length;
+        };
+
+        for (auto const& accessor : json.value("accessors", nlohmann::json::array())) {
+            Accessor a;
+            a.buffer_view = accessor.value("bufferView", -1);
+            a.byte_offset = accessor.value("byteOffset", size_t(0));
+            a.component_type = accessor.at("componentType").get<unsigned int>();
+            a.components = componentCount(accessor.at("type").get<std::string>());
+            a.count = accessor.at("count").get<size_t>();
+            a.normalized = accessor.value("normalized", false);
+            if (a.components == 0 || componentSize(a.component_type) == 0) {
+                error = "unsupported accessor type";
+                return false;
+            }
+
+            if (accessor.contains("min") && accessor.contains("max") && accessor["min"].size() >= 3 &&
+                accessor["max"].size() >= 3) {
+                a.has_bounds = true;
+                for (int i = 0; i < 3; ++i) {
+                    a.bounds[i] = accessor["min"][i].get<float>();
+                    a.bounds[i + 3] = accessor["max"][i].get<float>();
+                }
+            }
+
+            auto const element = elementSize(a);
+            if (a.buffer_view >= 0) {
+                auto const stride = m_views.size() > static_cast<size_t>(a.buffer_view) &&
+                                            m_views[a.buffer_view].stride != 0
+                                        ? m_views[a.buffer_view].stride
+                                        : element;
+                if (!view_range_valid(a.buffer_view, a.byte_offset, a.count, element, stride)) {
+                    error = "accessor out of range";
+                    return false;
+                }
+            }
+
+            if (accessor.contains("sparse")) {
+                auto const& sparse = accessor["sparse"];
+                a.sparse_count = sparse.at("count").get<size_t>();
+                auto const& indices = sparse.at("indices");
+                a.sparse_indices_view = indices.at("bufferView").get<int>();
+                a.sparse_indices_offset = indices.value("byteOffset", size_t(0));
+                a.sparse_indices_type = indices.at("componentType").get<unsigned int>();
+                auto const& values = sparse.at("values");
+                a.sparse_values_view = values.at("bufferView").get<int>();
+                a.sparse_values_offset = values.value("byteOffset", size_t(0));
+
+                auto const index_size = componentSize(a.sparse_indices_type);
+                if (!view_range_valid(
+                        a.sparse_indices_view, a.sparse_indices_offset, a.sparse_count, index_size, index_size) ||
+                    !view_range_valid(a.sparse_values_view, a.sparse_values_offset, a.sparse_count, element, element)) {
+                    error = "sparse accessor out of range";
+                    return false;
+                }
+            }
+
+            m_accessors.push_back(a);
+        }
+
+        auto const valid_accessor = [this](int accessor) {
+            return accessor >= 0 && static_cast<size_t>(accessor) < m_accessors.size();
+        };
+        for (auto const& mesh : json.value("meshes", nlohmann::json::array())) {
+            auto const name = mesh.value("name", std::string());
+            auto const& primitives = mesh.at("primitives");
+            for (size_t primitive_idx = 0; primitive_idx < primitives.size(); ++primitive_idx) {
+                auto const& primitive = primitives[primitive_idx];
+                Primitive p;
+                p.mesh_name = name;
+                p.primitive_idx = primitive_idx;
+                p.indices = primitive.value("indices", -1);
+                p.mode = primitive.value("mode", 4);
+                for (auto const& attribute : primitive.at("attributes").items()) {
+                    p.attributes.emplace_back(attribute.key(), attribute.value().get<int>());
+                }
+                auto const position = std::find_if(p.attributes.begin(), p.attributes.end(),
+                    [](auto const& attribute) { return attribute.first == "POSITION"; });
+                if (position == p.attributes.end() ||
+                    std::any_of(p.attributes.begin(), p.attributes.end(),
+                        [&](auto const& attribute) { return !valid_accessor(attribute.second); }) ||
+                    (p.indices >= 0 && !valid_accessor(p.indices))) {
+                    error = "invalid primitive in mesh " + name;
+                    return false;
+                }
+                m_primitives.push_back(std::move(p));
+            }
+        }
+    } catch (nlohmann::json::exception const& ex) {
+        error = ex.what();
+        return false;
+    }
+
+    m_decoded.resize(m_accessors.size());
+    m_sequential.resize(m_primitives.size());
+
+    return true;
+}
+
+
+size_t GlbView::elementSize(Accessor const& accessor) const {
+    return componentSize(accessor.component_type) * accessor.components;
+}
+
+
+std::vector<uint8_t> const& GlbView::decoded(int accessor) {
+    auto& slot = m_decoded[accessor];
+    if (slot != nullptr) {
+        return *slot;
+    }
+
+    auto const& a = m_accessors[accessor];
+    auto const element = elementSize(a);
+    auto const* bin = reinterpret_cast<uint8_t const*>(m_bin);
+
+    // accessors without buffer view are initialized with zeros
+    std::vector<uint8_t> packed(a.count * element, 0);
+    if (a.buffer_view >= 0) {
+        auto const& view = m_views[a.buffer_view];
+        auto const stride = view.stride != 0 ? view.stride : element;
+        auto const* source = bin + view.offset + a.byte_offset;
+        core::utility::ParallelFor<size_t>(0, a.count, 0, [&](size_t begin, size_t end) {
+            for (auto i = begin; i < end; ++i) {
+                std::memcpy(&packed[i * element], source + i * stride, element);
+            }
+        });
+    }
+
+    if (a.sparse_count > 0) {
+        auto const* indices = bin + m_views[a.sparse_indices_view].offset + a.sparse_indices_offset;
+        auto const* values = bin + m_views[a.sparse_values_view].offset + a.sparse_values_offset;
+        auto const index_size = componentSize(a.sparse_indices_type);
+        for (size_t i = 0; i < a.sparse_count; ++i) {
+            auto const target = readIndex(indices + i * index_size, a.sparse_indices_type);
+            if (target < a.count) {
+                std::memcpy(&packed[target * element], values + i * element, element);
+            }
+        }
+    }
+
+    if (a.normalized && a.component_type != gl_float) {
+        auto const component_size = componentSize(a.component_type);
+        auto const value_count = a.count * a.components;
+        auto converted = std::make_unique<std::vector<uint8_t>>(value_count * sizeof(float));
+        auto* target = reinterpret_cast<float*>(converted->data());
+        core::utility::ParallelFor<size_t>(0, value_count, 0, [&](size_t begin, size_t end) {
+            for (auto i = begin; i < end; ++i) {
+                target[i] = normalizedToFloat(&packed[i * component_size], a.component_type);
+            }
+        });
+        slot = std::move(converted);
+    } else {
+        slot = std::make_unique<std::vector<uint8_t>>(std::move(packed));
+    }
+
+    return *slot;
+}
+
+
+MeshDataAccessCollection::VertexAttribute GlbView::attribute(
+    int accessor, MeshDataAccessCollection::AttributeSemanticType semantic) {
+    auto const& a = m_accessors[accessor];
+
+    bool const as_stored =
+        a.buffer_view >= 0 && a.sparse_count == 0 && !(a.normalized && a.component_type != gl_float);
+    if (as_stored) {
+        auto const& view = m_views[a.buffer_view];
+        auto const stride = view.stride != 0 ? view.stride : elementSize(a);
+        auto* view_data = reinterpret_cast<uint8_t*>(const_cast<char*>(m_bin)) + view.offset;
+
+        // same layout as for models loaded by tinygltf: packed views share the data pointer and use the accessor
+        // offset, strided views get the offset applied to the data pointer
+        if (view.stride == 0) {
+            return {view_data, a.count * stride, a.components,
+                MeshDataAccessCollection::covertToValueType(a.component_type), stride, a.byte_offset, semantic};
+        }
+        return {view_data + a.byte_offset, a.count * stride, a.components,
+            MeshDataAccessCollection::covertToValueType(a.component_type), stride, 0, semantic};
+    }
+
+    auto const& data = decoded(accessor);
+    auto const type = a.normalized ? MeshDataAccessCollection::FLOAT
+                                   : MeshDataAccessCollection::covertToValueType(a.component_type);
+    auto const stride = MeshDataAccessCollection::getByteSize(type) * a.components;
+    return {const_cast<uint8_t*>(data.data()), data.size(), a.components, type, stride, 0, semantic};
+}
+
+
+MeshDataAccessCollection::IndexData GlbView::indices(size_t primitive) {
+    auto const& p = m_primitives[primitive];
+
+    if (p.indices < 0) {
+        auto& sequential = m_sequential[primitive];
+        if (sequential == nullptr) {
+            auto const position = std::find_if(p.attributes.begin(), p.attributes.end(),
+                [](auto const& attribute) { return attribute.first == "POSITION"; });
+            sequential = std::make_unique<std::vector<uint32_t>>(m_accessors[position->second].count);
+            std::iota(sequential->begin(), sequential->end(), 0);
+        }
+        return {reinterpret_cast<uint8_t*>(sequential->data()), sequential->size() * sizeof(uint32_t),
+            MeshDataAccessCollection::UNSIGNED_INT};
+    }
+
+    auto const& a = m_accessors[p.indices];
+    auto const type = MeshDataAccessCollection::covertToValueType(a.component_type);
+    if (a.buffer_view >= 0 && a.sparse_count == 0) {
+        auto* data = reinterpret_cast<uint8_t*>(const_cast<char*>(m_bin)) + m_views[a.buffer_view].offset +
+                     a.byte_offset;
+        return {data, a.count * elementSize(a), type};
+    }
+
+    auto const& data = decoded(p.indices);
+    return {const_cast<uint8_t*>(data.data()), data.size(), type};
+}
+
+
+bool GlbView::bounds(size_t primitive, std::array<float, 6>& bbox) const {
+    for (auto const& attribute : m_primitives[primitive].attributes) {
+        if (attribute.first == "POSITION" && m_accessors[attribute.second].has_bounds) {
+            bbox = m_accessors[attribute.second].bounds;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+size_t GlbView::decodedCount() const {
+    return std::count_if(m_decoded.begin(), m_decoded.end(), [](auto const& slot) { return slot != nullptr; });
+}
+
+} // namespace mesh
+} // namespace megamol
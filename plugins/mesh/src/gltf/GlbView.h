@@ -0,0 +1,122 @@
+/*
+ * GlbView.h
+ *
+ * Copyright (C) 2022 by Universitaet Stuttgart (VISUS).
+ * All rights reserved.
+ */
+
+#ifndef GLB_VIEW_H_INCLUDED
+#define GLB_VIEW_H_INCLUDED
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mesh/MeshDataAccessCollection.h"
+#include "mesh/MeshIngest.h"
+
+namespace megamol {
+namespace mesh {
+
+/**
+ * Read-only view of a binary glTF (.glb) file. The file is memory mapped and accessors are exposed as non-owning
+ * views into the binary chunk. Only accessors that cannot be used as stored, i.e. sparse or normalized integer
+ * accessors, are decoded into owned buffers. This happens in attribute() and indices(), so for a loader that adds all
+ * primitives to a mesh collection these accessors are decoded when the file is loaded.
+ *
+ * The views point into a read-only mapping, so the attribute and index data must not be written.
+ */
+class GlbView {
+public:
+    struct Primitive {
+        std::string mesh_name;
+        size_t primitive_idx;
+        std::vector<std::pair<std::string, int>> attributes;
+        int indices = -1;
+        int mode = 4;
+    };
+
+    /**
+     * Maps and indexes a .glb file.
+     *
+     * @param filename The file.
+     * @param error    Description of the problem if the file cannot be viewed.
+     *
+     * @return 'true' on success, 'false' if the file is no valid self-contained .glb file.
+     */
+    bool open(std::string const& filename, std::string& error);
+
+    std::vector<Primitive> const& primitives() const {
+        return m_primitives;
+    }
+
+    /**
+     * Answer a vertex attribute for an accessor. Sparse and normalized integer accessors are decoded by the first call
+     * and kept for later calls.
+     */
+    MeshDataAccessCollection::VertexAttribute attribute(
+        int accessor, MeshDataAccessCollection::AttributeSemanticType semantic);
+
+    /**
+     * Answer the index data of a primitive. Sequential indices are generated for non-indexed primitives.
+     */
+    MeshDataAccessCollection::IndexData indices(size_t primitive);
+
+    /**
+     * Answer the min and max of the POSITION accessor of a primitive, if the file provides them.
+     */
+    bool bounds(size_t primitive, std::array<float, 6>& bbox) const;
+
+    /** Answer the number of accessors decoded so far. */
+    size_t decodedCount() const;
+
+private:
+    struct BufferView {
+        size_t offset = 0;
+        size_t length = 0;
+        size_t stride = 0;
+    };
+
+    struct Accessor {
+        int buffer_view = -1;
+        size_t byte_offset = 0;
+        unsigned int component_type = 0;
+        unsigned int components = 1;
+        size_t count = 0;
+        bool normalized = false;
+        bool has_bounds = false;
+        std::array<float, 6> bounds;
+
+        size_t sparse_count = 0;
+        int sparse_indices_view = -1;
+        size_t sparse_indices_offset = 0;
+        unsigned int sparse_indices_type = 0;
+        int sparse_values_view = -1;
+        size_t sparse_values_offset = 0;
+    };
+
+    size_t elementSize(Accessor const& accessor) const;
+
+    std::vector<uint8_t> const& decoded(int accessor);
+
+    ingest::MappedFile m_file;
+
+    char const* m_bin = nullptr;
+    size_t m_bin_size = 0;
+
+    std::vector<BufferView> m_views;
+    std::vector<Accessor> m_accessors;
+    std::vector<Primitive> m_primitives;
+
+    /** Decoded accessors, null for accessors used as stored and for those not requested yet */
+    std::vector<std::unique_ptr<std::vector<uint8_t>>> m_decoded;
+
+    /** Generated indices of non-indexed primitives */
+    std::vector<std::unique_ptr<std::vector<uint32_t>>> m_sequential;
+};
+
+} // namespace mesh
+} // namespace megamol
+
+#endif // !GLB_VIEW_H_INCLUDED
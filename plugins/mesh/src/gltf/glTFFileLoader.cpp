@@ -19,6 +19,7 @@
 megamol::mesh::GlTFFileLoader::GlTFFileLoader()
         : AbstractMeshDataSource()
         , m_version(0)
+        , m_meshes_dirty(false)
         , m_glTFFilename_slot("glTF filename", "The name of the gltf file to load")
         , m_gltf_slot("gltfModels", "The slot publishing the loaded data") {
     this->m_gltf_slot.SetCallback(CallGlTFData::ClassName(), "GetData", &GlTFFileLoader::getGltfDataCallback);
@@ -27,7 +28,7 @@ megamol::mesh::GlTFFileLoader::GlTFFileLoader()
     this->MakeSlotAvailable(&this->m_gltf_slot);
 
     this->m_glTFFilename_slot << new core::param::FilePathParam(
-        "", core::param::FilePathParam::Flag_File_RestrictExtension, {"gltf"});
+        "", core::param::FilePathParam::Flag_File_RestrictExtension, {"gltf", "glb"});
     this->MakeSlotAvailable(&this->m_glTFFilename_slot);
 }
 
@@ -45,6 +46,11 @@ bool megamol::mesh::GlTFFileLoader::getGltfDataCallback(core::Call& caller) {
         ++m_version;
     }
 
+    // the mapped .glb file suffices for meshes, the complete model is only loaded when it is requested
+    if (m_glb != nullptr && m_gltf_model == nullptr) {
+        loadGltfModel(m_glTFFilename_slot.Param<core::param::FilePathParam>()->Value().generic_u8string(), true);
+    }
+
     if (gltf_call->version() < m_version) {
         gltf_call->setData(
             {m_glTFFilename_slot.Param<core::param::FilePathParam>()->Value().generic_u8string(), m_gltf_model},
@@ -86,142 +92,197 @@ bool megamol::mesh::GlTFFileLoader::getMeshDataCallback(core::Call& caller) {
     }
 
     if (lhs_mesh_call->version() < m_version) {
-        for (auto const& identifier : m_mesh_access_collection.second) {
-            m_mesh_access_collection.first->deleteMesh(identifier);
+        // meshes are only added again if the file changed, not for updates of chained sources
+        if (m_meshes_dirty) {
+            clearMeshAccessCollection();
+
+            auto const filename = m_glTFFilename_slot.Param<core::param::FilePathParam>()->Value().generic_u8string();
+            if (m_glb != nullptr) {
+                m_bbox = addGlbMeshes(filename);
+            } else if (m_gltf_model != nullptr) {
+                m_bbox = addGltfModelMeshes(filename);
+            } else {
+                return false;
+            }
+            m_meshes_dirty = false;
         }
-        m_mesh_access_collection.second.clear();
 
         // set data and version to signal update
         lhs_mesh_call->setData(m_mesh_access_collection.first, m_version);
 
         // compute mesh call specific update
-        std::array<float, 6> bbox;
+        auto meta_data = lhs_mesh_call->getMetaData();
+        meta_data.m_bboxs.SetBoundingBox(m_bbox[0], m_bbox[1], m_bbox[2], m_bbox[3], m_bbox[4], m_bbox[5]);
+        meta_data.m_bboxs.SetClipBox(m_bbox[0], m_bbox[1], m_bbox[2], m_bbox[3], m_bbox[4], m_bbox[5]);
+        lhs_mesh_call->setMetaData(meta_data);
+    }
 
-        bbox[0] = std::numeric_limits<float>::max();
-        bbox[1] = std::numeric_limits<float>::max();
-        bbox[2] = std::numeric_limits<float>::max();
-        bbox[3] = std::numeric_limits<float>::lowest();
-        bbox[4] = std::numeric_limits<float>::lowest();
-        bbox[5] = std::numeric_limits<float>::lowest();
+    return true;
+}
 
-        auto model = m_gltf_model;
+namespace {
 
-        if (model == nullptr)
-            return false;
+std::array<float, 6> emptyBoundingBox() {
+    return {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+        std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+        std::numeric_limits<float>::lowest()};
+}
+
+void finishBoundingBox(std::array<float, 6>& bbox) {
+    if (bbox[0] > bbox[3] || bbox[1] > bbox[4] || bbox[2] > bbox[5]) {
+        bbox = {-0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f};
+    }
+}
+
+megamol::mesh::MeshDataAccessCollection::AttributeSemanticType attributeSemantic(std::string const& name) {
+    using megamol::mesh::MeshDataAccessCollection;
+
+    if (name == "POSITION") {
+        return MeshDataAccessCollection::AttributeSemanticType::POSITION;
+    } else if (name == "NORMAL") {
+        return MeshDataAccessCollection::AttributeSemanticType::NORMAL;
+    } else if (name == "TANGENT") {
+        return MeshDataAccessCollection::AttributeSemanticType::TANGENT;
+    } else if (name == "TEXCOORD_0") {
+        return MeshDataAccessCollection::AttributeSemanticType::TEXCOORD;
+    } else if (name == "COLOR_0") {
+        return MeshDataAccessCollection::AttributeSemanticType::COLOR;
+    }
+    return MeshDataAccessCollection::AttributeSemanticType::UNKNOWN;
+}
 
-        for (size_t mesh_idx = 0; mesh_idx < model->meshes.size(); mesh_idx++) {
-
-            auto primitive_cnt = model->meshes[mesh_idx].primitives.size();
-
-            for (size_t primitive_idx = 0; primitive_idx < primitive_cnt; ++primitive_idx) {
-
-                std::vector<MeshDataAccessCollection::VertexAttribute> mesh_attributes;
-                MeshDataAccessCollection::IndexData mesh_indices;
-
-                auto& indices_accessor = model->accessors[model->meshes[mesh_idx].primitives[primitive_idx].indices];
-                auto& indices_bufferView = model->bufferViews[indices_accessor.bufferView];
-                auto& indices_buffer = model->buffers[indices_bufferView.buffer];
-
-                mesh_indices.byte_size = (indices_accessor.count * indices_accessor.ByteStride(indices_bufferView));
-                mesh_indices.data = reinterpret_cast<uint8_t*>(
-                    indices_buffer.data.data() + indices_bufferView.byteOffset + indices_accessor.byteOffset);
-                mesh_indices.type = MeshDataAccessCollection::covertToValueType(indices_accessor.componentType);
-
-                auto& vertex_attributes = model->meshes[mesh_idx].primitives[primitive_idx].attributes;
-                for (auto attrib : vertex_attributes) {
-                    auto& vertexAttrib_accessor = model->accessors[attrib.second];
-                    auto& vertexAttrib_bufferView = model->bufferViews[vertexAttrib_accessor.bufferView];
-                    auto& vertexAttrib_buffer = model->buffers[vertexAttrib_bufferView.buffer];
-
-                    MeshDataAccessCollection::AttributeSemanticType attrib_semantic;
-
-                    if (attrib.first == "POSITION") {
-                        attrib_semantic = MeshDataAccessCollection::AttributeSemanticType::POSITION;
-                    } else if (attrib.first == "NORMAL") {
-                        attrib_semantic = MeshDataAccessCollection::AttributeSemanticType::NORMAL;
-                    } else if (attrib.first == "TANGENT") {
-                        attrib_semantic = MeshDataAccessCollection::AttributeSemanticType::TANGENT;
-                    } else if (attrib.first == "TEXCOORD_0") {
-                        attrib_semantic = MeshDataAccessCollection::AttributeSemanticType::TEXCOORD;
-                    } else if (attrib.first == "COLOR_0") {
-                        attrib_semantic = MeshDataAccessCollection::AttributeSemanticType::COLOR;
-                    } else {
-                        attrib_semantic = MeshDataAccessCollection::AttributeSemanticType::UNKNOWN;
-                    }
-
-
-                    uint8_t* data_ptr = nullptr;
-                    size_t attrib_byte_stride = vertexAttrib_accessor.ByteStride(vertexAttrib_bufferView);
-                    size_t attrib_byte_offset = 0;
-                    // check bufferView stride for 0 to detect interleaved data
-                    if (vertexAttrib_bufferView.byteStride == 0) {
-                        // if interleaved, do not apply accessor byte offset to data pointer
-                        data_ptr = reinterpret_cast<uint8_t*>(
-                            vertexAttrib_buffer.data.data() + vertexAttrib_bufferView.byteOffset);
-                        // and instead use attribute offset
-                        attrib_byte_offset = vertexAttrib_accessor.byteOffset;
-                    } else {
-                        // if non-interleaved, apply accessor byte offset to data pointer
-                        data_ptr = reinterpret_cast<uint8_t*>(vertexAttrib_buffer.data.data() +
-                                                              vertexAttrib_bufferView.byteOffset +
-                                                              vertexAttrib_accessor.byteOffset);
-                        // and do not set any attribute offset because offset > 0 with non-interleaved
-                        // attributes suggests a (VVVNNNCCC) layout which we will use as a
-                        // (VVV)(NNN)(CCC) layout instead
-                    }
-
-                    mesh_attributes.emplace_back(MeshDataAccessCollection::VertexAttribute{data_ptr,
-                        (vertexAttrib_accessor.count * attrib_byte_stride),
-                        static_cast<unsigned int>(vertexAttrib_accessor.type),
-                        MeshDataAccessCollection::covertToValueType(vertexAttrib_accessor.componentType),
-                        attrib_byte_stride, attrib_byte_offset, attrib_semantic});
+megamol::mesh::MeshDataAccessCollection::PrimitiveType primitiveType(int mode) {
+    using megamol::mesh::MeshDataAccessCollection;
+
+    switch (mode) {
+    case 1:
+        return MeshDataAccessCollection::LINES;
+    case 3:
+        return MeshDataAccessCollection::LINE_STRIP;
+    case 6:
+        return MeshDataAccessCollection::TRIANGLE_FAN;
+    default:
+        return MeshDataAccessCollection::TRIANGLES;
+    }
+}
+
+} // namespace
+
+std::array<float, 6> megamol::mesh::GlTFFileLoader::addGltfModelMeshes(std::string const& filename) {
+    auto bbox = emptyBoundingBox();
+    auto model = m_gltf_model;
+
+    for (size_t mesh_idx = 0; mesh_idx < model->meshes.size(); mesh_idx++) {
+
+        auto primitive_cnt = model->meshes[mesh_idx].primitives.size();
+
+        for (size_t primitive_idx = 0; primitive_idx < primitive_cnt; ++primitive_idx) {
+
+            std::vector<MeshDataAccessCollection::VertexAttribute> mesh_attributes;
+            MeshDataAccessCollection::IndexData mesh_indices;
+
+            auto& indices_accessor = model->accessors[model->meshes[mesh_idx].primitives[primitive_idx].indices];
+            auto& indices_bufferView = model->bufferViews[indices_accessor.bufferView];
+            auto& indices_buffer = model->buffers[indices_bufferView.buffer];
+
+            mesh_indices.byte_size = (indices_accessor.count * indices_accessor.ByteStride(indices_bufferView));
+            mesh_indices.data = reinterpret_cast<uint8_t*>(
+                indices_buffer.data.data() + indices_bufferView.byteOffset + indices_accessor.byteOffset);
+            mesh_indices.type = MeshDataAccessCollection::covertToValueType(indices_accessor.componentType);
+
+            auto& vertex_attributes = model->meshes[mesh_idx].primitives[primitive_idx].attributes;
+            for (auto attrib : vertex_attributes) {
+                auto& vertexAttrib_accessor = model->accessors[attrib.second];
+                auto& vertexAttrib_bufferView = model->bufferViews[vertexAttrib_accessor.bufferView];
+                auto& vertexAttrib_buffer = model->buffers[vertexAttrib_bufferView.buffer];
+
+                auto attrib_semantic = attributeSemantic(attrib.first);
+
+                uint8_t* data_ptr = nullptr;
+                size_t attrib_byte_stride = vertexAttrib_accessor.ByteStride(vertexAttrib_bufferView);
+                size_t attrib_byte_offset = 0;
+                // check bufferView stride for 0 to detect interleaved data
+                if (vertexAttrib_bufferView.byteStride == 0) {
+                    // if interleaved, do not apply accessor byte offset to data pointer
+                    data_ptr = reinterpret_cast<uint8_t*>(
+                        vertexAttrib_buffer.data.data() + vertexAttrib_bufferView.byteOffset);
+                    // and instead use attribute offset
+                    attrib_byte_offset = vertexAttrib_accessor.byteOffset;
+                } else {
+                    // if non-interleaved, apply accessor byte offset to data pointer
+                    data_ptr = reinterpret_cast<uint8_t*>(vertexAttrib_buffer.data.data() +
+                                                          vertexAttrib_bufferView.byteOffset +
+                                                          vertexAttrib_accessor.byteOffset);
+                    // and do not set any attribute offset because offset > 0 with non-interleaved
+                    // attributes suggests a (VVVNNNCCC) layout which we will use as a
+                    // (VVV)(NNN)(CCC) layout instead
                 }
 
-                std::string identifier =
-                    m_glTFFilename_slot.Param<core::param::FilePathParam>()->Value().generic_u8string() +
-                    model->meshes[mesh_idx].name + "_" + std::to_string(primitive_idx);
-                m_mesh_access_collection.first->addMesh(identifier, mesh_attributes, mesh_indices);
-                m_mesh_access_collection.second.push_back(identifier);
-
-                auto max_data =
-                    model
-                        ->accessors
-                            [model->meshes[mesh_idx].primitives[primitive_idx].attributes.find("POSITION")->second]
-                        .maxValues;
-                auto min_data =
-                    model
-                        ->accessors
-                            [model->meshes[mesh_idx].primitives[primitive_idx].attributes.find("POSITION")->second]
-                        .minValues;
-
-                bbox[0] = std::min(bbox[0], static_cast<float>(min_data[0]));
-                bbox[1] = std::min(bbox[1], static_cast<float>(min_data[1]));
-                bbox[2] = std::min(bbox[2], static_cast<float>(min_data[2]));
-                bbox[3] = std::max(bbox[3], static_cast<float>(max_data[0]));
-                bbox[4] = std::max(bbox[4], static_cast<float>(max_data[1]));
-                bbox[5] = std::max(bbox[5], static_cast<float>(max_data[2]));
+                mesh_attributes.emplace_back(MeshDataAccessCollection::VertexAttribute{data_ptr,
+                    (vertexAttrib_accessor.count * attrib_byte_stride),
+                    static_cast<unsigned int>(vertexAttrib_accessor.type),
+                    MeshDataAccessCollection::covertToValueType(vertexAttrib_accessor.componentType),
+                    attrib_byte_stride, attrib_byte_offset, attrib_semantic});
             }
+
+            std::string identifier = filename + model->meshes[mesh_idx].name + "_" + std::to_string(primitive_idx);
+            m_mesh_access_collection.first->addMesh(identifier, mesh_attributes, mesh_indices);
+            m_mesh_access_collection.second.push_back(identifier);
+
+            auto max_data =
+                model->accessors[model->meshes[mesh_idx].primitives[primitive_idx].attributes.find("POSITION")->second]
+                    .maxValues;
+            auto min_data =
+                model->accessors[model->meshes[mesh_idx].primitives[primitive_idx].attributes.find("POSITION")->second]
+                    .minValues;
+
+            bbox[0] = std::min(bbox[0], static_cast<float>(min_data[0]));
+            bbox[1] = std::min(bbox[1], static_cast<float>(min_data[1]));
+            bbox[2] = std::min(bbox[2], static_cast<float>(min_data[2]));
+            bbox[3] = std::max(bbox[3], static_cast<float>(max_data[0]));
+            bbox[4] = std::max(bbox[4], static_cast<float>(max_data[1]));
+            bbox[5] = std::max(bbox[5], static_cast<float>(max_data[2]));
         }
+    }
+
+    finishBoundingBox(bbox);
+    return bbox;
+}
+
+std::array<float, 6> megamol::mesh::GlTFFileLoader::addGlbMeshes(std::string const& filename) {
+    auto bbox = emptyBoundingBox();
+    auto const& primitives = m_glb->primitives();
 
-        if (bbox[0] == std::numeric_limits<float>::max() || bbox[1] == std::numeric_limits<float>::max() ||
-            bbox[2] == std::numeric_limits<float>::max() || bbox[3] == std::numeric_limits<float>::min() ||
-            bbox[4] == std::numeric_limits<float>::min() || bbox[5] == std::numeric_limits<float>::min()) {
+    m_mesh_access_collection.second.reserve(primitives.size());
+    for (size_t p = 0; p < primitives.size(); ++p) {
+        auto const& primitive = primitives[p];
 
-            bbox[0] = -0.5;
-            bbox[1] = -0.5;
-            bbox[2] = -0.5;
-            bbox[3] = 0.5;
-            bbox[4] = 0.5;
-            bbox[5] = 0.5;
+        std::vector<MeshDataAccessCollection::VertexAttribute> mesh_attributes;
+        mesh_attributes.reserve(primitive.attributes.size());
+        for (auto const& attrib : primitive.attributes) {
+            mesh_attributes.push_back(m_glb->attribute(attrib.second, attributeSemantic(attrib.first)));
         }
 
-        auto meta_data = lhs_mesh_call->getMetaData();
-        meta_data.m_bboxs.SetBoundingBox(bbox[0], bbox[1], bbox[2], bbox[3], bbox[4], bbox[5]);
-        meta_data.m_bboxs.SetClipBox(bbox[0], bbox[1], bbox[2], bbox[3], bbox[4], bbox[5]);
-        lhs_mesh_call->setMetaData(meta_data);
+        std::string identifier = filename + primitive.mesh_name + "_" + std::to_string(primitive.primitive_idx);
+        m_mesh_access_collection.first->addMesh(
+            identifier, std::move(mesh_attributes), m_glb->indices(p), primitiveType(primitive.mode));
+        m_mesh_access_collection.second.push_back(std::move(identifier));
+
+        std::array<float, 6> primitive_bbox;
+        if (m_glb->bounds(p, primitive_bbox)) {
+            for (int i = 0; i < 3; ++i) {
+                bbox[i] = std::min(bbox[i], primitive_bbox[i]);
+                bbox[i + 3] = std::max(bbox[i + 3], primitive_bbox[i + 3]);
+            }
+        }
     }
 
-    return true;
+    megamol::core::utility::log::Log::DefaultLog.WriteInfo("[GlTFFileLoader]: Mapped %zu primitives, decoded %zu "
+                                                           "accessors",
+        primitives.size(), m_glb->decodedCount());
+
+    finishBoundingBox(bbox);
+    return bbox;
 }
 
 bool megamol::mesh::GlTFFileLoader::getMeshMetaDataCallback(core::Call& caller) {
@@ -238,29 +299,51 @@ bool megamol::mesh::GlTFFileLoader::checkAndLoadGltfModel() {
         m_glTFFilename_slot.ResetDirty();
 
         auto filename = m_glTFFilename_slot.Param<core::param::FilePathParam>()->Value().generic_u8string();
-        m_gltf_model = std::make_shared<tinygltf::Model>();
-
-        if (filename != "") {
-            tinygltf::TinyGLTF loader;
-            std::string err;
-            std::string war;
+        bool const binary = m_glTFFilename_slot.Param<core::param::FilePathParam>()->Value().extension() == ".glb";
 
-            bool ret = loader.LoadASCIIFromFile(&*m_gltf_model, &err, &war, filename);
-            if (!err.empty()) {
-                megamol::core::utility::log::Log::DefaultLog.WriteError("Err: %s\n", err.c_str());
-            }
+        m_gltf_model = nullptr;
+        m_glb = nullptr;
+        m_meshes_dirty = true;
 
-            if (!ret) {
-                megamol::core::utility::log::Log::DefaultLog.WriteError("Failed to parse glTF\n");
+        if (binary) {
+            auto glb = std::make_shared<GlbView>();
+            std::string err;
+            if (glb->open(filename, err)) {
+                m_glb = glb;
+                return true;
             }
+            megamol::core::utility::log::Log::DefaultLog.WriteWarn(
+                "[GlTFFileLoader]: Cannot map %s (%s), loading it completely", filename.c_str(), err.c_str());
         }
 
+        loadGltfModel(filename, binary);
+
         return true;
     }
 
     return false;
 }
 
+void megamol::mesh::GlTFFileLoader::loadGltfModel(std::string const& filename, bool binary) {
+    m_gltf_model = std::make_shared<tinygltf::Model>();
+
+    if (filename != "") {
+        tinygltf::TinyGLTF loader;
+        std::string err;
+        std::string war;
+
+        bool ret = binary ? loader.LoadBinaryFromFile(&*m_gltf_model, &err, &war, filename)
+                          : loader.LoadASCIIFromFile(&*m_gltf_model, &err, &war, filename);
+        if (!err.empty()) {
+            megamol::core::utility::log::Log::DefaultLog.WriteError("Err: %s\n", err.c_str());
+        }
+
+        if (!ret) {
+            megamol::core::utility::log::Log::DefaultLog.WriteError("Failed to parse glTF\n");
+        }
+    }
+}
+
 void megamol::mesh::GlTFFileLoader::release() {
     // intentionally empty ?
 }
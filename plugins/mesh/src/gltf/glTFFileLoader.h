@@ -15,6 +15,8 @@
 #include "mesh/MeshCalls.h"
 #include "mesh/MeshDataAccessCollection.h"
 
+#include "GlbView.h"
+
 namespace megamol {
 namespace mesh {
 
@@ -75,11 +77,39 @@ protected:
 
     bool checkAndLoadGltfModel();
 
+    /**
+     * Loads the complete model with tinygltf.
+     */
+    void loadGltfModel(std::string const& filename, bool binary);
+
+    /**
+     * Adds the primitives of the model to the mesh access collection.
+     *
+     * @return The bounding box over all primitives.
+     */
+    std::array<float, 6> addGltfModelMeshes(std::string const& filename);
+
+    /**
+     * Adds the primitives of the mapped .glb file to the mesh access collection. Accessors that cannot be used as
+     * stored are decoded here, all others point into the mapping.
+     *
+     * @return The bounding box over all primitives.
+     */
+    std::array<float, 6> addGlbMeshes(std::string const& filename);
+
 private:
     std::shared_ptr<tinygltf::Model> m_gltf_model;
 
+    /** Mapped .glb file, the model is only loaded by tinygltf if the gltf slot requests it */
+    std::shared_ptr<GlbView> m_glb;
+
     uint32_t m_version;
 
+    /** Whether the meshes of the file still have to be added to the mesh access collection */
+    bool m_meshes_dirty;
+
+    std::array<float, 6> m_bbox;
+
     /** The gltf file name */
     core::param::ParamSlot m_glTFFilename_slot;
 
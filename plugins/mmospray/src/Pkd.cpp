@@ -5,23 +5,170 @@
 
 #include "Pkd.h"
 #include "stdafx.h"
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <stdint.h>
-#include <thread>
 
-#define POS(idx, dim) pos(idx, dim)
+#include "mmcore/param/FilePathParam.h"
+#include "mmcore/param/IntParam.h"
+#include "mmcore/utility/TaskScheduler.h"
+#include "mmcore/utility/log/Log.h"
 
 using namespace megamol;
 
+namespace {
+
+/**
+ * Tree files are MMPLD 1.3 files with this bit set in the version field of the header. The lists hold the particles
+ * in PKD order as FLOAT_XYZ + UINT8_RGBA, with the split dimension in the low bits of x.
+ */
+constexpr uint16_t pkdTreeFlag = 0x8000;
+constexpr uint16_t pkdTreeVersion = 103;
+
+/** Ranges above this size are partitioned in parallel, smaller ones with std::nth_element */
+constexpr size_t parallelSelectCutoff = 1 << 20;
+constexpr size_t selectBlockSize = 1 << 16;
+
+/** Subtrees above this size are built as tasks */
+constexpr size_t taskCutoff = 1 << 14;
+
+/**
+ * Reorders [first, last) like std::nth_element on the coordinate dim. Large ranges are partitioned in parallel around
+ * a sampled pivot into scratch, which has to hold last - first elements, until the range containing nth is small.
+ */
+void parallelNthElement(rkcommon::math::vec4f* first, rkcommon::math::vec4f* nth, rkcommon::math::vec4f* last,
+    rkcommon::math::vec4f* scratch, const size_t dim) {
+    while (static_cast<size_t>(last - first) > parallelSelectCutoff) {
+        const size_t n = last - first;
+
+        std::array<float, 63> sample;
+        for (size_t i = 0; i < sample.size(); ++i) {
+            sample[i] = first[i * (n / sample.size())][dim];
+        }
+        std::nth_element(sample.begin(), sample.begin() + sample.size() / 2, sample.end());
+        const float pivot = sample[sample.size() / 2];
+
+        // per block counts of the elements below and equal to the pivot, turned into output offsets
+        const size_t blocks = (n + selectBlockSize - 1) / selectBlockSize;
+        std::vector<size_t> lower(blocks + 1, 0);
+        std::vector<size_t> equal(blocks + 1, 0);
+        core::utility::ParallelFor<size_t>(0, blocks, 1, [&](size_t b0, size_t b1) {
+            for (size_t b = b0; b < b1; ++b) {
+                const auto* end = first + std::min(n, (b + 1) * selectBlockSize);
+                for (const auto* cur = first + b * selectBlockSize; cur < end; ++cur) {
+                    const float v = (*cur)[dim];
+                    lower[b + 1] += v < pivot;
+                    equal[b + 1] += v == pivot;
+                }
+            }
+        });
+        for (size_t b = 0; b < blocks; ++b) {
+            lower[b + 1] += lower[b];
+            equal[b + 1] += equal[b];
+        }
+        const size_t numLower = lower[blocks];
+        const size_t numEqual = equal[blocks];
+        if (numLower + numEqual == 0) {
+            // pivot is NaN, no progress possible
+            break;
+        }
+
+        core::utility::ParallelFor<size_t>(0, blocks, 1, [&](size_t b0, size_t b1) {
+            for (size_t b = b0; b < b1; ++b) {
+                auto* lo = scratch + lower[b];
+                auto* eq = scratch + numLower + equal[b];
+                auto* gr = scratch + numLower + numEqual + (b * selectBlockSize - lower[b] - equal[b]);
+                const auto* end = first + std::min(n, (b + 1) * selectBlockSize);
+                for (const auto* cur = first + b * selectBlockSize; cur < end; ++cur) {
+                    const float v = (*cur)[dim];
+                    if (v < pivot) {
+                        *lo++ = *cur;
+                    } else if (v == pivot) {
+                        *eq++ = *cur;
+                    } else {
+                        *gr++ = *cur;
+                    }
+                }
+            }
+        });
+        core::utility::ParallelFor<size_t>(0, n, selectBlockSize,
+            [&](size_t i0, size_t i1) { std::copy(scratch + i0, scratch + i1, first + i0); });
+
+        const size_t k = nth - first;
+        if (k < numLower) {
+            last = first + numLower;
+        } else if (k < numLower + numEqual) {
+            return;
+        } else {
+            first += numLower + numEqual;
+            scratch += numLower + numEqual;
+        }
+    }
+    std::nth_element(first, nth, last, [dim](rkcommon::math::vec4f const& a, rkcommon::math::vec4f const& b) {
+        return a[dim] < b[dim];
+    });
+}
+
+/** Hash of the particle data, computed in parallel over blocks */
+uint64_t hashParticles(rkcommon::math::vec4f const* data, size_t count) {
+    const auto mix = [](uint64_t h) {
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ull;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebull;
+        h ^= h >> 31;
+        return h;
+    };
+    constexpr size_t blockSize = 1 << 18;
+    const size_t blocks = (count + blockSize - 1) / blockSize;
+    std::vector<uint64_t> hashes(blocks);
+    core::utility::ParallelFor<size_t>(0, blocks, 1, [&](size_t b0, size_t b1) {
+        for (size_t b = b0; b < b1; ++b) {
+            uint64_t h = mix(b + 1);
+            const auto end = std::min(count, (b + 1) * blockSize);
+            for (size_t i = b * blockSize; i < end; ++i) {
+                uint64_t words[2];
+                std::memcpy(words, &data[i], sizeof(words));
+                h = ((h ^ words[0]) << 29 | (h ^ words[0]) >> 35) * 0x9e3779b97f4a7c15ull;
+                h = ((h ^ words[1]) << 29 | (h ^ words[1]) >> 35) * 0x9e3779b97f4a7c15ull;
+            }
+            hashes[b] = mix(h);
+        }
+    });
+    uint64_t h = mix(count);
+    for (const auto blockHash : hashes) {
+        h = mix(h ^ blockHash);
+    }
+    return h;
+}
+
+/** Answers whether the file name is one of a tree file, i.e. a 16 digit hex hash with the extension .mmpld */
+bool isTreeFileName(std::filesystem::path const& path) {
+    const auto stem = path.stem().u8string();
+    return (path.extension() == ".mmpld") && (stem.size() == 16) &&
+           std::all_of(stem.begin(), stem.end(), [](char c) { return std::isxdigit(static_cast<unsigned char>(c)); });
+}
+
+} // namespace
+
 
 ospray::PkdBuilder::PkdBuilder()
         : megamol::datatools::AbstractParticleManipulator("outData", "inData")
+        , treeDirectorySlot("treeDirectory", "Directory for PKD-sorted MMPLD files of built trees, which are loaded "
+                                             "instead of building the trees again. Empty to always build.")
+        , treeCacheSizeSlot("treeCacheSize", "The maximum size of the tree files in treeDirectory in MegaBytes. The "
+                                             "least recently used files are deleted above it, 0 for no limit.")
         , inDataHash(std::numeric_limits<size_t>::max())
-        , outDataHash(0)
-/*, numParticles(0)
-, numInnerNodes(0)*/
-{
-    //model = std::make_shared<ParticleModel>();
+        , outDataHash(0) {
+    this->treeDirectorySlot.SetParameter(
+        new core::param::FilePathParam("", core::param::FilePathParam::Flag_Directory_ToBeCreated));
+    this->MakeSlotAvailable(&this->treeDirectorySlot);
+
+    this->treeCacheSizeSlot.SetParameter(new core::param::IntParam(4096, 0));
+    this->MakeSlotAvailable(&this->treeCacheSizeSlot);
 }
 
 ospray::PkdBuilder::~PkdBuilder() {
@@ -30,6 +177,7 @@ ospray::PkdBuilder::~PkdBuilder() {
 
 bool ospray::PkdBuilder::manipulateData(
     geocalls::MultiParticleDataCall& outData, geocalls::MultiParticleDataCall& inData) {
+    using megamol::core::utility::log::Log;
 
     if ((inData.DataHash() != inDataHash) || (inData.FrameID() != frameID)) {
         inDataHash = inData.DataHash();
@@ -41,21 +189,53 @@ bool ospray::PkdBuilder::manipulateData(
         models.resize(inData.GetParticleListCount());
 
         for (unsigned int i = 0; i < inData.GetParticleListCount(); ++i) {
-            auto& parts = inData.AccessParticles(i);
-            auto& out = outData.AccessParticles(i);
-
-            // empty the model
-            // this->model->position.clear();
+            // empty the model and put the data into it
             models[i].position.clear();
+            models[i].fill(inData.AccessParticles(i));
+        }
 
-            // put data the data into the model
-            // and build the pkd tree
-            // this->model->fill(parts);
-            models[i].fill(parts);
-            // this->build();
-            Pkd pkd;
-            pkd.model = &models[i];
-            pkd.build();
+        // PKD tree files loaded by MMPLDDataSource are trees already, in the layout the builder produces
+        bool sorted = true;
+        for (unsigned int i = 0; i < inData.GetParticleListCount(); ++i) {
+            auto const& parts = inData.AccessParticles(i);
+            sorted = sorted && parts.IsPkdSorted() &&
+                     (parts.GetVertexDataType() == geocalls::SimpleSphericalParticles::VERTDATA_FLOAT_XYZ) &&
+                     (parts.GetColourDataType() == geocalls::SimpleSphericalParticles::COLDATA_UINT8_RGBA);
+        }
+
+        std::filesystem::path treeFile;
+        const auto treeDirectory = this->treeDirectorySlot.Param<core::param::FilePathParam>()->Value();
+        if (!sorted && !treeDirectory.empty()) {
+            char name[32];
+            std::snprintf(name, sizeof(name), "%016llx.mmpld", static_cast<unsigned long long>(this->modelHash()));
+            treeFile = treeDirectory / name;
+        }
+
+        if (sorted) {
+            Log::DefaultLog.WriteInfo("[PkdBuilder] Input is PKD-sorted, the trees are not built again");
+        } else if (!treeFile.empty() && this->readTreeFile(treeFile)) {
+            Log::DefaultLog.WriteInfo("[PkdBuilder] Loaded PKD trees from %s", treeFile.u8string().c_str());
+        } else {
+            for (auto& model : models) {
+                if (model.position.empty())
+                    continue;
+                Pkd pkd;
+                pkd.model = &model;
+                pkd.build();
+            }
+            if (!treeFile.empty()) {
+                if (this->writeTreeFile(treeFile, inData)) {
+                    this->pruneTreeDirectory(treeDirectory, treeFile);
+                } else {
+                    Log::DefaultLog.WriteWarn(
+                        "[PkdBuilder] Unable to write PKD tree file %s", treeFile.u8string().c_str());
+                }
+            }
+        }
+
+        for (unsigned int i = 0; i < inData.GetParticleListCount(); ++i) {
+            auto& parts = inData.AccessParticles(i);
+            auto& out = outData.AccessParticles(i);
 
             out.SetCount(parts.GetCount());
             out.SetVertexData(
@@ -63,6 +243,7 @@ bool ospray::PkdBuilder::manipulateData(
             out.SetColourData(
                 megamol::geocalls::SimpleSphericalParticles::COLDATA_UINT8_RGBA, &models[i].position[0].w, 16);
             out.SetGlobalRadius(parts.GetGlobalRadius());
+            out.SetIsPkdSorted(true);
         }
 
         outData.SetUnlocker(nullptr, false);
@@ -72,6 +253,175 @@ bool ospray::PkdBuilder::manipulateData(
 }
 
 
+uint64_t ospray::PkdBuilder::modelHash() const {
+    uint64_t h = models.size();
+    for (auto const& model : models) {
+        h = h * 0x9e3779b97f4a7c15ull ^ hashParticles(model.position.data(), model.position.size());
+    }
+    return h;
+}
+
+
+bool ospray::PkdBuilder::readTreeFile(std::filesystem::path const& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    char magic[6];
+    uint16_t version = 0;
+    uint32_t frameCount = 0;
+    in.read(magic, 6);
+    in.read(reinterpret_cast<char*>(&version), 2);
+    in.read(reinterpret_cast<char*>(&frameCount), 4);
+    if (!in || std::memcmp(magic, "MMPLD", 6) != 0 || version != (pkdTreeVersion | pkdTreeFlag) || frameCount != 1) {
+        return false;
+    }
+    // bounding box, clip box, seek table and time stamp
+    in.seekg(2 * 6 * 4 + 2 * 8 + 4, std::ios::cur);
+
+    uint32_t listCount = 0;
+    in.read(reinterpret_cast<char*>(&listCount), 4);
+    if (!in || listCount != models.size()) {
+        return false;
+    }
+
+    std::vector<std::vector<rkcommon::math::vec4f>> trees(listCount);
+    for (uint32_t i = 0; i < listCount; ++i) {
+        uint8_t types[2];
+        uint64_t count = 0;
+        in.read(reinterpret_cast<char*>(types), 2);
+        in.seekg(4, std::ios::cur); // global radius
+        in.read(reinterpret_cast<char*>(&count), 8);
+        in.seekg(6 * 4, std::ios::cur); // list bounding box
+        if (!in || types[0] != 1 || types[1] != 2 || count != models[i].position.size()) {
+            return false;
+        }
+        trees[i].resize(count);
+        in.read(reinterpret_cast<char*>(trees[i].data()), count * sizeof(rkcommon::math::vec4f));
+        if (!in) {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < listCount; ++i) {
+        models[i].position = std::move(trees[i]);
+    }
+
+    // the modification time orders the files for pruneTreeDirectory
+    in.close();
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+    return true;
+}
+
+
+bool ospray::PkdBuilder::writeTreeFile(
+    std::filesystem::path const& path, geocalls::MultiParticleDataCall const& data) const {
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    // written under a temporary name, so concurrent readers never see a partial file
+    auto tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        const auto write = [&out](const void* value, size_t size) {
+            out.write(static_cast<const char*>(value), size);
+        };
+
+        const uint16_t version = pkdTreeVersion | pkdTreeFlag;
+        const uint32_t frameCount = 1;
+        write("MMPLD", 6);
+        write(&version, 2);
+        write(&frameCount, 4);
+        write(data.GetBoundingBoxes().ObjectSpaceBBox().PeekBounds(), 6 * 4);
+        write(data.GetBoundingBoxes().ObjectSpaceClipBox().PeekBounds(), 6 * 4);
+
+        uint64_t seekTable[2];
+        seekTable[0] = 6 + 2 + 4 + 2 * 6 * 4 + sizeof(seekTable);
+        seekTable[1] = seekTable[0] + 4 + 4;
+        for (unsigned int i = 0; i < models.size(); ++i) {
+            seekTable[1] += 2 + 4 + 8 + 6 * 4 + models[i].position.size() * sizeof(rkcommon::math::vec4f);
+        }
+        write(seekTable, sizeof(seekTable));
+
+        const float timeStamp = static_cast<float>(data.FrameID());
+        const uint32_t listCount = static_cast<uint32_t>(models.size());
+        write(&timeStamp, 4);
+        write(&listCount, 4);
+        for (unsigned int i = 0; i < models.size(); ++i) {
+            auto const& parts = data.AccessParticles(i);
+            const uint8_t types[2] = {1, 2};
+            const float radius = parts.GetGlobalRadius();
+            const uint64_t count = models[i].position.size();
+            write(types, 2);
+            write(&radius, 4);
+            write(&count, 8);
+            write(parts.GetBBox().PeekBounds(), 6 * 4);
+            write(models[i].position.data(), count * sizeof(rkcommon::math::vec4f));
+        }
+        if (!out) {
+            out.close();
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+
+void ospray::PkdBuilder::pruneTreeDirectory(std::filesystem::path const& directory, std::filesystem::path const& keep) {
+    using megamol::core::utility::log::Log;
+
+    const auto limit = static_cast<uintmax_t>(this->treeCacheSizeSlot.Param<core::param::IntParam>()->Value()) << 20;
+    if (limit == 0) {
+        return;
+    }
+
+    struct TreeFile {
+        std::filesystem::path path;
+        std::filesystem::file_time_type time;
+        uintmax_t size;
+    };
+    std::vector<TreeFile> files;
+    uintmax_t total = 0;
+    std::error_code ec;
+    for (auto const& entry : std::filesystem::directory_iterator(directory, ec)) {
+        if (!entry.is_regular_file(ec) || !isTreeFileName(entry.path())) {
+            continue;
+        }
+        TreeFile file{entry.path(), entry.last_write_time(ec), entry.file_size(ec)};
+        if (!ec) {
+            total += file.size;
+            files.push_back(std::move(file));
+        }
+    }
+    if (total <= limit) {
+        return;
+    }
+
+    std::sort(files.begin(), files.end(), [](TreeFile const& a, TreeFile const& b) { return a.time < b.time; });
+    for (auto const& file : files) {
+        if (total <= limit) {
+            break;
+        }
+        if ((file.path != keep) && std::filesystem::remove(file.path, ec)) {
+            total -= file.size;
+            Log::DefaultLog.WriteInfo("[PkdBuilder] Removed PKD tree file %s", file.path.u8string().c_str());
+        }
+    }
+}
+
+
 void ospray::Pkd::setDim(size_t ID, int dim) const {
 #if DIM_FROM_DEPTH
     return;
@@ -97,11 +447,6 @@ inline size_t ospray::Pkd::maxDim(const rkcommon::math::vec3f& v) const {
 }
 
 
-inline void ospray::Pkd::swap(const size_t a, const size_t b) const {
-    std::swap(model->position[a], model->position[b]);
-}
-
-
 void ospray::Pkd::build() {
     // PING;
     assert(this->model != NULL);
@@ -111,15 +456,6 @@ void ospray::Pkd::build() {
     numParticles = model->position.size();
     assert(numParticles <= (1ULL << 31));
 
-#if 0
-    cout << "#osp:pkd: TEST: RANDOMIZING PARTICLES" << endl;
-    for (size_t i = numParticles - 1; i>0; --i) {
-        size_t j = size_t(drand48()*i);
-        if (i != j) swap(i, j);
-    }
-    cout << "#osp:pkd: RANDOMIZED" << endl;
-#endif
-
     numInnerNodes = numInnerNodesOf(numParticles);
 
     // determine num levels
@@ -129,111 +465,37 @@ void ospray::Pkd::build() {
         ++numLevels;
         nodeID = leftChildOf(nodeID);
     }
-    // PRINT(numLevels);
 
-    const rkcommon::math::box3f& bounds = model->getBounds();
-    /*std::cout << "#osp:pkd: bounds of model " << bounds << std::endl;
-    std::cout << "#osp:pkd: number of input particles " << numParticles << std::endl;*/
-    this->buildRec(0, bounds, 0);
+    const rkcommon::math::box3f bounds = model->getBounds();
+
+    // the tree is built out of place: every node picks its particle from the range of its subtree in the input,
+    // which is partitioned with a (parallel) nth_element instead of swapping along the subtree iterators
+    std::vector<rkcommon::math::vec4f> input(std::move(model->position));
+    model->position.resize(numParticles);
+    std::vector<rkcommon::math::vec4f> scratch(numParticles > parallelSelectCutoff ? numParticles : 0);
+
+    this->buildRec(0, input.data(), input.data() + numParticles, scratch.data(), bounds);
 }
 
 
-void ospray::Pkd::buildRec(const size_t nodeID, const rkcommon::math::box3f& bounds, const size_t depth) const {
-    // if (depth < 4)
-    // std::cout << "#osp:pkd: building subtree " << nodeID << std::endl;
-    if (!hasLeftChild(nodeID))
+void ospray::Pkd::buildRec(const size_t nodeID, rkcommon::math::vec4f* first, rkcommon::math::vec4f* last,
+    rkcommon::math::vec4f* scratch, const rkcommon::math::box3f& bounds) const {
+    const size_t n = last - first;
+    if (n == 0)
+        return;
+    if (n == 1) {
         // has no children -> it's a valid kd-tree already :-)
+        model->position[nodeID] = *first;
         return;
+    }
 
     // we have at least one child.
     const size_t dim = this->maxDim(bounds.size());
-    // if (depth < 4) { PRINT(bounds); printf("depth %ld-> dim %ld\n",depth,dim); }
-    const size_t N = numParticles;
-
-    if (!hasRightChild(nodeID)) {
-        // no right child, but not a leaf emtpy. must have exactly one
-        // child on the left. see if we have to swap, but otherwise
-        // nothing to do.
-        size_t lChild = leftChildOf(nodeID);
-        if (POS(lChild, dim) > POS(nodeID, dim))
-            swap(nodeID, lChild);
-        // and done
-        setDim(nodeID, dim);
-        return;
-    }
-
-    {
-
-        // we have a left and a right subtree, each of at least 1 node.
-        SubtreeIterator l0(leftChildOf(nodeID));
-        SubtreeIterator r0(rightChildOf(nodeID));
-
-        SubtreeIterator l((size_t)l0); //(leftChildOf(nodeID));
-        SubtreeIterator r((size_t)r0); //(rightChildOf(nodeID));
-
-        // size_t numSwaps = 0, numComps = 0;
-        float rootPos = POS(nodeID, dim);
-        while (1) {
 
-            while (isValidNode(l, N) && (POS(l, dim) <= rootPos))
-                ++l;
-            while (isValidNode(r, N) && (POS(r, dim) >= rootPos))
-                ++r;
-
-            if (isValidNode(l, N)) {
-                if (isValidNode(r, N)) {
-                    // both mis-mathces valid, just swap them and go on
-                    swap(l, r);
-                    ++l;
-                    ++r;
-                    continue;
-                } else {
-                    // mis-match on left side, but nothing on right side to swap with: swap with root
-                    // --> can't go on on right side any more, but can still compact matches on left
-                    l0 = l;
-                    ++l;
-                    while (isValidNode(l, N)) {
-                        if (POS(l, dim) <= rootPos) {
-                            swap(l0, l);
-                            ++l0;
-                        }
-                        ++l;
-                    }
-                    swap(nodeID, l0);
-                    ++l0;
-                    rootPos = POS(nodeID, dim);
-
-                    l = l0;
-                    r = r0;
-                    continue;
-                }
-            } else {
-                if (isValidNode(r, N)) {
-                    // mis-match on left side, but nothing on right side to swap with: swap with root
-                    // --> can't go on on right side any more, but can still compact matches on left
-                    r0 = r;
-                    ++r;
-                    while (isValidNode(r, N)) {
-                        if (POS(r, dim) >= rootPos) {
-                            swap(r0, r);
-                            ++r0;
-                        }
-                        ++r;
-                    }
-                    swap(nodeID, r0);
-                    ++r0;
-                    rootPos = POS(nodeID, dim);
-
-                    l = l0;
-                    r = r0;
-                    continue;
-                } else {
-                    // no mis-match on either side ... done.
-                    break;
-                }
-            }
-        }
-    }
+    // the left subtree gets the particles below the node, the right one the particles above
+    auto* const median = first + subtreeSize(leftChildOf(nodeID));
+    parallelNthElement(first, median, last, scratch, dim);
+    model->position[nodeID] = *median;
 
     rkcommon::math::box3f lBounds = bounds;
     rkcommon::math::box3f rBounds = bounds;
@@ -242,12 +504,17 @@ void ospray::Pkd::buildRec(const size_t nodeID, const rkcommon::math::box3f& bou
 
     lBounds.upper[dim] = rBounds.lower[dim] = pos(nodeID, dim);
 
-    if ((numLevels - depth) > 20) {
-        std::thread lThread(&pkdBuildThread, new PKDBuildJob(this, leftChildOf(nodeID), lBounds, depth + 1));
-        buildRec(rightChildOf(nodeID), rBounds, depth + 1);
-        lThread.join();
+    auto* const rScratch = scratch != nullptr ? scratch + (median + 1 - first) : nullptr;
+    if (n > taskCutoff) {
+        // idle workers steal the left halves
+        core::utility::TaskGroup group;
+        group.Run([this, nodeID, first, median, scratch, lBounds]() {
+            buildRec(leftChildOf(nodeID), first, median, scratch, lBounds);
+        });
+        buildRec(rightChildOf(nodeID), median + 1, last, rScratch, rBounds);
+        group.Wait();
     } else {
-        buildRec(leftChildOf(nodeID), lBounds, depth + 1);
-        buildRec(rightChildOf(nodeID), rBounds, depth + 1);
+        buildRec(leftChildOf(nodeID), first, median, scratch, lBounds);
+        buildRec(rightChildOf(nodeID), median + 1, last, rScratch, rBounds);
     }
 }
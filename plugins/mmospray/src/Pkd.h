@@ -8,8 +8,11 @@
 #include "datatools/AbstractParticleManipulator.h"
 #include "geometry_calls/MultiParticleDataCall.h"
 #include "mmcore/CallerSlot.h"
+#include "mmcore/param/ParamSlot.h"
 #include "rkcommon/math/box.h"
 #include "rkcommon/math/vec.h"
+#include <algorithm>
+#include <filesystem>
 #include <map>
 
 
@@ -49,6 +52,24 @@ protected:
     virtual bool manipulateData(geocalls::MultiParticleDataCall& outData, geocalls::MultiParticleDataCall& inData);
 
 private:
+    /** Answers the content hash of the filled models, the key of the tree files */
+    uint64_t modelHash() const;
+
+    /** Loads the trees of all models from a tree file, fails if the file does not match the models */
+    bool readTreeFile(std::filesystem::path const& path);
+
+    /** Writes the trees of all models as PKD-sorted MMPLD file */
+    bool writeTreeFile(std::filesystem::path const& path, geocalls::MultiParticleDataCall const& data) const;
+
+    /** Deletes the least recently used tree files in the directory until they fit treeCacheSize, except keep */
+    void pruneTreeDirectory(std::filesystem::path const& directory, std::filesystem::path const& keep);
+
+    /** Directory of the PKD tree files, empty to always build the trees */
+    core::param::ParamSlot treeDirectorySlot;
+
+    /** Size limit of the tree files in MegaBytes, 0 for no limit */
+    core::param::ParamSlot treeCacheSizeSlot;
+
     size_t inDataHash;
     size_t outDataHash;
     unsigned int frameID;
@@ -90,8 +111,14 @@ struct Pkd {
         return model->position[nodeID][dim];
     }
 
-    //! helper function for building - swap two particles in the model
-    inline void swap(const size_t a, const size_t b) const;
+    //! number of nodes in the subtree below (and including) the given node
+    __forceinline size_t subtreeSize(const size_t nodeID) const {
+        size_t size = 0;
+        for (size_t first = nodeID, width = 1; first < numParticles; first = leftChildOf(first), width += width) {
+            size += std::min(width, numParticles - first);
+        }
+        return size;
+    }
 
     // save the given particle's split dimension
     void setDim(size_t ID, int dim) const;
@@ -100,7 +127,13 @@ struct Pkd {
     //! build particle tree over given model. WILL REORDER THE MODEL'S ELEMENTS
     void build();
 
-    void buildRec(const size_t nodeID, const rkcommon::math::box3f& bounds, const size_t depth) const;
+    /**
+     * Builds the subtree of nodeID from the particles in [first, last) of the input, which are reordered.
+     * Subtrees of more than ~16k particles are built as tasks on the TaskScheduler, so the number of threads is
+     * bounded by its workers.
+     */
+    void buildRec(const size_t nodeID, rkcommon::math::vec4f* first, rkcommon::math::vec4f* last,
+        rkcommon::math::vec4f* scratch, const rkcommon::math::box3f& bounds) const;
 };
 
 
@@ -133,23 +166,5 @@ struct SubtreeIterator {
     }
 };
 
-struct PKDBuildJob {
-    const Pkd* const pkd;
-    const size_t nodeID;
-    const rkcommon::math::box3f bounds;
-    const size_t depth;
-    __forceinline PKDBuildJob(const Pkd* pkd, size_t nodeID, rkcommon::math::box3f bounds, size_t depth)
-            : pkd(pkd)
-            , nodeID(nodeID)
-            , bounds(bounds)
-            , depth(depth){};
-};
-
-static void pkdBuildThread(void* arg) {
-    PKDBuildJob* job = (PKDBuildJob*)arg;
-    job->pkd->buildRec(job->nodeID, job->bounds, job->depth);
-    delete job;
-}
-
 } // namespace ospray
 } // namespace megamol
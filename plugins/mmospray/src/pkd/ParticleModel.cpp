@@ -6,8 +6,11 @@
 #include "pkd/ParticleModel.h"
 #include "stdafx.h"
 
+#include "mmcore/utility/TaskScheduler.h"
 #include "mmcore/utility/log/Log.h"
 
+#include <mutex>
+
 using namespace megamol;
 
 
@@ -53,25 +56,19 @@ inline rkcommon::math::vec3f makeRandomColor(const int i) {
 //! return world bounding box of all particle *positions* (i.e., particles *ex* radius)
 rkcommon::math::box3f ospray::ParticleModel::getBounds() const {
     rkcommon::math::box3f bounds = rkcommon::math::empty;
-    for (size_t i = 0; i < position.size(); ++i)
-        bounds.extend({position[i].x, position[i].y, position[i].z});
+    std::mutex bounds_lock;
+    core::utility::ParallelFor<size_t>(0, position.size(), 0, [&](size_t first, size_t last) {
+        rkcommon::math::box3f local = rkcommon::math::empty;
+        for (size_t i = first; i < last; ++i)
+            local.extend({position[i].x, position[i].y, position[i].z});
+        std::lock_guard<std::mutex> lock(bounds_lock);
+        bounds.extend(local);
+    });
     return bounds;
 }
 
 
 void megamol::ospray::ParticleModel::fill(geocalls::SimpleSphericalParticles parts) {
-    // Attribute rgba("rgba");
-
-    size_t vertexLength;
-    size_t colorLength;
-
-    // Vertex data type check
-    if (parts.GetVertexDataType() == geocalls::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ) {
-        vertexLength = 3;
-    } else if (parts.GetVertexDataType() == geocalls::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR) {
-        vertexLength = 4;
-    }
-
     auto const& parStore = parts.GetParticleStore();
     auto const& xAcc = parStore.GetXAcc();
     auto const& yAcc = parStore.GetYAcc();
@@ -81,23 +78,28 @@ void megamol::ospray::ParticleModel::fill(geocalls::SimpleSphericalParticles par
     auto const& bAcc = parStore.GetCBAcc();
     auto const& aAcc = parStore.GetCAAcc();
 
-    for (size_t loop = 0; loop < parts.GetCount(); ++loop) {
+    auto const offset = this->position.size();
+    this->position.resize(offset + parts.GetCount());
+
+    core::utility::ParallelFor<size_t>(0, parts.GetCount(), 0, [&](size_t first, size_t last) {
+        for (size_t loop = first; loop < last; ++loop) {
 
-        rkcommon::math::vec3f pos;
+            rkcommon::math::vec3f pos;
 
-        pos.x = xAcc->Get_f(loop);
-        pos.y = yAcc->Get_f(loop);
-        pos.z = zAcc->Get_f(loop);
+            pos.x = xAcc->Get_f(loop);
+            pos.y = yAcc->Get_f(loop);
+            pos.z = zAcc->Get_f(loop);
 
-        rkcommon::math::vec4uc col;
+            rkcommon::math::vec4uc col;
 
-        col.x = rAcc->Get_u8(loop);
-        col.y = gAcc->Get_u8(loop);
-        col.z = bAcc->Get_u8(loop);
-        col.w = aAcc->Get_u8(loop);
+            col.x = rAcc->Get_u8(loop);
+            col.y = gAcc->Get_u8(loop);
+            col.z = bAcc->Get_u8(loop);
+            col.w = aAcc->Get_u8(loop);
 
-        float const color = encodeColorToFloat(col);
+            float const color = encodeColorToFloat(col);
 
-        this->position.emplace_back(pos, color);
-    }
+            this->position[offset + loop] = rkcommon::math::vec4f(pos, color);
+        }
+    });
 }
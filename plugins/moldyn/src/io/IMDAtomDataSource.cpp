@@ -15,13 +15,14 @@
 #include "mmcore/param/StringParam.h"
 #include "mmcore/param/Vector3fParam.h"
 #include "mmcore/utility/ColourParser.h"
+#include "mmcore/utility/TaskScheduler.h"
+#include "mmcore/utility/TextParsing.h"
 #include "mmcore/utility/log/Log.h"
 #include "mmcore/view/Input.h"
 #include "stdafx.h"
 #include "vislib/Array.h"
 #include "vislib/PtrArray.h"
 #include "vislib/String.h"
-#include "vislib/StringTokeniser.h"
 #include "vislib/forceinline.h"
 #include "vislib/math/ShallowVector.h"
 #include "vislib/math/Vector.h"
@@ -30,6 +31,8 @@
 #include "vislib/sys/SystemMessage.h"
 #include "vislib/sys/sysfunctions.h"
 #include <climits>
+#include <limits>
+#include <vector>
 
 
 namespace {
@@ -132,98 +135,6 @@ protected:
         cp[4] = c;
     }
 
-    /**
-     * sifts the next ascii block
-     *
-     * @param fail The fail flag is not changed if the method succeeds.
-     *             If the method fails the flag is set to 'true'.
-     *
-     * @return The next ascii block
-     */
-    const char* sift(bool& fail) {
-        static vislib::StringA ebuf;
-        char* cbuf = reinterpret_cast<char*>(this->buf);
-
-        // do we need new data?
-        if (this->pos == this->validBufSize) {
-            try {
-                this->validBufSize = static_cast<unsigned int>(this->file.Read(this->buf, BUFSIZE));
-            } catch (...) {
-                this->pos = this->validBufSize = 0;
-                fail = true;
-                return NULL;
-            }
-            this->pos = 0;
-            if (this->validBufSize == 0) { // eof
-                fail = true;
-                return NULL;
-            }
-        }
-
-        // skip white-spaces
-        if (cbuf[this->pos] == 0) {
-            cbuf[this->pos] = ' '; // because this 0 was proably from a
-                                   // previous sift
-        }
-        while (vislib::CharTraitsA::IsSpace(cbuf[this->pos])) {
-            this->pos++;
-            if (this->pos == this->validBufSize) {
-                try {
-                    this->validBufSize = static_cast<unsigned int>(this->file.Read(this->buf, BUFSIZE));
-                } catch (...) {
-                    this->pos = this->validBufSize = 0;
-                    fail = true;
-                    return NULL;
-                }
-                this->pos = 0;
-                if (this->validBufSize == 0) { // eof
-                    fail = true;
-                    return NULL;
-                }
-            }
-        }
-
-        // collect token
-        unsigned int start = this->pos; // start of the new token
-        while (!vislib::CharTraitsA::IsSpace(cbuf[this->pos])) {
-            this->pos++;
-            if (this->pos == this->validBufSize) {
-                // running out of buffer, so we need to copy!
-                ebuf = vislib::StringA(cbuf + start, this->pos - start);
-
-                while (!this->file.IsEOF()) {
-                    try {
-                        this->validBufSize = static_cast<unsigned int>(this->file.Read(this->buf, BUFSIZE));
-                    } catch (...) {
-                        this->pos = this->validBufSize = 0;
-                        break;
-                    }
-                    this->pos = 0;
-                    if (this->validBufSize == 0) { // eof
-                        break;
-                    }
-
-                    while (!vislib::CharTraitsA::IsSpace(cbuf[this->pos]) && (this->pos < this->validBufSize)) {
-                        this->pos++;
-                    }
-
-                    ebuf += vislib::StringA(cbuf, this->pos);
-                    if (this->pos < this->validBufSize) {
-                        // we did not run out of buffer -> os it's the end of the token
-                        break;
-                    }
-                }
-
-                return ebuf.PeekBuffer();
-            }
-        }
-
-        // token complete in buffer (and there are remaining whitspaces)
-        ASSERT(vislib::CharTraitsA::IsSpace(cbuf[this->pos]));
-        this->buf[this->pos] = 0;
-        return cbuf + start;
-    }
-
 private:
     /** The size of the input buffer */
     static const unsigned int BUFSIZE = 4 * 1024;
@@ -321,23 +232,18 @@ private:
 
 
 /**
- * IMD Atom file reader class for the ASCII file format
+ * IMD Atom file reader class for the ASCII file format. Reads the
+ * whitespace separated values of a part of the mapped file.
  */
-class AtomReaderASCII : public AbstractAtomReader {
+class AtomReaderText {
 public:
     /**
      * Ctor
      *
-     * @param file The file to read from
-     */
-    AtomReaderASCII(vislib::sys::File& file) : AbstractAtomReader(file) {
-        // Intentionally empty
-    }
-
-    /**
-     * Dtor
+     * @param begin The begin of the text to read from
+     * @param end The end of the text to read from
      */
-    ~AtomReaderASCII(void) {
+    AtomReaderText(const char* begin, const char* end) : cursor(begin, end), malformed(false) {
         // Intentionally empty
     }
 
@@ -350,11 +256,11 @@ public:
      * @return The read integer
      */
     VISLIB_FORCEINLINE UINT32 ReadInt(bool& fail) {
-        const char* c = this->sift(fail);
-        try {
-            return static_cast<UINT32>(vislib::CharTraitsA::ParseInt(c));
-        } catch (...) { fail = true; }
-        return 0;
+        int64_t i = 0;
+        if (!megamol::core::utility::parseInt(this->next(fail), i) && !fail) {
+            this->malformed = fail = true;
+        }
+        return static_cast<UINT32>(i);
     }
 
     /**
@@ -366,11 +272,11 @@ public:
      * @return The read float
      */
     VISLIB_FORCEINLINE float ReadFloat(bool& fail) {
-        const char* c = this->sift(fail);
-        try {
-            return static_cast<float>(vislib::CharTraitsA::ParseDouble(c));
-        } catch (...) { fail = true; }
-        return 0.0f;
+        float f = 0.0f;
+        if (!megamol::core::utility::parseFloat(this->next(fail), f) && !fail) {
+            this->malformed = fail = true;
+        }
+        return f;
     }
 
     /**
@@ -379,8 +285,8 @@ public:
      * @param fail The fail flag is not changed if the method succeeds.
      *             If the method fails the flag is set to 'true'.
      */
-    VISLIB_FORCEINLINE void SkipInt(bool& fail) { /*const char *c =*/
-        this->sift(fail);
+    VISLIB_FORCEINLINE void SkipInt(bool& fail) {
+        this->next(fail);
     }
 
     /**
@@ -389,9 +295,35 @@ public:
      * @param fail The fail flag is not changed if the method succeeds.
      *             If the method fails the flag is set to 'true'.
      */
-    VISLIB_FORCEINLINE void SkipFloat(bool& fail) { /*const char *c =*/
-        this->sift(fail);
+    VISLIB_FORCEINLINE void SkipFloat(bool& fail) {
+        this->next(fail);
+    }
+
+    /**
+     * Answer whether reading stopped at a value which is no number
+     *
+     * @return 'true' if a value could not be parsed
+     */
+    inline bool IsMalformed(void) const {
+        return this->malformed;
+    }
+
+private:
+    /** Answers the next token, fails at the end of the text */
+    VISLIB_FORCEINLINE std::string_view next(bool& fail) {
+        this->cursor.skipWhitespace();
+        if (this->cursor.atEnd()) {
+            fail = true;
+            return std::string_view();
+        }
+        return this->cursor.token();
     }
+
+    /** The cursor in the text */
+    megamol::core::utility::TextCursor cursor;
+
+    /** Flag whether a value could not be parsed */
+    bool malformed;
 };
 
 
@@ -716,23 +648,90 @@ using namespace megamol;
 using namespace megamol::moldyn::io;
 
 
+/**
+ * The data columns selected by the parameters. Columns which are not
+ * selected are UINT_MAX.
+ */
+struct IMDAtomDataSource::ColumnSelection {
+    unsigned int colcolumn = UINT_MAX;
+    unsigned int dircolcolumn = UINT_MAX;
+    unsigned int typecolumn = UINT_MAX;
+    unsigned int dirXCol = UINT_MAX;
+    unsigned int dirYCol = UINT_MAX;
+    unsigned int dirZCol = UINT_MAX;
+    int dircolMode = 0;
+    bool loadDir = false;
+    bool splitDir = false;
+    bool normaliseDir = false;
+    bool bboxEnabled = false;
+    vislib::math::Vector<float, 3> bboxMin;
+    vislib::math::Vector<float, 3> bboxMax;
+};
+
+
+/**
+ * The atoms read from a part of the file, separated by type in order of
+ * the first appearance of the types.
+ */
+struct IMDAtomDataSource::AtomBlock {
+    std::vector<unsigned int> types;
+    std::vector<std::vector<float>> pos;
+    std::vector<std::vector<float>> col;
+    std::vector<std::vector<float>> dir;
+
+    /** The bounding values of the colour columns per type */
+    std::vector<float> minC, maxC;
+
+    /** The bounding box of the positions */
+    float minX = 0.0f, minY = 0.0f, minZ = 0.0f, maxX = 0.0f, maxY = 0.0f, maxZ = 0.0f;
+
+    /** Flag whether no atom has been read yet */
+    bool first = true;
+
+    /** The colour value and the type index of the first atom */
+    float firstC = 0.0f;
+    unsigned int firstType = 0;
+
+    /** Flag whether reading stopped at a malformed value */
+    bool malformed = false;
+
+    /** Answers the index of a type, appending it if it is new */
+    unsigned int TypeIndex(unsigned int t) {
+        for (unsigned int i = 0; i < static_cast<unsigned int>(this->types.size()); i++) {
+            if (this->types[i] == t)
+                return i;
+        }
+        this->types.push_back(t);
+        this->pos.emplace_back();
+        this->col.emplace_back();
+        this->dir.emplace_back();
+        this->minC.push_back(std::numeric_limits<float>::max());
+        this->maxC.push_back(std::numeric_limits<float>::lowest());
+        return static_cast<unsigned int>(this->types.size() - 1);
+    }
+};
+
+
 /*
  * IMDAtomDataSource::FileFormatAutoDetect
  */
 float IMDAtomDataSource::FileFormatAutoDetect(const unsigned char* data, SIZE_T dataSize) {
-    vislib::StringA line(reinterpret_cast<const char*>(data), static_cast<unsigned int>(dataSize));
-    line.Replace('\t', ' ');
-    vislib::Array<vislib::StringA> lines = vislib::StringTokeniserA::Split(line, "\n", true);
-    for (SIZE_T i = 0; i < lines.Count(); i++) {
-        if (!lines[i].StartsWith("#F "))
+    core::utility::TextCursor text(std::string_view(reinterpret_cast<const char*>(data), dataSize));
+    while (!text.atEnd()) {
+        core::utility::TextCursor line(text.line());
+        if (line.token() != "#F")
             continue;
-        vislib::Array<vislib::StringA> tokens = vislib::StringTokeniserA::Split(lines[i], ' ', true);
-        if (tokens.Count() != 8)
+        std::string_view tokens[8];
+        int count = 0;
+        while (!line.atLineEnd() && (count < 8)) {
+            tokens[count++] = line.token();
+        }
+        if ((count != 7) || !line.atLineEnd())
             continue;
 
         // now I'm almost sure
-        if (tokens[1].Equals("A") || tokens[1].Equals("B") || tokens[1].Equals("b") || tokens[1].Equals("L") ||
-            tokens[1].Equals("l")) {
+        if ((tokens[0] == "A") || (tokens[0] == "B") || (tokens[0] == "b") || (tokens[0] == "L") ||
+            (tokens[0] == "l")) {
             // now I'm sure
             return 1.0f;
         }
@@ -1133,20 +1132,19 @@ void IMDAtomDataSource::assertData(void) {
 
     this->clear();
 
-    vislib::sys::FastFile file;
+    core::utility::MappedFile mapped;
     auto filename = this->filenameSlot.Param<core::param::FilePathParam>()->Value();
     //    Log::DefaultLog.WriteInfo(50, _T("Loading \"%s\""), filename.PeekBuffer());
     // this->datahash = static_cast<SIZE_T>(filename.HashCode());
-    if (!file.Open(filename.native().c_str(), vislib::sys::File::READ_ONLY, vislib::sys::File::SHARE_READ,
-            vislib::sys::File::OPEN_ONLY)) {
+    if (!mapped.open(filename.generic_u8string())) {
         Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to open imd file %s\n", filename.generic_u8string().c_str());
         return;
     }
 
     HeaderData header;
-    if (!this->readHeader(file, header)) {
+    size_t dataOffset = 0;
+    if (!this->readHeader(mapped.text(), header, dataOffset)) {
         // error already logged
-        file.Close();
         return;
     }
 
@@ -1173,32 +1171,81 @@ void IMDAtomDataSource::assertData(void) {
     bool loadDir = (dirXCol >= 0) && (dirYCol >= 0) && (dirZCol >= 0);
     bool splitLoadDir = this->splitLoadDiredDataSlot.Param<core::param::BoolParam>()->Value();
 
-    bool retval = false;
-    switch (header.format) {
-    case 'A': // ASCII
-        retval = this->readData<AtomReaderASCII>(file, header, loadDir, splitLoadDir);
-        break;
-    case 'B': // binary, big endian, double
-        retval = (machineLittleEndian) ? this->readData<AtomReaderDoubleSwitched>(file, header, loadDir, splitLoadDir)
-                                       : this->readData<AtomReaderDouble>(file, header, loadDir, splitLoadDir);
-        break;
-    case 'b': // binary, big endian, float
-        retval = (machineLittleEndian) ? this->readData<AtomReaderFloatSwitched>(file, header, loadDir, splitLoadDir)
-                                       : this->readData<AtomReaderFloat>(file, header, loadDir, splitLoadDir);
-        break;
-    case 'L': // binary, little endian, double
-        retval = (machineLittleEndian) ? this->readData<AtomReaderDouble>(file, header, loadDir, splitLoadDir)
-                                       : this->readData<AtomReaderDoubleSwitched>(file, header, loadDir, splitLoadDir);
-        break;
-    case 'l': // binary, little endian float
-        retval = (machineLittleEndian) ? this->readData<AtomReaderFloat>(file, header, loadDir, splitLoadDir)
-                                       : this->readData<AtomReaderFloatSwitched>(file, header, loadDir, splitLoadDir);
-        break;
-    default:
-        Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to read imd file: Illegal format\n");
-        break;
+    ColumnSelection sel;
+    this->selectColumns(header, loadDir, splitLoadDir, sel);
+
+    // the ascii data is parsed in parallel in parts of whole lines, the
+    // binary data is streamed in one block
+    std::vector<AtomBlock> blocks;
+    if (header.format == 'A') {
+        const char* data = mapped.data() + dataOffset;
+        const auto parts = core::utility::chunkAtLines(data, mapped.size() - dataOffset);
+        blocks.resize(parts.size() - 1);
+        core::utility::ParallelFor<size_t>(0, blocks.size(), 1, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                AtomReaderText reader(data + parts[i], data + parts[i + 1]);
+                this->readData(reader, header, sel, blocks[i]);
+                blocks[i].malformed = reader.IsMalformed();
+            }
+        });
+    } else {
+        vislib::sys::FastFile file;
+        if (!file.Open(filename.native().c_str(), vislib::sys::File::READ_ONLY, vislib::sys::File::SHARE_READ,
+                vislib::sys::File::OPEN_ONLY)) {
+            Log::DefaultLog.WriteMsg(
+                Log::LEVEL_ERROR, "Unable to open imd file %s\n", filename.generic_u8string().c_str());
+            return;
+        }
+        file.Seek(static_cast<vislib::sys::File::FileOffset>(dataOffset));
+        blocks.resize(1);
+
+        switch (header.format) {
+        case 'B': { // binary, big endian, double
+            if (machineLittleEndian) {
+                AtomReaderDoubleSwitched reader(file);
+                this->readData(reader, header, sel, blocks[0]);
+            } else {
+                AtomReaderDouble reader(file);
+                this->readData(reader, header, sel, blocks[0]);
+            }
+        } break;
+        case 'b': { // binary, big endian, float
+            if (machineLittleEndian) {
+                AtomReaderFloatSwitched reader(file);
+                this->readData(reader, header, sel, blocks[0]);
+            } else {
+                AtomReaderFloat reader(file);
+                this->readData(reader, header, sel, blocks[0]);
+            }
+        } break;
+        case 'L': { // binary, little endian, double
+            if (machineLittleEndian) {
+                AtomReaderDouble reader(file);
+                this->readData(reader, header, sel, blocks[0]);
+            } else {
+                AtomReaderDoubleSwitched reader(file);
+                this->readData(reader, header, sel, blocks[0]);
+            }
+        } break;
+        case 'l': { // binary, little endian float
+            if (machineLittleEndian) {
+                AtomReaderFloat reader(file);
+                this->readData(reader, header, sel, blocks[0]);
+            } else {
+                AtomReaderFloatSwitched reader(file);
+                this->readData(reader, header, sel, blocks[0]);
+            }
+        } break;
+        default:
+            Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to read imd file: Illegal format\n");
+            break;
+        }
+
+        file.Close();
     }
 
+    bool retval = this->storeData(blocks);
+
     if (retval) {
         // TODO inside readData!
         // this->posData.EnforceSize(posWriter.End(), true);
@@ -1235,8 +1282,6 @@ void IMDAtomDataSource::assertData(void) {
         // this->datahash = 0;
     }
 
-    file.Close();
-
     // apply filter (if activated)
     this->posXFilterUpdate(this->posXFilterNow);
 }
@@ -1245,174 +1290,181 @@ void IMDAtomDataSource::assertData(void) {
 /*
  * IMDAtomDataSource::readHeader
  */
-bool IMDAtomDataSource::readHeader(vislib::sys::File& file, IMDAtomDataSource::HeaderData& header) {
+bool IMDAtomDataSource::readHeader(
+    std::string_view text, IMDAtomDataSource::HeaderData& header, size_t& dataOffset) {
     using megamol::core::utility::log::Log;
-    using vislib::sys::File;
-    vislib::StringA line;
-    bool windowsNewline = false;
-    char nlb[2];
-
-    try {
-        file.SeekToBegin();
-        line = vislib::sys::ReadLineFromFileA(file);
-        if (line[0] != '#') {
-            Log::DefaultLog.WriteMsg(
-                Log::LEVEL_ERROR, "Failed to parse IMD header: Illegal first line character %c\n", line[0]);
-            return false;
-        }
+    using megamol::core::utility::TextCursor;
 
-        file.Seek(-2, File::CURRENT);
-        file.Read(nlb, 2);
-        file.SeekToBegin();
-        if ((nlb[0] == '\r') && (nlb[1] == '\n')) {
-            windowsNewline = true; // used for the '#E' line
+    auto const fail = [](const char* msg, std::string_view item) {
+        Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Failed to parse IMD header: %s%.*s\n", msg,
+            static_cast<int>(item.size()), item.data());
+        return false;
+    };
+
+    // splits a header line into its tokens, the first one being the line tag
+    const size_t maxItems = 9;
+    std::string_view itemz[maxItems];
+    auto const split = [&itemz](std::string_view line) {
+        TextCursor cursor(line);
+        size_t cnt = 0;
+        while (!cursor.atLineEnd()) {
+            auto const item = cursor.token();
+            if (cnt < maxItems)
+                itemz[cnt] = item;
+            cnt++;
         }
+        return cnt;
+    };
+    auto const parseDouble = [](std::string_view item) {
+        double d = 0.0;
+        megamol::core::utility::parseDouble(item, d);
+        return d;
+    };
+
+    if (text.empty() || (text[0] != '#')) {
+        Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Failed to parse IMD header: Illegal first line character %c\n",
+            text.empty() ? ' ' : text[0]);
+        return false;
+    }
 
-        header.captions.Clear();
+    size_t firstLineEnd = text.find('\n');
+    bool windowsNewline = (firstLineEnd != std::string_view::npos) && (firstLineEnd > 0) &&
+                          (text[firstLineEnd - 1] == '\r'); // used for the '#E' line
 
-        int warnCnt = 0;
-        int linePos = 0;
-        while (!file.IsEOF()) {
-            line = vislib::sys::ReadLineFromFileA(file);
-            linePos++;
+    header.captions.Clear();
 
-            if (line[0] != '#') {
-                Log::DefaultLog.WriteMsg(
-                    Log::LEVEL_WARN, "Line %d has illegal first character: %c\n", linePos, line[0]);
-                warnCnt++;
-                if (warnCnt == 10) {
-                    throw new vislib::Exception("Too many warnings", __FILE__, __LINE__);
-                } else {
-                    continue;
-                }
+    TextCursor cursor(text);
+    int warnCnt = 0;
+    int linePos = 0;
+    while (!cursor.atEnd()) {
+        std::string_view line = cursor.line();
+        linePos++;
+
+        if (line.empty() || (line[0] != '#')) {
+            Log::DefaultLog.WriteMsg(
+                Log::LEVEL_WARN, "Line %d has illegal first character: %c\n", linePos, line.empty() ? ' ' : line[0]);
+            warnCnt++;
+            if (warnCnt == 10) {
+                return fail("Too many warnings", {});
+            } else {
+                continue;
             }
+        }
 
-            switch (line[1]) {
-            case '#':
-                break;  // comment line
-            case 'F': { // format line
-                line.Replace('\t', ' ');
-                vislib::Array<vislib::StringA> itemz = vislib::StringTokeniserA::Split(line, ' ', true);
-                if (itemz.Count() != 8) {
-                    vislib::StringA msg("Illegal format line (not 7 fields): ");
-                    msg.Append(line);
-                    throw new vislib::Exception(msg.PeekBuffer(), __FILE__, __LINE__);
-                }
+        switch ((line.size() > 1) ? line[1] : '\0') {
+        case '#':
+            break;  // comment line
+        case 'F': { // format line
+            if (split(line) != 8) {
+                return fail("Illegal format line (not 7 fields): ", line);
+            }
 
-                header.format = itemz[1][0];
-                if (((header.format != 'A') && (header.format != 'B') && (header.format != 'b') &&
-                        (header.format != 'L') && (header.format != 'l')) ||
-                    (itemz[1].Length() != 1)) {
-                    vislib::StringA msg("Illegal format: ");
-                    msg.Append(itemz[1]);
-                    throw new vislib::Exception(msg.PeekBuffer(), __FILE__, __LINE__);
-                }
+            header.format = itemz[1][0];
+            if (((header.format != 'A') && (header.format != 'B') && (header.format != 'b') &&
+                    (header.format != 'L') && (header.format != 'l')) ||
+                (itemz[1].size() != 1)) {
+                return fail("Illegal format: ", itemz[1]);
+            }
 
-                header.id = (vislib::CharTraitsA::ParseInt(itemz[2]) != 0);
-                header.type = (vislib::CharTraitsA::ParseInt(itemz[3]) != 0);
-                header.mass = (vislib::CharTraitsA::ParseInt(itemz[4]) != 0);
-                header.pos = vislib::CharTraitsA::ParseInt(itemz[5]);
-                header.vel = vislib::CharTraitsA::ParseInt(itemz[6]);
-                header.dat = vislib::CharTraitsA::ParseInt(itemz[7]);
-
-                if ((header.pos != 2) && (header.pos != 3)) {
-                    vislib::StringA msg("Illegal position vector size: ");
-                    msg.Append(itemz[5]);
-                    throw new vislib::Exception(msg.PeekBuffer(), __FILE__, __LINE__);
+            int64_t values[6];
+            for (int i = 0; i < 6; i++) {
+                if (!megamol::core::utility::parseInt(itemz[2 + i], values[i])) {
+                    return fail("Illegal format line: ", line);
                 }
+            }
+            header.id = (values[0] != 0);
+            header.type = (values[1] != 0);
+            header.mass = (values[2] != 0);
+            header.pos = static_cast<int>(values[3]);
+            header.vel = static_cast<int>(values[4]);
+            header.dat = static_cast<int>(values[5]);
+
+            if ((header.pos != 2) && (header.pos != 3)) {
+                return fail("Illegal position vector size: ", itemz[5]);
+            }
 
-                if ((header.vel > 0) && (header.vel != header.pos)) {
-                    vislib::StringA msg("Illegal velocity vector size: ");
-                    msg.Append(itemz[6]);
-                    throw new vislib::Exception(msg.PeekBuffer(), __FILE__, __LINE__);
-                }
+            if ((header.vel > 0) && (header.vel != header.pos)) {
+                return fail("Illegal velocity vector size: ", itemz[6]);
+            }
 
-            } break;
-            case 'C': // caption line
-                line.Replace('\t', ' ');
-                header.captions = vislib::StringTokeniserA::Split(line, ' ', true);
-                header.captions.Erase(0, 1);
-                break;
-            case 'X': { // bounding box x line
-                line.Replace('\t', ' ');
-                vislib::Array<vislib::StringA> itemz = vislib::StringTokeniserA::Split(line, ' ', true);
-                if (itemz.Count() < 3) {
-                    throw new vislib::Exception("Illegal bounding box x vector", __FILE__, __LINE__);
-                }
-                vislib::math::Vector<double, 3> vec(
-                    vislib::CharTraitsA::ParseDouble(itemz[1]), vislib::CharTraitsA::ParseDouble(itemz[2]), 0.0);
-                if (itemz.Count() >= 4) {
-                    vec.SetZ(vislib::CharTraitsA::ParseDouble(itemz[3]));
-                }
-                this->headerMaxX = static_cast<float>(vec.Length());
-            } break;
-            case 'Y': { // bounding box y line
-                line.Replace('\t', ' ');
-                vislib::Array<vislib::StringA> itemz = vislib::StringTokeniserA::Split(line, ' ', true);
-                if (itemz.Count() < 3) {
-                    throw new vislib::Exception("Illegal bounding box y vector", __FILE__, __LINE__);
-                }
-                vislib::math::Vector<double, 3> vec(
-                    vislib::CharTraitsA::ParseDouble(itemz[1]), vislib::CharTraitsA::ParseDouble(itemz[2]), 0.0);
-                if (itemz.Count() >= 4) {
-                    vec.SetZ(vislib::CharTraitsA::ParseDouble(itemz[3]));
-                }
-                this->headerMaxY = static_cast<float>(vec.Length());
-            } break;
-            case 'Z': { // bounding box z line
-                line.Replace('\t', ' ');
-                vislib::Array<vislib::StringA> itemz = vislib::StringTokeniserA::Split(line, ' ', true);
-                if (itemz.Count() < 4) {
-                    throw new vislib::Exception("Illegal bounding box z vector", __FILE__, __LINE__);
-                }
-                vislib::math::Vector<double, 3> vec(vislib::CharTraitsA::ParseDouble(itemz[1]),
-                    vislib::CharTraitsA::ParseDouble(itemz[2]), vislib::CharTraitsA::ParseDouble(itemz[3]));
-                this->headerMaxZ = static_cast<float>(vec.Length());
-            } break;
-            case 'E': // end header line
-
-                if (header.format != 'A') {
-                    // fix a newline at the end (should never happen)
-                    file.Seek(-2, File::CURRENT);
-                    file.Read(nlb, 2);
-                    if ((nlb[0] == '\r') && (nlb[1] == '\n') && !windowsNewline) {
-                        file.Seek(-1, File::CURRENT);
-                    }
+        } break;
+        case 'C': { // caption line
+            TextCursor captions(line);
+            captions.token();
+            while (!captions.atLineEnd()) {
+                auto const caption = captions.token();
+                header.captions.Add(vislib::StringA(caption.data(), static_cast<unsigned int>(caption.size())));
+            }
+        } break;
+        case 'X': { // bounding box x line
+            size_t cnt = split(line);
+            if (cnt < 3) {
+                return fail("Illegal bounding box x vector", {});
+            }
+            vislib::math::Vector<double, 3> vec(parseDouble(itemz[1]), parseDouble(itemz[2]), 0.0);
+            if (cnt >= 4) {
+                vec.SetZ(parseDouble(itemz[3]));
+            }
+            this->headerMaxX = static_cast<float>(vec.Length());
+        } break;
+        case 'Y': { // bounding box y line
+            size_t cnt = split(line);
+            if (cnt < 3) {
+                return fail("Illegal bounding box y vector", {});
+            }
+            vislib::math::Vector<double, 3> vec(parseDouble(itemz[1]), parseDouble(itemz[2]), 0.0);
+            if (cnt >= 4) {
+                vec.SetZ(parseDouble(itemz[3]));
+            }
+            this->headerMaxY = static_cast<float>(vec.Length());
+        } break;
+        case 'Z': { // bounding box z line
+            if (split(line) < 4) {
+                return fail("Illegal bounding box z vector", {});
+            }
+            vislib::math::Vector<double, 3> vec(
+                parseDouble(itemz[1]), parseDouble(itemz[2]), parseDouble(itemz[3]));
+            this->headerMaxZ = static_cast<float>(vec.Length());
+        } break;
+        case 'E': // end header line
+            dataOffset = static_cast<size_t>(cursor.position() - text.data());
+
+            if (header.format != 'A') {
+                // fix a newline at the end (should never happen)
+                if ((dataOffset >= 2) && (text[dataOffset - 2] == '\r') && (text[dataOffset - 1] == '\n') &&
+                    !windowsNewline) {
+                    dataOffset--;
                 }
+            }
 
-                if (!header.captions.IsEmpty()) {
-                    int cnt = 0;
-                    if (header.id)
-                        cnt++;
-                    if (header.type)
-                        cnt++;
-                    if (header.mass)
-                        cnt++;
-                    cnt += header.pos + header.vel + header.dat;
-                    int hcnt = static_cast<int>(header.captions.Count());
-                    if (hcnt < cnt) {
-                        Log::DefaultLog.WriteMsg(
-                            Log::LEVEL_WARN, "Too few data column captions specified (%d instead of %d)", hcnt, cnt);
-                        for (; hcnt < cnt; hcnt++) {
-                            header.captions.Add("unnamed");
-                        }
-                    } else if (hcnt > cnt) {
-                        Log::DefaultLog.WriteMsg(
-                            Log::LEVEL_WARN, "Too many data column captions specified (%d instead of %d)", hcnt, cnt);
-                        header.captions.Erase(cnt, hcnt - cnt);
+            if (!header.captions.IsEmpty()) {
+                int cnt = 0;
+                if (header.id)
+                    cnt++;
+                if (header.type)
+                    cnt++;
+                if (header.mass)
+                    cnt++;
+                cnt += header.pos + header.vel + header.dat;
+                int hcnt = static_cast<int>(header.captions.Count());
+                if (hcnt < cnt) {
+                    Log::DefaultLog.WriteMsg(
+                        Log::LEVEL_WARN, "Too few data column captions specified (%d instead of %d)", hcnt, cnt);
+                    for (; hcnt < cnt; hcnt++) {
+                        header.captions.Add("unnamed");
                     }
+                } else if (hcnt > cnt) {
+                    Log::DefaultLog.WriteMsg(
+                        Log::LEVEL_WARN, "Too many data column captions specified (%d instead of %d)", hcnt, cnt);
+                    header.captions.Erase(cnt, hcnt - cnt);
                 }
-
-                return true;
             }
-        }
-        Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Failed to parse IMD header: unexpected end of file\n");
 
-    } catch (vislib::Exception ex) {
-        Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Failed to parse IMD header: %s\n", ex.GetMsgA());
-    } catch (...) { Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Failed to parse IMD header: unexpected exception\n"); }
+            return true;
+        }
+    }
 
-    return false;
+    return fail("unexpected end of file", {});
 }
 
 template<typename T>
@@ -1460,35 +1512,10 @@ void IMDAtomDataSource::readToFloatColumn(T& reader, bool& fail, unsigned int* c
 }
 
 /*
- * IMDAtomDataSource::readData
+ * IMDAtomDataSource::selectColumns
  */
-template<typename T>
-bool IMDAtomDataSource::readData(
-    vislib::sys::File& file, const IMDAtomDataSource::HeaderData& header, bool loadDir, bool splitDir) {
-    T reader(file);
-    bool fail = false;
-    float x = 0.0f, y = 0.0f, z = 0.0f;
-    bool first = true;
-    float c = 0.0f, dc = 0.0f, t = 0.0f;
-    float dx = 0.0f, dy = 0.0f, dz = 0.0f;
-    unsigned int column;
-    unsigned int colcolumn = UINT_MAX;
-    unsigned int dircolcolumn = UINT_MAX;
-    unsigned int typecolumn = UINT_MAX;
-    // TODO type column
-
-    this->typeData.Clear();
-    this->minC.Clear();
-    this->maxC.Clear();
-    this->posData.Clear();
-    this->colData.Clear();
-    this->allDirData.Clear();
-
-    vislib::PtrArray<vislib::RawStorageWriter> posWriters;
-    vislib::PtrArray<vislib::RawStorageWriter> colWriters;
-    vislib::PtrArray<vislib::RawStorageWriter> dirWriters;
-
-    bool normaliseDir = this->dirNormDirSlot.Param<core::param::BoolParam>()->Value();
+void IMDAtomDataSource::selectColumns(
+    const IMDAtomDataSource::HeaderData& header, bool loadDir, bool splitDir, ColumnSelection& sel) {
     vislib::StringA dirXColName = this->dirXColNameSlot.Param<core::param::StringParam>()->Value().c_str();
     vislib::StringA dirYColName = this->dirYColNameSlot.Param<core::param::StringParam>()->Value().c_str();
     vislib::StringA dirZColName = this->dirZColNameSlot.Param<core::param::StringParam>()->Value().c_str();
@@ -1498,7 +1525,16 @@ bool IMDAtomDataSource::readData(
     ASSERT(!loadDir || (dirXCol >= 0));
     ASSERT(!loadDir || (dirYCol >= 0));
     ASSERT(!loadDir || (dirZCol >= 0));
-    int dircolMode = this->dircolourModeSlot.Param<core::param::EnumParam>()->Value();
+    sel.dirXCol = (dirXCol < 0) ? UINT_MAX : static_cast<unsigned int>(dirXCol);
+    sel.dirYCol = (dirYCol < 0) ? UINT_MAX : static_cast<unsigned int>(dirYCol);
+    sel.dirZCol = (dirZCol < 0) ? UINT_MAX : static_cast<unsigned int>(dirZCol);
+    sel.dircolMode = this->dircolourModeSlot.Param<core::param::EnumParam>()->Value();
+    sel.loadDir = loadDir;
+    sel.splitDir = splitDir;
+    sel.normaliseDir = this->dirNormDirSlot.Param<core::param::BoolParam>()->Value();
+    sel.bboxEnabled = this->bboxEnabledSlot.Param<core::param::BoolParam>()->Value();
+    sel.bboxMin = this->bboxMinSlot.Param<core::param::Vector3fParam>()->Value();
+    sel.bboxMax = this->bboxMaxSlot.Param<core::param::Vector3fParam>()->Value();
 
     if (true) {
         // type from column
@@ -1507,35 +1543,35 @@ bool IMDAtomDataSource::readData(
         // 1. exact match
         for (SIZE_T i = 0; i < header.captions.Count(); i++) {
             if (header.captions[i].Equals(typecolname)) {
-                typecolumn = static_cast<unsigned int>(i);
+                sel.typecolumn = static_cast<unsigned int>(i);
                 break;
             }
         }
 
-        if (typecolumn == UINT_MAX) {
+        if (sel.typecolumn == UINT_MAX) {
             // 2. caseless match
             for (SIZE_T i = 0; i < header.captions.Count(); i++) {
                 if (header.captions[i].Equals(typecolname, false)) {
-                    typecolumn = static_cast<unsigned int>(i);
+                    sel.typecolumn = static_cast<unsigned int>(i);
                     break;
                 }
             }
         }
 
-        if (typecolumn == UINT_MAX) {
+        if (sel.typecolumn == UINT_MAX) {
             // 3. index
             try {
-                typecolumn = vislib::CharTraitsA::ParseInt(typecolname);
-                if (typecolumn >= static_cast<unsigned int>(header.captions.Count())) {
+                sel.typecolumn = vislib::CharTraitsA::ParseInt(typecolname);
+                if (sel.typecolumn >= static_cast<unsigned int>(header.captions.Count())) {
                     megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_ERROR,
-                        "The parsed type column index is out of range (%u not in 0..%d)\n", typecolumn,
+                        "The parsed type column index is out of range (%u not in 0..%d)\n", sel.typecolumn,
                         static_cast<int>(header.captions.Count()) - 1);
-                    typecolumn = UINT_MAX;
+                    sel.typecolumn = UINT_MAX;
                 }
-            } catch (...) { typecolumn = UINT_MAX; }
+            } catch (...) { sel.typecolumn = UINT_MAX; }
         }
 
-        if (typecolumn == UINT_MAX) {
+        if (sel.typecolumn == UINT_MAX) {
             megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_ERROR,
                 "Failed to parse type column selection: %s\n", typecolname.PeekBuffer());
         }
@@ -1548,76 +1584,96 @@ bool IMDAtomDataSource::readData(
         // 1. exact match
         for (SIZE_T i = 0; i < header.captions.Count(); i++) {
             if (header.captions[i].Equals(colcolname)) {
-                colcolumn = static_cast<unsigned int>(i);
+                sel.colcolumn = static_cast<unsigned int>(i);
                 break;
             }
         }
 
-        if (colcolumn == UINT_MAX) {
+        if (sel.colcolumn == UINT_MAX) {
             // 2. caseless match
             for (SIZE_T i = 0; i < header.captions.Count(); i++) {
                 if (header.captions[i].Equals(colcolname, false)) {
-                    colcolumn = static_cast<unsigned int>(i);
+                    sel.colcolumn = static_cast<unsigned int>(i);
                     break;
                 }
             }
         }
 
-        if (colcolumn == UINT_MAX) {
+        if (sel.colcolumn == UINT_MAX) {
             // 3. index
             try {
-                colcolumn = vislib::CharTraitsA::ParseInt(colcolname);
-                if (colcolumn >= static_cast<unsigned int>(header.captions.Count())) {
+                sel.colcolumn = vislib::CharTraitsA::ParseInt(colcolname);
+                if (sel.colcolumn >= static_cast<unsigned int>(header.captions.Count())) {
                     megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_ERROR,
-                        "The parsed colouring column index is out of range (%u not in 0..%d)\n", colcolumn,
+                        "The parsed colouring column index is out of range (%u not in 0..%d)\n", sel.colcolumn,
                         static_cast<int>(header.captions.Count()) - 1);
-                    colcolumn = UINT_MAX;
+                    sel.colcolumn = UINT_MAX;
                 }
-            } catch (...) { colcolumn = UINT_MAX; }
+            } catch (...) { sel.colcolumn = UINT_MAX; }
         }
 
-        if (colcolumn == UINT_MAX) {
+        if (sel.colcolumn == UINT_MAX) {
             megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_ERROR,
                 "Failed to parse colour column selection: %s\n", colcolname.PeekBuffer());
         }
     }
 
-    if (dircolMode == 1) {
+    if (sel.dircolMode == 1) {
         // column colouring mode
         vislib::StringA dircolcolname(this->dircolourColumnSlot.Param<core::param::StringParam>()->Value().c_str());
         // 1. exact match
         for (SIZE_T i = 0; i < header.captions.Count(); i++) {
             if (header.captions[i].Equals(dircolcolname)) {
-                dircolcolumn = static_cast<unsigned int>(i);
+                sel.dircolcolumn = static_cast<unsigned int>(i);
                 break;
             }
         }
-        if (dircolcolumn == UINT_MAX) {
+        if (sel.dircolcolumn == UINT_MAX) {
             // 2. caseless match
             for (SIZE_T i = 0; i < header.captions.Count(); i++) {
                 if (header.captions[i].Equals(dircolcolname, false)) {
-                    dircolcolumn = static_cast<unsigned int>(i);
+                    sel.dircolcolumn = static_cast<unsigned int>(i);
                     break;
                 }
             }
         }
-        if (dircolcolumn == UINT_MAX) {
+        if (sel.dircolcolumn == UINT_MAX) {
             // 3. index
             try {
-                dircolcolumn = vislib::CharTraitsA::ParseInt(dircolcolname);
-                if (dircolcolumn >= static_cast<unsigned int>(header.captions.Count())) {
+                sel.dircolcolumn = vislib::CharTraitsA::ParseInt(dircolcolname);
+                if (sel.dircolcolumn >= static_cast<unsigned int>(header.captions.Count())) {
                     megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_ERROR,
-                        "The parsed dir colouring column index is out of range (%u not in 0..%d)\n", dircolcolumn,
+                        "The parsed dir colouring column index is out of range (%u not in 0..%d)\n", sel.dircolcolumn,
                         static_cast<int>(header.captions.Count()) - 1);
-                    dircolcolumn = UINT_MAX;
+                    sel.dircolcolumn = UINT_MAX;
                 }
-            } catch (...) { dircolcolumn = UINT_MAX; }
+            } catch (...) { sel.dircolcolumn = UINT_MAX; }
         }
-        if (dircolcolumn == UINT_MAX) {
+        if (sel.dircolcolumn == UINT_MAX) {
             megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_ERROR,
                 "Failed to parse dir colour column selection: %s\n", dircolcolname.PeekBuffer());
         }
     }
+}
+
+
+/*
+ * IMDAtomDataSource::readData
+ */
+template<typename T>
+void IMDAtomDataSource::readData(
+    T& reader, const IMDAtomDataSource::HeaderData& header, const ColumnSelection& sel, AtomBlock& block) {
+    bool fail = false;
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+    float c = 0.0f, dc = 0.0f, t = 0.0f;
+    float dx = 0.0f, dy = 0.0f, dz = 0.0f;
+    unsigned int column;
+    const unsigned int colcolumn = sel.colcolumn;
+    const unsigned int dircolcolumn = sel.dircolcolumn;
+    const unsigned int typecolumn = sel.typecolumn;
+    const unsigned int dirXCol = sel.dirXCol;
+    const unsigned int dirYCol = sel.dirYCol;
+    const unsigned int dirZCol = sel.dirZCol;
 
     while (!fail) {
         column = 0;
@@ -1768,81 +1824,68 @@ bool IMDAtomDataSource::readData(
 
         if (!fail) {
 
-            if (this->bboxEnabledSlot.Param<core::param::BoolParam>()->Value()) {
-                vislib::math::Vector<float, 3> p(x, y, z),
-                    minP(this->bboxMinSlot.Param<core::param::Vector3fParam>()->Value()),
-                    maxP(this->bboxMaxSlot.Param<core::param::Vector3fParam>()->Value());
-                if ((p.GetX() < minP.GetX() || p.GetY() < minP.GetY() || p.GetZ() < minP.GetZ()) ||
-                    (p.GetX() > maxP.GetX() || p.GetY() > maxP.GetY() || p.GetZ() > maxP.GetZ()))
+            if (sel.bboxEnabled) {
+                if ((x < sel.bboxMin.GetX() || y < sel.bboxMin.GetY() || z < sel.bboxMin.GetZ()) ||
+                    (x > sel.bboxMax.GetX() || y > sel.bboxMax.GetY() || z > sel.bboxMax.GetZ()))
                     continue;
             }
 
-
-            int rawIdx = 0;
-            if ((rawIdx = static_cast<int>(typeData.IndexOf(static_cast<unsigned int>(t)))) ==
-                static_cast<int>(vislib::Array<unsigned int>::INVALID_POS)) {
-                typeData.Append(static_cast<unsigned int>(t));
-                rawIdx = static_cast<int>(typeData.Count() - 1);
-                this->posData.Append(new vislib::RawStorage());
-                this->colData.Append(new vislib::RawStorage());
-                this->allDirData.Append(new vislib::RawStorage());
-                this->minC.Append(0.0f);
-                this->maxC.Append(1.0f);
-                posWriters.Append(new vislib::RawStorageWriter(*(this->posData[rawIdx]), 0, 0, 10 * 1024 * 1024));
-                colWriters.Append(new vislib::RawStorageWriter(*(this->colData[rawIdx]), 0, 0, 10 * 1024 * 1024));
-                dirWriters.Append(new vislib::RawStorageWriter(*(this->allDirData[rawIdx]), 0, 0, 10 * 1024 * 1024));
-            }
-
-            if (!first) {
-                if (this->minX > x)
-                    this->minX = x;
-                else if (this->maxX < x)
-                    this->maxX = x;
-                if (this->minY > y)
-                    this->minY = y;
-                else if (this->maxY < y)
-                    this->maxY = y;
-                if (this->minZ > z)
-                    this->minZ = z;
-                else if (this->maxZ < z)
-                    this->maxZ = z;
+            const unsigned int rawIdx = block.TypeIndex(static_cast<unsigned int>(t));
+            std::vector<float>& posOut = block.pos[rawIdx];
+            std::vector<float>& colOut = block.col[rawIdx];
+            std::vector<float>& dirOut = block.dir[rawIdx];
+
+            if (!block.first) {
+                if (block.minX > x)
+                    block.minX = x;
+                else if (block.maxX < x)
+                    block.maxX = x;
+                if (block.minY > y)
+                    block.minY = y;
+                else if (block.maxY < y)
+                    block.maxY = y;
+                if (block.minZ > z)
+                    block.minZ = z;
+                else if (block.maxZ < z)
+                    block.maxZ = z;
             } else {
-                first = false;
-                this->minX = this->maxX = x;
-                this->minY = this->maxY = y;
-                this->minZ = this->maxZ = z;
-                this->minC[rawIdx] = this->maxC[rawIdx] = c;
+                block.first = false;
+                block.minX = block.maxX = x;
+                block.minY = block.maxY = y;
+                block.minZ = block.maxZ = z;
+                block.firstC = c;
+                block.firstType = rawIdx;
             }
             if (colcolumn != UINT_MAX) {
-                if (this->minC[rawIdx] > c)
-                    this->minC[rawIdx] = c;
-                else if (this->maxC[rawIdx] < c)
-                    this->maxC[rawIdx] = c;
+                if (block.minC[rawIdx] > c)
+                    block.minC[rawIdx] = c;
+                if (block.maxC[rawIdx] < c)
+                    block.maxC[rawIdx] = c;
             }
             if (dircolcolumn != UINT_MAX) {
-                if (this->minC[rawIdx] > dc)
-                    this->minC[rawIdx] = dc;
-                else if (this->maxC[rawIdx] < dc)
-                    this->maxC[rawIdx] = dc;
+                if (block.minC[rawIdx] > dc)
+                    block.minC[rawIdx] = dc;
+                if (block.maxC[rawIdx] < dc)
+                    block.maxC[rawIdx] = dc;
             }
 
-            if (loadDir) {
-                if (normaliseDir) {
+            if (sel.loadDir) {
+                if (sel.normaliseDir) {
                     vislib::math::Vector<float, 3> dv(dx, dy, dz);
                     dv.Normalise();
                     dx = dv.X();
                     dy = dv.Y();
                     dz = dv.Z();
                 }
-                if (splitDir && vislib::math::IsEqual(dx, 0.0f) && vislib::math::IsEqual(dy, 0.0f) &&
+                if (sel.splitDir && vislib::math::IsEqual(dx, 0.0f) && vislib::math::IsEqual(dy, 0.0f) &&
                     vislib::math::IsEqual(dz, 0.0f)) {
-                    *posWriters[rawIdx] << x << y << z;
+                    posOut.insert(posOut.end(), {x, y, z});
                     if (colcolumn != UINT_MAX)
-                        *colWriters[rawIdx] << c;
+                        colOut.push_back(c);
                     // TODO type column??? vermutlich net
                 } else {
-                    *dirWriters[rawIdx] << x << y << z;
-                    if (dircolMode == 2) {
+                    dirOut.insert(dirOut.end(), {x, y, z});
+                    if (sel.dircolMode == 2) {
                         vislib::math::Vector<float, 3> dv(dx, dy, dz);
                         dv.Normalise();
                         float xr = 1.0f, xg = 0.0f, xb = 0.0f, yr = 0.0f, yg = 1.0f, yb = 0.0f, zr = 0.0f, zg = 0.0f,
@@ -1864,41 +1907,129 @@ bool IMDAtomDataSource::readData(
                         }
                         dv.Set(dv.X() * dv.X(), dv.Y() * dv.Y(), dv.Z() * dv.Z());
 
-                        *dirWriters[rawIdx] << (xr * dv.X() + yr * dv.Y() + zr * dv.Z());
-                        *dirWriters[rawIdx] << (xg * dv.X() + yg * dv.Y() + zg * dv.Z());
-                        *dirWriters[rawIdx] << (xb * dv.X() + yb * dv.Y() + zb * dv.Z());
+                        dirOut.push_back(xr * dv.X() + yr * dv.Y() + zr * dv.Z());
+                        dirOut.push_back(xg * dv.X() + yg * dv.Y() + zg * dv.Z());
+                        dirOut.push_back(xb * dv.X() + yb * dv.Y() + zb * dv.Z());
 
                     } else if (dircolcolumn != UINT_MAX)
-                        *dirWriters[rawIdx] << dc;
+                        dirOut.push_back(dc);
                     else if (colcolumn != UINT_MAX)
-                        *dirWriters[rawIdx] << c;
-                    *dirWriters[rawIdx] << dx << dy << dz;
+                        dirOut.push_back(c);
+                    dirOut.insert(dirOut.end(), {dx, dy, dz});
                 }
             } else {
-                *posWriters[rawIdx] << x << y << z;
+                posOut.insert(posOut.end(), {x, y, z});
                 if (colcolumn != UINT_MAX)
-                    *colWriters[rawIdx] << c;
+                    colOut.push_back(c);
             }
         }
     }
+}
+
 
-    if (!first) {
-        for (int i = 0; i < static_cast<int>(posData.Count()); i++) {
-            this->posData[i]->EnforceSize(posWriters[i]->End(), true);
-            this->colData[i]->EnforceSize(colWriters[i]->End(), true);
-            this->allDirData[i]->EnforceSize(dirWriters[i]->End(), true);
+/*
+ * IMDAtomDataSource::storeData
+ */
+bool IMDAtomDataSource::storeData(std::vector<AtomBlock>& blocks) {
+    this->typeData.Clear();
+    this->minC.Clear();
+    this->maxC.Clear();
+    this->posData.Clear();
+    this->colData.Clear();
+    this->allDirData.Clear();
+
+    // blocks behind a malformed value are dropped, as reading a file stops there
+    size_t blockCnt = 0;
+    while (blockCnt < blocks.size()) {
+        if (blocks[blockCnt++].malformed) {
+            megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_WARN,
+                "IMD atom data contains a malformed value, ignoring the remaining atoms\n");
+            break;
         }
-    } else {
-        for (int i = 0; i < static_cast<int>(posData.Count()); i++) {
-            this->posData[i]->EnforceSize(0, true);
-            this->colData[i]->EnforceSize(0, true);
-            this->allDirData[i]->EnforceSize(0, true);
+    }
+
+    bool first = true;
+    std::vector<size_t> posSize, colSize, dirSize;
+    std::vector<std::vector<unsigned int>> rawIdx(blockCnt);
+    for (size_t b = 0; b < blockCnt; b++) {
+        const AtomBlock& block = blocks[b];
+        for (size_t i = 0; i < block.types.size(); i++) {
+            INT_PTR idx = this->typeData.IndexOf(block.types[i]);
+            if (idx == vislib::Array<unsigned int>::INVALID_POS) {
+                idx = static_cast<INT_PTR>(this->typeData.Count());
+                this->typeData.Append(block.types[i]);
+                this->posData.Append(new vislib::RawStorage());
+                this->colData.Append(new vislib::RawStorage());
+                this->allDirData.Append(new vislib::RawStorage());
+                this->minC.Append(0.0f);
+                this->maxC.Append(1.0f);
+                posSize.push_back(0);
+                colSize.push_back(0);
+                dirSize.push_back(0);
+            }
+            rawIdx[b].push_back(static_cast<unsigned int>(idx));
+            posSize[idx] += block.pos[i].size();
+            colSize[idx] += block.col[i].size();
+            dirSize[idx] += block.dir[i].size();
         }
+        if (block.first)
+            continue;
+
+        if (first) {
+            first = false;
+            this->minX = block.minX;
+            this->minY = block.minY;
+            this->minZ = block.minZ;
+            this->maxX = block.maxX;
+            this->maxY = block.maxY;
+            this->maxZ = block.maxZ;
+            this->minC[rawIdx[b][block.firstType]] = this->maxC[rawIdx[b][block.firstType]] = block.firstC;
+        } else {
+            this->minX = vislib::math::Min(this->minX, block.minX);
+            this->minY = vislib::math::Min(this->minY, block.minY);
+            this->minZ = vislib::math::Min(this->minZ, block.minZ);
+            this->maxX = vislib::math::Max(this->maxX, block.maxX);
+            this->maxY = vislib::math::Max(this->maxY, block.maxY);
+            this->maxZ = vislib::math::Max(this->maxZ, block.maxZ);
+        }
+        for (size_t i = 0; i < block.types.size(); i++) {
+            unsigned int idx = rawIdx[b][i];
+            this->minC[idx] = vislib::math::Min(this->minC[idx], block.minC[i]);
+            this->maxC[idx] = vislib::math::Max(this->maxC[idx], block.maxC[i]);
+        }
+    }
+
+    if (first) {
+        return false;
+    }
+
+    for (SIZE_T i = 0; i < this->typeData.Count(); i++) {
+        this->posData[i]->EnforceSize(posSize[i] * sizeof(float));
+        this->colData[i]->EnforceSize(colSize[i] * sizeof(float));
+        this->allDirData[i]->EnforceSize(dirSize[i] * sizeof(float));
+        posSize[i] = colSize[i] = dirSize[i] = 0;
     }
-    return !first;
+    auto const append = [](vislib::RawStorage& dst, size_t& offset, std::vector<float>& src) {
+        if (!src.empty()) {
+            ::memcpy(dst.As<float>() + offset, src.data(), src.size() * sizeof(float));
+            offset += src.size();
+        }
+        std::vector<float>().swap(src);
+    };
+    for (size_t b = 0; b < blockCnt; b++) {
+        AtomBlock& block = blocks[b];
+        for (size_t i = 0; i < block.types.size(); i++) {
+            unsigned int idx = rawIdx[b][i];
+            append(*this->posData[idx], posSize[idx], block.pos[i]);
+            append(*this->colData[idx], colSize[idx], block.col[i]);
+            append(*this->allDirData[idx], dirSize[idx], block.dir[i]);
+        }
+    }
+
+    return true;
 }
 
-// TODO das ist eigentlich kruscht, das sollte wenn dann ein region-filter sein, aber na gut...
+
 /*
  * IMDAtomDataSource::posXFilterUpdate
  */
@@ -20,6 +20,8 @@
 #include "vislib/RawStorageWriter.h"
 #include "vislib/String.h"
 #include "vislib/sys/File.h"
+#include <string_view>
+#include <vector>
 
 
 namespace megamol {
@@ -163,15 +165,22 @@ private:
      */
     void assertData(void);
 
+    /** The data columns selected by the parameters, see selectColumns */
+    struct ColumnSelection;
+
+    /** The atoms read from a part of the file, see readData */
+    struct AtomBlock;
+
     /**
      * Reads the header of the imd file.
      *
-     * @param file The file object to read from
+     * @param text The text of the file
      * @param header The struct receiving the data
+     * @param dataOffset Receives the offset of the atom data in the file
      *
      * @return 'true' on success
      */
-    bool readHeader(vislib::sys::File& file, HeaderData& header);
+    bool readHeader(std::string_view text, HeaderData& header, size_t& dataOffset);
 
     // TODO: document
     // read a value and ADVANCE column
@@ -181,25 +190,42 @@ private:
     void readToFloatColumn(T& reader, bool& fail, unsigned int* column, ...);
 
     /**
-     * Reads the data of the imd file. This method also calculated the
-     * data bounding box and sets the corresponding members.
+     * Resolves the type, colour and direction columns selected by the
+     * parameters. The parameters are evaluated once, so that the data can
+     * be read in parallel afterwards.
      *
-     * Use a imdinternal::AtomReader* class as template type.
-     *
-     * @param file The file object to read from
      * @param header The struct holding the header data
-     * @param pos The writer receiving the read position data
-     * @param col The writer receiving the read colour data
-     * @param dir The writer receiving all directed particle data
-     * @param loadDir Flag to activate the use of 'dir'
+     * @param loadDir Flag to activate loading directed particles
      * @param splitDir Particles with direction NULL vector will be stored
-     *                 in pos and col, while all others will be stored in
-     *                 dir if (loadDir==true)
+     *                 as undirected particles if (loadDir==true)
+     * @param sel The struct receiving the selection
+     */
+    void selectColumns(const HeaderData& header, bool loadDir, bool splitDir, ColumnSelection& sel);
+
+    /**
+     * Reads atoms until the reader fails. Does not change any member, so
+     * different parts of a file can be read concurrently.
      *
-     * @return 'true' on success
+     * Use a AtomReader* class as template type.
+     *
+     * @param reader The reader to read from
+     * @param header The struct holding the header data
+     * @param sel The selected columns
+     * @param block The block receiving the atoms
      */
     template<typename T>
-    bool readData(vislib::sys::File& file, const HeaderData& header, bool loadDir, bool splitDir);
+    void readData(T& reader, const HeaderData& header, const ColumnSelection& sel, AtomBlock& block);
+
+    /**
+     * Concatenates the blocks in file order into the data members and
+     * calculates the data bounding box. Blocks behind the first malformed
+     * one are dropped.
+     *
+     * @param blocks The blocks read from the file
+     *
+     * @return 'true' if any atom was read
+     */
+    bool storeData(std::vector<AtomBlock>& blocks);
 
     /**
      * Updates the posX filter data (decrese only!)
@@ -0,0 +1,778 @@
+/*
+ * MMPLDCodec.cpp
+ *
+ * Copyright (C) 2022 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#include "MMPLDCodec.h"
+#include "mmcore/utility/TaskScheduler.h"
+#include "stdafx.h"
+#include "vislib/assert.h"
+
+#include "zlib.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace megamol::moldyn::io {
+
+namespace {
+
+/** size of the frame header of version 1.3: timestamp and list count */
+constexpr SIZE_T FRAME_HEADER_SIZE = 4 + 4;
+
+/** size of the frame header of version 2.0: timestamp, list count, keyframe distance and decoded size */
+constexpr SIZE_T ENCODED_FRAME_HEADER_SIZE = 4 + 4 + 4 + 8;
+
+/** size of the codec fields behind a list header without quantization box and payload size */
+constexpr SIZE_T CODEC_FIELDS_SIZE = 4;
+
+/** chunk size for zlib, whose counters are 32 bit */
+constexpr size_t ZLIB_CHUNK = static_cast<size_t>(1) << 30;
+
+/** A list of a frame in the version 1.3 layout */
+struct ListLayout {
+    UINT8 vertType = 0;
+    UINT8 colType = 0;
+    UINT64 count = 0;
+    unsigned int vertSize = 0;
+    unsigned int colSize = 0;
+
+    /** offset and size of the list header */
+    SIZE_T header = 0;
+    SIZE_T headerSize = 0;
+};
+
+
+/*
+ * parseListHeader
+ */
+bool parseListHeader(const uint8_t* data, SIZE_T size, SIZE_T& p, ListLayout& list) {
+    list.header = p;
+    if (p + 2 > size) {
+        return false;
+    }
+    list.vertType = data[p];
+    list.colType = data[p + 1];
+    p += 2;
+    if (list.vertType == 0) {
+        list.colType = 0;
+    }
+    list.vertSize = MMPLDCodec::VertexSize(list.vertType);
+    list.colSize = MMPLDCodec::ColourSize(list.colType);
+
+    SIZE_T fields = 8 + 24; // count and bounding box
+    if ((list.vertType == 1) || (list.vertType == 3) || (list.vertType == 4)) {
+        fields += 4; // global radius
+    }
+    if (list.colType == 0) {
+        fields += 4; // global colour
+    } else if ((list.colType == 3) || (list.colType == 7)) {
+        fields += 8; // colour index range
+    }
+    if (p + fields > size) {
+        return false;
+    }
+    ::memcpy(&list.count, data + p + fields - 32, 8);
+    p += fields;
+    list.headerSize = p - list.header;
+    return true;
+}
+
+
+/** Answer whether the positions of a vertex type can be quantized. */
+inline bool isQuantizable(UINT8 vertType) {
+    return (vertType == 1) || (vertType == 2) || (vertType == 4);
+}
+
+
+/** Answer the size of the encoded vertex data. */
+inline unsigned int encodedVertexSize(UINT8 vertType, UINT8 quantization) {
+    if (quantization == MMPLDCodec::QUANTIZE_16BIT) {
+        return (vertType == 2) ? 3 * 2 + 4 : 3 * 2;
+    }
+    return MMPLDCodec::VertexSize(vertType);
+}
+
+
+/** Reads the position of a record as double. */
+inline void readPosition(const uint8_t* record, UINT8 vertType, double* pos) {
+    if (vertType == 4) {
+        ::memcpy(pos, record, 3 * sizeof(double));
+    } else {
+        float f[3];
+        ::memcpy(f, record, 3 * sizeof(float));
+        pos[0] = f[0];
+        pos[1] = f[1];
+        pos[2] = f[2];
+    }
+}
+
+
+/*
+ * positionBounds
+ */
+void positionBounds(const uint8_t* records, UINT64 count, unsigned int stride, UINT8 vertType, double* box) {
+    for (int i = 0; i < 3; ++i) {
+        box[i] = std::numeric_limits<double>::max();
+        box[i + 3] = std::numeric_limits<double>::lowest();
+    }
+    double pos[3];
+    for (UINT64 i = 0; i < count; ++i) {
+        readPosition(records + i * stride, vertType, pos);
+        for (int j = 0; j < 3; ++j) {
+            box[j] = std::min(box[j], pos[j]);
+            box[j + 3] = std::max(box[j + 3], pos[j]);
+        }
+    }
+    if (count == 0) {
+        std::fill(box, box + 6, 0.0);
+    }
+}
+
+
+/*
+ * quantize
+ */
+void quantize(const uint8_t* records, UINT64 count, const ListLayout& list, const double* box, uint8_t* out) {
+    const unsigned int stride = list.vertSize + list.colSize;
+    const unsigned int encStride = encodedVertexSize(list.vertType, MMPLDCodec::QUANTIZE_16BIT) + list.colSize;
+    double scale[3];
+    for (int j = 0; j < 3; ++j) {
+        const double extent = box[j + 3] - box[j];
+        scale[j] = (extent > 0.0) ? 65535.0 / extent : 0.0;
+    }
+    double pos[3];
+    uint16_t q[3];
+    for (UINT64 i = 0; i < count; ++i) {
+        const uint8_t* src = records + i * stride;
+        uint8_t* dst = out + i * encStride;
+        readPosition(src, list.vertType, pos);
+        for (int j = 0; j < 3; ++j) {
+            const double v = (pos[j] - box[j]) * scale[j];
+            q[j] = static_cast<uint16_t>(std::lround(std::clamp(v, 0.0, 65535.0)));
+        }
+        ::memcpy(dst, q, 6);
+        if (list.vertType == 2) {
+            ::memcpy(dst + 6, src + 12, 4); // radius
+        }
+        ::memcpy(dst + encStride - list.colSize, src + list.vertSize, list.colSize);
+    }
+}
+
+
+/*
+ * dequantize
+ */
+void dequantize(const uint8_t* encoded, UINT64 count, const ListLayout& list, const double* box, uint8_t* out) {
+    const unsigned int stride = list.vertSize + list.colSize;
+    const unsigned int encStride = encodedVertexSize(list.vertType, MMPLDCodec::QUANTIZE_16BIT) + list.colSize;
+    double step[3];
+    for (int j = 0; j < 3; ++j) {
+        step[j] = (box[j + 3] - box[j]) / 65535.0;
+    }
+    uint16_t q[3];
+    for (UINT64 i = 0; i < count; ++i) {
+        const uint8_t* src = encoded + i * encStride;
+        uint8_t* dst = out + i * stride;
+        ::memcpy(q, src, 6);
+        if (list.vertType == 4) {
+            double pos[3];
+            for (int j = 0; j < 3; ++j) {
+                pos[j] = box[j] + q[j] * step[j];
+            }
+            ::memcpy(dst, pos, sizeof(pos));
+        } else {
+            float pos[3];
+            for (int j = 0; j < 3; ++j) {
+                pos[j] = static_cast<float>(box[j] + q[j] * step[j]);
+            }
+            ::memcpy(dst, pos, sizeof(pos));
+            if (list.vertType == 2) {
+                ::memcpy(dst + 12, src + 6, 4);
+            }
+        }
+        ::memcpy(dst + list.vertSize, src + encStride - list.colSize, list.colSize);
+    }
+}
+
+
+/*
+ * predict
+ *
+ * XORs the records with the reference records. With delta prediction, the leading 16 bit fields of the
+ * quantized positions are subtracted instead, as small motions then give small differences.
+ */
+void predict(uint8_t* records, const uint8_t* ref, UINT64 count, unsigned int stride, unsigned int deltaBytes,
+    bool inverse) {
+    for (UINT64 i = 0; i < count; ++i) {
+        uint8_t* r = records + i * stride;
+        const uint8_t* o = ref + i * stride;
+        for (unsigned int b = 0; b < deltaBytes; b += 2) {
+            uint16_t v, w;
+            ::memcpy(&v, r + b, 2);
+            ::memcpy(&w, o + b, 2);
+            v = inverse ? static_cast<uint16_t>(v + w) : static_cast<uint16_t>(v - w);
+            ::memcpy(r + b, &v, 2);
+        }
+        for (unsigned int b = deltaBytes; b < stride; ++b) {
+            r[b] ^= o[b];
+        }
+    }
+}
+
+
+/*
+ * shuffle
+ *
+ * Splits the records into byte planes, so the slowly changing high bytes of neighbouring records end up
+ * next to each other for the compressor.
+ */
+void shuffle(const uint8_t* records, UINT64 count, unsigned int stride, uint8_t* out) {
+    for (unsigned int b = 0; b < stride; ++b) {
+        uint8_t* plane = out + b * count;
+        for (UINT64 i = 0; i < count; ++i) {
+            plane[i] = records[i * stride + b];
+        }
+    }
+}
+
+
+/*
+ * unshuffle
+ */
+void unshuffle(const uint8_t* planes, UINT64 count, unsigned int stride, uint8_t* out) {
+    for (unsigned int b = 0; b < stride; ++b) {
+        const uint8_t* plane = planes + b * count;
+        for (UINT64 i = 0; i < count; ++i) {
+            out[i * stride + b] = plane[i];
+        }
+    }
+}
+
+
+/*
+ * deflateBuffer
+ *
+ * Answers false if the compressed data would not be smaller than the input.
+ */
+bool deflateBuffer(const uint8_t* src, size_t size, int level, std::vector<uint8_t>& out) {
+    z_stream zs;
+    ::memset(&zs, 0, sizeof(zs));
+    if (::deflateInit(&zs, level) != Z_OK) {
+        return false;
+    }
+    out.resize(size);
+    size_t inPos = 0, outPos = 0;
+    int ret = Z_OK;
+    while (ret != Z_STREAM_END) {
+        if ((zs.avail_in == 0) && (inPos < size)) {
+            const size_t n = std::min(ZLIB_CHUNK, size - inPos);
+            zs.next_in = const_cast<Bytef*>(src + inPos);
+            zs.avail_in = static_cast<uInt>(n);
+            inPos += n;
+        }
+        if (zs.avail_out == 0) {
+            const size_t n = std::min(ZLIB_CHUNK, out.size() - outPos);
+            if (n == 0) {
+                break; // not smaller than the input
+            }
+            zs.next_out = out.data() + outPos;
+            zs.avail_out = static_cast<uInt>(n);
+            outPos += n;
+        }
+        ret = ::deflate(&zs, ((inPos == size) && (zs.avail_in == 0)) ? Z_FINISH : Z_NO_FLUSH);
+        if ((ret != Z_OK) && (ret != Z_STREAM_END) && (ret != Z_BUF_ERROR)) {
+            break;
+        }
+    }
+    ::deflateEnd(&zs);
+    if (ret != Z_STREAM_END) {
+        return false;
+    }
+    out.resize(outPos - zs.avail_out);
+    return true;
+}
+
+
+/*
+ * inflateBuffer
+ */
+bool inflateBuffer(const uint8_t* src, size_t size, uint8_t* out, size_t outSize) {
+    z_stream zs;
+    ::memset(&zs, 0, sizeof(zs));
+    if (::inflateInit(&zs) != Z_OK) {
+        return false;
+    }
+    size_t inPos = 0, outPos = 0;
+    int ret = Z_OK;
+    while (ret != Z_STREAM_END) {
+        bool refilled = false;
+        if ((zs.avail_in == 0) && (inPos < size)) {
+            const size_t n = std::min(ZLIB_CHUNK, size - inPos);
+            zs.next_in = const_cast<Bytef*>(src + inPos);
+            zs.avail_in = static_cast<uInt>(n);
+            inPos += n;
+            refilled = true;
+        }
+        if ((zs.avail_out == 0) && (outPos < outSize)) {
+            const size_t n = std::min(ZLIB_CHUNK, outSize - outPos);
+            zs.next_out = out + outPos;
+            zs.avail_out = static_cast<uInt>(n);
+            outPos += n;
+            refilled = true;
+        }
+        ret = ::inflate(&zs, Z_NO_FLUSH);
+        if ((ret == Z_BUF_ERROR) && !refilled) {
+            break; // truncated or too long
+        }
+        if ((ret != Z_OK) && (ret != Z_STREAM_END) && (ret != Z_BUF_ERROR)) {
+            break;
+        }
+    }
+    ::inflateEnd(&zs);
+    return (ret == Z_STREAM_END) && (outPos - zs.avail_out == outSize);
+}
+
+/** Spreads the lower 21 bits of v such that two zero bits follow each bit. */
+inline UINT64 spreadBits(UINT64 v) {
+    v &= 0x1FFFFF;
+    v = (v | (v << 32)) & 0x1F00000000FFFFull;
+    v = (v | (v << 16)) & 0x1F0000FF0000FFull;
+    v = (v | (v << 8)) & 0x100F00F00F00F00Full;
+    v = (v | (v << 4)) & 0x10C30C30C30C30C3ull;
+    v = (v | (v << 2)) & 0x1249249249249249ull;
+    return v;
+}
+
+} // namespace
+
+
+/*
+ * MMPLDCodec::VertexSize
+ */
+unsigned int MMPLDCodec::VertexSize(UINT8 vertType) {
+    static const unsigned int sizes[] = {0, 12, 16, 6, 24};
+    return (vertType < 5) ? sizes[vertType] : 0;
+}
+
+
+/*
+ * MMPLDCodec::ColourSize
+ */
+unsigned int MMPLDCodec::ColourSize(UINT8 colType) {
+    static const unsigned int sizes[] = {0, 3, 4, 4, 12, 16, 8, 8};
+    return (colType < 8) ? sizes[colType] : 0;
+}
+
+
+/*
+ * MMPLDCodec::LodOrder
+ */
+std::vector<UINT64> MMPLDCodec::LodOrder(const void* vertices, unsigned int stride, UINT8 vertType, UINT64 count) {
+    auto position = [vertices, stride, vertType](UINT64 i, double* pos) {
+        const unsigned char* v = static_cast<const unsigned char*>(vertices) + i * stride;
+        for (int j = 0; j < 3; ++j) {
+            if (vertType == 4) {
+                double d;
+                ::memcpy(&d, v + j * sizeof(double), sizeof(double));
+                pos[j] = d;
+            } else if (vertType == 3) {
+                int16_t s;
+                ::memcpy(&s, v + j * sizeof(int16_t), sizeof(int16_t));
+                pos[j] = s;
+            } else {
+                float f;
+                ::memcpy(&f, v + j * sizeof(float), sizeof(float));
+                pos[j] = f;
+            }
+        }
+    };
+
+    double minPos[3], maxPos[3], pos[3];
+    position(0, minPos);
+    position(0, maxPos);
+    for (UINT64 i = 1; i < count; ++i) {
+        position(i, pos);
+        for (int j = 0; j < 3; ++j) {
+            minPos[j] = std::min(minPos[j], pos[j]);
+            maxPos[j] = std::max(maxPos[j], pos[j]);
+        }
+    }
+    double scale[3];
+    for (int j = 0; j < 3; ++j) {
+        scale[j] = (maxPos[j] > minPos[j]) ? static_cast<double>(0x1FFFFF) / (maxPos[j] - minPos[j]) : 0.0;
+    }
+
+    std::vector<std::pair<UINT64, UINT64>> codes(static_cast<size_t>(count));
+    core::utility::ParallelFor<UINT64>(0, count, 0, [&](UINT64 first, UINT64 last) {
+        double p[3];
+        for (UINT64 i = first; i < last; ++i) {
+            position(i, p);
+            UINT64 code = 0;
+            for (int j = 0; j < 3; ++j) {
+                code |= spreadBits(static_cast<UINT64>((p[j] - minPos[j]) * scale[j])) << j;
+            }
+            codes[i] = std::make_pair(code, i);
+        }
+    });
+    std::sort(codes.begin(), codes.end());
+
+    unsigned int levels = 0;
+    while ((static_cast<UINT64>(1) << levels) < count) {
+        ++levels;
+    }
+    std::vector<UINT64> order;
+    order.reserve(static_cast<size_t>(count));
+    for (UINT64 r = 0; r < (static_cast<UINT64>(1) << levels); ++r) {
+        UINT64 rank = 0;
+        for (unsigned int b = 0; b < levels; ++b) {
+            rank |= ((r >> b) & 1) << (levels - 1 - b);
+        }
+        if (rank < count) {
+            order.push_back(codes[rank].second);
+        }
+    }
+    return order;
+}
+
+
+/*
+ * MMPLDCodec::KeyframeDistance
+ */
+bool MMPLDCodec::KeyframeDistance(const void* data, SIZE_T size, UINT32& distance) {
+    if (size < ENCODED_FRAME_HEADER_SIZE) {
+        return false;
+    }
+    ::memcpy(&distance, static_cast<const uint8_t*>(data) + 8, 4);
+    return true;
+}
+
+
+/*
+ * MMPLDCodec::DecodedSize
+ */
+bool MMPLDCodec::DecodedSize(const void* data, SIZE_T size, UINT64& decodedSize) {
+    if (size < ENCODED_FRAME_HEADER_SIZE) {
+        return false;
+    }
+    ::memcpy(&decodedSize, static_cast<const uint8_t*>(data) + 12, 8);
+    return true;
+}
+
+
+/*
+ * MMPLDCodec::MMPLDCodec
+ */
+MMPLDCodec::MMPLDCodec(void) : reference(), hasReference(false), referenceDistance(0) {
+    // intentionally empty
+}
+
+
+/*
+ * MMPLDCodec::~MMPLDCodec
+ */
+MMPLDCodec::~MMPLDCodec(void) {
+    // intentionally empty
+}
+
+
+/*
+ * MMPLDCodec::Encode
+ */
+bool MMPLDCodec::Encode(
+    const void* frame, SIZE_T size, bool keyframe, const Settings& settings, vislib::RawStorage& outFrame) {
+    const uint8_t* data = static_cast<const uint8_t*>(frame);
+    if (size < FRAME_HEADER_SIZE) {
+        return false;
+    }
+    UINT32 listCnt;
+    ::memcpy(&listCnt, data + 4, 4);
+
+    std::vector<ListLayout> lists(listCnt);
+    std::vector<SIZE_T> records(listCnt);
+    SIZE_T p = FRAME_HEADER_SIZE;
+    for (UINT32 li = 0; li < listCnt; ++li) {
+        if (!parseListHeader(data, size, p, lists[li])) {
+            return false;
+        }
+        records[li] = p;
+        p += static_cast<SIZE_T>(lists[li].count * (lists[li].vertSize + lists[li].colSize));
+        if (p > size) {
+            return false;
+        }
+    }
+
+    const bool predicted = !keyframe && this->hasReference && (settings.Prediction != PREDICT_NONE);
+
+    struct EncodedList {
+        UINT8 compression = COMPRESSION_NONE;
+        UINT8 predictor = PREDICT_NONE;
+        std::vector<uint8_t> payload;
+    };
+    std::vector<EncodedList> encoded(listCnt);
+    std::vector<Reference> next(listCnt);
+
+    core::utility::ParallelFor<size_t>(0, listCnt, 1, [&](size_t first, size_t last) {
+        std::vector<uint8_t> work;
+        for (size_t li = first; li < last; ++li) {
+            const ListLayout& list = lists[li];
+            const uint8_t* src = data + records[li];
+            Reference& ref = next[li];
+            EncodedList& enc = encoded[li];
+            ref.vertType = list.vertType;
+            ref.colType = list.colType;
+            ref.count = list.count;
+            ref.quantization = (settings.QuantizePositions && isQuantizable(list.vertType)) ? QUANTIZE_16BIT
+                                                                                             : QUANTIZE_NONE;
+
+            const Reference* prev = nullptr;
+            if (predicted && (li < this->reference.size())) {
+                const Reference& r = this->reference[li];
+                if ((r.vertType == ref.vertType) && (r.colType == ref.colType) &&
+                    (r.quantization == ref.quantization) && (r.count == ref.count) && (r.count > 0)) {
+                    prev = &r;
+                }
+            }
+
+            const unsigned int stride = encodedVertexSize(list.vertType, ref.quantization) + list.colSize;
+            const size_t bytes = static_cast<size_t>(list.count * stride);
+            if (ref.quantization == QUANTIZE_16BIT) {
+                positionBounds(src, list.count, list.vertSize + list.colSize, list.vertType, ref.box);
+                // keeping the box of the previous frame keeps unmoved particles at the same quantized values
+                if ((prev != nullptr) && (prev->box[0] <= ref.box[0]) && (prev->box[1] <= ref.box[1]) &&
+                    (prev->box[2] <= ref.box[2]) && (prev->box[3] >= ref.box[3]) && (prev->box[4] >= ref.box[4]) &&
+                    (prev->box[5] >= ref.box[5])) {
+                    std::copy(prev->box, prev->box + 6, ref.box);
+                }
+                ref.records.resize(bytes);
+                quantize(src, list.count, list, ref.box, ref.records.data());
+            } else {
+                ref.records.assign(src, src + bytes);
+            }
+
+            work = ref.records;
+            if (prev != nullptr) {
+                // delta prediction only applies to quantized positions, other lists are stored as XOR predicted
+                enc.predictor = ((settings.Prediction == PREDICT_DELTA) && (ref.quantization != QUANTIZE_16BIT))
+                                    ? PREDICT_XOR
+                                    : settings.Prediction;
+                const unsigned int deltaBytes =
+                    ((enc.predictor == PREDICT_DELTA) && (ref.quantization == QUANTIZE_16BIT)) ? 6 : 0;
+                predict(work.data(), prev->records.data(), list.count, stride, deltaBytes, false);
+            }
+
+            enc.payload.resize(bytes);
+            shuffle(work.data(), list.count, stride, enc.payload.data());
+            if ((settings.CompressionLevel > 0) && (bytes > 0) &&
+                deflateBuffer(enc.payload.data(), bytes, settings.CompressionLevel, work)) {
+                enc.compression = COMPRESSION_DEFLATE;
+                enc.payload.swap(work);
+            }
+        }
+    });
+
+    bool anyPredicted = false;
+    SIZE_T outSize = ENCODED_FRAME_HEADER_SIZE;
+    for (UINT32 li = 0; li < listCnt; ++li) {
+        anyPredicted |= (encoded[li].predictor != PREDICT_NONE);
+        outSize += lists[li].headerSize + CODEC_FIELDS_SIZE + 8 + encoded[li].payload.size();
+        if (next[li].quantization != QUANTIZE_NONE) {
+            outSize += 6 * sizeof(double);
+        }
+    }
+    const UINT32 distance = anyPredicted ? this->referenceDistance + 1 : 0;
+    const UINT64 decodedSize = static_cast<UINT64>(p);
+
+    outFrame.EnforceSize(outSize);
+    uint8_t* out = outFrame.As<uint8_t>();
+    SIZE_T o = 0;
+    ::memcpy(out + o, data, 8); // timestamp and list count
+    o += 8;
+    ::memcpy(out + o, &distance, 4);
+    o += 4;
+    ::memcpy(out + o, &decodedSize, 8);
+    o += 8;
+    for (UINT32 li = 0; li < listCnt; ++li) {
+        ::memcpy(out + o, data + lists[li].header, lists[li].headerSize);
+        o += lists[li].headerSize;
+        const uint8_t fields[CODEC_FIELDS_SIZE] = {
+            encoded[li].compression, next[li].quantization, encoded[li].predictor, 0};
+        ::memcpy(out + o, fields, CODEC_FIELDS_SIZE);
+        o += CODEC_FIELDS_SIZE;
+        if (next[li].quantization != QUANTIZE_NONE) {
+            ::memcpy(out + o, next[li].box, 6 * sizeof(double));
+            o += 6 * sizeof(double);
+        }
+        const UINT64 payloadSize = encoded[li].payload.size();
+        ::memcpy(out + o, &payloadSize, 8);
+        o += 8;
+    }
+    for (UINT32 li = 0; li < listCnt; ++li) {
+        if (!encoded[li].payload.empty()) {
+            ::memcpy(out + o, encoded[li].payload.data(), encoded[li].payload.size());
+            o += encoded[li].payload.size();
+        }
+    }
+    ASSERT(o == outSize);
+
+    this->reference = std::move(next);
+    this->hasReference = true;
+    this->referenceDistance = distance;
+    return true;
+}
+
+
+/*
+ * MMPLDCodec::Decode
+ */
+bool MMPLDCodec::Decode(const void* data, SIZE_T size, vislib::RawStorage* outFrame) {
+    const uint8_t* in = static_cast<const uint8_t*>(data);
+    if (size < ENCODED_FRAME_HEADER_SIZE) {
+        return false;
+    }
+    UINT32 listCnt, distance;
+    UINT64 decodedSize;
+    ::memcpy(&listCnt, in + 4, 4);
+    ::memcpy(&distance, in + 8, 4);
+    ::memcpy(&decodedSize, in + 12, 8);
+    if ((distance > 0) && !this->hasReference) {
+        return false;
+    }
+
+    std::vector<ListLayout> lists(listCnt);
+    std::vector<Reference> next(listCnt);
+    std::vector<UINT8> compression(listCnt), predictor(listCnt);
+    std::vector<SIZE_T> payload(listCnt + 1);
+    std::vector<SIZE_T> records(listCnt);
+    SIZE_T p = ENCODED_FRAME_HEADER_SIZE;
+    SIZE_T o = FRAME_HEADER_SIZE;
+    for (UINT32 li = 0; li < listCnt; ++li) {
+        ListLayout& list = lists[li];
+        if (!parseListHeader(in, size, p, list) || (p + CODEC_FIELDS_SIZE + 8 > size)) {
+            return false;
+        }
+        compression[li] = in[p];
+        next[li].quantization = in[p + 1];
+        predictor[li] = in[p + 2];
+        p += CODEC_FIELDS_SIZE;
+        if ((compression[li] > COMPRESSION_DEFLATE) || (next[li].quantization > QUANTIZE_16BIT) ||
+            (predictor[li] > PREDICT_DELTA) ||
+            ((next[li].quantization != QUANTIZE_NONE) && !isQuantizable(list.vertType))) {
+            return false;
+        }
+        if (next[li].quantization != QUANTIZE_NONE) {
+            if (p + 6 * sizeof(double) + 8 > size) {
+                return false;
+            }
+            ::memcpy(next[li].box, in + p, 6 * sizeof(double));
+            p += 6 * sizeof(double);
+        }
+        UINT64 payloadSize;
+        ::memcpy(&payloadSize, in + p, 8);
+        p += 8;
+        payload[li + 1] = payload[li] + static_cast<SIZE_T>(payloadSize);
+
+        next[li].vertType = list.vertType;
+        next[li].colType = list.colType;
+        next[li].count = list.count;
+        if (predictor[li] != PREDICT_NONE) {
+            if (li >= this->reference.size()) {
+                return false;
+            }
+            const Reference& r = this->reference[li];
+            if ((r.vertType != list.vertType) || (r.colType != list.colType) ||
+                (r.quantization != next[li].quantization) || (r.count != list.count)) {
+                return false;
+            }
+        }
+
+        o += list.headerSize;
+        records[li] = o;
+        o += static_cast<SIZE_T>(list.count * (list.vertSize + list.colSize));
+    }
+    if ((p + payload[listCnt] > size) || (o != decodedSize)) {
+        return false;
+    }
+    for (UINT32 li = 0; li <= listCnt; ++li) {
+        payload[li] += p;
+    }
+
+    uint8_t* out = nullptr;
+    if (outFrame != nullptr) {
+        outFrame->EnforceSize(o);
+        out = outFrame->As<uint8_t>();
+        ::memcpy(out, in, 8); // timestamp and list count
+        for (UINT32 li = 0; li < listCnt; ++li) {
+            ::memcpy(out + records[li] - lists[li].headerSize, in + lists[li].header, lists[li].headerSize);
+        }
+    }
+
+    std::vector<char> ok(listCnt, 0);
+    core::utility::ParallelFor<size_t>(0, listCnt, 1, [&](size_t first, size_t last) {
+        std::vector<uint8_t> planes;
+        for (size_t li = first; li < last; ++li) {
+            const ListLayout& list = lists[li];
+            Reference& ref = next[li];
+            const unsigned int stride = encodedVertexSize(list.vertType, ref.quantization) + list.colSize;
+            const size_t bytes = static_cast<size_t>(list.count * stride);
+            const uint8_t* src = in + payload[li];
+            const size_t srcSize = payload[li + 1] - payload[li];
+
+            if (compression[li] == COMPRESSION_DEFLATE) {
+                planes.resize(bytes);
+                if (!inflateBuffer(src, srcSize, planes.data(), bytes)) {
+                    continue;
+                }
+                src = planes.data();
+            } else if (srcSize != bytes) {
+                continue;
+            }
+            ref.records.resize(bytes);
+            unshuffle(src, list.count, stride, ref.records.data());
+
+            if (predictor[li] != PREDICT_NONE) {
+                const unsigned int deltaBytes =
+                    ((predictor[li] == PREDICT_DELTA) && (ref.quantization == QUANTIZE_16BIT)) ? 6 : 0;
+                predict(ref.records.data(), this->reference[li].records.data(), list.count, stride, deltaBytes,
+                    true);
+            }
+
+            if (out != nullptr) {
+                if (ref.quantization == QUANTIZE_16BIT) {
+                    dequantize(ref.records.data(), list.count, list, ref.box, out + records[li]);
+                } else if (bytes > 0) {
+                    ::memcpy(out + records[li], ref.records.data(), bytes);
+                }
+            }
+            ok[li] = 1;
+        }
+    });
+
+    if (std::find(ok.begin(), ok.end(), 0) != ok.end()) {
+        this->Reset();
+        return false;
+    }
+
+    this->reference = std::move(next);
+    this->hasReference = true;
+    this->referenceDistance = distance;
+    return true;
+}
+
+
+/*
+ * MMPLDCodec::Reset
+ */
+void MMPLDCodec::Reset(void) {
+    this->reference.clear();
+    this->hasReference = false;
+    this->referenceDistance = 0;
+}
+
+
+} // namespace megamol::moldyn::io
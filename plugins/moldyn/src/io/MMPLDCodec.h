@@ -0,0 +1,186 @@
+/*
+ * MMPLDCodec.h
+ *
+ * Copyright (C) 2022 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include "vislib/RawStorage.h"
+#include "vislib/types.h"
+
+#include <cstdint>
+#include <vector>
+
+
+namespace megamol::moldyn::io {
+
+
+/**
+ * Encoder and decoder of the frames of MMPLD version 2.0 files.
+ *
+ * A version 2.0 frame holds the same particle lists as a version 1.3 frame, but the records of every list are
+ * stored as a separate payload behind all list headers:
+ *
+ *   float    timestamp
+ *   UINT32   number of lists
+ *   UINT32   keyframe distance, 0 for keyframes, n if the frame refers to its predecessor and the nearest keyframe
+ *            is n frames before it
+ *   UINT64   size of the frame in the version 1.3 layout
+ *   per list:
+ *     the list header of version 1.3 (types, global radius and colour, count, bounding box)
+ *     UINT8    compression (COMPRESSION_*)
+ *     UINT8    quantization (QUANTIZE_*)
+ *     UINT8    predictor (PREDICT_*)
+ *     UINT8    reserved, 0
+ *     double   quantization box (6 values, only if quantized)
+ *     UINT64   size of the payload
+ *   the payloads of all lists
+ *
+ * A payload holds the encoded records of a list: the positions optionally quantized to 16 bit relative to the
+ * quantization box, XOR or delta encoded against the encoded records of the same list in the previous frame, split
+ * into byte planes and deflated. Lists can only be predicted if the list of the previous frame has the same types
+ * and count, otherwise they are stored on their own.
+ *
+ * Encoder and decoder keep the encoded records of the previous frame as reference, so frames have to be passed in
+ * order starting at a keyframe. The lists of a frame are encoded and decoded in parallel.
+ */
+class MMPLDCodec {
+public:
+    /** The compression of the payloads */
+    enum Compression : uint8_t { COMPRESSION_NONE = 0, COMPRESSION_DEFLATE = 1 };
+
+    /** The representation of the positions */
+    enum Quantization : uint8_t { QUANTIZE_NONE = 0, QUANTIZE_16BIT = 1 };
+
+    /**
+     * The temporal prediction of the records. PREDICT_DELTA subtracts the quantized positions and XORs the remaining
+     * fields, so it requires QUANTIZE_16BIT. Lists without quantized positions are encoded and marked as PREDICT_XOR
+     * instead.
+     */
+    enum Predictor : uint8_t { PREDICT_NONE = 0, PREDICT_XOR = 1, PREDICT_DELTA = 2 };
+
+    /** The parameters of the encoder */
+    struct Settings {
+        /** zlib compression level, 0 stores the payloads uncompressed */
+        int CompressionLevel = 1;
+
+        /** whether float and double positions are quantized to 16 bit */
+        bool QuantizePositions = false;
+
+        /** the prediction from the previous frame, PREDICT_DELTA falls back to PREDICT_XOR without quantization */
+        Predictor Prediction = PREDICT_XOR;
+    };
+
+    /**
+     * Answer the size of the vertex data of a version 1.3 vertex type.
+     *
+     * @param vertType The vertex type.
+     *
+     * @return The size in bytes.
+     */
+    static unsigned int VertexSize(UINT8 vertType);
+
+    /**
+     * Answer the size of the colour data of a version 1.3 colour type.
+     *
+     * @param colType The colour type.
+     *
+     * @return The size in bytes.
+     */
+    static unsigned int ColourSize(UINT8 colType);
+
+    /**
+     * Answers the order in which the particles of a list are stored for progressive loading. The particles are
+     * sorted along a Morton curve in their bounds and taken at bit-reversed ranks, so for every k the first 2^k
+     * particles are spread evenly over the curve, and every prefix of the list is a spatially stratified subsample.
+     *
+     * @param vertices The vertex data of the list.
+     * @param stride The distance between two vertices in bytes.
+     * @param vertType The version 1.3 vertex type, must not be 0.
+     * @param count The number of particles, at least 1.
+     *
+     * @return The indices of the particles in storage order.
+     */
+    static std::vector<UINT64> LodOrder(const void* vertices, unsigned int stride, UINT8 vertType, UINT64 count);
+
+    /**
+     * Reads the keyframe distance of an encoded frame.
+     *
+     * @param data The encoded frame.
+     * @param size The size of the encoded frame.
+     * @param distance Receives the keyframe distance.
+     *
+     * @return 'true' on success, 'false' if the frame is too small.
+     */
+    static bool KeyframeDistance(const void* data, SIZE_T size, UINT32& distance);
+
+    /**
+     * Reads the size of the decoded frame from an encoded frame.
+     *
+     * @param data The encoded frame.
+     * @param size The size of the encoded frame.
+     * @param decodedSize Receives the size of the frame in the version 1.3 layout.
+     *
+     * @return 'true' on success, 'false' if the frame is too small.
+     */
+    static bool DecodedSize(const void* data, SIZE_T size, UINT64& decodedSize);
+
+    /** Ctor. */
+    MMPLDCodec(void);
+
+    /** Dtor. */
+    ~MMPLDCodec(void);
+
+    /**
+     * Encodes a frame given in the version 1.3 layout.
+     *
+     * @param frame The frame in the version 1.3 layout.
+     * @param size The size of the frame.
+     * @param keyframe Whether the frame has to be stored without reference to the previous frame.
+     * @param settings The parameters of the encoder.
+     * @param outFrame Receives the encoded frame.
+     *
+     * @return 'true' on success, 'false' if the frame is malformed.
+     */
+    bool Encode(const void* frame, SIZE_T size, bool keyframe, const Settings& settings, vislib::RawStorage& outFrame);
+
+    /**
+     * Decodes a frame into the version 1.3 layout.
+     *
+     * @param data The encoded frame.
+     * @param size The size of the encoded frame.
+     * @param outFrame Receives the frame in the version 1.3 layout. If NULL, the frame only becomes the reference
+     *                 for the next one.
+     *
+     * @return 'true' on success, 'false' if the frame is malformed or refers to a frame that has not been decoded.
+     */
+    bool Decode(const void* data, SIZE_T size, vislib::RawStorage* outFrame);
+
+    /** Drops the reference frame, the next frame has to be a keyframe. */
+    void Reset(void);
+
+private:
+    /** A particle list of the reference frame */
+    struct Reference {
+        UINT8 vertType = 0;
+        UINT8 colType = 0;
+        UINT8 quantization = QUANTIZE_NONE;
+        UINT64 count = 0;
+        double box[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+        std::vector<uint8_t> records;
+    };
+
+    /** the lists of the previous frame */
+    std::vector<Reference> reference;
+
+    /** whether the reference holds a frame */
+    bool hasReference;
+
+    /** the keyframe distance of the reference frame */
+    UINT32 referenceDistance;
+};
+
+
+} // namespace megamol::moldyn::io
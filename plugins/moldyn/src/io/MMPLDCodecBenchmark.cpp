@@ -0,0 +1,326 @@
+/*
+ * MMPLDCodecBenchmark.cpp
+ *
+ * Copyright (C) 2022 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#include "MMPLDCodecBenchmark.h"
+#include "stdafx.h"
+
+#include "mmcore/param/BoolParam.h"
+#include "mmcore/param/EnumParam.h"
+#include "mmcore/param/FloatParam.h"
+#include "mmcore/param/IntParam.h"
+#include "mmcore/utility/log/Log.h"
+#include "vislib/RawStorage.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+using megamol::core::utility::log::Log;
+
+namespace megamol::moldyn::io {
+
+namespace {
+
+/** size of the list header of a list of float positions and optional RGBA colours, see MMPLDCodec.h */
+constexpr SIZE_T LIST_HEADER_SIZE = 2 + 4 + 8 + 24;
+
+/** size of the frame header of version 1.3 */
+constexpr SIZE_T FRAME_HEADER_SIZE = 4 + 4;
+
+} // namespace
+
+
+/*
+ * MMPLDCodecBenchmark::MMPLDCodecBenchmark
+ */
+MMPLDCodecBenchmark::MMPLDCodecBenchmark(void)
+        : core::job::AbstractThreadedJob()
+        , core::Module()
+        , particleCountSlot("particleCount", "number of particles")
+        , frameCountSlot("frameCount", "number of frames of the trajectory")
+        , motionSlot("motion", "maximum displacement of a particle per frame relative to the size of the domain")
+        , colourSlot("colour", "gives every particle an RGBA colour")
+        , compressionLevelSlot("compressionLevel", "The zlib compression level, 0 for none")
+        , quantizeSlot("quantizePositions", "Quantizes the positions to 16 bit within the list bounds")
+        , predictionSlot("prediction", "The prediction of frames from their previous frame")
+        , keyframeIntervalSlot("keyframeInterval", "The number of frames between two keyframes")
+        , lodOrderSlot("lodOrder", "Stores the particles in the level-of-detail order of MMPLDWriter")
+        , repetitionsSlot("repetitions", "number of timed runs") {
+
+    this->particleCountSlot << new core::param::IntParam(1000000, 1);
+    this->MakeSlotAvailable(&this->particleCountSlot);
+
+    this->frameCountSlot << new core::param::IntParam(32, 1);
+    this->MakeSlotAvailable(&this->frameCountSlot);
+
+    this->motionSlot << new core::param::FloatParam(0.001f, 0.0f, 1.0f);
+    this->MakeSlotAvailable(&this->motionSlot);
+
+    this->colourSlot << new core::param::BoolParam(true);
+    this->MakeSlotAvailable(&this->colourSlot);
+
+    this->compressionLevelSlot << new core::param::IntParam(1, 0, 9);
+    this->MakeSlotAvailable(&this->compressionLevelSlot);
+
+    this->quantizeSlot << new core::param::BoolParam(false);
+    this->MakeSlotAvailable(&this->quantizeSlot);
+
+    core::param::EnumParam* predPar = new core::param::EnumParam(MMPLDCodec::PREDICT_XOR);
+    predPar->SetTypePair(MMPLDCodec::PREDICT_NONE, "None");
+    predPar->SetTypePair(MMPLDCodec::PREDICT_XOR, "XOR");
+    predPar->SetTypePair(MMPLDCodec::PREDICT_DELTA, "Delta");
+    this->predictionSlot.SetParameter(predPar);
+    this->MakeSlotAvailable(&this->predictionSlot);
+
+    this->keyframeIntervalSlot << new core::param::IntParam(16, 1);
+    this->MakeSlotAvailable(&this->keyframeIntervalSlot);
+
+    this->lodOrderSlot << new core::param::BoolParam(false);
+    this->MakeSlotAvailable(&this->lodOrderSlot);
+
+    this->repetitionsSlot << new core::param::IntParam(3, 1);
+    this->MakeSlotAvailable(&this->repetitionsSlot);
+}
+
+
+/*
+ * MMPLDCodecBenchmark::~MMPLDCodecBenchmark
+ */
+MMPLDCodecBenchmark::~MMPLDCodecBenchmark(void) {
+    this->Release();
+}
+
+
+/*
+ * MMPLDCodecBenchmark::create
+ */
+bool MMPLDCodecBenchmark::create(void) {
+    // intentionally empty
+    return true;
+}
+
+
+/*
+ * MMPLDCodecBenchmark::release
+ */
+void MMPLDCodecBenchmark::release(void) {
+    // intentionally empty
+}
+
+
+/*
+ * MMPLDCodecBenchmark::Run
+ */
+DWORD MMPLDCodecBenchmark::Run(void* userData) {
+    const int repetitions = this->repetitionsSlot.Param<core::param::IntParam>()->Value();
+    const UINT32 keyframeInterval =
+        static_cast<UINT32>(std::max(1, this->keyframeIntervalSlot.Param<core::param::IntParam>()->Value()));
+
+    MMPLDCodec::Settings settings;
+    settings.CompressionLevel = this->compressionLevelSlot.Param<core::param::IntParam>()->Value();
+    settings.QuantizePositions = this->quantizeSlot.Param<core::param::BoolParam>()->Value();
+    settings.Prediction =
+        static_cast<MMPLDCodec::Predictor>(this->predictionSlot.Param<core::param::EnumParam>()->Value());
+
+    std::vector<std::vector<uint8_t>> frames;
+    double extent = 0.0;
+    this->generate(frames, extent);
+    UINT64 decodedBytes = 0;
+    for (const auto& f : frames) {
+        decodedBytes += f.size();
+    }
+    // any quantization box lies within the bounds of all frames, so its step is at most extent / 65535
+    const double tolerance = settings.QuantizePositions ? 0.5 * extent / 65535.0 + 1.0e-6 : 0.0;
+
+    Log::DefaultLog.WriteInfo("MMPLDCodecBenchmark: %u frames of %.1f MB", static_cast<unsigned int>(frames.size()),
+        frames.empty() ? 0.0 : frames.front().size() / (1024.0 * 1024.0));
+
+    double encodeTotal = 0.0, decodeTotal = 0.0;
+    int runs = 0;
+    bool success = true;
+    for (int rep = 0; (rep < repetitions) && success && !this->shouldTerminate(); rep++) {
+        MMPLDCodec encoder, decoder;
+        vislib::RawStorage encoded, decoded;
+        UINT64 encodedBytes = 0;
+        double encodeSeconds = 0.0, decodeSeconds = 0.0;
+        for (UINT32 i = 0; (i < frames.size()) && !this->shouldTerminate(); i++) {
+            auto start = std::chrono::steady_clock::now();
+            if (!encoder.Encode(frames[i].data(), frames[i].size(), (i % keyframeInterval) == 0, settings, encoded)) {
+                Log::DefaultLog.WriteError("MMPLDCodecBenchmark: unable to encode frame %u", i);
+                success = false;
+                break;
+            }
+            auto mid = std::chrono::steady_clock::now();
+            if (!decoder.Decode(encoded.As<void>(), encoded.GetSize(), &decoded)) {
+                Log::DefaultLog.WriteError("MMPLDCodecBenchmark: unable to decode frame %u", i);
+                success = false;
+                break;
+            }
+            auto end = std::chrono::steady_clock::now();
+            encodeSeconds += std::chrono::duration<double>(mid - start).count();
+            decodeSeconds += std::chrono::duration<double>(end - mid).count();
+            encodedBytes += encoded.GetSize();
+
+            if (!this->compare(frames[i], decoded.As<void>(), decoded.GetSize(), tolerance)) {
+                Log::DefaultLog.WriteError("MMPLDCodecBenchmark: frame %u differs after decoding", i);
+                success = false;
+                break;
+            }
+        }
+        if (!success || this->shouldTerminate()) {
+            break;
+        }
+        encodeTotal += encodeSeconds;
+        decodeTotal += decodeSeconds;
+        runs++;
+
+        const double mb = decodedBytes / (1024.0 * 1024.0);
+        Log::DefaultLog.WriteInfo("MMPLDCodecBenchmark: run %d: %.1f MB into %.1f MB (%.1f%%), encode %.1f MB/s, "
+                                  "decode %.1f MB/s",
+            rep, mb, encodedBytes / (1024.0 * 1024.0), 100.0 * encodedBytes / decodedBytes, mb / encodeSeconds,
+            mb / decodeSeconds);
+    }
+
+    if (runs > 0) {
+        const double mb = decodedBytes / (1024.0 * 1024.0) * runs;
+        Log::DefaultLog.WriteInfo("MMPLDCodecBenchmark: all frames match, encode %.1f MB/s, decode %.1f MB/s on "
+                                  "average over %d run(s)",
+            mb / encodeTotal, mb / decodeTotal, runs);
+    }
+    return success ? 0 : -1;
+}
+
+
+/*
+ * MMPLDCodecBenchmark::generate
+ */
+void MMPLDCodecBenchmark::generate(std::vector<std::vector<uint8_t>>& frames, double& extent) {
+    const UINT64 count = static_cast<UINT64>(this->particleCountSlot.Param<core::param::IntParam>()->Value());
+    const int frameCnt = this->frameCountSlot.Param<core::param::IntParam>()->Value();
+    const float motion = this->motionSlot.Param<core::param::FloatParam>()->Value();
+    const bool colour = this->colourSlot.Param<core::param::BoolParam>()->Value();
+    const bool lod = this->lodOrderSlot.Param<core::param::BoolParam>()->Value();
+
+    const UINT8 vertType = 1; // float xyz
+    const UINT8 colType = colour ? 2 : 0; // uint8 rgba or global colour
+    const unsigned int stride = MMPLDCodec::VertexSize(vertType) + MMPLDCodec::ColourSize(colType);
+
+    // fixed seed, so all runs and settings see the same trajectory
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> pos(0.0f, 1.0f);
+    std::uniform_real_distribution<float> step(-motion, motion);
+    std::uniform_int_distribution<int> rgb(0, 255);
+
+    std::vector<float> positions(count * 3);
+    std::generate(positions.begin(), positions.end(), [&]() { return pos(rng); });
+    std::vector<uint8_t> colours(colour ? count * 4 : 0);
+    std::generate(colours.begin(), colours.end(), [&]() { return static_cast<uint8_t>(rgb(rng)); });
+
+    // like MMPLDWriter, the order of the first frame is kept for all frames
+    std::vector<UINT64> order;
+    if (lod) {
+        order = MMPLDCodec::LodOrder(positions.data(), 12, vertType, count);
+    }
+
+    float lower[3] = {1.0f, 1.0f, 1.0f}, upper[3] = {0.0f, 0.0f, 0.0f};
+    frames.resize(frameCnt);
+    for (int f = 0; f < frameCnt; f++) {
+        if (f > 0) {
+            for (auto& p : positions) {
+                p = std::clamp(p + step(rng), 0.0f, 1.0f);
+            }
+        }
+        float bbox[6] = {1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f};
+        for (UINT64 i = 0; i < count; i++) {
+            for (int j = 0; j < 3; j++) {
+                bbox[j] = std::min(bbox[j], positions[i * 3 + j]);
+                bbox[j + 3] = std::max(bbox[j + 3], positions[i * 3 + j]);
+            }
+        }
+        for (int j = 0; j < 3; j++) {
+            lower[j] = std::min(lower[j], bbox[j]);
+            upper[j] = std::max(upper[j], bbox[j + 3]);
+        }
+
+        std::vector<uint8_t>& frame = frames[f];
+        frame.resize(FRAME_HEADER_SIZE + LIST_HEADER_SIZE + 4 + static_cast<SIZE_T>(count * stride));
+        uint8_t* p = frame.data();
+        const float timestamp = static_cast<float>(f);
+        const UINT32 listCnt = 1;
+        const float radius = 0.5f / std::cbrt(static_cast<float>(count));
+        const uint8_t globalColour[4] = {192, 192, 192, 255};
+        ::memcpy(p, &timestamp, 4);
+        ::memcpy(p + 4, &listCnt, 4);
+        p += FRAME_HEADER_SIZE;
+        p[0] = vertType;
+        p[1] = colType;
+        ::memcpy(p + 2, &radius, 4);
+        if (colour) {
+            ::memcpy(p + 6, &count, 8);
+            ::memcpy(p + 14, bbox, 24);
+            p += LIST_HEADER_SIZE;
+        } else {
+            ::memcpy(p + 6, globalColour, 4);
+            ::memcpy(p + 10, &count, 8);
+            ::memcpy(p + 18, bbox, 24);
+            p += LIST_HEADER_SIZE + 4;
+        }
+        for (UINT64 i = 0; i < count; i++) {
+            const UINT64 src = lod ? order[i] : i;
+            ::memcpy(p, &positions[src * 3], 12);
+            if (colour) {
+                ::memcpy(p + 12, &colours[src * 4], 4);
+            }
+            p += stride;
+        }
+        frame.resize(p - frame.data());
+    }
+
+    extent = std::max({upper[0] - lower[0], upper[1] - lower[1], upper[2] - lower[2], 0.0f});
+}
+
+
+/*
+ * MMPLDCodecBenchmark::compare
+ */
+bool MMPLDCodecBenchmark::compare(
+    const std::vector<uint8_t>& expected, const void* actual, SIZE_T size, double tolerance) const {
+    if (size != expected.size()) {
+        return false;
+    }
+    const uint8_t* a = static_cast<const uint8_t*>(actual);
+    if (tolerance <= 0.0) {
+        return ::memcmp(expected.data(), a, size) == 0;
+    }
+
+    // the headers and colours have to match exactly, the positions within the tolerance
+    const bool colour = expected[FRAME_HEADER_SIZE + 1] != 0;
+    const SIZE_T records = FRAME_HEADER_SIZE + LIST_HEADER_SIZE + (colour ? 0 : 4);
+    const unsigned int stride = colour ? 16 : 12;
+    if (::memcmp(expected.data(), a, records) != 0) {
+        return false;
+    }
+    for (SIZE_T p = records; p + stride <= size; p += stride) {
+        float e[3], d[3];
+        ::memcpy(e, expected.data() + p, 12);
+        ::memcpy(d, a + p, 12);
+        for (int j = 0; j < 3; j++) {
+            if (std::abs(static_cast<double>(e[j]) - d[j]) > tolerance) {
+                return false;
+            }
+        }
+        if (::memcmp(expected.data() + p + 12, a + p + 12, stride - 12) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+} // namespace megamol::moldyn::io
@@ -0,0 +1,130 @@
+/*
+ * MMPLDCodecBenchmark.h
+ *
+ * Copyright (C) 2022 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include "MMPLDCodec.h"
+#include "mmcore/Module.h"
+#include "mmcore/job/AbstractThreadedJob.h"
+#include "mmcore/param/ParamSlot.h"
+
+#include <vector>
+
+
+namespace megamol::moldyn::io {
+
+
+/**
+ * Round trip check and benchmark of the MMPLD 2.0 codec. A synthetic trajectory of randomly moving particles is
+ * encoded and decoded again with the codec settings of the parameters, optionally in the level-of-detail order of
+ * MMPLDWriter. Every decoded frame is compared to its input, exactly if the positions are not quantized and within
+ * half a quantization step otherwise. The compression ratio and the encode and decode throughput are logged.
+ */
+class MMPLDCodecBenchmark : public core::job::AbstractThreadedJob, public core::Module {
+public:
+    /**
+     * Answer the name of this module.
+     *
+     * @return The name of this module.
+     */
+    static const char* ClassName(void) {
+        return "MMPLDCodecBenchmark";
+    }
+
+    /**
+     * Answer a human readable description of this module.
+     *
+     * @return A human readable description of this module.
+     */
+    static const char* Description(void) {
+        return "Checks and times the MMPLD 2.0 codec on a synthetic trajectory";
+    }
+
+    /**
+     * Answers whether this module is available on the current system.
+     *
+     * @return 'true' if the module is available, 'false' otherwise.
+     */
+    static bool IsAvailable(void) {
+        return true;
+    }
+
+    /** Ctor. */
+    MMPLDCodecBenchmark(void);
+
+    /** Dtor. */
+    virtual ~MMPLDCodecBenchmark(void);
+
+protected:
+    /**
+     * Implementation of 'Create'.
+     *
+     * @return 'true' on success, 'false' otherwise.
+     */
+    virtual bool create(void);
+
+    /**
+     * Implementation of 'Release'.
+     */
+    virtual void release(void);
+
+    /**
+     * Perform the work of a thread.
+     *
+     * @param userData Unused.
+     *
+     * @return 0 on success, -1 if a frame did not survive the round trip.
+     */
+    virtual DWORD Run(void* userData);
+
+private:
+    /**
+     * Generates the trajectory in the version 1.3 layout.
+     *
+     * @param frames Receives the frames.
+     * @param extent Receives the largest extent of the positions over all frames.
+     */
+    void generate(std::vector<std::vector<uint8_t>>& frames, double& extent);
+
+    /**
+     * Compares a decoded frame to its input.
+     *
+     * @param expected The input frame.
+     * @param actual The decoded frame.
+     * @param size The size of the decoded frame.
+     * @param tolerance The allowed deviation of the positions.
+     *
+     * @return 'true' if the frames match.
+     */
+    bool compare(const std::vector<uint8_t>& expected, const void* actual, SIZE_T size, double tolerance) const;
+
+    core::param::ParamSlot particleCountSlot;
+
+    core::param::ParamSlot frameCountSlot;
+
+    /** the maximum displacement of a particle per frame relative to the size of the domain */
+    core::param::ParamSlot motionSlot;
+
+    /** whether the particles have an RGBA colour each */
+    core::param::ParamSlot colourSlot;
+
+    core::param::ParamSlot compressionLevelSlot;
+
+    core::param::ParamSlot quantizeSlot;
+
+    core::param::ParamSlot predictionSlot;
+
+    core::param::ParamSlot keyframeIntervalSlot;
+
+    /** whether the particles are stored in the level-of-detail order of MMPLDWriter */
+    core::param::ParamSlot lodOrderSlot;
+
+    core::param::ParamSlot repetitionsSlot;
+};
+
+
+} // namespace megamol::moldyn::io
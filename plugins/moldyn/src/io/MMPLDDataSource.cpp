@@ -17,6 +17,11 @@
 #include "vislib/String.h"
 #include "vislib/sys/FastFile.h"
 
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
 namespace megamol::moldyn::io {
 
 
@@ -28,6 +33,42 @@ namespace megamol::moldyn::io {
 // factor multiplied to the frame size for estimating the overhead to the pure data.
 #define CACHE_FRAME_FACTOR 1.15f
 
+namespace {
+
+/**
+ * Answer the size of the fields of a list header behind the vertex and colour type: global radius, global colour or
+ * colour index range, particle count and, since version 1.3, the bounding box.
+ */
+SIZE_T listFieldsSize(UINT8 vrtType, UINT8 colType, unsigned int version) {
+    SIZE_T size = 8;
+    if ((vrtType == 1) || (vrtType == 3) || (vrtType == 4)) {
+        size += 4;
+    }
+    if (colType == 0) {
+        size += 4;
+    } else if ((colType == 3) || (colType == 7)) {
+        size += 8;
+    }
+    if (version >= 103) {
+        size += 24;
+    }
+    return size;
+}
+
+
+/** Answer the offset of the particle count in the list header fields. */
+inline SIZE_T listCountOffset(UINT8 vrtType, UINT8 colType, unsigned int version) {
+    return listFieldsSize(vrtType, colType, version) - 8 - ((version >= 103) ? 24 : 0);
+}
+
+
+/** Answer the size of a particle record. */
+inline SIZE_T recordSize(UINT8 vrtType, UINT8 colType) {
+    return (vrtType == 0) ? 0 : MMPLDCodec::VertexSize(vrtType) + MMPLDCodec::ColourSize(colType);
+}
+
+} // namespace
+
 /*****************************************************************************/
 
 /*
@@ -49,11 +90,95 @@ MMPLDDataSource::Frame::~Frame() {
 /*
  * MMPLDDataSource::Frame::LoadFrame
  */
-bool MMPLDDataSource::Frame::LoadFrame(vislib::sys::File* file, unsigned int idx, UINT64 size, unsigned int version) {
+bool MMPLDDataSource::Frame::LoadFrame(vislib::sys::File* file, unsigned int idx, UINT64 size, unsigned int version,
+    LevelOfDetail const& lod, bool pkdSorted) {
     this->frame = idx;
     this->fileVersion = version;
+    // a prefix of a PKD-sorted list is not a PKD tree of its own
+    this->pkdSorted = pkdSorted && lod.IsFull();
     this->dat.EnforceSize(static_cast<SIZE_T>(size));
-    return (file->Read(this->dat, size) == size);
+    if (lod.IsFull() || (version == 101)) {
+        return (file->Read(this->dat, size) == size);
+    }
+
+    // read the list headers and the prefix of each list, the remaining particles are skipped in the file
+    auto read = [&](SIZE_T p, SIZE_T len) { return (p + len <= size) && (file->Read(this->dat.At(p), len) == len); };
+    SIZE_T p = (version >= 102) ? 8 : 4;
+    if (!read(0, p)) {
+        return false;
+    }
+    const UINT32 plc = *this->dat.AsAt<UINT32>(p - 4);
+    for (UINT32 i = 0; i < plc; i++) {
+        if (!read(p, 2)) {
+            return false;
+        }
+        const UINT8 vrtType = *this->dat.AsAt<UINT8>(p);
+        const UINT8 colType = (vrtType == 0) ? 0 : *this->dat.AsAt<UINT8>(p + 1);
+        p += 2;
+        const SIZE_T fields = listFieldsSize(vrtType, colType, version);
+        if (!read(p, fields)) {
+            return false;
+        }
+        UINT64* count = this->dat.AsAt<UINT64>(p + listCountOffset(vrtType, colType, version));
+        const UINT64 prefix = lod.Prefix(*count);
+        const SIZE_T stride = recordSize(vrtType, colType);
+        const UINT64 skipped = (*count - prefix) * stride;
+        *count = prefix;
+        p += fields;
+        if (!read(p, static_cast<SIZE_T>(prefix * stride))) {
+            return false;
+        }
+        p += static_cast<SIZE_T>(prefix * stride);
+        if (skipped > 0) {
+            file->Seek(static_cast<vislib::sys::File::FileOffset>(skipped), vislib::sys::File::CURRENT);
+        }
+    }
+    this->dat.EnforceSize(p, true);
+    return true;
+}
+
+
+/*
+ * MMPLDDataSource::Frame::DecodeFrame
+ */
+bool MMPLDDataSource::Frame::DecodeFrame(
+    MMPLDCodec& codec, unsigned int idx, vislib::RawStorage const& data, LevelOfDetail const& lod) {
+    this->frame = idx;
+    this->fileVersion = 103;
+    this->pkdSorted = false;
+    if (!codec.Decode(data.As<void>(), data.GetSize(), &this->dat)) {
+        this->dat.EnforceSize(0);
+        return false;
+    }
+    // the payloads are decoded completely as the following frames refer to them, only the copy is shortened
+    if (!lod.IsFull()) {
+        this->truncateLists(lod);
+    }
+    return true;
+}
+
+
+/*
+ * MMPLDDataSource::Frame::truncateLists
+ */
+void MMPLDDataSource::Frame::truncateLists(LevelOfDetail const& lod) {
+    SIZE_T src = (this->fileVersion >= 102) ? 8 : 4;
+    SIZE_T dst = src;
+    const UINT32 plc = *this->dat.AsAt<UINT32>(src - 4);
+    for (UINT32 i = 0; i < plc; i++) {
+        const UINT8 vrtType = *this->dat.AsAt<UINT8>(src);
+        const UINT8 colType = (vrtType == 0) ? 0 : *this->dat.AsAt<UINT8>(src + 1);
+        const SIZE_T header = 2 + listFieldsSize(vrtType, colType, this->fileVersion);
+        const SIZE_T stride = recordSize(vrtType, colType);
+        const SIZE_T countPos = 2 + listCountOffset(vrtType, colType, this->fileVersion);
+        const UINT64 count = *this->dat.AsAt<UINT64>(src + countPos);
+        const UINT64 prefix = lod.Prefix(count);
+        ::memmove(this->dat.At(dst), this->dat.At(src), header + static_cast<SIZE_T>(prefix * stride));
+        *this->dat.AsAt<UINT64>(dst + countPos) = prefix;
+        src += header + static_cast<SIZE_T>(count * stride);
+        dst += header + static_cast<SIZE_T>(prefix * stride);
+    }
+    this->dat.EnforceSize(dst, true);
 }
 
 
@@ -200,6 +325,7 @@ void MMPLDDataSource::Frame::SetData(
         pts.SetColourData(colDatType, this->dat.At(p + vrtSize), stride);
 
         p += static_cast<SIZE_T>(stride * pts.GetCount());
+        pts.SetIsPkdSorted(this->pkdSorted);
 
         if (this->fileVersion == 101) {
             // TODO: who deletes this?
@@ -229,11 +355,19 @@ MMPLDDataSource::MMPLDDataSource(void)
         , limitMemorySlot("limitMemory", "Limits the memory cache size")
         , limitMemorySizeSlot("limitMemorySize", "Specifies the size limit (in MegaBytes) of the memory cache")
         , overrideBBoxSlot("overrideLocalBBox", "Override local bbox")
+        , lodLevelSlot("lodLevel", "Loads only every 2^lodLevel-th particle of each list. Shows a representative "
+                                   "subsample for files written with level-of-detail ordering")
+        , maxParticlesSlot("maxParticles", "The maximum number of particles loaded per list, 0 for all")
         , getData("getdata", "Slot to request data from this data source.")
         , file(NULL)
-        , frameIdx(NULL)
+        , frameIdx()
         , bbox(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f)
         , clipbox(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f)
+        , frameSizeScale(1.0)
+        , pkdSorted(false)
+        , codec()
+        , codecFrame(UINT_MAX)
+        , encodedFrame()
         , data_hash(0) {
 
     this->filename.SetParameter(
@@ -256,6 +390,14 @@ MMPLDDataSource::MMPLDDataSource(void)
     this->overrideBBoxSlot << new core::param::BoolParam(false);
     this->MakeSlotAvailable(&this->overrideBBoxSlot);
 
+    this->lodLevelSlot << new core::param::IntParam(0, 0, 63);
+    this->lodLevelSlot.SetUpdateCallback(&MMPLDDataSource::levelOfDetailChanged);
+    this->MakeSlotAvailable(&this->lodLevelSlot);
+
+    this->maxParticlesSlot << new core::param::IntParam(0, 0);
+    this->maxParticlesSlot.SetUpdateCallback(&MMPLDDataSource::levelOfDetailChanged);
+    this->MakeSlotAvailable(&this->maxParticlesSlot);
+
     this->getData.SetCallback(geocalls::MultiParticleDataCall::ClassName(),
         geocalls::MultiParticleDataCall::FunctionName(0), &MMPLDDataSource::getDataCallback);
     this->getData.SetCallback(geocalls::MultiParticleDataCall::ClassName(),
@@ -305,11 +447,17 @@ void MMPLDDataSource::loadFrame(AnimDataModule::Frame* frame, unsigned int idx)
         return;
     }
     //printf("Requesting frame %u of %u frames\n", idx, this->FrameCount());
-    //printf("Requesting frame %u of %u frames\n", idx, this->FrameCount());
     //Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Requesting frame %u of %u frames\n", idx, this->FrameCount());
     ASSERT(idx < this->FrameCount());
+    if (this->fileVersion >= 200) {
+        if (!this->loadEncodedFrame(*f, idx)) {
+            Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to decode frame %d from MMPLD file\n", idx);
+        }
+        return;
+    }
     this->file->Seek(this->frameIdx[idx]);
-    if (!f->LoadFrame(this->file, idx, this->frameIdx[idx + 1] - this->frameIdx[idx], this->fileVersion)) {
+    if (!f->LoadFrame(this->file, idx, this->frameIdx[idx + 1] - this->frameIdx[idx], this->fileVersion,
+            this->levelOfDetail(), this->pkdSorted)) {
         // failed
         Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to read frame %d from MMPLD file\n", idx);
     }
@@ -320,6 +468,10 @@ void MMPLDDataSource::loadFrame(AnimDataModule::Frame* frame, unsigned int idx)
  * MMPLDDataSource::release
  */
 void MMPLDDataSource::release(void) {
+    if (this->pendingIndex.valid()) {
+        this->pendingIndex.wait();
+        this->pendingIndex = std::future<FileIndex>();
+    }
     this->resetFrameCache();
     if (this->file != NULL) {
         vislib::sys::File* f = this->file;
@@ -327,51 +479,86 @@ void MMPLDDataSource::release(void) {
         f->Close();
         delete f;
     }
-    ARY_SAFE_DELETE(this->frameIdx);
+    this->frameIdx.clear();
+    this->codec.Reset();
+    this->codecFrame = UINT_MAX;
+    this->encodedFrame.EnforceSize(0);
 }
 
 
 /*
- * MMPLDDataSource::filenameChanged
+ * MMPLDDataSource::readRawFrame
  */
-bool MMPLDDataSource::filenameChanged(core::param::ParamSlot& slot) {
-    using megamol::core::utility::log::Log;
-    using vislib::sys::File;
-    this->resetFrameCache();
-    this->bbox.Set(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f);
-    this->clipbox = this->bbox;
-    this->data_hash++;
+bool MMPLDDataSource::readRawFrame(unsigned int idx, vislib::RawStorage& data) {
+    const UINT64 size = this->frameIdx[idx + 1] - this->frameIdx[idx];
+    data.EnforceSize(static_cast<SIZE_T>(size));
+    this->file->Seek(this->frameIdx[idx]);
+    return (this->file->Read(data, size) == size);
+}
 
-    if (this->file == NULL) {
-        this->file = new vislib::sys::FastFile();
-    } else {
-        this->file->Close();
+
+/*
+ * MMPLDDataSource::loadEncodedFrame
+ */
+bool MMPLDDataSource::loadEncodedFrame(Frame& frame, unsigned int idx) {
+    UINT32 distance = 0;
+    if (!this->readRawFrame(idx, this->encodedFrame) ||
+        !MMPLDCodec::KeyframeDistance(this->encodedFrame.As<void>(), this->encodedFrame.GetSize(), distance) ||
+        (distance > idx)) {
+        frame.Clear();
+        return false;
+    }
+
+    if ((distance > 0) && (this->codecFrame + 1 != idx)) {
+        // replay the frames since the keyframe, they only update the reference of the decoder
+        this->codecFrame = UINT_MAX;
+        for (unsigned int i = idx - distance; i < idx; ++i) {
+            if (!this->readRawFrame(i, this->encodedFrame) ||
+                !this->codec.Decode(this->encodedFrame.As<void>(), this->encodedFrame.GetSize(), nullptr)) {
+                this->codec.Reset();
+                frame.Clear();
+                return false;
+            }
+        }
+        if (!this->readRawFrame(idx, this->encodedFrame)) {
+            this->codec.Reset();
+            frame.Clear();
+            return false;
+        }
     }
-    ASSERT(this->filename.Param<core::param::FilePathParam>() != NULL);
 
-    if (!this->file->Open(this->filename.Param<core::param::FilePathParam>()->Value().native().c_str(), File::READ_ONLY,
-            File::SHARE_READ, File::OPEN_ONLY)) {
-        megamol::core::utility::log::Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Unable to open MMPLD-File \"%s\".",
-            this->filename.Param<core::param::FilePathParam>()->Value().generic_u8string().c_str());
+    if (!frame.DecodeFrame(this->codec, idx, this->encodedFrame, this->levelOfDetail())) {
+        this->codecFrame = UINT_MAX;
+        return false;
+    }
+    this->codecFrame = idx;
+    return true;
+}
 
-        SAFE_DELETE(this->file);
-        this->setFrameCount(1);
-        this->initFrameCache(1);
 
-        return true;
+/*
+ * MMPLDDataSource::readFileIndex
+ */
+MMPLDDataSource::FileIndex MMPLDDataSource::readFileIndex(std::filesystem::path const& path) {
+    using vislib::sys::File;
+    FileIndex index;
+
+    index.file = std::make_unique<vislib::sys::FastFile>();
+    if (!index.file->Open(path.native().c_str(), File::READ_ONLY, File::SHARE_READ, File::OPEN_ONLY)) {
+        index.file.reset();
+        index.error = "Unable to open MMPLD-File \"" + path.generic_u8string() + "\".";
+        return index;
     }
 
-#define _ERROR_OUT(MSG)                                    \
-    Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, MSG);       \
-    SAFE_DELETE(this->file);                               \
-    this->setFrameCount(1);                                \
-    this->initFrameCache(1);                               \
-    this->bbox.Set(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f); \
-    this->clipbox = this->bbox;                            \
-    return true;
-#define _ASSERT_READFILE(BUFFER, BUFFERSIZE)                        \
-    if (this->file->Read((BUFFER), (BUFFERSIZE)) != (BUFFERSIZE)) { \
-        _ERROR_OUT("Unable to read MMPLD file header");             \
+#define _ERROR_OUT(MSG)       \
+    index.file->Close();      \
+    index.file.reset();       \
+    index.frameIdx.clear();   \
+    index.error = MSG;        \
+    return index;
+#define _ASSERT_READFILE(BUFFER, BUFFERSIZE)                         \
+    if (index.file->Read((BUFFER), (BUFFERSIZE)) != (BUFFERSIZE)) { \
+        _ERROR_OUT("Unable to read MMPLD file header");              \
     }
 
     char magicid[6];
@@ -381,10 +568,13 @@ bool MMPLDDataSource::filenameChanged(core::param::ParamSlot& slot) {
     }
     unsigned short ver;
     _ASSERT_READFILE(&ver, 2);
-    if (ver < 100 || ver > 103) {
+    // the highest bit marks PKD-sorted files written by the PkdBuilder of mmospray, they are plain MMPLD otherwise
+    index.pkdSorted = (ver & 0x8000) != 0;
+    ver &= 0x7FFF;
+    if (ver < 100 || (ver > 103 && ver != 200)) {
         _ERROR_OUT("MMPLD file header version wrong");
     }
-    this->fileVersion = ver;
+    index.version = ver;
 
     UINT32 frmCnt = 0;
     _ASSERT_READFILE(&frmCnt, 4);
@@ -392,21 +582,77 @@ bool MMPLDDataSource::filenameChanged(core::param::ParamSlot& slot) {
         _ERROR_OUT("MMPLD file does not contain any frame information");
     }
 
-    float box[6];
-    _ASSERT_READFILE(box, 4 * 6);
-    this->bbox.Set(box[0], box[1], box[2], box[3], box[4], box[5]);
-    _ASSERT_READFILE(box, 4 * 6);
-    this->clipbox.Set(box[0], box[1], box[2], box[3], box[4], box[5]);
+    _ASSERT_READFILE(index.bbox, 4 * 6);
+    _ASSERT_READFILE(index.clipbox, 4 * 6);
+
+    index.frameIdx.resize(frmCnt + 1);
+    _ASSERT_READFILE(index.frameIdx.data(), 8 * (frmCnt + 1));
+
+    if (ver >= 200) {
+        // frames are decoded into the version 1.3 layout, so the cache holds more than the stored size
+        UINT8 header[4 + 4 + 4 + 8];
+        UINT64 decodedSize = 0;
+        const UINT64 storedSize = index.frameIdx[1] - index.frameIdx[0];
+        index.file->Seek(index.frameIdx[0]);
+        if ((storedSize >= sizeof(header)) && (index.file->Read(header, sizeof(header)) == sizeof(header)) &&
+            MMPLDCodec::DecodedSize(header, sizeof(header), decodedSize)) {
+            index.frameSizeScale = std::max(1.0, static_cast<double>(decodedSize) / static_cast<double>(storedSize));
+        }
+    }
+
+#undef _ASSERT_READFILE
+#undef _ERROR_OUT
+
+    return index;
+}
+
+
+/*
+ * MMPLDDataSource::finishFileIndex
+ */
+void MMPLDDataSource::finishFileIndex(void) {
+    using megamol::core::utility::log::Log;
+    if (!this->pendingIndex.valid()) {
+        return;
+    }
+    FileIndex index = this->pendingIndex.get();
+
+    if (!index.error.empty()) {
+        Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "%s", index.error.c_str());
+        return;
+    }
+
+    // the placeholder cache set up in filenameChanged is still loading; stop it before the state it reads changes
+    this->resetFrameCache();
+    this->file = index.file.release();
+    this->fileVersion = index.version;
+    this->pkdSorted = index.pkdSorted;
+    this->codec.Reset();
+    this->codecFrame = UINT_MAX;
+    this->bbox.Set(index.bbox[0], index.bbox[1], index.bbox[2], index.bbox[3], index.bbox[4], index.bbox[5]);
+    this->clipbox.Set(
+        index.clipbox[0], index.clipbox[1], index.clipbox[2], index.clipbox[3], index.clipbox[4], index.clipbox[5]);
+    this->frameIdx = std::move(index.frameIdx);
+    this->frameSizeScale = index.frameSizeScale;
+
+    this->setFrameCount(static_cast<UINT32>(this->frameIdx.size() - 1));
+    this->initFrameCache(this->frameCacheSize());
+}
+
 
-    delete[] this->frameIdx;
-    this->frameIdx = new UINT64[frmCnt + 1];
-    _ASSERT_READFILE(this->frameIdx, 8 * (frmCnt + 1));
+/*
+ * MMPLDDataSource::frameCacheSize
+ */
+unsigned int MMPLDDataSource::frameCacheSize(void) {
+    const UINT32 frmCnt = static_cast<UINT32>(this->frameIdx.size() - 1);
     double size = 0.0;
     for (UINT32 i = 0; i < frmCnt; i++) {
         size += static_cast<double>(this->frameIdx[i + 1] - this->frameIdx[i]);
     }
     size /= static_cast<double>(frmCnt);
-    size *= CACHE_FRAME_FACTOR;
+    size *= this->frameSizeScale * CACHE_FRAME_FACTOR;
+    // each level of detail halves the particles held per frame
+    size = std::max(std::ldexp(size, -static_cast<int>(this->levelOfDetail().level)), 1.0);
 
     UINT64 mem = vislib::sys::SystemInformation::AvailableMemorySize();
     if (this->limitMemorySlot.Param<core::param::BoolParam>()->Value()) {
@@ -429,11 +675,68 @@ bool MMPLDDataSource::filenameChanged(core::param::ParamSlot& slot) {
         megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_INFO, msg);
     }
 
-    this->setFrameCount(frmCnt);
-    this->initFrameCache(cacheSize);
+    return cacheSize;
+}
 
-#undef _ASSERT_READFILE
-#undef _ERROR_OUT
+
+/*
+ * MMPLDDataSource::levelOfDetail
+ */
+MMPLDDataSource::LevelOfDetail MMPLDDataSource::levelOfDetail(void) {
+    LevelOfDetail lod;
+    lod.level = static_cast<unsigned int>(std::max(0, this->lodLevelSlot.Param<core::param::IntParam>()->Value()));
+    lod.maxParticles =
+        static_cast<UINT64>(std::max(0, this->maxParticlesSlot.Param<core::param::IntParam>()->Value()));
+    return lod;
+}
+
+
+/*
+ * MMPLDDataSource::levelOfDetailChanged
+ */
+bool MMPLDDataSource::levelOfDetailChanged(core::param::ParamSlot& slot) {
+    this->data_hash++;
+    // a pending index picks up the new level when the cache is created
+    if (this->file != NULL) {
+        this->resetFrameCache();
+        this->codec.Reset();
+        this->codecFrame = UINT_MAX;
+        this->setFrameCount(static_cast<unsigned int>(this->frameIdx.size() - 1));
+        this->initFrameCache(this->frameCacheSize());
+    }
+    return true;
+}
+
+
+/*
+ * MMPLDDataSource::filenameChanged
+ */
+bool MMPLDDataSource::filenameChanged(core::param::ParamSlot& slot) {
+    // a previous indexing still running only holds its own file handle, drop its result
+    if (this->pendingIndex.valid()) {
+        this->pendingIndex.wait();
+        this->pendingIndex = std::future<FileIndex>();
+    }
+
+    this->resetFrameCache();
+    this->bbox.Set(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f);
+    this->clipbox = this->bbox;
+    this->data_hash++;
+
+    if (this->file != NULL) {
+        this->file->Close();
+        SAFE_DELETE(this->file);
+    }
+    this->frameIdx.clear();
+    this->setFrameCount(1);
+    this->initFrameCache(1);
+
+    ASSERT(this->filename.Param<core::param::FilePathParam>() != NULL);
+
+    // opening the file and reading the frame table can take long for large files or network drives,
+    // so it starts right away in the background and is only waited for when the data is requested
+    this->pendingIndex = std::async(std::launch::async, &MMPLDDataSource::readFileIndex,
+        this->filename.Param<core::param::FilePathParam>()->Value());
 
     return true;
 }
@@ -447,6 +750,8 @@ bool MMPLDDataSource::getDataCallback(core::Call& caller) {
     if (c2 == NULL)
         return false;
 
+    this->finishFileIndex();
+
     Frame* f = NULL;
     if (c2 != NULL) {
         f = dynamic_cast<Frame*>(this->requestLockedFrame(c2->FrameID(), c2->IsFrameForced()));
@@ -470,6 +775,7 @@ bool MMPLDDataSource::getExtentCallback(core::Call& caller) {
     geocalls::MultiParticleDataCall* c2 = dynamic_cast<geocalls::MultiParticleDataCall*>(&caller);
 
     if (c2 != NULL) {
+        this->finishFileIndex();
         c2->SetFrameCount(this->FrameCount());
         c2->AccessBoundingBoxes().Clear();
         c2->AccessBoundingBoxes().SetObjectSpaceBBox(this->bbox);
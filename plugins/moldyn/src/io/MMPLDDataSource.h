@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "MMPLDCodec.h"
 #include "geometry_calls/MultiParticleDataCall.h"
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/param/ParamSlot.h"
@@ -16,6 +17,12 @@
 #include "vislib/sys/File.h"
 #include "vislib/types.h"
 
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
 
 namespace megamol::moldyn::io {
 
@@ -90,6 +97,36 @@ protected:
      */
     virtual void release(void);
 
+    /**
+     * The part of each particle list that is loaded. Files written with
+     * level-of-detail ordering hold a representative subsample in every
+     * prefix of a list.
+     */
+    struct LevelOfDetail {
+        /** each level halves the number of particles loaded per list */
+        unsigned int level = 0;
+
+        /** the maximum number of particles loaded per list, 0 for all */
+        UINT64 maxParticles = 0;
+
+        /** Answer whether the lists are loaded completely. */
+        inline bool IsFull(void) const {
+            return (this->level == 0) && (this->maxParticles == 0);
+        }
+
+        /** Answer the number of particles loaded of a list with 'count' particles. */
+        inline UINT64 Prefix(UINT64 count) const {
+            UINT64 prefix = (this->level < 64) ? (count >> this->level) : 0;
+            if ((prefix == 0) && (count > 0)) {
+                prefix = 1;
+            }
+            if ((this->maxParticles > 0) && (prefix > this->maxParticles)) {
+                prefix = this->maxParticles;
+            }
+            return prefix;
+        }
+    };
+
     /** Nested class of frame data */
     class Frame : public core::view::AnimDataModule::Frame {
     public:
@@ -118,10 +155,30 @@ protected:
          * @param idx The zero-based index of the frame
          * @param size The size of the frame data in bytes
          * @param version File version (100 = standard, 101 with clusterInfos)
+         * @param lod The part of the lists to load, the rest is skipped in
+         *            the file. Lists with clusterInfos are always loaded
+         *            completely.
+         * @param pkdSorted Whether the file stores the lists in PKD order.
+         *                  Only complete lists are marked as such.
          *
          * @return True on success
          */
-        bool LoadFrame(vislib::sys::File* file, unsigned int idx, UINT64 size, unsigned int version);
+        bool LoadFrame(vislib::sys::File* file, unsigned int idx, UINT64 size, unsigned int version,
+            LevelOfDetail const& lod, bool pkdSorted);
+
+        /**
+         * Decodes a frame of a version 2.0 file into this object. The frame
+         * is stored in the version 1.3 layout.
+         *
+         * @param codec The decoder holding the previous frame
+         * @param idx The zero-based index of the frame
+         * @param data The encoded frame
+         * @param lod The part of the lists to keep
+         *
+         * @return True on success
+         */
+        bool DecodeFrame(
+            MMPLDCodec& codec, unsigned int idx, vislib::RawStorage const& data, LevelOfDetail const& lod);
 
         /**
          * Sets the data into the call
@@ -131,11 +188,21 @@ protected:
         void SetData(geocalls::MultiParticleDataCall& call, vislib::math::Cuboid<float> const& bbox, bool overrideBBox);
 
     private:
+        /**
+         * Shortens the lists of the loaded frame to the given part.
+         *
+         * @param lod The part of the lists to keep
+         */
+        void truncateLists(LevelOfDetail const& lod);
+
         /** position data per type */
         vislib::RawStorage dat;
 
         /** file version */
         unsigned int fileVersion;
+
+        /** whether the lists are in PKD order */
+        bool pkdSorted = false;
     };
 
     /**
@@ -172,6 +239,56 @@ protected:
         Frame* frame;
     };
 
+    /** Header and frame table of an MMPLD file, read in the background */
+    struct FileIndex {
+        std::unique_ptr<vislib::sys::File> file;
+        unsigned int version = 0;
+        /** the file is a PKD tree file of the PkdBuilder of mmospray */
+        bool pkdSorted = false;
+        float bbox[6] = {-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+        float clipbox[6] = {-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+        std::vector<UINT64> frameIdx;
+        /** ratio of decoded to stored size of the first frame, to size the cache for compressed files */
+        double frameSizeScale = 1.0;
+        std::string error;
+    };
+
+    /**
+     * Opens the file and reads header and frame table. Runs on a worker thread and must not touch the module.
+     *
+     * @param path The path of the MMPLD file.
+     *
+     * @return The index of the file, error is set if reading failed.
+     */
+    static FileIndex readFileIndex(std::filesystem::path const& path);
+
+    /**
+     * Reads a frame as stored in the file.
+     *
+     * @param idx The zero-based index of the frame
+     * @param data Receives the frame data
+     *
+     * @return True on success
+     */
+    bool readRawFrame(unsigned int idx, vislib::RawStorage& data);
+
+    /**
+     * Loads a frame of a version 2.0 file. Frames referring to their
+     * predecessors are decoded starting at their keyframe, unless the
+     * decoder already holds the predecessor.
+     *
+     * @param frame The frame to load into
+     * @param idx The zero-based index of the frame
+     *
+     * @return True on success
+     */
+    bool loadEncodedFrame(Frame& frame, unsigned int idx);
+
+    /**
+     * Waits for a pending background indexing of the file and applies its result to the module.
+     */
+    void finishFileIndex(void);
+
     /**
      * Callback receiving the update of the file name parameter.
      *
@@ -181,6 +298,30 @@ protected:
      */
     bool filenameChanged(core::param::ParamSlot& slot);
 
+    /**
+     * Reloads the frames with the changed level of detail.
+     *
+     * @param slot Must be lodLevelSlot or maxParticlesSlot
+     *
+     * @return true
+     */
+    bool levelOfDetailChanged(core::param::ParamSlot& slot);
+
+    /**
+     * Answer the level of detail set in the parameters.
+     *
+     * @return The part of the lists to load
+     */
+    LevelOfDetail levelOfDetail(void);
+
+    /**
+     * Answer the number of frames fitting into the cache memory, based on
+     * the average frame size and the level of detail.
+     *
+     * @return The frame cache size
+     */
+    unsigned int frameCacheSize(void);
+
     /**
      * Gets the data from the source.
      *
@@ -208,6 +349,12 @@ protected:
     /** Specifies the size limit of the memory cache */
     core::param::ParamSlot limitMemorySizeSlot;
 
+    /** The level of detail, each level halves the particles loaded per list */
+    core::param::ParamSlot lodLevelSlot;
+
+    /** The maximum number of particles loaded per list */
+    core::param::ParamSlot maxParticlesSlot;
+
     /** Override local bbox */
     core::param::ParamSlot overrideBBoxSlot;
 
@@ -218,7 +365,10 @@ protected:
     vislib::sys::File* file;
 
     /** The frame index table */
-    UINT64* frameIdx;
+    std::vector<UINT64> frameIdx;
+
+    /** Pending background indexing of the file set in the filename slot */
+    std::future<FileIndex> pendingIndex;
 
     /** The data set bounding box */
     vislib::math::Cuboid<float> bbox;
@@ -229,6 +379,21 @@ protected:
     /** file version */
     unsigned int fileVersion;
 
+    /** Ratio of decoded to stored frame size */
+    double frameSizeScale;
+
+    /** Whether the file stores the particles in PKD order */
+    bool pkdSorted;
+
+    /** The decoder of version 2.0 frames */
+    MMPLDCodec codec;
+
+    /** The index of the frame the decoder holds as reference, UINT_MAX if none */
+    unsigned int codecFrame;
+
+    /** Buffer for the encoded frames */
+    vislib::RawStorage encodedFrame;
+
     /** Data file load id counter */
     size_t data_hash;
 };
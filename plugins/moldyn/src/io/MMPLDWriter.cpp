@@ -18,6 +18,11 @@
 #include "mmcore/utility/sys/Thread.h"
 #include "vislib/String.h"
 #include "vislib/sys/FastFile.h"
+#include "vislib/sys/MemoryFile.h"
+
+#include <chrono>
+#include <cstring>
+#include <vector>
 
 namespace megamol::moldyn::io {
 
@@ -28,6 +33,14 @@ MMPLDWriter::MMPLDWriter(void)
         : AbstractDataWriter()
         , filenameSlot("filename", "The path to the MMPLD file to be written")
         , versionSlot("version", "The file format version to be written")
+        , compressionLevelSlot("compressionLevel", "The zlib compression level of version 2.0, 0 for none")
+        , quantizeSlot("quantizePositions", "Quantizes the positions of version 2.0 to 16 bit within the list bounds")
+        , predictionSlot("prediction", "The prediction of version 2.0 frames from their previous frame")
+        , keyframeIntervalSlot("keyframeInterval", "The number of frames between two keyframes of version 2.0")
+        , lodOrderSlot("lodOrder", "Orders the particles of each list such that every prefix is a spatially "
+                                   "stratified subsample, for loading coarse levels of detail. The particle order of "
+                                   "the source is not preserved; the order of the first frame is kept for the whole "
+                                   "file, so particles stay at the same index in every frame")
         , dataSlot("data", "The slot requesting the data to be written")
         , startFrameSlot("startFrame", "the first frame to write")
         , endFrameSlot("endFrame", "the last frame to write")
@@ -44,9 +57,29 @@ MMPLDWriter::MMPLDWriter(void)
 #endif
     verPar->SetTypePair(102, "1.2");
     verPar->SetTypePair(103, "1.3");
+    verPar->SetTypePair(200, "2.0");
     this->versionSlot.SetParameter(verPar);
     this->MakeSlotAvailable(&this->versionSlot);
 
+    this->compressionLevelSlot << new core::param::IntParam(1, 0, 9);
+    this->MakeSlotAvailable(&this->compressionLevelSlot);
+
+    this->quantizeSlot << new core::param::BoolParam(false);
+    this->MakeSlotAvailable(&this->quantizeSlot);
+
+    core::param::EnumParam* predPar = new core::param::EnumParam(MMPLDCodec::PREDICT_XOR);
+    predPar->SetTypePair(MMPLDCodec::PREDICT_NONE, "None");
+    predPar->SetTypePair(MMPLDCodec::PREDICT_XOR, "XOR");
+    predPar->SetTypePair(MMPLDCodec::PREDICT_DELTA, "Delta");
+    this->predictionSlot.SetParameter(predPar);
+    this->MakeSlotAvailable(&this->predictionSlot);
+
+    this->keyframeIntervalSlot << new core::param::IntParam(16, 1);
+    this->MakeSlotAvailable(&this->keyframeIntervalSlot);
+
+    this->lodOrderSlot << new core::param::BoolParam(false);
+    this->MakeSlotAvailable(&this->lodOrderSlot);
+
     this->startFrameSlot << new core::param::IntParam(0);
     this->MakeSlotAvailable(&startFrameSlot);
     this->endFrameSlot << new core::param::IntParam(0);
@@ -178,6 +211,19 @@ bool MMPLDWriter::run(void) {
         ASSERT_WRITEOUT(&frameOffset, 8);
     }
 
+    const int fileVersion = this->versionSlot.Param<core::param::EnumParam>()->Value();
+    const UINT32 keyframeInterval =
+        static_cast<UINT32>(std::max(1, this->keyframeIntervalSlot.Param<core::param::IntParam>()->Value()));
+    if ((fileVersion >= 200) &&
+        (this->predictionSlot.Param<core::param::EnumParam>()->Value() == MMPLDCodec::PREDICT_DELTA) &&
+        !this->quantizeSlot.Param<core::param::BoolParam>()->Value()) {
+        Log::DefaultLog.WriteWarn("Delta prediction requires quantized positions, using XOR prediction instead\n");
+    }
+    MMPLDCodec codec;
+    this->lodOrders.clear();
+    UINT64 decodedBytes = 0;
+    double encodeSeconds = 0.0;
+
     mpdc->Unlock();
     for (UINT32 i = theStart; i < theEnd; i++) {
         frameOffset = static_cast<UINT64>(file.Tell());
@@ -211,7 +257,17 @@ bool MMPLDWriter::run(void) {
             }
         } while (mpdc->FrameID() != i);
 
-        if (!this->writeFrame(file, *mpdc)) {
+        bool written;
+        if (fileVersion >= 200) {
+            const auto start = std::chrono::steady_clock::now();
+            UINT64 decodedSize = 0;
+            written = this->writeEncodedFrame(file, *mpdc, codec, (i - theStart) % keyframeInterval == 0, decodedSize);
+            encodeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            decodedBytes += decodedSize;
+        } else {
+            written = this->writeFrame(file, *mpdc, fileVersion);
+        }
+        if (!written) {
             mpdc->Unlock();
             Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Cannot write data frame %u. Abort.\n", i);
             file.Close();
@@ -225,11 +281,18 @@ bool MMPLDWriter::run(void) {
     ASSERT_WRITEOUT(&frameOffset, 8);
 
     file.Seek(6); // set correct version to show that file is complete
-    version = this->versionSlot.Param<core::param::EnumParam>()->Value();
+    version = static_cast<UINT16>(fileVersion);
     ASSERT_WRITEOUT(&version, 2);
 
     file.Seek(frameOffset);
 
+    if ((fileVersion >= 200) && (decodedBytes > 0)) {
+        const UINT64 storedBytes = frameOffset - (seekTable + (frameCnt + 1) * 8);
+        Log::DefaultLog.WriteInfo("Encoded %.1f MB into %.1f MB (%.1f%%) at %.1f MB/s\n",
+            decodedBytes / (1024.0 * 1024.0), storedBytes / (1024.0 * 1024.0), 100.0 * storedBytes / decodedBytes,
+            (encodeSeconds > 0.0) ? decodedBytes / (1024.0 * 1024.0) / encodeSeconds : 0.0);
+    }
+
     Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Completed writing data\n");
     file.Close();
 
@@ -250,7 +313,7 @@ bool MMPLDWriter::getCapabilities(core::DataWriterCtrlCall& call) {
 /*
  * MMPLDWriter::writeFrame
  */
-bool MMPLDWriter::writeFrame(vislib::sys::File& file, geocalls::MultiParticleDataCall& data) {
+bool MMPLDWriter::writeFrame(vislib::sys::File& file, geocalls::MultiParticleDataCall& data, int version) {
 #define ASSERT_WRITEOUT(A, S)                                                   \
     if (file.Write((A), (S)) != (S)) {                                          \
         Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Write error %d", __LINE__); \
@@ -259,7 +322,8 @@ bool MMPLDWriter::writeFrame(vislib::sys::File& file, geocalls::MultiParticleDat
     }
     using megamol::core::utility::log::Log;
     uint8_t const alpha = 255;
-    int ver = this->versionSlot.Param<core::param::EnumParam>()->Value();
+    const int ver = version;
+    const bool lod = this->lodOrderSlot.Param<core::param::BoolParam>()->Value();
 
     // HAZARD for megamol up to fc4e784dae531953ad4cd3180f424605474dd18b this reads == 102
     // which means that many MMPLDs out there with version 103 are written wrongly (no timestamp)!
@@ -397,6 +461,38 @@ bool MMPLDWriter::writeFrame(vislib::sys::File& file, geocalls::MultiParticleDat
             continue;
         const unsigned char* vp = static_cast<const unsigned char*>(points.GetVertexData());
         const unsigned char* cp = static_cast<const unsigned char*>(points.GetColourData());
+        std::vector<unsigned char> lodVert, lodCol;
+        if (lod && (ver != 101) && (cnt > 2)) {
+            // the cluster infos of version 1.1 refer to the particle order, so those lists stay as they are
+            // the order of the first frame is reused, so that a particle keeps its index and the prediction of
+            // version 2.0 sees its previous position
+            if (this->lodOrders.size() <= li) {
+                this->lodOrders.resize(li + 1);
+            }
+            std::vector<UINT64>& order = this->lodOrders[li];
+            if (order.size() != cnt) {
+                if (!order.empty()) {
+                    Log::DefaultLog.WriteWarn("MMPLDWriter: list %u changed from %llu to %llu particles, the "
+                                              "particles are reordered\n",
+                        li, static_cast<unsigned long long>(order.size()), static_cast<unsigned long long>(cnt));
+                }
+                order = MMPLDCodec::LodOrder(vp, vo, vt, cnt);
+            }
+            lodVert.resize(static_cast<size_t>(cnt * vs));
+            for (UINT64 i = 0; i < cnt; ++i) {
+                ::memcpy(lodVert.data() + i * vs, vp + order[i] * vo, vs);
+            }
+            vp = lodVert.data();
+            vo = vs;
+            if ((cp != nullptr) && (cs > 0)) {
+                lodCol.resize(static_cast<size_t>(cnt * cs));
+                for (UINT64 i = 0; i < cnt; ++i) {
+                    ::memcpy(lodCol.data() + i * cs, cp + order[i] * co, cs);
+                }
+                cp = lodCol.data();
+                co = cs;
+            }
+        }
         if (vt == 4 && ct < 5) {
             switch (points.GetColourDataType()) {
             case geocalls::MultiParticleDataCall::Particles::COLDATA_NONE: {
@@ -496,4 +592,49 @@ bool MMPLDWriter::writeFrame(vislib::sys::File& file, geocalls::MultiParticleDat
     return true;
 #undef ASSERT_WRITEOUT
 }
+
+
+/*
+ * MMPLDWriter::writeEncodedFrame
+ */
+bool MMPLDWriter::writeEncodedFrame(vislib::sys::File& file, geocalls::MultiParticleDataCall& data, MMPLDCodec& codec,
+    bool keyframe, UINT64& decodedSize) {
+    using megamol::core::utility::log::Log;
+
+    // the frame is assembled in the version 1.3 layout first, sized for the widest record writeFrame can produce
+    SIZE_T bound = 4 + 4;
+    for (unsigned int li = 0; li < data.GetParticleListCount(); ++li) {
+        auto const& points = data.AccessParticles(li);
+        const SIZE_T vs = geocalls::MultiParticleDataCall::Particles::VertexDataSize[points.GetVertexDataType()];
+        const SIZE_T cs = geocalls::MultiParticleDataCall::Particles::ColorDataSize[points.GetColourDataType()];
+        SIZE_T rs = vs;
+        if ((points.GetColourDataType() != geocalls::MultiParticleDataCall::Particles::COLDATA_NONE) ||
+            (points.GetVertexDataType() == geocalls::MultiParticleDataCall::Particles::VERTDATA_DOUBLE_XYZ)) {
+            rs += std::max<SIZE_T>(cs, 8);
+        }
+        bound += 64 + static_cast<SIZE_T>(points.GetCount()) * rs;
+    }
+
+    vislib::RawStorage plain;
+    plain.EnforceSize(bound);
+    vislib::sys::MemoryFile plainFile;
+    if (!plainFile.Open(plain.As<void>(), bound, vislib::sys::File::WRITE_ONLY) ||
+        !this->writeFrame(plainFile, data, 103)) {
+        return false;
+    }
+    decodedSize = static_cast<UINT64>(plainFile.Tell());
+
+    MMPLDCodec::Settings settings;
+    settings.CompressionLevel = this->compressionLevelSlot.Param<core::param::IntParam>()->Value();
+    settings.QuantizePositions = this->quantizeSlot.Param<core::param::BoolParam>()->Value();
+    settings.Prediction =
+        static_cast<MMPLDCodec::Predictor>(this->predictionSlot.Param<core::param::EnumParam>()->Value());
+
+    vislib::RawStorage encoded;
+    if (!codec.Encode(plain.As<void>(), static_cast<SIZE_T>(decodedSize), keyframe, settings, encoded)) {
+        Log::DefaultLog.WriteError("MMPLDWriter: unable to encode frame");
+        return false;
+    }
+    return file.Write(encoded.As<void>(), encoded.GetSize()) == encoded.GetSize();
+}
 } // namespace megamol::moldyn::io
@@ -7,12 +7,15 @@
 
 #pragma once
 
+#include "MMPLDCodec.h"
 #include "geometry_calls/MultiParticleDataCall.h"
 #include "mmcore/AbstractDataWriter.h"
 #include "mmcore/CallerSlot.h"
 #include "mmcore/param/ParamSlot.h"
 #include "vislib/sys/File.h"
 
+#include <vector>
+
 
 namespace megamol::moldyn::io {
 
@@ -99,10 +102,25 @@ private:
      *
      * @param file The output data file
      * @param data The data of the current frame
+     * @param version The file format version of the frame, at most 1.3
      *
      * @return True on success
      */
-    bool writeFrame(vislib::sys::File& file, geocalls::MultiParticleDataCall& data);
+    bool writeFrame(vislib::sys::File& file, geocalls::MultiParticleDataCall& data, int version);
+
+    /**
+     * Writes the data of one frame to the file in the version 2.0 layout
+     *
+     * @param file The output data file
+     * @param data The data of the current frame
+     * @param codec The encoder holding the previous frame
+     * @param keyframe Whether the frame is stored without reference to the previous frame
+     * @param decodedSize Receives the size of the frame in the version 1.3 layout
+     *
+     * @return True on success
+     */
+    bool writeEncodedFrame(vislib::sys::File& file, geocalls::MultiParticleDataCall& data, MMPLDCodec& codec,
+        bool keyframe, UINT64& decodedSize);
 
     /** The file name of the file to be written */
     core::param::ParamSlot filenameSlot;
@@ -110,12 +128,30 @@ private:
     /** The file format version to be written */
     core::param::ParamSlot versionSlot;
 
+    /** The zlib compression level of version 2.0, 0 stores the particles uncompressed */
+    core::param::ParamSlot compressionLevelSlot;
+
+    /** Whether version 2.0 quantizes the positions to 16 bit relative to the list bounding box */
+    core::param::ParamSlot quantizeSlot;
+
+    /** The prediction from the previous frame used by version 2.0 */
+    core::param::ParamSlot predictionSlot;
+
+    /** The number of frames between two keyframes of version 2.0 */
+    core::param::ParamSlot keyframeIntervalSlot;
+
+    /** Whether the particles of each list are ordered such that every prefix is a representative subsample */
+    core::param::ParamSlot lodOrderSlot;
+
     core::param::ParamSlot startFrameSlot;
     core::param::ParamSlot endFrameSlot;
     core::param::ParamSlot subsetSlot;
 
     /** The slot asking for data */
     core::CallerSlot dataSlot;
+
+    /** The particle order of each list, computed for the first frame and kept for the whole file */
+    std::vector<std::vector<UINT64>> lodOrders;
 };
 
 
@@ -9,8 +9,9 @@
 #include "geometry_calls/MultiParticleDataCall.h"
 #include "mmcore/CoreInstance.h"
 #include "mmcore/param/FilePathParam.h"
+#include "mmcore/utility/TaskScheduler.h"
+#include "mmcore/utility/TextParsing.h"
 #include "mmcore/utility/log/Log.h"
-#include "mmcore/utility/sys/ASCIIFileBuffer.h"
 #include "mmcore/utility/sys/SystemInformation.h"
 #include "stdafx.h"
 #include "vislib/ArrayAllocator.h"
@@ -26,9 +27,10 @@
 #include "vislib/memutils.h"
 #include "vislib/sys/AutoLock.h"
 #include "vislib/sys/File.h"
-#include "vislib/sys/MemoryFile.h"
 #include "vislib/sys/sysfunctions.h"
 #include "vislib/utils.h"
+#include <string_view>
+#include <vector>
 
 using namespace megamol;
 using namespace megamol::moldyn::io;
@@ -479,89 +481,112 @@ void MMSPDDataSource::Frame::SetDirData(geocalls::MultiParticleDataCall& call, c
 void MMSPDDataSource::Frame::loadFrameText(char* buffer, UINT64 size, const MMSPDHeader& header) {
     // We don't have to brother with unicode here, because there is no string data allowed.
     // All characters must be white space, line breaks, '>' and characters forming numbers (digits, dots, plus, minus, 'e').
-    vislib::sys::MemoryFile mem;
-    mem.Open(static_cast<void*>(buffer), static_cast<SIZE_T>(size), vislib::sys::File::READ_ONLY);
-    vislib::sys::ASCIIFileBuffer txt(vislib::sys::ASCIIFileBuffer::PARSING_WORDS);
-    if (!txt.LoadFile(mem))
-        throw vislib::Exception(__FILE__, __LINE__);
-
-    if (txt.Count() <= 0)
+    const core::utility::LineIndex lines(std::string_view(buffer, static_cast<size_t>(size)));
+    if (lines.empty())
         throw vislib::Exception("Unable to load frame data", __FILE__, __LINE__);
-    if (txt.Line(0).Count() < 2)
+    core::utility::TextCursor marker(lines[0]);
+    marker.token();
+    uint64_t partCnt = 0;
+    if (marker.atLineEnd())
         throw vislib::Exception("Illegal time frame marker", __FILE__, __LINE__);
-    UINT64 partCnt = vislib::CharTraitsA::ParseUInt64(txt.Line(0).Word(1));
-    if (txt.Count() < partCnt + 1)
+    if (!core::utility::parseUInt(marker.token(), partCnt))
+        throw vislib::Exception("Illegal particle count", __FILE__, __LINE__);
+    if (lines.size() < partCnt + 1)
         throw vislib::Exception("Data frame truncated", __FILE__, __LINE__);
 
-    SIZE_T typeCnt = header.GetTypes().Count();
-    vislib::PtrArray<vislib::RawStorageWriter> typeData;
-    typeData.SetCount(typeCnt);
-    for (SIZE_T i = 0; i < typeCnt; i++) {
-        typeData[i] = new vislib::RawStorageWriter(this->Data()[i].Data());
-        typeData[i]->SetIncrement(vislib::math::Max<SIZE_T>(
-            static_cast<SIZE_T>((header.GetTypes()[i].GetFields().Count() * sizeof(float) * partCnt) / (2 * typeCnt)),
-            1024 * 1024));
-    }
-    vislib::RawStorageWriter idxRecDat(this->IndexReconstructionData());
-    if (typeCnt > 1)
-        idxRecDat.SetIncrement(vislib::math::Max<SIZE_T>(static_cast<SIZE_T>(partCnt / 10), 10 * 1024));
-    UINT32 irdLastType = static_cast<UINT32>(typeCnt);
-    UINT64 irdLastCount;
+    // the particle lines are parsed in parallel ranges, the ranges are concatenated per type afterwards
+    struct Range {
+        std::vector<std::vector<char>> typeData;
+        const char* error = nullptr;
+    };
+    const SIZE_T typeCnt = header.GetTypes().Count();
+    const bool hasIDs = header.HasIDs();
+    const UINT64 rangeSize = 64 * 1024;
+    std::vector<Range> ranges(static_cast<size_t>((partCnt + rangeSize - 1) / rangeSize));
+    std::vector<UINT32> partTypes((typeCnt > 1) ? static_cast<size_t>(partCnt) : 0);
+
+    core::utility::ParallelFor<size_t>(0, ranges.size(), 1, [&](size_t first, size_t last) {
+        for (size_t r = first; r < last; r++) {
+            Range& range = ranges[r];
+            range.typeData.resize(typeCnt);
+            const UINT64 end = vislib::math::Min<UINT64>(partCnt, (r + 1) * rangeSize);
+            for (UINT64 pi = r * rangeSize; (pi < end) && (range.error == nullptr); pi++) {
+                core::utility::TextCursor line(lines[static_cast<size_t>(1 + pi)]);
+                uint64_t id = 0;
+                int64_t type = 0;
+                if (hasIDs && !core::utility::parseUInt(line.token(), id)) {
+                    range.error = "line truncated or illegal id";
+                    break;
+                }
+                if (typeCnt > 1) {
+                    if (!core::utility::parseInt(line.token(), type)) {
+                        range.error = "line truncated or illegal type";
+                        break;
+                    }
+                    if ((type < 0) || (static_cast<SIZE_T>(type) >= typeCnt)) {
+                        range.error = "Illegal type encountered";
+                        break;
+                    }
+                    partTypes[static_cast<size_t>(pi)] = static_cast<UINT32>(type);
+                }
 
-    SIZE_T type = 0;
-    for (UINT64 pi = 0; pi < partCnt; pi++) {
-        const vislib::sys::ASCIIFileBuffer::LineBuffer& line = txt.Line(static_cast<SIZE_T>(1 + pi));
-        unsigned int off = 0;
-        if (typeCnt > 1) {
-            if (header.HasIDs()) {
-                if (line.Count() < 2)
-                    throw vislib::Exception("line truncated", __FILE__, __LINE__);
-                type = static_cast<SIZE_T>(vislib::CharTraitsA::ParseInt(line.Word(1)));
-                if (type >= typeCnt)
-                    throw vislib::Exception("Illegal type encountered", __FILE__, __LINE__);
-                typeData[type]->Write(vislib::CharTraitsA::ParseUInt64(line.Word(0)));
-                off = 2;
-            } else {
-                if (line.Count() < 1)
-                    throw vislib::Exception("line truncated", __FILE__, __LINE__);
-                type = static_cast<SIZE_T>(vislib::CharTraitsA::ParseInt(line.Word(0)));
-                if (type >= typeCnt)
-                    throw vislib::Exception("Illegal type encountered", __FILE__, __LINE__);
-                off = 1;
+                const MMSPDHeader::TypeDefinition& typeDef = header.GetTypes()[static_cast<SIZE_T>(type)];
+                std::vector<char>& out = range.typeData[static_cast<size_t>(type)];
+                const size_t outPos = out.size();
+                const SIZE_T fieldCnt = typeDef.GetFields().Count();
+                out.resize(outPos + (hasIDs ? sizeof(UINT64) : 0) + fieldCnt * sizeof(float));
+                char* dst = out.data() + outPos;
+                if (hasIDs) {
+                    const UINT64 id64 = static_cast<UINT64>(id);
+                    ::memcpy(dst, &id64, sizeof(UINT64));
+                    dst += sizeof(UINT64);
+                }
+                for (SIZE_T fi = 0; fi < fieldCnt; fi++) {
+                    float val = 0.0f;
+                    if (!line.parseFloat(val)) {
+                        range.error = "line truncated or illegal value";
+                        break;
+                    }
+                    if (typeDef.GetFields()[fi].GetType() == MMSPDHeader::Field::TYPE_BYTE) {
+                        val /= 255.0f;
+                    }
+                    ::memcpy(dst, &val, sizeof(float));
+                    dst += sizeof(float);
+                }
             }
-        } else if (header.HasIDs()) {
-            // type remains 0
-            if (line.Count() < 1)
-                throw vislib::Exception("line truncated", __FILE__, __LINE__);
-            typeData[type]->Write(vislib::CharTraitsA::ParseUInt64(line.Word(0)));
-            off = 1;
         }
+    });
 
-        this->addIndexForReconstruction(
-            static_cast<UINT32>(type), idxRecDat, this->IndexReconstructionData(), irdLastType, irdLastCount);
-
-        SIZE_T fieldCnt = header.GetTypes()[type].GetFields().Count();
-        if (line.Count() < fieldCnt + off)
-            throw vislib::Exception("line truncated", __FILE__, __LINE__);
+    for (const Range& range : ranges) {
+        if (range.error != nullptr)
+            throw vislib::Exception(range.error, __FILE__, __LINE__);
+    }
 
-        for (SIZE_T fi = 0; fi < fieldCnt; fi++) {
-            //float val = static_cast<float>(vislib::CharTraitsA::ParseDouble(line.Word(off + this->GetData()[type].FieldMap()[fi])));
-            //if (header.GetTypes()[type].GetFields()[this->GetData()[type].FieldMap()[fi]].GetType() ==
-            //    MMSPDHeader::Field::TYPE_BYTE) {
-            //    val /= 255.0f;
-            //}
-            float val = vislib::CharTraitsA::ParseDouble(line.Word(off + fi));
-            if (header.GetTypes()[type].GetFields()[fi].GetType() == MMSPDHeader::Field::TYPE_BYTE) {
-                val /= 255.0f;
+    for (SIZE_T i = 0; i < typeCnt; i++) {
+        SIZE_T typeSize = 0;
+        for (const Range& range : ranges) {
+            typeSize += range.typeData[i].size();
+        }
+        vislib::RawStorage& data = this->Data()[i].Data();
+        data.EnforceSize(typeSize);
+        typeSize = 0;
+        for (Range& range : ranges) {
+            if (!range.typeData[i].empty()) {
+                ::memcpy(data.At(typeSize), range.typeData[i].data(), range.typeData[i].size());
+                typeSize += range.typeData[i].size();
             }
-
-            //megamol::core::utility::log::Log::DefaultLog.WriteInfo("read: %f", val);
-            typeData[type]->Write(val);
+            std::vector<char>().swap(range.typeData[i]);
         }
     }
 
-    for (SIZE_T i = 0; i < typeCnt; i++) {
-        this->Data()[i].Data().EnforceSize(typeData[i]->End(), true);
+    vislib::RawStorageWriter idxRecDat(this->IndexReconstructionData());
+    if (typeCnt > 1)
+        idxRecDat.SetIncrement(vislib::math::Max<SIZE_T>(static_cast<SIZE_T>(partCnt / 10), 10 * 1024));
+    UINT32 irdLastType = static_cast<UINT32>(typeCnt);
+    UINT64 irdLastCount;
+    for (UINT64 pi = 0; pi < partCnt; pi++) {
+        this->addIndexForReconstruction((typeCnt > 1) ? partTypes[static_cast<size_t>(pi)] : 0, idxRecDat,
+            this->IndexReconstructionData(), irdLastType, irdLastCount);
     }
     this->IndexReconstructionData().EnforceSize(idxRecDat.End(), true);
 }
@@ -10,24 +10,23 @@
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/FilePathParam.h"
 #include "mmcore/param/StringParam.h"
+#include "mmcore/utility/TaskScheduler.h"
 #include "mmcore/utility/log/Log.h"
-#include "mmcore/utility/sys/ConsoleProgressBar.h"
 #include "mmcore/utility/sys/SystemInformation.h"
 #include "stdafx.h"
 #include "vislib/PtrArray.h"
 #include "vislib/RawStorageWriter.h"
 #include "vislib/String.h"
-#include "vislib/StringTokeniser.h"
 #include "vislib/Trace.h"
 #include "vislib/math/ShallowPoint.h"
 #include "vislib/math/ShallowQuaternion.h"
 #include "vislib/math/ShallowVector.h"
-#include "vislib/sys/BufferedFile.h"
-#include "vislib/sys/FastFile.h"
 #include "vislib/sys/Path.h"
 #include "vislib/sys/error.h"
 #include "vislib/sys/sysfunctions.h"
+#include <atomic>
 #include <cstdint>
+#include <unordered_map>
 
 using namespace megamol::core;
 using namespace megamol::moldyn;
@@ -41,6 +40,39 @@ using namespace megamol::moldyn;
 // factor multiplied to the frame size for estimating the overhead to the pure data.
 #define CACHE_FRAME_FACTOR 1.15f
 
+namespace {
+
+/** Answer whether a token starts with "time", ignoring the case. */
+bool startsWithTime(std::string_view token) {
+    static const char time[] = "time";
+    if (token.size() < 4)
+        return false;
+    for (size_t i = 0; i < 4; ++i) {
+        if ((token[i] | 0x20) != time[i])
+            return false;
+    }
+    return true;
+}
+
+/** Answer whether a token equals a lower case keyword, ignoring the case. */
+bool equalsInsensitive(std::string_view token, std::string_view keyword) {
+    if (token.size() != keyword.size())
+        return false;
+    for (size_t i = 0; i < token.size(); ++i) {
+        if ((token[i] | 0x20) != keyword[i])
+            return false;
+    }
+    return true;
+}
+
+/** Lowers an atomic index to value if it is larger. */
+void lowerTo(std::atomic<size_t>& index, size_t value) {
+    size_t current = index.load(std::memory_order_relaxed);
+    while (value < current && !index.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+} // namespace
+
 /*****************************************************************************/
 
 /*
@@ -73,6 +105,7 @@ io::VTFDataSource::Frame::~Frame() {
     this->partCnt.Clear();
     this->pos.Clear();
     this->col.Clear();
+    free(this->clusterInfos.plainData);
 }
 
 
@@ -96,7 +129,7 @@ void io::VTFDataSource::Frame::Clear(void) {
 /*
  * io::VTFDataSource::Frame::LoadFrame
  */
-bool io::VTFDataSource::Frame::LoadFrame(vislib::sys::File* file, unsigned int idx, vislib::Array<SimpleType>& types) {
+bool io::VTFDataSource::Frame::LoadFrame(std::string_view text, unsigned int idx, vislib::Array<SimpleType>& types) {
     /*
             timestep indexed
             0 -1 88.08974923911063 93.53975290469917 41.0842180843088940
@@ -107,43 +140,73 @@ bool io::VTFDataSource::Frame::LoadFrame(vislib::sys::File* file, unsigned int i
     */
 
     this->frame = idx;
-    this->partCnt.Resize(types.Count());
-    this->pos[0].EnforceSize(sizeof(float) * 3 * types[0].GetCount());
-    this->col[0].EnforceSize(sizeof(float) * 4 * types[0].GetCount());
-
-    unsigned int id = 0;
-
-    while (!file->IsEOF()) {
-        vislib::StringA line = vislib::sys::ReadLineFromFileA(*file);
-        line.TrimSpaces();
 
-        vislib::Array<vislib::StringA> shreds = vislib::StringTokeniserA::Split(line, ' ', true);
-
-        if (line.IsEmpty() || line.StartsWithInsensitive("time")) {
-            break;
+    const utility::LineIndex lines(text);
+    const size_t lineCnt = lines.size();
+    this->pos[0].EnforceSize(sizeof(float) * 3 * lineCnt);
+    this->col[0].EnforceSize(sizeof(float) * 4 * lineCnt);
+    float* poss = this->pos[0].As<float>();
+    float* cols = this->col[0].As<float>();
+    std::vector<int> clusterIds(lineCnt);
+
+    // the frame ends at the first empty line or the next time line, every line is parsed independently
+    std::atomic<size_t> end(lineCnt);
+    std::atomic<size_t> malformed(lineCnt);
+    utility::ParallelFor<size_t>(0, lineCnt, 0, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last && i < end.load(std::memory_order_relaxed); ++i) {
+            utility::TextCursor cursor(lines[i]);
+            const std::string_view id = cursor.token();
+            if (id.empty() || startsWithTime(id)) {
+                lowerTo(end, i);
+                break;
+            }
+            int64_t clusterId;
+            float x, y, z;
+            if (!utility::parseInt(cursor.token(), clusterId) || !cursor.parseFloat(x) || !cursor.parseFloat(y) ||
+                !cursor.parseFloat(z)) {
+                lowerTo(malformed, i);
+                lowerTo(end, i);
+                break;
+            }
+            poss[3 * i + 0] = x;
+            poss[3 * i + 1] = y;
+            poss[3 * i + 2] = z;
+            cols[4 * i + 0] = 0.0f; // type
+            cols[4 * i + 1] = static_cast<float>(clusterId);
+            cols[4 * i + 2] = 0.0f;
+            cols[4 * i + 3] = 0.0f;
+            clusterIds[i] = static_cast<int>(clusterId);
         }
-
-        int clusterId = (int)vislib::CharTraitsA::ParseInt(shreds[1]);
-        this->clusterInfos.data[clusterId].Append(id);
-
-        vislib::math::Vector<float, 3> pos;
-        pos.Set((float)vislib::CharTraitsA::ParseDouble(shreds[2]), (float)vislib::CharTraitsA::ParseDouble(shreds[3]),
-            (float)vislib::CharTraitsA::ParseDouble(shreds[4]));
-
-        vislib::math::Vector<float, 4> col;
-        col.Set(0.0f, // type
-            static_cast<float>(clusterId), 0.0f, 0.0f);
-
-
-        //this->pos[0].Append(pos.PeekComponents(), 3 * sizeof(float));
-
-        memcpy(this->pos[0].At(4 * 3 * this->partCnt[0]), pos.PeekComponents(), 3 * sizeof(float));
-        memcpy(this->col[0].At(4 * 4 * this->partCnt[0]), col.PeekComponents(), 4 * sizeof(float));
-
-        ++this->partCnt[0];
-        ++id;
+    });
+    const size_t partCnt = end.load();
+    if (malformed.load() == partCnt) {
+        megamol::core::utility::log::Log::DefaultLog.WriteWarn(
+            "Malformed particle line %u in frame %u, the frame is truncated", static_cast<unsigned int>(partCnt), idx);
+    }
+    this->partCnt[0] = static_cast<unsigned int>(partCnt);
+
+    // group the particles by cluster in order of their first appearance
+    std::unordered_map<int, size_t> clusterIdx;
+    std::vector<int> clusterKeys;
+    std::vector<std::vector<int>> clusterMembers;
+    for (size_t i = 0; i < partCnt; ++i) {
+        auto it = clusterIdx.try_emplace(clusterIds[i], clusterKeys.size()).first;
+        if (it->second == clusterKeys.size()) {
+            clusterKeys.push_back(clusterIds[i]);
+            clusterMembers.emplace_back();
+        }
+        clusterMembers[it->second].push_back(static_cast<int>(i));
+    }
+    this->clusterInfos.data.Clear();
+    for (size_t c = 0; c < clusterKeys.size(); ++c) {
+        vislib::Array<int> members;
+        members.SetCount(clusterMembers[c].size());
+        memcpy(&members[0], clusterMembers[c].data(), sizeof(int) * members.Count());
+        this->clusterInfos.data.Set(clusterKeys[c], members);
     }
+
     // count + start + data
+    free(this->clusterInfos.plainData);
     this->clusterInfos.sizeofPlainData =
         2 * this->clusterInfos.data.Count() * sizeof(int) + this->partCnt[0] * sizeof(int);
     this->clusterInfos.plainData = (unsigned int*)malloc(this->clusterInfos.sizeofPlainData);
@@ -153,7 +216,7 @@ bool io::VTFDataSource::Frame::LoadFrame(vislib::sys::File* file, unsigned int i
     auto it = this->clusterInfos.data.GetConstIterator();
     while (it.HasNext()) {
         const auto current = it.Next();
-        const auto arr = current.Value();
+        const auto& arr = current.Value();
         this->clusterInfos.plainData[ptr++] = static_cast<unsigned int>(arr.Count());
         this->clusterInfos.plainData[ptr++] = summedSizesSoFar;
 
@@ -161,16 +224,6 @@ bool io::VTFDataSource::Frame::LoadFrame(vislib::sys::File* file, unsigned int i
         summedSizesSoFar += static_cast<unsigned int>(arr.Count());
     }
 
-    /*
-    this->col[0].AssertSize(this->partCnt[0] * sizeof(float) * 4);
-    for(unsigned int i = 0; i < this->partCnt[0]; ++i)
-    {
-            *this->col[0].AsAt<float>(4*(4*i + 0)) = 0.5f;
-            *this->col[0].AsAt<float>(4*(4*i + 1)) = 0.5f;
-            *this->col[0].AsAt<float>(4*(4*i + 2)) = 0.5f;
-            *this->col[0].AsAt<float>(4*(4*i + 3)) = 1.0f;
-    }
-    */
     VLTRACE(VISLIB_TRCELVL_INFO, "Frame %u loaded\n", this->frame);
 
     return true;
@@ -255,27 +308,6 @@ const io::VTFDataSource::Frame* io::VTFDataSource::Frame::MakeInterpolationFrame
 }
 
 
-/*
- * io::VTFDataSource::Frame::parseParticleLine
- */
-void io::VTFDataSource::Frame::parseParticleLine(
-    vislib::StringA& line, int& outType, float& outX, float& outY, float& outZ) {
-
-    vislib::Array<vislib::StringA> shreds = vislib::StringTokeniserA::Split(line, ' ', true);
-    if ((shreds.Count() != 9) && (shreds.Count() != 5)) {
-        throw 0; // invalid line separations
-    }
-    if (!shreds[0].Equals("!")) {
-        throw 0; // invalid line marker
-    }
-
-    outType = vislib::CharTraitsA::ParseInt(shreds[1]);
-    outX = float(vislib::CharTraitsA::ParseInt(shreds[2])); // de-quantization of positions is done later
-    outY = float(vislib::CharTraitsA::ParseInt(shreds[3]));
-    outZ = float(vislib::CharTraitsA::ParseInt(shreds[4]));
-}
-
-
 /*
  * io::VTFDataSource::Frame::SetTypeCount
  */
@@ -318,9 +350,9 @@ io::VTFDataSource::VTFDataSource(void)
         , filename("filename", "The path to the trisoup file to load.")
         , getData("getdata", "Slot to request data from this data source.")
         , preprocessSlot("preprocess", "aggregation preprocessing")
+        , file()
         , types()
         , frameIdx()
-        , file(NULL)
         , datahash(0) {
 
     this->filename.SetParameter(new param::FilePathParam(""));
@@ -371,14 +403,16 @@ void io::VTFDataSource::loadFrame(view::AnimDataModule::Frame* frame, unsigned i
     Frame* f = dynamic_cast<Frame*>(frame);
     if (f == NULL)
         return;
-    if (this->file == NULL) {
+    if (this->file.data() == nullptr) {
         f->Clear();
         return;
     }
     ASSERT(idx < this->FrameCount());
 
-    this->file->Seek(this->frameIdx[idx]);
-    f->LoadFrame(this->file, idx, this->types);
+    // the range ends behind the next time line, the frame stops at it
+    const size_t begin = this->frameIdx[idx];
+    const size_t end = (idx + 1 < this->frameIdx.size()) ? this->frameIdx[idx + 1] : this->file.size();
+    f->LoadFrame(this->file.text().substr(begin, end - begin), idx, this->types);
 
     if (this->preprocessSlot.Param<param::BoolParam>()->Value())
         preprocessFrame(*f);
@@ -445,14 +479,9 @@ void io::VTFDataSource::preprocessFrame(Frame& frame) {
  */
 void io::VTFDataSource::release(void) {
     this->resetFrameCache();
-    if (this->file != NULL) {
-        vislib::sys::File* f = this->file;
-        this->file = NULL;
-        f->Close();
-        delete f;
-    }
+    this->file.close();
     this->types.Clear();
-    this->frameIdx.Clear();
+    this->frameIdx.clear();
 }
 
 /*
@@ -461,43 +490,33 @@ void io::VTFDataSource::release(void) {
 bool io::VTFDataSource::filenameChanged(param::ParamSlot& slot) {
 
     this->types.Clear();
-    this->frameIdx.Clear();
+    this->frameIdx.clear();
     this->resetFrameCache();
 
     this->datahash++;
 
-    if (this->file == NULL) {
-        //this->file = new vislib::sys::FastFile();
-        this->file = new vislib::sys::BufferedFile();
-        dynamic_cast<vislib::sys::BufferedFile*>(this->file)->SetBufferSize(2 << 30);
-    } else {
-        this->file->Close();
-    }
+    this->file.close();
     ASSERT(this->filename.Param<param::FilePathParam>() != NULL);
 
-    if (!this->file->Open(this->filename.Param<param::FilePathParam>()->Value().native().c_str(),
-            vislib::sys::File::READ_ONLY, vislib::sys::File::SHARE_READ, vislib::sys::File::OPEN_ONLY)) {
+    if (!this->file.open(this->filename.Param<param::FilePathParam>()->Value().generic_u8string())) {
         vislib::sys::SystemMessage err(::GetLastError());
         megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_ERROR,
             "Unable to open VTF-File \"%s\": %s",
             this->filename.Param<param::FilePathParam>()->Value().generic_u8string().c_str(),
             static_cast<const char*>(err));
 
-        SAFE_DELETE(this->file);
         this->setFrameCount(1);
         this->initFrameCache(1);
 
         return true;
     }
 
-    if (!this->parseHeaderAndFrameIndices(
-            this->filename.Param<param::FilePathParam>()->Value().generic_u8string().c_str())) {
+    if (!this->parseHeaderAndFrameIndices()) {
         megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_ERROR,
             "Unable to read VTF-Header from file \"%s\". Wrong format?",
             this->filename.Param<param::FilePathParam>()->Value().generic_u8string().c_str());
 
-        this->file->Close();
-        SAFE_DELETE(this->file);
+        this->file.close();
         this->setFrameCount(1);
         this->initFrameCache(1);
 
@@ -537,9 +556,7 @@ bool io::VTFDataSource::filenameChanged(param::ParamSlot& slot) {
 /*
  * io::VTFDataSource::readHeader
  */
-bool io::VTFDataSource::parseHeaderAndFrameIndices(const vislib::TString& filename) {
-
-    ASSERT(this->file->Tell() == 0);
+bool io::VTFDataSource::parseHeaderAndFrameIndices(void) {
 
     /*
     pbc 100.0 100.0 100.0
@@ -560,115 +577,72 @@ bool io::VTFDataSource::parseHeaderAndFrameIndices(const vislib::TString& filena
     bool haveAtomType = false;
 
     this->types.Clear();
-
-    vislib::sys::ConsoleProgressBar cpb;
-    cpb.Start("Progress Loading VTF File", static_cast<vislib::sys::ConsoleProgressBar::Size>(this->file->GetSize()));
+    this->frameIdx.clear();
 
     // read the header
-    while (!this->file->IsEOF()) {
-        vislib::sys::File::FileSize currentFileCursor = this->file->Tell();
-        vislib::StringA line = vislib::sys::ReadLineFromFileA(*this->file);
-        line.TrimSpaces();
-
-        if (line.IsEmpty())
-            continue;
-
-        vislib::Array<vislib::StringA> shreds = vislib::StringTokeniserA::Split(line, ' ', true);
-
-        if (!haveBoundingBox) {
-            if (shreds[0].Compare("pbc", false)) {
-                extents.Set((float)vislib::CharTraitsA::ParseDouble(shreds[1]),
-                    (float)vislib::CharTraitsA::ParseDouble(shreds[2]),
-                    (float)vislib::CharTraitsA::ParseDouble(shreds[3]));
-
-                haveBoundingBox = true;
-                continue;
+    const std::string_view text = this->file.text();
+    utility::TextCursor cursor(text);
+    while (!cursor.atEnd() && !(haveBoundingBox && haveAtomType)) {
+        utility::TextCursor line(cursor.line());
+        const std::string_view keyword = line.token();
+
+        if (!haveBoundingBox && equalsInsensitive(keyword, "pbc")) {
+            float x, y, z;
+            if (!line.parseFloat(x) || !line.parseFloat(y) || !line.parseFloat(z)) {
+                return false;
             }
-        }
-        if (!haveAtomType) {
-            if (shreds[0].Compare("atom", false)) {
-                vislib::Array<vislib::StringA> counts = vislib::StringTokeniserA::Split(shreds[1], ':', true);
-
-                SimpleType type;
-                type.SetID(vislib::CharTraitsA::ParseInt(shreds[7]));
-                type.SetRadius((float)vislib::CharTraitsA::ParseDouble(shreds[3]));
-                type.SetCount(vislib::CharTraitsA::ParseInt(counts[1]) - vislib::CharTraitsA::ParseInt(counts[0]) + 1);
-                this->types.Append(type);
-                haveAtomType = true;
-                continue;
+            extents.Set(x, y, z);
+            haveBoundingBox = true;
+
+        } else if (!haveAtomType && equalsInsensitive(keyword, "atom")) {
+            // from:to radius R name N type T
+            std::string_view shreds[7];
+            for (auto& shred : shreds) {
+                shred = line.token();
             }
-        }
-
-        if (haveBoundingBox && haveAtomType) {
-            if (shreds[0].Compare("time", false) && shreds[1].Compare("index", false)) {
-                this->frameIdx.Append(this->file->Tell());
-                cpb.Set(static_cast<vislib::sys::ConsoleProgressBar::Size>(this->file->Tell()));
+            const size_t colon = shreds[0].find(':');
+            int64_t from, to, id;
+            float radius;
+            if (colon == std::string_view::npos || !utility::parseInt(shreds[0].substr(0, colon), from) ||
+                !utility::parseInt(shreds[0].substr(colon + 1), to) || !utility::parseFloat(shreds[2], radius) ||
+                !utility::parseInt(shreds[6], id)) {
+                return false;
             }
-        }
-
-        /*
-vislib::StringA line = vislib::sys::ReadLineFromFileA(*this->file);
-line.TrimSpaces();
 
-if (line.IsEmpty()) {
-    continue;
-
-} else if (line[0] == '~') {
-    SimpleType *element = NULL;
-    try {// a type line!
-        int type;
-        element = this->parseTypeLine(line, type);
-        if (element == NULL) {
-            throw 0;
+            SimpleType type;
+            type.SetID(static_cast<unsigned int>(id));
+            type.SetRadius(radius);
+            type.SetCount(static_cast<unsigned int>(to - from + 1));
+            this->types.Append(type);
+            haveAtomType = true;
         }
+    }
+    if (!(haveBoundingBox && haveAtomType)) {
+        return false;
+    }
 
-        for (unsigned int i = 0; i < types.Count(); i++) {
-            if (types[i].ID() == static_cast<unsigned int>(type)) {
-                if (types[i].Radius() < element->Radius()) {
-                    types[i].SetRadius(element->Radius());
+    // search the time lines of the body in parallel
+    const size_t bodyBegin = static_cast<size_t>(cursor.position() - text.data());
+    const auto chunks = utility::chunkAtLines(text.data() + bodyBegin, text.size() - bodyBegin);
+    std::vector<std::vector<size_t>> chunkFrames(chunks.size() - 1);
+    utility::ParallelFor<size_t>(0, chunks.size() - 1, 1, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; ++c) {
+            utility::TextCursor chunk(text.substr(bodyBegin + chunks[c], chunks[c + 1] - chunks[c]));
+            while (!chunk.atEnd()) {
+                utility::TextCursor line(chunk.line());
+                if (line.keyword("time") && line.keyword("index")) {
+                    chunkFrames[c].push_back(static_cast<size_t>(chunk.position() - text.data()));
                 }
-                element = NULL;
-                break;
             }
         }
-        if (element != NULL) {
-            //type = types.Count;
-            types.Append(*element);
-            types.Last() = *element;
-        }
-        element = NULL;
-    } catch(...) {
-        megamol::core::utility::log::Log::DefaultLog.WriteMsg(50, "Error parsing type line.");
+    });
+    for (const auto& frames : chunkFrames) {
+        this->frameIdx.insert(this->frameIdx.end(), frames.begin(), frames.end());
     }
-    SAFE_DELETE(element);
-} else if (line[0] == '>') {
-    // very extream file redirection
-    vislib::StringW vnfn(vislib::StringA(line.PeekBuffer() + 1));
-    vnfn.TrimSpaces();
-    vislib::StringW base = vislib::sys::Path::Resolve(vislib::StringW(filename));
-    base.Truncate(base.FindLast(vislib::sys::Path::SEPARATOR_W) + 1);
-    vnfn = vislib::sys::Path::Resolve(vnfn, base);
-
-    this->file->Close();
-    if (!this->file->Open(vnfn, vislib::sys::File::READ_ONLY,
-            vislib::sys::File::SHARE_READ,
-            vislib::sys::File::OPEN_ONLY)) {
-
-        SAFE_DELETE(this->file);
+    if (this->frameIdx.empty()) {
         return false;
     }
-
-    this->buildFrameTable();
-    break;
-
-} else if (line[0] == '#') {
-    // beginning of the body!
-    break;
-}
-        */
-    }
-    this->setFrameCount((unsigned int)this->frameIdx.Count());
-    //this->initFrameCache(1);
+    this->setFrameCount(static_cast<unsigned int>(this->frameIdx.size()));
 
     return true;
 }
@@ -686,7 +660,7 @@ bool io::VTFDataSource::getDataCallback(Call& caller) {
         f = dynamic_cast<Frame*>(this->requestLockedFrame(c2->FrameID()));
         if (f == NULL)
             return false;
-        c2->SetDataHash((this->file == NULL) ? 0 : this->datahash);
+        c2->SetDataHash((this->file.data() == nullptr) ? 0 : this->datahash);
         c2->SetUnlocker(new Unlocker(*f));
         c2->SetParticleListCount((unsigned int)this->types.Count());
         for (unsigned int i = 0; i < this->types.Count(); i++) {
@@ -725,7 +699,7 @@ bool io::VTFDataSource::getExtentCallback(Call& caller) {
                 border = r;
         }
 
-        c2->SetDataHash((this->file == NULL) ? 0 : this->datahash);
+        c2->SetDataHash((this->file.data() == nullptr) ? 0 : this->datahash);
         c2->SetFrameCount(this->FrameCount());
         c2->AccessBoundingBoxes().Clear();
         c2->AccessBoundingBoxes().SetObjectSpaceBBox(
@@ -10,13 +10,14 @@
 #include "geometry_calls/MultiParticleDataCall.h"
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/param/ParamSlot.h"
+#include "mmcore/utility/TextParsing.h"
 #include "mmcore/view/AnimDataModule.h"
 #include "vislib/Array.h"
 #include "vislib/Map.h"
 #include "vislib/RawStorage.h"
-#include "vislib/sys/FastFile.h"
-#include "vislib/sys/File.h"
 #include "vislib/types.h"
+#include <string_view>
+#include <vector>
 
 
 namespace megamol {
@@ -289,15 +290,16 @@ private:
         void Clear(void);
 
         /**
-         * Loads a frame from 'file' to this object.
+         * Loads a frame from the text of the file to this object. The
+         * particle lines are parsed in parallel.
          *
-         * @param file The data file.
+         * @param text The text of the frame, starting behind its time line.
          * @param idx The index number of the frame.
          * @param types The types array of the data.
          *
          * @return 'true' on success, 'false' on failure.
          */
-        bool LoadFrame(vislib::sys::File* file, unsigned int idx, vislib::Array<SimpleType>& types);
+        bool LoadFrame(std::string_view text, unsigned int idx, vislib::Array<SimpleType>& types);
 
         /**
          * Sets the number of types of the data set.
@@ -377,20 +379,6 @@ private:
         }
 
     private:
-        /**
-         * Parses a particle line of the vim file.
-         *
-         * @param line The line to parse.
-         * @param outType Receives the type of the parse particle.
-         * @param outX Receives the x component of the position of the
-         *             parsed particle.
-         * @param outY Receives the y component of the position of the
-         *             parsed particle.
-         * @param outZ Receives the z component of the position of the
-         *             parsed particle.
-         */
-        void parseParticleLine(vislib::StringA& line, int& outType, float& outX, float& outY, float& outZ);
-
         /** type count */
         unsigned int typeCnt;
 
@@ -459,13 +447,12 @@ private:
     bool filenameChanged(core::param::ParamSlot& slot);
 
     /**
-     * Reads the file header containing the particle descriptions.
-     *
-     * @param filename The file that is currently loading
+     * Reads the file header containing the particle descriptions and
+     * searches the time lines of all frames in parallel.
      *
      * @return 'true' on success, 'false' on failure.
      */
-    bool parseHeaderAndFrameIndices(const vislib::TString& filename);
+    bool parseHeaderAndFrameIndices(void);
 
     /**
      * Gets the data from the source.
@@ -496,14 +483,14 @@ private:
     /** The slot for requesting data */
     core::CalleeSlot getData;
 
-    /** The opened data file */
-    vislib::sys::File* file;
+    /** The mapped data file */
+    core::utility::MappedFile file;
 
     /** The types */
     vislib::Array<SimpleType> types;
 
-    /** The frame index table */
-    vislib::Array<vislib::sys::File::FileSize> frameIdx;
+    /** The frame index table, offsets of the first line behind each time line */
+    std::vector<size_t> frameIdx;
 
     /** The data file hash */
     SIZE_T datahash;
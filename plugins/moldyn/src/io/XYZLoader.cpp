@@ -10,12 +10,12 @@
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/FilePathParam.h"
 #include "mmcore/param/FloatParam.h"
+#include "mmcore/utility/TaskScheduler.h"
+#include "mmcore/utility/TextParsing.h"
+#include "mmcore/utility/log/Log.h"
 #include "stdafx.h"
-#include "vislib/StringTokeniser.h"
-#include "vislib/sys/FastFile.h"
-#include "vislib/sys/TextFileReader.h"
-#include <deque>
 #include <map>
+#include <string_view>
 
 using namespace megamol;
 using namespace megamol::moldyn;
@@ -156,27 +156,20 @@ void io::XYZLoader::assertData(void) {
     hasElementSymbolSlot.ResetDirty();
     groupByElementSlot.ResetDirty();
 
-    float rad = radiusSlot.Param<core::param::FloatParam>()->Value();
-
-    vislib::sys::FastFile file;
-    if (!file.Open(filenameSlot.Param<core::param::FilePathParam>()->Value().native().c_str(),
-            vislib::sys::File::READ_ONLY, vislib::sys::File::SHARE_READ, vislib::sys::File::OPEN_ONLY)) {
+    core::utility::MappedFile file;
+    if (!file.open(filenameSlot.Param<core::param::FilePathParam>()->Value().generic_u8string())) {
         megamol::core::utility::log::Log::DefaultLog.WriteError("Unable to open file \"%s\"",
             filenameSlot.Param<core::param::FilePathParam>()->Value().generic_u8string().c_str());
         return;
     }
-    vislib::sys::TextFileReader reader(&file);
+    core::utility::TextCursor header(file.text());
 
-    size_t partCnt = -1;
-    vislib::StringA l;
     unsigned int lineNum = 0;
 
     if (hasCountLineSlot.Param<core::param::BoolParam>()->Value()) {
         lineNum++;
-        reader.ReadLine(l);
-        try {
-            partCnt = static_cast<size_t>(vislib::CharTraitsA::ParseUInt64(l.PeekBuffer()));
-        } catch (...) {
+        uint64_t partCnt;
+        if (!core::utility::parseUInt(core::utility::trim(header.line()), partCnt)) {
             megamol::core::utility::log::Log::DefaultLog.WriteWarn(
                 "Unable to parse atom count from first line in \"%s\"",
                 filenameSlot.Param<core::param::FilePathParam>()->Value().generic_u8string().c_str());
@@ -185,58 +178,95 @@ void io::XYZLoader::assertData(void) {
 
     if (hasCommentLineSlot.Param<core::param::BoolParam>()->Value()) {
         lineNum++;
-        reader.ReadLine(l); // just skip the second line
+        header.skipLine(); // just skip the second line
     }
 
-    bool hasEl = hasElementSymbolSlot.Param<core::param::BoolParam>()->Value();
-    bool grpEl = groupByElementSlot.Param<core::param::BoolParam>()->Value();
-    bool warning = true;
-    if (!grpEl)
-        poss.resize(1);
-    std::map<std::string, std::deque<float>> grpDat;
-
-    while (reader.ReadLine(l)) {
-        lineNum++;
-        l.Replace('\t', ' ');
-        vislib::Array<vislib::StringA> parts(vislib::StringTokeniserA::Split(l, ' ', true));
-        if (parts.Count() != (hasEl ? 4 : 3)) {
-            if (warning) {
-                megamol::core::utility::log::Log::DefaultLog.WriteWarn(
-                    "Problem parsing \"%s\":", filenameSlot.Param<core::param::FilePathParam>()->Value());
-                warning = false;
+    const bool hasEl = hasElementSymbolSlot.Param<core::param::BoolParam>()->Value();
+    const bool grpEl = groupByElementSlot.Param<core::param::BoolParam>()->Value();
+    const size_t expected = hasEl ? 4 : 3;
+
+    /** The atoms of a chunk of lines, grouped by element, and the lines that could not be parsed */
+    struct Chunk {
+        std::map<std::string_view, std::vector<float>> groups;
+        size_t lineCnt = 0;
+        std::vector<std::pair<size_t, int>> problems;
+    };
+    enum { TOO_FEW_TOKENS, TOO_MANY_TOKENS, BAD_COORDINATES };
+
+    // the atom lines are parsed in parallel chunks, every chunk starts at a line
+    const size_t bodyBegin = static_cast<size_t>(header.position() - file.data());
+    const auto offsets = core::utility::chunkAtLines(file.data() + bodyBegin, file.size() - bodyBegin);
+    std::vector<Chunk> chunks(offsets.size() - 1);
+    core::utility::ParallelFor<size_t>(0, chunks.size(), 1, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; ++c) {
+            auto& chunk = chunks[c];
+            core::utility::TextCursor cursor(
+                file.data() + bodyBegin + offsets[c], file.data() + bodyBegin + offsets[c + 1]);
+            for (; !cursor.atEnd(); ++chunk.lineCnt) {
+                core::utility::TextCursor line(cursor.line());
+                std::string_view parts[4];
+                size_t partCnt = 0;
+                for (auto part = line.token(); !part.empty(); part = line.token(), ++partCnt) {
+                    if (partCnt < expected) {
+                        parts[partCnt] = part;
+                    }
+                }
+                if (partCnt < expected) {
+                    chunk.problems.emplace_back(chunk.lineCnt, TOO_FEW_TOKENS);
+                    continue;
+                }
+                if (partCnt > expected) {
+                    chunk.problems.emplace_back(chunk.lineCnt, TOO_MANY_TOKENS);
+                }
+                const std::string_view el = (hasEl && grpEl) ? parts[0] : std::string_view();
+                const size_t o = hasEl ? 1 : 0;
+
+                float x, y, z;
+                if (!core::utility::parseFloat(parts[o + 0], x) || !core::utility::parseFloat(parts[o + 1], y) ||
+                    !core::utility::parseFloat(parts[o + 2], z)) {
+                    chunk.problems.emplace_back(chunk.lineCnt, BAD_COORDINATES);
+                    continue;
+                }
+                chunk.groups[el].insert(chunk.groups[el].end(), {x, y, z});
             }
         }
-        if (parts.Count() < (hasEl ? 4 : 3)) {
-            megamol::core::utility::log::Log::DefaultLog.WriteError(
-                "Line %u has too few tokens; line will be ignored", lineNum);
-            continue;
-        }
-        if (parts.Count() > (hasEl ? 4 : 3)) {
-            megamol::core::utility::log::Log::DefaultLog.WriteWarn(
-                "Line %u has too many tokens; trailing tokens will be ignored", lineNum);
-        }
-        std::string el = (hasEl && grpEl) ? parts[0].PeekBuffer() : "";
-        int o = hasEl ? 1 : 0;
-
-        float x = NAN, y = NAN, z = NAN;
-        try {
-            x = static_cast<float>(vislib::CharTraitsA::ParseDouble(parts[o + 0]));
-            y = static_cast<float>(vislib::CharTraitsA::ParseDouble(parts[o + 1]));
-            z = static_cast<float>(vislib::CharTraitsA::ParseDouble(parts[o + 2]));
-        } catch (...) {
+    });
+
+    // report the problems in line order
+    bool warning = true;
+    for (const auto& chunk : chunks) {
+        for (const auto& problem : chunk.problems) {
+            const unsigned int line = lineNum + static_cast<unsigned int>(problem.first) + 1;
             if (warning) {
                 megamol::core::utility::log::Log::DefaultLog.WriteWarn("Problem parsing \"%s\":",
                     filenameSlot.Param<core::param::FilePathParam>()->Value().generic_u8string().c_str());
                 warning = false;
             }
-            megamol::core::utility::log::Log::DefaultLog.WriteError(
-                "Failed to parse coordinates at line %u: (%f, %f, %f); line will be ignored", lineNum, x, y, z);
-            continue;
+            if (problem.second == TOO_FEW_TOKENS) {
+                megamol::core::utility::log::Log::DefaultLog.WriteError(
+                    "Line %u has too few tokens; line will be ignored", line);
+            } else if (problem.second == TOO_MANY_TOKENS) {
+                megamol::core::utility::log::Log::DefaultLog.WriteWarn(
+                    "Line %u has too many tokens; trailing tokens will be ignored", line);
+            } else {
+                megamol::core::utility::log::Log::DefaultLog.WriteError(
+                    "Failed to parse coordinates at line %u; line will be ignored", line);
+            }
         }
+        lineNum += static_cast<unsigned int>(chunk.lineCnt);
+    }
 
-        grpDat[el].push_back(x);
-        grpDat[el].push_back(y);
-        grpDat[el].push_back(z);
+    // merge the chunks in file order, groups are sorted by element
+    std::map<std::string_view, std::vector<float>> grpDat;
+    for (auto& chunk : chunks) {
+        for (auto& g : chunk.groups) {
+            auto& p = grpDat[g.first];
+            if (p.empty()) {
+                p = std::move(g.second);
+            } else {
+                p.insert(p.end(), g.second.begin(), g.second.end());
+            }
+        }
     }
 
     poss.clear();
@@ -245,32 +275,14 @@ void io::XYZLoader::assertData(void) {
     if (grpDat.size() == 0) {
         bbox.Set(-1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f);
     } else {
-        auto i = grpDat.begin()->second.begin();
-        float x = *i;
-        ++i;
-        float y = *i;
-        ++i;
-        float z = *i;
-        bbox.Set(x, y, z, x, y, z);
+        const auto& first = grpDat.begin()->second;
+        bbox.Set(first[0], first[1], first[2], first[0], first[1], first[2]);
     }
 
-    for (const auto& g : grpDat) {
-        poss.push_back(std::vector<float>());
-        auto& p = poss.back();
-        p.clear();
-        p.reserve(g.second.size());
-        auto end = g.second.end();
-        for (auto i = g.second.begin(); i != end;) {
-            float x = *i;
-            ++i;
-            float y = *i;
-            ++i;
-            float z = *i;
-            ++i;
-            bbox.GrowToPoint(x, y, z);
-            p.push_back(x);
-            p.push_back(y);
-            p.push_back(z);
+    for (auto& g : grpDat) {
+        for (size_t i = 0; i < g.second.size(); i += 3) {
+            bbox.GrowToPoint(g.second[i], g.second[i + 1], g.second[i + 2]);
         }
+        poss.push_back(std::move(g.second));
     }
 }
@@ -13,6 +13,7 @@
 #include "io/IMDAtomDataSource.h"
 #include "io/MMPGDDataSource.h"
 #include "io/MMPGDWriter.h"
+#include "io/MMPLDCodecBenchmark.h"
 #include "io/MMPLDDataSource.h"
 #include "io/MMPLDWriter.h"
 #include "io/MMSPDDataSource.h"
@@ -60,6 +61,7 @@ public:
         this->module_descriptions.RegisterAutoDescription<megamol::moldyn::io::MMPGDWriter>();
         this->module_descriptions.RegisterAutoDescription<megamol::moldyn::io::MMPLDDataSource>();
         this->module_descriptions.RegisterAutoDescription<megamol::moldyn::io::MMPLDWriter>();
+        this->module_descriptions.RegisterAutoDescription<megamol::moldyn::io::MMPLDCodecBenchmark>();
         this->module_descriptions.RegisterAutoDescription<megamol::moldyn::io::TestSpheresDataSource>();
 
         // register calls
@@ -6,6 +6,8 @@
 #include "AtomGrid.h"
 #include "stdafx.h"
 
+#include "mmcore/utility/TaskScheduler.h"
+
 using namespace megamol;
 using namespace megamol::molecularmaps;
 
@@ -465,50 +467,16 @@ void AtomGrid::initialize(std::vector<vec4d>& atomVector) {
         this->ring_sizes[i] = 2 * (x * x) + y * ((x * x) - (y * y));
     }
 
-    // Initialise the threads that are used for the computation of the neighbours and the
-    // closest atoms.
-    size_t core_num = Concurrency::details::_CurrentScheduler::_GetNumberOfVirtualProcessors();
-    std::vector<std::thread> cell_threads = std::vector<std::thread>(core_num);
-    size_t part_size = static_cast<size_t>(this->cells.size() / cell_threads.size());
-
-    // Create neighbours of cells.
+    // Create neighbours of cells. The cells are independent of each other, so they are
+    // distributed over the task scheduler.
     this->cell_rings = std::vector<std::vector<std::vector<uint16_t>>>(this->cells.size());
     this->cell_rings.shrink_to_fit();
-    for (size_t i = 0; i < cell_threads.size(); i++) {
-        if (i < cell_threads.size() - 1) {
-            cell_threads[i] =
-                std::thread(std::bind(&AtomGrid::allCellNeighbours, this, i * part_size, (i + 1) * part_size));
-
-        } else {
-            cell_threads[i] =
-                std::thread(std::bind(&AtomGrid::allCellNeighbours, this, i * part_size, this->cells.size()));
-        }
-    }
-
-    // Wait for the create cell threads to finish.
-    for (size_t i = 0; i < cell_threads.size(); i++) {
-        if (cell_threads[i].joinable()) {
-            cell_threads[i].join();
-        }
-    }
-
-    // Insert the atoms in the grid.
-    part_size = static_cast<size_t>(this->atoms.size() / cell_threads.size());
-    for (size_t i = 0; i < cell_threads.size(); i++) {
-        if (i < cell_threads.size() - 1) {
-            cell_threads[i] = std::thread(std::bind(&AtomGrid::insertAtoms, this, i * part_size, (i + 1) * part_size));
-
-        } else {
-            cell_threads[i] = std::thread(std::bind(&AtomGrid::insertAtoms, this, i * part_size, this->atoms.size()));
-        }
-    }
+    core::utility::ParallelFor<size_t>(0, this->cells.size(), 0,
+        [this](const size_t p_begin, const size_t p_end) { this->allCellNeighbours(p_begin, p_end); });
 
-    // Wait for the create cell threads to finish.
-    for (size_t i = 0; i < cell_threads.size(); i++) {
-        if (cell_threads[i].joinable()) {
-            cell_threads[i].join();
-        }
-    }
+    // Insert the atoms in the grid. This is done sequentially, because atoms from different
+    // ranges may end up in the same cell.
+    this->insertAtoms(0, this->atoms.size());
 
     // Set the initalised flag.
     this->isInitializedFlag = true;
@@ -320,7 +320,10 @@ MapGenerator::MapGenerator(void)
     this->vertices_rebuild_ids = std::vector<int>(0);
     this->vertices_sphere = std::vector<float>(0);
 
+    this->recomputeNeeded = false;
     this->voronoiNeeded = false;
+    // The map waiting for the Voronoi diagram is computed in the next frame after the build.
+    this->voronoiCalc.SetBuildFinishedCallback([this]() { this->NotifyOutputChanged(); });
 
     this->writeValueImageParam.SetParameter(new core::param::BoolParam(false));
     this->MakeSlotAvailable(&this->writeValueImageParam);
@@ -3781,12 +3784,27 @@ bool MapGenerator::Render(core::view::CallRender3DGL& call) {
     vec3f eye_dir = vec3f(dir.x, dir.y, dir.z);
     vec3f up_dir = vec3f(dirUp.x, dirUp.y, dirUp.z);
 
-    // Has the input data changed or the shader been reloaded?
-    if (this->lastDataHash != ctmd->DataHash() || this->computeButton.IsDirty() || shaderReloaded ||
-        this->voronoiNeeded) {
-        bool justReload = shaderReloaded && this->lastDataHash == ctmd->DataHash() && !this->computeButton.IsDirty();
-        this->lastDataHash = ctmd->DataHash();
+    // Pressing the recompute button cancels the construction of a Voronoi diagram that is
+    // still in progress and starts it again.
+    if (this->computeButton.IsDirty()) {
         this->computeButton.ResetDirty();
+        this->voronoiCalc.Cancel();
+        this->recomputeNeeded = true;
+    }
+
+    // Has the input data changed or the shader been reloaded? The Voronoi diagram of the
+    // atoms is built in the background, the map is not recomputed before it is available,
+    // so the previous map is rendered in the meantime.
+    bool recompute = this->lastDataHash != ctmd->DataHash() || this->recomputeNeeded || shaderReloaded ||
+                     this->voronoiNeeded;
+    if (recompute && !this->voronoiCalc.Prefetch(mdc)) {
+        this->voronoiNeeded = true;
+        recompute = false;
+    }
+    if (recompute) {
+        bool justReload = shaderReloaded && this->lastDataHash == ctmd->DataHash() && !this->recomputeNeeded;
+        this->lastDataHash = ctmd->DataHash();
+        this->recomputeNeeded = false;
         this->voronoiNeeded = false;
 
         // Initialise computed flags.
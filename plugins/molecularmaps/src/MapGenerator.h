@@ -942,6 +942,9 @@ private:
     /** Calculator for the voronoi protein channels */
     VoronoiChannelCalculator voronoiCalc;
 
+    /** A flag determining whether the recompute button was pressed and the map needs to be recomputed */
+    bool recomputeNeeded;
+
     /** A flag determining whether the voronoi diagram was needed or not */
     bool voronoiNeeded;
 
@@ -7,6 +7,8 @@
 #include "VoronoiChannelCalculator.h"
 #include "stdafx.h"
 
+#include <chrono>
+
 using namespace megamol::core;
 using namespace megamol::molecularmaps;
 using namespace megamol::protein_calls;
@@ -15,192 +17,120 @@ using namespace megamol::protein_calls;
  * VoronoiChannelCalculator::~VoronoiChannelCalculator
  */
 VoronoiChannelCalculator::~VoronoiChannelCalculator(void) {
-    this->stopThreads();
+    this->Cancel();
+    this->waitForBuild();
     this->Release();
 }
 
 /*
  * VoronoiChannelCalculator::VoronoiChannelCalculator
  */
-VoronoiChannelCalculator::VoronoiChannelCalculator(void) : AbstractLocalRenderer(), resultAvailable(false) {}
+VoronoiChannelCalculator::VoronoiChannelCalculator(void)
+        : AbstractLocalRenderer()
+        , atomRadiusMax(0.0f)
+        , atomRadiusMiddle(0.0f)
+        , buildStarted(false)
+        , building(false)
+        , diagramAvailable(false)
+        , probeRadius(0.0f)
+        , resultAvailable(false) {}
 
 /*
- * VoronoiChannelCalculator::checkVertexValidity
+ * VoronoiChannelCalculator::Cancel
  */
-void VoronoiChannelCalculator::checkVertexAndGateValidity(MolecularDataCall* mdc) {
-    // Initialise the valid vertices flag to be valid for all vertices.
-    this->gateValidFlags.resize(this->voronoi_edges.size(), true);
-    this->gateValidFlags.assign(gateValidFlags.size(), true);
-    this->vertexValidFlags.resize(this->voronoi_vertices.size(), true);
-    this->vertexValidFlags.assign(vertexValidFlags.size(), true);
-    size_t filtered_inf_vertices = 0, filtered_radius_vertices = 0, filtered_convex_hull_vertices = 0, i = 0;
-    std::vector<std::pair<size_t, vec4d>> valid_vertices;
-    valid_vertices.reserve(this->voronoi_vertices.size());
-
-    // Loop over all vertices.
-    for (auto it = this->voronoi_vertices.begin(); it != this->voronoi_vertices.end(); it++) {
-        // A vertex is valid if its radius is greater than the probe radius and if it is no infinity vertex.
-        this->vertexValidFlags[i] =
-            ((this->vertices[i].GetW() >= this->probeRadius) && !(it->second.infinity_count > 2));
-        if (this->vertexValidFlags[i]) {
-            valid_vertices.emplace_back(std::make_pair(i, this->vertices[i]));
-        }
-
-        // Check if the vertex radius is smaller than the probe radius.
-        if (this->vertices[i].GetW() < this->probeRadius) {
-            filtered_radius_vertices++;
-        }
+void VoronoiChannelCalculator::Cancel(void) {
+    this->cancellation.Cancel();
+    this->buildStarted = false;
+}
 
-        // Check if the vertex is at infinity, i.e. from that vertex no other vertices could be reached.
-        if (it->second.infinity_count > 2) {
-            filtered_inf_vertices++;
+/*
+ * VoronoiChannelCalculator::checkVertexValidity
+ */
+void VoronoiChannelCalculator::checkVertexAndGateValidity(void) {
+    // Initialise the valid vertices flag to be valid for all vertices. The result of the
+    // convex hull test does not depend on the probe radius, so it is kept until the
+    // diagram changes.
+    this->vertexValidFlags.assign(this->voronoi_vertices.size(), true);
+    this->vertexHullTests.resize(this->voronoi_vertices.size(), HULL_UNTESTED);
+    this->gateValidFlags.assign(this->voronoi_edges.size(), true);
+    this->gateHullTests.resize(this->voronoi_edges.size(), HULL_UNTESTED);
+    std::vector<size_t> untested;
+    untested.reserve(this->voronoi_vertices.size());
+
+    // Loop over all vertices. A vertex is valid if its radius is greater than the probe
+    // radius and if it is no infinity vertex, i.e. from that vertex other vertices could
+    // be reached.
+    for (size_t i = 0; i < this->voronoi_vertices.size(); i++) {
+        const auto& vertex = this->voronoi_vertices[i];
+        this->vertexValidFlags[i] = ((vertex.vertex.GetW() >= this->probeRadius) && !(vertex.infinity_count > 2));
+        if (this->vertexValidFlags[i] && (this->vertexHullTests[i] == HULL_UNTESTED)) {
+            untested.push_back(i);
         }
-        i++;
-    }
-    // megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_INFO, "Filtered %d
-    // voronoi vertices, because their radius was lower than %f", filtered_radius_vertices, this->probeRadius);
-    // megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_INFO, "Filtered %d
-    // voronoi infinity vertices", filtered_inf_vertices);
-
-    // Initialise the threads to test if the vertices are inside or outside of the convex hull.
-    size_t core_num = Concurrency::details::_CurrentScheduler::_GetNumberOfVirtualProcessors();
-    size_t items_per_thread = std::max(static_cast<size_t>(1), valid_vertices.size() / core_num);
-    this->stopThreads();
-
-    // If the last thread has less than items_per_thread vertices to process, we need more than core_num threads in
-    // total.
-    if (valid_vertices.size() % core_num == 0) {
-        this->voronoi_threads = std::vector<std::thread>(core_num);
-
-    } else {
-        this->voronoi_threads = std::vector<std::thread>(core_num + 1);
-    }
-
-    // Convert the atoms to a vec3f representation.
-    std::vector<vec3f> atomData(mdc->AtomCount());
-    auto ptr = mdc->AtomPositions();
-    for (uint i = 0; i < mdc->AtomCount(); i++) {
-        atomData[i].Set(ptr[i * 3 + 0], ptr[i * 3 + 1], ptr[i * 3 + 2]);
     }
 
 #define CONVEX_HULL_FILTERING
 #ifdef CONVEX_HULL_FILTERING
     // Check for all vertices that are still valid if they lie inside the convex hull if not, filter them.
-    size_t begin_index;
-    size_t end_index;
-    for (size_t i = 0; i < this->voronoi_threads.size(); i++) {
-        // Determine the begin and end index for the current thread.
-        if (i < this->voronoi_threads.size() - 1) {
-            begin_index = i * items_per_thread;
-            end_index = (i + 1) * items_per_thread;
-
-        } else {
-            begin_index = i * items_per_thread;
-            end_index = valid_vertices.size();
+    core::utility::ParallelFor<size_t>(0, untested.size(), 0, [this, &untested](size_t p_begin, size_t p_end) {
+        std::vector<vec3f> directions = std::vector<vec3f>(this->hullAtoms.size());
+        for (size_t a = p_begin; a < p_end; a++) {
+            size_t idx = untested[a];
+            this->vertexHullTests[idx] =
+                Computations::LiesInsideConvexHull(this->hullAtoms, this->voronoi_vertices[idx].vertex, directions)
+                    ? HULL_INSIDE
+                    : HULL_OUTSIDE;
         }
-
-        // Start the thread with the current begin and end index.
-        this->voronoi_threads[i] = std::thread([&valid_vertices, this, &atomData, begin_index, end_index] {
-            std::vector<vec3f> directions = std::vector<vec3f>(atomData.size());
-            for (size_t a = begin_index; a < end_index; a++) {
-                size_t idx = valid_vertices[a].first;
-                this->vertexValidFlags[idx] =
-                    Computations::LiesInsideConvexHull(atomData, valid_vertices[a].second, directions);
-            }
-        });
+    });
+    for (size_t i = 0; i < this->voronoi_vertices.size(); i++) {
+        this->vertexValidFlags[i] = this->vertexValidFlags[i] && (this->vertexHullTests[i] == HULL_INSIDE);
     }
-
-    // Wait for the threads to finish.
-    this->stopThreads();
 #endif /* #ifdef CONVEX_HULL_FILTERING */
 
-    std::vector<std::pair<size_t, vec4d>> valid_gates;
-    valid_gates.reserve(this->voronoi_edges.size());
-
     // filter the gates also
-    i = 0;
-    for (auto it = this->voronoi_edges.begin(); it != this->voronoi_edges.end(); it++) {
-        this->gateValidFlags[i] = (it->gate_sphere.GetW() >= this->probeRadius);
-        if (this->gateValidFlags[i]) {
-            valid_gates.emplace_back(std::make_pair(i, it->gate_sphere));
+    untested.clear();
+    for (size_t i = 0; i < this->voronoi_edges.size(); i++) {
+        this->gateValidFlags[i] = (this->voronoi_edges[i].gate_sphere.GetW() >= this->probeRadius);
+        if (this->gateValidFlags[i] && (this->gateHullTests[i] == HULL_UNTESTED)) {
+            untested.push_back(i);
         }
-        i++;
-    }
-
-    items_per_thread = std::max(static_cast<size_t>(1), valid_gates.size() / core_num);
-
-    if (valid_gates.size() % core_num == 0) {
-        this->voronoi_threads = std::vector<std::thread>(core_num);
-    } else {
-        this->voronoi_threads = std::vector<std::thread>(core_num + 1);
     }
 
 #ifdef CONVEX_HULL_FILTERING
-    for (size_t i = 0; i < this->voronoi_threads.size(); i++) {
-        // Determine the begin and end index for the current thread.
-        if (i < this->voronoi_threads.size() - 1) {
-            begin_index = i * items_per_thread;
-            end_index = (i + 1) * items_per_thread;
-
-        } else {
-            begin_index = i * items_per_thread;
-            end_index = valid_gates.size();
+    core::utility::ParallelFor<size_t>(0, untested.size(), 0, [this, &untested](size_t p_begin, size_t p_end) {
+        std::vector<vec3f> directions = std::vector<vec3f>(this->hullAtoms.size());
+        for (size_t a = p_begin; a < p_end; a++) {
+            size_t idx = untested[a];
+            this->gateHullTests[idx] =
+                Computations::LiesInsideConvexHull(this->hullAtoms, this->voronoi_edges[idx].gate_sphere, directions)
+                    ? HULL_INSIDE
+                    : HULL_OUTSIDE;
         }
-
-        // Start the thread with the current begin and end index.
-        this->voronoi_threads[i] = std::thread([&valid_gates, this, &atomData, begin_index, end_index] {
-            std::vector<vec3f> directions = std::vector<vec3f>(atomData.size());
-            for (size_t a = begin_index; a < end_index; a++) {
-                size_t idx = valid_gates[a].first;
-                this->gateValidFlags[idx] =
-                    Computations::LiesInsideConvexHull(atomData, valid_gates[a].second, directions);
-            }
-        });
+    });
+    for (size_t i = 0; i < this->voronoi_edges.size(); i++) {
+        this->gateValidFlags[i] = this->gateValidFlags[i] && (this->gateHullTests[i] == HULL_INSIDE);
     }
-    this->stopThreads();
 #endif /* #ifdef CONVEX_HULL_FILTERING */
 }
 
 /*
  * VoronoiChannelCalculator::constructVoronoiDiagram
  */
-bool VoronoiChannelCalculator::constructVoronoiDiagram(MolecularDataCall* mdc) {
+bool VoronoiChannelCalculator::constructVoronoiDiagram(core::utility::CancellationToken token) {
     // Delete the old computed Voronoi Diagram.
-    this->edge_neighbours.clear();
-    this->gates.clear();
+    this->gateHullTests.clear();
     this->gateValidFlags.clear();
-    this->vertexMap.clear();
+    this->vertexHullTests.clear();
+    this->vertexIDs.clear();
     this->vertexValidFlags.clear();
-    this->vertices.clear();
     this->voronoi_vertices.clear();
     this->voronoi_edges.clear();
 
-    // Remove the remaining gates in the queue.
-    this->gatesToTest_one.clear();
-    this->gatesToTest_two.clear();
-
-    // Get the true bounding box of the molecule. Then shrink the bounding box by 3 A
-    // in each direction to fit tightly
-    auto bb = mdc->AccessBoundingBoxes().ObjectSpaceBBox();
-    bb.Grow(-3.0f);
-
-    // Calculate the maximal and the middle atom radius.
-    float rMax = FLT_MIN;
-    for (unsigned int i = 0; i < mdc->AtomTypeCount(); i++) {
-        if (mdc->AtomTypes()[i].Radius() > rMax) {
-            rMax = mdc->AtomTypes()[i].Radius();
-        }
-    }
-    float rMiddle = 0.0f;
-    for (unsigned int i = 0; i < mdc->AtomCount(); i++) {
-        rMiddle += mdc->AtomTypes()[mdc->AtomTypeIndices()[i]].Radius();
-    }
-    rMiddle /= static_cast<float>(mdc->AtomCount());
-
     // Compute the 4 start vertices.
+    const auto& bb = this->atomBBox;
+    const float rMiddle = this->atomRadiusMiddle;
     auto bbcenter = bb.CalcCenter();
     float movement = bb.GetLeft() - bbcenter.GetX();
-    float constant = rMax * 2.5f;
+    float constant = this->atomRadiusMax * 2.5f;
     float plane = bbcenter.GetX() + movement - constant * rMiddle;
 
     vec4d start1(plane, bbcenter.GetY() + constant * rMiddle, bbcenter.GetZ(), rMiddle * 0.9);
@@ -223,15 +153,8 @@ bool VoronoiChannelCalculator::constructVoronoiDiagram(MolecularDataCall* mdc) {
     }
     auto centroid = sphereVec[0];
 
-    // Copy the atom data.
-    std::vector<vec4d> atomData(mdc->AtomCount());
-    auto ptr = mdc->AtomPositions();
-    for (uint i = 0; i < mdc->AtomCount(); i++) {
-        atomData[i].Set(
-            ptr[i * 3 + 0], ptr[i * 3 + 1], ptr[i * 3 + 2], mdc->AtomTypes()[mdc->AtomTypeIndices()[i]].Radius());
-    }
-
     // Add the four start vertices to the atom list. They will be removed later on.
+    std::vector<vec4d> atomData(this->atoms);
     atomData.push_back(start1);
     atomData.push_back(start2);
     atomData.push_back(start3);
@@ -240,352 +163,287 @@ bool VoronoiChannelCalculator::constructVoronoiDiagram(MolecularDataCall* mdc) {
     // Create a search grid for the atoms.
     this->searchGrid.Init(atomData);
 
-    // Add every possible gate of the start cell to a data structure.
+    // Gate definition: 1 start voronoi sphere as vec4d + 3 gate sphere indices followed
+    // by the index of the fourth vertex stored in an array. The fifth value is the
+    // Voronoi vertex ID this can be ignored for now. Initialise the start gates.
     uint s1Idx = static_cast<uint>(this->searchGrid.GetAtoms().size() - 4);
     uint s2Idx = static_cast<uint>(this->searchGrid.GetAtoms().size() - 3);
     uint s3Idx = static_cast<uint>(this->searchGrid.GetAtoms().size() - 2);
     uint s4Idx = static_cast<uint>(this->searchGrid.GetAtoms().size() - 1);
-    std::pair<vec4d, std::array<uint, 5>> g1(centroid, {s1Idx, s2Idx, s3Idx, s4Idx, 0});
-    std::pair<vec4d, std::array<uint, 5>> g2(centroid, {s2Idx, s3Idx, s4Idx, s1Idx, 0});
-    std::pair<vec4d, std::array<uint, 5>> g3(centroid, {s1Idx, s3Idx, s4Idx, s2Idx, 0});
-    std::pair<vec4d, std::array<uint, 5>> g4(centroid, {s1Idx, s2Idx, s4Idx, s3Idx, 0});
-
-    // Gate definition: 1 start voronoi sphere as vec4d + 3 gate sphere indices followed
-    // by the index of the fourth vertex stored in an array. The fifth value is the
-    // Voronoi vertex ID this can be ignored for now. Initialise the start gates.
-    this->gatesToTest_one.reserve(2 * this->searchGrid.GetAtoms().size());
-    this->gatesToTest_two.reserve(2 * this->searchGrid.GetAtoms().size());
-    this->active_gates = 0;
-    this->gatesToTest_one.push_back(g4);
-    this->gatesToTest_one.push_back(g3);
-    this->gatesToTest_one.push_back(g2);
-    this->gatesToTest_one.push_back(g1);
-
-    // Initialise the loop that looks for the initial Voronoi Vertex.
-    this->initVertexFound = false;
-
-    // This loop processes each element in the queue and tries to find a corresponding
-    // end vertex for each of them. If the end vertex is only defined by "real" atoms,
-    // we have found the initial voronoi vertex, if not we add three new gates to the
-    // queue.
-    size_t core_num = Concurrency::details::_CurrentScheduler::_GetNumberOfVirtualProcessors();
-    this->stopThreads();
-    this->voronoi_threads = std::vector<std::thread>(core_num);
-    uint stop = 0;
-    while (stop != 2) {
-        // Compute the active gates and push the new gates to the inactive queue.
-        stop = 0;
-        for (size_t i = 0; i < this->voronoi_threads.size(); i++) {
-            this->voronoi_threads[i] = std::thread(std::bind(&VoronoiChannelCalculator::nextVoronoiVertexInit, this));
+    std::vector<Gate> gates;
+    gates.reserve(2 * this->searchGrid.GetAtoms().size());
+    gates.emplace_back(centroid, std::array<uint, 5>{s1Idx, s2Idx, s3Idx, s4Idx, 0});
+    gates.emplace_back(centroid, std::array<uint, 5>{s2Idx, s3Idx, s4Idx, s1Idx, 0});
+    gates.emplace_back(centroid, std::array<uint, 5>{s1Idx, s3Idx, s4Idx, s2Idx, 0});
+    gates.emplace_back(centroid, std::array<uint, 5>{s1Idx, s2Idx, s4Idx, s3Idx, 0});
+    std::vector<Gate> nextGates;
+    nextGates.reserve(gates.capacity());
+    std::vector<GateResult> results;
+
+    // This loop processes the gates wave by wave and tries to find a corresponding end
+    // vertex for each of them. If the end vertex is only defined by "real" atoms, we
+    // have found the initial voronoi vertex, if not we add three new gates to the next
+    // wave. The first such gate of a wave wins, so the result is reproducible.
+    bool initVertexFound = false;
+    vec4d initVertex;
+    vec4ui initVertexBorder;
+    const uint thresh = s1Idx;
+    while (!gates.empty() && !initVertexFound) {
+        if (!this->nextVoronoiVertices(gates, results, token)) {
+            return false;
         }
 
-        // Wait for all threads to finish and swap the active an inactive queue.
-        this->stopThreads();
-        this->active_gates = (this->active_gates + 1) % 2;
+        nextGates.clear();
+        for (size_t i = 0; (i < gates.size()) && !initVertexFound; i++) {
+            const auto& gate = gates[i].second;
+            if (results[i].atom < 0) {
+                continue;
+            }
 
-        // Stop if either both gate queues are empty or if the initial vertex is found.
-        if (this->gatesToTest_one.empty()) {
-            stop++;
-        }
-        if (this->gatesToTest_two.empty()) {
-            stop++;
-        }
-        if (this->initVertexFound) {
-            stop = 2;
+            const auto minIdx = static_cast<uint>(results[i].atom);
+            if (gate[0] < thresh && gate[1] < thresh && gate[2] < thresh && minIdx < thresh) {
+                initVertexFound = true;
+                initVertexBorder = vec4ui(gate[0], gate[1], gate[2], minIdx);
+                initVertex = results[i].vertex;
+
+            } else {
+                nextGates.emplace_back(results[i].vertex, std::array<uint, 5>{minIdx, gate[0], gate[1], gate[2], 0});
+                nextGates.emplace_back(results[i].vertex, std::array<uint, 5>{minIdx, gate[1], gate[2], gate[0], 0});
+                nextGates.emplace_back(results[i].vertex, std::array<uint, 5>{minIdx, gate[0], gate[2], gate[1], 0});
+            }
         }
+        gates.swap(nextGates);
     }
 
-    if (!this->initVertexFound) {
+    if (!initVertexFound) {
         megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_ERROR,
             "No initial Voronoi vertex could be found!"
             "\nPlease contact the developer to fix this.\n");
         return false;
     }
 
-    // Remove the remaining gates in the queue.
-    this->gatesToTest_one.clear();
-    this->gatesToTest_two.clear();
-
     // Remove the start spheres from the list of atoms.
     this->searchGrid.RemoveStartSpheres();
 
     // Create the new gates for the start vertex.
-    s1Idx = this->initVertexBorder[0];
-    s2Idx = this->initVertexBorder[1];
-    s3Idx = this->initVertexBorder[2];
-    s4Idx = this->initVertexBorder[3];
-    g1.first = this->initVertex;
-    g1.second = {s1Idx, s2Idx, s3Idx, s4Idx, 0};
-    g2.first = this->initVertex;
-    g2.second = {s2Idx, s3Idx, s4Idx, s1Idx, 0};
-    g3.first = this->initVertex;
-    g3.second = {s1Idx, s3Idx, s4Idx, s2Idx, 0};
-    g4.first = this->initVertex;
-    g4.second = {s1Idx, s2Idx, s4Idx, s3Idx, 0};
-
-    // Put the gate in the active queue.
-    this->active_gates = 0;
-    this->gatesToTest_one.push_back(g4);
-    this->gatesToTest_one.push_back(g3);
-    this->gatesToTest_one.push_back(g2);
-    this->gatesToTest_one.push_back(g1);
+    s1Idx = initVertexBorder[0];
+    s2Idx = initVertexBorder[1];
+    s3Idx = initVertexBorder[2];
+    s4Idx = initVertexBorder[3];
+    gates.clear();
+    gates.emplace_back(initVertex, std::array<uint, 5>{s1Idx, s2Idx, s3Idx, s4Idx, 0});
+    gates.emplace_back(initVertex, std::array<uint, 5>{s2Idx, s3Idx, s4Idx, s1Idx, 0});
+    gates.emplace_back(initVertex, std::array<uint, 5>{s1Idx, s3Idx, s4Idx, s2Idx, 0});
+    gates.emplace_back(initVertex, std::array<uint, 5>{s1Idx, s2Idx, s4Idx, s3Idx, 0});
 
     // Initialise the list of Voronoi vertices and edges.
     this->voronoi_edges.reserve(20 * this->searchGrid.GetAtoms().size());
-    this->vertices.reserve(20 * this->searchGrid.GetAtoms().size());
+    this->voronoi_vertices.reserve(10 * this->searchGrid.GetAtoms().size());
+    this->vertexIDs.reserve(10 * this->searchGrid.GetAtoms().size());
 
     // Convert the intial Voronoi vertex to a Voronoi vertex and add it to the list.
-    this->voronoi_id = 0;
-    auto vertex = VoronoiVertex(initVertexBorder, this->voronoi_id++);
-    this->voronoi_vertices.insert(std::pair<uint64_t, VoronoiVertex>(vertex.vertex_hash, vertex));
-    this->vertices.push_back(this->initVertex);
-
-    // Use the threadpool to compute all Voronoi vertices.
-    this->stopThreads();
-    this->voronoi_threads = std::vector<std::thread>(core_num);
-    stop = 0;
-    while (stop != 2) {
-        // Compute the active gates and push the new gates to the inactive queue.
-        stop = 0;
-        for (size_t i = 0; i < this->voronoi_threads.size(); i++) {
-            this->voronoi_threads[i] = std::thread(std::bind(&VoronoiChannelCalculator::nextVoronoiVertex, this));
+    this->voronoi_vertices.emplace_back(initVertexBorder, 0, 0, initVertex);
+    this->vertexIDs.emplace(this->voronoi_vertices.back().vertex_hash, 0);
+
+    // Compute all Voronoi vertices. The end vertices of a wave are searched in parallel,
+    // the new vertices, edges and gates are added in the order of the gates.
+    auto lastReport = std::chrono::steady_clock::now();
+    while (!gates.empty()) {
+        if (!this->nextVoronoiVertices(gates, results, token)) {
+            return false;
         }
 
-        // Wait for all threads to finish and swap the active an inactive queue.
-        this->stopThreads();
-        this->active_gates = (this->active_gates + 1) % 2;
+        nextGates.clear();
+        for (size_t i = 0; i < gates.size(); i++) {
+            const auto& gate = gates[i];
+            if (results[i].atom >= 0) {
+                // Create the new Voronoi vertex and check if it already exists.
+                const auto minIdx = static_cast<uint>(results[i].atom);
+                VoronoiVertex vertex(vec4ui(gate.second[0], gate.second[1], gate.second[2], minIdx),
+                    static_cast<uint>(this->voronoi_vertices.size()), 0, results[i].vertex);
+                auto it = this->vertexIDs.emplace(vertex.vertex_hash, vertex.id);
+                if (it.second) {
+                    // The vertex is new so add it to the list and create the three new gates.
+                    this->voronoi_vertices.push_back(vertex);
+                    nextGates.emplace_back(results[i].vertex,
+                        std::array<uint, 5>{minIdx, gate.second[0], gate.second[1], gate.second[2], vertex.id});
+                    nextGates.emplace_back(results[i].vertex,
+                        std::array<uint, 5>{minIdx, gate.second[1], gate.second[2], gate.second[0], vertex.id});
+                    nextGates.emplace_back(results[i].vertex,
+                        std::array<uint, 5>{minIdx, gate.second[0], gate.second[2], gate.second[1], vertex.id});
+                }
+
+                // Create the edge between the vertex we came from and the end vertex.
+                this->voronoi_edges.emplace_back(it.first->second, gate.first, gate.second[4]);
 
-        // If both queues are empty we found all vertices.
-        if (this->gatesToTest_one.empty()) {
-            stop++;
+            } else {
+                // There is no end vertex, so increase the infinity counter of the vertex we came from.
+                this->voronoi_vertices[gate.second[4]].infinity_count++;
+            }
         }
-        if (this->gatesToTest_two.empty()) {
-            stop++;
+        gates.swap(nextGates);
+
+        // Report the progress, the construction takes minutes for large proteins.
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastReport > std::chrono::seconds(2)) {
+            lastReport = now;
+            megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_INFO,
+                "Voronoi diagram: %zu vertices, %zu edges, %zu open gates.", this->voronoi_vertices.size(),
+                this->voronoi_edges.size(), gates.size());
         }
     }
 
-    // Clear the search grid and free all used memory.
-    std::thread cleanup([&]() { this->searchGrid.ClearSearchGrid(); });
-    cleanup.detach();
+    megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_INFO,
+        "Computed the Voronoi diagram with %zu vertices and %zu edges.", this->voronoi_vertices.size(),
+        this->voronoi_edges.size());
 
     return true;
 }
 
 /*
- * VoronoiChannelCalculator::nextVoronoiVertex
+ * VoronoiChannelCalculator::IsBuilding
  */
-void VoronoiChannelCalculator::nextVoronoiVertex() {
-    std::array<vec3d, 2> circles{vec3d(), vec3d()};
-    std::pair<vec4d, std::array<uint, 5>> gate;
-    std::array<vec4d, 2> gateCenter{vec4d(), vec4d()};
-    std::array<vec4d, 2> incircle{vec4d(), vec4d()};
-    std::array<vec4d, 2> sphereVec{vec4d(), vec4d()};
-    bool stop = false;
-    while (!stop) {
-        // Get the gate and remove it from the queue.
-        this->voronoi_mutex.lock();
-        if (this->active_gates == 0) {
-            // If the thread waited so long that the active queue is now empty we can stop it.
-            if (this->gatesToTest_one.empty()) {
-                this->voronoi_mutex.unlock();
-                break;
-            }
-
-            // Get the last element from the queue and process it.
-            gate = this->gatesToTest_one.back();
-            this->gatesToTest_one.pop_back();
+bool VoronoiChannelCalculator::IsBuilding(void) const {
+    return this->building.load();
+}
 
-        } else {
-            // If the thread waited so long that the active queue is now empty we can stop it.
-            if (this->gatesToTest_two.empty()) {
-                this->voronoi_mutex.unlock();
-                break;
+/*
+ * VoronoiChannelCalculator::nextVoronoiVertices
+ */
+bool VoronoiChannelCalculator::nextVoronoiVertices(
+    const std::vector<Gate>& p_gates, std::vector<GateResult>& p_results, core::utility::CancellationToken token) {
+    p_results.resize(p_gates.size());
+    core::utility::ParallelFor<size_t>(
+        0, p_gates.size(), 0,
+        [this, &p_gates, &p_results](size_t p_begin, size_t p_end) {
+            std::array<vec3d, 2> circles{vec3d(), vec3d()};
+            std::array<vec4d, 2> gateCenter{vec4d(), vec4d()};
+            std::array<vec4d, 2> incircle{vec4d(), vec4d()};
+            const auto& atoms = this->searchGrid.GetAtoms();
+            for (size_t i = p_begin; i < p_end; i++) {
+                // Create the vector that contains all three gate spheres.
+                const auto& gate = p_gates[i];
+                std::array<vec4d, 4> gateVector{
+                    atoms[gate.second[0]], atoms[gate.second[1]], atoms[gate.second[2]], vec4d()};
+
+                // Get the gate centers, we only need the first one, i.e. the one with the smaller radius.
+                Computations::ComputeGateCenter(gateVector, gateCenter, incircle, circles);
+
+                // Compute the pivot point of the current gate.
+                vec3d pivot = Computations::ComputePivot(gateVector);
+
+                // Compute the next voronoi vertex.
+                EndVertexParams params = EndVertexParams(gate, gateCenter, gateVector, pivot);
+                vec4d edgeEndResult;
+                p_results[i].atom = this->searchGrid.GetEndVertex(params, edgeEndResult);
+                p_results[i].vertex = edgeEndResult;
             }
+        },
+        token);
+    return !token.IsCancelled();
+}
 
-            // Get the last element from the queue and process it.
-            gate = this->gatesToTest_two.back();
-            this->gatesToTest_two.pop_back();
-        }
-        this->voronoi_mutex.unlock();
-
-        // Create the vector that contains all three gate spheres.
-        std::array<vec4d, 4> gateVector{this->searchGrid.GetAtoms()[gate.second[0]],
-            this->searchGrid.GetAtoms()[gate.second[1]], this->searchGrid.GetAtoms()[gate.second[2]], vec4d()};
-
-        // Get the gate centers, we only need the first one, i.e. the one with the smaller radius.
-        auto gateCenter_cnt = Computations::ComputeGateCenter(gateVector, gateCenter, incircle, circles);
-
-        // Compute the pivot point of the current gate.
-        vec3d pivot = Computations::ComputePivot(gateVector);
-
-        // Compute the next voronoi vertex.
-        EndVertexParams params = EndVertexParams(gate, gateCenter, gateVector, pivot);
-        vec4d edgeEndResult;
-        int minIdx = this->searchGrid.GetEndVertex(params, edgeEndResult);
-
-        // Did we find a result for the currently processed gate?
-        if (minIdx >= 0) {
-            // Create the new Voronoi vertex and check if it already exists.
-            this->voronoi_mutex.lock();
-            VoronoiVertex possible_vertex =
-                VoronoiVertex(vec4ui(gate.second[0], gate.second[1], gate.second[2], minIdx), 0);
-            auto it = this->voronoi_vertices.find(possible_vertex.vertex_hash);
-            if (it == this->voronoi_vertices.end()) {
-                // The vertex is new so add it to the list and create the edge between the vertex we came from and the
-                // new vertex.
-                possible_vertex.id = this->voronoi_id++;
-                this->voronoi_vertices.insert(
-                    std::pair<uint64_t, VoronoiVertex>(possible_vertex.vertex_hash, possible_vertex));
-                this->voronoi_edges.push_back(VoronoiEdge(possible_vertex.id, gate.first, gate.second[4]));
-                this->vertices.push_back(edgeEndResult);
-                this->voronoi_mutex.unlock();
-
-                // Create the three new gates.
-                std::pair<vec4d, std::array<uint, 5>> new1(edgeEndResult,
-                    {static_cast<uint>(minIdx), gate.second[0], gate.second[1], gate.second[2], possible_vertex.id});
-                std::pair<vec4d, std::array<uint, 5>> new2(edgeEndResult,
-                    {static_cast<uint>(minIdx), gate.second[1], gate.second[2], gate.second[0], possible_vertex.id});
-                std::pair<vec4d, std::array<uint, 5>> new3(edgeEndResult,
-                    {static_cast<uint>(minIdx), gate.second[0], gate.second[2], gate.second[1], possible_vertex.id});
-
-                // Add the new gates to the inactive queue.
-                this->voronoi_mutex.lock();
-                if (this->active_gates == 0) {
-                    this->gatesToTest_two.push_back(new3);
-                    this->gatesToTest_two.push_back(new2);
-                    this->gatesToTest_two.push_back(new1);
-
-                } else {
-                    this->gatesToTest_one.push_back(new3);
-                    this->gatesToTest_one.push_back(new2);
-                    this->gatesToTest_one.push_back(new1);
-                }
-                this->voronoi_mutex.unlock();
+/*
+ * VoronoiChannelCalculator::Prefetch
+ */
+bool VoronoiChannelCalculator::Prefetch(MolecularDataCall* mdc) {
+    // Without data there is nothing to wait for, Update reports the error.
+    if ((mdc == nullptr) || (mdc->AtomCount() == 0)) {
+        return true;
+    }
 
-            } else {
-                // The vertex already exists so create the edge.
-                this->voronoi_edges.push_back(VoronoiEdge(it->second.id, gate.first, gate.second[4]));
-                this->voronoi_mutex.unlock();
-            }
+    // The diagram for the data has been built or is being built.
+    if (this->buildStarted && (mdc->DataHash() == this->lastDataHash)) {
+        return !this->building.load();
+    }
 
-        } else {
-            // Compute the hash value of the voronoi vertex and increase the infinity counter.
-            this->voronoi_mutex.lock();
-            auto vertex_hash =
-                VoronoiVertex::ComputeHash(vec4ui(gate.second[0], gate.second[1], gate.second[2], gate.second[3]));
-            auto it = this->voronoi_vertices.find(vertex_hash);
-            if (it != this->voronoi_vertices.end()) {
-                it->second.infinity_count++;
-            }
-            this->voronoi_mutex.unlock();
-        }
+    // Stop the build for the previous data. It works on the members set up below, so
+    // the new build can only start once its task has returned. The task still calls the
+    // build finished callback after publishing its result, hence the flag is not enough.
+    this->Cancel();
+    if (this->isBuildRunning()) {
+        return false;
+    }
+    this->diagramAvailable = false;
+    this->resultAvailable = false;
+    this->lastDataHash = mdc->DataHash();
 
-        // Check if we need to stop the thread because all gates have been processed.
-        if (this->active_gates == 0) {
-            stop = this->gatesToTest_one.empty();
+    // Get the true bounding box of the molecule. Then shrink the bounding box by 3 A
+    // in each direction to fit tightly
+    this->atomBBox = mdc->AccessBoundingBoxes().ObjectSpaceBBox();
+    this->atomBBox.Grow(-3.0f);
 
-        } else {
-            stop = this->gatesToTest_two.empty();
+    // Calculate the maximal and the middle atom radius.
+    this->atomRadiusMax = FLT_MIN;
+    for (unsigned int i = 0; i < mdc->AtomTypeCount(); i++) {
+        if (mdc->AtomTypes()[i].Radius() > this->atomRadiusMax) {
+            this->atomRadiusMax = mdc->AtomTypes()[i].Radius();
         }
     }
-}
+    this->atomRadiusMiddle = 0.0f;
+    for (unsigned int i = 0; i < mdc->AtomCount(); i++) {
+        this->atomRadiusMiddle += mdc->AtomTypes()[mdc->AtomTypeIndices()[i]].Radius();
+    }
+    this->atomRadiusMiddle /= static_cast<float>(mdc->AtomCount());
 
-/*
- * VoronoiChannelCalculator::nextVoronoiVertexInit
- */
-void VoronoiChannelCalculator::nextVoronoiVertexInit() {
-    std::array<vec3d, 2> circles{vec3d(), vec3d()};
-    std::pair<vec4d, std::array<uint, 5>> gate;
-    std::array<vec4d, 2> gateCenter{vec4d(), vec4d()};
-    std::array<vec4d, 2> incircle{vec4d(), vec4d()};
-    std::array<vec4d, 2> sphereVec{vec4d(), vec4d()};
-    bool stop = false;
-    while (!stop && !this->initVertexFound) {
-        // Get the gate and remove it from the queue.
-        this->voronoi_mutex.lock();
-        if (this->active_gates == 0) {
-            // If the thread waited so long that the active queue is now empty we can stop it.
-            if (this->gatesToTest_one.empty()) {
-                this->voronoi_mutex.unlock();
-                break;
-            }
+    // Copy the atom data, because the call is not valid any more while the diagram is built.
+    this->atoms.resize(mdc->AtomCount());
+    this->hullAtoms.resize(mdc->AtomCount());
+    auto ptr = mdc->AtomPositions();
+    for (uint i = 0; i < mdc->AtomCount(); i++) {
+        this->atoms[i].Set(
+            ptr[i * 3 + 0], ptr[i * 3 + 1], ptr[i * 3 + 2], mdc->AtomTypes()[mdc->AtomTypeIndices()[i]].Radius());
+        this->hullAtoms[i].Set(ptr[i * 3 + 0], ptr[i * 3 + 1], ptr[i * 3 + 2]);
+    }
 
-            // Get the last element from the queue and process it.
-            gate = this->gatesToTest_one.back();
-            this->gatesToTest_one.pop_back();
+    // Build the diagram in a low priority task, which only workers pick up. The construction
+    // checks the token itself instead of passing it to the scheduler, so the task always
+    // runs and reports that the build has stopped.
+    this->buildStarted = true;
+    this->building.store(true);
+    this->cancellation = core::utility::CancellationSource();
+    this->build = core::utility::TaskScheduler::Instance().Submit(
+        [this, token = this->cancellation.Token()]() {
+            try {
+                this->diagramAvailable = this->constructVoronoiDiagram(token);
+            } catch (std::exception const& ex) {
+                megamol::core::utility::log::Log::DefaultLog.WriteError(
+                    "The construction of the Voronoi diagram failed: %s", ex.what());
+                this->diagramAvailable = false;
+            }
 
-        } else {
-            // If the thread waited so long that the active queue is now empty we can stop it.
-            if (this->gatesToTest_two.empty()) {
-                this->voronoi_mutex.unlock();
-                break;
+            // Clear the search grid and free all used memory.
+            this->searchGrid.ClearSearchGrid();
+            if (token.IsCancelled()) {
+                megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_INFO,
+                    "The construction of the Voronoi diagram was cancelled.");
+            }
+            // Publish the result before notifying, so that the frame triggered by the callback
+            // finds the diagram. Everything that replaces the members or destroys the calculator
+            // waits for the task to return, which includes the callback.
+            this->building.store(false);
+            if (this->buildFinished) {
+                this->buildFinished();
             }
+        },
+        core::utility::TaskPriority::Low);
 
-            // Get the last element from the queue and process it.
-            gate = this->gatesToTest_two.back();
-            this->gatesToTest_two.pop_back();
-        }
-        this->voronoi_mutex.unlock();
-
-        // Create the vector that contains all three gate spheres.
-        std::array<vec4d, 4> gateVector{this->searchGrid.GetAtoms()[gate.second[0]],
-            this->searchGrid.GetAtoms()[gate.second[1]], this->searchGrid.GetAtoms()[gate.second[2]], vec4d()};
-
-        // Get the gate centers, we only need the first one, i.e. the one with the smaller radius.
-        auto gateCenter_cnt = Computations::ComputeGateCenter(gateVector, gateCenter, incircle, circles);
-
-        // Compute the pivot point of the current gate.
-        vec3d pivot = Computations::ComputePivot(gateVector);
-
-        // Compute the next voronoi vertex.
-        EndVertexParams params = EndVertexParams(gate, gateCenter, gateVector, pivot);
-        vec4d edgeEndResult;
-        int minIdx = this->searchGrid.GetEndVertex(params, edgeEndResult);
-
-        // Did we find a result for the currently processed gate?
-        if (minIdx >= 0) {
-            // Check if all 4 surrounding vertices of our voronoi vertex are "real" atoms. If all of them are real,
-            // we have found our start vertex and can exit. If at least one is one of the four start vertices, add
-            // the three new gates to the queue and process the next gate.
-            this->voronoi_mutex.lock();
-            uint thresh = static_cast<uint>(this->searchGrid.GetAtoms().size() - 4);
-            if (gate.second[0] < thresh && gate.second[1] < thresh && gate.second[2] < thresh &&
-                static_cast<uint>(minIdx) < thresh) {
-                this->initVertexFound = true;
-                this->initVertexBorder = vec4ui(gate.second[0], gate.second[1], gate.second[2], minIdx);
-                this->initVertex = edgeEndResult;
+    return false;
+}
 
-            } else {
-                std::pair<vec4d, std::array<uint, 5>> new1(
-                    edgeEndResult, {static_cast<uint>(minIdx), gate.second[0], gate.second[1], gate.second[2], 0});
-                std::pair<vec4d, std::array<uint, 5>> new2(
-                    edgeEndResult, {static_cast<uint>(minIdx), gate.second[1], gate.second[2], gate.second[0], 0});
-                std::pair<vec4d, std::array<uint, 5>> new3(
-                    edgeEndResult, {static_cast<uint>(minIdx), gate.second[0], gate.second[2], gate.second[1], 0});
-                if (this->active_gates == 0) {
-                    this->gatesToTest_two.push_back(new3);
-                    this->gatesToTest_two.push_back(new2);
-                    this->gatesToTest_two.push_back(new1);
-
-                } else {
-                    this->gatesToTest_one.push_back(new3);
-                    this->gatesToTest_one.push_back(new2);
-                    this->gatesToTest_one.push_back(new1);
-                }
-            }
-            this->voronoi_mutex.unlock();
-        }
-    }
+/*
+ * VoronoiChannelCalculator::isBuildRunning
+ */
+bool VoronoiChannelCalculator::isBuildRunning(void) const {
+    return this->build.valid() && (this->build.wait_for(std::chrono::seconds(0)) != std::future_status::ready);
 }
 
 /*
- * VoronoiChannelCalculator::stopThreads
+ * VoronoiChannelCalculator::waitForBuild
  */
-void VoronoiChannelCalculator::stopThreads() {
-    for (size_t i = 0; i < this->voronoi_threads.size(); i++) {
-        if (this->voronoi_threads[i].joinable()) {
-            this->voronoi_threads[i].join();
-        }
+void VoronoiChannelCalculator::waitForBuild(void) {
+    if (this->build.valid()) {
+        core::utility::TaskScheduler::Instance().Wait(this->build);
     }
 }
 
@@ -600,32 +458,31 @@ bool VoronoiChannelCalculator::create(void) {
  * VoronoiChannelCalculator::Render
  */
 bool VoronoiChannelCalculator::Render(view::CallRender3DGL& call, bool lighting) {
+    // The diagram is not complete while it is being built.
+    if (this->building.load() || !this->resultAvailable) {
+        return true;
+    }
+
     glLineWidth(1.0);
     glDisable(GL_LIGHTING);
     glBegin(GL_LINES);
     glColor3f(1.0, 1.0, 1.0);
     int i = 0;
     for (auto e : this->voronoi_edges) {
+        const auto& start = this->voronoi_vertices[e.start_vertex].vertex;
+        const auto& end = this->voronoi_vertices[e.end_vertex].vertex;
         if (this->vertexValidFlags[e.start_vertex] && this->vertexValidFlags[e.end_vertex] &&
             gateValidFlags[i]) { // the whole edge is valid
-            glVertex3f(this->vertices[e.start_vertex].GetX(), this->vertices[e.start_vertex].GetY(),
-                this->vertices[e.start_vertex].GetZ());
-            glVertex3f(static_cast<float>(e.gate_sphere.GetX()), static_cast<float>(e.gate_sphere.GetY()),
-                static_cast<float>(e.gate_sphere.GetZ()));
-            glVertex3f(static_cast<float>(e.gate_sphere.GetX()), static_cast<float>(e.gate_sphere.GetY()),
-                static_cast<float>(e.gate_sphere.GetZ()));
-            glVertex3f(this->vertices[e.end_vertex].GetX(), this->vertices[e.end_vertex].GetY(),
-                this->vertices[e.end_vertex].GetZ());
+            glVertex3d(start.GetX(), start.GetY(), start.GetZ());
+            glVertex3d(e.gate_sphere.GetX(), e.gate_sphere.GetY(), e.gate_sphere.GetZ());
+            glVertex3d(e.gate_sphere.GetX(), e.gate_sphere.GetY(), e.gate_sphere.GetZ());
+            glVertex3d(end.GetX(), end.GetY(), end.GetZ());
         } else if (this->vertexValidFlags[e.start_vertex] && gateValidFlags[i]) { // the first part of the edge is valid
-            glVertex3f(this->vertices[e.start_vertex].GetX(), this->vertices[e.start_vertex].GetY(),
-                this->vertices[e.start_vertex].GetZ());
-            glVertex3f(static_cast<float>(e.gate_sphere.GetX()), static_cast<float>(e.gate_sphere.GetY()),
-                static_cast<float>(e.gate_sphere.GetZ()));
+            glVertex3d(start.GetX(), start.GetY(), start.GetZ());
+            glVertex3d(e.gate_sphere.GetX(), e.gate_sphere.GetY(), e.gate_sphere.GetZ());
         } else if (this->vertexValidFlags[e.end_vertex] && gateValidFlags[i]) { // the second part of the edge is valid
-            glVertex3f(static_cast<float>(e.gate_sphere.GetX()), static_cast<float>(e.gate_sphere.GetY()),
-                static_cast<float>(e.gate_sphere.GetZ()));
-            glVertex3f(this->vertices[e.end_vertex].GetX(), this->vertices[e.end_vertex].GetY(),
-                this->vertices[e.end_vertex].GetZ());
+            glVertex3d(e.gate_sphere.GetX(), e.gate_sphere.GetY(), e.gate_sphere.GetZ());
+            glVertex3d(end.GetX(), end.GetY(), end.GetZ());
         }
         i++;
     }
@@ -645,57 +502,59 @@ bool VoronoiChannelCalculator::Update(MolecularDataCall* mdc, std::vector<Vorono
         return false;
     }
 
-    // If we have new data recompute the Voronoi diagram.
-    bool newDiagram = false;
-    if (mdc->DataHash() != this->lastDataHash) {
-        // Set the new data hash and compute the voronoi diagram.
-        this->lastDataHash = mdc->DataHash();
-        newDiagram = this->constructVoronoiDiagram(mdc);
+    // If we have new data recompute the Voronoi diagram and wait for it. A cancelled
+    // build has to stop before the one for the new data can start.
+    while (!this->Prefetch(mdc)) {
+        this->waitForBuild();
+    }
+    if (!this->diagramAvailable) {
+        this->resultAvailable = false;
+        return false;
     }
 
-    // Check if the diagram is valid or the probe radius has been changed and
+    // Check if the diagram is new or the probe radius has been changed and
     // filter the voronoi vertices based on the probe.
-    if (std::abs(this->probeRadius - probeRadius) > FLT_EPSILON || newDiagram) {
+    if (std::abs(this->probeRadius - probeRadius) > FLT_EPSILON || !this->resultAvailable) {
         // Save the probe radius and filter the voronoi vertices and gates
         // based on the radius and the convex hull of the input data.
         this->probeRadius = probeRadius;
-        this->checkVertexAndGateValidity(mdc);
+        this->checkVertexAndGateValidity();
         this->resultAvailable = true;
     }
 
-    // Check if there are results available and return them.
-    if (this->resultAvailable) {
-        // Copy the valid vertices into the output vector. Also create the
-        // offset vector for the vertex IDs.
-        std::vector<int> vertex_offset = std::vector<int>(this->voronoi_vertices.size(), -1);
-        p_voronoi_vertices.reserve(this->voronoi_vertices.size());
-        int new_id = 0;
-        size_t i = 0;
-        for (auto it = this->voronoi_vertices.begin(); it != this->voronoi_vertices.end(); it++) {
-            if (this->vertexValidFlags[i]) {
-                p_voronoi_vertices.emplace_back((*it).second);
-                p_voronoi_vertices.back().vertex = this->vertices[i];
-                vertex_offset[i] = new_id++;
-            }
-            i++;
+    // Copy the valid vertices into the output vector. Also create the
+    // offset vector for the vertex IDs.
+    std::vector<int> vertex_offset = std::vector<int>(this->voronoi_vertices.size(), -1);
+    p_voronoi_vertices.reserve(this->voronoi_vertices.size());
+    int new_id = 0;
+    for (size_t i = 0; i < this->voronoi_vertices.size(); i++) {
+        if (this->vertexValidFlags[i]) {
+            p_voronoi_vertices.emplace_back(this->voronoi_vertices[i]);
+            vertex_offset[i] = new_id++;
         }
+    }
 
-        // Copy the valid edges to the output vector.For a valid edge both
-        // vertices on the edge have to be valid.
-        p_voronoi_edges.reserve(this->voronoi_edges.size());
-        for (size_t i = 0; i < this->voronoi_edges.size(); i++) {
-            if (this->gateValidFlags[i]) {
-                if (vertex_offset[this->voronoi_edges[i].end_vertex] != -1 &&
-                    vertex_offset[this->voronoi_edges[i].start_vertex] != -1) {
-                    p_voronoi_edges.emplace_back(this->voronoi_edges[i]);
-                    p_voronoi_edges.back().end_vertex = vertex_offset[p_voronoi_edges.back().end_vertex];
-                    p_voronoi_edges.back().start_vertex = vertex_offset[p_voronoi_edges.back().start_vertex];
-                }
+    // Copy the valid edges to the output vector.For a valid edge both
+    // vertices on the edge have to be valid.
+    p_voronoi_edges.reserve(this->voronoi_edges.size());
+    for (size_t i = 0; i < this->voronoi_edges.size(); i++) {
+        if (this->gateValidFlags[i]) {
+            if (vertex_offset[this->voronoi_edges[i].end_vertex] != -1 &&
+                vertex_offset[this->voronoi_edges[i].start_vertex] != -1) {
+                p_voronoi_edges.emplace_back(this->voronoi_edges[i]);
+                p_voronoi_edges.back().end_vertex = vertex_offset[p_voronoi_edges.back().end_vertex];
+                p_voronoi_edges.back().start_vertex = vertex_offset[p_voronoi_edges.back().start_vertex];
             }
         }
-        return true;
     }
-    return false;
+    return true;
+}
+
+/*
+ * VoronoiChannelCalculator::SetBuildFinishedCallback
+ */
+void VoronoiChannelCalculator::SetBuildFinishedCallback(std::function<void(void)> callback) {
+    this->buildFinished = std::move(callback);
 }
 
 /*
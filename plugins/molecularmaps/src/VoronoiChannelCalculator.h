@@ -15,14 +15,34 @@
 
 #include "protein_calls/MolecularDataCall.h"
 
+#include "mmcore/utility/TaskScheduler.h"
+
+#include "vislib/math/Cuboid.h"
 #include "vislib/math/Plane.h"
 #include "vislib/math/Vector.h"
 
 #include <Eigen/Dense>
 
+#include <atomic>
+#include <functional>
+#include <future>
+#include <unordered_map>
+
 namespace megamol {
 namespace molecularmaps {
 
+/**
+ * Computes the Voronoi diagram of the atoms of a protein, which is used to find
+ * the channels through the protein.
+ *
+ * The diagram is built in a low priority task on the task scheduler: the gates of
+ * the diagram are processed in waves, the end vertices of all gates of a wave
+ * are searched in parallel and the results are merged in the order of the
+ * gates, so the diagram does not depend on the number of workers. A build can
+ * be cancelled at any time. The diagram is kept as long as the data hash of
+ * the protein does not change, so a change of the probe radius only filters
+ * the existing diagram again.
+ */
 class VoronoiChannelCalculator : public AbstractLocalRenderer {
 public:
     /** Ctor. */
@@ -31,18 +51,54 @@ public:
     /** Dtor. */
     virtual ~VoronoiChannelCalculator(void);
 
+    /**
+     * Cancels a build of the Voronoi diagram that is in progress without
+     * waiting for it. The next call to Prefetch or Update after the build
+     * has stopped starts a new build.
+     */
+    void Cancel(void);
+
     /**
      * Initializes the renderer.
      */
     virtual bool create(void);
 
+    /**
+     * Answer whether the Voronoi diagram is being built in the background.
+     *
+     * @return true if a build is in progress, false otherwise.
+     */
+    bool IsBuilding(void) const;
+
+    /**
+     * Starts building the Voronoi diagram for the data in 'mdc' in the
+     * background unless it has been built or is being built already. The
+     * atom data are copied, so the call does not need to stay valid.
+     *
+     * @param mdc The molecular data call containing the particle data
+     *
+     * @return true if the diagram for 'mdc' is available, false if it is
+     *         still being built.
+     */
+    bool Prefetch(protein_calls::MolecularDataCall* mdc);
+
     /**
      * Invokes the rendering calls.
      */
     virtual bool Render(core::view::CallRender3DGL& call, bool lighting = true);
 
     /**
-     * Update function for the local data to render.
+     * Sets the function that is called when a build has finished or has
+     * stopped after being cancelled. It is called on a worker thread after
+     * IsBuilding has become false.
+     *
+     * @param callback The function to call.
+     */
+    void SetBuildFinishedCallback(std::function<void(void)> callback);
+
+    /**
+     * Update function for the local data to render. Waits for the Voronoi
+     * diagram of 'mdc' to be built.
      *
      * @param mdc The molecular data call containing the particle data
      */
@@ -56,64 +112,97 @@ protected:
     virtual void release(void);
 
 private:
+    /** A gate: the start sphere, the three gate atoms, the fourth atom and the ID of the start vertex. */
+    typedef std::pair<vec4d, std::array<uint, 5>> Gate;
+
+    /** The result of the end vertex search for a gate. */
+    struct GateResult {
+        /** The index of the atom that closes the end vertex or -1 if there is none. */
+        int atom;
+
+        /** The end vertex. */
+        vec4d vertex;
+    };
+
+    /** States of the convex hull test, which does not depend on the probe radius. */
+    enum HullTest : uint8_t { HULL_UNTESTED = 0, HULL_INSIDE, HULL_OUTSIDE };
+
     /**
      * Checks the validity for each vertex
      */
-    void checkVertexAndGateValidity(protein_calls::MolecularDataCall* mdc);
+    void checkVertexAndGateValidity(void);
 
     /**
-     * Constructs the voronoi diagram for a protein.
+     * Constructs the voronoi diagram for the atoms copied by Prefetch.
      *
-     * @param mdc The molecular data call containing the protein data.
+     * @param token The token that cancels the construction.
      *
      * @return true if the diagram was created, false otherwise
      */
-    bool constructVoronoiDiagram(protein_calls::MolecularDataCall* mdc);
+    bool constructVoronoiDiagram(core::utility::CancellationToken token);
 
     /**
+     * Searches the end vertices of all gates of a wave in parallel.
+     *
+     * @param p_gates   The gates of the wave.
+     * @param p_results Receives the end vertex for every gate.
+     * @param token     The token that cancels the search.
      *
+     * @return true if all gates have been processed, false if the search was cancelled.
      */
-    void convexHullThread();
+    bool nextVoronoiVertices(
+        const std::vector<Gate>& p_gates, std::vector<GateResult>& p_results, core::utility::CancellationToken token);
 
     /**
-     * Computes the next Voronoi vertices until the thread is stopped.
+     * Answer whether the task of the background build has not returned yet.
+     * Unlike the building flag, this includes the build finished callback.
      */
-    void nextVoronoiVertex();
+    bool isBuildRunning(void) const;
 
     /**
-     * Computes the next Voronoi vertices until the thread is stopped.
+     * Waits for the background build to finish, executing pending tasks in
+     * the meantime.
      */
-    void nextVoronoiVertexInit();
+    void waitForBuild(void);
 
-    /**
-     * Stops all threads in the threadpool.
-     */
-    void stopThreads();
+    /** The atoms with their radii as input for the construction. */
+    std::vector<vec4d> atoms;
 
-    /** Indicates the active queue for the Voronoi threads. */
-    uint active_gates;
+    /** The shrunken bounding box of the atoms. */
+    vislib::math::Cuboid<float> atomBBox;
 
-    /** List of neighbouring particle indices per edge */
-    std::vector<vislib::math::Vector<int, 3>> edge_neighbours;
+    /** The maximal atom radius. */
+    float atomRadiusMax;
 
-    /** List of all gate vertices, one for each edge */
-    std::vector<vislib::math::Vector<float, 4>> gates;
+    /** The average atom radius. */
+    float atomRadiusMiddle;
 
-    /** Queue of all gate vertices that need to be processed. */
-    std::vector<std::pair<vec4d, std::array<uint, 5>>> gatesToTest_one;
-    std::vector<std::pair<vec4d, std::array<uint, 5>>> gatesToTest_two;
+    /** Flag showing whether a build for the last data hash has been started and not been cancelled. */
+    bool buildStarted;
 
-    /** Validity flags for all gates. Non-valid gates are not initialized and do not belong to cavities. */
-    std::vector<bool> gateValidFlags;
+    /** The task building the Voronoi diagram in the background. */
+    std::future<void> build;
+
+    /** Called when the background build has finished or stopped. */
+    std::function<void(void)> buildFinished;
 
-    /** The initial vertex. */
-    vec4d initVertex;
+    /** Flag showing whether the background build is running. */
+    std::atomic<bool> building;
 
-    /** The gate spheres of the initial vertex. */
-    vec4ui initVertexBorder;
+    /** The source of the token that cancels the background build. */
+    core::utility::CancellationSource cancellation;
 
-    /** Flag that signals if the initial vertex is found. */
-    bool initVertexFound;
+    /** Flag showing whether the last build produced a diagram. */
+    bool diagramAvailable;
+
+    /** The results of the convex hull test for all gates. */
+    std::vector<uint8_t> gateHullTests;
+
+    /** Validity flags for all gates. Non-valid gates are not initialized and do not belong to cavities. */
+    std::vector<bool> gateValidFlags;
+
+    /** The positions of the atoms for the convex hull test. */
+    std::vector<vec3f> hullAtoms;
 
     /** The probe radius the diagram is constructed for */
     float probeRadius;
@@ -124,29 +213,20 @@ private:
     /** The search grid that contains all atoms of the protein. */
     AtomGrid searchGrid;
 
-    /** map mapping vertex ids to identical other vertices */
-    std::vector<int> vertexMap;
+    /** The results of the convex hull test for all vertices. */
+    std::vector<uint8_t> vertexHullTests;
+
+    /** Maps the hash of a Voronoi vertex to its ID. */
+    std::unordered_map<uint64_t, uint> vertexIDs;
 
     /** validity flags of all vertices */
     std::vector<bool> vertexValidFlags;
 
-    /** List of all voronoi vertex positions. */
-    std::vector<vislib::math::Vector<float, 4>> vertices;
-
     /** List of all voronoi edges. */
     std::vector<VoronoiEdge> voronoi_edges;
 
-    /** The ID of the next voronoi vertex. */
-    uint voronoi_id;
-
-    /** The mutex that locks access to the local variables for the threads. */
-    std::mutex voronoi_mutex;
-
-    /** Thread pool that computes the voronoi edges. */
-    std::vector<std::thread> voronoi_threads;
-
-    /** List of all voronoi vertices. */
-    std::map<uint64_t, VoronoiVertex> voronoi_vertices;
+    /** List of all voronoi vertices, indexed by their ID. */
+    std::vector<VoronoiVertex> voronoi_vertices;
 };
 
 } /* end namespace molecularmaps */
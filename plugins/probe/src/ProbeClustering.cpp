@@ -14,14 +14,15 @@ megamol::probe::ProbeClustering::ProbeClustering()
         , _in_probes_slot("inProbes", "")
         , _in_table_slot("inTable", "")
         , _eps_slot("eps", "")
-        , _minpts_slot("minpts", "")
+        , _minpts_slot("minpts", "Minimum number of similar neighbors of a probe that seeds a cluster")
         , _threshold_slot("threshold", "")
         , _handwaving_slot("handwaving", "")
         , _lhs_idx_slot("debug::lhs_idx", "")
         , _rhs_idx_slot("debug::rhs_idx", "")
         , _print_debug_info_slot("debug::print", "")
         , _toggle_reps_slot("toggle reps", "")
-        , _angle_threshold_slot("angle threshold", "") {
+        , _angle_threshold_slot("angle threshold", "")
+        , _knn_slot("knn", "Maximum number of most similar neighbors per probe, 0 keeps all neighbors within eps") {
     _out_probes_slot.SetCallback(CallProbes::ClassName(), CallProbes::FunctionName(0), &ProbeClustering::get_data_cb);
     _out_probes_slot.SetCallback(CallProbes::ClassName(), CallProbes::FunctionName(1), &ProbeClustering::get_extent_cb);
     MakeSlotAvailable(&_out_probes_slot);
@@ -59,6 +60,9 @@ megamol::probe::ProbeClustering::ProbeClustering()
 
     _angle_threshold_slot << new core::param::FloatParam(45.0f, 0.0f);
     MakeSlotAvailable(&_angle_threshold_slot);
+
+    _knn_slot << new core::param::IntParam(0, 0);
+    MakeSlotAvailable(&_knn_slot);
 }
 
 
@@ -82,26 +86,38 @@ bool megamol::probe::ProbeClustering::get_data_cb(core::Call& c) {
     auto in_probes = _in_probes_slot.CallAs<CallProbes>();
     if (in_probes == nullptr)
         return false;
+    // the similarity table is optional, without it the probes are compared by their samples
     auto in_table = _in_table_slot.CallAs<datatools::table::TableDataCall>();
-    if (in_table == nullptr)
-        return false;
 
     if (!(*in_probes)(CallProbes::CallGetMetaData))
         return false;
     if (!(*in_probes)(CallProbes::CallGetData))
         return false;
-    if (!(*in_table)(1))
-        return false;
-    if (!(*in_table)(0))
-        return false;
-
-    _col_count = in_table->GetColumnsCount();
-    _row_count = in_table->GetRowsCount();
-    _sim_matrix = in_table->GetData();
 
     auto const& meta_data = in_probes->getMetaData();
     _probes = in_probes->getData();
 
+    _col_count = 0;
+    _row_count = 0;
+    _sim_matrix = nullptr;
+    std::size_t table_hash = 0;
+    if (in_table != nullptr) {
+        if (!(*in_table)(1))
+            return false;
+        if (!(*in_table)(0))
+            return false;
+        table_hash = in_table->DataHash();
+        if (in_table->GetColumnsCount() >= _probes->getProbeCount() &&
+            in_table->GetRowsCount() >= _probes->getProbeCount()) {
+            _col_count = in_table->GetColumnsCount();
+            _row_count = in_table->GetRowsCount();
+            _sim_matrix = in_table->GetData();
+        } else {
+            core::utility::log::Log::DefaultLog.WriteWarn(
+                "[ProbeClustering]: Similarity table does not cover all probes, comparing probe samples instead");
+        }
+    }
+
     // if (is_debug_dirty()) {
     //    auto const lhs_idx = _lhs_idx_slot.Param<core::param::IntParam>()->Value();
     //    auto const rhs_idx = _rhs_idx_slot.Param<core::param::IntParam>()->Value();
@@ -126,14 +142,15 @@ bool megamol::probe::ProbeClustering::get_data_cb(core::Call& c) {
     //    }
     //}
 
-    if (in_probes->hasUpdate() || meta_data.m_frame_ID != _frame_id || in_table->DataHash() != _in_table_data_hash ||
+    if (in_probes->hasUpdate() || meta_data.m_frame_ID != _frame_id || table_hash != _in_table_data_hash ||
         is_dirty() || _toggle_reps_slot.IsDirty() /*|| is_debug_dirty()*/) {
         if (in_probes->hasUpdate() || meta_data.m_frame_ID != _frame_id ||
-            in_table->DataHash() != _in_table_data_hash || is_dirty() /*|| is_debug_dirty()*/) {
+            table_hash != _in_table_data_hash || is_dirty() /*|| is_debug_dirty()*/) {
             auto const num_probes = _probes->getProbeCount();
 
             auto const eps = _eps_slot.Param<core::param::FloatParam>()->Value();
-            auto const minpts = _minpts_slot.Param<core::param::IntParam>()->Value();
+            auto const minpts = static_cast<datatools::clustering::index_t>(
+                std::max(_minpts_slot.Param<core::param::IntParam>()->Value(), 0));
             auto const threshold = _threshold_slot.Param<core::param::FloatParam>()->Value();
             auto const handwaving = _handwaving_slot.Param<core::param::FloatParam>()->Value();
             auto const angle_threshold = glm::radians(_angle_threshold_slot.Param<core::param::FloatParam>()->Value());
@@ -186,7 +203,11 @@ bool megamol::probe::ProbeClustering::get_data_cb(core::Call& c) {
             }*/
 
             if (in_probes->hasUpdate() || meta_data.m_frame_ID != _frame_id ||
-                in_table->DataHash() != _in_table_data_hash || is_dirty()) {
+                table_hash != _in_table_data_hash || is_dirty()) {
+                if (_sim_matrix == nullptr) {
+                    compute_signatures();
+                }
+
                 auto const p_bbox = meta_data.m_bboxs.BoundingBox();
                 std::array<float, 6> bbox = {p_bbox.GetLeft(), p_bbox.GetRight(), p_bbox.GetBottom(), p_bbox.GetTop(),
                     p_bbox.GetBack(), p_bbox.GetFront()};
@@ -198,54 +219,21 @@ bool megamol::probe::ProbeClustering::get_data_cb(core::Call& c) {
                 _kd_tree->buildIndex();
 
 
-                /*auto const cluster_res =
-                    datatools::clustering::DBSCAN_with_similarity<float, 3>(_kd_tree, eps, minpts,
-                        [sim_matrix, col_count, row_count, threshold](
-                            datatools::clustering::index_t a, datatools::clustering::index_t b) ->
-                   bool { auto const val = sim_matrix[a + b * col_count]; return val <= threshold;
-                        });*/
-                _cluster_res = datatools::clustering::GROWING_with_similarity_and_score<float, 3>(
-                    _kd_tree, eps * eps, minpts,
-                    [this, threshold, angle_threshold](
-                        datatools::clustering::index_t a, datatools::clustering::index_t b) -> bool {
-                        auto const val = _sim_matrix[a + b * _col_count];
-                        auto const crit_a = val <= threshold;
-
-                        auto const a_dir = _cur_dirs[a];
-                        auto const b_dir = _cur_dirs[b];
-                        auto const rad_angle = std::acos(glm::dot(glm::normalize(a_dir), glm::normalize(b_dir)));
-                        auto const crit_b = rad_angle <= angle_threshold;
-
-                        return crit_a && crit_b;
-                    },
-                    [this, handwaving](datatools::clustering::index_t pivot,
-                        std::vector<datatools::clustering::index_t> const& cluster) -> datatools::clustering::index_t {
-                        if (cluster.empty())
-                            return pivot;
-                        std::vector<float> scores;
-                        scores.reserve(cluster.size());
-                        for (auto const& lhs : cluster) {
-                            auto val = 0.0f;
-                            for (auto const& rhs : cluster) {
-                                val += _sim_matrix[lhs + rhs * _col_count];
-                            }
-                            val /= static_cast<float>(cluster.size() - 1);
-                            scores.push_back(val);
-                        }
-                        auto it = std::min_element(scores.begin(), scores.end());
-                        auto idx = std::distance(scores.begin(), it);
-                        return cluster[idx];
+                // sparse pipeline: similarities are only evaluated within the eps neighborhood of each probe,
+                // clusters grow from the probes with at least minpts similar neighbors
+                auto const knn = static_cast<datatools::clustering::index_t>(
+                    _knn_slot.Param<core::param::IntParam>()->Value());
+                auto const cos_angle_threshold = std::cos(angle_threshold);
+                _graph = datatools::clustering::build_similarity_graph<float, 3>(_kd_tree, eps * eps, knn,
+                    [this, threshold, cos_angle_threshold](
+                        datatools::clustering::index_t a, datatools::clustering::index_t b, float& weight) -> bool {
+                        auto const cos_angle = glm::dot(glm::normalize(_cur_dirs[a]), glm::normalize(_cur_dirs[b]));
+                        if (cos_angle < cos_angle_threshold)
+                            return false;
+                        weight = dissimilarity(a, b);
+                        return weight <= threshold;
                     });
-
-
-                /*[sim_matrix, col_count, row_count](datatools::clustering::index_t a,
-                    datatools::clustering::search_res_t<float> const& vec) -> float {
-                    std::vector<float> tmp_vals(vec.size());
-                    std::transform(vec.cbegin(), vec.cend(), tmp_vals.begin(),
-                        [&sim_matrix, col_count, a](auto const& el) { return sim_matrix[el.first + a * col_count]; });
-                    auto const sum = std::accumulate(tmp_vals.cbegin(), tmp_vals.cend(), 0.0f, std::plus<float>());
-                    return sum / static_cast<float>(vec.size());
-                }*/
+                _cluster_res = datatools::clustering::GROWING_on_graph(_graph, minpts);
 
                 if (vec_probe) {
                     for (decltype(_cluster_res)::size_type pidx = 0; pidx < _cluster_res.size(); ++pidx) {
@@ -276,31 +264,27 @@ bool megamol::probe::ProbeClustering::get_data_cb(core::Call& c) {
         bool toggle_reps = _toggle_reps_slot.Param<core::param::BoolParam>()->Value();
 
         if (toggle_reps) {
-            std::unordered_map<datatools::clustering::index_t, std::vector<datatools::clustering::index_t>> cluster_map;
+            // the most representative probe of a cluster has the smallest mean dissimilarity to its neighbors
+            auto const scores = datatools::clustering::cluster_scores(_graph, _cluster_res);
+            std::unordered_map<datatools::clustering::index_t, datatools::clustering::index_t> cluster_map;
             cluster_map.reserve(*max_el);
-
             for (decltype(_cluster_res)::size_type pidx = 0; pidx < _cluster_res.size(); ++pidx) {
-                cluster_map[_cluster_res[pidx]].push_back(pidx);
+                auto const cluster_id = _cluster_res[pidx];
+                if (cluster_id <= static_cast<datatools::clustering::cluster_type_ut>(
+                                      datatools::clustering::cluster_type::NOISE))
+                    continue;
+                auto const it = cluster_map.find(cluster_id);
+                if (it == cluster_map.end()) {
+                    cluster_map[cluster_id] = pidx;
+                } else if (scores[pidx] < scores[it->second]) {
+                    it->second = pidx;
+                }
             }
 
             std::vector<datatools::clustering::index_t> cluster_reps;
-            cluster_reps.reserve(*max_el);
+            cluster_reps.reserve(cluster_map.size());
             for (auto const& el : cluster_map) {
-                datatools::clustering::index_t min_idx = 0;
-                float min_score = std::numeric_limits<float>::max();
-                for (auto const& idx : el.second) {
-                    auto const current_idx = idx;
-                    for (auto const& tmp_idx : el.second) {
-                        if (tmp_idx == current_idx)
-                            continue;
-                        auto const val = _sim_matrix[current_idx + tmp_idx * _col_count];
-                        if (val < min_score) {
-                            min_idx = current_idx;
-                            min_score = val;
-                        }
-                    }
-                }
-                cluster_reps.push_back(min_idx);
+                cluster_reps.push_back(el.second);
             }
 
             bool vec_probe = false;
@@ -337,7 +321,7 @@ bool megamol::probe::ProbeClustering::get_data_cb(core::Call& c) {
         }
 
         _frame_id = meta_data.m_frame_ID;
-        _in_table_data_hash = in_table->DataHash();
+        _in_table_data_hash = table_hash;
         ++_out_data_hash;
         reset_dirty();
         _toggle_reps_slot.ResetDirty();
@@ -359,8 +343,6 @@ bool megamol::probe::ProbeClustering::get_extent_cb(core::Call& c) {
         return false;
 
     auto ct = this->_in_table_slot.CallAs<datatools::table::TableDataCall>();
-    if (ct == nullptr)
-        return false;
     auto cprobes = this->_in_probes_slot.CallAs<CallProbes>();
     if (cprobes == nullptr)
         return false;
@@ -369,7 +351,7 @@ bool megamol::probe::ProbeClustering::get_extent_cb(core::Call& c) {
     if (!(*cprobes)(1))
         return false;
     auto meta_data = cprobes->getMetaData();
-    if (!(*ct)(1))
+    if (ct != nullptr && !(*ct)(1))
         return false;
 
 
@@ -378,3 +360,50 @@ bool megamol::probe::ProbeClustering::get_extent_cb(core::Call& c) {
 
     return true;
 }
+
+
+void megamol::probe::ProbeClustering::compute_signatures() {
+    auto const num_probes = _probes->getProbeCount();
+    _signatures.assign(num_probes * signature_length, 0.0f);
+
+    core::utility::ParallelFor<std::size_t>(0, num_probes, 0, [this](std::size_t begin, std::size_t end) {
+        std::vector<float> samples;
+        for (std::size_t pidx = begin; pidx < end; ++pidx) {
+            samples.clear();
+            auto const generic_probe = _probes->getGenericProbe(pidx);
+            if (auto const* probe = std::get_if<FloatProbe>(&generic_probe)) {
+                samples = probe->getSamplingResult()->samples;
+            } else if (auto const* probe = std::get_if<FloatDistributionProbe>(&generic_probe)) {
+                for (auto const& sample : probe->getSamplingResult()->samples) {
+                    samples.push_back(sample.mean);
+                }
+            } else if (auto const* probe = std::get_if<Vec4Probe>(&generic_probe)) {
+                for (auto const& sample : probe->getSamplingResult()->samples) {
+                    samples.push_back(glm::length(glm::vec4(sample[0], sample[1], sample[2], sample[3])));
+                }
+            }
+            if (samples.empty())
+                continue;
+
+            // linear resampling, so probes with different sample counts can be compared
+            auto* signature = &_signatures[pidx * signature_length];
+            for (std::size_t i = 0; i < signature_length; ++i) {
+                auto const pos = static_cast<float>(i) * static_cast<float>(samples.size() - 1) /
+                                 static_cast<float>(signature_length - 1);
+                auto const lower = static_cast<std::size_t>(pos);
+                auto const upper = std::min(lower + 1, samples.size() - 1);
+                auto const t = pos - static_cast<float>(lower);
+                signature[i] = (1.0f - t) * samples[lower] + t * samples[upper];
+            }
+        }
+    });
+
+    auto const minmax = std::minmax_element(_signatures.cbegin(), _signatures.cend());
+    if (minmax.first != _signatures.cend() && *minmax.second > *minmax.first) {
+        auto const min_val = *minmax.first;
+        auto const scale = 1.0f / (*minmax.second - min_val);
+        for (auto& val : _signatures) {
+            val = (val - min_val) * scale;
+        }
+    }
+}
@@ -59,7 +59,7 @@ private:
 
     bool is_dirty() {
         return _eps_slot.IsDirty() || _minpts_slot.IsDirty() || _threshold_slot.IsDirty() ||
-               _handwaving_slot.IsDirty() || _angle_threshold_slot.IsDirty();
+               _handwaving_slot.IsDirty() || _angle_threshold_slot.IsDirty() || _knn_slot.IsDirty();
     }
 
     bool is_debug_dirty() {
@@ -72,6 +72,7 @@ private:
         _threshold_slot.ResetDirty();
         _handwaving_slot.ResetDirty();
         _angle_threshold_slot.ResetDirty();
+        _knn_slot.ResetDirty();
     }
 
     void reset_debug_dirty() {
@@ -81,25 +82,33 @@ private:
     }
 
     bool print_debug_info(core::param::ParamSlot& p) {
-        auto const lhs_idx = _lhs_idx_slot.Param<core::param::IntParam>()->Value();
-        auto const rhs_idx = _rhs_idx_slot.Param<core::param::IntParam>()->Value();
-        if (lhs_idx < _col_count && rhs_idx < _row_count) {
-            auto const val = _sim_matrix[lhs_idx + rhs_idx * _col_count];
+        auto const lhs_val = _lhs_idx_slot.Param<core::param::IntParam>()->Value();
+        auto const rhs_val = _rhs_idx_slot.Param<core::param::IntParam>()->Value();
+        if (lhs_val < 0 || rhs_val < 0) {
+            core::utility::log::Log::DefaultLog.WriteWarn(
+                "[ProbeClustering]: Negative probe index %d:%d", lhs_val, rhs_val);
+            return true;
+        }
+        auto const lhs_idx = static_cast<std::size_t>(lhs_val);
+        auto const rhs_idx = static_cast<std::size_t>(rhs_val);
+        if (lhs_idx < _cur_dirs.size() && rhs_idx < _cur_dirs.size() &&
+            (_sim_matrix != nullptr || !_signatures.empty())) {
+            auto const val = dissimilarity(lhs_idx, rhs_idx);
             core::utility::log::Log::DefaultLog.WriteInfo(
-                "[ProbeClustering]: Similiarty val for %d:%d is %f", lhs_idx, rhs_idx, val);
+                "[ProbeClustering]: Similiarty val for %d:%d is %f", lhs_val, rhs_val, val);
             auto const angle = glm::degrees(
                 std::acos(glm::dot(glm::normalize(_cur_dirs[lhs_idx]), glm::normalize(_cur_dirs[rhs_idx]))));
             core::utility::log::Log::DefaultLog.WriteInfo(
-                "[ProbeClustering]: Angle between %d:%d is %f", lhs_idx, rhs_idx, angle);
+                "[ProbeClustering]: Angle between %d:%d is %f", lhs_val, rhs_val, angle);
             auto lhs_pos = *reinterpret_cast<glm::vec3 const*>(_points->get_position(lhs_idx));
             auto rhs_pos = *reinterpret_cast<glm::vec3 const*>(_points->get_position(rhs_idx));
             auto const dis = glm::distance(lhs_pos, rhs_pos);
             core::utility::log::Log::DefaultLog.WriteInfo(
-                "[ProbeClustering]: Distance between %d:%d is %f", lhs_idx, rhs_idx, dis);
+                "[ProbeClustering]: Distance between %d:%d is %f", lhs_val, rhs_val, dis);
         }
         // reset_debug_dirty();
 
-        if (lhs_idx < _probes->getProbeCount() && rhs_idx < _probes->getProbeCount()) {
+        if (_probes != nullptr && lhs_idx < _probes->getProbeCount() && rhs_idx < _probes->getProbeCount()) {
 
             auto rhs_generic_probe = _probes->getGenericProbe(rhs_idx);
             auto lhs_generic_probe = _probes->getGenericProbe(lhs_idx);
@@ -108,12 +117,30 @@ private:
             uint32_t lhs_cluster_id = std::visit(
                 [](auto&& arg) -> uint32_t { return static_cast<uint32_t>(arg.m_cluster_id); }, lhs_generic_probe);
             core::utility::log::Log::DefaultLog.WriteInfo("[ProbeClustering]: Assigned cluster IDs for %d:%d are %d:%d",
-                lhs_idx, rhs_idx, lhs_cluster_id, rhs_cluster_id);
+                lhs_val, rhs_val, lhs_cluster_id, rhs_cluster_id);
         }
 
         return true;
     }
 
+    /** Resamples the samples of all probes to signatures of equal length, normalized to the global value range */
+    void compute_signatures();
+
+    /** Dissimilarity of two probes, from the similarity table if connected, otherwise from the signatures */
+    float dissimilarity(std::size_t lhs, std::size_t rhs) const {
+        if (_sim_matrix != nullptr) {
+            return _sim_matrix[lhs + rhs * _col_count];
+        }
+        float sum = 0.0f;
+        for (std::size_t i = 0; i < signature_length; ++i) {
+            auto const diff = _signatures[lhs * signature_length + i] - _signatures[rhs * signature_length + i];
+            sum += diff * diff;
+        }
+        return std::sqrt(sum / static_cast<float>(signature_length));
+    }
+
+    static constexpr std::size_t signature_length = 32;
+
     core::CalleeSlot _out_probes_slot;
 
     core::CallerSlot _in_probes_slot;
@@ -138,6 +165,8 @@ private:
 
     core::param::ParamSlot _angle_threshold_slot;
 
+    core::param::ParamSlot _knn_slot;
+
     std::shared_ptr<datatools::genericPointcloud<float, 3>> _points;
 
     std::shared_ptr<datatools::clustering::kd_tree_t<float, 3>> _kd_tree;
@@ -146,6 +175,10 @@ private:
 
     float const* _sim_matrix = nullptr;
 
+    std::vector<float> _signatures;
+
+    datatools::clustering::similarity_graph_t _graph;
+
     std::vector<glm::vec3> _cur_dirs;
 
     datatools::clustering::cluster_result_t _cluster_res;
@@ -188,8 +188,8 @@ bool SampleAlongPobes::getData(core::Call& call) {
         something_has_changed = something_has_changed || (cd->getDataHash() != _old_datahash) || ct->hasUpdate();
     } else if (cv != nullptr) {
 
-        // get volume data
-        if (!(*cv)(geocalls::VolumetricDataCall::IDX_GET_DATA))
+        // get volume data, bricked volumes only load the bricks the probes pass through
+        if (!_vol_sampler.Open(*cv) && !(*cv)(geocalls::VolumetricDataCall::IDX_GET_DATA))
             return false;
 
         meta_data.m_frame_cnt = cv->FrameCount();
@@ -300,23 +300,18 @@ bool SampleAlongPobes::getData(core::Call& call) {
             auto type_length = _vol_metadata->ScalarLength;
 
             if (type == geocalls::FLOATING_POINT) {
-                auto data = reinterpret_cast<float*>(cv->GetData());
-                doVolumeTrilinSampling(data);
+                sampleVolume<float>(*cv, [this](auto& data) { this->doVolumeTrilinSampling(data); });
             } else if (type == geocalls::UNSIGNED_INTEGER) {
                 if (type_length < 4) {
-                    auto data = reinterpret_cast<unsigned char*>(cv->GetData());
-                    doVolumeTrilinSampling(data);
+                    sampleVolume<unsigned char>(*cv, [this](auto& data) { this->doVolumeTrilinSampling(data); });
                 } else {
-                    auto data = reinterpret_cast<unsigned int*>(cv->GetData());
-                    doVolumeTrilinSampling(data);
+                    sampleVolume<unsigned int>(*cv, [this](auto& data) { this->doVolumeTrilinSampling(data); });
                 }
             } else if (type == geocalls::SIGNED_INTEGER) {
                 if (type_length < 4) {
-                    auto data = reinterpret_cast<char*>(cv->GetData());
-                    doVolumeTrilinSampling(data);
+                    sampleVolume<char>(*cv, [this](auto& data) { this->doVolumeTrilinSampling(data); });
                 } else {
-                    auto data = reinterpret_cast<int*>(cv->GetData());
-                    doVolumeTrilinSampling(data);
+                    sampleVolume<int>(*cv, [this](auto& data) { this->doVolumeTrilinSampling(data); });
                 }
             }
         } else if (_sampling_mode.Param<core::param::EnumParam>()->Value() == 7) {
@@ -330,23 +325,18 @@ bool SampleAlongPobes::getData(core::Call& call) {
             auto type_length = _vol_metadata->ScalarLength;
 
             if (type == geocalls::FLOATING_POINT) {
-                auto data = reinterpret_cast<float*>(cv->GetData());
-                doVolumeRadiusSampling(data);
+                sampleVolume<float>(*cv, [this](auto& data) { this->doVolumeRadiusSampling(data); });
             } else if (type == geocalls::UNSIGNED_INTEGER) {
                 if (type_length < 4) {
-                    auto data = reinterpret_cast<unsigned char*>(cv->GetData());
-                    doVolumeRadiusSampling(data);
+                    sampleVolume<unsigned char>(*cv, [this](auto& data) { this->doVolumeRadiusSampling(data); });
                 } else {
-                    auto data = reinterpret_cast<unsigned int*>(cv->GetData());
-                    doVolumeRadiusSampling(data);
+                    sampleVolume<unsigned int>(*cv, [this](auto& data) { this->doVolumeRadiusSampling(data); });
                 }
             } else if (type == geocalls::SIGNED_INTEGER) {
                 if (type_length < 4) {
-                    auto data = reinterpret_cast<char*>(cv->GetData());
-                    doVolumeRadiusSampling(data);
+                    sampleVolume<char>(*cv, [this](auto& data) { this->doVolumeRadiusSampling(data); });
                 } else {
-                    auto data = reinterpret_cast<int*>(cv->GetData());
-                    doVolumeRadiusSampling(data);
+                    sampleVolume<int>(*cv, [this](auto& data) { this->doVolumeRadiusSampling(data); });
                 }
             } else {
                 core::utility::log::Log::DefaultLog.WriteError("[SampleAlongProbes]: Volume data type not supported.");
@@ -367,6 +357,7 @@ bool SampleAlongPobes::getData(core::Call& call) {
             _vol_metadata->Origin[2] + _vol_metadata->Extents[2], _vol_metadata->Origin[0] + _vol_metadata->Extents[0],
             _vol_metadata->Origin[1] + _vol_metadata->Extents[1], _vol_metadata->Origin[2]});
     }
+    _vol_sampler.Close();
     cp->setMetaData(meta_data);
     cp->setData(_probes, _version);
     _trigger_recalc = false;
@@ -11,6 +11,7 @@
 #include "mmcore/CallerSlot.h"
 #include "mmcore/Module.h"
 
+#include "geometry_calls/VolumetricBrickSampler.h"
 #include "geometry_calls/VolumetricDataCall.h"
 #include "kdtree.h"
 #include "mmadios/CallADIOSData.h"
@@ -31,6 +32,28 @@
 namespace megamol {
 namespace probe {
 
+/**
+ * Voxels of a bricked volume addressed by the linear index they would have in a dense volume, x fastest. A brick is
+ * loaded on the first access to one of its voxels and kept until the sampler is closed.
+ */
+template<typename T>
+struct BrickedVolumeData {
+    geocalls::VolumetricBrickSampler& sampler;
+
+    T operator[](size_t idx) {
+        auto const* res = sampler.GetResolution();
+        auto const x = idx % res[0];
+        idx /= res[0];
+        auto const y = idx % res[1];
+        auto const z = idx / res[1];
+        if (z >= res[2]) {
+            return static_cast<T>(0);
+        }
+        auto const* voxel = static_cast<T const*>(sampler.GetVoxel(x, y, z));
+        return (voxel != nullptr) ? *voxel : static_cast<T>(0);
+    }
+};
+
 class SampleAlongPobes : public core::Module {
 public:
     /**
@@ -102,11 +125,22 @@ private:
     void doScalarDistributionSampling(
         const std::shared_ptr<pcl::KdTreeFLANN<pcl::PointXYZ>>& tree, std::vector<T>& data);
 
-    template<typename T>
-    void doVolumeRadiusSampling(T* data);
+    template<typename Data>
+    void doVolumeRadiusSampling(Data& data);
 
-    template<typename T>
-    void doVolumeTrilinSampling(T* data);
+    template<typename Data>
+    void doVolumeTrilinSampling(Data& data);
+
+    template<typename T, typename Sampling>
+    void sampleVolume(geocalls::VolumetricDataCall& cv, Sampling&& sampling) {
+        if (_vol_sampler.IsOpen()) {
+            BrickedVolumeData<T> data{_vol_sampler};
+            sampling(data);
+        } else {
+            auto data = reinterpret_cast<T*>(cv.GetData());
+            sampling(data);
+        }
+    }
 
     template<typename T>
     void doVectorSamling(const std::shared_ptr<pcl::KdTreeFLANN<pcl::PointXYZ>>& tree, const std::vector<T>& data_x,
@@ -131,6 +165,9 @@ private:
 
     const geocalls::VolumetricDataCall::Metadata* _vol_metadata;
 
+    // bricked volumes are sampled through this instead of loading them as a whole
+    geocalls::VolumetricBrickSampler _vol_sampler;
+
     size_t _old_datahash;
     size_t _old_volume_datahash;
     bool _trigger_recalc;
@@ -851,8 +888,8 @@ void SampleAlongPobes::doNearestNeighborSampling(
     _probes->setGlobalMinMax(global_min, global_max);
 }
 
-template<typename T>
-void SampleAlongPobes::SampleAlongPobes::doVolumeRadiusSampling(T* data) {
+template<typename Data>
+void SampleAlongPobes::SampleAlongPobes::doVolumeRadiusSampling(Data& data) {
     const int samples_per_probe = this->_num_samples_per_probe_slot.Param<core::param::IntParam>()->Value();
     const float sample_radius_factor = this->_sample_radius_factor_slot.Param<core::param::FloatParam>()->Value();
 
@@ -988,8 +1025,8 @@ void SampleAlongPobes::SampleAlongPobes::doVolumeRadiusSampling(T* data) {
     _probes->setGlobalMinMax(global_min, global_max);
 }
 
-template<typename T>
-void SampleAlongPobes::SampleAlongPobes::doVolumeTrilinSampling(T* data) {
+template<typename Data>
+void SampleAlongPobes::SampleAlongPobes::doVolumeTrilinSampling(Data& data) {
     const int samples_per_probe = this->_num_samples_per_probe_slot.Param<core::param::IntParam>()->Value();
     const float sample_radius_factor = this->_sample_radius_factor_slot.Param<core::param::FloatParam>()->Value();
 
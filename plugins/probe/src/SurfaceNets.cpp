@@ -9,6 +9,10 @@
 #include "geometry_calls/VolumetricDataCall.h"
 #include "mmcore/param/EnumParam.h"
 #include "mmcore/param/FloatParam.h"
+#include "mmcore/utility/TaskScheduler.h"
+
+#include <algorithm>
+#include <limits>
 
 namespace megamol {
 namespace probe {
@@ -63,7 +67,210 @@ bool SurfaceNets::InterfaceIsDirty() {
 }
 
 
+namespace {
+
+// corners of a cell, edge_vertex_offsets refers to them
+constexpr std::array<std::array<uint32_t, 3>, 8> cube_offsets = {
+    {{0, 0, 0}, {1, 0, 0}, {0, 0, 1}, {1, 0, 1}, {0, 1, 0}, {1, 1, 0}, {0, 1, 1}, {1, 1, 1}}};
+
+constexpr std::array<uint32_t, 24> edge_vertex_offsets = {// 0
+    0, 1,
+    // 1
+    0, 2,
+    // 2
+    0, 4,
+    // 3
+    1, 3,
+    // 4
+    4, 5,
+    // 5
+    5, 7,
+    // 6
+    7, 6,
+    // 7
+    6, 4,
+    // 8
+    3, 2,
+    // 9
+    1, 5,
+    // 10
+    3, 7,
+    // 11
+    2, 6};
+
+/**
+ * Surface of one brick. The cells with a vertex are stored sorted by their brick-local index together with their
+ * edge crossings, the position of a cell in this list is the brick-local index of its vertex. This replaces lookup
+ * tables of full grid size.
+ */
+struct BrickSurface {
+    std::array<uint32_t, 3> first_cell;
+    std::vector<std::pair<uint32_t, uint32_t>> filled;
+    std::vector<std::array<float, 4>> vertices;
+    std::vector<std::array<float, 3>> normals;
+    std::vector<std::array<uint32_t, 4>> faces;
+    std::vector<std::array<float, 3>> face_normals;
+    std::array<float, 3> min = {
+        std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+    std::array<float, 3> max = {
+        std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+    uint32_t vertex_offset = 0;
+    uint32_t face_offset = 0;
+};
+
+/** Samples of a volume in memory. */
+template<typename T>
+struct DenseSamples {
+    T const* data;
+    std::array<uint32_t, 3> dims;
+
+    float operator()(uint32_t x, uint32_t y, uint32_t z) const {
+        return static_cast<float>(data[(static_cast<size_t>(z) * dims[1] + y) * dims[0] + x]);
+    }
+    void touch(std::array<uint32_t, 3> const& first, std::array<uint32_t, 3> const& last) {}
+    bool fetch() {
+        return true;
+    }
+    void evict() {}
+};
+
+/** Samples of a bricked volume, the bricks touched by a batch of cells are fetched before sampling them. */
+template<typename T>
+struct BrickedSamples {
+    geocalls::VolumetricBrickSampler* sampler;
+    std::vector<size_t> touched;
+
+    float operator()(uint32_t x, uint32_t y, uint32_t z) const {
+        return static_cast<float>(sampler->Sample<T>(x, y, z));
+    }
+    void touch(std::array<uint32_t, 3> const& first, std::array<uint32_t, 3> const& last) {
+        size_t const f[3] = {first[0], first[1], first[2]};
+        size_t const l[3] = {last[0], last[1], last[2]};
+        auto const bricks = sampler->GetIndex().GetBricksInBox(sampler->GetLevel(), f, l);
+        touched.insert(touched.end(), bricks.begin(), bricks.end());
+    }
+    bool fetch() {
+        auto const retval = sampler->Fetch(touched);
+        touched.clear();
+        return retval;
+    }
+    void evict() {
+        sampler->Evict();
+    }
+};
+
+} // namespace
+
+
 void SurfaceNets::calculateSurfaceNets() {
+    if (_sampler.IsOpen()) {
+        if (_brick_ranges.empty()) {
+            this->updateBrickRanges(_sampler.GetIndex());
+        }
+        if (_sampler.GetIndex().GetScalarType() == geocalls::FLOATING_POINT) {
+            BrickedSamples<float> samples{&_sampler};
+            this->calculateSurfaceNets(samples);
+        } else {
+            BrickedSamples<unsigned char> samples{&_sampler};
+            this->calculateSurfaceNets(samples);
+        }
+    } else if (_data != nullptr) {
+        if (_brick_ranges.empty()) {
+            this->updateBrickRanges(_data);
+        }
+        DenseSamples<float> samples{_data, _dims};
+        this->calculateSurfaceNets(samples);
+    } else if (_byte_data != nullptr) {
+        if (_brick_ranges.empty()) {
+            this->updateBrickRanges(_byte_data);
+        }
+        DenseSamples<unsigned char> samples{_byte_data, _dims};
+        this->calculateSurfaceNets(samples);
+    }
+}
+
+
+bool SurfaceNets::openBricks(geocalls::VolumetricDataCall& cd) {
+    // only the scalar types the dense path supports are sampled from bricks
+    if (!_sampler.Open(cd)) {
+        return false;
+    }
+    auto const& index = _sampler.GetIndex();
+    auto const is_float = index.GetScalarType() == geocalls::FLOATING_POINT && index.GetScalarLength() == 4;
+    auto const is_byte = index.GetScalarType() == geocalls::UNSIGNED_INTEGER && index.GetScalarLength() == 1;
+    if (index.GetComponents() != 1 || !(is_float || is_byte)) {
+        _sampler.Close();
+        return false;
+    }
+    return true;
+}
+
+
+template<typename T>
+void SurfaceNets::updateBrickRanges(T const* data) {
+    for (int i = 0; i < 3; ++i) {
+        _brick_count[i] = (_dims[i] - 2) / _brick_size + 1;
+    }
+    _brick_ranges.resize(static_cast<size_t>(_brick_count[0]) * _brick_count[1] * _brick_count[2]);
+
+    auto const dims = _dims;
+    auto const brick_count = _brick_count;
+    core::utility::ParallelFor<size_t>(0, _brick_ranges.size(), 1, [&](size_t begin, size_t end) {
+        for (auto b = begin; b < end; ++b) {
+            std::array<uint32_t, 3> first, last;
+            auto rest = b;
+            for (int i = 0; i < 3; ++i) {
+                first[i] = static_cast<uint32_t>(rest % brick_count[i]) * _brick_size;
+                rest /= brick_count[i];
+                // the cells of the brick reach one sample into the next brick
+                last[i] = std::min(first[i] + _brick_size, dims[i] - 1);
+            }
+            float min_value = std::numeric_limits<float>::max();
+            float max_value = std::numeric_limits<float>::lowest();
+            for (uint32_t z = first[2]; z <= last[2]; ++z) {
+                for (uint32_t y = first[1]; y <= last[1]; ++y) {
+                    auto const* row = data + (static_cast<size_t>(z) * dims[1] + y) * dims[0];
+                    for (uint32_t x = first[0]; x <= last[0]; ++x) {
+                        auto const value = static_cast<float>(row[x]);
+                        min_value = std::min(min_value, value);
+                        max_value = std::max(max_value, value);
+                    }
+                }
+            }
+            _brick_ranges[b] = {min_value, max_value};
+        }
+    });
+}
+
+
+void SurfaceNets::updateBrickRanges(geocalls::VolumetricBrickIndex const& index) {
+    for (int i = 0; i < 3; ++i) {
+        _brick_count[i] = (_dims[i] - 2) / _brick_size + 1;
+    }
+    _brick_ranges.resize(static_cast<size_t>(_brick_count[0]) * _brick_count[1] * _brick_count[2]);
+
+    // the ranges of the stored bricks bound the ones of the cells without loading any voxel
+    for (size_t b = 0; b < _brick_ranges.size(); ++b) {
+        size_t first[3], last[3];
+        auto rest = b;
+        for (int i = 0; i < 3; ++i) {
+            first[i] = (rest % _brick_count[i]) * _brick_size;
+            rest /= _brick_count[i];
+            last[i] = std::min<size_t>(first[i] + _brick_size, _dims[i] - 1);
+        }
+        float min_value = std::numeric_limits<float>::max();
+        float max_value = std::numeric_limits<float>::lowest();
+        for (auto const s : index.GetBricksInBox(0, first, last)) {
+            min_value = std::min(min_value, static_cast<float>(index.GetMinValue(s)));
+            max_value = std::max(max_value, static_cast<float>(index.GetMaxValue(s)));
+        }
+        _brick_ranges[b] = {min_value, max_value};
+    }
+}
+
+
+template<typename Samples>
+void SurfaceNets::calculateSurfaceNets(Samples& samples) {
 
     _bboxs.Clear();
 
@@ -72,268 +279,312 @@ void SurfaceNets::calculateSurfaceNets() {
     _faces.clear();
     _triangles.clear();
 
-    std::array<std::array<uint32_t, 3>, 8> cube_offsets;
-    cube_offsets[0] = {0, 0, 0};
-    cube_offsets[1] = {1, 0, 0};
-    cube_offsets[2] = {0, 0, 1};
-    cube_offsets[3] = {1, 0, 1};
-    cube_offsets[4] = {0, 1, 0};
-    cube_offsets[5] = {1, 1, 0};
-    cube_offsets[6] = {0, 1, 1};
-    cube_offsets[7] = {1, 1, 1};
-
-    const std::array<uint32_t, 24> edge_vertex_offsets = {// 0
-        0, 1,
-        // 1
-        0, 2,
-        // 2
-        0, 4,
-        // 3
-        1, 3,
-        // 4
-        4, 5,
-        // 5
-        5, 7,
-        // 6
-        7, 6,
-        // 7
-        6, 4,
-        // 8
-        3, 2,
-        // 9
-        1, 5,
-        // 10
-        3, 7,
-        // 11
-        2, 6};
+    if (_dims[0] < 2 || _dims[1] < 2 || _dims[2] < 2)
+        return;
 
     float const iso_value = this->_isoSlot.Param<core::param::FloatParam>()->Value();
 
-    std::vector<uint32_t> voxel_lookup(_dims[0] * _dims[1] * _dims[2]);
-    std::vector<uint32_t> voxel_filled;
-    voxel_filled.reserve(voxel_lookup.size());
-
-    std::vector<uint32_t> voxel_edge_crossings(_dims[0] * _dims[1] * _dims[2]);
-
-    auto dims = _dims;
-
-    auto const offset_now = [dims](
-                                uint32_t x, uint32_t y, uint32_t z) { return dims[0] * dims[1] * z + dims[0] * y + x; };
-
-    for (uint32_t z = 0; z < _dims[2] - 1; z++) {
-        for (uint32_t y = 0; y < _dims[1] - 1; y++) {
-            for (uint32_t x = 0; x < _dims[0] - 1; x++) {
+    auto const dims = _dims;
+    auto const spacing = _spacing;
+    auto const volume_origin = _volume_origin;
+    auto const brick_count = _brick_count;
+
+    auto const& sample = samples;
+
+    // a cell crosses the surface only if the value range of its brick contains the iso value
+    std::vector<uint32_t> active_slot(_brick_ranges.size(), std::numeric_limits<uint32_t>::max());
+    std::vector<BrickSurface> bricks;
+    for (size_t b = 0; b < _brick_ranges.size(); ++b) {
+        if (_brick_ranges[b].first <= iso_value && _brick_ranges[b].second > iso_value) {
+            active_slot[b] = static_cast<uint32_t>(bricks.size());
+            auto& brick = bricks.emplace_back();
+            auto rest = b;
+            for (int i = 0; i < 3; ++i) {
+                brick.first_cell[i] = static_cast<uint32_t>(rest % brick_count[i]) * _brick_size;
+                rest /= brick_count[i];
+            }
+        }
+    }
 
-                std::array<float, 8> sample_value;
-                sample_value[0] =
-                    _data[offset_now(x + cube_offsets[0][0], y + cube_offsets[0][1], z + cube_offsets[0][2])];
-                sample_value[1] =
-                    _data[offset_now(x + cube_offsets[1][0], y + cube_offsets[1][1], z + cube_offsets[1][2])];
-                sample_value[2] =
-                    _data[offset_now(x + cube_offsets[2][0], y + cube_offsets[2][1], z + cube_offsets[2][2])];
-                sample_value[3] =
-                    _data[offset_now(x + cube_offsets[3][0], y + cube_offsets[3][1], z + cube_offsets[3][2])];
-                sample_value[4] =
-                    _data[offset_now(x + cube_offsets[4][0], y + cube_offsets[4][1], z + cube_offsets[4][2])];
-                sample_value[5] =
-                    _data[offset_now(x + cube_offsets[5][0], y + cube_offsets[5][1], z + cube_offsets[5][2])];
-                sample_value[6] =
-                    _data[offset_now(x + cube_offsets[6][0], y + cube_offsets[6][1], z + cube_offsets[6][2])];
-                sample_value[7] =
-                    _data[offset_now(x + cube_offsets[7][0], y + cube_offsets[7][1], z + cube_offsets[7][2])];
+    // place one vertex in each cell crossing the surface, bricks are independent. A slab of bricks is processed at a
+    // time, so bricked volumes only need the voxels of the slab and the two layers of neighbors the normals read
+    for (size_t slab_begin = 0; slab_begin < bricks.size();) {
+        auto slab_end = slab_begin;
+        while (slab_end < bricks.size() && bricks[slab_end].first_cell[2] == bricks[slab_begin].first_cell[2]) {
+            auto const& first = bricks[slab_end].first_cell;
+            std::array<uint32_t, 3> touch_first, touch_last;
+            for (int i = 0; i < 3; ++i) {
+                touch_first[i] = first[i] < 2 ? 0 : first[i] - 2;
+                touch_last[i] = std::min(first[i] + _brick_size + 2, dims[i] - 1);
+            }
+            samples.touch(touch_first, touch_last);
+            ++slab_end;
+        }
+        if (!samples.fetch()) {
+            core::utility::log::Log::DefaultLog.WriteError("[SurfaceNets] Could not fetch the bricks of the volume.");
+            return;
+        }
 
-                uint32_t edge_crossings = 0;
+        core::utility::ParallelFor<size_t>(slab_begin, slab_end, 1, [&](size_t begin, size_t end) {
+            for (auto b = begin; b < end; ++b) {
+                auto& brick = bricks[b];
+                auto const& first = brick.first_cell;
+                std::array<uint32_t, 3> last;
+                for (int i = 0; i < 3; ++i) {
+                    last[i] = std::min(first[i] + _brick_size, dims[i] - 1);
+                }
 
-                std::array<float, 3> center_of_mass = {0.0f, 0.0f, 0.0f};
-                float normalization = 0.0f;
+                for (uint32_t z = first[2]; z < last[2]; z++) {
+                    for (uint32_t y = first[1]; y < last[1]; y++) {
+                        for (uint32_t x = first[0]; x < last[0]; x++) {
+
+                            std::array<float, 8> sample_value;
+                            for (int i = 0; i < 8; ++i) {
+                                sample_value[i] =
+                                    sample(x + cube_offsets[i][0], y + cube_offsets[i][1], z + cube_offsets[i][2]);
+                            }
+
+                            uint32_t edge_crossings = 0;
+
+                            std::array<float, 3> center_of_mass = {0.0f, 0.0f, 0.0f};
+                            float normalization = 0.0f;
+
+                            // Compute edge crossings and center of mass
+                            for (int i = 0; i < 12; ++i) {
+                                uint32_t const idx_0 = edge_vertex_offsets[i * 2 + 0];
+                                uint32_t const idx_1 = edge_vertex_offsets[i * 2 + 1];
+
+                                auto const v_0 = sample_value[idx_0];
+                                auto const v_1 = sample_value[idx_1];
+
+                                auto edge_crossing = uint32_t(!((v_0 > iso_value) == (v_1 > iso_value)));
+                                edge_crossings |= (edge_crossing << i);
+
+                                if (edge_crossing == 1) {
+                                    float d = ((iso_value - v_0) / (v_1 - v_0));
+                                    for (int j = 0; j < 3; ++j) {
+                                        auto const mix = static_cast<float>(cube_offsets[idx_0][j]) * (1.0f - d) +
+                                                         static_cast<float>(cube_offsets[idx_1][j]) * d;
+                                        center_of_mass[j] += static_cast<float>(j == 0 ? x : (j == 1 ? y : z)) + mix;
+                                    }
+                                    normalization += 1.0f;
+                                }
+                            } // for i < 12
+
+                            if (normalization > 0.0f) {
+                                std::array<float, 4> position;
+                                for (int j = 0; j < 3; ++j) {
+                                    position[j] = (center_of_mass[j] / normalization) * spacing[j] + volume_origin[j];
+                                    brick.min[j] = std::min(brick.min[j], position[j]);
+                                    brick.max[j] = std::max(brick.max[j], position[j]);
+                                }
+                                position[3] = 1.0f;
+                                brick.vertices.push_back(position);
+
+                                auto const local_idx =
+                                    (x - first[0]) + _brick_size * ((y - first[1]) + _brick_size * (z - first[2]));
+                                brick.filled.emplace_back(local_idx, edge_crossings);
+
+                                std::array<float, 3> normal;
+                                normal[0] = sample(x >= dims[0] - 1 ? x : x + 1, y, z) -
+                                            sample(x < 1 ? x : x - 1, y, z);
+                                normal[1] = sample(x, y >= dims[1] - 1 ? y : y + 1, z) -
+                                            sample(x, y < 1 ? y : y - 1, z);
+                                normal[2] = sample(x, y, z >= dims[2] - 1 ? z : z + 1) -
+                                            sample(x, y, z < 1 ? z : z - 1);
+                                if (normal[0] <= 1e-6 && normal[1] <= 1e-6 && normal[2] <= 1e-6) {
+                                    normal[0] = sample(x >= dims[0] - 2 ? x : x + 2, y, z) -
+                                                sample(x < 2 ? x : x - 2, y, z);
+                                    normal[1] = sample(x, y >= dims[1] - 2 ? y : y + 2, z) -
+                                                sample(x, y < 2 ? y : y - 2, z);
+                                    normal[2] = sample(x, y, z >= dims[2] - 2 ? z : z + 2) -
+                                                sample(x, y, z < 2 ? z : z - 2);
+                                }
+                                auto const normal_length =
+                                    std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                                normal[0] /= (normal_length < 0.00000001) ? 1.0 : normal_length;
+                                normal[1] /= (normal_length < 0.00000001) ? 1.0 : normal_length;
+                                normal[2] /= (normal_length < 0.00000001) ? 1.0 : normal_length;
+                                brick.normals.push_back(normal);
+                            }
+                        } // for x
+                    }     // for y
+                }         // for z
+            }
+        });
 
-                // Compute edge crossings and center of mass
-                for (int i = 0; i < 12; ++i) {
-                    uint32_t const idx_0 = edge_vertex_offsets[i * 2 + 0];
-                    uint32_t const idx_1 = edge_vertex_offsets[i * 2 + 1];
+        samples.evict();
+        slab_begin = slab_end;
+    }
 
-                    auto const v_0 = sample_value[idx_0];
-                    auto const v_1 = sample_value[idx_1];
+    // stitch the bricks: vertex indices become global by offsetting them with the vertex count of preceding bricks
+    uint32_t vertex_count = 0;
+    for (auto& brick : bricks) {
+        brick.vertex_offset = vertex_count;
+        vertex_count += static_cast<uint32_t>(brick.vertices.size());
+    }
+    _vertices.resize(vertex_count);
+    _normals.resize(vertex_count);
+    core::utility::ParallelFor<size_t>(0, bricks.size(), 1, [&](size_t begin, size_t end) {
+        for (auto b = begin; b < end; ++b) {
+            auto& brick = bricks[b];
+            std::copy(brick.vertices.begin(), brick.vertices.end(), _vertices.begin() + brick.vertex_offset);
+            std::copy(brick.normals.begin(), brick.normals.end(), _normals.begin() + brick.vertex_offset);
+            std::vector<std::array<float, 4>>().swap(brick.vertices);
+            std::vector<std::array<float, 3>>().swap(brick.normals);
+        }
+    });
 
-                    auto edge_crossing = uint32_t(!((v_0 > iso_value) == (v_1 > iso_value)));
-                    edge_crossings |= (edge_crossing << i);
+    core::utility::ParallelFor<size_t>(0, bricks.size(), 1, [&](size_t begin, size_t end) {
+        // lookup table for the brick being processed, reused for all bricks of this chunk
+        std::vector<uint32_t> local_lookup(_brick_size * _brick_size * _brick_size);
 
+        for (auto b = begin; b < end; ++b) {
+            auto& brick = bricks[b];
+            for (uint32_t v = 0; v < brick.filled.size(); ++v) {
+                local_lookup[brick.filled[v].first] = brick.vertex_offset + v;
+            }
 
+            // every cell adjacent to a crossed edge shares its samples, so a neighboring brick is active too
+            auto const vertex_at = [&](uint32_t x, uint32_t y, uint32_t z) -> uint32_t {
+                auto const local_idx =
+                    (x % _brick_size) + _brick_size * ((y % _brick_size) + _brick_size * (z % _brick_size));
+                if (x >= brick.first_cell[0] && y >= brick.first_cell[1] && z >= brick.first_cell[2]) {
+                    return local_lookup[local_idx];
+                }
+                auto const nb = (static_cast<size_t>(z / _brick_size) * brick_count[1] + y / _brick_size) *
+                                    brick_count[0] +
+                                x / _brick_size;
+                auto const& neighbor = bricks[active_slot[nb]];
+                auto const it = std::lower_bound(neighbor.filled.begin(), neighbor.filled.end(),
+                    std::make_pair(local_idx, uint32_t(0)),
+                    [](auto const& lhs, auto const& rhs) { return lhs.first < rhs.first; });
+                return neighbor.vertex_offset + static_cast<uint32_t>(it - neighbor.filled.begin());
+            };
+
+            for (auto const& [local_idx, edge_crossings] : brick.filled) {
+                std::array<uint32_t, 3> coords = {brick.first_cell[0] + local_idx % _brick_size,
+                    brick.first_cell[1] + (local_idx / _brick_size) % _brick_size,
+                    brick.first_cell[2] + local_idx / (_brick_size * _brick_size)};
+                if (coords[0] == 0 || coords[1] == 0 || coords[2] == 0)
+                    continue;
+                for (uint32_t i = 0; i < 3; ++i) {
+                    auto const edge_crossing = 1 & (edge_crossings >> i);
                     if (edge_crossing == 1) {
-
-                        float d = ((iso_value - v_0) / (v_1 - v_0));
-                        std::array<float, 3> mix;
-                        mix[0] = static_cast<float>(cube_offsets[idx_0][0]) * (1.0f - d) +
-                                 static_cast<float>(cube_offsets[idx_1][0]) * d;
-                        mix[1] = static_cast<float>(cube_offsets[idx_0][1]) * (1.0f - d) +
-                                 static_cast<float>(cube_offsets[idx_1][1]) * d;
-                        mix[2] = static_cast<float>(cube_offsets[idx_0][2]) * (1.0f - d) +
-                                 static_cast<float>(cube_offsets[idx_1][2]) * d;
-                        std::array<float, 3> intersect_pos;
-                        intersect_pos[0] = static_cast<float>(x) + mix[0];
-                        intersect_pos[1] = static_cast<float>(y) + mix[1];
-                        intersect_pos[2] = static_cast<float>(z) + mix[2];
-                        center_of_mass[0] += intersect_pos[0];
-                        center_of_mass[1] += intersect_pos[1];
-                        center_of_mass[2] += intersect_pos[2];
-                        normalization += 1.0f;
-                    }
-                } // for i < 12
-
-                voxel_edge_crossings[offset_now(x, y, z)] = edge_crossings;
-
-                if (normalization > 0.0f) {
-
-                    center_of_mass[0] /= normalization;
-                    center_of_mass[1] /= normalization;
-                    center_of_mass[2] /= normalization;
-
-                    std::array<float, 4> position;
-                    position[0] = ((center_of_mass[0] / _dims[0]) * _dims[0] * _spacing[0]) + _volume_origin[0];
-                    position[1] = ((center_of_mass[1] / _dims[1]) * _dims[1] * _spacing[1]) + _volume_origin[1];
-                    position[2] = ((center_of_mass[2] / _dims[2]) * _dims[2] * _spacing[2]) + _volume_origin[2];
-                    position[3] = 1.0f;
-                    _vertices.push_back(position);
-
-                    float eps = 0.005;
-                    vislib::math::Cuboid<float> point_box(position[0] - eps, position[1] - eps, position[2] - eps,
-                        position[0] + eps, position[1] + eps, position[2] + eps);
-
-                    auto bbox = _bboxs.BoundingBox();
-                    auto cbox = _bboxs.ClipBox();
-                    bbox.Union(point_box);
-                    cbox.Union(point_box);
-                    _bboxs.SetBoundingBox(bbox);
-                    _bboxs.SetClipBox(cbox);
-
-                    voxel_lookup[offset_now(x, y, z)] = _vertices.size() - 1;
-                    voxel_filled.push_back(offset_now(x, y, z));
-
-                    std::array<float, 3> normal;
-                    normal[0] = _data[offset_now(x >= _dims[0] - 1 ? x : x + 1, y, z)] -
-                                _data[offset_now(x < 1 ? x : x - 1, y, z)];
-                    normal[1] = _data[offset_now(x, y >= _dims[1] - 1 ? y : y + 1, z)] -
-                                _data[offset_now(x, y < 1 ? y : y - 1, z)];
-                    normal[2] = _data[offset_now(x, y, z >= _dims[2] - 1 ? z : z + 1)] -
-                                _data[offset_now(x, y, z < 1 ? z : z - 1)];
-                    if (normal[0] <= 1e-6 && normal[1] <= 1e-6 && normal[2] <= 1e-6) {
-                        normal[0] = _data[offset_now(x >= _dims[0] - 2 ? x : x + 2, y, z)] -
-                                    _data[offset_now(x < 2 ? x : x - 2, y, z)];
-                        normal[1] = _data[offset_now(x, y >= _dims[1] - 2 ? y : y + 2, z)] -
-                                    _data[offset_now(x, y < 2 ? y : y - 2, z)];
-                        normal[2] = _data[offset_now(x, y, z >= _dims[2] - 2 ? z : z + 2)] -
-                                    _data[offset_now(x, y, z < 2 ? z : z - 2)];
+                        std::array<uint32_t, 4> indices;
+                        if (i == 0) {
+                            indices[0] = vertex_at(coords[0], coords[1] - 1, coords[2]);
+                            indices[1] = vertex_at(coords[0], coords[1] - 1, coords[2] - 1);
+                            indices[2] = vertex_at(coords[0], coords[1], coords[2] - 1);
+                            indices[3] = vertex_at(coords[0], coords[1], coords[2]);
+                        } else if (i == 1) {
+                            indices[0] = vertex_at(coords[0] - 1, coords[1] - 1, coords[2]);
+                            indices[1] = vertex_at(coords[0], coords[1] - 1, coords[2]);
+                            indices[2] = vertex_at(coords[0], coords[1], coords[2]);
+                            indices[3] = vertex_at(coords[0] - 1, coords[1], coords[2]);
+                        } else {
+                            indices[0] = vertex_at(coords[0] - 1, coords[1], coords[2]);
+                            indices[1] = vertex_at(coords[0], coords[1], coords[2]);
+                            indices[2] = vertex_at(coords[0], coords[1], coords[2] - 1);
+                            indices[3] = vertex_at(coords[0] - 1, coords[1], coords[2] - 1);
+                        }
+
+                        // hack normals
+                        auto tangent = _vertices[indices[2]];
+                        auto bitangent = _vertices[indices[1]];
+
+                        tangent[0] -= _vertices[indices[0]][0];
+                        tangent[1] -= _vertices[indices[0]][1];
+                        tangent[2] -= _vertices[indices[0]][2];
+                        auto t_length =
+                            std::sqrt(tangent[0] * tangent[0] + tangent[1] * tangent[1] + tangent[2] * tangent[2]);
+                        tangent[0] /= t_length;
+                        tangent[1] /= t_length;
+                        tangent[2] /= t_length;
+
+                        bitangent[0] -= _vertices[indices[0]][0];
+                        bitangent[1] -= _vertices[indices[0]][1];
+                        bitangent[2] -= _vertices[indices[0]][2];
+                        auto bt_length = std::sqrt(bitangent[0] * bitangent[0] + bitangent[1] * bitangent[1] +
+                                                   bitangent[2] * bitangent[2]);
+                        bitangent[0] /= bt_length;
+                        bitangent[1] /= bt_length;
+                        bitangent[2] /= bt_length;
+
+                        std::array<float, 3> normal;
+                        normal[0] = tangent[1] * bitangent[2] - tangent[2] * bitangent[1];
+                        normal[1] = tangent[2] * bitangent[0] - tangent[0] * bitangent[2];
+                        normal[2] = tangent[0] * bitangent[1] - tangent[1] * bitangent[0];
+                        auto n_length =
+                            std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                        normal[0] /= n_length;
+                        normal[1] /= n_length;
+                        normal[2] /= n_length;
+
+                        brick.faces.emplace_back(indices);
+                        brick.face_normals.emplace_back(normal);
                     }
-                    auto const normal_length =
-                        std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
-                    normal[0] /= (normal_length < 0.00000001) ? 1.0 : normal_length;
-                    normal[1] /= (normal_length < 0.00000001) ? 1.0 : normal_length;
-                    normal[2] /= (normal_length < 0.00000001) ? 1.0 : normal_length;
-                    _normals.push_back(normal);
-                }
-            } // for x
-        }     // for y
-    }         // for z
-    voxel_filled.shrink_to_fit();
-
-    auto const coordinateFromLinearIndex = [](uint32_t idx, uint32_t max_x, uint32_t max_y) {
-        std::array<uint32_t, 3> coords;
-        coords[0] = idx % (max_x);
-        idx /= (max_x);
-        coords[1] = idx % (max_y);
-        idx /= (max_y);
-        coords[2] = idx;
-        return coords;
-    };
+                } // for i < 3
+            }     // for filled
+        }
+    });
 
+    uint32_t face_count = 0;
+    for (auto& brick : bricks) {
+        brick.face_offset = face_count;
+        face_count += static_cast<uint32_t>(brick.faces.size());
+    }
+    _faces.resize(face_count);
+    _triangles.resize(2 * static_cast<size_t>(face_count));
+    core::utility::ParallelFor<size_t>(0, bricks.size(), 1, [&](size_t begin, size_t end) {
+        for (auto b = begin; b < end; ++b) {
+            auto const& brick = bricks[b];
+            for (size_t f = 0; f < brick.faces.size(); ++f) {
+                auto const& indices = brick.faces[f];
+                auto const out = brick.face_offset + f;
+                _faces[out] = indices;
+                _triangles[2 * out + 0] = {indices[0], indices[1], indices[2]};
+                _triangles[2 * out + 1] = {indices[0], indices[2], indices[3]};
+            }
+        }
+    });
 
-    for (auto id : voxel_filled) {
-        for (uint32_t i = 0; i < 3; ++i) {
-            auto const edge_crossing = 1 & (voxel_edge_crossings[id] >> i);
-            if (edge_crossing == 1) {
-                auto coords = coordinateFromLinearIndex(id, _dims[0], _dims[1]);
-                if (coords[0] > 0 && coords[1] > 0 && coords[2] > 0) {
-                    std::array<uint32_t, 4> indices;
-                    std::array<uint32_t, 3> triangle1;
-                    std::array<uint32_t, 3> triangle2;
-                    if (i == 0) {
-                        indices[0] = voxel_lookup[offset_now(coords[0], coords[1] - 1, coords[2])];
-                        indices[1] = voxel_lookup[offset_now(coords[0], coords[1] - 1, coords[2] - 1)];
-                        indices[2] = voxel_lookup[offset_now(coords[0], coords[1], coords[2] - 1)];
-                        indices[3] = voxel_lookup[offset_now(coords[0], coords[1], coords[2])]; // or just id
-                    } else if (i == 1) {
-                        indices[0] = voxel_lookup[offset_now(coords[0] - 1, coords[1] - 1, coords[2])];
-                        indices[1] = voxel_lookup[offset_now(coords[0], coords[1] - 1, coords[2])];
-                        indices[2] = voxel_lookup[offset_now(coords[0], coords[1], coords[2])];
-                        indices[3] = voxel_lookup[offset_now(coords[0] - 1, coords[1], coords[2])];
-                    } else if (i == 2) {
-                        indices[0] = voxel_lookup[offset_now(coords[0] - 1, coords[1], coords[2])];
-                        indices[1] = voxel_lookup[offset_now(coords[0], coords[1], coords[2])];
-                        indices[2] = voxel_lookup[offset_now(coords[0], coords[1], coords[2] - 1)];
-                        indices[3] = voxel_lookup[offset_now(coords[0] - 1, coords[1], coords[2] - 1)];
-                    }
-                    triangle1[0] = indices[0];
-                    triangle1[1] = indices[1];
-                    triangle1[2] = indices[2];
-                    triangle2[0] = indices[0];
-                    triangle2[1] = indices[2];
-                    triangle2[2] = indices[3];
-
-                    // hack normals
-                    auto tangent = _vertices[indices[2]];
-                    auto bitangent = _vertices[indices[1]];
-
-                    tangent[0] -= _vertices[indices[0]][0];
-                    tangent[1] -= _vertices[indices[0]][1];
-                    tangent[2] -= _vertices[indices[0]][2];
-                    auto t_length =
-                        std::sqrt(tangent[0] * tangent[0] + tangent[1] * tangent[1] + tangent[2] * tangent[2]);
-                    tangent[0] /= t_length;
-                    tangent[1] /= t_length;
-                    tangent[2] /= t_length;
-
-                    bitangent[0] -= _vertices[indices[0]][0];
-                    bitangent[1] -= _vertices[indices[0]][1];
-                    bitangent[2] -= _vertices[indices[0]][2];
-                    auto bt_length = std::sqrt(
-                        bitangent[0] * bitangent[0] + bitangent[1] * bitangent[1] + bitangent[2] * bitangent[2]);
-                    bitangent[0] /= bt_length;
-                    bitangent[1] /= bt_length;
-                    bitangent[2] /= bt_length;
-
-                    std::array<float, 3> normal;
-                    normal[0] = tangent[1] * bitangent[2] - tangent[2] * bitangent[1];
-                    normal[1] = tangent[2] * bitangent[0] - tangent[0] * bitangent[2];
-                    normal[2] = tangent[0] * bitangent[1] - tangent[1] * bitangent[0];
-                    auto n_length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
-                    normal[0] /= n_length;
-                    normal[1] /= n_length;
-                    normal[2] /= n_length;
-
-                    auto myDot = [](std::array<float, 3> const& v0, std::array<float, 3> const& v1) -> float {
-                        return (v0[0] * v1[0] + v0[1] * v1[1] + v0[2] * v1[2]);
-                    };
-
-                    _normals[indices[0]] = myDot(_normals[indices[0]], normal) > 0.0
-                                               ? normal
-                                               : std::array<float, 3>{-normal[0], -normal[1], -normal[2]};
-                    _normals[indices[1]] = myDot(_normals[indices[1]], normal) > 0.0
-                                               ? normal
-                                               : std::array<float, 3>{-normal[0], -normal[1], -normal[2]};
-                    _normals[indices[2]] = myDot(_normals[indices[2]], normal) > 0.0
-                                               ? normal
-                                               : std::array<float, 3>{-normal[0], -normal[1], -normal[2]};
-                    _normals[indices[3]] = myDot(_normals[indices[3]], normal) > 0.0
-                                               ? normal
-                                               : std::array<float, 3>{-normal[0], -normal[1], -normal[2]};
-
-                    _faces.emplace_back(indices);
-                    _triangles.emplace_back(triangle1);
-                    _triangles.emplace_back(triangle2);
-                }
+    // faces of neighboring bricks share vertices, so the normals are oriented in face order
+    auto myDot = [](std::array<float, 3> const& v0, std::array<float, 3> const& v1) -> float {
+        return (v0[0] * v1[0] + v0[1] * v1[1] + v0[2] * v1[2]);
+    };
+    for (auto const& brick : bricks) {
+        for (size_t f = 0; f < brick.faces.size(); ++f) {
+            auto const& normal = brick.face_normals[f];
+            for (auto const idx : brick.faces[f]) {
+                _normals[idx] = myDot(_normals[idx], normal) > 0.0
+                                    ? normal
+                                    : std::array<float, 3>{-normal[0], -normal[1], -normal[2]};
             }
-        } // for i < 3
-    }     // for voxel_filled
+        }
+    }
+
+    if (vertex_count > 0) {
+        std::array<float, 3> min = bricks.front().min;
+        std::array<float, 3> max = bricks.front().max;
+        for (auto const& brick : bricks) {
+            for (int j = 0; j < 3; ++j) {
+                min[j] = std::min(min[j], brick.min[j]);
+                max[j] = std::max(max[j], brick.max[j]);
+            }
+        }
+
+        float eps = 0.005;
+        vislib::math::Cuboid<float> point_box(
+            min[0] - eps, min[1] - eps, min[2] - eps, max[0] + eps, max[1] + eps, max[2] + eps);
+
+        auto bbox = _bboxs.BoundingBox();
+        auto cbox = _bboxs.ClipBox();
+        bbox.Union(point_box);
+        cbox.Union(point_box);
+        _bboxs.SetBoundingBox(bbox);
+        _bboxs.SetClipBox(cbox);
+    }
 }
 
 bool SurfaceNets::getData(core::Call& call) {
@@ -352,7 +603,9 @@ bool SurfaceNets::getData(core::Call& call) {
         return false;
     if (!(*cd)(geocalls::VolumetricDataCall::IDX_GET_METADATA))
         return false;
-    if (!(*cd)(geocalls::VolumetricDataCall::IDX_GET_DATA))
+    // bricked sources deliver the voxels on demand while extracting the surface
+    auto const bricked = this->openBricks(*cd);
+    if (!bricked && !(*cd)(geocalls::VolumetricDataCall::IDX_GET_DATA))
         return false;
 
     // get data from volumetric call
@@ -374,24 +627,18 @@ bool SurfaceNets::getData(core::Call& call) {
         _spacing[0] = meta_data->SliceDists[0][0];
         _spacing[1] = meta_data->SliceDists[1][0];
         _spacing[2] = meta_data->SliceDists[2][0];
-        if (cd->GetScalarType() == geocalls::FLOATING_POINT) {
+        _brick_ranges.clear();
+        // byte volumes are sampled directly instead of converting them to floats first
+        _data = nullptr;
+        _byte_data = nullptr;
+        if (!bricked && cd->GetScalarType() == geocalls::FLOATING_POINT) {
             _data = static_cast<float*>(cd->GetData());
-        } else if (cd->GetScalarType() == geocalls::UNSIGNED_INTEGER) {
-            _converted_data.reserve(_dims[0] * _dims[1] * _dims[2]);
-            auto c_data = static_cast<unsigned char*>(cd->GetData());
-            for (uint32_t z = 0; z < _dims[2]; ++z) {
-                for (uint32_t y = 0; y < _dims[1]; ++y) {
-                    for (uint32_t x = 0; x < _dims[0]; ++x) {
-                        uint64_t idx = z * _dims[0] * _dims[1] + y * _dims[0] + x;
-                        _converted_data.emplace_back(c_data[idx]);
-                    }
-                }
-            }
-            _data = _converted_data.data();
+        } else if (!bricked && cd->GetScalarType() == geocalls::UNSIGNED_INTEGER) {
+            _byte_data = static_cast<unsigned char const*>(cd->GetData());
         }
     }
 
-    if (something_changed && _data) {
+    if (something_changed && (bricked || _data || _byte_data)) {
         this->calculateSurfaceNets();
 
         _mesh_attribs.resize(2);
@@ -425,6 +672,8 @@ bool SurfaceNets::getData(core::Call& call) {
         ++_version;
     }
 
+    _sampler.Close();
+
     // put data in mesh
     mesh::MeshDataAccessCollection mesh;
 
@@ -499,11 +748,14 @@ bool SurfaceNets::getNormalData(core::Call& call) {
         return false;
     if (!(*cd)(geocalls::VolumetricDataCall::IDX_GET_METADATA))
         return false;
-    if (!(*cd)(geocalls::VolumetricDataCall::IDX_GET_DATA))
+    // bricked sources deliver the voxels on demand while extracting the surface
+    auto const bricked = this->openBricks(*cd);
+    if (!bricked && !(*cd)(geocalls::VolumetricDataCall::IDX_GET_DATA))
         return false;
 
     if (cd->DataHash() != _old_datahash) {
         something_changed = true;
+        _brick_ranges.clear();
     }
 
     _dims[0] = cd->GetResolution(0);
@@ -518,11 +770,13 @@ bool SurfaceNets::getNormalData(core::Call& call) {
     _spacing[2] = meta_data->SliceDists[2][0];
     if (cd->GetScalarType() != geocalls::FLOATING_POINT)
         return false;
-    _data = reinterpret_cast<float*>(cd->GetData());
+    _data = bricked ? nullptr : reinterpret_cast<float*>(cd->GetData());
+    _byte_data = nullptr;
 
     if (something_changed || _recalc) {
         this->calculateSurfaceNets();
     }
+    _sampler.Close();
 
     mpd->SetParticleListCount(1);
     mpd->AccessParticles(0).SetGlobalRadius(cd->AccessBoundingBoxes().ObjectSpaceBBox().LongestEdge() * 1e-3);
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "concave_hull.h"
+#include "geometry_calls/VolumetricBrickSampler.h"
 #include "geometry_calls/VolumetricDataCall.h"
 #include "mesh/MeshCalls.h"
 #include "mmcore/CalleeSlot.h"
@@ -71,6 +72,16 @@ private:
 
     void calculateSurfaceNets();
 
+    template<typename Samples>
+    void calculateSurfaceNets(Samples& samples);
+
+    template<typename T>
+    void updateBrickRanges(T const* data);
+
+    void updateBrickRanges(geocalls::VolumetricBrickIndex const& index);
+
+    bool openBricks(geocalls::VolumetricDataCall& cd);
+
     bool getMetaData(core::Call& call);
     bool getData(core::Call& call);
 
@@ -92,8 +103,18 @@ private:
     std::array<uint32_t, 3> _dims;
     std::array<float, 3> _spacing;
     std::array<float, 3> _volume_origin;
-    std::vector<float> _converted_data;
-    float* _data;
+    float* _data = nullptr;
+    unsigned char const* _byte_data = nullptr;
+
+    // bricked sources are sampled through this instead of _data, only bricks near the surface are loaded
+    geocalls::VolumetricBrickSampler _sampler;
+
+    /** Edge length of the bricks the grid is processed in, in cells. */
+    static constexpr uint32_t _brick_size = 32;
+
+    // value range of each brick, bricks not containing the iso value are skipped
+    std::array<uint32_t, 3> _brick_count;
+    std::vector<std::pair<float, float>> _brick_ranges;
 
     // store surface
     std::vector<std::array<float, 4>> _vertices;
@@ -1,5 +1,5 @@
 /*
- * GridNeighbourFinder.cpp
+ * GridNeighbourFinder.h
  *
  * Copyright (C) 2011 by University of Stuttgart (VISUS).
  * All rights reserved.
@@ -12,151 +12,340 @@
 #pragma once
 #endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
 
+#include "mmcore/utility/TaskScheduler.h"
 #include "mmcore/utility/log/Log.h"
 #include "stdafx.h"
+#include "vislib/Array.h"
 #include "vislib/ArrayAllocator.h"
 #include "vislib/SmartPtr.h"
 #include "vislib/math/Cuboid.h"
 #include "vislib/math/ShallowPoint.h"
 #include "vislib/math/mathfunctions.h"
 #include "vislib/types.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <ctime>
+#include <vector>
 
 using namespace megamol;
 
 /**
- * Simple nearest-neighbour-search implementation which uses a regular grid to speed up search queries.
+ * Nearest-neighbour search on a uniform grid (cell list).
+ *
+ * The points are sorted into cells at least as large as the search distance
+ * by a counting sort, so every cell is a contiguous range of the sorted
+ * points and a query only visits the 27 cells around it. Positions are kept
+ * in cell order for cache-friendly queries. Points outside the bounding box
+ * are clamped into the border cells, which costs performance, but not
+ * correctness.
+ *
+ * Queries are const and may run concurrently; FindAllNeighboursInRange runs
+ * a whole batch of them in parallel. For trajectories, UpdatePointData
+ * re-sorts new positions of the same points into the existing grid.
  */
 namespace megamol {
 namespace protein {
-template<class T /*, unigned int Dim> als template parameter?!*/>
+template<class T>
 class GridNeighbourFinder {
-    typedef vislib::math::Point<T, 3> Point;
 
 public:
-    GridNeighbourFinder() : elementGrid(0), elementCount(0), elementPositions(0) {}
-
-    ~GridNeighbourFinder() {
-        delete[] elementGrid;
+    GridNeighbourFinder() : elementPositions(nullptr), elementCount(0), gridSize(0), searchDistance(0) {
+        for (int i = 0; i < 3; i++) {
+            this->elementOrigin[i] = 0;
+            this->gridResolution[i] = 1;
+            this->gridResolutionFactors[i] = 0;
+        }
     }
 
+    ~GridNeighbourFinder() = default;
+
     /**
      * Set new point data to the neighbourhood search grid.
-     * @params TODO
+     *
+     * @param pointData      The positions as xyz triples. The finder does not
+     *                       copy the pointer, but only the positions.
+     * @param pointCount     The number of points.
+     * @param boundingBox    The bounding box of the points.
+     * @param searchDistance The search distance the grid is optimised for.
+     * @param filter         If not null, points with a filter value of -1 are
+     *                       not inserted.
      */
     void SetPointData(const T* pointData, unsigned int pointCount, vislib::math::Cuboid<T> boundingBox,
         T searchDistance, int* filter = 0) {
         this->elementPositions = pointData;
         this->elementCount = pointCount;
+        this->searchDistance = searchDistance;
 
-        // does the new BBox fit into the old one?
-        if (!elementGrid || !(this->elementBBox.Contains(boundingBox.GetLeftBottomBack(), -1) &&
-                                this->elementBBox.Contains(boundingBox.GetRightTopFront(), -1))) {
-            /* resize bounding-box and grid structure */
-            vislib::math::Dimension<T, 3> dim = boundingBox.GetSize();
-            for (int i = 0; i < 3; i++)
-                this->gridResolution[i] = (unsigned int)floor(dim[i] / (2 * searchDistance) + 1.0);
-            this->gridSize = this->gridResolution[0] * this->gridResolution[1] * this->gridResolution[2];
-            this->elementBBox = boundingBox;
-
-            // initialize element grid
-            if (elementGrid)
-                delete[] elementGrid;
-            this->elementGrid = new vislib::Array<const T*>[gridSize];
-            for (unsigned int i = 0; i < gridSize; i++) {
-                elementGrid[i].Resize(100);
-                elementGrid[i].SetCapacityIncrement(100);
+        /* Cells are at least as large as the search distance, but their number stays linear in the points. */
+        vislib::math::Dimension<T, 3> dim = boundingBox.GetSize();
+        const double maxCells = (std::max)(64.0, 8.0 * pointCount);
+        double cells = 1.0;
+        double res[3];
+        for (int i = 0; i < 3; i++) {
+            res[i] = (searchDistance > 0) ? std::floor(dim[i] / searchDistance) : 1.0;
+            res[i] = (std::max)(1.0, res[i]);
+            cells *= res[i];
+        }
+        if (cells > maxCells) {
+            const double scale = std::cbrt(cells / maxCells);
+            for (int i = 0; i < 3; i++) {
+                res[i] = (std::max)(1.0, std::floor(res[i] / scale));
             }
-        } else {
-            for (unsigned int i = 0; i < gridSize; i++)
-                elementGrid[i].Clear();
         }
 
-        this->elementOrigin = this->elementBBox.GetOrigin();
-
-        /** fill the internal grid structure */
-        vislib::math::Dimension<T, 3> bBoxDimension = this->elementBBox.GetSize();
+        const auto origin = boundingBox.GetOrigin();
         for (int i = 0; i < 3; i++) {
-            this->gridResolutionFactors[i] = (T)this->gridResolution[i] / bBoxDimension[i];
-            this->cellSize[i] = (T)bBoxDimension[i] / this->gridResolution[i]; //(T)1.0) / gridResolutionFactors[i];
+            this->elementOrigin[i] = origin[i];
+            this->gridResolution[i] = static_cast<unsigned int>(res[i]);
+            this->gridResolutionFactors[i] = (dim[i] > 0) ? static_cast<T>(this->gridResolution[i] / dim[i]) : 0;
         }
-        // sort the element positions into the grid ...
-        for (unsigned int i = 0; i < this->elementCount; i++) {
-            // we can skip this assert becaus another ASSERT in 'insertPointIntoGrid'
-            //ASSERT( elementBBox.Contains(vislib::math::ShallowPoint<T,3>(const_cast<T*>(&elementPositions[i*3]))) );
-            if (!filter || filter[i] != -1)
-                insertPointIntoGrid(&this->elementPositions[i * 3]);
+        this->gridSize = this->gridResolution[0] * this->gridResolution[1] * this->gridResolution[2];
+
+        this->elementIndices.clear();
+        this->elementIndices.reserve(pointCount);
+        for (unsigned int i = 0; i < pointCount; i++) {
+            if (!filter || filter[i] != -1) {
+                this->elementIndices.push_back(i);
+            }
         }
+
+        this->elementCells.resize(this->elementIndices.size());
+        this->computeCells();
+        this->sortIntoGrid();
     }
 
-public:
-    //template<typename T>
-    void FindNeighboursInRange(const T* point, T distance, vislib::Array<unsigned int>& resIdx) const {
-        //Point relPos = sub(point, elementOrigin);
-        T relPos[3] = {point[0] - elementOrigin[0], point[1] - elementOrigin[1], point[2] - elementOrigin[2]};
+    /**
+     * Updates the positions of the points set by the last call to
+     * SetPointData, for instance for the next frame of a trajectory. The
+     * grid and the filter are retained. If no point has left its cell, only
+     * the positions are refreshed.
+     *
+     * @param pointData  The new positions as xyz triples.
+     * @param pointCount The number of points, which must not have changed.
+     *
+     * @return 'true' on success, 'false' if the number of points has changed
+     *         and SetPointData must be called instead.
+     */
+    bool UpdatePointData(const T* pointData, unsigned int pointCount) {
+        if ((pointCount != this->elementCount) || (this->gridSize == 0)) {
+            return false;
+        }
 
-        // calculate range in the grid ...
-        int min[3], max[3];
-        for (unsigned int i = 0; i < 3; i++) {
-            min[i] = (int)floor((relPos[i] - distance) * gridResolutionFactors[i]);
-            if (min[i] < 0)
-                min[i] = 0;
-            max[i] = (int)ceil((relPos[i] + distance) * gridResolutionFactors[i]);
-            if (max[i] >= (int)gridResolution[i])
-                max[i] = (int)gridResolution[i] - 1;
+        this->elementPositions = pointData;
+        if (this->computeCells()) {
+            this->sortIntoGrid();
+        } else {
+            this->gatherPositions();
         }
+        return true;
+    }
+
+    /**
+     * Answer the number of points set, including filtered ones.
+     */
+    inline unsigned int GetPointCount(void) const {
+        return this->elementCount;
+    }
+
+    /**
+     * Answer the search distance the grid has been built for.
+     */
+    inline T GetSearchDistance(void) const {
+        return this->searchDistance;
+    }
+
+    /**
+     * Calls 'func' with the index of every point within 'distance' of
+     * 'point'.
+     */
+    template<class F>
+    void ForEachNeighbourInRange(const T* point, T distance, F&& func) const {
+        this->visitNeighboursInRange(point, distance, [&func](unsigned int idx) {
+            func(idx);
+            return false;
+        });
+    }
+
+    /**
+     * Answer whether any point is within 'distance' of 'point'. The search
+     * stops at the first hit.
+     */
+    bool HasNeighbourInRange(const T* point, T distance) const {
+        return this->visitNeighboursInRange(point, distance, [](unsigned int) { return true; });
+    }
+
+    /**
+     * Appends the indices of all points within 'distance' of 'point' to
+     * 'resIdx'.
+     */
+    void FindNeighboursInRange(const T* point, T distance, vislib::Array<unsigned int>& resIdx) const {
+        this->ForEachNeighbourInRange(point, distance, [&resIdx](unsigned int idx) { resIdx.Add(idx); });
+    }
+
+    /**
+     * Appends the indices of all points within 'distance' of 'point' to
+     * 'resIdx'.
+     */
+    void FindNeighboursInRange(const T* point, T distance, std::vector<unsigned int>& resIdx) const {
+        this->ForEachNeighbourInRange(point, distance, [&resIdx](unsigned int idx) { resIdx.push_back(idx); });
+    }
 
-        // loop over all cells inside the sphere (point, distance)
-        /*              for(float x = relPos[0]-distance; x <= relPos[0]+distance+cellSize[0]; x += cellSize[0]) {
-                                for(float y = relPos[1]-distance; y <= relPos[1]+distance+cellSize[1]; y += cellSize[1]) {
-                                        for(float z = relPos[2]-distance; z <= relPos[2]+distance+cellSize[2]; z += cellSize[2]) {
-                                                unsigned int indexX = x * gridResolutionFactors[0]; // floor()
-                                                unsigned int indexY = y * gridResolutionFactors[1];
-                                                unsigned int indexZ = z * gridResolutionFactors[2];
-                                                if (indexX > 0 && indexX < ... && ... && ... )
-                                        */
-        for (int indexX = min[0]; indexX <= max[0]; indexX++) {
-            for (int indexY = min[1]; indexY <= max[1]; indexY++) {
-                for (int indexZ = min[2]; indexZ <= max[2]; indexZ++) {
-                    //if ( (Point(x,y,z)-relPos).Length() < distance ) continue;
-                    findNeighboursInCell(elementGrid[cellIndex(indexX, indexY, indexZ)], point, distance, resIdx);
+    /**
+     * Finds the neighbours of a batch of query points in parallel. The
+     * neighbours of query i are neighbours[offsets[i]] to
+     * neighbours[offsets[i + 1] - 1], in the same order FindNeighboursInRange
+     * would report them.
+     *
+     * @param points     The query positions as xyz triples.
+     * @param pointCount The number of query points.
+     * @param distance   The search distance.
+     * @param offsets    Receives pointCount + 1 offsets into 'neighbours'.
+     * @param neighbours Receives the indices of the neighbours.
+     */
+    void FindAllNeighboursInRange(const T* points, unsigned int pointCount, T distance, std::vector<size_t>& offsets,
+        std::vector<unsigned int>& neighbours) const {
+        /* Every chunk of queries collects into its own buffer, which are concatenated in order afterwards. */
+        const unsigned int chunkSize = 1024;
+        const unsigned int chunks = (pointCount + chunkSize - 1) / chunkSize;
+        std::vector<std::vector<unsigned int>> buffers(chunks);
+
+        offsets.assign(static_cast<size_t>(pointCount) + 1, 0);
+        core::utility::ParallelFor<unsigned int>(0, chunks, 1, [&](unsigned int begin, unsigned int end) {
+            for (auto c = begin; c < end; ++c) {
+                const auto last = (std::min)(pointCount, (c + 1) * chunkSize);
+                for (auto i = c * chunkSize; i < last; ++i) {
+                    const auto before = buffers[c].size();
+                    this->FindNeighboursInRange(points + 3 * static_cast<size_t>(i), distance, buffers[c]);
+                    offsets[i + 1] = buffers[c].size() - before;
                 }
             }
+        });
+
+        for (size_t i = 0; i < pointCount; ++i) {
+            offsets[i + 1] += offsets[i];
         }
+        neighbours.resize(offsets[pointCount]);
+        core::utility::ParallelFor<unsigned int>(0, chunks, 1, [&](unsigned int begin, unsigned int end) {
+            for (auto c = begin; c < end; ++c) {
+                std::copy(buffers[c].begin(), buffers[c].end(), neighbours.begin() + offsets[c * chunkSize]);
+            }
+        });
     }
 
 private:
-    VISLIB_FORCEINLINE void insertPointIntoGrid(const T* point) {
-        //Point relPos = sub(point, elementOrigin);
-        unsigned int indexX =
-            (unsigned int)(/*relPos.X()*/ (point[0] - elementOrigin[0]) * gridResolutionFactors[0]); // floor()?
-        unsigned int indexY = (unsigned int)(/*relPos.Y()*/ (point[1] - elementOrigin[1]) * gridResolutionFactors[1]);
-        unsigned int indexZ = (unsigned int)(/*relPos.Z()*/ (point[2] - elementOrigin[2]) * gridResolutionFactors[2]);
-        ASSERT(indexX < gridResolution[0] && indexY < gridResolution[1] && indexZ < gridResolution[2]);
-        vislib::Array<const T*>& cell = elementGrid[cellIndex(indexX, indexY, indexZ)];
-        cell.Add(point);
+    /** The number of points a task processes while building the grid. */
+    static constexpr unsigned int BUILD_GRAIN = 1 << 14;
+
+    /**
+     * Computes the cell of every inserted point.
+     *
+     * @return 'true' if any point has changed its cell.
+     */
+    bool computeCells(void) {
+        const auto cnt = static_cast<unsigned int>(this->elementIndices.size());
+        std::atomic<bool> changed(false);
+        core::utility::ParallelFor<unsigned int>(0, cnt, BUILD_GRAIN, [&](unsigned int begin, unsigned int end) {
+            bool localChanged = false;
+            for (auto i = begin; i < end; ++i) {
+                const T* p = this->elementPositions + 3 * static_cast<size_t>(this->elementIndices[i]);
+                const auto cell = this->cellIndex(this->cellCoord(p[0], 0), this->cellCoord(p[1], 1),
+                    this->cellCoord(p[2], 2));
+                localChanged = localChanged || (cell != this->elementCells[i]);
+                this->elementCells[i] = cell;
+            }
+            if (localChanged) {
+                changed.store(true, std::memory_order_relaxed);
+            }
+        });
+        return changed.load();
+    }
+
+    /** Sorts the inserted points into the cells by a counting sort. */
+    void sortIntoGrid(void) {
+        this->cellStarts.assign(static_cast<size_t>(this->gridSize) + 1, 0);
+        for (auto cell : this->elementCells) {
+            ++this->cellStarts[cell + 1];
+        }
+        for (unsigned int i = 0; i < this->gridSize; i++) {
+            this->cellStarts[i + 1] += this->cellStarts[i];
+        }
+
+        /* Inserting in index order keeps every cell sorted by index. */
+        std::vector<unsigned int> next(this->cellStarts.begin(), this->cellStarts.end() - 1);
+        this->sortedIndices.resize(this->elementIndices.size());
+        for (size_t i = 0; i < this->elementIndices.size(); i++) {
+            this->sortedIndices[next[this->elementCells[i]]++] = this->elementIndices[i];
+        }
+
+        this->gatherPositions();
     }
 
-    VISLIB_FORCEINLINE void findNeighboursInCell(
-        const vislib::Array<const T*>& cell, const T* point, T distance, vislib::Array<unsigned int>& resIdx) const {
-        for (int i = 0; i < (int)cell.Count(); i++)
-            if (dist(cell[i], point) <= distance)
-                resIdx.Add((unsigned int)((cell[i] - elementPositions) / 3)); // store atom index
+    /** Copies the positions of the inserted points in cell order. */
+    void gatherPositions(void) {
+        const auto cnt = static_cast<unsigned int>(this->sortedIndices.size());
+        this->sortedPositions.resize(3 * static_cast<size_t>(cnt));
+        core::utility::ParallelFor<unsigned int>(0, cnt, BUILD_GRAIN, [&](unsigned int begin, unsigned int end) {
+            for (auto i = begin; i < end; ++i) {
+                const T* p = this->elementPositions + 3 * static_cast<size_t>(this->sortedIndices[i]);
+                T* q = this->sortedPositions.data() + 3 * static_cast<size_t>(i);
+                q[0] = p[0];
+                q[1] = p[1];
+                q[2] = p[2];
+            }
+        });
     }
 
-    inline unsigned int cellIndex(unsigned int x, unsigned int y, unsigned int z) const {
-        return x + (y + z * gridResolution[1]) * gridResolution[0];
+    /**
+     * Calls 'func' with the index of every point within 'distance' of
+     * 'point' until it returns 'true'.
+     *
+     * @return 'true' if 'func' stopped the search.
+     */
+    template<class F>
+    bool visitNeighboursInRange(const T* point, T distance, F&& func) const {
+        if (this->sortedIndices.empty()) {
+            return false;
+        }
+
+        // calculate range in the grid ...
+        unsigned int min[3], max[3];
+        for (unsigned int i = 0; i < 3; i++) {
+            min[i] = this->cellCoord(point[i] - distance, i);
+            max[i] = this->cellCoord(point[i] + distance, i);
+        }
+
+        // ... and test the points in it, the x-range of every row being contiguous
+        const T sqDistance = distance * distance;
+        for (unsigned int indexZ = min[2]; indexZ <= max[2]; indexZ++) {
+            for (unsigned int indexY = min[1]; indexY <= max[1]; indexY++) {
+                const auto first = this->cellStarts[this->cellIndex(min[0], indexY, indexZ)];
+                const auto last = this->cellStarts[this->cellIndex(max[0], indexY, indexZ) + 1];
+                for (auto i = first; i < last; i++) {
+                    const T* p = this->sortedPositions.data() + 3 * static_cast<size_t>(i);
+                    const T x = p[0] - point[0];
+                    const T y = p[1] - point[1];
+                    const T z = p[2] - point[2];
+                    if ((x * x + y * y + z * z <= sqDistance) && func(this->sortedIndices[i])) {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        return false;
     }
 
-    inline static Point sub(const T* a, const Point& b) {
-        return Point(a[0] - b[0], a[1] - b[1], a[2] - b[2]);
-    };
+    inline unsigned int cellCoord(T value, unsigned int dim) const {
+        const auto c = std::floor((value - this->elementOrigin[dim]) * this->gridResolutionFactors[dim]);
+        if (!(c > 0)) {
+            return 0;
+        }
+        return (c < this->gridResolution[dim]) ? static_cast<unsigned int>(c) : this->gridResolution[dim] - 1;
+    }
 
-    inline static T dist(const T* a, const T* b) {
-        T x = a[0] - b[0];
-        T y = a[1] - b[1];
-        T z = a[2] - b[2];
-        return sqrt(x * x + y * y + z * z);
+    inline unsigned int cellIndex(unsigned int x, unsigned int y, unsigned int z) const {
+        return x + (y + z * gridResolution[1]) * gridResolution[0];
     }
 
 private:
@@ -164,20 +353,26 @@ private:
     const T* elementPositions;
     /** number of points of 'elementPositions' */
     unsigned int elementCount;
-    /** array of position-pointers for each cell of the regular element grid */
-    vislib::Array<const T*>* elementGrid;
-    /** bounding box of all positions/points */
-    vislib::math::Cuboid<T> elementBBox;
-    /** origin of 'elementBBox' */
-    Point elementOrigin;
+    /** indices of the points that passed the filter */
+    std::vector<unsigned int> elementIndices;
+    /** cell of every point in 'elementIndices' */
+    std::vector<unsigned int> elementCells;
+    /** first entry of every cell in 'sortedIndices', plus the total count */
+    std::vector<unsigned int> cellStarts;
+    /** indices of the inserted points, sorted by cell */
+    std::vector<unsigned int> sortedIndices;
+    /** positions of the points in the order of 'sortedIndices' */
+    std::vector<T> sortedPositions;
+    /** origin of the grid */
+    T elementOrigin[3];
     /** number of cells in each dimension */
     unsigned int gridResolution[3];
-    /** factors to calculate cell index from a given point (inverse of 'cellSize') */
+    /** factors to calculate cell index from a given point (inverse of the cell size) */
     T gridResolutionFactors[3];
-    /** extends of each a grid cell */
-    T cellSize[3];
     /** short for gridResolution[0]*gridResolution[1]*gridResolution[2] */
     unsigned int gridSize;
+    /** the search distance the grid has been built for */
+    T searchDistance;
 };
 } // namespace protein
 } // namespace megamol
@@ -13,8 +13,10 @@
 #include "protein_calls/MolecularDataCall.h"
 #include "vislib/math/Quaternion.h"
 #include <algorithm>
+#include <cstddef>
 #include <list>
 #include <set>
+#include <utility>
 #include <vector>
 
 namespace megamol {
@@ -302,6 +304,24 @@ public:
         vislib::math::Vector<unsigned int, 3> probeIdx;
     };
 
+    /**
+     * The result of rolling the probe around an RS-edge: the vertex that
+     * forms the next RS-face and the buried-flags to set on the vicinity
+     * atoms, in the order the sequential computation would set them.
+     */
+    struct RSPivot {
+        // the third vertex of the next face (NULL if there is none)
+        RSVertex* Vertex;
+        // the rotation angle of the probe
+        float Angle;
+        // the orientation of the next face
+        float Factor;
+        // the vicinity atoms and their new buried-flag
+        std::vector<std::pair<RSVertex*, bool>> Flags;
+
+        RSPivot(void) : Vertex(NULL), Angle(0.0f), Factor(1.0f) {}
+    };
+
     /**
      * ctor
      * Computes the Reduced Surface(s) for the whole dataset provided by the
@@ -427,6 +447,15 @@ protected:
      */
     void ComputeVicinityEdge(RSEdge* edge);
 
+    /**
+     * Write the indices of all atoms that can be touched by the torus
+     * definded a probe rotating around an edge to 'result'. This does not
+     * modify the reduced surface and can be called concurrently.
+     * @param edge The pointer to the edge.
+     * @param result Receives the vicinity of the edge.
+     */
+    void ComputeVicinityEdge(const RSEdge* edge, std::vector<RSVertex*>& result) const;
+
     /**
      * Write the indices of all atoms within the probe range relative to an
      * RS-vertex.
@@ -447,6 +476,13 @@ protected:
      */
     void WriteProbesCutEdge(RSEdge* edge);
 
+    /**
+     * Compute the positions of all probes which cut a specific RS-edge.
+     * @param edge The pointer to the edge.
+     * @param result Receives the RS-faces which store the probe position.
+     */
+    void ComputeProbesCutEdge(const RSEdge* edge, std::vector<RSFace*>& result) const;
+
     bool SphereSphereIntersection(
         vislib::math::Vector<float, 3> m1, float rad1, vislib::math::Vector<float, 3> m2, float rad2);
 
@@ -479,6 +515,35 @@ protected:
      */
     void ComputeRSFace(unsigned int edgeIdx);
 
+    /**
+     * Compute the next RS-faces for all edges starting at 'firstEdgeIdx',
+     * including the edges created on the way, until the surface is closed.
+     * The pivots of the open edges are computed in parallel; the result is
+     * the same as calling ComputeRSFace for each edge in order.
+     *
+     * @param firstEdgeIdx The index of the first edge.
+     */
+    void ComputeRSFaces(unsigned int firstEdgeIdx);
+
+    /**
+     * Compute the vertex the probe touches first when rolling around the
+     * given edge, which must have one face assigned. This does not modify
+     * the reduced surface and can be called concurrently.
+     *
+     * @param edge The pointer to the edge.
+     * @param pivot Receives the result.
+     * @param vicinity Buffer for the vicinity of the edge.
+     */
+    void PivotRSEdge(RSEdge* edge, RSPivot& pivot, std::vector<RSVertex*>& vicinity) const;
+
+    /**
+     * Add the RS-face found by PivotRSEdge to the reduced surface.
+     *
+     * @param edge The pointer to the edge.
+     * @param pivot The result of PivotRSEdge for the edge.
+     */
+    void CommitRSFace(RSEdge* edge, const RSPivot& pivot);
+
     /**
      * Compute the rotation angle between two probe positions for a given direction
      * of rotation.
@@ -505,6 +570,41 @@ protected:
      */
     void ComputeProbeCutVertex(RSVertex* vertex);
 
+    /**
+     * Search all RS-faces whose probe is cut by the given RS-vertex.
+     * @param vertex The pointer to the RS-vertex.
+     * @param result Receives the cut RS-faces.
+     */
+    void ComputeProbeCutVertex(RSVertex* vertex, std::vector<RSFace*>& result) const;
+
+    /**
+     * Compute the cell of the voxel maps containing the given position.
+     * Positions outside the bounding box are clamped to the border cells.
+     * @param pos The position.
+     * @return The cell index along each axis.
+     */
+    vislib::math::Vector<unsigned int, 3> ComputeVoxelCell(const vislib::math::Vector<float, 3>& pos) const;
+
+    /**
+     * Compute the cells of the voxel maps around the cell containing the
+     * given position (inclusive bounds).
+     * @param pos The position.
+     * @param first Receives the first cell along each axis.
+     * @param last Receives the last cell along each axis.
+     */
+    void ComputeVoxelRange(const vislib::math::Vector<float, 3>& pos, vislib::math::Vector<unsigned int, 3>& first,
+        vislib::math::Vector<unsigned int, 3>& last) const;
+
+    /** Answer the index of a cell in the flattened voxel maps */
+    inline std::size_t VoxelIndex(unsigned int x, unsigned int y, unsigned int z) const {
+        return (static_cast<std::size_t>(x) * this->voxelMapRes.GetY() + y) * this->voxelMapRes.GetZ() + z;
+    }
+
+    /** Answer the index of a cell in the flattened voxel maps */
+    inline std::size_t VoxelIndex(const vislib::math::Vector<unsigned int, 3>& cell) const {
+        return this->VoxelIndex(cell.GetX(), cell.GetY(), cell.GetZ());
+    }
+
 private:
     // The pointer to the protein data interface
     megamol::protein_calls::MolecularDataCall* molecule;
@@ -540,10 +640,12 @@ private:
     // the RS-face list
     std::vector<RSFace*> rsFace;
 
-    // vector for the voxel map for RS-vertex positions
-    std::vector<std::vector<std::vector<std::vector<RSVertex*>>>> voxelMap;
-    // vector for the voxel map for probe positions
-    std::vector<std::vector<std::vector<std::vector<RSFace*>>>> voxelMapProbes;
+    // vector for the voxel map for RS-vertex positions (x-major, see VoxelIndex)
+    std::vector<std::vector<RSVertex*>> voxelMap;
+    // vector for the voxel map for probe positions (x-major, see VoxelIndex)
+    std::vector<std::vector<RSFace*>> voxelMapProbes;
+    // the number of cells of the voxel maps along each axis
+    vislib::math::Vector<unsigned int, 3> voxelMapRes;
     // float voxel length
     float voxelLength;
 
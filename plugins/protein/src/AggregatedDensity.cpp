@@ -1,13 +1,7 @@
-/*
- * AggregatedDensity.cpp
- *
- * Copyright (C) 2011 by Universitaet Stuttgart (VISUS).
- * Alle Rechte vorbehalten.
- */
-
 #include "AggregatedDensity.h"
 #include "geometry_calls/VolumetricDataCall.h"
 #include "mmcore/AbstractGetData3DCall.h"
+#include "mmcore/utility/log/Log.h"
 #include "stdafx.h"
 #include <cfloat>
 #include <climits>
@@ -15,18 +9,110 @@
 #include <float.h>
 #include <iostream>
 #include <math.h>
-#include <omp.h>
 
 #define _USE_MATH_DEFINES 1
+
+
+/**
+ * Partial sums of density and displacement of some frames. The grid is split
+ * into bricks of BRICK_SIZE^3 cells that are only allocated once an atom
+ * touches them, so the partial grids of the tasks stay small if the atoms do
+ * not fill the whole grid.
+ */
+class megamol::protein::AggregatedDensity::Accumulator {
+public:
+    /** The edge length of a brick in cells. */
+    static constexpr unsigned int BRICK_SIZE = 8;
+
+    /** The number of frames after which the sums are added to the result. */
+    static constexpr unsigned int MERGE_FRAMES = 32;
+
+    Accumulator(unsigned int xbins, unsigned int ybins, unsigned int zbins)
+            : xbins(xbins)
+            , ybins(ybins)
+            , zbins(zbins)
+            , bricksX((xbins + BRICK_SIZE - 1) / BRICK_SIZE)
+            , bricksY((ybins + BRICK_SIZE - 1) / BRICK_SIZE)
+            , bricks(static_cast<size_t>(bricksX) * bricksY * ((zbins + BRICK_SIZE - 1) / BRICK_SIZE))
+            , frames(0) {}
+
+    /** Adds 'weight' and the weighted displacement to the cell (x, y, z). */
+    inline void Add(unsigned int x, unsigned int y, unsigned int z, float weight, const float* vel) {
+        const auto b = (x / BRICK_SIZE) + this->bricksX * ((y / BRICK_SIZE) + this->bricksY * (z / BRICK_SIZE));
+        auto& brick = this->bricks[b];
+        if (brick.empty()) {
+            brick.assign(4 * BRICK_SIZE * BRICK_SIZE * BRICK_SIZE, 0.0f);
+            this->allocated.push_back(b);
+        }
+        float* cell =
+            brick.data() + 4 * ((x % BRICK_SIZE) + BRICK_SIZE * ((y % BRICK_SIZE) + BRICK_SIZE * (z % BRICK_SIZE)));
+        cell[0] += weight;
+        cell[1] += weight * vel[0];
+        cell[2] += weight * vel[1];
+        cell[3] += weight * vel[2];
+    }
+
+    /** Adds the sums to the dense grids 'density' and 'velocity' and clears them, keeping the bricks. */
+    void MergeInto(std::vector<double>& density, std::vector<double>& velocity) {
+        const auto bricksXY = static_cast<size_t>(this->bricksX) * this->bricksY;
+        for (auto b : this->allocated) {
+            float* brick = this->bricks[b].data();
+            const unsigned int x0 = static_cast<unsigned int>(b % this->bricksX) * BRICK_SIZE;
+            const unsigned int y0 = static_cast<unsigned int>((b / this->bricksX) % this->bricksY) * BRICK_SIZE;
+            const unsigned int z0 = static_cast<unsigned int>(b / bricksXY) * BRICK_SIZE;
+            for (unsigned int z = z0; z < (std::min)(z0 + BRICK_SIZE, this->zbins); ++z) {
+                for (unsigned int y = y0; y < (std::min)(y0 + BRICK_SIZE, this->ybins); ++y) {
+                    for (unsigned int x = x0; x < (std::min)(x0 + BRICK_SIZE, this->xbins); ++x) {
+                        float* cell = brick + 4 * ((x - x0) + BRICK_SIZE * ((y - y0) + BRICK_SIZE * (z - z0)));
+                        const auto i = x + this->xbins * (y + static_cast<size_t>(this->ybins) * z);
+                        density[i] += cell[0];
+                        velocity[3 * i + 0] += cell[1];
+                        velocity[3 * i + 1] += cell[2];
+                        velocity[3 * i + 2] += cell[3];
+                    }
+                }
+            }
+            std::fill(this->bricks[b].begin(), this->bricks[b].end(), 0.0f);
+        }
+        this->frames = 0;
+    }
+
+    /** Answer the number of frames in the sums. */
+    inline unsigned int Frames(void) const {
+        return this->frames;
+    }
+
+    /** Counts a frame added to the sums. */
+    inline void AddFrame(void) {
+        ++this->frames;
+    }
+
+private:
+    unsigned int xbins, ybins, zbins;
+    unsigned int bricksX, bricksY;
+    std::vector<std::vector<float>> bricks;
+    std::vector<size_t> allocated;
+    unsigned int frames;
+};
+
+
 /*
  * megamol::protein::AggregatedDensity::AggregatedDensity
  */
 megamol::protein::AggregatedDensity::AggregatedDensity(void)
         : getDensitySlot("sendAggregatedDensity", "Sends the aggrated density data")
         , getZvelocitySlot("sendAggregatedZvelocity", "Sends the aggrated velocity data")
-        , is_aggregated(false)
-        , framecounter(0)
-        , molDataCallerSlot("getMolecularData", "Connects the aggregation with molecule data storage") {
+        , molDataCallerSlot("getMolecularData", "Connects the aggregation with molecule data storage")
+        , framesPublished(0)
+        , dataHash(0)
+        , framesMerged(0)
+        , frameCount(0)
+        , atomCount(0)
+        , framesLoaded(0)
+        , framesInFlight(0)
+        , is_started(false)
+        , is_failed(false)
+        , is_aggregated(false) {
 
     this->getDensitySlot.SetCallback("VolumetricDataCall", "getData", &AggregatedDensity::getDensityCallback);
     this->getDensitySlot.SetCallback("VolumetricDataCall", "getExtent", &AggregatedDensity::getExtentCallback);
@@ -57,17 +143,19 @@ megamol::protein::AggregatedDensity::AggregatedDensity(void)
     zbins = static_cast<unsigned int>(ceil(box_z / res));
 
 
-    density = new float[xbins * ybins * zbins];
-    velocity = new float[3 * xbins * ybins * zbins];
-    memset(density, 0, xbins * ybins * zbins * sizeof(float));
-    memset(velocity, 0, 3 * xbins * ybins * zbins * sizeof(float));
+    this->densitySum.assign(static_cast<size_t>(xbins) * ybins * zbins, 0.0);
+    this->velocitySum.assign(3 * this->densitySum.size(), 0.0);
+    this->density.assign(this->densitySum.size(), 0.0f);
+    this->velocity.assign(this->densitySum.size(), 0.0f);
 }
 
 
 /*
  * megamol::protein::AggregatedDensity::~AggregatedDensity
  */
-megamol::protein::AggregatedDensity::~AggregatedDensity(void) {}
+megamol::protein::AggregatedDensity::~AggregatedDensity(void) {
+    this->Release();
+}
 
 
 /*
@@ -82,7 +170,7 @@ bool megamol::protein::AggregatedDensity::create(void) {
  * megamol::protein::AggregatedDensity::release
  */
 void megamol::protein::AggregatedDensity::release(void) {
-    ARY_SAFE_DELETE(this->vol);
+    this->stopAggregation();
 }
 
 
@@ -90,207 +178,316 @@ void megamol::protein::AggregatedDensity::release(void) {
  * megamol::protein::AggregatedDensity::getDataCallback
  */
 bool megamol::protein::AggregatedDensity::getDensityCallback(megamol::core::Call& caller) {
-    geocalls::VolumetricDataCall* cvd = dynamic_cast<geocalls::VolumetricDataCall*>(&caller);
-    if (cvd == NULL)
-        return false;
-
-    if (!this->is_aggregated)
-        if (!this->aggregate())
-            return false;
-    //#pragma omp parallel for
-    cvd->SetDataHash(1);
-    cvd->SetFrameID(0);
-    auto metadata = std::make_shared<geocalls::VolumetricDataCall::Metadata>();
-    metadata->Resolution[0] = xbins;
-    metadata->Resolution[1] = ybins;
-    metadata->Resolution[2] = zbins;
-    metadata->ScalarType = geocalls::VolumetricDataCall::ScalarType::FLOATING_POINT;
-    cvd->SetMetadata(metadata.get());
-    cvd->SetData(this->density);
-
-    return true;
+    return this->getVolumeCallback(caller, this->density, this->densityMetadata);
 }
 
 /*
  * megamol::protein::AggregatedDensity::getDataCallback
  */
 bool megamol::protein::AggregatedDensity::getZvelocityCallback(megamol::core::Call& caller) {
+    return this->getVolumeCallback(caller, this->velocity, this->velocityMetadata);
+}
+
+/*
+ * megamol::protein::AggregatedDensity::getExtentCallback
+ */
+bool megamol::protein::AggregatedDensity::getExtentCallback(megamol::core::Call& caller) {
     geocalls::VolumetricDataCall* cvd = dynamic_cast<geocalls::VolumetricDataCall*>(&caller);
     if (cvd == NULL)
         return false;
 
-    if (!this->is_aggregated)
-        if (!this->aggregate())
-            return false;
-    //#pragma omp parallel for
+    this->publishResult();
 
-    cvd->SetDataHash(1);
-    cvd->SetFrameID(0);
-    auto metadata = std::make_shared<geocalls::VolumetricDataCall::Metadata>();
-    metadata->Resolution[0] = xbins;
-    metadata->Resolution[1] = ybins;
-    metadata->Resolution[2] = zbins;
-    metadata->ScalarType = geocalls::VolumetricDataCall::ScalarType::FLOATING_POINT;
-    cvd->SetMetadata(metadata.get());
-    cvd->SetData(this->velocity);
+    cvd->AccessBoundingBoxes().Clear();
+    cvd->AccessBoundingBoxes().SetObjectSpaceBBox(
+        origin_x, origin_y, origin_z, origin_x + box_x, origin_y + box_y, origin_z + box_z);
+    cvd->SetDataHash(this->dataHash);
+    cvd->SetFrameCount(1);
 
     return true;
 }
 
 /*
- * megamol::protein::AggregatedDensity::getExtentCallback
+ * megamol::protein::AggregatedDensity::getVolumeCallback
  */
-bool megamol::protein::AggregatedDensity::getExtentCallback(megamol::core::Call& caller) {
+bool megamol::protein::AggregatedDensity::getVolumeCallback(
+    megamol::core::Call& caller, std::vector<float>& data, geocalls::VolumetricMetadataStore& metadata) {
     geocalls::VolumetricDataCall* cvd = dynamic_cast<geocalls::VolumetricDataCall*>(&caller);
     if (cvd == NULL)
         return false;
 
-    cvd->AccessBoundingBoxes().Clear();
-    cvd->AccessBoundingBoxes().SetObjectSpaceBBox(
-        origin_x, origin_y, origin_z, origin_x + box_x, origin_y + box_y, origin_z + box_z);
-    cvd->SetDataHash(1);
-    cvd->SetFrameCount(1);
+    this->continueAggregation();
+    this->publishResult();
+
+    cvd->SetDataHash(this->dataHash);
+    cvd->SetFrameID(0);
+    cvd->SetMetadata(&metadata);
+    cvd->SetData(data.data());
 
     return true;
 }
 
-bool megamol::protein::AggregatedDensity::aggregate() {
+/*
+ * megamol::protein::AggregatedDensity::continueAggregation
+ */
+void megamol::protein::AggregatedDensity::continueAggregation(void) {
+    using megamol::core::utility::log::Log;
+    if (this->is_aggregated) {
+        return;
+    }
     megamol::protein_calls::MolecularDataCall* mol =
         this->molDataCallerSlot.CallAs<megamol::protein_calls::MolecularDataCall>();
     if (!mol) {
-        return false;
+        return;
     }
 
-    // set call time
-    mol->SetCalltime(0);
-    // set frame ID and call data
-    mol->SetFrameID(0);
+    if (!this->is_started) {
+        // set call time
+        mol->SetCalltime(0);
+        // set frame ID and call data
+        mol->SetFrameID(0, true);
 
-    if (!(*mol)(megamol::protein_calls::MolecularDataCall::CallForGetData))
-        return false;
+        if (!(*mol)(megamol::protein_calls::MolecularDataCall::CallForGetData)) {
+            Log::DefaultLog.WriteError("AggregatedDensity: aggregating the trajectory failed.");
+            this->is_aggregated = true;
+            return;
+        }
 
-    // this number must remain constant!
-    unsigned int n_atoms = mol->AtomCount();
+        // this number must remain constant!
+        this->atomCount = mol->AtomCount();
+        this->frameCount = mol->FrameCount();
+        this->previousPositions.assign(mol->AtomPositions(), mol->AtomPositions() + 3 * this->atomCount);
+        mol->Unlock();
 
-    float* pos0 = new float[mol->AtomCount() * 3];
-    float* vel = new float[mol->AtomCount() * 3];
-    memcpy(pos0, mol->AtomPositions(), mol->AtomCount() * 3 * sizeof(float));
+        this->cancellation = core::utility::CancellationSource();
+        this->framesLoaded = 0;
+        this->is_started = true;
+    }
 
-    for (unsigned int frame = 0; frame < mol->FrameCount(); frame++) {
-        mol->SetFrameID(frame);
-        if (!(*mol)(megamol::protein_calls::MolecularDataCall::CallForGetData))
-            return false;
-        if (mol->AtomCount() != n_atoms) {
-            delete[] pos0, vel;
-            return false;
+    /** Takes a frame out of the flight when its task ends, even if binning it failed. */
+    struct FrameBinned {
+        AggregatedDensity& owner;
+        ~FrameBinned() {
+            // the next request loads the following frames or finishes the aggregation
+            if (--this->owner.framesInFlight == 0) {
+                this->owner.NotifyOutputChanged();
+            }
+        }
+    };
+
+    /*
+     * The frames are loaded here, on the thread calling the module, and the
+     * tasks only get copies of the positions. The number of frames in flight
+     * is limited, so a request does not block for the whole trajectory.
+     */
+    const unsigned int maxInFlight = 2 * (core::utility::TaskScheduler::Instance().WorkerCount() + 1);
+    const unsigned int n_atoms = this->atomCount;
+    const auto token = this->cancellation.Token();
+    while ((this->framesLoaded < this->frameCount) && (this->framesInFlight < maxInFlight) && !this->is_failed) {
+        const unsigned int frame = this->framesLoaded;
+        mol->SetFrameID(frame, true);
+        if (!(*mol)(megamol::protein_calls::MolecularDataCall::CallForGetData) || (mol->AtomCount() != n_atoms)) {
+            Log::DefaultLog.WriteError("AggregatedDensity: frame %u could not be loaded.", frame);
+            mol->Unlock();
+            this->is_failed = true;
+            break;
         }
-        const float* pos_new = mol->AtomPositions();
 
-        for (unsigned int i = 0; i < 3 * n_atoms; i++) {
-            vel[i] = pos_new[i] - pos0[i];
+        // positions followed by the displacements since the previous frame
+        auto buffer = std::make_shared<std::vector<float>>(6 * static_cast<size_t>(n_atoms));
+        const float* pos_new = mol->AtomPositions();
+        for (size_t i = 0; i < 3 * static_cast<size_t>(n_atoms); i++) {
+            (*buffer)[i] = pos_new[i];
+            (*buffer)[3 * n_atoms + i] = pos_new[i] - this->previousPositions[i];
+        }
+        mol->Unlock();
+        std::copy(buffer->begin(), buffer->begin() + 3 * n_atoms, this->previousPositions.begin());
+
+        ++this->framesLoaded;
+        ++this->framesInFlight;
+        this->binning.Run([this, buffer, n_atoms, token]() {
+            FrameBinned binned{*this};
+            if (!token.IsCancelled()) {
+                auto acc = this->acquireAccumulator();
+                this->aggregate_frame(buffer->data(), buffer->data() + 3 * n_atoms, n_atoms, *acc);
+                acc->AddFrame();
+                this->releaseAccumulator(std::move(acc), false);
+            }
+        });
+
+        if (this->framesLoaded % 1000 == 0) {
+            Log::DefaultLog.WriteInfo(
+                "AggregatedDensity: loaded %u of %u frames.", this->framesLoaded, this->frameCount);
         }
-        memcpy(pos0, mol->AtomPositions(), mol->AtomCount() * 3 * sizeof(float));
-        this->aggregate_frame(pos0, vel, n_atoms);
-        framecounter++;
     }
 
-    delete[] pos0, vel;
-    is_aggregated = true;
-    float maxdensity = 0;
-    float minvelocity = FLT_MAX;
-    float maxvelocity = FLT_MIN;
-    for (unsigned int i = 0; i < xbins * ybins * zbins; i++) {
-        density[i] *= 1.0f / framecounter / res / res / res * 1000.0f;
-        if (density[i] > 0) {
-            velocity[i] *= 1.0f / density[i] / framecounter;
-        } else {
-            velocity[i] = 0;
-        }
-        maxdensity = vislib::math::Max(density[i], maxdensity);
-        maxvelocity = vislib::math::Max(velocity[i], maxvelocity);
-        minvelocity = vislib::math::Min(velocity[i], minvelocity);
+    if ((this->is_failed || (this->framesLoaded == this->frameCount)) && (this->framesInFlight == 0)) {
+        this->finishAggregation();
     }
-    std::cout << "The max is " << maxdensity << std::endl;
-    std::cout << "The max vel is " << maxvelocity << std::endl;
-    std::cout << "The min vel is " << minvelocity << std::endl;
-    return true;
 }
 
-bool megamol::protein::AggregatedDensity::aggregate_frame(float* pos, float* vel, unsigned int n_atoms) {
+/*
+ * megamol::protein::AggregatedDensity::finishAggregation
+ */
+void megamol::protein::AggregatedDensity::finishAggregation(void) {
+    using megamol::core::utility::log::Log;
+    bool success = !this->is_failed;
+    try {
+        this->binning.Wait();
+    } catch (...) {
+        Log::DefaultLog.WriteError("AggregatedDensity: a frame could not be binned.");
+        success = false;
+    }
+
+    // add the frames still held by the accumulators
+    std::vector<std::unique_ptr<Accumulator>> accumulators;
+    {
+        std::lock_guard<std::mutex> lock(this->accumulatorLock);
+        accumulators.swap(this->idleAccumulators);
+    }
+    for (auto& acc : accumulators) {
+        this->releaseAccumulator(std::move(acc), true);
+    }
+
+    if (success) {
+        Log::DefaultLog.WriteInfo("AggregatedDensity: aggregated %u frames.", this->frameCount);
+    } else {
+        Log::DefaultLog.WriteError("AggregatedDensity: aggregating the trajectory failed.");
+    }
+    this->is_aggregated = true;
+}
+
+/*
+ * megamol::protein::AggregatedDensity::stopAggregation
+ */
+void megamol::protein::AggregatedDensity::stopAggregation(void) {
+    this->cancellation.Cancel();
+    try {
+        this->binning.Wait();
+    } catch (...) {
+        // the aggregation is abandoned anyway
+    }
+}
+
+void megamol::protein::AggregatedDensity::aggregate_frame(
+    const float* pos, const float* vel, unsigned int n_atoms, Accumulator& acc) const {
     float x, y, z, dx, dy, dz;
-    unsigned int X, Y, Z;
-    float weight;
-    unsigned int linear_index;
-    for (unsigned int i = 0; i < 3 * n_atoms; i++) {
+    int X, Y, Z;
+    for (unsigned int i = 0; i < n_atoms; i++) {
         x = (pos[3 * i + 0] - origin_x) / res; // in lattice constants
-        X = static_cast<unsigned int>(floor(x));
+        X = static_cast<int>(floor(x));
         dx = x - X;
         y = (pos[3 * i + 1] - origin_y) / res; // in lattice constants
-        Y = static_cast<unsigned int>(floor(y));
+        Y = static_cast<int>(floor(y));
         dy = y - Y;
         z = (pos[3 * i + 2] - origin_z) / res; // in lattice constants
-        Z = static_cast<unsigned int>(floor(z));
+        Z = static_cast<int>(floor(z));
         dz = z - Z;
 
-        if (X > 0 && X < xbins - 1 && Y > 0 && Y < ybins - 1 && Z > 0 && Z < zbins - 1) {
-            //weight=1;
-            //density[X+xbins*Y+xbins*ybins*Z]+=weight;
-            weight = (1 - dx) * (1 - dy) * (1 - dz);
-            linear_index = (X + 0) + (Y + 0) * xbins + (Z + 0) * xbins * ybins;
-            density[linear_index] += weight;
-            velocity[3 * linear_index + 0] += weight * vel[3 * i + 0];
-            velocity[3 * linear_index + 1] += weight * vel[3 * i + 1];
-            velocity[3 * linear_index + 2] += weight * vel[3 * i + 2];
-
-            weight = (1 - dx) * (1 - dy) * (dz);
-            linear_index = (X + 0) + (Y + 0) * xbins + (Z + 1) * xbins * ybins;
-            density[linear_index] += weight;
-            velocity[3 * linear_index + 0] += weight * vel[3 * i + 0];
-            velocity[3 * linear_index + 1] += weight * vel[3 * i + 1];
-            velocity[3 * linear_index + 2] += weight * vel[3 * i + 2];
-
-            weight = (1 - dx) * (dy) * (1 - dz);
-            linear_index = (X + 0) + (Y + 1) * xbins + (Z + 0) * xbins * ybins;
-            density[linear_index] += weight;
-            velocity[3 * linear_index + 0] += weight * vel[3 * i + 0];
-            velocity[3 * linear_index + 1] += weight * vel[3 * i + 1];
-            velocity[3 * linear_index + 2] += weight * vel[3 * i + 2];
-
-            weight = (1 - dx) * (dy) * (dz);
-            linear_index = (X + 0) + (Y + 1) * xbins + (Z + 1) * xbins * ybins;
-            density[linear_index] += weight;
-            velocity[3 * linear_index + 0] += weight * vel[3 * i + 0];
-            velocity[3 * linear_index + 1] += weight * vel[3 * i + 1];
-            velocity[3 * linear_index + 2] += weight * vel[3 * i + 2];
-
-            weight = (dx) * (1 - dy) * (1 - dz);
-            linear_index = (X + 1) + (Y + 0) * xbins + (Z + 0) * xbins * ybins;
-            density[linear_index] += weight;
-            velocity[3 * linear_index + 0] += weight * vel[3 * i + 0];
-            velocity[3 * linear_index + 1] += weight * vel[3 * i + 1];
-            velocity[3 * linear_index + 2] += weight * vel[3 * i + 2];
-
-            weight = (dx) * (1 - dy) * (dz);
-            linear_index = (X + 1) + (Y + 0) * xbins + (Z + 1) * xbins * ybins;
-            density[linear_index] += weight;
-            velocity[3 * linear_index + 0] += weight * vel[3 * i + 0];
-            velocity[3 * linear_index + 1] += weight * vel[3 * i + 1];
-            velocity[3 * linear_index + 2] += weight * vel[3 * i + 2];
-
-            weight = (dx) * (dy) * (1 - dz);
-            linear_index = (X + 1) + (Y + 1) * xbins + (Z + 0) * xbins * ybins;
-            density[linear_index] += weight;
-            velocity[3 * linear_index + 0] += weight * vel[3 * i + 0];
-            velocity[3 * linear_index + 1] += weight * vel[3 * i + 1];
-            velocity[3 * linear_index + 2] += weight * vel[3 * i + 2];
-
-            weight = (dx) * (dy) * (dz);
-            linear_index = (X + 1) + (Y + 1) * xbins + (Z + 1) * xbins * ybins;
-            density[linear_index] += weight;
-            velocity[3 * linear_index + 0] += weight * vel[3 * i + 0];
-            velocity[3 * linear_index + 1] += weight * vel[3 * i + 1];
-            velocity[3 * linear_index + 2] += weight * vel[3 * i + 2];
+        if (X >= 0 && X < static_cast<int>(xbins) - 1 && Y >= 0 && Y < static_cast<int>(ybins) - 1 && Z >= 0 &&
+            Z < static_cast<int>(zbins) - 1) {
+            const float* v = vel + 3 * i;
+            acc.Add(X + 0, Y + 0, Z + 0, (1 - dx) * (1 - dy) * (1 - dz), v);
+            acc.Add(X + 0, Y + 0, Z + 1, (1 - dx) * (1 - dy) * (dz), v);
+            acc.Add(X + 0, Y + 1, Z + 0, (1 - dx) * (dy) * (1 - dz), v);
+            acc.Add(X + 0, Y + 1, Z + 1, (1 - dx) * (dy) * (dz), v);
+            acc.Add(X + 1, Y + 0, Z + 0, (dx) * (1 - dy) * (1 - dz), v);
+            acc.Add(X + 1, Y + 0, Z + 1, (dx) * (1 - dy) * (dz), v);
+            acc.Add(X + 1, Y + 1, Z + 0, (dx) * (dy) * (1 - dz), v);
+            acc.Add(X + 1, Y + 1, Z + 1, (dx) * (dy) * (dz), v);
         }
     }
-    return true;
+}
+
+/*
+ * megamol::protein::AggregatedDensity::acquireAccumulator
+ */
+std::unique_ptr<megamol::protein::AggregatedDensity::Accumulator>
+megamol::protein::AggregatedDensity::acquireAccumulator(void) {
+    std::lock_guard<std::mutex> lock(this->accumulatorLock);
+    if (this->idleAccumulators.empty()) {
+        return std::make_unique<Accumulator>(this->xbins, this->ybins, this->zbins);
+    }
+    std::unique_ptr<Accumulator> acc = std::move(this->idleAccumulators.back());
+    this->idleAccumulators.pop_back();
+    return acc;
+}
+
+/*
+ * megamol::protein::AggregatedDensity::releaseAccumulator
+ */
+void megamol::protein::AggregatedDensity::releaseAccumulator(std::unique_ptr<Accumulator> acc, bool flush) {
+    if ((acc->Frames() >= Accumulator::MERGE_FRAMES) || (flush && (acc->Frames() > 0))) {
+        this->mergeAccumulator(*acc);
+    }
+    std::lock_guard<std::mutex> lock(this->accumulatorLock);
+    this->idleAccumulators.push_back(std::move(acc));
+}
+
+/*
+ * megamol::protein::AggregatedDensity::mergeAccumulator
+ */
+void megamol::protein::AggregatedDensity::mergeAccumulator(Accumulator& acc) {
+    {
+        std::lock_guard<std::mutex> lock(this->resultLock);
+        this->framesMerged += acc.Frames();
+        acc.MergeInto(this->densitySum, this->velocitySum);
+    }
+    // the next request publishes the refined result
+    this->NotifyOutputChanged();
+}
+
+/*
+ * megamol::protein::AggregatedDensity::publishResult
+ */
+void megamol::protein::AggregatedDensity::publishResult(void) {
+    {
+        std::lock_guard<std::mutex> lock(this->resultLock);
+        if (this->framesMerged == this->framesPublished) {
+            return;
+        }
+        this->framesPublished = this->framesMerged;
+
+        const double scale = 1.0 / this->framesPublished / res / res / res * 1000.0;
+        for (size_t i = 0; i < this->densitySum.size(); i++) {
+            this->density[i] = static_cast<float>(this->densitySum[i] * scale);
+            this->velocity[i] =
+                (this->densitySum[i] > 0.0) ? static_cast<float>(this->velocitySum[3 * i + 2] / this->densitySum[i])
+                                            : 0.0f;
+        }
+    }
+    ++this->dataHash;
+
+    float sliceDists[3] = {res, res, res};
+    double minValue = 0.0, maxValue = 0.0;
+    geocalls::VolumetricMetadata_t metadata;
+    metadata.GridType = geocalls::CARTESIAN;
+    metadata.Resolution[0] = xbins;
+    metadata.Resolution[1] = ybins;
+    metadata.Resolution[2] = zbins;
+    metadata.ScalarType = geocalls::FLOATING_POINT;
+    metadata.ScalarLength = sizeof(float);
+    metadata.Components = 1;
+    metadata.NumberOfFrames = 1;
+    metadata.Origin[0] = origin_x;
+    metadata.Origin[1] = origin_y;
+    metadata.Origin[2] = origin_z;
+    metadata.Extents[0] = box_x;
+    metadata.Extents[1] = box_y;
+    metadata.Extents[2] = box_z;
+    for (int i = 0; i < 3; i++) {
+        metadata.SliceDists[i] = sliceDists + i;
+        metadata.IsUniform[i] = true;
+    }
+    metadata.MinValues = &minValue;
+    metadata.MaxValues = &maxValue;
+
+    this->densityMetadata = metadata;
+    this->densityMetadata.UpdateStatistics(this->density.data(), this->dataHash, 0);
+    this->velocityMetadata = metadata;
+    this->velocityMetadata.UpdateStatistics(this->velocity.data(), this->dataHash, 0);
+
+    megamol::core::utility::log::Log::DefaultLog.WriteInfo(
+        "AggregatedDensity: published %u frames, maximum density %f, z-velocity in [%f, %f].", this->framesPublished,
+        this->densityMetadata.MaxValues[0], this->velocityMetadata.MinValues[0], this->velocityMetadata.MaxValues[0]);
 }
@@ -1,5 +1,5 @@
 /*
- * BSpline.h
+ * AggregatedDensity.h
  *
  * Copyright (C) 2008 by Universitaet Stuttgart (VIS).
  * Alle Rechte vorbehalten.
@@ -11,9 +11,16 @@
 #pragma once
 #endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "geometry_calls/VolumetricMetadataStore.h"
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/CallerSlot.h"
 #include "mmcore/Module.h"
+#include "mmcore/utility/TaskScheduler.h"
 #include "protein_calls/MolecularDataCall.h"
 
 namespace megamol {
@@ -21,7 +28,15 @@ namespace protein {
 
 
 /**
- * Class generation buck ball informations
+ * Aggregates the density and the mean z-velocity of the atoms over all frames
+ * of a trajectory.
+ *
+ * The aggregation streams the frames: every data request loads a few more
+ * frames on the calling thread, while tasks bin the frames already loaded
+ * into bricked partial grids, which are added to the result every few
+ * frames. Whenever sums are added or the tasks run out of frames, the module
+ * signals an output change, so the next request publishes the frames
+ * aggregated so far and loads the following ones.
  */
 class AggregatedDensity : public megamol::core::Module {
 public:
@@ -59,9 +74,6 @@ public:
     virtual ~AggregatedDensity(void);
 
 protected:
-    bool aggregate();
-    bool aggregate_frame(float* pos, float* vel, unsigned int n_atoms);
-
     /**
      * Implementation of 'Create'.
      *
@@ -93,6 +105,52 @@ private:
      */
     bool getExtentCallback(megamol::core::Call& caller);
 
+    /** Partial sums of a part of the frames. */
+    class Accumulator;
+
+    /**
+     * Starts the aggregation unless it has been started before, loads the
+     * next frames from the data source and hands them to the binning tasks.
+     * Finishes the aggregation once all frames have been binned.
+     */
+    void continueAggregation(void);
+
+    /** Waits for the binning tasks and adds the frames still held by the accumulators to the result. */
+    void finishAggregation(void);
+
+    /** Cancels a running aggregation and waits for it. */
+    void stopAggregation(void);
+
+    /**
+     * Bins the atoms of a frame into 'acc'.
+     *
+     * @param pos     The positions of the atoms.
+     * @param vel     The displacements of the atoms since the previous frame.
+     * @param n_atoms The number of atoms.
+     * @param acc     The partial sums to add to.
+     */
+    void aggregate_frame(const float* pos, const float* vel, unsigned int n_atoms, Accumulator& acc) const;
+
+    /** Answer an idle accumulator, accumulators are kept to reuse their bricks. */
+    std::unique_ptr<Accumulator> acquireAccumulator(void);
+
+    /** Returns an accumulator to the idle ones, adding its sums to the result if it holds enough frames. */
+    void releaseAccumulator(std::unique_ptr<Accumulator> acc, bool flush);
+
+    /** Adds the sums of 'acc' to the result and clears them. */
+    void mergeAccumulator(Accumulator& acc);
+
+    /** Normalises the frames merged so far into the published volumes. */
+    void publishResult(void);
+
+    /**
+     * Sets the data of a volume published by this module.
+     *
+     * @return 'true' on success, 'false' on failure.
+     */
+    bool getVolumeCallback(megamol::core::Call& caller, std::vector<float>& data,
+        geocalls::VolumetricMetadataStore& metadata);
+
     /** The slot for requesting data */
     megamol::core::CalleeSlot getDensitySlot;
 
@@ -103,12 +161,6 @@ private:
     /** MolecularDataCall caller slot */
     megamol::core::CallerSlot molDataCallerSlot;
 
-    /** The distance volume resolution */
-    unsigned int volRes;
-
-    /** The distance volume */
-    float* vol;
-
     std::vector<std::string> xtcfilenames;
     std::string pdbfilename;
     float origin_x;
@@ -118,13 +170,74 @@ private:
     float box_y;
     float box_z;
     float res;
-    float* density;
-    float* velocity;
     unsigned int xbins;
     unsigned int ybins;
     unsigned int zbins;
+
+    /** The published density */
+    std::vector<float> density;
+
+    /** The published mean z-velocity */
+    std::vector<float> velocity;
+
+    /** The metadata of 'density' */
+    geocalls::VolumetricMetadataStore densityMetadata;
+
+    /** The metadata of 'velocity' */
+    geocalls::VolumetricMetadataStore velocityMetadata;
+
+    /** The number of frames in 'density' and 'velocity' */
+    unsigned int framesPublished;
+
+    /** The hash of the published volumes, changed whenever more frames are published */
+    SIZE_T dataHash;
+
+    /** The sums of the weights of all frames merged so far */
+    std::vector<double> densitySum;
+
+    /** The sums of the weighted displacements of all frames merged so far */
+    std::vector<double> velocitySum;
+
+    /** The number of frames in 'densitySum' and 'velocitySum' */
+    unsigned int framesMerged;
+
+    /** Guards the sums and 'framesMerged' */
+    std::mutex resultLock;
+
+    /** Accumulators not used by a task at the moment */
+    std::vector<std::unique_ptr<Accumulator>> idleAccumulators;
+
+    std::mutex accumulatorLock;
+
+    /** Cancels the aggregation */
+    core::utility::CancellationSource cancellation;
+
+    /** The tasks binning the loaded frames */
+    core::utility::TaskGroup binning;
+
+    /** The number of frames of the trajectory */
+    unsigned int frameCount;
+
+    /** The number of atoms, which must be the same in all frames */
+    unsigned int atomCount;
+
+    /** The number of frames loaded and handed to the binning tasks */
+    unsigned int framesLoaded;
+
+    /** The number of loaded frames not binned yet */
+    std::atomic<unsigned int> framesInFlight;
+
+    /** The positions of the last loaded frame */
+    std::vector<float> previousPositions;
+
+    /** Whether the aggregation has been started */
+    bool is_started;
+
+    /** Whether a frame could not be loaded */
+    bool is_failed;
+
+    /** Whether the aggregation has finished, successfully or not */
     bool is_aggregated;
-    unsigned int framecounter;
 };
 
 
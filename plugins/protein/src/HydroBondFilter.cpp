@@ -6,7 +6,6 @@
  */
 
 #include "HydroBondFilter.h"
-#include "protein/GridNeighbourFinder.h"
 #include "stdafx.h"
 
 #include "protein_calls/MolecularDataCall.h"
@@ -15,8 +14,11 @@
 #include "mmcore/param/FloatParam.h"
 #include "mmcore/param/IntParam.h"
 
+#include "mmcore/utility/TaskScheduler.h"
 #include "mmcore/utility/log/Log.h"
-#include "vislib/math/ShallowVector.h"
+
+#include <algorithm>
+#include <climits>
 
 using namespace megamol;
 using namespace megamol::core;
@@ -142,6 +144,18 @@ void HydroBondFilter::fillSecStructVector(MolecularDataCall& mdc) {
             }
         }
     }
+
+    // number the runs of consecutive helix atoms, so that filterHBonds can check in constant time whether two atoms
+    // belong to the same helix
+    this->helixRunPerAtom.assign(mdc.AtomCount(), UINT_MAX);
+    unsigned int helixRun = 0;
+    for (unsigned int atomIdx = 0; atomIdx < mdc.AtomCount(); atomIdx++) {
+        if (this->secStructPerAtom[atomIdx] == MolecularDataCall::SecStructure::ElementType::TYPE_HELIX) {
+            this->helixRunPerAtom[atomIdx] = helixRun;
+        } else if ((atomIdx > 0) && (this->helixRunPerAtom[atomIdx - 1] != UINT_MAX)) {
+            helixRun++;
+        }
+    }
 }
 
 /*
@@ -223,19 +237,20 @@ bool HydroBondFilter::getExtent(Call& call) {
 /*
  * HydroBondFilter::isValidHBond
  */
-bool HydroBondFilter::isValidHBond(unsigned int donorIndex, unsigned int acceptorIndex, MolecularDataCall& mdc) {
+bool HydroBondFilter::isValidHBond(
+    unsigned int donorIndex, unsigned int acceptorIndex, const float* atomPositions, float maxDistance) const {
 
     if (donorIndex == acceptorIndex)
         return false;
 
-    // shallow vectors do not work because of constness
-    vislib::math::Vector<float, 3> donorPos = vislib::math::Vector<float, 3>(&mdc.AtomPositions()[donorIndex * 3]);
-    vislib::math::Vector<float, 3> acceptorPos =
-        vislib::math::Vector<float, 3>(&mdc.AtomPositions()[acceptorIndex * 3]);
-    vislib::math::Vector<float, 3> DToA(acceptorPos - donorPos);
+    const float* donorPos = &atomPositions[donorIndex * 3];
+    const float* acceptorPos = &atomPositions[acceptorIndex * 3];
+    const float x = acceptorPos[0] - donorPos[0];
+    const float y = acceptorPos[1] - donorPos[1];
+    const float z = acceptorPos[2] - donorPos[2];
 
     // the distance between acceptor and donator has to be below a threshold
-    return DToA.Length() <= this->hBondDonorAcceptorDistance.Param<param::FloatParam>()->Value();
+    return x * x + y * y + z * z <= maxDistance * maxDistance;
 }
 
 /*
@@ -243,67 +258,60 @@ bool HydroBondFilter::isValidHBond(unsigned int donorIndex, unsigned int accepto
  */
 void HydroBondFilter::filterHBonds(MolecularDataCall& mdc) {
 
-    std::vector<bool> copyVector(mdc.HydrogenBondCount(), false);
-    unsigned int copyCount = 0;
+    // one byte per bond, as the bonds are classified in parallel
+    std::vector<unsigned char> copyVector(mdc.HydrogenBondCount(), 0);
 
     bool copyAlpha = this->alphaHelixHBonds.Param<param::BoolParam>()->Value();
     bool copyBeta = this->betaSheetHBonds.Param<param::BoolParam>()->Value();
     bool copyOther = this->otherHBonds.Param<param::BoolParam>()->Value();
     bool fake = this->cAlphaHBonds.Param<param::BoolParam>()->Value();
+    float maxDistance = this->hBondDonorAcceptorDistance.Param<param::FloatParam>()->Value();
 
     // determine which H-Bonds have to be copied
-    for (unsigned int i = 0; i < mdc.HydrogenBondCount(); i++) {
-        unsigned int donorIdx = mdc.GetHydrogenBonds()[i * 2 + 0];
-        unsigned int acceptorIdx = mdc.GetHydrogenBonds()[i * 2 + 1];
-
-        auto secStructDonor = this->secStructPerAtom[donorIdx];
-        auto secStructAcceptor = this->secStructPerAtom[acceptorIdx];
-
-        bool copy = false;
-
-        if (secStructDonor == secStructAcceptor) { // inside of a secondary structure element
-            if (secStructDonor == MolecularDataCall::SecStructure::ElementType::TYPE_SHEET) {
-                // beta sheets are always copied, if allowed
-                copy = copyBeta;
-            } else if (secStructDonor == MolecularDataCall::SecStructure::ElementType::TYPE_HELIX) {
-                // alpha sheets are only copied if it is the same alpha sheet
-                unsigned int min = std::min(donorIdx, acceptorIdx);
-                unsigned int max = std::max(donorIdx, acceptorIdx);
-
-                bool isSame = true;
-                for (unsigned int j = min; j <= max; j++) {
-                    if (this->secStructPerAtom[j] != MolecularDataCall::SecStructure::ElementType::TYPE_HELIX) {
-                        // not the same if there happens a change in secondary structure between the two atoms
-                        isSame = false;
-                        break;
+    core::utility::ParallelFor<unsigned int>(
+        0, mdc.HydrogenBondCount(), 0, [&](unsigned int begin, unsigned int end) {
+            for (unsigned int i = begin; i < end; i++) {
+                unsigned int donorIdx = mdc.GetHydrogenBonds()[i * 2 + 0];
+                unsigned int acceptorIdx = mdc.GetHydrogenBonds()[i * 2 + 1];
+
+                auto secStructDonor = this->secStructPerAtom[donorIdx];
+                auto secStructAcceptor = this->secStructPerAtom[acceptorIdx];
+
+                bool copy = false;
+
+                if (secStructDonor == secStructAcceptor) { // inside of a secondary structure element
+                    if (secStructDonor == MolecularDataCall::SecStructure::ElementType::TYPE_SHEET) {
+                        // beta sheets are always copied, if allowed
+                        copy = copyBeta;
+                    } else if (secStructDonor == MolecularDataCall::SecStructure::ElementType::TYPE_HELIX) {
+                        // alpha sheets are only copied if it is the same alpha sheet, i.e. if there is no change in
+                        // secondary structure between the two atoms
+                        bool isSame = (this->helixRunPerAtom[donorIdx] == this->helixRunPerAtom[acceptorIdx]);
+
+                        if (copyAlpha && isSame) {
+                            copy = true;
+                        }
+                        if (copyOther && !isSame) {
+                            copy = true;
+                        }
+                    } else {
+                        copy = copyOther;
                     }
-                }
 
-                if (copyAlpha && isSame) {
-                    copy = true;
-                }
-                if (copyOther && !isSame) {
-                    copy = true;
+                } else { // random coil or between different elements
+                    copy = copyOther;
                 }
-            } else {
-                copy = copyOther;
-            }
 
-        } else { // random coil or between different elements
-            copy = copyOther;
-        }
-
-        if (!isValidHBond(donorIdx, acceptorIdx, mdc)) {
-            copy = false;
-        }
+                if (!isValidHBond(donorIdx, acceptorIdx, mdc.AtomPositions(), maxDistance)) {
+                    copy = false;
+                }
 
-        copyVector[i] = copy;
-        if (copy) {
-            copyCount++;
-        }
-    }
+                copyVector[i] = copy ? 1 : 0;
+            }
+        });
+    unsigned int copyCount = static_cast<unsigned int>(std::count(copyVector.begin(), copyVector.end(), 1));
 
-    this->hBondStatistics.resize(mdc.AtomCount(), 0);
+    this->hBondStatistics.assign(mdc.AtomCount(), 0);
     this->hydrogenBondsFiltered.resize(copyCount * 2, 0);
 
     // copy the H-Bond statistics and hydrogen bonds
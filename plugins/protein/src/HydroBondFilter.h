@@ -156,9 +156,11 @@ private:
      *
      * @param donorIndex The index of the donor of the hydrogen bond.
      * @param accptorIndex The index of the acceptor of the hydrogen bond.
-     * @param mdc The MolecularDataCall containing the data.
+     * @param atomPositions The positions of all atoms.
+     * @param maxDistance The maximal distance between donor and acceptor.
      */
-    bool isValidHBond(unsigned int donorIndex, unsigned int acceptorIndex, protein_calls::MolecularDataCall& mdc);
+    bool isValidHBond(
+        unsigned int donorIndex, unsigned int acceptorIndex, const float* atomPositions, float maxDistance) const;
 
     /** caller slot */
     core::CallerSlot inDataSlot;
@@ -198,6 +200,9 @@ private:
 
     /** The c alpha indices per atom */
     std::vector<unsigned int> cAlphaIndicesPerAtom;
+
+    /** The index of the run of consecutive helix atoms per atom, UINT_MAX for atoms outside of helices */
+    std::vector<unsigned int> helixRunPerAtom;
 };
 
 } /* end namespace protein */
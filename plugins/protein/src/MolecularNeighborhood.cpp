@@ -13,8 +13,6 @@
 #include "stdafx.h"
 #include "vislib/math/Point.h"
 
-#include "protein/GridNeighbourFinder.h"
-
 #include <chrono>
 #include <iostream>
 
@@ -142,17 +140,19 @@ bool MolecularNeighborhood::getExtent(core::Call& call) {
  * MolecularNeighborhood::findNeighborhoods
  */
 void MolecularNeighborhood::findNeighborhoods(MolecularDataCall& call, float radius) {
-    GridNeighbourFinder<float> finder;
-    finder.SetPointData(call.AtomPositions(), call.AtomCount(), call.AccessBoundingBoxes().ObjectSpaceBBox(), radius);
-    neighborhood.clear();
-    neighborhood.resize(call.AtomCount());
-    neighborhoodSizes.clear();
+    // if only the positions have changed, the grid can be updated instead of being rebuilt
+    if ((this->finder.GetSearchDistance() != radius) ||
+        !this->finder.UpdatePointData(call.AtomPositions(), call.AtomCount())) {
+        this->finder.SetPointData(
+            call.AtomPositions(), call.AtomCount(), call.AccessBoundingBoxes().ObjectSpaceBBox(), radius);
+    }
+    this->finder.FindAllNeighboursInRange(
+        call.AtomPositions(), call.AtomCount(), radius, this->neighborhoodOffsets, this->neighborhood);
+
     neighborhoodSizes.resize(call.AtomCount());
-    dataPointers.clear();
     dataPointers.resize(call.AtomCount());
     for (unsigned int i = 0; i < call.AtomCount(); i++) {
-        finder.FindNeighboursInRange(&call.AtomPositions()[i * 3], radius, neighborhood[i]);
-        neighborhoodSizes[i] = static_cast<unsigned int>(neighborhood[i].Count());
-        dataPointers[i] = neighborhood[i].PeekElements();
+        neighborhoodSizes[i] = static_cast<unsigned int>(neighborhoodOffsets[i + 1] - neighborhoodOffsets[i]);
+        dataPointers[i] = neighborhood.data() + neighborhoodOffsets[i];
     }
 }
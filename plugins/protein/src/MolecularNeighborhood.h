@@ -12,6 +12,7 @@
 #include "mmcore/CallerSlot.h"
 #include "mmcore/Module.h"
 #include "mmcore/param/ParamSlot.h"
+#include "protein/GridNeighbourFinder.h"
 #include "protein_calls/MolecularDataCall.h"
 #include <vector>
 
@@ -100,8 +101,14 @@ private:
     /** The last data set hash that was sent to the render */
     SIZE_T lastHashSent;
 
-    /** Vector containing the neighborhood for each atom as array of atom indices */
-    std::vector<vislib::Array<unsigned int>> neighborhood;
+    /** The search grid of the atoms */
+    GridNeighbourFinder<float> finder;
+
+    /** The neighborhoods of all atoms as atom indices, one after the other */
+    std::vector<unsigned int> neighborhood;
+
+    /** Offset of the neighborhood of each atom into 'neighborhood', plus the total size */
+    std::vector<size_t> neighborhoodOffsets;
 
     /** Vector containing the sizes of the neighborhoods */
     std::vector<unsigned int> neighborhoodSizes;
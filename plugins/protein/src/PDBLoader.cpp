@@ -11,8 +11,9 @@
 #include "mmcore/param/FilePathParam.h"
 #include "mmcore/param/IntParam.h"
 #include "mmcore/param/StringParam.h"
+#include "mmcore/utility/TaskScheduler.h"
+#include "mmcore/utility/TextParsing.h"
 #include "mmcore/utility/log/Log.h"
-#include "mmcore/utility/sys/ASCIIFileBuffer.h"
 #include "mmcore/utility/sys/MemmappedFile.h"
 #include "stdafx.h"
 #include "vislib/ArrayAllocator.h"
@@ -22,10 +23,13 @@
 #include "vislib/math/mathfunctions.h"
 #include "vislib/sys/sysfunctions.h"
 #include "vislib/types.h"
+#include <chrono>
 #include <ctime>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #define SFB716DEMO
 #define DARKER_COLORS
@@ -35,6 +39,40 @@ using namespace megamol::core;
 using namespace megamol::protein;
 using namespace megamol::protein_calls;
 
+namespace {
+
+/** Answers whether a line is a record of the given type */
+inline bool isRecord(std::string_view line, std::string_view record) {
+    return line.substr(0, record.size()) == record;
+}
+
+/** Answers whether an ATOM record is no alternate location, i.e. its location indicator is blank or 'A' */
+inline bool isMainLocation(std::string_view line) {
+    return (line.size() > 16) && ((line[16] == ' ') || (line[16] == 'A') || (line[16] == 'a'));
+}
+
+/** Parses a fixed-width field, empty or malformed fields yield 0 like atof does */
+inline float fieldFloat(std::string_view line, size_t begin, size_t length) {
+    float f = 0.0f;
+    core::utility::parseFloat(core::utility::field(line, begin, length), f);
+    return f;
+}
+
+/** Parses a fixed-width field, empty or malformed fields yield 0 like atoi does */
+inline int fieldInt(std::string_view line, size_t begin, size_t length) {
+    int64_t i = 0;
+    core::utility::parseInt(core::utility::field(line, begin, length), i);
+    return static_cast<int>(i);
+}
+
+/** Answers a fixed-width field as string */
+inline vislib::StringA fieldString(std::string_view line, size_t begin, size_t length) {
+    auto const f = core::utility::field(line, begin, length);
+    return vislib::StringA(f.data(), static_cast<unsigned int>(f.size()));
+}
+
+} // namespace
+
 #define SOLVENT_CHAIN_IDENTIFIER 127
 
 /*
@@ -935,8 +973,29 @@ bool PDBLoader::getData(core::Call& call) {
     dc->SetChains(
         static_cast<unsigned int>(this->chain.Count()), (MolecularDataCall::Chain*)this->chain.PeekElements());
 
-    if ((!this->secStructAvailable || this->recomputeStridePerFrameSlot.Param<param::BoolParam>()->Value()) &&
+    if (this->recomputeStridePerFrameSlot.Param<param::BoolParam>()->Value() &&
         this->strideFlagSlot.Param<param::BoolParam>()->Value()) {
+        if (!this->strideFrames.IsCached(dc, dc->FrameID())) {
+            // All frames of a multi-model PDB file are in memory, so compute
+            // them at once in parallel. Frames streamed from an XTC file are
+            // computed when they are requested.
+            std::vector<StrideFrameCache::FramePositions> positions;
+            if (!this->xtcFileValid) {
+                positions.reserve(this->data.Count());
+                for (unsigned int i = 0; i < static_cast<unsigned int>(this->data.Count()); ++i) {
+                    positions.emplace_back(i, this->data[i]->AtomPositions());
+                }
+            } else {
+                positions.emplace_back(dc->FrameID(), dc->AtomPositions());
+            }
+            auto t = std::chrono::steady_clock::now();
+            auto cnt = this->strideFrames.Compute(dc, positions);
+            Log::DefaultLog.WriteMsg(Log::LEVEL_INFO,
+                "Secondary Structure of %u frame(s) computed via STRIDE in %f seconds.", static_cast<unsigned int>(cnt),
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count());
+        }
+        this->strideFrames.WriteToInterface(dc, dc->FrameID());
+    } else if (!this->secStructAvailable && this->strideFlagSlot.Param<param::BoolParam>()->Value()) {
         time_t t = clock(); // DEBUG
         if (this->stride)
             delete this->stride;
@@ -1079,6 +1138,7 @@ void PDBLoader::loadFile(const vislib::TString& filename) {
     this->resetAllData();
 
     this->bbox.Set(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    this->bboxPerFrame.Clear();
 
     for (int i = 0; i < (int)this->data.Count(); i++)
         delete data[i];
@@ -1093,103 +1153,80 @@ void PDBLoader::loadFile(const vislib::TString& filename) {
 
     time_t t = clock(); // DEBUG
 
-    vislib::StringA line;
-    unsigned int idx, atomCnt, lineCnt, frameCnt, resCnt, chainCnt;
+    unsigned int idx, atomCnt, frameCnt, resCnt, chainCnt;
+    size_t lineCnt;
 
     t = clock(); // DEBUG
 
-    vislib::sys::ASCIIFileBuffer file;
-    vislib::Array<vislib::StringA> atomEntries;
-    SIZE_T atomEntriesCapacity = 10000;
+    // the atom entries are views into the mapped file (or the downloaded text)
+    core::utility::MappedFile file;
+    std::string downloaded;
+    std::string_view text;
+    std::vector<std::string_view> atomEntries;
     SIZE_T frameCapacity = 10000;
-    atomEntries.AssertCapacity(atomEntriesCapacity);
+    atomEntries.reserve(10000);
 
     Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Loading PDB file: %s", T2A(filename.PeekBuffer())); // DEBUG
     // try to load the file
     bool file_loaded = false;
-    if (file.LoadFile(T2A(filename))) {
-        // file successfully loaded, read first frame
+    if (file.open(static_cast<const char*>(T2A(filename)))) {
         file_loaded = true;
-        lineCnt = 0;
-        while (lineCnt < file.Count() && !line.StartsWith("END")) {
-            // get the current line from the file
-            line = file.Line(lineCnt);
-            // Store bounding box if provided
-            //            if( line.StartsWith( "BBOX") ) {
-            //                this->parseBBoxEntry(line);
-            //                Log::DefaultLog.WriteMsg( Log::LEVEL_INFO,
-            //                        "Found PDB bounding box (%f %f %f, %f %f %f)",
-            //                        this->bboxPDB.Left(),
-            //                        this->bboxPDB.Bottom(),
-            //                        this->bboxPDB.Back(),
-            //                        this->bboxPDB.Right(),
-            //                        this->bboxPDB.Top(),
-            //                        this->bboxPDB.Front()); // DEBUG
-            //            }
-            // store all atom entries
-            if (line.StartsWith("ATOM")) {
-                // ignore alternate locations
-                if (line.Substring(16, 1).Equals(" ", false) || line.Substring(16, 1).Equals("A", false)) {
-                    // check if the atom belongs to a cap and needs to be removed
-                    auto res_string = line.Substring(23, 4);
-                    res_string.TrimSpaces();
-                    int res_id = std::atoi(res_string.PeekBuffer());
-                    bool found = false;
-                    for (size_t i = 0; i < this->cap_chain.Count(); i++) {
-                        if (res_id >= this->cap_chain[i].first && res_id <= this->cap_chain[i].second) {
-                            found = true;
-                            break;
-                        }
-                    }
-
-                    if (!found) {
-                        // resize atom entry array, if necessary
-                        if (atomEntries.Count() == atomEntriesCapacity) {
-                            atomEntriesCapacity += 10000;
-                            atomEntries.AssertCapacity(atomEntriesCapacity);
-                        }
-                        // add atom entry
-                        atomEntries.Add(line);
-                    }
-                }
-            }
-            // next line
-            lineCnt++;
-        }
-        Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Atom count: %i", atomEntries.Count()); // DEBUG
+        text = file.text();
     } else {
 #ifdef WITH_CURL
         auto seperator_list_linux = vislib::StringTokeniserA::Split(filename, "/");
         vislib::TString tmp = seperator_list_linux[seperator_list_linux.Count() - 1];
         auto seperator_list_win = vislib::StringTokeniserA::Split(tmp, "\\");
         std::string file_exists = seperator_list_win[seperator_list_win.Count() - 1];
-        std::string complete_file = loadFromPDB(file_exists);
-
-        lineCnt = 0;
-        tmp = A2T(complete_file.c_str());
-        auto lines = vislib::StringTokeniserA::Split(tmp, "\n");
-        if (lines.Count() > 1)
-            file_loaded = true;
-
-        while (lineCnt < lines.Count() && !line.StartsWith("END")) {
-            line = lines[lineCnt];
-            if (line.StartsWith("ATOM")) {
-                // ignore alternate locations
-                if (line.Substring(16, 1).Equals(" ", false) || line.Substring(16, 1).Equals("A", false)) {
-                    // resize atom entry array, if necessary
-                    if (atomEntries.Count() == atomEntriesCapacity) {
-                        atomEntriesCapacity += 10000;
-                        atomEntries.AssertCapacity(atomEntriesCapacity);
-                    }
-                    // add atom entry
-                    atomEntries.Add(line);
+        downloaded = loadFromPDB(file_exists);
+        text = downloaded;
+        // more than one line
+        file_loaded = (text.find('\n') != std::string_view::npos);
+#endif
+    }
+    const core::utility::LineIndex lines(text);
+
+    // read first frame
+    lineCnt = 0;
+    bool end = false;
+    while (lineCnt < lines.size() && !end) {
+        // get the current line from the file
+        const std::string_view line = lines[lineCnt];
+        // Store bounding box if provided
+        //            if( line.StartsWith( "BBOX") ) {
+        //                this->parseBBoxEntry(line);
+        //                Log::DefaultLog.WriteMsg( Log::LEVEL_INFO,
+        //                        "Found PDB bounding box (%f %f %f, %f %f %f)",
+        //                        this->bboxPDB.Left(),
+        //                        this->bboxPDB.Bottom(),
+        //                        this->bboxPDB.Back(),
+        //                        this->bboxPDB.Right(),
+        //                        this->bboxPDB.Top(),
+        //                        this->bboxPDB.Front()); // DEBUG
+        //            }
+        // store all atom entries, ignore alternate locations
+        if (isRecord(line, "ATOM") && isMainLocation(line)) {
+            // check if the atom belongs to a cap and needs to be removed
+            int res_id = fieldInt(line, 23, 4);
+            bool found = false;
+            for (size_t i = 0; i < this->cap_chain.Count(); i++) {
+                if (res_id >= this->cap_chain[i].first && res_id <= this->cap_chain[i].second) {
+                    found = true;
+                    break;
                 }
             }
-            // next line
-            lineCnt++;
+
+            if (!found) {
+                // add atom entry
+                atomEntries.push_back(line);
+            }
         }
-        Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Atom count: %i", atomEntries.Count()); // DEBUG
-#endif
+        end = isRecord(line, "END");
+        // next line
+        lineCnt++;
+    }
+    if (file_loaded) {
+        Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Atom count: %i", static_cast<int>(atomEntries.size())); // DEBUG
     }
     if (!file_loaded) {
         Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR, "Could not load file %s", (const char*)T2A(filename)); // DEBUG
@@ -1198,8 +1235,8 @@ void PDBLoader::loadFile(const vislib::TString& filename) {
     // Init atom filter array with 1 (= 'visible')
     if (!this->atomVisibility.IsEmpty())
         this->atomVisibility.Clear(true);
-    this->atomVisibility.SetCount(atomEntries.Count());
-    for (unsigned int at = 0; at < atomEntries.Count(); at++)
+    this->atomVisibility.SetCount(atomEntries.size());
+    for (unsigned int at = 0; at < atomEntries.size(); at++)
         this->atomVisibility[at] = 1;
 
     // set the atom count for the first frame
@@ -1207,19 +1244,19 @@ void PDBLoader::loadFile(const vislib::TString& filename) {
     this->data.AssertCapacity(frameCapacity);
     this->data.SetCount(1);
     this->data[0] = new Frame(*const_cast<PDBLoader*>(this));
-    this->data[0]->SetAtomCount(static_cast<unsigned int>(atomEntries.Count()));
+    this->data[0]->SetAtomCount(static_cast<unsigned int>(atomEntries.size()));
     this->data[0]->setFrameIdx(0);
     // resize atom type index array
-    this->atomTypeIdx.SetCount(atomEntries.Count());
+    this->atomTypeIdx.SetCount(atomEntries.size());
     // set the capacity of the atom type array
-    this->atomType.AssertCapacity(atomEntries.Count());
+    this->atomType.AssertCapacity(atomEntries.size());
     // set the capacity of the residue array
-    this->residue.AssertCapacity(atomEntries.Count());
+    this->residue.AssertCapacity(atomEntries.size());
     // set the capacity of the index array
-    this->atomFormerIdx.AssertCapacity(atomEntries.Count());
-    this->atomFormerIdx.SetCount(atomEntries.Count());
+    this->atomFormerIdx.AssertCapacity(atomEntries.size());
+    this->atomFormerIdx.SetCount(atomEntries.size());
 
-    this->atomResidueIdx.SetCount(atomEntries.Count());
+    this->atomResidueIdx.SetCount(atomEntries.size());
 
     // check for residue-parameter and make it a chain of its own ( if no chain-id is specified ...?)
     const vislib::TString& solventResiduesStr =
@@ -1232,7 +1269,7 @@ void PDBLoader::loadFile(const vislib::TString& filename) {
     this->solventResidueIdx.Clear();
 
     // parse all atoms of the first frame
-    for (atomCnt = 0; atomCnt < atomEntries.Count(); ++atomCnt) {
+    for (atomCnt = 0; atomCnt < atomEntries.size(); ++atomCnt) {
         this->parseAtomEntry(atomEntries[atomCnt], atomCnt, frameCnt, solventResidueNames);
     }
     Log::DefaultLog.WriteMsg(
@@ -1334,13 +1371,14 @@ void PDBLoader::loadFile(const vislib::TString& filename) {
 
     // if no xtc-filename has been set
     if (this->xtcFilenameSlot.Param<core::param::FilePathParam>()->Value().empty()) {
-        // parsed first frame - load all other frames now
+        // parsed first frame - find the lines of all other frames now
+        std::vector<std::pair<size_t, size_t>> frameLines;
         atomCnt = 0;
-        while (lineCnt < file.Count()) {
+        while (lineCnt < lines.size()) {
             // get the current line from the file
-            line = file.Line(lineCnt);
+            const std::string_view line = lines[lineCnt];
             // store all atom entries
-            if (line.StartsWith("ATOM")) {
+            if (isRecord(line, "ATOM")) {
                 // found new frame, resize data array
                 if (atomCnt == 0) {
                     frameCnt++;
@@ -1348,33 +1386,58 @@ void PDBLoader::loadFile(const vislib::TString& filename) {
                     if (frameCnt > static_cast<unsigned int>(this->maxFramesSlot.Param<param::IntParam>()->Value())) {
                         break;
                     }
+                    if (!frameLines.empty()) {
+                        frameLines.back().second = lineCnt;
+                    }
+                    frameLines.emplace_back(lineCnt, lines.size());
                     if (this->data.Count() == frameCapacity) {
                         frameCapacity += 10000;
                         this->data.AssertCapacity(frameCapacity);
                     }
                     this->data.SetCount(frameCnt + 1);
                     this->data[frameCnt] = new Frame(*const_cast<PDBLoader*>(this));
-                    this->data[frameCnt]->SetAtomCount(static_cast<unsigned int>(atomEntries.Count()));
+                    this->data[frameCnt]->SetAtomCount(static_cast<unsigned int>(atomEntries.size()));
                     this->data[frameCnt]->setFrameIdx(frameCnt);
                 }
                 // ignore alternate locations
-                if (line.Substring(16, 1).Equals(" ", false) || line.Substring(16, 1).Equals("A", false)) {
-                    // add atom position to the current frame
-                    this->setAtomPositionToFrame(line, atomCnt, frameCnt);
+                if (isMainLocation(line)) {
                     atomCnt++;
                 }
-            } else if (line.StartsWith("END")) {
+            } else if (isRecord(line, "END")) {
                 atomCnt = 0;
             }
             // next line
             lineCnt++;
         }
+        if (!frameLines.empty()) {
+            frameLines.back().second = lineCnt;
+        }
+
+        // the frames are independent, so they are parsed in parallel
+        this->bboxPerFrame.SetCount(this->data.Count());
+        std::vector<unsigned int> frameAtomCnt(frameLines.size(), 0);
+        core::utility::ParallelFor<size_t>(0, frameLines.size(), 1, [&](size_t first, size_t last) {
+            for (size_t f = first; f < last; ++f) {
+                for (size_t l = frameLines[f].first; l < frameLines[f].second; ++l) {
+                    const std::string_view line = lines[l];
+                    if (isRecord(line, "ATOM") && isMainLocation(line)) {
+                        // add atom position to the current frame
+                        this->setAtomPositionToFrame(line, frameAtomCnt[f]++, static_cast<unsigned int>(f + 1));
+                    }
+                }
+            }
+        });
+        for (size_t f = 0; f < frameLines.size(); ++f) {
+            if (frameAtomCnt[f] > 0) {
+                this->bbox.Union(this->bboxPerFrame[f + 1]);
+            }
+        }
 
         Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Time for parsing %i frames: %f", this->data.Count(),
             (double(clock() - t) / double(CLOCKS_PER_SEC))); // DEBUG
 
-        // all information loaded, delete file
-        file.Clear();
+        // all information loaded, close file
+        file.close();
         Log::DefaultLog.WriteMsg(
             Log::LEVEL_INFO, "Time for clearing the file: %f", (double(clock() - t) / double(CLOCKS_PER_SEC))); // DEBUG
 
@@ -1419,11 +1482,11 @@ void PDBLoader::loadFile(const vislib::TString& filename) {
 
             // check whether the pdb-file and the xtc-file contain the
             // same number of atoms
-            if (nAtoms != atomEntries.Count()) {
+            if (nAtoms != atomEntries.size()) {
                 Log::DefaultLog.WriteMsg(Log::LEVEL_ERROR,
                     "XTC-File and given PDB-file not matching (XTC-file has"
                     "%i atom entries, PDB-file has %i atom entries).",
-                    nAtoms, atomEntries.Count()); // DEBUG
+                    nAtoms, static_cast<int>(atomEntries.size())); // DEBUG
                 xtcFileValid = false;
                 xtcFile.close();
             } else {
@@ -1452,37 +1515,28 @@ void PDBLoader::loadFileCap(const vislib::TString& filename) {
 
     Log::DefaultLog.WriteMsg(Log::LEVEL_INFO, "Loading CAP file: %s", T2A(filename.PeekBuffer())); // DEBUG
 
-    vislib::sys::ASCIIFileBuffer file;
-    vislib::StringA line;
-    unsigned int lineCnt;
+    core::utility::MappedFile file;
 
     this->cap_chain.Clear();
 
     // try to load the file
-    bool file_loaded = false;
-    if (file.LoadFile(T2A(filename))) {
-        // file successfully loaded, read first frame
-        file_loaded = true;
-        lineCnt = 0;
-        while (lineCnt < file.Count()) {
+    if (file.open(static_cast<const char*>(T2A(filename)))) {
+        core::utility::TextCursor text(file.text());
+        while (!text.atEnd()) {
             // get the current line from the file
-            line = file.Line(lineCnt);
+            const std::string_view line = text.line();
 
             // store the first and the last rsidue from the cap
-            vislib::StringA begin, end;
-            auto pos = line.Find("-", 0);
-            if (pos != -1) {
-                begin = line.Substring(0, pos);
-                end = line.Substring(pos + 1);
-
-            } else {
-                begin = line.Substring(0);
-                end = line.Substring(0);
+            std::string_view begin = line, end = line;
+            auto pos = line.find('-');
+            if (pos != std::string_view::npos) {
+                begin = line.substr(0, pos);
+                end = line.substr(pos + 1);
             }
-            this->cap_chain.Add(std::make_pair(std::atoi(begin.PeekBuffer()), std::atoi(end.PeekBuffer())));
-
-            // next line
-            lineCnt++;
+            int64_t first = 0, last = 0;
+            core::utility::parseInt(core::utility::trim(begin), first);
+            core::utility::parseInt(core::utility::trim(end), last);
+            this->cap_chain.Add(std::make_pair(static_cast<int>(first), static_cast<int>(last)));
         }
     }
 }
@@ -1490,27 +1544,22 @@ void PDBLoader::loadFileCap(const vislib::TString& filename) {
 /*
  * parse one atom entry
  */
-void PDBLoader::parseAtomEntry(vislib::StringA& atomEntry, unsigned int atom, unsigned int frame,
+void PDBLoader::parseAtomEntry(std::string_view atomEntry, unsigned int atom, unsigned int frame,
     vislib::Array<vislib::TString>& solventResidueNames) {
     // temp variables
     vislib::StringA tmpStr;
     vislib::math::Vector<float, 3> pos;
     // set atom position
-    pos.Set(float(atof(atomEntry.Substring(30, 8))), float(atof(atomEntry.Substring(38, 8))),
-        float(atof(atomEntry.Substring(46, 8))));
+    pos.Set(fieldFloat(atomEntry, 30, 8), fieldFloat(atomEntry, 38, 8), fieldFloat(atomEntry, 46, 8));
     this->data[frame]->SetAtomPosition(atom, pos.X(), pos.Y(), pos.Z());
 
     // get the atom index of the current ATOM entry
-    tmpStr = atomEntry.Substring(6, 5);
-    tmpStr.TrimSpaces();
-    this->atomFormerIdx[atom] = std::stoi(tmpStr.PeekBuffer());
+    this->atomFormerIdx[atom] = fieldInt(atomEntry, 6, 5);
 
     // get the name (atom type) of the current ATOM entry
-    tmpStr = atomEntry.Substring(12, 4);
-    tmpStr.TrimSpaces();
+    tmpStr = fieldString(atomEntry, 12, 4);
     // get the element symbol of the current ATOM entry
-    vislib::StringA tmpStr2 = atomEntry.Substring(76, 2);
-    tmpStr2.TrimSpaces();
+    vislib::StringA tmpStr2 = fieldString(atomEntry, 76, 2);
     // get the radius of the element
     float radius = getElementRadius(tmpStr);
     // get the color of the element
@@ -1542,12 +1591,10 @@ void PDBLoader::parseAtomEntry(vislib::StringA& atomEntry, unsigned int atom, un
     }
 
     // get chain id
-    char tmpChainId = atomEntry.Substring(21, 1)[0];
+    char tmpChainId = (atomEntry.size() > 21) ? atomEntry[21] : '\0';
     MolecularDataCall::Chain::ChainType tmpChainType = MolecularDataCall::Chain::UNSPECIFIC;
     // get the name of the residue
-    tmpStr = atomEntry.Substring(17, 4);
-    tmpStr.TrimSpaces();
-    vislib::StringA resName = tmpStr;
+    vislib::StringA resName = fieldString(atomEntry, 17, 4);
     unsigned int resTypeIdx;
 
     // search for current residue type name in the array
@@ -1580,9 +1627,7 @@ void PDBLoader::parseAtomEntry(vislib::StringA& atomEntry, unsigned int atom, un
 
 
     // get the sequence number of the residue
-    tmpStr = atomEntry.Substring(22, 4);
-    tmpStr.TrimSpaces();
-    unsigned int newResSeq = static_cast<unsigned int>(atoi(tmpStr));
+    unsigned int newResSeq = static_cast<unsigned int>(fieldInt(atomEntry, 22, 4));
     // handle residue
     if (this->residue.Count() == 0) {
         // create first residue
@@ -1642,9 +1687,7 @@ void PDBLoader::parseAtomEntry(vislib::StringA& atomEntry, unsigned int atom, un
     this->atomResidueIdx[atom] = static_cast<int>(this->residue.Count() - 1);
 
     // get the temperature factor (b-factor)
-    tmpStr = atomEntry.Substring(60, 6);
-    tmpStr.TrimSpaces();
-    float tempFactor = float(atof(tmpStr));
+    float tempFactor = fieldFloat(atomEntry, 60, 6);
     if (atom == 0) {
         this->data[frame]->SetBFactorRange(tempFactor, tempFactor);
     } else {
@@ -1656,9 +1699,7 @@ void PDBLoader::parseAtomEntry(vislib::StringA& atomEntry, unsigned int atom, un
     this->data[frame]->SetAtomBFactor(atom, tempFactor);
 
     // get the occupancy
-    tmpStr = atomEntry.Substring(54, 6);
-    tmpStr.TrimSpaces();
-    float occupancy = float(atof(tmpStr));
+    float occupancy = fieldFloat(atomEntry, 54, 6);
     if (atom == 0) {
         this->data[frame]->SetOccupancyRange(occupancy, occupancy);
     } else {
@@ -1670,9 +1711,7 @@ void PDBLoader::parseAtomEntry(vislib::StringA& atomEntry, unsigned int atom, un
     this->data[frame]->SetAtomOccupancy(atom, occupancy);
 
     // get the charge
-    tmpStr = atomEntry.Substring(78, 2);
-    tmpStr.TrimSpaces();
-    float charge = float(atof(tmpStr));
+    float charge = fieldFloat(atomEntry, 78, 2);
     if (atom == 0) {
         this->data[frame]->SetChargeRange(charge, charge);
     } else {
@@ -1807,13 +1846,11 @@ vislib::math::Vector<unsigned char, 3> PDBLoader::getElementColor(vislib::String
 /*
  * set the position of the current atom entry to the frame
  */
-void PDBLoader::setAtomPositionToFrame(vislib::StringA& atomEntry, unsigned int atom, unsigned int frame) {
+void PDBLoader::setAtomPositionToFrame(std::string_view atomEntry, unsigned int atom, unsigned int frame) {
     // temp variables
-    vislib::StringA tmpStr;
     vislib::math::Vector<float, 3> pos;
     // set atom position
-    pos.Set(float(atof(atomEntry.Substring(30, 8))), float(atof(atomEntry.Substring(38, 8))),
-        float(atof(atomEntry.Substring(46, 8))));
+    pos.Set(fieldFloat(atomEntry, 30, 8), fieldFloat(atomEntry, 38, 8), fieldFloat(atomEntry, 46, 8));
     this->data[frame]->SetAtomPosition(atom, pos.X(), pos.Y(), pos.Z());
 
     // update bounding box
@@ -1823,18 +1860,15 @@ void PDBLoader::setAtomPositionToFrame(vislib::StringA& atomEntry, unsigned int
         pos.X() + this->atomType[this->atomTypeIdx[atom]].Radius(),
         pos.Y() + this->atomType[this->atomTypeIdx[atom]].Radius(),
         pos.Z() + this->atomType[this->atomTypeIdx[atom]].Radius());
-    this->bbox.Union(atomBBox);
 
     if (atom == 0) {
-        this->bboxPerFrame.Add(atomBBox);
+        this->bboxPerFrame[frame] = atomBBox;
     } else {
         this->bboxPerFrame[frame].Union(atomBBox);
     }
 
     // get the temperature factor (b-factor)
-    tmpStr = atomEntry.Substring(60, 6);
-    tmpStr.TrimSpaces();
-    float tempFactor = float(atof(tmpStr));
+    float tempFactor = fieldFloat(atomEntry, 60, 6);
     if (atom == 0) {
         this->data[frame]->SetBFactorRange(tempFactor, tempFactor);
     } else {
@@ -1845,9 +1879,7 @@ void PDBLoader::setAtomPositionToFrame(vislib::StringA& atomEntry, unsigned int
     }
 
     // get the occupancy
-    tmpStr = atomEntry.Substring(54, 6);
-    tmpStr.TrimSpaces();
-    float occupancy = float(atof(tmpStr));
+    float occupancy = fieldFloat(atomEntry, 54, 6);
     if (atom == 0) {
         this->data[frame]->SetOccupancyRange(occupancy, occupancy);
     } else {
@@ -1858,9 +1890,7 @@ void PDBLoader::setAtomPositionToFrame(vislib::StringA& atomEntry, unsigned int
     }
 
     // get the charge
-    tmpStr = atomEntry.Substring(78, 2);
-    tmpStr.TrimSpaces();
-    float charge = float(atof(tmpStr));
+    float charge = fieldFloat(atomEntry, 78, 2);
     if (atom == 0) {
         this->data[frame]->SetChargeRange(charge, charge);
     } else {
@@ -2003,6 +2033,7 @@ void PDBLoader::resetAllData() {
     delete stride;
     this->stride = 0;
     secStructAvailable = false;
+    this->strideFrames.Clear();
     this->chainFirstRes.Clear();
     this->chainResCount.Clear();
     this->chainName.Clear();
@@ -14,6 +14,7 @@
 #include "MDDriverConnector.h"
 #include "MultiPDBLoader.h"
 #include "Stride.h"
+#include "StrideFrameCache.h"
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/CallerSlot.h"
 #include "mmcore/param/ParamSlot.h"
@@ -25,6 +26,7 @@
 #include "vislib/math/Cuboid.h"
 #include "vislib/math/Vector.h"
 #include <fstream>
+#include <string_view>
 
 #ifdef WITH_CURL
 #include <curl/curl.h>
@@ -566,11 +568,11 @@ private:
     /**
      * Parse one atom entry.
      *
-     * @param atomEntry The atom entry string.
+     * @param atomEntry The atom entry line.
      * @param atom      The number of the current atom.
      * @param frame     The number of the current frame.
      */
-    void parseAtomEntry(vislib::StringA& atomEntry, unsigned int atom, unsigned int frame,
+    void parseAtomEntry(std::string_view atomEntry, unsigned int atom, unsigned int frame,
         vislib::Array<vislib::TString>& solventResidueNames);
 
     /**
@@ -598,13 +600,14 @@ private:
 
     /**
      * Parse one atom entry and set the position of the current atom entry
-     * to the frame.
+     * to the frame. Only the frame and its bounding box are changed, so
+     * different frames can be parsed concurrently.
      *
-     * @param atomEntry The atom entry string.
+     * @param atomEntry The atom entry line.
      * @param atom      The number of the current atom.
      * @param frame     The number of the current frame.
      */
-    void setAtomPositionToFrame(vislib::StringA& atomEntry, unsigned int atom, unsigned int frame);
+    void setAtomPositionToFrame(std::string_view atomEntry, unsigned int atom, unsigned int frame);
 
     /**
      * Search for connections in the given residue and add them to the
@@ -736,6 +739,8 @@ private:
 
     /** Stride secondary structure computation */
     Stride* stride;
+    /** Stride secondary structure of each frame if recomputed per frame */
+    StrideFrameCache strideFrames;
     /** Flag whether secondary structure is available */
     bool secStructAvailable;
 
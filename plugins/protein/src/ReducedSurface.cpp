@@ -12,9 +12,13 @@
 #include "vislib/Trace.h"
 #include "vislib/assert.h"
 #include "vislib/sys/File.h"
+#include <atomic>
 #include <ctime>
 #include <iostream>
 #include <math.h>
+#include <mutex>
+
+#include "mmcore/utility/TaskScheduler.h"
 
 using namespace megamol;
 using namespace megamol::core;
@@ -122,8 +126,8 @@ void ReducedSurface::ComputeReducedSurface() {
     time_t t = clock();
     time_t t_total = clock();
 
-    // counter variables
-    unsigned int cnt1, cnt2;
+    // counter variable
+    unsigned int cnt1;
     // clear the RS-vertices, -edges and -faces
     for (cnt1 = 0; cnt1 < this->rsVertex.size(); ++cnt1) {
         delete this->rsVertex[cnt1];
@@ -151,19 +155,14 @@ void ReducedSurface::ComputeReducedSurface() {
     this->bBox = this->molecule->AccessBoundingBoxes().ObjectSpaceBBox();
     // set voxel lenght --> diameter of the probe + maximum atom diameter
     this->voxelLength = 2 * this->probeRadius + 2 * 3.0f;
-    unsigned int tmpSize = (unsigned int)ceilf(this->bBox.Width() / this->voxelLength);
+    this->voxelMapRes.Set(std::max(1u, (unsigned int)ceilf(this->bBox.Width() / this->voxelLength)),
+        std::max(1u, (unsigned int)ceilf(this->bBox.Height() / this->voxelLength)),
+        std::max(1u, (unsigned int)ceilf(this->bBox.Depth() / this->voxelLength)));
+    const unsigned int voxelCount = this->voxelMapRes.GetX() * this->voxelMapRes.GetY() * this->voxelMapRes.GetZ();
     this->voxelMap.clear();
     this->voxelMapProbes.clear();
-    this->voxelMap.resize(tmpSize);
-    this->voxelMapProbes.resize(tmpSize);
-    for (cnt1 = 0; cnt1 < this->voxelMap.size(); ++cnt1) {
-        this->voxelMap[cnt1].resize((unsigned int)ceilf(this->bBox.Height() / this->voxelLength));
-        this->voxelMapProbes[cnt1].resize((unsigned int)ceilf(this->bBox.Height() / this->voxelLength));
-        for (cnt2 = 0; cnt2 < this->voxelMap[cnt1].size(); ++cnt2) {
-            this->voxelMap[cnt1][cnt2].resize((unsigned int)ceilf(this->bBox.Depth() / this->voxelLength));
-            this->voxelMapProbes[cnt1][cnt2].resize((unsigned int)ceilf(this->bBox.Depth() / this->voxelLength));
-        }
-    }
+    this->voxelMap.resize(voxelCount);
+    this->voxelMapProbes.resize(voxelCount);
     std::cout << "time for resizing voxel maps:  " << (double(clock() - t) / double(CLOCKS_PER_SEC)) << std::endl;
     t = clock();
 
@@ -181,30 +180,24 @@ void ReducedSurface::ComputeReducedSurface() {
         this->rsVertex.push_back(new RSVertex(tmpVec1, radius, cnt1));
 
         // add RS-vertex to voxel map cell
-        this->voxelMap[(unsigned int)std::min((unsigned int)this->voxelMap.size() - 1,
-            (unsigned int)std::max(0, (int)floorf((tmpVec1.GetX() - bBox.Left()) / voxelLength)))]
-                      [(unsigned int)std::min((unsigned int)this->voxelMap[0].size() - 1,
-                          (unsigned int)std::max(0, (int)floorf((tmpVec1.GetY() - bBox.Bottom()) / voxelLength)))]
-                      [(unsigned int)std::min((unsigned int)this->voxelMap[0][0].size() - 1,
-                           (unsigned int)std::max(0, (int)floorf((tmpVec1.GetZ() - bBox.Back()) / voxelLength)))]
-                          .push_back(this->rsVertex.back());
+        this->voxelMap[this->VoxelIndex(this->ComputeVoxelCell(tmpVec1))].push_back(this->rsVertex.back());
         // if this is the first atom OR the x-value is larger than the current smallest x
         // --> store cnt as xIdx
-        if (this->rsVertex.size() > 0 ||
+        if (this->rsVertex.size() == 1 ||
             (this->rsVertex[xIdx]->GetPosition().GetX() - this->rsVertex[xIdx]->GetRadius()) >
                 (this->rsVertex.back()->GetPosition().GetX() - this->rsVertex.back()->GetRadius())) {
             xIdx = (unsigned int)this->rsVertex.size() - 1;
         }
         // if this is the first atom OR the y-value is larger than the current smallest y
         // --> store cnt as yIdx
-        if (this->rsVertex.size() > 0 ||
+        if (this->rsVertex.size() == 1 ||
             (this->rsVertex[yIdx]->GetPosition().GetY() - this->rsVertex[yIdx]->GetRadius()) >
                 (this->rsVertex.back()->GetPosition().GetY() - this->rsVertex.back()->GetRadius())) {
             yIdx = (unsigned int)this->rsVertex.size() - 1;
         }
         // if this is the first atom OR the z-value is larger than the current smallest z
         // --> store cnt as zIdx
-        if (this->rsVertex.size() > 0 ||
+        if (this->rsVertex.size() == 1 ||
             (this->rsVertex[zIdx]->GetPosition().GetZ() - this->rsVertex[zIdx]->GetRadius()) >
                 (this->rsVertex.back()->GetPosition().GetZ() - this->rsVertex.back()->GetRadius())) {
             zIdx = (unsigned int)this->rsVertex.size() - 1;
@@ -238,11 +231,7 @@ void ReducedSurface::ComputeReducedSurface() {
     t = clock();
 
     // for each edge of the first RS-face: find neighbours
-    cnt1 = 0;
-    while (cnt1 < this->rsEdge.size()) {
-        this->ComputeRSFace(cnt1);
-        cnt1++;
-    }
+    this->ComputeRSFaces(0);
 
     // remove all RS-edges with only one face from the list of RS-edges
     std::vector<RSEdge*> tmpRSEdge;
@@ -280,20 +269,25 @@ void ReducedSurface::ComputeSingularities() {
     /*
             time_t t = clock();
     */
-    unsigned int cnt1;
-    // check number of cutting probes per edge
-    countCutEdges = 0;
-    for (cnt1 = 0; cnt1 < this->rsEdge.size(); ++cnt1) {
-        // check cutting probes only for spindle tori
-        if (this->rsEdge[cnt1]->GetTorusRadius() < this->probeRadius) {
-            WriteProbesCutEdge(this->rsEdge[cnt1]);
-            if (this->rsEdge[cnt1]->cuttingProbes.size() > 0) {
-                countCutEdges++;
+    // the edges only read the probe voxel map, so they can be processed concurrently
+    std::atomic<unsigned int> cutEdges(0);
+    core::utility::ParallelFor<std::size_t>(0, this->rsEdge.size(), 256, [&](std::size_t begin, std::size_t end) {
+        unsigned int cnt = 0;
+        for (auto i = begin; i < end; ++i) {
+            // check cutting probes only for spindle tori
+            if (this->rsEdge[i]->GetTorusRadius() < this->probeRadius) {
+                WriteProbesCutEdge(this->rsEdge[i]);
+                if (this->rsEdge[i]->cuttingProbes.size() > 0) {
+                    cnt++;
+                }
+            } else {
+                this->rsEdge[i]->cuttingProbes.clear();
             }
-        } else {
-            this->rsEdge[cnt1]->cuttingProbes.clear();
         }
-    }
+        cutEdges += cnt;
+    });
+    // check number of cutting probes per edge
+    countCutEdges = cutEdges;
 
     /*
             std::cout << "Number of cutted edges: " << countCutEdges << " / " << this->rsEdge.size() << " " <<
@@ -315,6 +309,56 @@ void ReducedSurface::ComputeRSFace(unsigned int edgeIdx) {
     // do nothing if the edge has both faces already set or if this is a free edge
     if (edge->GetFace2() != NULL || edge->GetFace1() == NULL)
         return;
+    RSPivot pivot;
+    this->PivotRSEdge(edge, pivot, this->vicinity);
+    this->CommitRSFace(edge, pivot);
+}
+
+
+/*
+ * find next face for all open edges starting at the given edge
+ */
+void ReducedSurface::ComputeRSFaces(unsigned int firstEdgeIdx) {
+    std::vector<RSPivot> pivots;
+    // the front is advanced in waves: the pivots of all edges of a wave are independent of each other and
+    // computed concurrently, then the new faces are added in the order of the edges, which yields the same
+    // surface as computing one face after the other
+    while (firstEdgeIdx < this->rsEdge.size()) {
+        const unsigned int lastEdgeIdx = (unsigned int)this->rsEdge.size();
+        pivots.resize(lastEdgeIdx - firstEdgeIdx);
+        core::utility::ParallelFor<unsigned int>(
+            firstEdgeIdx, lastEdgeIdx, 64, [&](unsigned int begin, unsigned int end) {
+                std::vector<RSVertex*> vicinity;
+                for (auto i = begin; i < end; ++i) {
+                    RSEdge* edge = this->rsEdge[i];
+                    RSPivot& pivot = pivots[i - firstEdgeIdx];
+                    if (edge->GetFace2() == NULL && edge->GetFace1() != NULL) {
+                        this->PivotRSEdge(edge, pivot, vicinity);
+                    } else {
+                        pivot.Vertex = NULL;
+                        pivot.Flags.clear();
+                    }
+                }
+            });
+
+        for (unsigned int i = firstEdgeIdx; i < lastEdgeIdx; ++i) {
+            RSEdge* edge = this->rsEdge[i];
+            // the edge might have been closed by a face of this wave
+            if (edge->GetFace2() != NULL || edge->GetFace1() == NULL)
+                continue;
+            this->CommitRSFace(edge, pivots[i - firstEdgeIdx]);
+        }
+        firstEdgeIdx = lastEdgeIdx;
+    }
+}
+
+
+/*
+ * find the vertex the probe hits first when rolling over the given edge
+ */
+void ReducedSurface::PivotRSEdge(RSEdge* edge, RSPivot& pivot, std::vector<RSVertex*>& vicinity) const {
+    pivot.Vertex = NULL;
+    pivot.Flags.clear();
     unsigned int cnt;
     int result = -1;
     // the angle between two faces
@@ -324,11 +368,11 @@ void ReducedSurface::ComputeRSFace(unsigned int edgeIdx) {
     vislib::math::Vector<float, 3> ai = edge->GetVertex1()->GetPosition();
     vislib::math::Vector<float, 3> aj = edge->GetVertex2()->GetPosition();
     vislib::math::Vector<float, 3> pijk0 = edge->GetFace1()->GetProbeCenter();
-    vislib::math::Vector<float, 3> ak, uik, tik, tjk, uijk, utb, bijk, pijk1;
+    vislib::math::Vector<float, 3> ak, uik, tik, uijk, utb, bijk, pijk1;
     RSVertex* ak0Vertex;
     vislib::math::Vector<float, 3> ak0, uijk0, bijk0;
     float rk0;
-    float dik, djk, rk, rik, rjk, wijk, hijk;
+    float dik, djk, rk, wijk, hijk;
     // store the face's vertex which does not belong to the edge as vertex ak0
     if (edge->GetFace1()->GetVertex1() != edge->GetVertex1() && edge->GetFace1()->GetVertex1() != edge->GetVertex2())
         ak0Vertex = edge->GetFace1()->GetVertex1();
@@ -354,9 +398,9 @@ void ReducedSurface::ComputeRSFace(unsigned int edgeIdx) {
     vislib::math::Vector<float, 3> bijk0Dir, bijkDir, ak0Dir, akDir;
 
     // search all atoms that are in the vicinity of this edge
-    this->ComputeVicinityEdge(edge);
+    this->ComputeVicinityEdge(edge, vicinity);
     // do nothing if the edge has no vicinity
-    if (this->vicinity.empty())
+    if (vicinity.empty())
         return;
 
     // d of plane defined by uijk0, ai
@@ -379,9 +423,9 @@ void ReducedSurface::ComputeRSFace(unsigned int edgeIdx) {
         dir1 = 1.0f;
 
     // loop over all atoms which are in the vicinty
-    for (cnt = 0; cnt < this->vicinity.size(); ++cnt) {
-        ak = this->vicinity[cnt]->GetPosition();
-        rk = this->vicinity[cnt]->GetRadius();
+    for (cnt = 0; cnt < vicinity.size(); ++cnt) {
+        ak = vicinity[cnt]->GetPosition();
+        rk = vicinity[cnt]->GetRadius();
         dik = (ak - ai).Length();
         djk = (ak - aj).Length();
         // continue, if one or more of the distances are too large
@@ -410,7 +454,7 @@ void ReducedSurface::ComputeRSFace(unsigned int edgeIdx) {
         akDir = ak - tij;
 
         // if the face is dual to the existing face of the edge:
-        if (ak0Vertex == this->vicinity[cnt]) {
+        if (ak0Vertex == vicinity[cnt]) {
             // check if the normal is the inverted normal of ak0
             if ((uijk + uijk0).Length() < (uijk - uijk0).Length())
                 tmpFac = 1.0f;
@@ -488,214 +532,240 @@ void ReducedSurface::ComputeRSFace(unsigned int edgeIdx) {
         // alpha must be greater than 0
         if (alpha < epsilon) {
             // set atom with greater angle as the current angle as buried
-            this->vicinity[cnt]->SetAtomBuried(true);
+            pivot.Flags.push_back(std::make_pair(vicinity[cnt], true));
         } else if (alpha < angle) {
             if (result > -1) {
                 // set former atom with the smallest angle as buried
-                this->vicinity[result]->SetAtomBuried(true);
+                pivot.Flags.push_back(std::make_pair(vicinity[result], true));
             }
             // set atom with the current smallest angle as not burried
-            this->vicinity[cnt]->SetAtomBuried(false);
+            pivot.Flags.push_back(std::make_pair(vicinity[cnt], false));
             angle = alpha;
             factor = tmpFac;
             result = cnt;
         } else {
             // set atom with greater angle as the current angle as buried
-            this->vicinity[cnt]->SetAtomBuried(true);
+            pivot.Flags.push_back(std::make_pair(vicinity[cnt], true));
         }
+    }
+
+    if (result >= 0) {
+        pivot.Vertex = vicinity[result];
+        pivot.Angle = angle;
+        pivot.Factor = factor;
+    }
+}
+
+
+/*
+ * add the face found by PivotRSEdge to the reduced surface
+ */
+void ReducedSurface::CommitRSFace(RSEdge* edge, const RSPivot& pivot) {
+    unsigned int cnt;
+    // mark the vicinity atoms like the pivoting did, in the same order
+    for (cnt = 0; cnt < pivot.Flags.size(); ++cnt) {
+        pivot.Flags[cnt].first->SetAtomBuried(pivot.Flags[cnt].second);
         // set vicinity atom as treated
-        this->vicinity[cnt]->SetTreated();
+        pivot.Flags[cnt].first->SetTreated();
     }
+    if (pivot.Vertex == NULL)
+        return;
+
+    const float angle = pivot.Angle;
+    const float factor = pivot.Factor;
+    // names of the variables according to: Connolly "Analytical Molecular Surface Calculation", 1983
+    vislib::math::Vector<float, 3> ai = edge->GetVertex1()->GetPosition();
+    vislib::math::Vector<float, 3> aj = edge->GetVertex2()->GetPosition();
+    vislib::math::Vector<float, 3> ak, uik, tik, tjk, uijk, utb, bijk, pijk1;
+    float dik, djk, rk, rik, rjk, wijk, hijk;
+    float ri = edge->GetVertex1()->GetRadius();
+    float rj = edge->GetVertex2()->GetRadius();
+    float rp = this->probeRadius;
+    float dij = (aj - ai).Length();
+    vislib::math::Vector<float, 3> uij = (aj - ai) / dij;
+    vislib::math::Vector<float, 3> tij = edge->GetTorusCenter();
+
 
     // compute values for the result
-    if (result >= 0) {
-        edge->SetRotationAngle(angle * factor);
-        ak = this->vicinity[result]->GetPosition();
-        rk = this->vicinity[result]->GetRadius();
-        dik = (ak - ai).Length();
-        djk = (ak - aj).Length();
-        uik = (ak - ai) / dik;
-        // tik = 0.5f*( ai + ak) + 0.5f*( ak - ai) * ( pow( ri + rp, 2.0f) - pow( rk + rp, 2.0f))/pow( dik, 2.0f);
-        tik = 0.5f * (ai + ak) + 0.5f * (ak - ai) * ((ri + rp) * (ri + rp) - (rk + rp) * (rk + rp)) / (dik * dik);
-        // tjk = 0.5f*( aj + ak) + 0.5f*( ak - aj) * ( pow( rj + rp, 2.0f) - pow( rk + rp, 2.0f))/pow( djk, 2.0f);
-        tjk = 0.5f * (aj + ak) + 0.5f * (ak - aj) * ((rj + rp) * (rj + rp) - (rk + rp) * (rk + rp)) / (djk * djk);
-        // rik = 0.5f*pow( pow(ri + rk + 2.0f*rp, 2.0f) - pow( dik, 2.0f), 0.5f) * ( pow( pow( dik, 2.0f) - pow( ri -
-        // rk, 2.0f), 0.5f) / dik);
-        rik = 0.5f * pow((ri + rk + 2.0f * rp) * (ri + rk + 2.0f * rp) - dik * dik, 0.5f) *
-              (pow(dik * dik - (ri - rk) * (ri - rk), 0.5f) / dik);
-        // rjk = 0.5f*pow( pow(rj + rk + 2.0f*rp, 2.0f) - pow( djk, 2.0f), 0.5f) * ( pow( pow( djk, 2.0f) - pow( rj -
-        // rk, 2.0f), 0.5f) / djk);
-        rjk = 0.5f * pow((rj + rk + 2.0f * rp) * (rj + rk + 2.0f * rp) - djk * djk, 0.5f) *
-              (pow(djk * djk - (rj - rk) * (rj - rk), 0.5f) / djk);
-        wijk = acos(uij.Dot(uik));
-        uijk = uij.Cross(uik) / sin(wijk);
-        utb = uijk.Cross(uij);
-        // bijk = tij + utb * ( uik.Dot( tik - tij)) * pow( sin( wijk), -1.0f);
-        bijk = tij + utb * (uik.Dot(tik - tij) / sin(wijk));
-        // hijk = pow( pow( ri + rp, 2.0f) - pow( ( bijk - ai).Length(), 2.0f), 0.5f);
-        hijk = pow((ri + rp) * (ri + rp) - ((bijk - ai).Length()) * ((bijk - ai).Length()), 0.5f);
-        pijk1 = bijk + uijk * hijk * factor;
-
-        // pointer to a dual face of the new face
-        RSFace* dualFace = NULL;
-        // store the attributes of the new face
-        std::vector<RSVertex*> vertsNewFace;
-        vertsNewFace.push_back(edge->GetVertex1());
-        if (edge->GetVertex2()->GetIndex() < edge->GetVertex1()->GetIndex())
-            vertsNewFace.insert(vertsNewFace.begin(), edge->GetVertex2());
+    edge->SetRotationAngle(angle * factor);
+    ak = pivot.Vertex->GetPosition();
+    rk = pivot.Vertex->GetRadius();
+    dik = (ak - ai).Length();
+    djk = (ak - aj).Length();
+    uik = (ak - ai) / dik;
+    // tik = 0.5f*( ai + ak) + 0.5f*( ak - ai) * ( pow( ri + rp, 2.0f) - pow( rk + rp, 2.0f))/pow( dik, 2.0f);
+    tik = 0.5f * (ai + ak) + 0.5f * (ak - ai) * ((ri + rp) * (ri + rp) - (rk + rp) * (rk + rp)) / (dik * dik);
+    // tjk = 0.5f*( aj + ak) + 0.5f*( ak - aj) * ( pow( rj + rp, 2.0f) - pow( rk + rp, 2.0f))/pow( djk, 2.0f);
+    tjk = 0.5f * (aj + ak) + 0.5f * (ak - aj) * ((rj + rp) * (rj + rp) - (rk + rp) * (rk + rp)) / (djk * djk);
+    // rik = 0.5f*pow( pow(ri + rk + 2.0f*rp, 2.0f) - pow( dik, 2.0f), 0.5f) * ( pow( pow( dik, 2.0f) - pow( ri -
+    // rk, 2.0f), 0.5f) / dik);
+    rik = 0.5f * pow((ri + rk + 2.0f * rp) * (ri + rk + 2.0f * rp) - dik * dik, 0.5f) *
+          (pow(dik * dik - (ri - rk) * (ri - rk), 0.5f) / dik);
+    // rjk = 0.5f*pow( pow(rj + rk + 2.0f*rp, 2.0f) - pow( djk, 2.0f), 0.5f) * ( pow( pow( djk, 2.0f) - pow( rj -
+    // rk, 2.0f), 0.5f) / djk);
+    rjk = 0.5f * pow((rj + rk + 2.0f * rp) * (rj + rk + 2.0f * rp) - djk * djk, 0.5f) *
+          (pow(djk * djk - (rj - rk) * (rj - rk), 0.5f) / djk);
+    wijk = acos(uij.Dot(uik));
+    uijk = uij.Cross(uik) / sin(wijk);
+    utb = uijk.Cross(uij);
+    // bijk = tij + utb * ( uik.Dot( tik - tij)) * pow( sin( wijk), -1.0f);
+    bijk = tij + utb * (uik.Dot(tik - tij) / sin(wijk));
+    // hijk = pow( pow( ri + rp, 2.0f) - pow( ( bijk - ai).Length(), 2.0f), 0.5f);
+    hijk = pow((ri + rp) * (ri + rp) - ((bijk - ai).Length()) * ((bijk - ai).Length()), 0.5f);
+    pijk1 = bijk + uijk * hijk * factor;
+
+    // pointer to a dual face of the new face
+    RSFace* dualFace = NULL;
+    // store the attributes of the new face
+    std::vector<RSVertex*> vertsNewFace;
+    vertsNewFace.push_back(edge->GetVertex1());
+    if (edge->GetVertex2()->GetIndex() < edge->GetVertex1()->GetIndex())
+        vertsNewFace.insert(vertsNewFace.begin(), edge->GetVertex2());
+    else
+        vertsNewFace.push_back(edge->GetVertex2());
+    if (pivot.Vertex->GetIndex() < vertsNewFace[0]->GetIndex()) {
+        vertsNewFace.insert(vertsNewFace.begin(), pivot.Vertex);
+    } else {
+        if (pivot.Vertex->GetIndex() < vertsNewFace[1]->GetIndex())
+            vertsNewFace.insert(vertsNewFace.begin() + 1, pivot.Vertex);
         else
-            vertsNewFace.push_back(edge->GetVertex2());
-        if (this->vicinity[result]->GetIndex() < vertsNewFace[0]->GetIndex()) {
-            vertsNewFace.insert(vertsNewFace.begin(), this->vicinity[result]);
-        } else {
-            if (this->vicinity[result]->GetIndex() < vertsNewFace[1]->GetIndex())
-                vertsNewFace.insert(vertsNewFace.begin() + 1, this->vicinity[result]);
-            else
-                vertsNewFace.push_back(this->vicinity[result]);
-        }
-        vislib::math::Vector<float, 3> normalNewFace = uijk * factor;
-        vislib::math::Vector<float, 3> probeCenterNewFace = pijk1;
-        // create first RS-edge
-        RSEdge* tmpEdge1 = new RSEdge(edge->GetVertex1(), this->vicinity[result], tik, rik);
-        std::vector<RSEdge*> index1, index2;
-        RSFace* face = NULL;
-        for (cnt = 0; cnt < this->vicinity[result]->GetEdgeCount(); ++cnt) {
-            if (*(this->vicinity[result]->GetEdge(cnt)) == *tmpEdge1) {
-                index1.push_back(this->vicinity[result]->GetEdge(cnt));
-            }
+            vertsNewFace.push_back(pivot.Vertex);
+    }
+    vislib::math::Vector<float, 3> normalNewFace = uijk * factor;
+    vislib::math::Vector<float, 3> probeCenterNewFace = pijk1;
+    // create first RS-edge
+    RSEdge* tmpEdge1 = new RSEdge(edge->GetVertex1(), pivot.Vertex, tik, rik);
+    std::vector<RSEdge*> index1, index2;
+    RSFace* face = NULL;
+    for (cnt = 0; cnt < pivot.Vertex->GetEdgeCount(); ++cnt) {
+        if (*(pivot.Vertex->GetEdge(cnt)) == *tmpEdge1) {
+            index1.push_back(pivot.Vertex->GetEdge(cnt));
         }
+    }
 
-        // check, if this face already exists for edge 1
-        for (cnt = 0; cnt < index1.size(); ++cnt) {
-            if (index1[cnt]->GetFace1()->GetVertex1() == vertsNewFace[0] &&
-                index1[cnt]->GetFace1()->GetVertex2() == vertsNewFace[1] &&
-                index1[cnt]->GetFace1()->GetVertex3() == vertsNewFace[2]) {
-                if ((index1[cnt]->GetFace1()->GetFaceNormal() - normalNewFace).Length() < this->epsilon)
-                    face = index1[cnt]->GetFace1();
+    // check, if this face already exists for edge 1
+    for (cnt = 0; cnt < index1.size(); ++cnt) {
+        if (index1[cnt]->GetFace1()->GetVertex1() == vertsNewFace[0] &&
+            index1[cnt]->GetFace1()->GetVertex2() == vertsNewFace[1] &&
+            index1[cnt]->GetFace1()->GetVertex3() == vertsNewFace[2]) {
+            if ((index1[cnt]->GetFace1()->GetFaceNormal() - normalNewFace).Length() < this->epsilon)
+                face = index1[cnt]->GetFace1();
+            else
+                dualFace = index1[cnt]->GetFace1();
+        } else if (index1[cnt]->GetFace2() != NULL) {
+            if (index1[cnt]->GetFace2()->GetVertex1() == vertsNewFace[0] &&
+                index1[cnt]->GetFace2()->GetVertex2() == vertsNewFace[1] &&
+                index1[cnt]->GetFace2()->GetVertex3() == vertsNewFace[2]) {
+                if ((index1[cnt]->GetFace2()->GetFaceNormal() - normalNewFace).Length() < this->epsilon)
+                    face = index1[cnt]->GetFace2();
                 else
-                    dualFace = index1[cnt]->GetFace1();
-            } else if (index1[cnt]->GetFace2() != NULL) {
-                if (index1[cnt]->GetFace2()->GetVertex1() == vertsNewFace[0] &&
-                    index1[cnt]->GetFace2()->GetVertex2() == vertsNewFace[1] &&
-                    index1[cnt]->GetFace2()->GetVertex3() == vertsNewFace[2]) {
-                    if ((index1[cnt]->GetFace2()->GetFaceNormal() - normalNewFace).Length() < this->epsilon)
-                        face = index1[cnt]->GetFace2();
-                    else
-                        dualFace = index1[cnt]->GetFace2();
-                }
+                    dualFace = index1[cnt]->GetFace2();
             }
         }
-        // create second RS-edge
-        RSEdge* tmpEdge2 = new RSEdge(edge->GetVertex2(), this->vicinity[result], tjk, rjk);
-        for (cnt = 0; cnt < this->vicinity[result]->GetEdgeCount(); ++cnt) {
-            if (*(this->vicinity[result]->GetEdge(cnt)) == *tmpEdge2) {
-                index2.push_back(this->vicinity[result]->GetEdge(cnt));
-            }
+    }
+    // create second RS-edge
+    RSEdge* tmpEdge2 = new RSEdge(edge->GetVertex2(), pivot.Vertex, tjk, rjk);
+    for (cnt = 0; cnt < pivot.Vertex->GetEdgeCount(); ++cnt) {
+        if (*(pivot.Vertex->GetEdge(cnt)) == *tmpEdge2) {
+            index2.push_back(pivot.Vertex->GetEdge(cnt));
         }
-        // check, if this face already exists for edge 2
-        for (cnt = 0; cnt < index2.size(); ++cnt) {
-            if (index2[cnt]->GetFace1()->GetVertex1() == vertsNewFace[0] &&
-                index2[cnt]->GetFace1()->GetVertex2() == vertsNewFace[1] &&
-                index2[cnt]->GetFace1()->GetVertex3() == vertsNewFace[2]) {
-                if ((index2[cnt]->GetFace1()->GetFaceNormal() - normalNewFace).Length() < this->epsilon)
-                    face = index2[cnt]->GetFace1();
+    }
+    // check, if this face already exists for edge 2
+    for (cnt = 0; cnt < index2.size(); ++cnt) {
+        if (index2[cnt]->GetFace1()->GetVertex1() == vertsNewFace[0] &&
+            index2[cnt]->GetFace1()->GetVertex2() == vertsNewFace[1] &&
+            index2[cnt]->GetFace1()->GetVertex3() == vertsNewFace[2]) {
+            if ((index2[cnt]->GetFace1()->GetFaceNormal() - normalNewFace).Length() < this->epsilon)
+                face = index2[cnt]->GetFace1();
+            else
+                dualFace = index2[cnt]->GetFace1();
+        } else if (index2[cnt]->GetFace2() != NULL) {
+            if (index2[cnt]->GetFace2()->GetVertex1() == vertsNewFace[0] &&
+                index2[cnt]->GetFace2()->GetVertex2() == vertsNewFace[1] &&
+                index2[cnt]->GetFace2()->GetVertex3() == vertsNewFace[2]) {
+                if ((index2[cnt]->GetFace2()->GetFaceNormal() - normalNewFace).Length() < this->epsilon)
+                    face = index2[cnt]->GetFace2();
                 else
-                    dualFace = index2[cnt]->GetFace1();
-            } else if (index2[cnt]->GetFace2() != NULL) {
-                if (index2[cnt]->GetFace2()->GetVertex1() == vertsNewFace[0] &&
-                    index2[cnt]->GetFace2()->GetVertex2() == vertsNewFace[1] &&
-                    index2[cnt]->GetFace2()->GetVertex3() == vertsNewFace[2]) {
-                    if ((index2[cnt]->GetFace2()->GetFaceNormal() - normalNewFace).Length() < this->epsilon)
-                        face = index2[cnt]->GetFace2();
-                    else
-                        dualFace = index2[cnt]->GetFace2();
-                }
+                    dualFace = index2[cnt]->GetFace2();
             }
         }
+    }
 
-        // the new face is NOT already existing:
-        if (face == NULL) {
-            // add the first temporary edge to the edge list and to its vertices
-            this->rsEdge.push_back(tmpEdge1);
-            tmpEdge1->GetVertex1()->AddEdge(tmpEdge1);
-            tmpEdge1->GetVertex2()->AddEdge(tmpEdge1);
-            // add the second temporary edge to the edge list and to its vertices
-            this->rsEdge.push_back(tmpEdge2);
-            tmpEdge2->GetVertex1()->AddEdge(tmpEdge2);
-            tmpEdge2->GetVertex2()->AddEdge(tmpEdge2);
-            // create new RS-face
-            face = new RSFace(vertsNewFace[0], vertsNewFace[1], vertsNewFace[2], edge, tmpEdge1, tmpEdge2,
-                normalNewFace, probeCenterNewFace);
-            this->rsFace.push_back(face);
-            // add new RS-face to its edges
-            edge->SetRSFace(face);
-            tmpEdge1->SetRSFace(face);
-            tmpEdge2->SetRSFace(face);
-            if (dualFace != NULL) {
-                dualFace->SetDualFace(face);
-                face->SetDualFace(dualFace);
+    // the new face is NOT already existing:
+    if (face == NULL) {
+        // add the first temporary edge to the edge list and to its vertices
+        this->rsEdge.push_back(tmpEdge1);
+        tmpEdge1->GetVertex1()->AddEdge(tmpEdge1);
+        tmpEdge1->GetVertex2()->AddEdge(tmpEdge1);
+        // add the second temporary edge to the edge list and to its vertices
+        this->rsEdge.push_back(tmpEdge2);
+        tmpEdge2->GetVertex1()->AddEdge(tmpEdge2);
+        tmpEdge2->GetVertex2()->AddEdge(tmpEdge2);
+        // create new RS-face
+        face = new RSFace(vertsNewFace[0], vertsNewFace[1], vertsNewFace[2], edge, tmpEdge1, tmpEdge2,
+            normalNewFace, probeCenterNewFace);
+        this->rsFace.push_back(face);
+        // add new RS-face to its edges
+        edge->SetRSFace(face);
+        tmpEdge1->SetRSFace(face);
+        tmpEdge2->SetRSFace(face);
+        if (dualFace != NULL) {
+            dualFace->SetDualFace(face);
+            face->SetDualFace(dualFace);
+        }
+        // add probe position to voxel map cell
+        const vislib::math::Vector<unsigned int, 3> probeCell = this->ComputeVoxelCell(probeCenterNewFace);
+        face->SetProbeIndex(probeCell.GetX(), probeCell.GetY(), probeCell.GetZ());
+        this->voxelMapProbes[this->VoxelIndex(probeCell)].push_back(face);
+    } else {
+        // delete temporary edges
+        delete tmpEdge1;
+        delete tmpEdge2;
+        // set the first face of the current edge as adjacent face to the already existing face
+        if (*(face->GetEdge1()) == *edge) {
+            if (face->GetEdge1()->SetRSFace(edge->GetFace1())) {
+                face->GetEdge1()->SetRotationAngle(angle * (-factor));
+                if (edge->GetFace1()->GetEdge1() == edge)
+                    edge->GetFace1()->SetEdge1(face->GetEdge1());
+                else if (edge->GetFace1()->GetEdge2() == edge)
+                    edge->GetFace1()->SetEdge2(face->GetEdge1());
+                else
+                    edge->GetFace1()->SetEdge3(face->GetEdge1());
+            } else {
+                edge->SetRSFace(face);
+                // std::cout << "error1 " << std::endl;
             }
-            // add probe position to voxel map cell
-            face->SetProbeIndex(
-                std::min((unsigned int)this->voxelMapProbes.size() - 1,
-                    (unsigned int)std::max(0, (int)floorf((probeCenterNewFace.GetX() - bBox.Left()) / voxelLength))),
-                std::min((unsigned int)this->voxelMapProbes[0].size() - 1,
-                    (unsigned int)std::max(0, (int)floorf((probeCenterNewFace.GetY() - bBox.Bottom()) / voxelLength))),
-                std::min((unsigned int)this->voxelMapProbes[0][0].size() - 1,
-                    (unsigned int)std::max(0, (int)floorf((probeCenterNewFace.GetZ() - bBox.Back()) / voxelLength))));
-            this->voxelMapProbes[face->GetProbeIndex().GetX()][face->GetProbeIndex().GetY()]
-                                [face->GetProbeIndex().GetZ()]
-                                    .push_back(face);
-        } else {
-            // delete temporary edges
-            delete tmpEdge1;
-            delete tmpEdge2;
-            // set the first face of the current edge as adjacent face to the already existing face
-            if (*(face->GetEdge1()) == *edge) {
-                if (face->GetEdge1()->SetRSFace(edge->GetFace1())) {
-                    face->GetEdge1()->SetRotationAngle(angle * (-factor));
-                    if (edge->GetFace1()->GetEdge1() == edge)
-                        edge->GetFace1()->SetEdge1(face->GetEdge1());
-                    else if (edge->GetFace1()->GetEdge2() == edge)
-                        edge->GetFace1()->SetEdge2(face->GetEdge1());
-                    else
-                        edge->GetFace1()->SetEdge3(face->GetEdge1());
-                } else {
-                    edge->SetRSFace(face);
-                    // std::cout << "error1 " << std::endl;
-                }
-            } else if (*(face->GetEdge2()) == *edge) {
-                if (face->GetEdge2()->SetRSFace(edge->GetFace1())) {
-                    face->GetEdge2()->SetRotationAngle(angle * (-factor));
-                    if (edge->GetFace1()->GetEdge1() == edge)
-                        edge->GetFace1()->SetEdge1(face->GetEdge2());
-                    else if (edge->GetFace1()->GetEdge2() == edge)
-                        edge->GetFace1()->SetEdge2(face->GetEdge2());
-                    else
-                        edge->GetFace1()->SetEdge3(face->GetEdge2());
-                } else {
-                    edge->SetRSFace(face);
-                    // std::cout << "error2 " << std::endl;
-                }
+        } else if (*(face->GetEdge2()) == *edge) {
+            if (face->GetEdge2()->SetRSFace(edge->GetFace1())) {
+                face->GetEdge2()->SetRotationAngle(angle * (-factor));
+                if (edge->GetFace1()->GetEdge1() == edge)
+                    edge->GetFace1()->SetEdge1(face->GetEdge2());
+                else if (edge->GetFace1()->GetEdge2() == edge)
+                    edge->GetFace1()->SetEdge2(face->GetEdge2());
+                else
+                    edge->GetFace1()->SetEdge3(face->GetEdge2());
             } else {
-                if (face->GetEdge3()->SetRSFace(edge->GetFace1())) {
-                    face->GetEdge3()->SetRotationAngle(angle * (-factor));
-                    if (edge->GetFace1()->GetEdge1() == edge)
-                        edge->GetFace1()->SetEdge1(face->GetEdge3());
-                    else if (edge->GetFace1()->GetEdge2() == edge)
-                        edge->GetFace1()->SetEdge2(face->GetEdge3());
-                    else
-                        edge->GetFace1()->SetEdge3(face->GetEdge3());
-                } else {
-                    edge->SetRSFace(face);
-                    // std::cout << "error3 " << std::endl;
-                }
+                edge->SetRSFace(face);
+                // std::cout << "error2 " << std::endl;
             }
-            if (dualFace != NULL) {
-                dualFace->SetDualFace(face);
-                face->SetDualFace(dualFace);
+        } else {
+            if (face->GetEdge3()->SetRSFace(edge->GetFace1())) {
+                face->GetEdge3()->SetRotationAngle(angle * (-factor));
+                if (edge->GetFace1()->GetEdge1() == edge)
+                    edge->GetFace1()->SetEdge1(face->GetEdge3());
+                else if (edge->GetFace1()->GetEdge2() == edge)
+                    edge->GetFace1()->SetEdge2(face->GetEdge3());
+                else
+                    edge->GetFace1()->SetEdge3(face->GetEdge3());
+            } else {
+                edge->SetRSFace(face);
+                // std::cout << "error3 " << std::endl;
             }
         }
+        if (dualFace != NULL) {
+            dualFace->SetDualFace(face);
+            face->SetDualFace(dualFace);
+        }
     }
 }
 
@@ -797,16 +867,9 @@ bool ReducedSurface::ComputeFirstFixedProbePos(RSVertex* vI, RSVertex* vJ, RSVer
         this->rsFace.push_back(new RSFace(vI, vJ, vK, this->rsEdge[this->rsEdge.size() - 3],
             this->rsEdge[this->rsEdge.size() - 2], this->rsEdge[this->rsEdge.size() - 1], uijk, pijk1));
         // add probe position to voxel map cell
-        this->rsFace.back()->SetProbeIndex(
-            std::min((unsigned int)this->voxelMapProbes.size() - 1,
-                (unsigned int)std::max(0, (int)floorf((pijk1.GetX() - bBox.Left()) / voxelLength))),
-            std::min((unsigned int)this->voxelMapProbes[0].size() - 1,
-                (unsigned int)std::max(0, (int)floorf((pijk1.GetY() - bBox.Bottom()) / voxelLength))),
-            std::min((unsigned int)this->voxelMapProbes[0][0].size() - 1,
-                (unsigned int)std::max(0, (int)floorf((pijk1.GetZ() - bBox.Back()) / voxelLength))));
-        this->voxelMapProbes[this->rsFace.back()->GetProbeIndex().GetX()][this->rsFace.back()->GetProbeIndex().GetY()]
-                            [this->rsFace.back()->GetProbeIndex().GetZ()]
-                                .push_back(this->rsFace.back());
+        const vislib::math::Vector<unsigned int, 3> probeCell = this->ComputeVoxelCell(pijk1);
+        this->rsFace.back()->SetProbeIndex(probeCell.GetX(), probeCell.GetY(), probeCell.GetZ());
+        this->voxelMapProbes[this->VoxelIndex(probeCell)].push_back(this->rsFace.back());
 
         this->rsEdge[this->rsEdge.size() - 3]->SetRSFace(this->rsFace.back());
         this->rsEdge[this->rsEdge.size() - 2]->SetRSFace(this->rsFace.back());
@@ -831,16 +894,9 @@ bool ReducedSurface::ComputeFirstFixedProbePos(RSVertex* vI, RSVertex* vJ, RSVer
         this->rsFace.push_back(new RSFace(vI, vJ, vK, this->rsEdge[this->rsEdge.size() - 3],
             this->rsEdge[this->rsEdge.size() - 2], this->rsEdge[this->rsEdge.size() - 1], uijk * (-1.0f), pijk2));
         // add probe position to voxel map cell
-        this->rsFace.back()->SetProbeIndex(
-            std::min((unsigned int)this->voxelMapProbes.size() - 1,
-                (unsigned int)std::max(0, (int)floorf((pijk2.GetX() - bBox.Left()) / voxelLength))),
-            std::min((unsigned int)this->voxelMapProbes[0].size() - 1,
-                (unsigned int)std::max(0, (int)floorf((pijk2.GetY() - bBox.Bottom()) / voxelLength))),
-            std::min((unsigned int)this->voxelMapProbes[0][0].size() - 1,
-                (unsigned int)std::max(0, (int)floorf((pijk2.GetZ() - bBox.Back()) / voxelLength))));
-        this->voxelMapProbes[this->rsFace.back()->GetProbeIndex().GetX()][this->rsFace.back()->GetProbeIndex().GetY()]
-                            [this->rsFace.back()->GetProbeIndex().GetZ()]
-                                .push_back(this->rsFace.back());
+        const vislib::math::Vector<unsigned int, 3> probeCell = this->ComputeVoxelCell(pijk2);
+        this->rsFace.back()->SetProbeIndex(probeCell.GetX(), probeCell.GetY(), probeCell.GetZ());
+        this->voxelMapProbes[this->VoxelIndex(probeCell)].push_back(this->rsFace.back());
 
         this->rsEdge[this->rsEdge.size() - 3]->SetRSFace(this->rsFace.back());
         this->rsEdge[this->rsEdge.size() - 2]->SetRSFace(this->rsFace.back());
@@ -853,121 +909,101 @@ bool ReducedSurface::ComputeFirstFixedProbePos(RSVertex* vI, RSVertex* vJ, RSVer
 }
 
 
+/*
+ * Compute the voxel map cell of a position
+ */
+vislib::math::Vector<unsigned int, 3> ReducedSurface::ComputeVoxelCell(
+    const vislib::math::Vector<float, 3>& pos) const {
+    return vislib::math::Vector<unsigned int, 3>(
+        std::min(this->voxelMapRes.GetX() - 1,
+            (unsigned int)std::max(0, (int)floorf((pos.GetX() - this->bBox.Left()) / this->voxelLength))),
+        std::min(this->voxelMapRes.GetY() - 1,
+            (unsigned int)std::max(0, (int)floorf((pos.GetY() - this->bBox.Bottom()) / this->voxelLength))),
+        std::min(this->voxelMapRes.GetZ() - 1,
+            (unsigned int)std::max(0, (int)floorf((pos.GetZ() - this->bBox.Back()) / this->voxelLength))));
+}
+
+
+/*
+ * Compute the range of voxel map cells around a position
+ */
+void ReducedSurface::ComputeVoxelRange(const vislib::math::Vector<float, 3>& pos,
+    vislib::math::Vector<unsigned int, 3>& first, vislib::math::Vector<unsigned int, 3>& last) const {
+    const vislib::math::Vector<unsigned int, 3> cell = this->ComputeVoxelCell(pos);
+    for (unsigned int i = 0; i < 3; ++i) {
+        first[i] = (cell[i] > 0) ? (cell[i] - 1) : 0;
+        last[i] = std::min(cell[i] + 1, this->voxelMapRes[i] - 1);
+    }
+}
+
+
 /*
  * Compute vicinity for an atom at position 'm' with radius 'rad'
- * TODO: this could be implemented faster!!!
  */
 void ReducedSurface::ComputeVicinity(vislib::math::Vector<float, 3> m, float rad) {
-    unsigned int cnt, xId, yId, zId, maxXId, maxYId, maxZId;
-    // maxXId = (unsigned int)floorf( this->bBox.Width() / this->voxelLength);
-    // maxYId = (unsigned int)floorf( this->bBox.Height() / this->voxelLength);
-    // maxZId = (unsigned int)floorf( this->bBox.Depth() / this->voxelLength);
-    maxXId = (unsigned int)this->voxelMap.size() - 1;
-    maxYId = (unsigned int)this->voxelMap[0].size() - 1;
-    maxZId = (unsigned int)this->voxelMap[0][0].size() - 1;
-    int cntX, cntY, cntZ;
-
-    xId = (unsigned int)std::max(0, (int)floorf((m.GetX() - bBox.Left()) / voxelLength));
-    xId = (unsigned int)std::min(maxXId, xId);
-    yId = (unsigned int)std::max(0, (int)floorf((m.GetY() - bBox.Bottom()) / voxelLength));
-    yId = (unsigned int)std::min(maxYId, yId);
-    zId = (unsigned int)std::max(0, (int)floorf((m.GetZ() - bBox.Back()) / voxelLength));
-    zId = (unsigned int)std::min(maxZId, zId);
+    vislib::math::Vector<unsigned int, 3> first, last;
+    unsigned int cnt, x, y, z;
+    this->ComputeVoxelRange(m, first, last);
 
     float distance;
-    // float threshold;
     // clear old vicinity indices
     this->vicinity.clear();
     // loop over all atoms to find vicinity
-    for (cntX = ((xId > 0) ? (-1) : 0); cntX < ((xId < maxXId) ? 2 : 1); ++cntX) {
-        for (cntY = ((yId > 0) ? (-1) : 0); cntY < ((yId < maxYId) ? 2 : 1); ++cntY) {
-            for (cntZ = ((zId > 0) ? (-1) : 0); cntZ < ((zId < maxZId) ? 2 : 1); ++cntZ) {
-                for (cnt = 0; cnt < this->voxelMap[xId + cntX][yId + cntY][zId + cntZ].size(); ++cnt) {
+    for (x = first.GetX(); x <= last.GetX(); ++x) {
+        for (y = first.GetY(); y <= last.GetY(); ++y) {
+            for (z = first.GetZ(); z <= last.GetZ(); ++z) {
+                const std::vector<RSVertex*>& voxel = this->voxelMap[this->VoxelIndex(x, y, z)];
+                for (cnt = 0; cnt < voxel.size(); ++cnt) {
                     // compute distance
-                    distance = (this->voxelMap[xId + cntX][yId + cntY][zId + cntZ][cnt]->GetPosition() - m).Length();
+                    distance = (voxel[cnt]->GetPosition() - m).Length();
                     // don't check self --> continue if distance is zero
                     if (distance < epsilon)
                         continue;
-                    // compute threshold
-                    // threshold = this->voxelMap[xId+cntX][yId+cntY][zId+cntZ][cnt]->GetRadius() + rad
-                    // + 2.0f*this->probeRadius;
-                    // if distance < threshold --> add atom 'cnt' to vicinity
-                    // if( distance <= threshold )
-                    //{
-                    //    this->vicinity.push_back( this->voxelMap[xId+cntX][yId+cntY][zId+cntZ][cnt]);
-                    //}
-                    this->vicinity.push_back(this->voxelMap[xId + cntX][yId + cntY][zId + cntZ][cnt]);
+                    this->vicinity.push_back(voxel[cnt]);
                 }
             }
         }
     }
-    /*
-    unsigned int cnt;
-    float distance, threshold;
-    // clear old vicinity indices
-    this->vicinity.clear();
-    // loop over all atoms to find vicinity
-    for( cnt = 0; cnt < this->rsVertex.size(); cnt++ )
-    {
-            // compute distance
-            distance = (this->rsVertex[cnt]->GetPosition() - m).Length();
-            // don't check self --> continue if distance is zero
-            if( distance < epsilon ) continue;
-            // compute threshold
-            threshold = this->rsVertex[cnt]->GetRadius() + rad + 2.0f*this->probeRadius;
-            // if distance < threshold --> add atom 'cnt' to vicinity
-            if( distance <= threshold )
-            {
-                    this->vicinity.push_back( cnt);
-            }
-    }
-    */
 }
 
 
 /*
  * Compute vicinity for the torus around edge 'idx'
- * TODO: this could be implemented faster!!!
  */
 void ReducedSurface::ComputeVicinityEdge(RSEdge* edge) {
-    unsigned int cnt, xId, yId, zId, maxXId, maxYId, maxZId;
+    this->ComputeVicinityEdge(edge, this->vicinity);
+}
 
-    maxXId = (unsigned int)this->voxelMap.size() - 1;
-    maxYId = (unsigned int)this->voxelMap[0].size() - 1;
-    maxZId = (unsigned int)this->voxelMap[0][0].size() - 1;
-    int cntX, cntY, cntZ;
 
-    xId = std::min(
-        maxXId, (unsigned int)std::max(0, (int)floorf((edge->GetTorusCenter().GetX() - bBox.Left()) / voxelLength)));
-    yId = std::min(
-        maxYId, (unsigned int)std::max(0, (int)floorf((edge->GetTorusCenter().GetY() - bBox.Bottom()) / voxelLength)));
-    zId = std::min(
-        maxZId, (unsigned int)std::max(0, (int)floorf((edge->GetTorusCenter().GetZ() - bBox.Back()) / voxelLength)));
+/*
+ * Compute vicinity for the torus around edge 'idx'
+ */
+void ReducedSurface::ComputeVicinityEdge(const RSEdge* edge, std::vector<RSVertex*>& result) const {
+    vislib::math::Vector<unsigned int, 3> first, last;
+    unsigned int cnt, x, y, z;
+    this->ComputeVoxelRange(edge->GetTorusCenter(), first, last);
 
     float distance, threshold;
     // clear old vicinity indices
-    this->vicinity.clear();
+    result.clear();
     // loop over all atoms to find vicinity
-    for (cntX = ((xId > 0) ? (-1) : 0); cntX < ((xId < maxXId) ? 2 : 1); ++cntX) {
-        for (cntY = ((yId > 0) ? (-1) : 0); cntY < ((yId < maxYId) ? 2 : 1); ++cntY) {
-            for (cntZ = ((zId > 0) ? (-1) : 0); cntZ < ((zId < maxZId) ? 2 : 1); ++cntZ) {
-                for (cnt = 0; cnt < this->voxelMap[xId + cntX][yId + cntY][zId + cntZ].size(); ++cnt) {
+    for (x = first.GetX(); x <= last.GetX(); ++x) {
+        for (y = first.GetY(); y <= last.GetY(); ++y) {
+            for (z = first.GetZ(); z <= last.GetZ(); ++z) {
+                const std::vector<RSVertex*>& voxel = this->voxelMap[this->VoxelIndex(x, y, z)];
+                for (cnt = 0; cnt < voxel.size(); ++cnt) {
                     // don't check vertices of the edge --> continue
-                    if (*(this->voxelMap[xId + cntX][yId + cntY][zId + cntZ][cnt]) == *(edge->GetVertex1()) ||
-                        *(this->voxelMap[xId + cntX][yId + cntY][zId + cntZ][cnt]) == *(edge->GetVertex2()))
+                    if (*(voxel[cnt]) == *(edge->GetVertex1()) || *(voxel[cnt]) == *(edge->GetVertex2()))
                         continue;
                     // --> the following is not necessary, because real vicinity is checked when RS-face is computed
                     // --> but it results in a considerable speedup!
                     // compute distance
-                    distance = (this->voxelMap[xId + cntX][yId + cntY][zId + cntZ][cnt]->GetPosition() -
-                                edge->GetTorusCenter())
-                                   .Length();
+                    distance = (voxel[cnt]->GetPosition() - edge->GetTorusCenter()).Length();
                     // compute threshold
-                    threshold = this->voxelMap[xId + cntX][yId + cntY][zId + cntZ][cnt]->GetRadius() +
-                                edge->GetTorusRadius() + this->probeRadius;
+                    threshold = voxel[cnt]->GetRadius() + edge->GetTorusRadius() + this->probeRadius;
                     // if distance < threshold --> add atom 'cnt' to vicinity
                     if (distance <= threshold) {
-                        this->vicinity.push_back(this->voxelMap[xId + cntX][yId + cntY][zId + cntZ][cnt]);
+                        result.push_back(voxel[cnt]);
                     }
                 }
             }
@@ -978,46 +1014,31 @@ void ReducedSurface::ComputeVicinityEdge(RSEdge* edge) {
 
 /*
  * Compute vicinity for atom 'idx'
- * TODO: this could be implemented faster!!!
  */
 void ReducedSurface::ComputeVicinityVertex(RSVertex* vertex) {
-    unsigned int cnt, xId, yId, zId, maxXId, maxYId, maxZId;
-    // maxXId = (unsigned int)floorf( this->bBox.Width() / this->voxelLength);
-    // maxYId = (unsigned int)floorf( this->bBox.Height() / this->voxelLength);
-    // maxZId = (unsigned int)floorf( this->bBox.Depth() / this->voxelLength);
-    maxXId = (unsigned int)this->voxelMap.size() - 1;
-    maxYId = (unsigned int)this->voxelMap[0].size() - 1;
-    maxZId = (unsigned int)this->voxelMap[0][0].size() - 1;
-    int cntX, cntY, cntZ;
-
-    xId = (unsigned int)std::max(0, (int)floorf((vertex->GetPosition().GetX() - bBox.Left()) / voxelLength));
-    xId = (unsigned int)std::min(maxXId, xId);
-    yId = (unsigned int)std::max(0, (int)floorf((vertex->GetPosition().GetY() - bBox.Bottom()) / voxelLength));
-    yId = (unsigned int)std::min(maxYId, yId);
-    zId = (unsigned int)std::max(0, (int)floorf((vertex->GetPosition().GetZ() - bBox.Back()) / voxelLength));
-    zId = (unsigned int)std::min(maxZId, zId);
+    vislib::math::Vector<unsigned int, 3> first, last;
+    unsigned int cnt, x, y, z;
+    this->ComputeVoxelRange(vertex->GetPosition(), first, last);
 
     float distance, threshold;
     // clear old vicinity indices
     this->vicinity.clear();
     // loop over all atoms to find vicinity
-    for (cntX = ((xId > 0) ? (-1) : 0); cntX < ((xId < maxXId) ? 2 : 1); ++cntX) {
-        for (cntY = ((yId > 0) ? (-1) : 0); cntY < ((yId < maxYId) ? 2 : 1); ++cntY) {
-            for (cntZ = ((zId > 0) ? (-1) : 0); cntZ < ((zId < maxZId) ? 2 : 1); ++cntZ) {
-                for (cnt = 0; cnt < this->voxelMap[xId + cntX][yId + cntY][zId + cntZ].size(); ++cnt) {
-                    // don't check vertices of the edge --> continue
-                    if (this->voxelMap[xId + cntX][yId + cntY][zId + cntZ][cnt]->GetIndex() == vertex->GetIndex())
+    for (x = first.GetX(); x <= last.GetX(); ++x) {
+        for (y = first.GetY(); y <= last.GetY(); ++y) {
+            for (z = first.GetZ(); z <= last.GetZ(); ++z) {
+                const std::vector<RSVertex*>& voxel = this->voxelMap[this->VoxelIndex(x, y, z)];
+                for (cnt = 0; cnt < voxel.size(); ++cnt) {
+                    // don't check the vertex itself --> continue
+                    if (voxel[cnt]->GetIndex() == vertex->GetIndex())
                         continue;
                     // compute distance
-                    distance =
-                        (this->voxelMap[xId + cntX][yId + cntY][zId + cntZ][cnt]->GetPosition() - vertex->GetPosition())
-                            .Length();
+                    distance = (voxel[cnt]->GetPosition() - vertex->GetPosition()).Length();
                     // compute threshold
-                    threshold = this->voxelMap[xId + cntX][yId + cntY][zId + cntZ][cnt]->GetRadius() +
-                                vertex->GetRadius() + 2.0f * this->probeRadius;
+                    threshold = voxel[cnt]->GetRadius() + vertex->GetRadius() + 2.0f * this->probeRadius;
                     // if distance < threshold --> add atom 'cnt' to vicinity
                     if (distance <= threshold) {
-                        this->vicinity.push_back(this->voxelMap[xId + cntX][yId + cntY][zId + cntZ][cnt]);
+                        this->vicinity.push_back(voxel[cnt]);
                     }
                 }
             }
@@ -1030,58 +1051,8 @@ void ReducedSurface::ComputeVicinityVertex(RSVertex* vertex) {
  * Get the positions of all probes which cut a specific RS-edge.
  */
 std::vector<ReducedSurface::RSFace*> ReducedSurface::GetProbesCutEdge(RSEdge* edge) {
-    unsigned int cnt, xId, yId, zId, maxXId, maxYId, maxZId;
-    // maxXId = (unsigned int)floorf( this->bBox.Width() / this->voxelLength);
-    // maxYId = (unsigned int)floorf( this->bBox.Height() / this->voxelLength);
-    // maxZId = (unsigned int)floorf( this->bBox.Depth() / this->voxelLength);
-    maxXId = (unsigned int)this->voxelMapProbes.size() - 1;
-    maxYId = (unsigned int)this->voxelMapProbes[0].size() - 1;
-    maxZId = (unsigned int)this->voxelMapProbes[0][0].size() - 1;
-    int cntX, cntY, cntZ;
-
-    vislib::math::Vector<float, 3> v1, v2, center, probe, dir21;
-    // first vertex of the edge
-    v1 = edge->GetVertex1()->GetPosition();
-    // second vertex of the edge
-    v2 = edge->GetVertex2()->GetPosition();
-    // center of the edge
-    dir21 = v1 - v2;
-    center = dir21 / 2.0f + v2;
-    // normalize dir21
-    dir21.Normalise();
-    // compute voxel indices for edge center
-    xId = std::min((unsigned int)std::max(0, (int)floorf((center.GetX() - bBox.Left()) / voxelLength)), maxXId);
-    yId = std::min((unsigned int)std::max(0, (int)floorf((center.GetY() - bBox.Bottom()) / voxelLength)), maxYId);
-    zId = std::min((unsigned int)std::max(0, (int)floorf((center.GetZ() - bBox.Back()) / voxelLength)), maxZId);
-
-    float dist1, dist2, edgeLen, lenH;
-    edgeLen = (v1 - v2).Length();
-    // clear old vicinity indices
     std::vector<RSFace*> cuttingProbes;
-    cuttingProbes.clear();
-    // loop over all atoms to find vicinity
-    for (cntX = ((xId > 0) ? (-1) : 0); cntX < ((xId < maxXId) ? 2 : 1); ++cntX) {
-        for (cntY = ((yId > 0) ? (-1) : 0); cntY < ((yId < maxYId) ? 2 : 1); ++cntY) {
-            for (cntZ = ((zId > 0) ? (-1) : 0); cntZ < ((zId < maxZId) ? 2 : 1); ++cntZ) {
-                for (cnt = 0; cnt < this->voxelMapProbes[xId + cntX][yId + cntY][zId + cntZ].size(); ++cnt) {
-                    probe = this->voxelMapProbes[xId + cntX][yId + cntY][zId + cntZ][cnt]->GetProbeCenter();
-                    // distances between probe and edges
-                    dist1 = (probe - v1).Length();
-                    dist2 = (probe - v2).Length();
-                    // compute the height
-                    lenH = (probe - v2).Dot(dir21);
-                    // if base of height is not on edge, the probe does not cut the edge
-                    if (lenH >= edgeLen || lenH <= 0.0f)
-                        continue;
-                    // if the height is larger than the probe radius, the probe does not cut the edge
-                    if ((dir21 * lenH + v2 - probe).Length() > this->probeRadius)
-                        continue;
-                    // add probe to the list of cutting probes
-                    cuttingProbes.push_back(this->voxelMapProbes[xId + cntX][yId + cntY][zId + cntZ][cnt]);
-                }
-            }
-        }
-    }
+    this->ComputeProbesCutEdge(edge, cuttingProbes);
     return cuttingProbes;
 }
 
@@ -1090,14 +1061,16 @@ std::vector<ReducedSurface::RSFace*> ReducedSurface::GetProbesCutEdge(RSEdge* ed
  * Write the positions of all probes which cut a specific RS-edge.
  */
 void ReducedSurface::WriteProbesCutEdge(RSEdge* edge) {
-    unsigned int cnt, xId, yId, zId, maxXId, maxYId, maxZId;
-    // maxXId = (unsigned int)floorf( this->bBox.Width() / this->voxelLength);
-    // maxYId = (unsigned int)floorf( this->bBox.Height() / this->voxelLength);
-    // maxZId = (unsigned int)floorf( this->bBox.Depth() / this->voxelLength);
-    maxXId = (unsigned int)this->voxelMapProbes.size() - 1;
-    maxYId = (unsigned int)this->voxelMapProbes[0].size() - 1;
-    maxZId = (unsigned int)this->voxelMapProbes[0][0].size() - 1;
-    int cntX, cntY, cntZ;
+    this->ComputeProbesCutEdge(edge, edge->cuttingProbes);
+}
+
+
+/*
+ * Compute the positions of all probes which cut a specific RS-edge.
+ */
+void ReducedSurface::ComputeProbesCutEdge(const RSEdge* edge, std::vector<RSFace*>& result) const {
+    vislib::math::Vector<unsigned int, 3> first, last;
+    unsigned int cnt, x, y, z;
 
     vislib::math::Vector<float, 3> v1, v2, center, probe, dir21;
     // first vertex of the edge
@@ -1110,23 +1083,19 @@ void ReducedSurface::WriteProbesCutEdge(RSEdge* edge) {
     // normalize dir21
     dir21.Normalise();
     // compute voxel indices for edge center
-    xId = std::min((unsigned int)std::max(0, (int)floorf((center.GetX() - bBox.Left()) / voxelLength)), maxXId);
-    yId = std::min((unsigned int)std::max(0, (int)floorf((center.GetY() - bBox.Bottom()) / voxelLength)), maxYId);
-    zId = std::min((unsigned int)std::max(0, (int)floorf((center.GetZ() - bBox.Back()) / voxelLength)), maxZId);
+    this->ComputeVoxelRange(center, first, last);
 
-    float dist1, dist2, edgeLen, lenH;
+    float edgeLen, lenH;
     edgeLen = (v1 - v2).Length();
-    // clear old vicinity indices
-    edge->cuttingProbes.clear();
-    // loop over all atoms to find vicinity
-    for (cntX = ((xId > 0) ? (-1) : 0); cntX < ((xId < maxXId) ? 2 : 1); ++cntX) {
-        for (cntY = ((yId > 0) ? (-1) : 0); cntY < ((yId < maxYId) ? 2 : 1); ++cntY) {
-            for (cntZ = ((zId > 0) ? (-1) : 0); cntZ < ((zId < maxZId) ? 2 : 1); ++cntZ) {
-                for (cnt = 0; cnt < this->voxelMapProbes[xId + cntX][yId + cntY][zId + cntZ].size(); ++cnt) {
-                    probe = this->voxelMapProbes[xId + cntX][yId + cntY][zId + cntZ][cnt]->GetProbeCenter();
-                    // distances between probe and edges
-                    dist1 = (probe - v1).Length();
-                    dist2 = (probe - v2).Length();
+    // clear old probes
+    result.clear();
+    // loop over all probes to find the cutting ones
+    for (x = first.GetX(); x <= last.GetX(); ++x) {
+        for (y = first.GetY(); y <= last.GetY(); ++y) {
+            for (z = first.GetZ(); z <= last.GetZ(); ++z) {
+                const std::vector<RSFace*>& voxel = this->voxelMapProbes[this->VoxelIndex(x, y, z)];
+                for (cnt = 0; cnt < voxel.size(); ++cnt) {
+                    probe = voxel[cnt]->GetProbeCenter();
                     // compute the height
                     lenH = (probe - v2).Dot(dir21);
                     // if base of height is not on edge, the probe does not cut the edge
@@ -1136,7 +1105,7 @@ void ReducedSurface::WriteProbesCutEdge(RSEdge* edge) {
                     if ((dir21 * lenH + v2 - probe).Length() > this->probeRadius)
                         continue;
                     // add probe to the list of cutting probes
-                    edge->cuttingProbes.push_back(this->voxelMapProbes[xId + cntX][yId + cntY][zId + cntZ][cnt]);
+                    result.push_back(voxel[cnt]);
                 }
             }
         }
@@ -1148,39 +1117,40 @@ void ReducedSurface::WriteProbesCutEdge(RSEdge* edge) {
  * Search all RS-faces whose probe is cut by the given RS-vertex.
  */
 void ReducedSurface::ComputeProbeCutVertex(RSVertex* vertex) {
-    unsigned int cnt, xId, yId, zId, maxXId, maxYId, maxZId;
-    // maxXId = (unsigned int)floorf( this->bBox.Width() / this->voxelLength);
-    // maxYId = (unsigned int)floorf( this->bBox.Height() / this->voxelLength);
-    // maxZId = (unsigned int)floorf( this->bBox.Depth() / this->voxelLength);
-    maxXId = (unsigned int)this->voxelMap.size() - 1;
-    maxYId = (unsigned int)this->voxelMap[0].size() - 1;
-    maxZId = (unsigned int)this->voxelMap[0][0].size() - 1;
-    int cntX, cntY, cntZ;
+    this->ComputeProbeCutVertex(vertex, this->cutFaces);
+}
+
+
+/*
+ * Search all RS-faces whose probe is cut by the given RS-vertex.
+ */
+void ReducedSurface::ComputeProbeCutVertex(RSVertex* vertex, std::vector<RSFace*>& result) const {
+    vislib::math::Vector<unsigned int, 3> first, last;
+    unsigned int cnt, x, y, z;
 
     vislib::math::Vector<float, 3> v1, probe;
-    // first vertex of the edge
+    // position of the vertex
     v1 = vertex->GetPosition();
-    // compute voxel indices for edge center
-    xId = std::min((unsigned int)std::max(0, (int)floorf((v1.GetX() - bBox.Left()) / voxelLength)), maxXId);
-    yId = std::min((unsigned int)std::max(0, (int)floorf((v1.GetY() - bBox.Bottom()) / voxelLength)), maxYId);
-    zId = std::min((unsigned int)std::max(0, (int)floorf((v1.GetZ() - bBox.Back()) / voxelLength)), maxZId);
+    // compute voxel indices for the vertex
+    this->ComputeVoxelRange(v1, first, last);
 
     float dist;
     // clear old face list
-    this->cutFaces.clear();
-    // loop over all atoms to find vicinity
-    for (cntX = ((xId > 0) ? (-1) : 0); cntX < ((xId < maxXId) ? 2 : 1); ++cntX) {
-        for (cntY = ((yId > 0) ? (-1) : 0); cntY < ((yId < maxYId) ? 2 : 1); ++cntY) {
-            for (cntZ = ((zId > 0) ? (-1) : 0); cntZ < ((zId < maxZId) ? 2 : 1); ++cntZ) {
-                for (cnt = 0; cnt < this->voxelMapProbes[xId + cntX][yId + cntY][zId + cntZ].size(); ++cnt) {
+    result.clear();
+    // loop over all probes to find the cut ones
+    for (x = first.GetX(); x <= last.GetX(); ++x) {
+        for (y = first.GetY(); y <= last.GetY(); ++y) {
+            for (z = first.GetZ(); z <= last.GetZ(); ++z) {
+                const std::vector<RSFace*>& voxel = this->voxelMapProbes[this->VoxelIndex(x, y, z)];
+                for (cnt = 0; cnt < voxel.size(); ++cnt) {
                     // store probe center
-                    probe = this->voxelMapProbes[xId + cntX][yId + cntY][zId + cntZ][cnt]->GetProbeCenter();
+                    probe = voxel[cnt]->GetProbeCenter();
                     // compute distance between probe and vertex
                     dist = (probe - v1).Length();
                     // if the distance is smaller than the two radii, the probe is cut
                     if (dist < (vertex->GetRadius() + probeRadius - epsilon)) {
                         // add RS-face to the list of cut faces
-                        cutFaces.push_back(this->voxelMapProbes[xId + cntX][yId + cntY][zId + cntZ][cnt]);
+                        result.push_back(voxel[cnt]);
                     }
                 }
             }
@@ -1256,7 +1226,7 @@ bool ReducedSurface::UpdateData(const float lowerThreshold, const float upperThr
     unsigned int yIdx = 0;
     unsigned int zIdx = 0;
     // indices of voxel map entries
-    unsigned int oldVoxelMapIdxX, oldVoxelMapIdxY, oldVoxelMapIdxZ, newVoxelMapIdxX, newVoxelMapIdxY, newVoxelMapIdxZ;
+    unsigned int oldVoxelMapIdx, newVoxelMapIdx;
     // difference between the current and the subsequent atom position
     float difference;
     // temporary vector for RS-edges
@@ -1303,37 +1273,16 @@ bool ReducedSurface::UpdateData(const float lowerThreshold, const float upperThr
         if (difference > lowerThreshold) {
             // the lower threshold is exceeded
             lowerThresholdExceeded = true;
-            // compute old voxel map index
-            oldVoxelMapIdxX = (unsigned int)std::max(
-                0, (int)floorf((this->rsVertex[cnt3]->GetPosition().GetX() - bBox.Left()) / voxelLength));
-            oldVoxelMapIdxX = std::min(oldVoxelMapIdxX, (unsigned int)this->voxelMap.size() - 1);
-            oldVoxelMapIdxY = (unsigned int)std::max(
-                0, (int)floorf((this->rsVertex[cnt3]->GetPosition().GetY() - bBox.Bottom()) / voxelLength));
-            oldVoxelMapIdxY = std::min(oldVoxelMapIdxY, (unsigned int)this->voxelMap[oldVoxelMapIdxX].size() - 1);
-            oldVoxelMapIdxZ = (unsigned int)std::max(
-                0, (int)floorf((this->rsVertex[cnt3]->GetPosition().GetZ() - bBox.Back()) / voxelLength));
-            oldVoxelMapIdxZ =
-                std::min(oldVoxelMapIdxZ, (unsigned int)this->voxelMap[oldVoxelMapIdxX][oldVoxelMapIdxY].size() - 1);
-            // compute new voxel map index --> make sure the index is within bounds
-            newVoxelMapIdxX =
-                (unsigned int)std::max(0, (int)floorf((tmpVec1.GetX() - bBox.Left()) / this->voxelLength));
-            newVoxelMapIdxX = std::min(newVoxelMapIdxX, (unsigned int)this->voxelMap.size() - 1);
-            newVoxelMapIdxY =
-                (unsigned int)std::max(0, (int)floorf((tmpVec1.GetY() - bBox.Bottom()) / this->voxelLength));
-            newVoxelMapIdxY = std::min(newVoxelMapIdxY, (unsigned int)this->voxelMap[newVoxelMapIdxX].size() - 1);
-            newVoxelMapIdxZ =
-                (unsigned int)std::max(0, (int)floorf((tmpVec1.GetZ() - bBox.Back()) / this->voxelLength));
-            newVoxelMapIdxZ =
-                std::min(newVoxelMapIdxZ, (unsigned int)this->voxelMap[newVoxelMapIdxX][newVoxelMapIdxY].size() - 1);
+            // compute old and new voxel map index --> make sure the index is within bounds
+            oldVoxelMapIdx = this->VoxelIndex(this->ComputeVoxelCell(this->rsVertex[cnt3]->GetPosition()));
+            newVoxelMapIdx = this->VoxelIndex(this->ComputeVoxelCell(tmpVec1));
             // if the new atom position lies in another voxel --> remove old and add new position
-            if ((oldVoxelMapIdxX != newVoxelMapIdxX) || (oldVoxelMapIdxY != newVoxelMapIdxY) ||
-                (oldVoxelMapIdxZ != newVoxelMapIdxZ)) {
+            if (oldVoxelMapIdx != newVoxelMapIdx) {
                 // add the rsVertex-pointer to the new voxel
-                this->voxelMap[newVoxelMapIdxX][newVoxelMapIdxY][newVoxelMapIdxZ].push_back(this->rsVertex[cnt3]);
+                this->voxelMap[newVoxelMapIdx].push_back(this->rsVertex[cnt3]);
                 // remove the rsVertex-pointer from the old voxel
-                this->voxelMap[oldVoxelMapIdxX][oldVoxelMapIdxY][oldVoxelMapIdxZ].erase(
-                    std::find(this->voxelMap[oldVoxelMapIdxX][oldVoxelMapIdxY][oldVoxelMapIdxZ].begin(),
-                        this->voxelMap[oldVoxelMapIdxX][oldVoxelMapIdxY][oldVoxelMapIdxZ].end(), this->rsVertex[cnt3]));
+                this->voxelMap[oldVoxelMapIdx].erase(std::find(this->voxelMap[oldVoxelMapIdx].begin(),
+                    this->voxelMap[oldVoxelMapIdx].end(), this->rsVertex[cnt3]));
             }
             // set new atom position
             this->rsVertex[cnt3]->SetPosition(tmpVec1);
@@ -1380,19 +1329,22 @@ bool ReducedSurface::UpdateData(const float lowerThreshold, const float upperThr
     }
 
     // find all RS-faces, whose probe is cut by a moved atom
-    // TODO: this could be done in the loop above (and would be faster that way)
-    for (itVertex = changedRSVertices.begin(); itVertex != changedRSVertices.end(); ++itVertex) {
-        this->ComputeProbeCutVertex(*itVertex);
-        // add all found RS-faces to the list of changed faces
-        if (this->cutFaces.size() > 0) {
-            for (cnt1 = 0; cnt1 < this->cutFaces.size(); ++cnt1) {
-                changedRSFaces.insert(this->cutFaces[cnt1]);
+    {
+        std::vector<RSVertex*> vertices(changedRSVertices.begin(), changedRSVertices.end());
+        std::mutex lock;
+        core::utility::ParallelFor<std::size_t>(0, vertices.size(), 64, [&](std::size_t begin, std::size_t end) {
+            std::vector<RSFace*> cut, faces;
+            for (auto i = begin; i < end; ++i) {
+                this->ComputeProbeCutVertex(vertices[i], cut);
+                faces.insert(faces.end(), cut.begin(), cut.end());
             }
-            // std::cout << "INFO: found RS-faces whose probes are cut by moved atoms (" << this->cutFaces.size() << ")"
-            // << std::endl;
-        }
+            // add all found RS-faces to the list of changed faces
+            std::lock_guard<std::mutex> l(lock);
+            changedRSFaces.insert(faces.begin(), faces.end());
+        });
     }
-    this->cutFaces.clear();
+    // edges of the surface always have two faces, but be safe with free edges
+    changedRSFaces.erase(static_cast<RSFace*>(NULL));
 
     // std::cout << "INFO: marked RS-faces (" << changedRSFaces.size() << ") and RS-edges (" << changedRSEdges.size() <<
     // ")" << std::endl; std::cout << "INFO: total number of RS-faces (" << this->rsFace.size() << ") and RS-edges (" <<
@@ -1405,19 +1357,15 @@ bool ReducedSurface::UpdateData(const float lowerThreshold, const float upperThr
     for (itFace = changedRSFaces.begin(); itFace != changedRSFaces.end(); ++itFace) {
         face = *itFace;
         // remove RS-face from probe voxel map
-        oldVoxelMapIdxX = face->GetProbeIndex().GetX();
-        oldVoxelMapIdxY = face->GetProbeIndex().GetY();
-        oldVoxelMapIdxZ = face->GetProbeIndex().GetZ();
+        oldVoxelMapIdx = this->VoxelIndex(face->GetProbeIndex());
         // find and remove old probe position
-        itProbe = std::find(this->voxelMapProbes[oldVoxelMapIdxX][oldVoxelMapIdxY][oldVoxelMapIdxZ].begin(),
-            this->voxelMapProbes[oldVoxelMapIdxX][oldVoxelMapIdxY][oldVoxelMapIdxZ].end(), face);
-        if (itProbe != this->voxelMapProbes[oldVoxelMapIdxX][oldVoxelMapIdxY][oldVoxelMapIdxZ].end()) {
-            this->voxelMapProbes[oldVoxelMapIdxX][oldVoxelMapIdxY][oldVoxelMapIdxZ].erase(itProbe);
-            ////std::cout << "SUCCESS: probe found in voxel map! ["<< oldVoxelMapIdxX << "][" << oldVoxelMapIdxY << "]["
-            ///<< oldVoxelMapIdxZ << "]" << std::endl;
+        itProbe =
+            std::find(this->voxelMapProbes[oldVoxelMapIdx].begin(), this->voxelMapProbes[oldVoxelMapIdx].end(), face);
+        if (itProbe != this->voxelMapProbes[oldVoxelMapIdx].end()) {
+            this->voxelMapProbes[oldVoxelMapIdx].erase(itProbe);
         } else {
-            std::cout << "ERROR: probe not found in voxel map! [" << oldVoxelMapIdxX << "][" << oldVoxelMapIdxY << "]["
-                      << oldVoxelMapIdxZ << "]" << std::endl;
+            std::cout << "ERROR: probe not found in voxel map! [" << face->GetProbeIndex().GetX() << "]["
+                      << face->GetProbeIndex().GetY() << "][" << face->GetProbeIndex().GetZ() << "]" << std::endl;
         }
 
         // remove RS-face from all RS-edges which belong to one of its three RS-vertices
@@ -1464,15 +1412,22 @@ bool ReducedSurface::UpdateData(const float lowerThreshold, const float upperThr
             }
         }
 
-        // delete RS-face
-        itProbe = std::find(this->rsFace.begin(), this->rsFace.end(), (*itFace));
-        if (itProbe != this->rsFace.end()) {
-            delete (*itProbe);
-            this->rsFace.erase(itProbe);
-        } else {
-            std::cout << "ERROR: RS-Face not found in list of RS-faces!" << std::endl;
+        // mark RS-face for deletion
+        face->toDelete = true;
+    }
+
+    // delete all marked RS-faces in one pass instead of searching each of them in the list of RS-faces
+    for (cnt1 = 0; cnt1 < this->rsFace.size(); ++cnt1) {
+        face = this->rsFace[cnt1];
+        if (face->toDelete && face->GetDualFace() != NULL && !face->GetDualFace()->toDelete) {
+            face->GetDualFace()->SetDualFace(NULL);
         }
     }
+    itProbe = std::stable_partition(this->rsFace.begin(), this->rsFace.end(), [](RSFace* f) { return !f->toDelete; });
+    for (std::vector<RSFace*>::iterator it = itProbe; it != this->rsFace.end(); ++it) {
+        delete (*it);
+    }
+    this->rsFace.erase(itProbe, this->rsFace.end());
 
     // std::cout << "INFO: deleted RS-faces" << std::endl;
 
@@ -1483,15 +1438,14 @@ bool ReducedSurface::UpdateData(const float lowerThreshold, const float upperThr
         // remove RS-edge from its two RS-vertices
         (*itEdge)->GetVertex1()->RemoveEdge((*itEdge));
         (*itEdge)->GetVertex2()->RemoveEdge((*itEdge));
-        // delete RS-edge
-        itDelEdge = std::find(this->rsEdge.begin(), this->rsEdge.end(), (*itEdge));
-        if (itDelEdge != this->rsEdge.end()) {
-            delete (*itDelEdge);
-            this->rsEdge.erase(itDelEdge);
-        } else {
-            // std::cout << "ERROR: RS-edge not found in list of RS-edges!" << std::endl;
-        }
     }
+    // delete the RS-edges in one pass
+    itDelEdge = std::stable_partition(
+        this->rsEdge.begin(), this->rsEdge.end(), [&](RSEdge* e) { return changedRSEdges.count(e) == 0; });
+    for (std::vector<RSEdge*>::iterator it = itDelEdge; it != this->rsEdge.end(); ++it) {
+        delete (*it);
+    }
+    this->rsEdge.erase(itDelEdge, this->rsEdge.end());
     // std::cout << "INFO: number of RS-edges after deletion: " << this->rsEdge.size() << std::endl;
 
     // std::cout << "INFO: new number of RS-faces (" << this->rsFace.size() << ") and RS-edges (" << this->rsEdge.size()
@@ -1516,11 +1470,7 @@ bool ReducedSurface::UpdateData(const float lowerThreshold, const float upperThr
         // std::cout << "INFO: computing new RS-faces from old RS-edges..." << std::endl;
 
         // for each edge: find neighbours
-        cnt1 = 0;
-        while (cnt1 < this->rsEdge.size()) {
-            this->ComputeRSFace(cnt1);
-            cnt1++;
-        }
+        this->ComputeRSFaces(0);
 
         // std::cout << "INFO: computed new RS-faces from old RS-edges" << std::endl;
 
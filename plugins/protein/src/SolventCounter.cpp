@@ -7,13 +7,13 @@
  */
 #include "SolventCounter.h"
 #include "mmcore/param/FloatParam.h"
+#include "mmcore/utility/TaskScheduler.h"
 #include "mmcore/utility/log/Log.h"
 #include "protein_calls/PerAtomFloatCall.h"
 #include "stdafx.h"
 #include "vislib/assert.h"
 #include <cfloat>
 #include <climits>
-#include <omp.h>
 
 
 using namespace megamol;
@@ -109,20 +109,13 @@ bool SolventCounter::getDataCallback(core::Call& call) {
     if (solvent.Count() != mol->AtomCount() || this->datahash != mol->DataHash()) {
         this->solvent.Clear();
         this->solvent.SetCount(mol->AtomCount());
-        vislib::math::Vector<float, 3> molAtomPos, solAtomPos;
         for (unsigned int i = 0; i < mol->AtomCount(); i++) {
-            molAtomPos.Set(
-                mol->AtomPositions()[3 * i], mol->AtomPositions()[3 * i + 1], mol->AtomPositions()[3 * i + 2]);
             this->solvent[i] = 0.0f;
-            for (unsigned int j = 0; j < sol->AtomCount(); j++) {
-                solAtomPos.Set(
-                    sol->AtomPositions()[3 * j], sol->AtomPositions()[3 * j + 1], sol->AtomPositions()[3 * j + 2]);
-                // increase counter if the current solvent atom is within the given radius
-                if ((molAtomPos - solAtomPos).Length() <= this->radiusParam.Param<param::FloatParam>()->Value()) {
-                    this->solvent[i] = 1.0f;
-                }
-            }
         }
+        const float radius = this->radiusParam.Param<param::FloatParam>()->Value();
+        this->solventGrid.SetPointData(
+            sol->AtomPositions(), sol->AtomCount(), sol->AccessBoundingBoxes().ObjectSpaceBBox(), radius);
+        this->countSolvent(mol->AtomPositions(), mol->AtomCount(), radius);
         this->datahash = mol->DataHash();
     }
     mol->Unlock();
@@ -151,8 +144,8 @@ bool SolventCounter::getDataCallback(core::Call& call) {
         }
         this->minValue = FLT_MAX;
         this->maxValue = FLT_MIN;
-        // loop over all frames
-        vislib::math::Vector<float, 3> molAtomPos, solAtomPos;
+        // loop over all frames, the solvent only moves, so the grid is updated incrementally
+        const float radius = this->radiusParam.Param<param::FloatParam>()->Value();
         for (unsigned int fID = 0; fID < frameCount; fID++) {
             if (fID % 100 == 0)
                 megamol::core::utility::log::Log::DefaultLog.WriteInfo("Computing Frame %i", fID);
@@ -162,20 +155,12 @@ bool SolventCounter::getDataCallback(core::Call& call) {
             sol->SetFrameID(fID);
             if (!(*sol)(MolecularDataCall::CallForGetData))
                 return false;
-            // loop over all molecule atoms and check for neighboring solvent atoms
-            for (unsigned int i = 0; i < mol->AtomCount(); i++) {
-                molAtomPos.Set(
-                    mol->AtomPositions()[3 * i], mol->AtomPositions()[3 * i + 1], mol->AtomPositions()[3 * i + 2]);
-                for (unsigned int j = 0; j < sol->AtomCount(); j++) {
-                    solAtomPos.Set(
-                        sol->AtomPositions()[3 * j], sol->AtomPositions()[3 * j + 1], sol->AtomPositions()[3 * j + 2]);
-                    // increase counter if the current solvent atom is within the given radius
-                    if ((molAtomPos - solAtomPos).Length() <= this->radiusParam.Param<param::FloatParam>()->Value()) {
-                        this->solvent[i] += 1.0f;
-                        break;
-                    }
-                }
+            if ((fID == 0) || !this->solventGrid.UpdatePointData(sol->AtomPositions(), sol->AtomCount())) {
+                this->solventGrid.SetPointData(
+                    sol->AtomPositions(), sol->AtomCount(), sol->AccessBoundingBoxes().ObjectSpaceBBox(), radius);
             }
+            // check all molecule atoms for neighboring solvent atoms
+            this->countSolvent(mol->AtomPositions(), mol->AtomCount(), radius);
             this->datahash = mol->DataHash();
             mol->Unlock();
             sol->Unlock();
@@ -200,3 +185,23 @@ bool SolventCounter::getDataCallback(core::Call& call) {
 
     return true;
 }
+
+
+/*
+ * SolventCounter::countSolvent
+ */
+void SolventCounter::countSolvent(const float* atomPositions, unsigned int atomCount, float radius) {
+    ASSERT(this->solvent.Count() >= atomCount);
+    if (atomCount == 0) {
+        return;
+    }
+    float* counts = &this->solvent[0];
+    core::utility::ParallelFor<unsigned int>(0, atomCount, 0, [&](unsigned int begin, unsigned int end) {
+        for (auto i = begin; i < end; i++) {
+            // increase counter if any solvent atom is within the given radius
+            if (this->solventGrid.HasNeighbourInRange(&atomPositions[3 * i], radius)) {
+                counts[i] += 1.0f;
+            }
+        }
+    });
+}
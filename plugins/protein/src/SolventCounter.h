@@ -16,6 +16,7 @@
 #include "mmcore/CallerSlot.h"
 #include "mmcore/Module.h"
 #include "mmcore/param/ParamSlot.h"
+#include "protein/GridNeighbourFinder.h"
 #include "protein_calls/MolecularDataCall.h"
 #include "vislib/Array.h"
 
@@ -94,6 +95,16 @@ private:
      */
     bool getDataCallback(core::Call& caller);
 
+    /**
+     * Increments the counter of every atom that has a solvent atom in the
+     * search grid within 'radius'.
+     *
+     * @param atomPositions The positions of the molecule atoms.
+     * @param atomCount     The number of molecule atoms.
+     * @param radius        The search radius.
+     */
+    void countSolvent(const float* atomPositions, unsigned int atomCount, float radius);
+
     /** The slot for requesting data */
     core::CalleeSlot getDataSlot;
 
@@ -109,6 +120,9 @@ private:
     /** The array that stores the solvent around each atom */
     vislib::Array<float> solvent;
 
+    /** The search grid of the solvent atoms */
+    GridNeighbourFinder<float> solventGrid;
+
     float minValue;
     float midValue;
     float maxValue;
@@ -14,7 +14,12 @@ using namespace megamol::protein_calls;
 #undef max
 
 
-Stride::Stride(MolecularDataCall* mol) : Successful(false) {
+Stride::Stride(MolecularDataCall* mol) : Stride(mol, (mol != nullptr) ? mol->AtomPositions() : nullptr) {
+    if (mol)
+        mol->SetHydrogenBonds(this->ownHydroBonds.data(), static_cast<unsigned int>(HydroBondCnt));
+}
+
+Stride::Stride(const MolecularDataCall* mol, const float* atomPos) : Successful(false) {
     // set protein chain count to zero
     ProteinChainCnt = 0;
     // set hydrogen bond count to zero
@@ -28,11 +33,11 @@ Stride::Stride(MolecularDataCall* mol) : Successful(false) {
     DefaultCmd(StrideCmd);
 
     // do nothing if Protein Data Interface is not valid
-    if (!mol)
+    if (!mol || !atomPos)
         return;
 
     // get chains from interface
-    GetChains(mol);
+    GetChains(mol, atomPos);
     // try to compute the secondary structure
     ComputeSecondaryStructure();
     // compute the indices of the hydrogen bonds
@@ -96,7 +101,7 @@ void Stride::FreeHBond(HBOND* h) {
     free(h);
 }
 
-void Stride::GetChains(MolecularDataCall* mol) {
+void Stride::GetChains(const MolecularDataCall* mol, const float* atomPos) {
     int ChainCnt;
     int cntCha, cntRes, cntAtm, idx, cnt, chain;
     int atomCount, firstAtom;
@@ -152,9 +157,9 @@ void Stride::GetChains(MolecularDataCall* mol) {
                 snprintf(
                     r->AtomType[cntAtm], AT_FIELD, mol->AtomTypes()[mol->AtomTypeIndices()[cntAtm + firstAtom]].Name());
 #endif // _WIN32
-                r->Coord[cntAtm][0] = mol->AtomPositions()[3 * (firstAtom + cntAtm) + 0];
-                r->Coord[cntAtm][1] = mol->AtomPositions()[3 * (firstAtom + cntAtm) + 1];
-                r->Coord[cntAtm][2] = mol->AtomPositions()[3 * (firstAtom + cntAtm) + 2];
+                r->Coord[cntAtm][0] = atomPos[3 * (firstAtom + cntAtm) + 0];
+                r->Coord[cntAtm][1] = atomPos[3 * (firstAtom + cntAtm) + 1];
+                r->Coord[cntAtm][2] = atomPos[3 * (firstAtom + cntAtm) + 2];
 
                 r->Occupancy[cntAtm] = mol->AtomOccupancies()[firstAtom + cntAtm];
                 r->TempFactor[cntAtm] = mol->AtomBFactors()[firstAtom + cntAtm];
@@ -215,6 +220,8 @@ bool Stride::ComputeSecondaryStructure() {
     if ((HydroBondCnt = FindHydrogenBonds(ProteinChain, Cn, HydroBond, StrideCmd)) == 0) {
         //die( "No hydrogen bonds found in %s\n", StrideCmd->InputFile );
         printf("No hydrogen bonds found.\n");
+        free(PhiPsiMapHelix);
+        free(PhiPsiMapSheet);
         return false;
     }
 
@@ -244,78 +251,105 @@ bool Stride::ComputeSecondaryStructure() {
     // find disulfide bonds
     SSBond(ProteinChain, ProteinChainCnt);
 
+    free(PhiPsiMapHelix);
+    free(PhiPsiMapSheet);
+
     return true;
 }
 
 bool Stride::WriteToInterface(MolecularDataCall* mol) {
-    if (mol) {
-        int Cn, i;
-        char type;
-        int firstRes;
-        int resCnt;
-        int idx = 0;
+    if (!mol)
+        return false;
 
-        std::vector<MolecularDataCall::SecStructure> sec;
+    if (!ExistsSecStr(ProteinChain, ProteinChainCnt))
+        return false;
 
-        if (!ExistsSecStr(ProteinChain, ProteinChainCnt))
-            return false;
+    std::vector<char> codes;
+    GetStructureCodes(mol, codes);
+    return WriteStructureCodes(mol, codes, this->ownHydroBonds);
+}
 
-        for (Cn = 0; Cn < ProteinChainCnt; ++Cn) {
-            // do nothing if the current chain is not valid
-            if (!ProteinChain[Cn]->Valid)
-                continue;
+void Stride::GetStructureCodes(const MolecularDataCall* mol, std::vector<char>& outCodes) const {
+    outCodes.clear();
 
-            // set initial values for first sec struct elem
-            firstRes = mol->Molecules()[Cn].FirstResidueIndex();
-            resCnt = 1;
-            type = ProteinChain[Cn]->Rsd[0]->Prop->Asn;
+    if (!mol || !ExistsSecStr(ProteinChain, ProteinChainCnt))
+        return;
 
-            for (i = 1; i < ProteinChain[Cn]->NRes; i++) {
-                // update values if type did not change
-                if (ProteinChain[Cn]->Rsd[i]->Prop->Asn == type) {
-                    resCnt++;
-                } else {
-                    // write sec struct elem to vector if new elem starts
-                    sec.push_back(MolecularDataCall::SecStructure());
-                    sec.back().SetPosition(firstRes, resCnt);
-                    if (type == 'G' || type == 'H' || type == 'I')
-                        sec.back().SetType(MolecularDataCall::SecStructure::TYPE_HELIX);
-                    else if (type == 'E')
-                        sec.back().SetType(MolecularDataCall::SecStructure::TYPE_SHEET);
-                    else
-                        sec.back().SetType(MolecularDataCall::SecStructure::TYPE_COIL);
-                    // start new sec struct elem
-                    firstRes = i + mol->Molecules()[Cn].FirstResidueIndex();
-                    resCnt = 1;
-                    type = ProteinChain[Cn]->Rsd[i]->Prop->Asn;
-                }
+    outCodes.resize(mol->ResidueCount(), 0);
+    for (int Cn = 0; Cn < ProteinChainCnt; ++Cn) {
+        // residues of invalid chains are left unassigned
+        if (!ProteinChain[Cn]->Valid)
+            continue;
 
-                //printf( "CHAIN %4i RES %5i ASN %c\n", Cn, i, ProteinChain[Cn]->Rsd[i]->Prop->Asn);
-            }
-            // write last sec struct elem to vector
-            sec.push_back(MolecularDataCall::SecStructure());
-            sec.back().SetPosition(firstRes, resCnt);
-            if (type == 'G' || type == 'H' || type == 'I')
-                sec.back().SetType(MolecularDataCall::SecStructure::TYPE_HELIX);
-            else if (type == 'E')
-                sec.back().SetType(MolecularDataCall::SecStructure::TYPE_SHEET);
-            else
-                sec.back().SetType(MolecularDataCall::SecStructure::TYPE_COIL);
-            mol->SetMoleculeSecondaryStructure(Cn, idx, (unsigned int)sec.size() - idx);
-            idx = (int)sec.size();
-        }
-        // handled all residues of current chain, copy sec struct to interface
-        mol->SetSecondaryStructureCount((unsigned int)sec.size());
-        for (i = 0; i < (int)sec.size(); ++i) {
-            mol->SetSecondaryStructure(i, sec[i]);
+        unsigned int firstRes = mol->Molecules()[Cn].FirstResidueIndex();
+        for (int i = 0; i < ProteinChain[Cn]->NRes; ++i) {
+            outCodes[firstRes + i] = ProteinChain[Cn]->Rsd[i]->Prop->Asn;
         }
+    }
+}
 
-        // set the found hydrogen bonds
-        mol->SetHydrogenBonds(this->ownHydroBonds.data(), static_cast<unsigned int>(HydroBondCnt));
+bool Stride::WriteStructureCodes(
+    MolecularDataCall* mol, const std::vector<char>& codes, const std::vector<unsigned int>& hBonds) {
+    if (!mol)
+        return false;
 
-    } else {
+    // set the found hydrogen bonds
+    mol->SetHydrogenBonds(hBonds.data(), static_cast<unsigned int>(hBonds.size() / 2));
+
+    if (codes.size() < mol->ResidueCount())
         return false;
+
+    std::vector<MolecularDataCall::SecStructure> sec;
+    auto pushElement = [&sec](unsigned int firstRes, unsigned int resCnt, char type) {
+        sec.push_back(MolecularDataCall::SecStructure());
+        sec.back().SetPosition(firstRes, resCnt);
+        if (type == 'G' || type == 'H' || type == 'I')
+            sec.back().SetType(MolecularDataCall::SecStructure::TYPE_HELIX);
+        else if (type == 'E')
+            sec.back().SetType(MolecularDataCall::SecStructure::TYPE_SHEET);
+        else
+            sec.back().SetType(MolecularDataCall::SecStructure::TYPE_COIL);
+    };
+
+    unsigned int chainCnt = std::min(mol->MoleculeCount(), static_cast<unsigned int>(MAX_CHAIN));
+    unsigned int idx = 0;
+    for (unsigned int Cn = 0; Cn < chainCnt; ++Cn) {
+        unsigned int first = mol->Molecules()[Cn].FirstResidueIndex();
+        unsigned int end = first + mol->Molecules()[Cn].ResidueCount();
+
+        // do nothing if the current chain is not valid
+        if (first >= end || codes[first] == 0)
+            continue;
+
+        // set initial values for first sec struct elem
+        unsigned int firstRes = first;
+        unsigned int resCnt = 1;
+        char type = codes[first];
+
+        for (unsigned int i = first + 1; i < end && codes[i] != 0; ++i) {
+            // update values if type did not change
+            if (codes[i] == type) {
+                resCnt++;
+            } else {
+                // write sec struct elem to vector and start new one
+                pushElement(firstRes, resCnt, type);
+                firstRes = i;
+                resCnt = 1;
+                type = codes[i];
+            }
+        }
+        // write last sec struct elem to vector
+        pushElement(firstRes, resCnt, type);
+        mol->SetMoleculeSecondaryStructure(Cn, idx, static_cast<unsigned int>(sec.size()) - idx);
+        idx = static_cast<unsigned int>(sec.size());
+    }
+
+    // handled all residues of all chains, copy sec struct to interface
+    mol->SetSecondaryStructureCount(static_cast<unsigned int>(sec.size()));
+    for (unsigned int i = 0; i < sec.size(); ++i) {
+        mol->SetSecondaryStructure(i, sec[i]);
     }
+
     return true;
 }
 
@@ -679,13 +713,43 @@ int Stride::FindHydrogenBonds(CHAIN** Chain, int NChain, HBOND** HBond, COMMAND*
     for (i = 0; i < NAcc; i++)
         BondedAcceptor[i] = STRIDE_NO;
 
+    // Only pairs within the distance cut-off can form a bond or a polar
+    // interaction. Keep the acceptor positions as structure of arrays such
+    // that the squared distances to a donor are computed in a vectorisable
+    // loop and all other pairs are skipped before allocating an HBOND. The
+    // slightly enlarged cut-off leaves the exact decision to the test below.
+    std::vector<float> AccX(NAcc), AccY(NAcc), AccZ(NAcc), AccDist2(NAcc);
+    for (ac = 0; ac < NAcc; ac++) {
+        const float* Coord = Acc[ac]->Chain->Rsd[Acc[ac]->A_Res]->Coord[Acc[ac]->A_At];
+        AccX[ac] = Coord[0];
+        AccY[ac] = Coord[1];
+        AccZ[ac] = Coord[2];
+    }
+    const float MaxDist2 = (Cmd->DistCutOff * 1.001f) * (Cmd->DistCutOff * 1.001f);
+
     for (dc = 0; dc < NDnr; dc++) {
 
         if (Dnr[dc]->Group != Peptide && !Cmd->SideChainHBond)
             continue;
 
+        const float* DCoord = Dnr[dc]->Chain->Rsd[Dnr[dc]->D_Res]->Coord[Dnr[dc]->D_At];
+        const float DX = DCoord[0], DY = DCoord[1], DZ = DCoord[2];
+        const float* AX = AccX.data();
+        const float* AY = AccY.data();
+        const float* AZ = AccZ.data();
+        float* ADist2 = AccDist2.data();
+        for (ac = 0; ac < NAcc; ac++) {
+            const float X = AX[ac] - DX;
+            const float Y = AY[ac] - DY;
+            const float Z = AZ[ac] - DZ;
+            ADist2[ac] = X * X + Y * Y + Z * Z;
+        }
+
         for (ac = 0; ac < NAcc; ac++) {
 
+            if (ADist2[ac] > MaxDist2)
+                continue;
+
             if (abs(Acc[ac]->A_Res - Dnr[dc]->D_Res) < 2 && Acc[ac]->Chain->Id == Dnr[dc]->Chain->Id)
                 continue;
 
@@ -1590,14 +1654,7 @@ int Stride::FindAtom(CHAIN* Chain, int ResNumb, const char* Atom, int* AtNumb) {
 }
 
 char Stride::SpaceToDash(char Id) {
-    static char NewId;
-
-    if (Id == ' ')
-        NewId = '-';
-    else
-        NewId = Id;
-
-    return (NewId);
+    return ((Id == ' ') ? '-' : Id);
 }
 
 Stride::BOOLEAN Stride::ChInStr(char* String, char Char) {
@@ -3045,7 +3102,7 @@ const char* Stride::Translate(char Code) {
     }
 }
 
-Stride::BOOLEAN Stride::ExistsSecStr(CHAIN** Chain, int NChain) {
+Stride::BOOLEAN Stride::ExistsSecStr(CHAIN** Chain, int NChain) const {
     int i, Cn;
 
     for (Cn = 0; Cn < NChain; Cn++)
@@ -3264,7 +3321,7 @@ float Stride::VectorProduct(float* Vector1, float* Vector2, float* Product) {
     return (sqrt(ProductLength));
 }
 
-void Stride::PostProcessHBonds(megamol::protein_calls::MolecularDataCall* mol) {
+void Stride::PostProcessHBonds(const megamol::protein_calls::MolecularDataCall* mol) {
     this->ownHydroBonds.resize(HydroBondCnt * 2);
 
     for (unsigned int bondIdx = 0; bondIdx < static_cast<unsigned int>(HydroBondCnt); bondIdx++) {
@@ -3274,12 +3331,10 @@ void Stride::PostProcessHBonds(megamol::protein_calls::MolecularDataCall* mol) {
         this->ownHydroBonds[bondIdx * 2 + 0] = donor;
         this->ownHydroBonds[bondIdx * 2 + 1] = acceptor;
     }
-
-    mol->SetHydrogenBonds(this->ownHydroBonds.data(), static_cast<unsigned int>(HydroBondCnt));
 }
 
 unsigned int Stride::GetMoleculeIndex(unsigned int ChainIdx, unsigned int ResidueIdx, unsigned int InternalIdx,
-    megamol::protein_calls::MolecularDataCall* mol) {
+    const megamol::protein_calls::MolecularDataCall* mol) {
     unsigned int firstResidue = mol->Molecules()[ChainIdx].FirstResidueIndex();
     unsigned int firstAtom = mol->Residues()[firstResidue + ResidueIdx]->FirstAtomIndex();
     return firstAtom + InternalIdx;
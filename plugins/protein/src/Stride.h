@@ -280,10 +280,56 @@ public:
     } PATTERN;
 
     Stride(megamol::protein_calls::MolecularDataCall* mol);
+
+    /**
+     * Computes the secondary structure of the molecules in 'mol' for the
+     * given atom positions instead of the ones set in the call. The call is
+     * only read, so several frames may be processed concurrently using
+     * separate instances.
+     *
+     * @param mol     The call providing the topology of the molecules.
+     * @param atomPos The atom positions of the frame (3 floats per atom).
+     */
+    Stride(const megamol::protein_calls::MolecularDataCall* mol, const float* atomPos);
+
     virtual ~Stride(void);
 
     bool WriteToInterface(megamol::protein_calls::MolecularDataCall* mol);
 
+    /**
+     * Answer the hydrogen bonds found as pairs of donor and acceptor atom
+     * indices.
+     */
+    inline const std::vector<unsigned int>& GetHydrogenBonds(void) const {
+        return this->ownHydroBonds;
+    }
+
+    /**
+     * Writes the STRIDE code ('H', 'E', 'C', ...) of each residue of 'mol'
+     * to 'outCodes'. Residues that have not been assigned, e.g. because
+     * their chain is not valid, get the code 0. 'outCodes' is left empty
+     * if no secondary structure has been found at all.
+     *
+     * @param mol      The call used to compute the secondary structure.
+     * @param outCodes Receives one code per residue of the call.
+     */
+    void GetStructureCodes(const megamol::protein_calls::MolecularDataCall* mol, std::vector<char>& outCodes) const;
+
+    /**
+     * Sets the secondary structure elements described by per-residue STRIDE
+     * codes as obtained from GetStructureCodes and the given hydrogen bonds
+     * to the call.
+     *
+     * @param mol    The call to write to.
+     * @param codes  One STRIDE code per residue of the call.
+     * @param hBonds Pairs of donor and acceptor atom indices. The memory
+     *               must remain valid as long as the call uses it.
+     *
+     * @return true if secondary structure elements have been written.
+     */
+    static bool WriteStructureCodes(megamol::protein_calls::MolecularDataCall* mol, const std::vector<char>& codes,
+        const std::vector<unsigned int>& hBonds);
+
 protected:
     typedef struct // OWNBOND
     {
@@ -291,12 +337,12 @@ protected:
         unsigned int acceptor;
     } OWNBOND;
 
-    void GetChains(megamol::protein_calls::MolecularDataCall* mol);
+    void GetChains(const megamol::protein_calls::MolecularDataCall* mol, const float* atomPos);
     bool ComputeSecondaryStructure();
 
-    void PostProcessHBonds(megamol::protein_calls::MolecularDataCall* mol);
+    void PostProcessHBonds(const megamol::protein_calls::MolecularDataCall* mol);
     unsigned int GetMoleculeIndex(unsigned int ChainIdx, unsigned int ResidueIdx, unsigned int InternalIndex,
-        megamol::protein_calls::MolecularDataCall* mol);
+        const megamol::protein_calls::MolecularDataCall* mol);
 
     void DefaultCmd(COMMAND* Cmd);
     int ReadPDBFile(CHAIN** Chain, int* Cn, COMMAND* Cmd);
@@ -366,7 +412,7 @@ protected:
     void Alias(int* D1, int* A1, int* D2, int* A2, char* D1Cn, char* A1Cn, char* D2Cn, char* A2Cn, PATTERN* Pat);
     void Bridge(char* Asn1, char* Asn2, CHAIN** Chain, int Cn1, int Cn2, PATTERN** Pat, int NPat);
     const char* Translate(char Code);
-    BOOLEAN ExistsSecStr(CHAIN** Chain, int NChain);
+    BOOLEAN ExistsSecStr(CHAIN** Chain, int NChain) const;
     void ExtractAsn(CHAIN** Chain, int Cn, char* Asn);
     int Boundaries(char* Asn, int L, char SecondStr, int (*Bound)[2]);
     void InitChain(CHAIN** Chain);
@@ -0,0 +1,177 @@
+/*
+ * StrideCheck.cpp
+ *
+ * Copyright (C) 2022 by University of Stuttgart (VISUS).
+ * All rights reserved.
+ */
+
+#include "StrideCheck.h"
+#include "stdafx.h"
+
+#include "Stride.h"
+#include "StrideFrameCache.h"
+
+#include "mmcore/param/IntParam.h"
+#include "mmcore/utility/log/Log.h"
+#include "protein_calls/MolecularDataCall.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+using namespace megamol;
+using namespace megamol::protein;
+using namespace megamol::protein_calls;
+using megamol::core::utility::log::Log;
+
+
+/*
+ * StrideCheck::StrideCheck
+ */
+StrideCheck::StrideCheck(void)
+        : core::job::AbstractThreadedJob()
+        , core::Module()
+        , dataCallerSlot("getdata", "Connects the check with the trajectory")
+        , firstFrameSlot("firstFrame", "The first frame to check")
+        , frameCountSlot("frameCount", "The number of frames to check, 0 for all remaining frames") {
+
+    this->dataCallerSlot.SetCompatibleCall<MolecularDataCallDescription>();
+    this->MakeSlotAvailable(&this->dataCallerSlot);
+
+    this->firstFrameSlot << new core::param::IntParam(0, 0);
+    this->MakeSlotAvailable(&this->firstFrameSlot);
+
+    this->frameCountSlot << new core::param::IntParam(0, 0);
+    this->MakeSlotAvailable(&this->frameCountSlot);
+}
+
+
+/*
+ * StrideCheck::~StrideCheck
+ */
+StrideCheck::~StrideCheck(void) {
+    this->Release();
+}
+
+
+/*
+ * StrideCheck::create
+ */
+bool StrideCheck::create(void) {
+    // intentionally empty
+    return true;
+}
+
+
+/*
+ * StrideCheck::release
+ */
+void StrideCheck::release(void) {
+    // intentionally empty
+}
+
+
+/*
+ * StrideCheck::Run
+ */
+DWORD StrideCheck::Run(void* userData) {
+    MolecularDataCall* mol = this->dataCallerSlot.CallAs<MolecularDataCall>();
+    if (mol == nullptr) {
+        Log::DefaultLog.WriteError("%s: no trajectory connected", this->ClassName());
+        return -1;
+    }
+    if (!(*mol)(MolecularDataCall::CallForGetExtent)) {
+        Log::DefaultLog.WriteError("%s: unable to get the extent of the trajectory", this->ClassName());
+        return -1;
+    }
+    const unsigned int frameCnt = mol->FrameCount();
+    const unsigned int first = static_cast<unsigned int>(this->firstFrameSlot.Param<core::param::IntParam>()->Value());
+    unsigned int last = frameCnt;
+    if (this->frameCountSlot.Param<core::param::IntParam>()->Value() > 0) {
+        last = std::min(
+            last, first + static_cast<unsigned int>(this->frameCountSlot.Param<core::param::IntParam>()->Value()));
+    }
+    if (first >= last) {
+        Log::DefaultLog.WriteError(
+            "%s: first frame %u is beyond the trajectory of %u frames", this->ClassName(), first, frameCnt);
+        return -1;
+    }
+
+    // Single-frame path, as used before the cache: one Stride instance per
+    // frame on the positions set in the call. The positions are kept for the
+    // batched path below.
+    std::vector<std::vector<float>> positions(last - first);
+    std::vector<std::vector<char>> codes(last - first);
+    std::vector<std::vector<unsigned int>> hBonds(last - first);
+    double singleSeconds = 0.0;
+    for (unsigned int fr = first; (fr < last) && !this->shouldTerminate(); ++fr) {
+        mol->SetFrameID(fr, true);
+        if (!(*mol)(MolecularDataCall::CallForGetData)) {
+            Log::DefaultLog.WriteError("%s: unable to get frame %u", this->ClassName(), fr);
+            return -1;
+        }
+        positions[fr - first].assign(mol->AtomPositions(), mol->AtomPositions() + mol->AtomCount() * 3);
+
+        const auto start = std::chrono::steady_clock::now();
+        Stride stride(mol, positions[fr - first].data());
+        stride.GetStructureCodes(mol, codes[fr - first]);
+        hBonds[fr - first] = stride.GetHydrogenBonds();
+        singleSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        mol->Unlock();
+    }
+    if (this->shouldTerminate()) {
+        return -1;
+    }
+
+    // Batched path on the topology of the first frame.
+    std::vector<StrideFrameCache::FramePositions> framePositions;
+    for (unsigned int fr = first; fr < last; ++fr) {
+        framePositions.emplace_back(fr, positions[fr - first].data());
+    }
+    mol->SetFrameID(first, true);
+    if (!(*mol)(MolecularDataCall::CallForGetData)) {
+        Log::DefaultLog.WriteError("%s: unable to get frame %u", this->ClassName(), first);
+        return -1;
+    }
+    StrideFrameCache cache;
+    const auto start = std::chrono::steady_clock::now();
+    cache.Compute(mol, framePositions);
+    const double batchedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    mol->Unlock();
+
+    unsigned int mismatches = 0;
+    for (unsigned int fr = first; fr < last; ++fr) {
+        const std::vector<char>* batchedCodes = cache.GetStructureCodes(fr);
+        const std::vector<unsigned int>* batchedHBonds = cache.GetHydrogenBonds(fr);
+        if ((batchedCodes == nullptr) || (batchedHBonds == nullptr)) {
+            Log::DefaultLog.WriteError("%s: frame %u has not been computed by the cache", this->ClassName(), fr);
+            ++mismatches;
+            continue;
+        }
+        const std::vector<char>& expected = codes[fr - first];
+        if (*batchedCodes != expected) {
+            size_t res = 0;
+            while ((res < expected.size()) && (res < batchedCodes->size()) && (expected[res] == (*batchedCodes)[res])) {
+                ++res;
+            }
+            Log::DefaultLog.WriteError("%s: frame %u differs from residue %u on (%u vs. %u residues)",
+                this->ClassName(), fr, static_cast<unsigned int>(res), static_cast<unsigned int>(expected.size()),
+                static_cast<unsigned int>(batchedCodes->size()));
+            ++mismatches;
+        } else if (*batchedHBonds != hBonds[fr - first]) {
+            Log::DefaultLog.WriteError("%s: frame %u has %u instead of %u hydrogen bonds", this->ClassName(), fr,
+                static_cast<unsigned int>(batchedHBonds->size() / 2),
+                static_cast<unsigned int>(hBonds[fr - first].size() / 2));
+            ++mismatches;
+        }
+    }
+
+    Log::DefaultLog.WriteInfo("%s: %u frames, single-frame %.3f s, batched %.3f s", this->ClassName(), last - first,
+        singleSeconds, batchedSeconds);
+    if (mismatches > 0) {
+        Log::DefaultLog.WriteError("%s: %u of %u frames differ", this->ClassName(), mismatches, last - first);
+        return -1;
+    }
+    Log::DefaultLog.WriteInfo("%s: all frames match", this->ClassName());
+    return 0;
+}
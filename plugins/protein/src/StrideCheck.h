@@ -0,0 +1,101 @@
+/*
+ * StrideCheck.h
+ *
+ * Copyright (C) 2022 by University of Stuttgart (VISUS).
+ * All rights reserved.
+ */
+
+#ifndef MMPROTEINPLUGIN_STRIDECHECK_H_INCLUDED
+#define MMPROTEINPLUGIN_STRIDECHECK_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "mmcore/CallerSlot.h"
+#include "mmcore/Module.h"
+#include "mmcore/job/AbstractThreadedJob.h"
+#include "mmcore/param/ParamSlot.h"
+
+namespace megamol {
+namespace protein {
+
+/**
+ * Checks the batched STRIDE computation of StrideFrameCache against the
+ * single-frame path. Every frame of the connected trajectory is computed by
+ * its own Stride instance on the data of the call, then all frames are
+ * computed at once by the cache. The STRIDE code of every residue and the
+ * hydrogen bonds have to match for every frame. Mismatches are logged and
+ * fail the job, and the time of both paths is logged.
+ */
+class StrideCheck : public core::job::AbstractThreadedJob, public core::Module {
+public:
+    /**
+     * Answer the name of this module.
+     *
+     * @return The name of this module.
+     */
+    static const char* ClassName(void) {
+        return "StrideCheck";
+    }
+
+    /**
+     * Answer a human readable description of this module.
+     *
+     * @return A human readable description of this module.
+     */
+    static const char* Description(void) {
+        return "Compares the batched STRIDE computation to the single-frame one on a trajectory";
+    }
+
+    /**
+     * Answers whether this module is available on the current system.
+     *
+     * @return 'true' if the module is available, 'false' otherwise.
+     */
+    static bool IsAvailable(void) {
+        return true;
+    }
+
+    /** Ctor. */
+    StrideCheck(void);
+
+    /** Dtor. */
+    virtual ~StrideCheck(void);
+
+protected:
+    /**
+     * Implementation of 'Create'.
+     *
+     * @return 'true' on success, 'false' otherwise.
+     */
+    virtual bool create(void);
+
+    /**
+     * Implementation of 'Release'.
+     */
+    virtual void release(void);
+
+    /**
+     * Perform the work of a thread.
+     *
+     * @param userData Unused.
+     *
+     * @return 0 if all frames match, -1 otherwise.
+     */
+    virtual DWORD Run(void* userData);
+
+private:
+    /** The slot getting the trajectory */
+    core::CallerSlot dataCallerSlot;
+
+    /** The first frame to check */
+    core::param::ParamSlot firstFrameSlot;
+
+    /** The number of frames to check, 0 for all remaining frames */
+    core::param::ParamSlot frameCountSlot;
+};
+
+} /* end namespace protein */
+} /* end namespace megamol */
+
+#endif /* MMPROTEINPLUGIN_STRIDECHECK_H_INCLUDED */
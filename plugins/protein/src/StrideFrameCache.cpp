@@ -0,0 +1,111 @@
+/*
+ * StrideFrameCache.cpp
+ *
+ * Copyright (C) 2022 by University of Stuttgart (VISUS).
+ * All rights reserved.
+ */
+
+#include "StrideFrameCache.h"
+#include "stdafx.h"
+
+#include "Stride.h"
+
+#include "mmcore/utility/TaskScheduler.h"
+
+using namespace megamol;
+using namespace megamol::protein;
+using namespace megamol::protein_calls;
+
+
+/*
+ * StrideFrameCache::StrideFrameCache
+ */
+StrideFrameCache::StrideFrameCache(void) : dataHash(0) {}
+
+
+/*
+ * StrideFrameCache::~StrideFrameCache
+ */
+StrideFrameCache::~StrideFrameCache(void) {}
+
+
+/*
+ * StrideFrameCache::Clear
+ */
+void StrideFrameCache::Clear(void) {
+    this->frames.clear();
+    this->dataHash = 0;
+}
+
+
+/*
+ * StrideFrameCache::Compute
+ */
+std::size_t StrideFrameCache::Compute(const MolecularDataCall* mol, const std::vector<FramePositions>& positions) {
+    if (mol == nullptr) {
+        return 0;
+    }
+    if (mol->DataHash() != this->dataHash) {
+        this->frames.clear();
+        this->dataHash = mol->DataHash();
+    }
+
+    // Create the entries of all missing frames up front, such that the
+    // workers only write to distinct, already existing elements.
+    std::vector<std::pair<const float*, Frame*>> todo;
+    for (auto const& f : positions) {
+        if ((f.second != nullptr) && (this->frames.find(f.first) == this->frames.end())) {
+            todo.emplace_back(f.second, &this->frames[f.first]);
+        }
+    }
+
+    // Every frame is processed by its own Stride instance. Stride is not
+    // cheap to set up, so one frame per task is the right granularity.
+    core::utility::ParallelFor<std::size_t>(0, todo.size(), 1, [&](std::size_t first, std::size_t last) {
+        for (auto i = first; i < last; ++i) {
+            Stride stride(mol, todo[i].first);
+            stride.GetStructureCodes(mol, todo[i].second->codes);
+            todo[i].second->hBonds = stride.GetHydrogenBonds();
+        }
+    });
+
+    return todo.size();
+}
+
+
+/*
+ * StrideFrameCache::IsCached
+ */
+bool StrideFrameCache::IsCached(const MolecularDataCall* mol, unsigned int frameID) const {
+    return (mol != nullptr) && (mol->DataHash() == this->dataHash) && (this->frames.count(frameID) > 0);
+}
+
+
+/*
+ * StrideFrameCache::GetStructureCodes
+ */
+const std::vector<char>* StrideFrameCache::GetStructureCodes(unsigned int frameID) const {
+    auto it = this->frames.find(frameID);
+    return (it != this->frames.end()) ? &it->second.codes : nullptr;
+}
+
+
+/*
+ * StrideFrameCache::GetHydrogenBonds
+ */
+const std::vector<unsigned int>* StrideFrameCache::GetHydrogenBonds(unsigned int frameID) const {
+    auto it = this->frames.find(frameID);
+    return (it != this->frames.end()) ? &it->second.hBonds : nullptr;
+}
+
+
+/*
+ * StrideFrameCache::WriteToInterface
+ */
+bool StrideFrameCache::WriteToInterface(MolecularDataCall* mol, unsigned int frameID) const {
+    auto it = this->frames.find(frameID);
+    if ((mol == nullptr) || (it == this->frames.end())) {
+        return false;
+    }
+    return Stride::WriteStructureCodes(mol, it->second.codes, it->second.hBonds);
+}
@@ -0,0 +1,109 @@
+/*
+ * StrideFrameCache.h
+ *
+ * Copyright (C) 2022 by University of Stuttgart (VISUS).
+ * All rights reserved.
+ */
+
+#ifndef MMPROTEINPLUGIN_STRIDEFRAMECACHE_H_INCLUDED
+#define MMPROTEINPLUGIN_STRIDEFRAMECACHE_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "protein_calls/MolecularDataCall.h"
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace megamol {
+namespace protein {
+
+/**
+ * Computes the STRIDE secondary structure for many frames of a trajectory in
+ * parallel and caches the result of each frame by its frame ID.
+ *
+ * Per frame only the STRIDE code of every residue and the hydrogen bonds are
+ * kept, which is all that is needed to set the secondary structure to a
+ * MolecularDataCall. All frames must share the topology of the call used for
+ * computing them; the cache is dropped as soon as the data hash changes.
+ */
+class StrideFrameCache {
+public:
+    /** The atom positions of a frame along with its frame ID. */
+    typedef std::pair<unsigned int, const float*> FramePositions;
+
+    StrideFrameCache(void);
+
+    virtual ~StrideFrameCache(void);
+
+    /**
+     * Drops all cached frames.
+     */
+    void Clear(void);
+
+    /**
+     * Computes the secondary structure of all given frames that are not
+     * cached yet. The frames are processed in parallel on the task scheduler.
+     *
+     * @param mol       The call providing the topology. It is only read.
+     * @param positions The positions of the frames to compute.
+     *
+     * @return The number of frames that have been computed.
+     */
+    std::size_t Compute(const protein_calls::MolecularDataCall* mol, const std::vector<FramePositions>& positions);
+
+    /**
+     * Answer whether the secondary structure of the given frame is cached
+     * for the data hash of 'mol'.
+     */
+    bool IsCached(const protein_calls::MolecularDataCall* mol, unsigned int frameID) const;
+
+    /**
+     * Answer the cached STRIDE codes of the given frame, one per residue.
+     *
+     * @return The codes or nullptr if the frame is not cached.
+     */
+    const std::vector<char>* GetStructureCodes(unsigned int frameID) const;
+
+    /**
+     * Answer the cached hydrogen bonds of the given frame as pairs of donor
+     * and acceptor atom indices.
+     *
+     * @return The hydrogen bonds or nullptr if the frame is not cached.
+     */
+    const std::vector<unsigned int>* GetHydrogenBonds(unsigned int frameID) const;
+
+    /**
+     * Sets the cached secondary structure and hydrogen bonds of the given
+     * frame to the call.
+     *
+     * @param mol     The call to write to.
+     * @param frameID The frame to write.
+     *
+     * @return true if the frame is cached and contains secondary structure
+     *         elements, false otherwise.
+     */
+    bool WriteToInterface(protein_calls::MolecularDataCall* mol, unsigned int frameID) const;
+
+private:
+    /** The secondary structure of a single frame. */
+    typedef struct {
+        /** One STRIDE code per residue (0 if not assigned). */
+        std::vector<char> codes;
+        /** Pairs of donor and acceptor atom indices. */
+        std::vector<unsigned int> hBonds;
+    } Frame;
+
+    /** The data hash the cached frames belong to. */
+    std::size_t dataHash;
+
+    /** The cached frames, indexed by frame ID. */
+    std::unordered_map<unsigned int, Frame> frames;
+};
+
+} /* end namespace protein */
+} /* end namespace megamol */
+
+#endif /* MMPROTEINPLUGIN_STRIDEFRAMECACHE_H_INCLUDED */
@@ -9,6 +9,7 @@
 
 // jobs
 #include "PDBWriter.h"
+#include "StrideCheck.h"
 #include "VTIWriter.h"
 
 
@@ -103,6 +104,7 @@ public:
         this->module_descriptions.RegisterAutoDescription<megamol::protein::VTILoader>();
         this->module_descriptions.RegisterAutoDescription<megamol::protein::PDBWriter>();
         this->module_descriptions.RegisterAutoDescription<megamol::protein::VTIWriter>();
+        this->module_descriptions.RegisterAutoDescription<megamol::protein::StrideCheck>();
         this->module_descriptions.RegisterAutoDescription<megamol::protein::VMDDXLoader>();
         this->module_descriptions.RegisterAutoDescription<megamol::protein::TrajectorySmoothFilter>();
 
@@ -4,6 +4,8 @@
 #pragma once
 #endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
 
+#include <vector>
+
 #include "geometry_calls/MultiParticleDataCall.h"
 #include "trisoup/trisoupVolumetricDataCall.h"
 #include "vislib/Array.h"
@@ -15,15 +17,13 @@
 #include "vislib/math/mathtypes.h"
 #include "vislib/sys/CriticalSection.h"
 
-/** forward declaration */
-namespace megamol::trisoup_gl::volumetrics {
-class VoluMetricJob;
-}
-
 namespace megamol {
 namespace trisoup {
 namespace volumetrics {
 
+/** forward declaration */
+class VoluMetricComputation;
+
 /** typdef steering the arithmetic precision of the voxelizer. */
 typedef /*float*/ double VoxelizerFloat;
 
@@ -209,21 +209,20 @@ struct FatVoxel {
      */
     VoxelizerFloat distField;
 
-    /** Pointer to the memory holding numTriangles * 3 * 3 VoxelizerFloats. */
-    VoxelizerFloat* triangles;
-
     /**
-     * Pointer to the memory holding numTriangles VoxelizerFloats containing the
-     * volume associated with each triangle.
+     * Pointer to the storage of the cell geometry: numTriangles * 3 * 3 VoxelizerFloats holding the
+     * triangles, followed by the volumes() and corners() of the triangles. The storage is owned by
+     * the voxelizer, see StorageSize().
      */
-    VoxelizerFloat* volumes;
+    VoxelizerFloat* triangles;
 
     /**
-     * Pointer to the memory holding numTriangles unsigned chars containing the
-     * respective corner the tet was anchored on. Can be used for growing the
-     * trivial neighbors.
+     * BorderVoxel containing a copy of the geometry for those FatVoxels that
+     * potentially touch other subvolumes. This memory must NOT be deleted alongside
+     * the FatVoxel since it is linked for fast access/deduplication, but needs to
+     * survive the volume itself.
      */
-    unsigned char* corners;
+    BorderVoxelElement borderVoxel;
 
     /** Number of triangles contained in this FatVoxel */
     unsigned char numTriangles;
@@ -240,19 +239,38 @@ struct FatVoxel {
      */
     /*unsigned*/ short consumedTriangles;
 
-    /**
-     * BorderVoxel containing a copy of the geometry for those FatVoxels that
-     * potentially touch other subvolumes. This memory must NOT be deleted alongside
-     * the FatVoxel since it is linked for fast access/deduplication, but needs to
-     * survive the volume itself.
-     */
-    BorderVoxelElement borderVoxel;
-
     /**
      * thomasbm: surface that might enclose all surfaces withing this voxel.
      * This is used to detect and remove entirely enclosed surfaces.
      */
     //class Surface *enclosingCandidate;
+
+    /**
+     * Answer the volumes associated with each triangle, numTriangles VoxelizerFloats.
+     */
+    VISLIB_FORCEINLINE VoxelizerFloat* volumes(void) const {
+        return this->triangles + 3 * 3 * this->numTriangles;
+    }
+
+    /**
+     * Answer the respective corners the tets of the triangles were anchored on, numTriangles
+     * unsigned chars. Can be used for growing the trivial neighbors.
+     */
+    VISLIB_FORCEINLINE unsigned char* corners(void) const {
+        return reinterpret_cast<unsigned char*>(this->triangles + 3 * 3 * this->numTriangles + this->numTriangles);
+    }
+
+    /**
+     * Answer the number of VoxelizerFloats needed to store the geometry of a cell.
+     *
+     * @param numTriangles the number of triangles in the cell
+     *
+     * @return the size of the storage 'triangles' points to
+     */
+    VISLIB_FORCEINLINE static unsigned int StorageSize(unsigned int numTriangles) {
+        return (3 * 3 + 1) * numTriangles +
+               (numTriangles + sizeof(VoxelizerFloat) - 1) / sizeof(VoxelizerFloat);
+    }
 };
 
 /**
@@ -428,8 +446,11 @@ struct SubJobData {
      */
     VoxelizerFloat CellSize;
 
-    /** datacall that gives access to the particles */
-    geocalls::MultiParticleDataCall* datacall;
+    /**
+     * Particles that may influence the subvolume as x, y, z and the radius already multiplied
+     * by RadMult. Only these are sampled by the job.
+     */
+    std::vector<float> Particles;
 
     /** here the Job should store its results */
     SubJobResult Result;
@@ -437,7 +458,7 @@ struct SubJobData {
     /** whether to persist the geometry computation takes place on (in result.mesh) */
     bool storeMesh, storeVolume;
 
-    trisoup_gl::volumetrics::VoluMetricJob* parent;
+    VoluMetricComputation* parent;
 
     VISLIB_FORCEINLINE unsigned cellIndex(const vislib::math::Point<unsigned, 3>& p) {
         return cellIndex(p.X(), p.Y(), p.Z());
@@ -0,0 +1,97 @@
+#ifndef MEGAMOLCORE_TETRAVOXELIZER_H_INCLUDED
+#define MEGAMOLCORE_TETRAVOXELIZER_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "trisoup/volumetrics/JobStructures.h"
+#include "trisoup/volumetrics/TagVolume.h"
+#include "vislib/math/ShallowShallowTriangle.h"
+
+namespace megamol {
+namespace trisoup {
+namespace volumetrics {
+
+/**
+ * Voxelizes the particles of one subvolume into a distance field, extracts the surfaces with
+ * marching tetrahedra and stitches them with the surfaces of the finished neighboring subvolumes.
+ * One instance processes one SubJobData at a time and can be reused for the next one.
+ */
+class TetraVoxelizer {
+public:
+    TetraVoxelizer(void);
+    ~TetraVoxelizer(void);
+
+    VoxelizerFloat GetOffset(VoxelizerFloat fValue1, VoxelizerFloat fValue2, VoxelizerFloat fValueDesired);
+
+    void growSurfaceFromTriangle(
+        FatVoxel* theVolume, unsigned int x, unsigned int y, unsigned int z, unsigned seedTriIndex, Surface& surf);
+
+    /**
+     * also does compute fullFaces
+     */
+    VoxelizerFloat growVolume(
+        FatVoxel* theVolume, Surface& surf, const vislib::math::Point<int, 3>& seed, bool emptyVolume);
+
+    bool CellHasNoGeometry(FatVoxel* theVolume, unsigned x, unsigned y, unsigned z);
+
+    bool CellFull(FatVoxel* theVolume, unsigned x, unsigned y, unsigned z);
+
+    void MarchCell(FatVoxel* theVolume, unsigned int x, unsigned int y, unsigned int z);
+
+    void CollectCell(FatVoxel* theVolume, unsigned int x, unsigned int y, unsigned int z);
+
+    void DetectEncapsulatedSurfs();
+
+    static int tets[6][4];
+    static vislib::math::Point<int, 3> cornerNeighbors[8][7];
+    static vislib::math::Point<int, 3> moreNeighbors[6];
+
+    /**
+     * Processes a subvolume and stores the surfaces in its Result.
+     *
+     * @param sjd The subvolume to work on.
+     *
+     * @return 0 on success, negative on error.
+     */
+    int Run(SubJobData* sjd);
+
+private:
+    void debugPrintTriangle(vislib::math::ShallowShallowTriangle<float, 3>& tri);
+    void debugPrintTriangle(vislib::math::ShallowShallowTriangle<double, 3>& tri);
+
+    void ProcessTriangle(vislib::math::ShallowShallowTriangle<VoxelizerFloat, 3>& sstI, FatVoxel& f,
+        unsigned triIdx, Surface& surf, unsigned int x, unsigned int y, unsigned int z);
+
+    /**
+     * Answer storage for the geometry of a cell, see FatVoxel::StorageSize. The storage stays valid
+     * until the next call to Run.
+     */
+    VoxelizerFloat* allocateCellStorage(unsigned int numTriangles);
+
+    SubJobData* sjd;
+
+    std::deque<vislib::math::Point<unsigned int, 4>> cellFIFO;
+
+    /** the cells whose borderVoxel has been set while collecting the current surface */
+    std::vector<FatVoxel*> borderCells;
+
+    /** blocks holding the geometry of all cells of the current subvolume */
+    std::vector<std::unique_ptr<VoxelizerFloat[]>> cellStorage;
+
+    /** the number of blocks in use */
+    size_t cellStorageBlock;
+
+    /** the number of VoxelizerFloats used of the current block */
+    size_t cellStorageUsed;
+};
+
+} /* end namespace volumetrics */
+} /* end namespace trisoup */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_TETRAVOXELIZER_H_INCLUDED */
@@ -0,0 +1,217 @@
+/*
+ * VoluMetricComputation.h
+ *
+ * Copyright (C) 2010 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOLCORE_VOLUMETRICCOMPUTATION_H_INCLUDED
+#define MEGAMOLCORE_VOLUMETRICCOMPUTATION_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "geometry_calls/MultiParticleDataCall.h"
+#include "mmcore/utility/TaskScheduler.h"
+#include "trisoup/volumetrics/JobStructures.h"
+#include "vislib/math/Cuboid.h"
+#include "vislib/sys/File.h"
+
+namespace megamol {
+namespace trisoup {
+namespace volumetrics {
+
+class TetraVoxelizer;
+
+/**
+ * Computes metrics about the volume occupied by a number of (spherical) glyphs, i.e. the surfaces
+ * enclosing the glyphs, their area, volume and the void volume next to them. The domain is split into
+ * subvolumes that are voxelized by TetraVoxelizer jobs on the core task scheduler. Finished subvolumes
+ * are stitched with their finished neighbors, so partial results can be queried while the jobs run.
+ *
+ * The computation does not need any graphics API, it is shared by the interactive VoluMetricJob and
+ * the headless jobs.
+ */
+class VoluMetricComputation {
+public:
+    /** The parameters of a computation */
+    struct Settings {
+        /** multiplier for the particle radius */
+        VoxelizerFloat RadiusMultiplier = 1.0;
+
+        /** fraction of the minimal particle radius that is used as cell size */
+        VoxelizerFloat CellSizeRatio = 0.5;
+
+        /** maximum edge length of a subvolume processed as a separate job */
+        int SubVolumeResolution = 128;
+
+        /** whether the jobs keep the surface triangles */
+        bool StoreMesh = false;
+
+        /** whether the jobs keep the sampled volumes */
+        bool StoreVolume = false;
+    };
+
+    /** The metrics of the surfaces, accumulated per unique global ID */
+    struct Statistics {
+        vislib::Array<unsigned int> UniqueIDs;
+        vislib::Array<SIZE_T> CountPerID;
+        vislib::Array<VoxelizerFloat> SurfPerID;
+        vislib::Array<VoxelizerFloat> VolPerID;
+        vislib::Array<VoxelizerFloat> VoidVolPerID;
+    };
+
+    /**
+     * Callback reporting the number of finished and of all subvolumes. It is called from the thread
+     * running Compute, once after the jobs have been scheduled and whenever jobs have finished.
+     */
+    typedef std::function<void(unsigned int finished, unsigned int total)> ProgressCallback;
+
+    /** Ctor. */
+    VoluMetricComputation(void);
+
+    /** Dtor. */
+    ~VoluMetricComputation(void);
+
+    /**
+     * Computes the surfaces of the particles of the current frame of a data call. Blocks until all
+     * subvolumes have been processed or the computation has been cancelled.
+     *
+     * @param datacall the call holding the particles
+     * @param settings the parameters of the computation
+     * @param progress called whenever subvolumes have finished
+     *
+     * @return true on success, false on error or if cancelled
+     */
+    bool Compute(geocalls::MultiParticleDataCall& datacall, const Settings& settings,
+        const ProgressCallback& progress = ProgressCallback());
+
+    /**
+     * Computes the surfaces of a set of spheres.
+     *
+     * @param particles x, y, z and radius of each sphere
+     * @param bounds    the domain to compute the surfaces in
+     * @param settings  the parameters of the computation
+     * @param progress  called whenever subvolumes have finished
+     *
+     * @return true on success, false on error or if cancelled
+     */
+    bool Compute(const std::vector<float>& particles, const vislib::math::Cuboid<VoxelizerFloat>& bounds,
+        const Settings& settings, const ProgressCallback& progress = ProgressCallback());
+
+    /**
+     * Asks a running computation to stop. Subvolumes not yet started are skipped.
+     */
+    void Cancel(void);
+
+    /**
+     * Releases the subvolumes and their results.
+     */
+    void Clear(void);
+
+    /**
+     * Joins the surfaces of all finished subvolumes and accumulates their metrics per global ID.
+     * Can be called while the computation is running.
+     *
+     * @param stats receives the metrics
+     */
+    void GenerateStatistics(Statistics& stats);
+
+    /**
+     * Adds the volumes of enclosed surfaces to the enclosing ones, logs the metrics and writes them
+     * to a file.
+     *
+     * @param frameNumber the frame the metrics belong to
+     * @param stats       the metrics from GenerateStatistics, updated in place
+     * @param file        the file to write to, may be NULL
+     */
+    void OutputStatistics(unsigned int frameNumber, Statistics& stats, vislib::sys::File* file);
+
+    /** Answer the domain split into subvolumes. */
+    inline const vislib::math::Cuboid<VoxelizerFloat>& GetBounds(void) const {
+        return this->bounds;
+    }
+
+    /** Answer the number of subvolumes along x. */
+    inline int GetDivX(void) const {
+        return this->divX;
+    }
+
+    /** Answer the number of subvolumes along y. */
+    inline int GetDivY(void) const {
+        return this->divY;
+    }
+
+    /** Answer the number of subvolumes along z. */
+    inline int GetDivZ(void) const {
+        return this->divZ;
+    }
+
+    bool areSurfacesJoinable(int sjdIdx1, int surfIdx1, int sjdIdx2, int surfIdx2);
+
+    // thomasbm: full enclosing test for two surfaces specified by global-id
+    bool testFullEnclosing(
+        int enclosingIdx, int enclosedIdx, vislib::Array<vislib::Array<Surface*>>& globaIdSurfaces);
+
+    unsigned int MaxGlobalID;
+
+    vislib::sys::CriticalSection AccessMaxGlobalID;
+
+    vislib::sys::CriticalSection RewriteGlobalID;
+
+    // thomasbm: TODO: use hash table here!? STL-version?
+    vislib::Array<BoundingBox<unsigned>> globalIdBoxes;
+
+    vislib::Array<SubJobData*> SubJobDataList;
+
+private:
+    /**
+     * Answer whether two BorderVoxel arrays touch at least in one place.
+     *
+     * @param border1 the first BorderVoxel array
+     * @param border2 the second BorderVoxel array
+     *
+     * @return whether they touch
+     */
+    bool doBordersTouch(BorderVoxelArray& border1, BorderVoxelArray& border2);
+
+    bool isSurfaceJoinableWithSubvolume(SubJobData* surfJob, int surfIdx, SubJobData* volume);
+
+    void joinSurfaces(int sjdIdx1, int surfIdx1, int sjdIdx2, int surfIdx2);
+
+    /** Answer an idle voxelizer, voxelizers are kept to reuse their cell storage. */
+    std::unique_ptr<TetraVoxelizer> acquireVoxelizer(void);
+
+    /** Returns a voxelizer to the idle ones. */
+    void releaseVoxelizer(std::unique_ptr<TetraVoxelizer> voxelizer);
+
+    VoxelizerFloat MaxRad;
+
+    VoxelizerFloat MinRad;
+
+    vislib::math::Cuboid<VoxelizerFloat> bounds;
+
+    int divX;
+    int divY;
+    int divZ;
+
+    /** cancels the subvolumes of the running computation, replaced for every computation */
+    core::utility::CancellationSource cancellation;
+
+    std::mutex cancellationLock;
+
+    std::mutex voxelizerLock;
+
+    std::vector<std::unique_ptr<TetraVoxelizer>> idleVoxelizers;
+};
+
+} /* end namespace volumetrics */
+} /* end namespace trisoup */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_VOLUMETRICCOMPUTATION_H_INCLUDED */
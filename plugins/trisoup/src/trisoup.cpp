@@ -12,6 +12,8 @@
 #include "trisoup/CallBinaryVolumeData.h"
 #include "trisoup/trisoupVolumetricDataCall.h"
 #include "vislib/Trace.h"
+#include "volumetrics/VoluMetricBenchmark.h"
+#include "volumetrics/VoluMetricStatisticsJob.h"
 
 namespace megamol::trisoup {
 class TrisoupPluginInstance : public megamol::core::utility::plugins::AbstractPluginInstance {
@@ -32,6 +34,8 @@ public:
         // register modules
         this->module_descriptions.RegisterAutoDescription<megamol::trisoup::WavefrontObjWriter>();
         this->module_descriptions.RegisterAutoDescription<megamol::quartz::OSCBFix>();
+        this->module_descriptions.RegisterAutoDescription<megamol::trisoup::volumetrics::VoluMetricStatisticsJob>();
+        this->module_descriptions.RegisterAutoDescription<megamol::trisoup::volumetrics::VoluMetricBenchmark>();
 
         // register calls
         this->call_descriptions.RegisterAutoDescription<megamol::trisoup::CallBinaryVolumeData>();
@@ -1,18 +1,24 @@
-#include "TetraVoxelizer.h"
-#include "VoluMetricJob.h"
-#include "geometry_calls/MultiParticleDataCall.h"
+#include "trisoup/volumetrics/TetraVoxelizer.h"
 #include "mmcore/utility/log/Log.h"
+#include "mmcore/utility/sys/Thread.h"
 #include "stdafx.h"
 #include "trisoup/volumetrics/JobStructures.h"
 #include "trisoup/volumetrics/MarchingCubeTables.h"
+#include "trisoup/volumetrics/VoluMetricComputation.h"
 #include "vislib/math/ShallowPoint.h"
 #include "vislib/math/Vector.h"
 #include <cfloat>
 #include <climits>
 
 using namespace megamol;
-using namespace megamol::trisoup_gl;
-using namespace megamol::trisoup_gl::volumetrics;
+using namespace megamol::trisoup::volumetrics;
+
+namespace {
+
+/** number of VoxelizerFloats per block of cell storage */
+constexpr size_t cellStorageBlockSize = 1 << 16;
+
+} // namespace
 
 int TetraVoxelizer::tets[6][4] = {{0, 2, 3, 7}, {0, 2, 6, 7}, {0, 4, 6, 7}, {0, 6, 1, 2}, {0, 6, 1, 4}, {5, 6, 1, 4}};
 
@@ -83,17 +89,32 @@ void TetraVoxelizer::debugPrintTriangle(vislib::math::ShallowShallowTriangle<dou
         tri.PeekCoordinates()[2][2]);
 }
 
-TetraVoxelizer::TetraVoxelizer(void) : terminate(false), sjd(NULL) {
+TetraVoxelizer::TetraVoxelizer(void) : sjd(NULL), cellStorageBlock(0), cellStorageUsed(0) {
     //triangleSoup.SetCapacityIncrement(90); // AKA 10 triangles?
 }
 
 
 TetraVoxelizer::~TetraVoxelizer(void) {}
 
-bool TetraVoxelizer::CellHasNoGeometry(trisoup::volumetrics::FatVoxel* theVolume, unsigned x, unsigned y, unsigned z) {
+VoxelizerFloat* TetraVoxelizer::allocateCellStorage(unsigned int numTriangles) {
+    const size_t size = FatVoxel::StorageSize(numTriangles);
+    ASSERT(size <= cellStorageBlockSize);
+    if (this->cellStorageBlock == 0 || this->cellStorageUsed + size > cellStorageBlockSize) {
+        if (this->cellStorageBlock == this->cellStorage.size()) {
+            this->cellStorage.emplace_back(new VoxelizerFloat[cellStorageBlockSize]);
+        }
+        ++this->cellStorageBlock;
+        this->cellStorageUsed = 0;
+    }
+    VoxelizerFloat* storage = this->cellStorage[this->cellStorageBlock - 1].get() + this->cellStorageUsed;
+    this->cellStorageUsed += size;
+    return storage;
+}
+
+bool TetraVoxelizer::CellHasNoGeometry(FatVoxel* theVolume, unsigned x, unsigned y, unsigned z) {
     //   unsigned int i;
     //   bool neg = false, pos = false;
-    //   trisoup::volumetrics::VoxelizerFloat f;
+    //   VoxelizerFloat f;
 
     //   for (i = 0; i < 8; i++) {
     //       f = theVolume[sjd->cellIndx(
@@ -114,7 +135,7 @@ bool TetraVoxelizer::CellHasNoGeometry(trisoup::volumetrics::FatVoxel* theVolume
     return theVolume[index].mcCase == 255 || theVolume[index].mcCase == 0;
 }
 
-bool TetraVoxelizer::CellFull(trisoup::volumetrics::FatVoxel* theVolume, unsigned x, unsigned y, unsigned z) {
+bool TetraVoxelizer::CellFull(FatVoxel* theVolume, unsigned x, unsigned y, unsigned z) {
     //unsigned int i;
     //bool neg = true;
     //float f;
@@ -133,11 +154,11 @@ bool TetraVoxelizer::CellFull(trisoup::volumetrics::FatVoxel* theVolume, unsigne
 }
 
 void TetraVoxelizer::CollectCell(
-    trisoup::volumetrics::FatVoxel* theVolume, unsigned int x, unsigned int y, unsigned int z) {
+    FatVoxel* theVolume, unsigned int x, unsigned int y, unsigned int z) {
     if (CellHasNoGeometry(theVolume, x, y, z))
         return;
 
-    trisoup::volumetrics::FatVoxel& cell = theVolume[sjd->cellIndex(x, y, z)];
+    FatVoxel& cell = theVolume[sjd->cellIndex(x, y, z)];
 
     // WTF ?
     //    if (cell.numTriangles > 0)
@@ -153,26 +174,28 @@ void TetraVoxelizer::CollectCell(
             continue;
 
         // this is a new surface
-        trisoup::volumetrics::Surface surf;
+        Surface surf;
         surf.border->SetCapacityIncrement(10);
         surf.mesh.SetCapacityIncrement(90);
-        surf.surface = static_cast<trisoup::volumetrics::VoxelizerFloat>(0.0);
-        surf.volume = static_cast<trisoup::volumetrics::VoxelizerFloat>(0.0);
-        surf.voidVolume = static_cast<trisoup::volumetrics::VoxelizerFloat>(0.0); // this is empty as well ...
+        surf.surface = static_cast<VoxelizerFloat>(0.0);
+        surf.volume = static_cast<VoxelizerFloat>(0.0);
+        surf.voidVolume = static_cast<VoxelizerFloat>(0.0); // this is empty as well ...
         surf.fullFaces = 0;
         surf.globalID = UINT_MAX;
 
-        for (SIZE_T cellIdx = 0; cellIdx < static_cast<SIZE_T>(sjd->resX * sjd->resY * sjd->resZ); cellIdx++)
-            theVolume[cellIdx].borderVoxel = NULL;
+        // border voxels are per surface, only the cells touched by the previous one need to be reset
+        for (FatVoxel* borderCell : this->borderCells)
+            borderCell->borderVoxel = NULL;
+        this->borderCells.clear();
 
-        cellFIFO.Append(vislib::math::Point<unsigned int, 4>(x, y, z, triIdx));
+        cellFIFO.push_back(vislib::math::Point<unsigned int, 4>(x, y, z, triIdx));
 #ifdef ULTRADEBUG
         megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_INFO,
             "[%08u] appending  (%04u, %04u, %04u)[%u]\n", vislib::sys::Thread::CurrentID(), x, y, z, l);
 #endif /* ULTRADEBUG */
-        while (cellFIFO.Count() > 0) {
-            vislib::math::Point<unsigned int, 4> p = cellFIFO.First();
-            cellFIFO.RemoveFirst();
+        while (!cellFIFO.empty()) {
+            vislib::math::Point<unsigned int, 4> p = cellFIFO.front();
+            cellFIFO.pop_front();
 #ifdef ULTRADEBUG
             megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_INFO,
                 "[%08u] growing    (%04u, %04u, %04u)[%u]\n", vislib::sys::Thread::CurrentID(), p.X(), p.Y(), p.Z(),
@@ -190,18 +213,18 @@ void TetraVoxelizer::CollectCell(
     } /* end for */
 }
 
-trisoup::volumetrics::VoxelizerFloat TetraVoxelizer::GetOffset(trisoup::volumetrics::VoxelizerFloat fValue1,
-    trisoup::volumetrics::VoxelizerFloat fValue2, trisoup::volumetrics::VoxelizerFloat fValueDesired) {
-    trisoup::volumetrics::VoxelizerFloat fDelta = fValue2 - fValue1;
-    ASSERT(fDelta != static_cast<trisoup::volumetrics::VoxelizerFloat>(0));
-    trisoup::volumetrics::VoxelizerFloat res = (fValueDesired - fValue1) / fDelta;
-    ASSERT(res <= static_cast<trisoup::volumetrics::VoxelizerFloat>(1) &&
-           res >= static_cast<trisoup::volumetrics::VoxelizerFloat>(0));
+VoxelizerFloat TetraVoxelizer::GetOffset(VoxelizerFloat fValue1,
+    VoxelizerFloat fValue2, VoxelizerFloat fValueDesired) {
+    VoxelizerFloat fDelta = fValue2 - fValue1;
+    ASSERT(fDelta != static_cast<VoxelizerFloat>(0));
+    VoxelizerFloat res = (fValueDesired - fValue1) / fDelta;
+    ASSERT(res <= static_cast<VoxelizerFloat>(1) &&
+           res >= static_cast<VoxelizerFloat>(0));
     return res;
 }
 
-trisoup::volumetrics::VoxelizerFloat TetraVoxelizer::growVolume(trisoup::volumetrics::FatVoxel* theVolume,
-    trisoup::volumetrics::Surface& surf, const vislib::math::Point<int, 3>& seed, bool emptyVolume) {
+VoxelizerFloat TetraVoxelizer::growVolume(FatVoxel* theVolume,
+    Surface& surf, const vislib::math::Point<int, 3>& seed, bool emptyVolume) {
     SIZE_T cells = 0;
     vislib::math::Point<int, 3> p;
     vislib::Array<vislib::math::Point<int, 3>> queue;
@@ -212,7 +235,7 @@ trisoup::volumetrics::VoxelizerFloat TetraVoxelizer::growVolume(trisoup::volumet
     while (queue.Count() > 0) {
         p = queue.Last();
         queue.RemoveLast();
-        trisoup::volumetrics::FatVoxel& cell = theVolume[sjd->cellIndex(p)];
+        FatVoxel& cell = theVolume[sjd->cellIndex(p)];
 
         if (!emptyVolume) {
             ASSERT(cell.mcCase == 255 && vislib::math::Abs(cell.consumedTriangles) < 2);
@@ -254,7 +277,7 @@ trisoup::volumetrics::VoxelizerFloat TetraVoxelizer::growVolume(trisoup::volumet
                 vislib::math::Point<int, 3> neighbCrd(p.X() + mN.X(), p.Y() + mN.Y(), p.Z() + mN.Z());
 
                 if (sjd->coordsInside(neighbCrd)) {
-                    trisoup::volumetrics::FatVoxel& neighbCell = theVolume[sjd->cellIndex(neighbCrd)];
+                    FatVoxel& neighbCell = theVolume[sjd->cellIndex(neighbCrd)];
 
                     if (!emptyVolume) {
                         if (neighbCell.mcCase == 255 && neighbCell.consumedTriangles == 0) {
@@ -292,11 +315,11 @@ trisoup::volumetrics::VoxelizerFloat TetraVoxelizer::growVolume(trisoup::volumet
 /**
  * TODO: sinnvoller Kommentar! bissle erklaeren!
  */
-void TetraVoxelizer::growSurfaceFromTriangle(trisoup::volumetrics::FatVoxel* theVolume, unsigned int x, unsigned int y,
-    unsigned int z, unsigned seedTriIndex, trisoup::volumetrics::Surface& surf) {
-    typedef vislib::math::ShallowShallowTriangle<trisoup::volumetrics::VoxelizerFloat, 3> Triangle;
+void TetraVoxelizer::growSurfaceFromTriangle(FatVoxel* theVolume, unsigned int x, unsigned int y,
+    unsigned int z, unsigned seedTriIndex, Surface& surf) {
+    typedef vislib::math::ShallowShallowTriangle<VoxelizerFloat, 3> Triangle;
 
-    trisoup::volumetrics::FatVoxel& cell = theVolume[sjd->cellIndex(x, y, z)];
+    FatVoxel& cell = theVolume[sjd->cellIndex(x, y, z)];
     //int currSurfID = MarchingCubeTables::a2ucTriangleSurfaceID[cell.mcCase][seedTriIndex];
 
     // first, grow the full neighbors
@@ -304,7 +327,7 @@ void TetraVoxelizer::growSurfaceFromTriangle(trisoup::volumetrics::FatVoxel* the
     for (unsigned int cornerIdx = 0; cornerIdx < 8; cornerIdx++) {
         //if (!(cell.mcCase & (1 << cornerIdx))) continue;
         //#pragma message(__LOC__"Guido's Code  mit cell.corners wurde hier auskommentiert - liegt der Bug wirklich daran?!")
-        int fullNeighb = cell.mcCase & (1 << cornerIdx) & cell.corners[seedTriIndex];
+        int fullNeighb = cell.mcCase & (1 << cornerIdx) & cell.corners()[seedTriIndex];
 
         for (unsigned int cornerNeighbIdx = 0; cornerNeighbIdx < 7; cornerNeighbIdx++) {
             vislib::math::Point<int, 3>& cN = cornerNeighbors[cornerIdx][cornerNeighbIdx];
@@ -313,7 +336,7 @@ void TetraVoxelizer::growSurfaceFromTriangle(trisoup::volumetrics::FatVoxel* the
 
             if (sjd->coordsInside(crnCrd)) {
                 // der aktuelle Nachbar
-                trisoup::volumetrics::FatVoxel& neighbCell = theVolume[sjd->cellIndex(crnCrd)];
+                FatVoxel& neighbCell = theVolume[sjd->cellIndex(crnCrd)];
 
                 if (fullNeighb) {
                     // 'neighbCell' located completely inside?
@@ -347,7 +370,7 @@ void TetraVoxelizer::growSurfaceFromTriangle(trisoup::volumetrics::FatVoxel* the
                 if (inCellSurf & (1 << niTriIdx)) {
                     Triangle neighbTriangle(cell.triangles + 3 * 3 * niTriIdx);
                     //if (triangle.HasCommonEdge(neighbTriangle)) {
-                    if (trisoup::volumetrics::Dowel::HaveCommonEdge(triangle, neighbTriangle)) {
+                    if (Dowel::HaveCommonEdge(triangle, neighbTriangle)) {
                         inCellSurf |= (1 << triIdx);
                         foundNew = true;
                     }
@@ -356,7 +379,7 @@ void TetraVoxelizer::growSurfaceFromTriangle(trisoup::volumetrics::FatVoxel* the
         }
     } while (foundNew);
 
-    trisoup::volumetrics::VoxelizerFloat cellVolume = 0;
+    VoxelizerFloat cellVolume = 0;
     bool collected = false;
     for (int triIdx = 0; triIdx < cell.numTriangles; triIdx++) {
         // is this part of the in-cell surface?
@@ -367,7 +390,7 @@ void TetraVoxelizer::growSurfaceFromTriangle(trisoup::volumetrics::FatVoxel* the
         if (!(cell.consumedTriangles & (1 << triIdx))) {
             ProcessTriangle(triangle, cell, triIdx, surf, x, y, z);
             cell.consumedTriangles |= (1 << triIdx);
-            cellVolume += cell.volumes[triIdx];
+            cellVolume += cell.volumes()[triIdx];
             collected = true;
         }
 
@@ -380,8 +403,8 @@ void TetraVoxelizer::growSurfaceFromTriangle(trisoup::volumetrics::FatVoxel* the
             if (!sjd->coordsInside(neighbCrd))
                 continue;
 
-            trisoup::volumetrics::FatVoxel& neighbCell = theVolume[sjd->cellIndex(neighbCrd)];
-            trisoup::volumetrics::VoxelizerFloat niCellVolume = 0;
+            FatVoxel& neighbCell = theVolume[sjd->cellIndex(neighbCrd)];
+            VoxelizerFloat niCellVolume = 0;
             bool niCollected = false;
 
             for (int niTriIdx = 0; niTriIdx < neighbCell.numTriangles; niTriIdx++) {
@@ -396,7 +419,7 @@ void TetraVoxelizer::growSurfaceFromTriangle(trisoup::volumetrics::FatVoxel* the
                 debugPrintTriangle(neighbTriangle);
                 debugPrintTriangle(triangle);
 #endif /* ULTRADEBUG */
-                if (trisoup::volumetrics::Dowel::HaveCommonEdge(neighbTriangle, triangle)) {
+                if (Dowel::HaveCommonEdge(neighbTriangle, triangle)) {
 #ifdef ULTRADEBUG
                     megamol::core::utility::log::Log::DefaultLog.WriteMsg(megamol::core::utility::log::Log::LEVEL_INFO,
                         "[%08u] -> has common edge", vislib::sys::Thread::CurrentID());
@@ -406,11 +429,11 @@ void TetraVoxelizer::growSurfaceFromTriangle(trisoup::volumetrics::FatVoxel* the
                         ProcessTriangle(
                             neighbTriangle, neighbCell, niTriIdx, surf, neighbCrd.X(), neighbCrd.Y(), neighbCrd.Z());
                         neighbCell.consumedTriangles |= (1 << niTriIdx);
-                        niCellVolume += neighbCell.volumes[niTriIdx];
+                        niCellVolume += neighbCell.volumes()[niTriIdx];
                         niCollected = true;
                     }
                     /* this causes a recursive mechanism using a qeue */
-                    cellFIFO.Append(
+                    cellFIFO.push_back(
                         vislib::math::Point<unsigned, 4>(neighbCrd.X(), neighbCrd.Y(), neighbCrd.Z(), niTriIdx));
                 }
             }
@@ -432,25 +455,25 @@ void TetraVoxelizer::growSurfaceFromTriangle(trisoup::volumetrics::FatVoxel* the
 }
 
 /**
- * Adds the triangle 'triangle' with index 'triIdx' inside 'cell' to 'surf' and collects trisoup::volumetrics::Surface and volume data.
+ * Adds the triangle 'triangle' with index 'triIdx' inside 'cell' to 'surf' and collects Surface and volume data.
  */
 VISLIB_FORCEINLINE void TetraVoxelizer::ProcessTriangle(
-    vislib::math::ShallowShallowTriangle<trisoup::volumetrics::VoxelizerFloat, 3>& triangle,
-    trisoup::volumetrics::FatVoxel& cell, unsigned triIdx, trisoup::volumetrics::Surface& surf, unsigned int x,
+    vislib::math::ShallowShallowTriangle<VoxelizerFloat, 3>& triangle,
+    FatVoxel& cell, unsigned triIdx, Surface& surf, unsigned int x,
     unsigned int y, unsigned int z) {
 
-    vislib::math::ShallowShallowTriangle<trisoup::volumetrics::VoxelizerFloat, 3> tmpTriangle(
+    vislib::math::ShallowShallowTriangle<VoxelizerFloat, 3> tmpTriangle(
         cell.triangles + 3 * 3 * triIdx);
 
     /* copy 'triangle' to 'surf.mesh' if we want to store the geometry */
     if (sjd->storeMesh) {
         surf.mesh.SetCount(surf.mesh.Count() + 9);
         tmpTriangle.SetPointer(
-            const_cast<trisoup::volumetrics::VoxelizerFloat*>(surf.mesh.PeekElements() + surf.mesh.Count() - 9));
+            const_cast<VoxelizerFloat*>(surf.mesh.PeekElements() + surf.mesh.Count() - 9));
         tmpTriangle = triangle;
     }
 
-    surf.surface += triangle.Area<trisoup::volumetrics::VoxelizerFloat>();
+    surf.surface += triangle.Area<VoxelizerFloat>();
     //    surf.volume += cell.triangles[triIdx];
 
     // thomasbm: grow bounding volume based on intersecting voxels ...
@@ -459,15 +482,16 @@ VISLIB_FORCEINLINE void TetraVoxelizer::ProcessTriangle(
 
     if (sjd->isBorder(x, y, z)) {
         if (cell.borderVoxel == NULL) {
-            cell.borderVoxel = new trisoup::volumetrics::BorderVoxel();
+            cell.borderVoxel = new BorderVoxel();
             cell.borderVoxel->x = x + sjd->offsetX;
             cell.borderVoxel->y = y + sjd->offsetY;
             cell.borderVoxel->z = z + sjd->offsetZ;
             cell.borderVoxel->triangles.AssertCapacity(cell.numTriangles * 9);
             surf.border->Add(cell.borderVoxel);
+            this->borderCells.push_back(&cell);
         }
         cell.borderVoxel->triangles.SetCount(cell.borderVoxel->triangles.Count() + 9);
-        tmpTriangle.SetPointer(const_cast<trisoup::volumetrics::VoxelizerFloat*>(
+        tmpTriangle.SetPointer(const_cast<VoxelizerFloat*>(
             cell.borderVoxel->triangles.PeekElements() + cell.borderVoxel->triangles.Count() - 9));
         tmpTriangle = triangle;
     }
@@ -483,22 +507,22 @@ VISLIB_FORCEINLINE void TetraVoxelizer::ProcessTriangle(
 }
 
 void TetraVoxelizer::MarchCell(
-    trisoup::volumetrics::FatVoxel* theVolume, unsigned int x, unsigned int y, unsigned int z) {
+    FatVoxel* theVolume, unsigned int x, unsigned int y, unsigned int z) {
 
-    trisoup::volumetrics::FatVoxel& currVoxel = theVolume[sjd->cellIndex(x, y, z)];
+    FatVoxel& currVoxel = theVolume[sjd->cellIndex(x, y, z)];
     currVoxel.consumedTriangles = 0;
     currVoxel.numTriangles = 0;
 
     unsigned int i;
-    trisoup::volumetrics::VoxelizerFloat CubeValues[8];
-    vislib::math::Point<trisoup::volumetrics::VoxelizerFloat, 3> EdgeVertex[12];
+    VoxelizerFloat CubeValues[8];
+    vislib::math::Point<VoxelizerFloat, 3> EdgeVertex[12];
 
     currVoxel.mcCase = 0;
     //Make a local copy of the values at the cube's corners
     for (i = 0; i < 8; i++) {
-        CubeValues[i] = theVolume[sjd->cellIndex(x + trisoup::volumetrics::MarchingCubeTables::a2fVertexOffset[i][0],
-                                      y + trisoup::volumetrics::MarchingCubeTables::a2fVertexOffset[i][1],
-                                      z + trisoup::volumetrics::MarchingCubeTables::a2fVertexOffset[i][2])]
+        CubeValues[i] = theVolume[sjd->cellIndex(x + MarchingCubeTables::a2fVertexOffset[i][0],
+                                      y + MarchingCubeTables::a2fVertexOffset[i][1],
+                                      z + MarchingCubeTables::a2fVertexOffset[i][2])]
                             .distField;
         if (CubeValues[i] < 0.0f)
             currVoxel.mcCase |= 1 << i;
@@ -507,14 +531,12 @@ void TetraVoxelizer::MarchCell(
     if (CellHasNoGeometry(theVolume, x, y, z)) { // || !((x==6) && (y==7) && (z==6))) {
         currVoxel.consumedTriangles = 0;
         currVoxel.triangles = NULL;
-        currVoxel.volumes = NULL;
-        currVoxel.corners = NULL;
         currVoxel.numTriangles = 0;
         return;
     }
 
     // reference corner of this cell
-    vislib::math::Point<trisoup::volumetrics::VoxelizerFloat, 3> p(sjd->Bounds.Left() + x * sjd->CellSize,
+    vislib::math::Point<VoxelizerFloat, 3> p(sjd->Bounds.Left() + x * sjd->CellSize,
         sjd->Bounds.Bottom() + y * sjd->CellSize, sjd->Bounds.Back() + z * sjd->CellSize);
 
     // how many triangles will we get?
@@ -564,14 +586,13 @@ void TetraVoxelizer::MarchCell(
         }
     }
 
-    currVoxel.triangles = new trisoup::volumetrics::VoxelizerFloat[currVoxel.numTriangles * 3 * 3];
-    currVoxel.volumes = new trisoup::volumetrics::VoxelizerFloat[currVoxel.numTriangles];
-    currVoxel.corners = new unsigned char[currVoxel.numTriangles];
-    vislib::math::ShallowShallowTriangle<trisoup::volumetrics::VoxelizerFloat, 3> tri(currVoxel.triangles);
-    vislib::math::ShallowShallowTriangle<trisoup::volumetrics::VoxelizerFloat, 3> tri2(currVoxel.triangles);
-    vislib::math::Point<trisoup::volumetrics::VoxelizerFloat, 3> temp;
-    trisoup::volumetrics::VoxelizerFloat* vol = NULL;
-    trisoup::volumetrics::VoxelizerFloat* vol2 = NULL;
+    currVoxel.triangles = this->allocateCellStorage(currVoxel.numTriangles);
+    unsigned char* corners = currVoxel.corners();
+    vislib::math::ShallowShallowTriangle<VoxelizerFloat, 3> tri(currVoxel.triangles);
+    vislib::math::ShallowShallowTriangle<VoxelizerFloat, 3> tri2(currVoxel.triangles);
+    vislib::math::Point<VoxelizerFloat, 3> temp;
+    VoxelizerFloat* vol = NULL;
+    VoxelizerFloat* vol2 = NULL;
     int triOffset = 0;
 
     // now we repeat this for all six sub-tetrahedra
@@ -586,52 +607,52 @@ void TetraVoxelizer::MarchCell(
         if (CubeValues[tets[tetIdx][3]] < 0.0f)
             triIdx |= 8;
 
-        vislib::math::Point<trisoup::volumetrics::VoxelizerFloat, 3> p0(
-            p.X() + (trisoup::volumetrics::VoxelizerFloat)
-                            trisoup::volumetrics::MarchingCubeTables::a2fVertexOffset[tets[tetIdx][0]][0] *
+        vislib::math::Point<VoxelizerFloat, 3> p0(
+            p.X() + (VoxelizerFloat)
+                            MarchingCubeTables::a2fVertexOffset[tets[tetIdx][0]][0] *
                         sjd->CellSize,
-            p.Y() + (trisoup::volumetrics::VoxelizerFloat)
-                            trisoup::volumetrics::MarchingCubeTables::a2fVertexOffset[tets[tetIdx][0]][1] *
+            p.Y() + (VoxelizerFloat)
+                            MarchingCubeTables::a2fVertexOffset[tets[tetIdx][0]][1] *
                         sjd->CellSize,
-            p.Z() + (trisoup::volumetrics::VoxelizerFloat)
-                            trisoup::volumetrics::MarchingCubeTables::a2fVertexOffset[tets[tetIdx][0]][2] *
+            p.Z() + (VoxelizerFloat)
+                            MarchingCubeTables::a2fVertexOffset[tets[tetIdx][0]][2] *
                         sjd->CellSize);
-        vislib::math::Point<trisoup::volumetrics::VoxelizerFloat, 3> p1(
-            p.X() + (trisoup::volumetrics::VoxelizerFloat)
-                            trisoup::volumetrics::MarchingCubeTables::a2fVertexOffset[tets[tetIdx][1]][0] *
+        vislib::math::Point<VoxelizerFloat, 3> p1(
+            p.X() + (VoxelizerFloat)
+                            MarchingCubeTables::a2fVertexOffset[tets[tetIdx][1]][0] *
                         sjd->CellSize,
-            p.Y() + (trisoup::volumetrics::VoxelizerFloat)
-                            trisoup::volumetrics::MarchingCubeTables::a2fVertexOffset[tets[tetIdx][1]][1] *
+            p.Y() + (VoxelizerFloat)
+                            MarchingCubeTables::a2fVertexOffset[tets[tetIdx][1]][1] *
                         sjd->CellSize,
-            p.Z() + (trisoup::volumetrics::VoxelizerFloat)
-                            trisoup::volumetrics::MarchingCubeTables::a2fVertexOffset[tets[tetIdx][1]][2] *
+            p.Z() + (VoxelizerFloat)
+                            MarchingCubeTables::a2fVertexOffset[tets[tetIdx][1]][2] *
                         sjd->CellSize);
-        vislib::math::Point<trisoup::volumetrics::VoxelizerFloat, 3> p2(
-            p.X() + (trisoup::volumetrics::VoxelizerFloat)
-                            trisoup::volumetrics::MarchingCubeTables::a2fVertexOffset[tets[tetIdx][2]][0] *
+        vislib::math::Point<VoxelizerFloat, 3> p2(
+            p.X() + (VoxelizerFloat)
+                            MarchingCubeTables::a2fVertexOffset[tets[tetIdx][2]][0] *
                         sjd->CellSize,
-            p.Y() + (trisoup::volumetrics::VoxelizerFloat)
-                            trisoup::volumetrics::MarchingCubeTables::a2fVertexOffset[tets[tetIdx][2]][1] *
+            p.Y() + (VoxelizerFloat)
+                            MarchingCubeTables::a2fVertexOffset[tets[tetIdx][2]][1] *
                         sjd->CellSize,
-            p.Z() + (trisoup::volumetrics::VoxelizerFloat)
-                            trisoup::volumetrics::MarchingCubeTables::a2fVertexOffset[tets[tetIdx][2]][2] *
+            p.Z() + (VoxelizerFloat)
+                            MarchingCubeTables::a2fVertexOffset[tets[tetIdx][2]][2] *
                         sjd->CellSize);
-        vislib::math::Point<trisoup::volumetrics::VoxelizerFloat, 3> p3(
-            p.X() + (trisoup::volumetrics::VoxelizerFloat)
-                            trisoup::volumetrics::MarchingCubeTables::a2fVertexOffset[tets[tetIdx][3]][0] *
+        vislib::math::Point<VoxelizerFloat, 3> p3(
+            p.X() + (VoxelizerFloat)
+                            MarchingCubeTables::a2fVertexOffset[tets[tetIdx][3]][0] *
                         sjd->CellSize,
-            p.Y() + (trisoup::volumetrics::VoxelizerFloat)
-                            trisoup::volumetrics::MarchingCubeTables::a2fVertexOffset[tets[tetIdx][3]][1] *
+            p.Y() + (VoxelizerFloat)
+                            MarchingCubeTables::a2fVertexOffset[tets[tetIdx][3]][1] *
                         sjd->CellSize,
-            p.Z() + (trisoup::volumetrics::VoxelizerFloat)
-                            trisoup::volumetrics::MarchingCubeTables::a2fVertexOffset[tets[tetIdx][3]][2] *
+            p.Z() + (VoxelizerFloat)
+                            MarchingCubeTables::a2fVertexOffset[tets[tetIdx][3]][2] *
                         sjd->CellSize);
 
-        trisoup::volumetrics::VoxelizerFloat fullVol = vislib::math::Abs((p1 - p0).Dot((p2 - p0).Cross(p3 - p0))) /
-                                                       static_cast<trisoup::volumetrics::VoxelizerFloat>(6.0);
+        VoxelizerFloat fullVol = vislib::math::Abs((p1 - p0).Dot((p2 - p0).Cross(p3 - p0))) /
+                                                       static_cast<VoxelizerFloat>(6.0);
 
         tri.SetPointer(currVoxel.triangles + 3 * 3 * triOffset);
-        vol = currVoxel.volumes + triOffset;
+        vol = currVoxel.volumes() + triOffset;
         switch (triIdx) {
         case 0x00:
         case 0x0F:
@@ -642,22 +663,22 @@ void TetraVoxelizer::MarchCell(
             //} else {
 
             tri[0] = p0.Interpolate(p1, GetOffset(CubeValues[tets[tetIdx][0]], CubeValues[tets[tetIdx][1]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
             tri[2] = p0.Interpolate(p2, GetOffset(CubeValues[tets[tetIdx][0]], CubeValues[tets[tetIdx][2]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
             tri[1] = p0.Interpolate(p3, GetOffset(CubeValues[tets[tetIdx][0]], CubeValues[tets[tetIdx][3]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
 
             *vol = vislib::math::Abs((tri[0] - p0).Dot((tri[2] - p0).Cross(tri[1] - p0))) /
-                   static_cast<trisoup::volumetrics::VoxelizerFloat>(6.0);
+                   static_cast<VoxelizerFloat>(6.0);
             if (CubeValues[tets[tetIdx][0]] > 0.0) {
                 *vol = fullVol - *vol;
                 // any but 0
-                currVoxel.corners[triOffset] = 1 << tets[tetIdx][1];
-                currVoxel.corners[triOffset] |= 1 << tets[tetIdx][2];
-                currVoxel.corners[triOffset] |= 1 << tets[tetIdx][3];
+                corners[triOffset] = 1 << tets[tetIdx][1];
+                corners[triOffset] |= 1 << tets[tetIdx][2];
+                corners[triOffset] |= 1 << tets[tetIdx][3];
             } else {
-                currVoxel.corners[triOffset] = 1 << tets[tetIdx][0];
+                corners[triOffset] = 1 << tets[tetIdx][0];
             }
             //}
             //tri[0] = p;
@@ -676,22 +697,22 @@ void TetraVoxelizer::MarchCell(
             //    tri[1] = p1.Interpolate(p2, GetOffset(CubeValues[tets[tetIdx][1]], CubeValues[tets[tetIdx][2]], 0.0f));
             //} else {
             tri[0] = p1.Interpolate(p0, GetOffset(CubeValues[tets[tetIdx][1]], CubeValues[tets[tetIdx][0]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
             tri[1] = p1.Interpolate(p3, GetOffset(CubeValues[tets[tetIdx][1]], CubeValues[tets[tetIdx][3]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
             tri[2] = p1.Interpolate(p2, GetOffset(CubeValues[tets[tetIdx][1]], CubeValues[tets[tetIdx][2]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
 
             *vol = vislib::math::Abs((tri[0] - p1).Dot((tri[1] - p1).Cross(tri[2] - p1))) /
-                   static_cast<trisoup::volumetrics::VoxelizerFloat>(6.0);
+                   static_cast<VoxelizerFloat>(6.0);
             if (CubeValues[tets[tetIdx][1]] > 0.0) {
                 *vol = fullVol - *vol;
                 // any but 1
-                currVoxel.corners[triOffset] = 1 << tets[tetIdx][0];
-                currVoxel.corners[triOffset] |= 1 << tets[tetIdx][2];
-                currVoxel.corners[triOffset] |= 1 << tets[tetIdx][3];
+                corners[triOffset] = 1 << tets[tetIdx][0];
+                corners[triOffset] |= 1 << tets[tetIdx][2];
+                corners[triOffset] |= 1 << tets[tetIdx][3];
             } else {
-                currVoxel.corners[triOffset] = 1 << tets[tetIdx][1];
+                corners[triOffset] = 1 << tets[tetIdx][1];
             }
             //}
             //tri[0] = p;
@@ -713,23 +734,23 @@ void TetraVoxelizer::MarchCell(
             //    tri[2] = p1.Interpolate(p3, GetOffset(CubeValues[tets[tetIdx][1]], CubeValues[tets[tetIdx][3]], 0.0f));
             //} else {
             tri[0] = p0.Interpolate(p3, GetOffset(CubeValues[tets[tetIdx][0]], CubeValues[tets[tetIdx][3]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
             tri[1] = p0.Interpolate(p2, GetOffset(CubeValues[tets[tetIdx][0]], CubeValues[tets[tetIdx][2]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
             tri[2] = p1.Interpolate(p3, GetOffset(CubeValues[tets[tetIdx][1]], CubeValues[tets[tetIdx][3]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
 
             // tet3
             *vol = vislib::math::Abs((p0 - p1).Dot((tri[2] - p1).Cross(tri[1] - p1))) /
-                   static_cast<trisoup::volumetrics::VoxelizerFloat>(6.0);
+                   static_cast<VoxelizerFloat>(6.0);
             // tet2
             *vol += vislib::math::Abs((tri[0] - p0).Dot((tri[2] - p0).Cross(tri[1] - p0))) /
-                    static_cast<trisoup::volumetrics::VoxelizerFloat>(6.0);
+                    static_cast<VoxelizerFloat>(6.0);
             if (CubeValues[tets[tetIdx][0]] > 0.0) {
                 // any but 0, 1
-                currVoxel.corners[triOffset] = 1 << tets[tetIdx][2];
+                corners[triOffset] = 1 << tets[tetIdx][2];
             } else {
-                currVoxel.corners[triOffset] = 1 << tets[tetIdx][0];
+                corners[triOffset] = 1 << tets[tetIdx][0];
             }
             //}
             //tri[0] = p;
@@ -740,14 +761,14 @@ void TetraVoxelizer::MarchCell(
             //tri[0].p[2] = VertexInterp(iso,g.p[v1],g.p[v3],g.val[v1],g.val[v3]);
             triOffset++;
             tri2.SetPointer(currVoxel.triangles + 3 * 3 * triOffset);
-            vol2 = currVoxel.volumes + triOffset;
+            vol2 = currVoxel.volumes() + triOffset;
             tri2[0] = tri[2];
             tri2[1] = p1.Interpolate(p2, GetOffset(CubeValues[tets[tetIdx][1]], CubeValues[tets[tetIdx][2]],
-                                             static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                             static_cast<VoxelizerFloat>(0)));
             tri2[2] = tri[1];
             // tet1
             *vol2 = vislib::math::Abs((tri2[1] - p1).Dot((tri[1] - p1).Cross(tri[2] - p1))) /
-                    static_cast<trisoup::volumetrics::VoxelizerFloat>(6.0);
+                    static_cast<VoxelizerFloat>(6.0);
             //tri2[0] = p;
             //tri2[1] = p;
             //tri2[2] = p;
@@ -759,9 +780,9 @@ void TetraVoxelizer::MarchCell(
                 *vol = fullVol - (*vol + *vol2);
                 *vol2 = 0.0;
                 // any but 0, 1
-                currVoxel.corners[triOffset] = 1 << tets[tetIdx][3];
+                corners[triOffset] = 1 << tets[tetIdx][3];
             } else {
-                currVoxel.corners[triOffset] = 1 << tets[tetIdx][1];
+                corners[triOffset] = 1 << tets[tetIdx][1];
             }
             triOffset++;
             break;
@@ -773,22 +794,22 @@ void TetraVoxelizer::MarchCell(
             //    tri[1] = p2.Interpolate(p3, GetOffset(CubeValues[tets[tetIdx][2]], CubeValues[tets[tetIdx][3]], 0.0f));
             //} else {
             tri[0] = p2.Interpolate(p0, GetOffset(CubeValues[tets[tetIdx][2]], CubeValues[tets[tetIdx][0]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
             tri[1] = p2.Interpolate(p1, GetOffset(CubeValues[tets[tetIdx][2]], CubeValues[tets[tetIdx][1]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
             tri[2] = p2.Interpolate(p3, GetOffset(CubeValues[tets[tetIdx][2]], CubeValues[tets[tetIdx][3]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
 
             *vol = vislib::math::Abs((tri[0] - p2).Dot((tri[1] - p2).Cross(tri[2] - p2))) /
-                   static_cast<trisoup::volumetrics::VoxelizerFloat>(6.0);
+                   static_cast<VoxelizerFloat>(6.0);
             if (CubeValues[tets[tetIdx][2]] > 0.0) {
                 *vol = fullVol - *vol;
                 // any but 2
-                currVoxel.corners[triOffset] = 1 << tets[tetIdx][0];
-                currVoxel.corners[triOffset] |= 1 << tets[tetIdx][1];
-                currVoxel.corners[triOffset] |= 1 << tets[tetIdx][3];
+                corners[triOffset] = 1 << tets[tetIdx][0];
+                corners[triOffset] |= 1 << tets[tetIdx][1];
+                corners[triOffset] |= 1 << tets[tetIdx][3];
             } else {
-                currVoxel.corners[triOffset] = 1 << tets[tetIdx][2];
+                corners[triOffset] = 1 << tets[tetIdx][2];
             }
             //}
             //tri[0] = p;
@@ -806,20 +827,20 @@ void TetraVoxelizer::MarchCell(
             // tetrahedron 2: around p0: p0->p3, p2->p3, p0->p1
             // tetrahedron 3: around p2: p0, p2->p3, p0->p1
             tri[0] = p0.Interpolate(p1, GetOffset(CubeValues[tets[tetIdx][0]], CubeValues[tets[tetIdx][1]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
             tri[1] = p2.Interpolate(p3, GetOffset(CubeValues[tets[tetIdx][2]], CubeValues[tets[tetIdx][3]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
             tri[2] = p0.Interpolate(p3, GetOffset(CubeValues[tets[tetIdx][0]], CubeValues[tets[tetIdx][3]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
 
             // tet2
             *vol = vislib::math::Abs((tri[2] - p0).Dot((tri[1] - p0).Cross(tri[0] - p0))) /
-                   static_cast<trisoup::volumetrics::VoxelizerFloat>(6.0);
+                   static_cast<VoxelizerFloat>(6.0);
             if (CubeValues[tets[tetIdx][0]] > 0.0) {
                 // any but 0, 2
-                currVoxel.corners[triOffset] = 1 << tets[tetIdx][1];
+                corners[triOffset] = 1 << tets[tetIdx][1];
             } else {
-                currVoxel.corners[triOffset] = 1 << tets[tetIdx][0];
+                corners[triOffset] = 1 << tets[tetIdx][0];
             }
             //tri[0] = p;
             //tri[1] = p;
@@ -829,18 +850,18 @@ void TetraVoxelizer::MarchCell(
             //tri[0].p[2] = VertexInterp(iso,g.p[v0],g.p[v3],g.val[v0],g.val[v3]);
             triOffset++;
             tri2.SetPointer(currVoxel.triangles + 3 * 3 * triOffset);
-            vol2 = currVoxel.volumes + triOffset;
+            vol2 = currVoxel.volumes() + triOffset;
             tri2[0] = tri[0];
             tri2[1] = p1.Interpolate(p2, GetOffset(CubeValues[tets[tetIdx][1]], CubeValues[tets[tetIdx][2]],
-                                             static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                             static_cast<VoxelizerFloat>(0)));
             tri2[2] = tri[1];
 
             // tet1
             *vol2 = vislib::math::Abs((tri2[1] - p2).Dot((tri[0] - p2).Cross(tri[1] - p2))) /
-                    static_cast<trisoup::volumetrics::VoxelizerFloat>(6.0);
+                    static_cast<VoxelizerFloat>(6.0);
             // tet3
             *vol2 += vislib::math::Abs((p0 - p2).Dot((tri[1] - p2).Cross(tri[0] - p2))) /
-                     static_cast<trisoup::volumetrics::VoxelizerFloat>(6.0);
+                     static_cast<VoxelizerFloat>(6.0);
             //tri2[0] = p;
             //tri2[1] = p;
             //tri2[2] = p;
@@ -852,9 +873,9 @@ void TetraVoxelizer::MarchCell(
                 *vol = fullVol - (*vol + *vol2);
                 *vol2 = 0.0;
                 // any but 0, 2
-                currVoxel.corners[triOffset] = 1 << tets[tetIdx][3];
+                corners[triOffset] = 1 << tets[tetIdx][3];
             } else {
-                currVoxel.corners[triOffset] = 1 << tets[tetIdx][2];
+                corners[triOffset] = 1 << tets[tetIdx][2];
             }
             triOffset++;
             break;
@@ -868,17 +889,17 @@ void TetraVoxelizer::MarchCell(
             // tetrahedron 2: around p2: p2->p3, p1->p3, p0->p2
             // tetrahedron 3: around p1: p2, p1->p3, p0->p2
             tri[0] = p0.Interpolate(p1, GetOffset(CubeValues[tets[tetIdx][0]], CubeValues[tets[tetIdx][1]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
             tri[1] = p1.Interpolate(p3, GetOffset(CubeValues[tets[tetIdx][1]], CubeValues[tets[tetIdx][3]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
             tri[2] = p2.Interpolate(p3, GetOffset(CubeValues[tets[tetIdx][2]], CubeValues[tets[tetIdx][3]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
 
             if (CubeValues[tets[tetIdx][1]] > 0.0) {
                 // any but 1, 2
-                currVoxel.corners[triOffset] = 1 << tets[tetIdx][0];
+                corners[triOffset] = 1 << tets[tetIdx][0];
             } else {
-                currVoxel.corners[triOffset] = 1 << tets[tetIdx][1];
+                corners[triOffset] = 1 << tets[tetIdx][1];
             }
             //tri[0] = p;
             //tri[1] = p;
@@ -890,19 +911,19 @@ void TetraVoxelizer::MarchCell(
             tri2.SetPointer(currVoxel.triangles + 3 * 3 * triOffset);
             tri2[0] = tri[0];
             tri2[1] = p0.Interpolate(p2, GetOffset(CubeValues[tets[tetIdx][0]], CubeValues[tets[tetIdx][2]],
-                                             static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                             static_cast<VoxelizerFloat>(0)));
             tri2[2] = tri[2];
 
             // tet1
             *vol = vislib::math::Abs((tri[0] - p1).Dot((tri2[1] - p1).Cross(tri[1] - p1))) /
-                   static_cast<trisoup::volumetrics::VoxelizerFloat>(6.0);
-            vol2 = currVoxel.volumes + triOffset;
+                   static_cast<VoxelizerFloat>(6.0);
+            vol2 = currVoxel.volumes() + triOffset;
             // tet2
             *vol2 = vislib::math::Abs((tri[2] - p2).Dot((tri[1] - p2).Cross(tri2[1] - p2))) /
-                    static_cast<trisoup::volumetrics::VoxelizerFloat>(6.0);
+                    static_cast<VoxelizerFloat>(6.0);
             // tet3
             *vol2 += vislib::math::Abs((p2 - p1).Dot((tri[1] - p1).Cross(tri2[1] - p1))) /
-                     static_cast<trisoup::volumetrics::VoxelizerFloat>(6.0);
+                     static_cast<VoxelizerFloat>(6.0);
             //tri2[0] = p;
             //tri2[1] = p;
             //tri2[2] = p;
@@ -915,9 +936,9 @@ void TetraVoxelizer::MarchCell(
                 *vol = fullVol - (*vol + *vol2);
                 *vol2 = 0.0;
                 // any but 1, 2
-                currVoxel.corners[triOffset] = 1 << tets[tetIdx][3];
+                corners[triOffset] = 1 << tets[tetIdx][3];
             } else {
-                currVoxel.corners[triOffset] = 1 << tets[tetIdx][2];
+                corners[triOffset] = 1 << tets[tetIdx][2];
             }
             triOffset++;
             break;
@@ -929,22 +950,22 @@ void TetraVoxelizer::MarchCell(
             //    tri[1] = p3.Interpolate(p1, GetOffset(CubeValues[tets[tetIdx][3]], CubeValues[tets[tetIdx][1]], 0.0f));
             //} else {
             tri[0] = p3.Interpolate(p0, GetOffset(CubeValues[tets[tetIdx][3]], CubeValues[tets[tetIdx][0]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
             tri[1] = p3.Interpolate(p2, GetOffset(CubeValues[tets[tetIdx][3]], CubeValues[tets[tetIdx][2]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
             tri[2] = p3.Interpolate(p1, GetOffset(CubeValues[tets[tetIdx][3]], CubeValues[tets[tetIdx][1]],
-                                            static_cast<trisoup::volumetrics::VoxelizerFloat>(0)));
+                                            static_cast<VoxelizerFloat>(0)));
 
             *vol = vislib::math::Abs((tri[0] - p3).Dot((tri[1] - p3).Cross(tri[2] - p3))) /
-                   static_cast<trisoup::volumetrics::VoxelizerFloat>(6.0);
+                   static_cast<VoxelizerFloat>(6.0);
             if (CubeValues[tets[tetIdx][3]] > 0.0) {
                 *vol = fullVol - *vol;
                 // any but 3
-                currVoxel.corners[triOffset] = 1 << tets[tetIdx][0];
-                currVoxel.corners[triOffset] |= 1 << tets[tetIdx][1];
-                currVoxel.corners[triOffset] |= 1 << tets[tetIdx][2];
+                corners[triOffset] = 1 << tets[tetIdx][0];
+                corners[triOffset] |= 1 << tets[tetIdx][1];
+                corners[triOffset] |= 1 << tets[tetIdx][2];
             } else {
-                currVoxel.corners[triOffset] = tets[tetIdx][3];
+                corners[triOffset] = tets[tetIdx][3];
             }
             //}
             //tri[0] = p;
@@ -960,24 +981,24 @@ void TetraVoxelizer::MarchCell(
             if (CubeValues[tets[tetIdx][0]] <= 0 && CubeValues[tets[tetIdx][1]] <= 0 &&
                 CubeValues[tets[tetIdx][2]] <= 0 && CubeValues[tets[tetIdx][3]] <= 0) {
                 *vol = (sjd->CellSize * sjd->CellSize * sjd->CellSize) /
-                       static_cast<trisoup::volumetrics::VoxelizerFloat>(6.0);
+                       static_cast<VoxelizerFloat>(6.0);
             }
         }
     }
 }
 
 
-DWORD TetraVoxelizer::Run(void* userData) {
-    using megamol::core::utility::log::Log;
-
-    unsigned int vertFloatSize = 0;
-    trisoup::volumetrics::VoxelizerFloat currRad = 0.f;
-    //, maxRad = -FLT_MAX;
-    trisoup::volumetrics::VoxelizerFloat currDist;
+int TetraVoxelizer::Run(SubJobData* job) {
+    VoxelizerFloat currRad = 0.f;
+    VoxelizerFloat currDist;
     vislib::math::Point<unsigned int, 3> pStart, pEnd;
-    vislib::math::Point<trisoup::volumetrics::VoxelizerFloat, 3> p;
-    sjd = static_cast<trisoup::volumetrics::SubJobData*>(userData);
-    SIZE_T numNeg = 0, numZero = 0, numPos = 0, numPartSkipped = 0, numPartAdded = 0;
+    vislib::math::Point<VoxelizerFloat, 3> p;
+    this->sjd = job;
+    SIZE_T numNeg = 0, numZero = 0, numPos = 0, numPartAdded = 0;
+
+    this->borderCells.clear();
+    this->cellStorageBlock = 0;
+    this->cellStorageUsed = 0;
 
     // my hacky breakpoint to catch a specific thread ^^ ;-)
     //#ifdef _DEBUG
@@ -986,10 +1007,9 @@ DWORD TetraVoxelizer::Run(void* userData) {
     //        }
     //#endif
 
-    unsigned int fifoEnd = 0, fifoCur = 0;
-    trisoup::volumetrics::FatVoxel* volume = new trisoup::volumetrics::FatVoxel[sjd->resX * sjd->resY * sjd->resZ];
-    // we can do that when using structs ... - its safer doing memzero (in case new members get added to the trisoup::volumetrics::FatVoxel struct)
-    memset(volume, 0, sizeof(trisoup::volumetrics::FatVoxel) * (sjd->resX * sjd->resY * sjd->resZ));
+    FatVoxel* volume = new FatVoxel[sjd->resX * sjd->resY * sjd->resZ];
+    // we can do that when using structs ... - its safer doing memzero (in case new members get added to the FatVoxel struct)
+    memset(volume, 0, sizeof(FatVoxel) * (sjd->resX * sjd->resY * sjd->resZ));
     for (SIZE_T i = 0; i < static_cast<SIZE_T>(sjd->resX * sjd->resY * sjd->resZ); i++) {
         volume[i].distField = FLT_MAX;
         volume[i].borderVoxel = NULL;
@@ -997,123 +1017,64 @@ DWORD TetraVoxelizer::Run(void* userData) {
         //volume[i].enclosingCandidate = 0; // thomasbm
     }
 
-    unsigned int partListCnt = sjd->datacall->GetParticleListCount();
-    for (unsigned int partListI = 0; partListI < partListCnt; partListI++) {
-        geocalls::MultiParticleDataCall::Particles ps = sjd->datacall->AccessParticles(partListI);
-        UINT64 numParticles = ps.GetCount();
-        unsigned int stride = ps.GetVertexDataStride();
-        geocalls::MultiParticleDataCall::Particles::VertexDataType dataType = ps.GetVertexDataType();
-        unsigned char* vertexData = (unsigned char*)ps.GetVertexData();
-        switch (dataType) {
-        case geocalls::MultiParticleDataCall::Particles::VERTDATA_NONE:
+    // sample everything into our temporary volume. The particles have been binned to the subvolumes
+    // they may touch, so no further culling is necessary.
+    const SIZE_T numParticles = sjd->Particles.size() / 4;
+    for (SIZE_T l = 0; l < numParticles; l++) {
+        vislib::math::ShallowPoint<float, 3> sp(sjd->Particles.data() + 4 * l);
+        currRad = sjd->Particles[4 * l + 3];
+
+        int x, y, z;
+        x = static_cast<int>((sp.X() - currRad - sjd->Bounds.Left()) / sjd->CellSize) - 1;
+        if (x < 0)
+            x = 0;
+        y = static_cast<int>((sp.Y() - currRad - sjd->Bounds.Bottom()) / sjd->CellSize) - 1;
+        if (y < 0)
+            y = 0;
+        z = static_cast<int>((sp.Z() - currRad - sjd->Bounds.Back()) / sjd->CellSize) - 1;
+        if (z < 0)
+            z = 0;
+        pStart.Set(x, y, z);
+
+        x = static_cast<int>((sp.X() + currRad - sjd->Bounds.Left()) / sjd->CellSize) + 2;
+        if (x >= static_cast<int>(sjd->resX))
+            x = sjd->resX - 1;
+        y = static_cast<int>((sp.Y() + currRad - sjd->Bounds.Bottom()) / sjd->CellSize) + 2;
+        if (y >= static_cast<int>(sjd->resY))
+            y = sjd->resY - 1;
+        z = static_cast<int>((sp.Z() + currRad - sjd->Bounds.Back()) / sjd->CellSize) + 2;
+        if (z >= static_cast<int>(sjd->resZ))
+            z = sjd->resZ - 1;
+        pEnd.Set(x, y, z);
+
+        if (pStart.X() > pEnd.X() || pStart.Y() > pEnd.Y() || pStart.Z() > pEnd.Z()) {
             continue;
-        case geocalls::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
-            vertFloatSize = 3 * sizeof(float);
-            break;
-        case geocalls::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
-            vertFloatSize = 4 * sizeof(float);
-            break;
-        case geocalls::MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ:
-            Log::DefaultLog.WriteError("This module does not yet like quantized data");
-            return -2;
         }
-    }
-
-    // sample everything into our temporary volume
-    vislib::math::Cuboid<float> bx(sjd->Bounds);
-    vislib::math::Point<trisoup::volumetrics::VoxelizerFloat, 3> Centroid = bx.CalcCenter();
-    trisoup::volumetrics::VoxelizerFloat distOffset =
-        vislib::math::Sqrt(bx.Width() * bx.Width() + bx.Height() * bx.Height() + bx.Depth() * bx.Depth()) /
-        static_cast<trisoup::volumetrics::VoxelizerFloat>(2.0);
-    // TODO: what did this do anyway
-    //trisoup::volumetrics::VoxelizerFloat g = sjd->MaxRad * sjd->RadMult - sjd->MaxRad;
-    //if (g > static_cast<trisoup::volumetrics::VoxelizerFloat>(0)) {
-    //    bx.Grow(2 * g);
-    //}
-
-    for (unsigned int partListI = 0; partListI < partListCnt; partListI++) {
-        geocalls::MultiParticleDataCall::Particles ps = sjd->datacall->AccessParticles(partListI);
-        currRad = ps.GetGlobalRadius() * sjd->RadMult;
-        UINT64 numParticles = ps.GetCount();
-        unsigned int stride = ps.GetVertexDataStride();
-        geocalls::MultiParticleDataCall::Particles::VertexDataType dataType = ps.GetVertexDataType();
-        unsigned char* vertexData = (unsigned char*)ps.GetVertexData();
-        switch (dataType) {
-        case geocalls::MultiParticleDataCall::Particles::VERTDATA_NONE:
-            continue;
-        case geocalls::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
-            vertFloatSize = 3 * sizeof(float);
-            break;
-        case geocalls::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
-            vertFloatSize = 4 * sizeof(float);
-            break;
-        case geocalls::MultiParticleDataCall::Particles::VERTDATA_SHORT_XYZ:
-            Log::DefaultLog.WriteError("This module does not yet like quantized data");
-            return -2;
-        }
-        for (UINT64 l = 0; l < numParticles; l++) {
-            vislib::math::ShallowPoint<float, 3> sp((float*)&vertexData[(vertFloatSize + stride) * l]);
-            if (dataType == geocalls::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR) {
-                currRad = (float)vertexData[(vertFloatSize + stride) * l + 3 * sizeof(float)];
-                currRad *= sjd->RadMult;
-            }
-            if (Centroid.Distance(sp) > currRad + distOffset) {
-                numPartSkipped++;
-                continue;
-            }
-            numPartAdded++;
-
-            int x, y, z;
-            x = static_cast<int>((sp.X() - currRad - sjd->Bounds.Left()) / sjd->CellSize) - 1;
-            if (x < 0)
-                x = 0;
-            y = static_cast<int>((sp.Y() - currRad - sjd->Bounds.Bottom()) / sjd->CellSize) - 1;
-            if (y < 0)
-                y = 0;
-            z = static_cast<int>((sp.Z() - currRad - sjd->Bounds.Back()) / sjd->CellSize) - 1;
-            if (z < 0)
-                z = 0;
-            pStart.Set(x, y, z);
-
-            x = static_cast<int>((sp.X() + currRad - sjd->Bounds.Left()) / sjd->CellSize) + 2;
-            if (x >= static_cast<int>(sjd->resX))
-                x = sjd->resX - 1;
-            y = static_cast<int>((sp.Y() + currRad - sjd->Bounds.Bottom()) / sjd->CellSize) + 2;
-            if (y >= static_cast<int>(sjd->resY))
-                y = sjd->resY - 1;
-            z = static_cast<int>((sp.Z() + currRad - sjd->Bounds.Back()) / sjd->CellSize) + 2;
-            if (z >= static_cast<int>(sjd->resZ))
-                z = sjd->resZ - 1;
-            pEnd.Set(x, y, z);
-
-            for (int z = pStart.Z(); z <= static_cast<int>(pEnd.Z()); z++) {
-                for (int y = pStart.Y(); y <= static_cast<int>(pEnd.Y()); y++) {
-                    for (int x = pStart.X(); x <= static_cast<int>(pEnd.X()); x++) {
-                        // TODO think about this. here the voxel content is determined by a corner
-                        p.Set(sjd->Bounds.Left() + x * sjd->CellSize, sjd->Bounds.Bottom() + y * sjd->CellSize,
-                            sjd->Bounds.Back() + z * sjd->CellSize);
-
-                        // and here it is the center!
-                        //p.Set(
-                        //    sjd->Bounds.Left() + x * sjd->CellSize + sjd->CellSize * 0.5f,
-                        //    sjd->Bounds.Bottom() + y * sjd->CellSize + sjd->CellSize * 0.5f,
-                        //    sjd->Bounds.Back() + z * sjd->CellSize + sjd->CellSize * 0.5f);
-                        currDist = sp.Distance<trisoup::volumetrics::VoxelizerFloat>(p) - currRad;
-                        SIZE_T i = sjd->cellIndex(x, y, z);
-                        //if (x > 5 && x < 8 && z > 4 && z < 8 && y > 6 && y < 9) {
-                        volume[i].distField = vislib::math::Min(volume[i].distField, currDist);
-                        //} else {
-                        //    volume[i].distField = 10000000;
-                        //}
-                        // thomasmbm: i think the 'numNeg'/'numPos' using to determinate full/empty volumes is i not correct, since particle-spheres may overlap!
-                        if (volume[i].distField < 0.0) {
-                            numNeg++;
+        numPartAdded++;
+
+        for (int z = pStart.Z(); z <= static_cast<int>(pEnd.Z()); z++) {
+            for (int y = pStart.Y(); y <= static_cast<int>(pEnd.Y()); y++) {
+                for (int x = pStart.X(); x <= static_cast<int>(pEnd.X()); x++) {
+                    // TODO think about this. here the voxel content is determined by a corner
+                    p.Set(sjd->Bounds.Left() + x * sjd->CellSize, sjd->Bounds.Bottom() + y * sjd->CellSize,
+                        sjd->Bounds.Back() + z * sjd->CellSize);
+
+                    // and here it is the center!
+                    //p.Set(
+                    //    sjd->Bounds.Left() + x * sjd->CellSize + sjd->CellSize * 0.5f,
+                    //    sjd->Bounds.Bottom() + y * sjd->CellSize + sjd->CellSize * 0.5f,
+                    //    sjd->Bounds.Back() + z * sjd->CellSize + sjd->CellSize * 0.5f);
+                    currDist = sp.Distance<VoxelizerFloat>(p) - currRad;
+                    SIZE_T i = sjd->cellIndex(x, y, z);
+                    volume[i].distField = vislib::math::Min(volume[i].distField, currDist);
+                    // thomasmbm: i think the 'numNeg'/'numPos' using to determinate full/empty volumes is i not correct, since particle-spheres may overlap!
+                    if (volume[i].distField < 0.0) {
+                        numNeg++;
+                    } else {
+                        if (volume[i].distField > 0.0) {
+                            numPos++;
                         } else {
-                            if (volume[i].distField > 0.0) {
-                                numPos++;
-                            } else {
-                                numZero++;
-                            }
+                            numZero++;
                         }
                     }
                 }
@@ -1130,7 +1091,7 @@ DWORD TetraVoxelizer::Run(void* userData) {
     //unsigned int rz = sjd->resZ;
     //sjd->resX = sjd->resY = sjd->resZ = 2;
 
-    //trisoup::volumetrics::FatVoxel *tv = new trisoup::volumetrics::FatVoxel[2 * 2 * 2];
+    //FatVoxel *tv = new FatVoxel[2 * 2 * 2];
     //tv[(0 * sjd->resY + 0) * sjd->resX + 0].distField = 0.0;
     //tv[(0 * sjd->resY + 0) * sjd->resX + 1].distField = -0.70710678118654752440084436210485;
     //tv[(0 * sjd->resY + 1) * sjd->resX + 1].distField = -0.70710678118654752440084436210485;
@@ -1143,7 +1104,7 @@ DWORD TetraVoxelizer::Run(void* userData) {
     //MarchCell(tv, 0, 0, 0);
 
     //double mv = 0.0;
-    //trisoup::volumetrics::FatVoxel &currVoxel = tv[(0 * sjd->resY + 0) * sjd->resX + 0];
+    //FatVoxel &currVoxel = tv[(0 * sjd->resY + 0) * sjd->resX + 0];
     //for (unsigned int x = 0; x < currVoxel.numTriangles; x++) {
     //    mv += currVoxel.volumes[x];
     //}
@@ -1158,24 +1119,24 @@ DWORD TetraVoxelizer::Run(void* userData) {
     // does this really define an empty sub-volume?
     if (numNeg == (sjd->resX) * (sjd->resY) * (sjd->resZ)) {
         // totally full
-        trisoup::volumetrics::Surface s;
+        Surface s;
         s.surface = 0.0;
         s.volume = (sjd->resX - 1) * (sjd->resY - 1) * (sjd->resZ - 1) * sjd->CellSize * sjd->CellSize * sjd->CellSize;
         s.voidVolume = 0;
         sjd->Result.surfaces.Append(s);
     } else if (numPartAdded == 0 || numPos == (sjd->resX) * (sjd->resY) * (sjd->resZ)) {
         // totally empty
-        trisoup::volumetrics::Surface s;
+        Surface s;
         s.surface = 0.0;
         s.volume = 0.0; // TODO: negative volume maybe?
         s.voidVolume =
             (sjd->resX - 1) * (sjd->resY - 1) * (sjd->resZ - 1) * sjd->CellSize * sjd->CellSize * sjd->CellSize;
         sjd->Result.surfaces.Append(s);
     } else {
-        // march it
-        for (int x = 0; x < static_cast<int>(sjd->resX) - 1; x++) {
+        // march it, cells are independent, so walk them in memory order
+        for (int z = 0; z < static_cast<int>(sjd->resZ) - 1; z++) {
             for (int y = 0; y < static_cast<int>(sjd->resY) - 1; y++) {
-                for (int z = 0; z < static_cast<int>(sjd->resZ) - 1; z++) {
+                for (int x = 0; x < static_cast<int>(sjd->resX) - 1; x++) {
                     MarchCell(volume, x, y, z);
                 }
             }
@@ -1208,7 +1169,7 @@ DWORD TetraVoxelizer::Run(void* userData) {
         v.origin[2] = sjd->Bounds.Back();
         v.scaling[0] = sjd->CellSize, v.scaling[1] = sjd->CellSize, v.scaling[2] = sjd->CellSize;
         /*            // reference corner of this cell
-            vislib::math::Point<trisoup::volumetrics::VoxelizerFloat, 3> p(sjd->Bounds.Left() + x * sjd->CellSize,
+            vislib::math::Point<VoxelizerFloat, 3> p(sjd->Bounds.Left() + x * sjd->CellSize,
                 sjd->Bounds.Bottom() + y * sjd->CellSize,
                 sjd->Bounds.Back() + z * sjd->CellSize);
                 */
@@ -1216,7 +1177,7 @@ DWORD TetraVoxelizer::Run(void* userData) {
             for (int y = 0; y < static_cast<int>(sjd->resY) - 1; y++) {
                 for (int z = 0; z < static_cast<int>(sjd->resZ) - 1; z++) {
                     unsigned int index = sjd->cellIndex(x, y, z);
-                    trisoup::volumetrics::FatVoxel& fv = volume[index];
+                    FatVoxel& fv = volume[index];
                     if (fv.mcCase == 255 || fv.mcCase == 0) {
                         // if (fv.consumedTriangles != 0) asm { int 3 };
                         v.volumeData[index] =
@@ -1227,22 +1188,8 @@ DWORD TetraVoxelizer::Run(void* userData) {
         }
     }
 
-    // dealloc stuff in volume
-    // dealloc volume as a whole etc.
-    for (int x = 0; x < static_cast<int>(sjd->resX) - 1; x++) {
-        for (int y = 0; y < static_cast<int>(sjd->resY) - 1; y++) {
-            for (int z = 0; z < static_cast<int>(sjd->resZ) - 1; z++) {
-                if (trisoup::volumetrics::MarchingCubeTables::a2ucTriangleConnectionCount
-                        [volume[sjd->cellIndex(x, y, z)].mcCase] > 0) {
-                    ARY_SAFE_DELETE(volume[sjd->cellIndex(x, y, z)].triangles);
-                    ARY_SAFE_DELETE(volume[sjd->cellIndex(x, y, z)].volumes);
-                    ARY_SAFE_DELETE(volume[sjd->cellIndex(x, y, z)].corners);
-                    // do NOT delete!
-                    volume[sjd->cellIndex(x, y, z)].borderVoxel = NULL;
-                }
-            }
-        }
-    }
+    // the cell geometry lives in cellStorage and is reused by the next subvolume, the border voxels
+    // are referenced by the surfaces
     ARY_SAFE_DELETE(volume);
 
 #ifdef ULTRADEBUG
@@ -1270,12 +1217,12 @@ DWORD TetraVoxelizer::Run(void* userData) {
     vislib::Array<unsigned int> joinableSurfs;
     joinableSurfs.SetCapacityIncrement(10);
     for (unsigned int sjdIdx = 0; sjdIdx < sjd->parent->SubJobDataList.Count(); sjdIdx++) {
-        trisoup::volumetrics::SubJobData* parentSubJob = sjd->parent->SubJobDataList[sjdIdx];
+        SubJobData* parentSubJob = sjd->parent->SubJobDataList[sjdIdx];
 
         if (!parentSubJob->Result.done || parentSubJob->Result.surfaces.Count() == 0 || sjdIdx == thisIndex)
             continue;
 
-        vislib::math::Cuboid<trisoup::volumetrics::VoxelizerFloat> box = sjd->Bounds;
+        vislib::math::Cuboid<VoxelizerFloat> box = sjd->Bounds;
         box.Union(parentSubJob->Bounds);
 
         if (box.Volume() > sjd->Bounds.Volume() + parentSubJob->Bounds.Volume())
@@ -1315,7 +1262,7 @@ DWORD TetraVoxelizer::Run(void* userData) {
                     sjd->parent->globalIdBoxes.SetCount(smallest + 1);
 #endif
                 for (unsigned int jsurfIdx = 0; jsurfIdx < joinableSurfs.Count(); jsurfIdx++) {
-                    trisoup::volumetrics::Surface& surf = parentSubJob->Result.surfaces[joinableSurfs[jsurfIdx]];
+                    Surface& surf = parentSubJob->Result.surfaces[joinableSurfs[jsurfIdx]];
 #ifdef PARALLEL_BBOX_COLLECT
                     // thomasbm: gather global surface-bounding boxes
                     //if (surf.globalID ??)
@@ -1339,8 +1286,3 @@ DWORD TetraVoxelizer::Run(void* userData) {
 
     return 0;
 }
-
-bool TetraVoxelizer::Terminate(void) {
-    terminate = true;
-    return true;
-}
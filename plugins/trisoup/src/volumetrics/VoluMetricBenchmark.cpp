@@ -0,0 +1,165 @@
+/*
+ * VoluMetricBenchmark.cpp
+ *
+ * Copyright (C) 2022 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+#include "VoluMetricBenchmark.h"
+#include "mmcore/param/FloatParam.h"
+#include "mmcore/param/IntParam.h"
+#include "mmcore/utility/log/Log.h"
+#include "stdafx.h"
+#include "vislib/math/mathfunctions.h"
+
+#include <chrono>
+#include <cmath>
+
+using namespace megamol::trisoup::volumetrics;
+
+/*
+ * VoluMetricBenchmark::VoluMetricBenchmark
+ */
+VoluMetricBenchmark::VoluMetricBenchmark(void)
+        : core::job::AbstractThreadedJob()
+        , core::Module()
+        , spheresPerAxisSlot("spheresPerAxis", "number of spheres along each axis of the lattice")
+        , radiusSlot("radius", "radius of the spheres")
+        , spacingSlot("spacing", "distance of neighboring sphere centers in radii, the spheres are disjoint above 2")
+        , cellSizeRatioSlot("cellSizeRatioSlot", "Fraction of the minimal particle radius that is used as cell size")
+        , subVolumeResolutionSlot(
+              "subVolumeResolutionSlot", "maximum edge length of a subvolume processed as a separate job")
+        , repetitionsSlot("repetitions", "number of timed runs") {
+
+    this->spheresPerAxisSlot << new core::param::IntParam(16, 1, 1024);
+    this->MakeSlotAvailable(&this->spheresPerAxisSlot);
+
+    this->radiusSlot << new core::param::FloatParam(1.0f, 0.0001f);
+    this->MakeSlotAvailable(&this->radiusSlot);
+
+    this->spacingSlot << new core::param::FloatParam(2.5f, 0.0f);
+    this->MakeSlotAvailable(&this->spacingSlot);
+
+    this->cellSizeRatioSlot << new core::param::FloatParam(0.5f, 0.01f, 10.0f);
+    this->MakeSlotAvailable(&this->cellSizeRatioSlot);
+
+    this->subVolumeResolutionSlot << new core::param::IntParam(128, 16, 2048);
+    this->MakeSlotAvailable(&this->subVolumeResolutionSlot);
+
+    this->repetitionsSlot << new core::param::IntParam(3, 1);
+    this->MakeSlotAvailable(&this->repetitionsSlot);
+}
+
+
+/*
+ * VoluMetricBenchmark::~VoluMetricBenchmark
+ */
+VoluMetricBenchmark::~VoluMetricBenchmark(void) {
+    this->Release();
+}
+
+
+/*
+ * VoluMetricBenchmark::Terminate
+ */
+bool VoluMetricBenchmark::Terminate(void) {
+    this->computation.Cancel();
+    return core::job::AbstractThreadedJob::Terminate();
+}
+
+
+/*
+ * VoluMetricBenchmark::create
+ */
+bool VoluMetricBenchmark::create(void) {
+
+    // Intentionally empty
+
+    return true;
+}
+
+
+/*
+ * VoluMetricBenchmark::release
+ */
+void VoluMetricBenchmark::release(void) {
+    this->computation.Clear();
+}
+
+
+/*
+ * VoluMetricBenchmark::Run
+ */
+DWORD VoluMetricBenchmark::Run(void* userData) {
+    using megamol::core::utility::log::Log;
+
+    const int perAxis = this->spheresPerAxisSlot.Param<core::param::IntParam>()->Value();
+    const float radius = this->radiusSlot.Param<core::param::FloatParam>()->Value();
+    const float spacing = this->spacingSlot.Param<core::param::FloatParam>()->Value() * radius;
+    const int repetitions = this->repetitionsSlot.Param<core::param::IntParam>()->Value();
+
+    VoluMetricComputation::Settings settings;
+    settings.CellSizeRatio = this->cellSizeRatioSlot.Param<core::param::FloatParam>()->Value();
+    settings.SubVolumeResolution = this->subVolumeResolutionSlot.Param<core::param::IntParam>()->Value();
+
+    const size_t count = static_cast<size_t>(perAxis) * perAxis * perAxis;
+    std::vector<float> particles;
+    particles.reserve(count * 4);
+    for (int z = 0; z < perAxis; z++) {
+        for (int y = 0; y < perAxis; y++) {
+            for (int x = 0; x < perAxis; x++) {
+                particles.push_back(x * spacing);
+                particles.push_back(y * spacing);
+                particles.push_back(z * spacing);
+                particles.push_back(radius);
+            }
+        }
+    }
+    // leave a margin of one radius around the lattice so all surfaces are closed
+    const VoxelizerFloat extent = (perAxis - 1) * spacing + radius;
+    const vislib::math::Cuboid<VoxelizerFloat> bounds(-2 * radius, -2 * radius, -2 * radius, extent + radius,
+        extent + radius, extent + radius);
+
+    const bool disjoint = spacing > 2.0f * radius;
+    const double expectedArea = 4.0 * vislib::math::PI_DOUBLE * radius * radius * count;
+    const double expectedVolume = 4.0 / 3.0 * vislib::math::PI_DOUBLE * radius * radius * radius * count;
+
+    Log::DefaultLog.WriteInfo("VoluMetricBenchmark: %u spheres, radius %f, spacing %f", static_cast<unsigned int>(count),
+        radius, spacing);
+
+    VoluMetricComputation::Statistics stats;
+    double total = 0.0;
+    int runs = 0;
+    for (int rep = 0; rep < repetitions && !this->shouldTerminate(); rep++) {
+        auto start = std::chrono::steady_clock::now();
+        if (!this->computation.Compute(particles, bounds, settings)) {
+            Log::DefaultLog.WriteWarn("VoluMetricBenchmark: run %d did not finish", rep);
+            break;
+        }
+        this->computation.GenerateStatistics(stats);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        total += seconds;
+        runs++;
+
+        double area = 0.0, volume = 0.0;
+        for (SIZE_T i = 0; i < stats.SurfPerID.Count(); i++) {
+            area += stats.SurfPerID[i];
+            volume += stats.VolPerID[i];
+        }
+        Log::DefaultLog.WriteInfo("VoluMetricBenchmark: run %d: %f s, %u subvolumes, %u surfaces, area %f, volume %f",
+            rep, seconds, static_cast<unsigned int>(this->computation.SubJobDataList.Count()),
+            static_cast<unsigned int>(stats.UniqueIDs.Count()), area, volume);
+        if (disjoint) {
+            Log::DefaultLog.WriteInfo("VoluMetricBenchmark: expected %u surfaces, area %f (error %.2f%%), "
+                                      "volume %f (error %.2f%%)",
+                static_cast<unsigned int>(count), expectedArea, 100.0 * (area - expectedArea) / expectedArea,
+                expectedVolume, 100.0 * (volume - expectedVolume) / expectedVolume);
+        }
+        this->computation.Clear();
+    }
+
+    if (runs > 0) {
+        Log::DefaultLog.WriteInfo(
+            "VoluMetricBenchmark: %f s on average over %d run(s), %f spheres/s", total / runs, runs, count * runs / total);
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * VoluMetricBenchmark.h
+ *
+ * Copyright (C) 2022 by Universitaet Stuttgart (VISUS).
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOLCORE_VOLUMETRICBENCHMARK_H_INCLUDED
+#define MEGAMOLCORE_VOLUMETRICBENCHMARK_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "mmcore/Module.h"
+#include "mmcore/job/AbstractThreadedJob.h"
+#include "mmcore/param/ParamSlot.h"
+#include "trisoup/volumetrics/VoluMetricComputation.h"
+
+namespace megamol {
+namespace trisoup {
+namespace volumetrics {
+
+/**
+ * Times the volumetric metrics on a synthetic dataset: a cubic lattice of equally sized spheres. If
+ * the spheres do not touch, every sphere is a separate surface with known area and volume, so the
+ * accuracy of the voxelization is logged along with the timings.
+ */
+class VoluMetricBenchmark : public core::job::AbstractThreadedJob, public core::Module {
+public:
+    /**
+     * Answer the name of this module.
+     *
+     * @return The name of this module.
+     */
+    static const char* ClassName(void) {
+        return "VoluMetricBenchmark";
+    }
+
+    /**
+     * Answer a human readable description of this module.
+     *
+     * @return A human readable description of this module.
+     */
+    static const char* Description(void) {
+        return "Times the volumetric metrics on a synthetic lattice of spheres";
+    }
+
+    /**
+     * Answers whether this module is available on the current system.
+     *
+     * @return 'true' if the module is available, 'false' otherwise.
+     */
+    static bool IsAvailable(void) {
+        return true;
+    }
+
+    /** Ctor. */
+    VoluMetricBenchmark(void);
+
+    /** Dtor. */
+    virtual ~VoluMetricBenchmark(void);
+
+    /**
+     * Terminates the job thread, subvolumes not yet started are skipped.
+     *
+     * @return true to acknowledge that the job will finish as soon
+     *         as possible.
+     */
+    virtual bool Terminate(void);
+
+protected:
+    /**
+     * Implementation of 'Create'.
+     *
+     * @return 'true' on success, 'false' otherwise.
+     */
+    virtual bool create(void);
+
+    /**
+     * Implementation of 'Release'.
+     */
+    virtual void release(void);
+
+    /**
+     * Perform the work of a thread.
+     *
+     * @param userData Unused.
+     *
+     * @return 0 on success, negative on error.
+     */
+    virtual DWORD Run(void* userData);
+
+private:
+    /** number of spheres along each axis */
+    core::param::ParamSlot spheresPerAxisSlot;
+
+    core::param::ParamSlot radiusSlot;
+
+    /** distance of neighboring sphere centers in radii */
+    core::param::ParamSlot spacingSlot;
+
+    core::param::ParamSlot cellSizeRatioSlot;
+
+    core::param::ParamSlot subVolumeResolutionSlot;
+
+    core::param::ParamSlot repetitionsSlot;
+
+    VoluMetricComputation computation;
+};
+
+} /* end namespace volumetrics */
+} /* end namespace trisoup */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_VOLUMETRICBENCHMARK_H_INCLUDED */
@@ -0,0 +1,880 @@
+/*
+ * VoluMetricComputation.cpp
+ *
+ * Copyright (C) 2010 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+#include "trisoup/volumetrics/VoluMetricComputation.h"
+#include "mmcore/utility/log/Log.h"
+#include "stdafx.h"
+#include "trisoup/volumetrics/TetraVoxelizer.h"
+#include "vislib/math/ShallowPoint.h"
+#include "vislib/math/ShallowShallowTriangle.h"
+#include "vislib/math/Vector.h"
+#include "vislib/sys/sysfunctions.h"
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
+
+using namespace megamol::trisoup::volumetrics;
+
+namespace {
+
+/*
+bool rayTriangleIntersect(ShallowShallowTriangle<VoxelizerFloat,3>& triangle, ) {
+
+
+    return true;
+}
+*/
+
+/**
+ * returns true if the line starting from 'seedPoint' in direction 'direction' hits the triangle-mesch 'mesh' and the hit point is returned by startPoint+direction*hitfactor.
+ */
+bool hitTriangleMesh(const vislib::Array<VoxelizerFloat>& mesh,
+    const vislib::math::ShallowPoint<VoxelizerFloat, 3>& seedPoint,
+    const vislib::math::Vector<VoxelizerFloat, 3>& direction,
+    VoxelizerFloat* hitFactor) {
+
+    unsigned int triCount = static_cast<unsigned int>(mesh.Count() / (3 * 3));
+    const VoxelizerFloat* triPoints = mesh.PeekElements();
+    for (unsigned int triIdx = 0; triIdx < triCount; triIdx++) {
+        vislib::math::ShallowShallowTriangle<VoxelizerFloat, 3> triangle(
+            const_cast<VoxelizerFloat*>(triPoints + triIdx * 3 * 3));
+
+        vislib::math::Vector<VoxelizerFloat, 3> normal;
+        vislib::math::Vector<VoxelizerFloat, 3> w0(triangle[0] - seedPoint);
+
+        triangle.Normal(normal);
+
+        VoxelizerFloat normDirDot = normal.Dot(direction);
+
+        if (normDirDot < 0.9) // direction from "behind"? invalid/deformed triangle?
+            continue;
+
+        VoxelizerFloat normW0Dot = normal.Dot(w0);
+
+        VoxelizerFloat intersectFactor =
+            normW0Dot / normDirDot; // <triangle[0]-seedPoint,normal> / <direction,normal>
+        if (intersectFactor < 0)    // triangle-plane lies behind the ray starting point (seedPoint)
+            continue;
+
+        // intersect point of ray with triangle plane
+        vislib::math::Point<VoxelizerFloat, 3> projectPoint =
+            seedPoint + direction * intersectFactor;
+
+        // test if the projected point on the triangle plane lies inside the triangle
+        vislib::math::Vector<VoxelizerFloat, 3> u(triangle[1] - triangle[0]);
+        vislib::math::Vector<VoxelizerFloat, 3> v(triangle[2] - triangle[0]);
+        vislib::math::Vector<VoxelizerFloat, 3> w(projectPoint - triangle[0]);
+        //pointInsideTriangle(projectPoint, triangle, normal);
+
+        // is I inside T?
+        VoxelizerFloat uu, uv, vv, wu, wv, D;
+        uu = u.Dot(u);
+        uv = u.Dot(v);
+        vv = v.Dot(v);
+        wu = w.Dot(u);
+        wv = w.Dot(v);
+        D = uv * uv - uu * vv;
+
+        // get and test parametric coords
+        VoxelizerFloat s, t;
+        s = (uv * wv - vv * wu) / D;
+        if (s < 0 || s > 1) // I is outside T
+            continue;
+        t = (uv * wu - uu * wv) / D;
+        if (t < 0 || (s + t) > 1) // I is outside T
+            continue;
+
+        // ray is inside triangle
+        *hitFactor = intersectFactor;
+        return true;
+    }
+
+    return false;
+}
+} // namespace
+
+
+/*
+ * VoluMetricComputation::VoluMetricComputation
+ */
+VoluMetricComputation::VoluMetricComputation(void)
+        : MaxGlobalID(0)
+        , MaxRad(0)
+        , MinRad(0)
+        , divX(0)
+        , divY(0)
+        , divZ(0) {
+    this->globalIdBoxes.SetCapacityIncrement(100); // thomasmbm
+    this->SubJobDataList.SetCapacityIncrement(16);
+}
+
+
+/*
+ * VoluMetricComputation::~VoluMetricComputation
+ */
+VoluMetricComputation::~VoluMetricComputation(void) {
+    this->Clear();
+}
+
+
+/*
+ * VoluMetricComputation::Compute
+ */
+bool VoluMetricComputation::Compute(
+    geocalls::MultiParticleDataCall& datacall, const Settings& settings, const ProgressCallback& progress) {
+    using megamol::core::utility::log::Log;
+
+    std::vector<float> particles;
+    unsigned int partListCnt = datacall.GetParticleListCount();
+    for (unsigned int partListI = 0; partListI < partListCnt; partListI++) {
+        geocalls::MultiParticleDataCall::Particles& ps = datacall.AccessParticles(partListI);
+        UINT64 numParticles = ps.GetCount();
+        unsigned int vertSize;
+        switch (ps.GetVertexDataType()) {
+        case geocalls::MultiParticleDataCall::Particles::VERTDATA_NONE:
+            continue;
+        case geocalls::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZ:
+            vertSize = 3 * sizeof(float);
+            break;
+        case geocalls::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR:
+            vertSize = 4 * sizeof(float);
+            break;
+        default:
+            Log::DefaultLog.WriteError("VoluMetricComputation supports float coordinates only");
+            return false;
+        }
+        // the stride is 0 for tightly packed data
+        unsigned int stride = ps.GetVertexDataStride();
+        if (stride == 0) {
+            stride = vertSize;
+        }
+        const bool hasRadius =
+            (ps.GetVertexDataType() == geocalls::MultiParticleDataCall::Particles::VERTDATA_FLOAT_XYZR);
+        const unsigned char* vertexData = static_cast<const unsigned char*>(ps.GetVertexData());
+        particles.reserve(particles.size() + 4 * numParticles);
+        for (UINT64 l = 0; l < numParticles; l++) {
+            const float* v = reinterpret_cast<const float*>(vertexData + stride * l);
+            particles.push_back(v[0]);
+            particles.push_back(v[1]);
+            particles.push_back(v[2]);
+            particles.push_back(hasRadius ? v[3] : ps.GetGlobalRadius());
+        }
+    }
+
+    vislib::math::Cuboid<VoxelizerFloat> b;
+    if (datacall.AccessBoundingBoxes().IsObjectSpaceClipBoxValid()) {
+        b = datacall.AccessBoundingBoxes().ObjectSpaceClipBox();
+    } else {
+        b = datacall.AccessBoundingBoxes().ObjectSpaceBBox();
+    }
+
+    return this->Compute(particles, b, settings, progress);
+}
+
+
+/*
+ * VoluMetricComputation::Compute
+ */
+bool VoluMetricComputation::Compute(const std::vector<float>& particles,
+    const vislib::math::Cuboid<VoxelizerFloat>& bounds, const Settings& settings, const ProgressCallback& progress) {
+    using megamol::core::utility::log::Log;
+
+    this->Clear();
+    this->MaxGlobalID = 0;
+
+    const SIZE_T numParticles = particles.size() / 4;
+    if (numParticles == 0) {
+        Log::DefaultLog.WriteWarn("VoluMetricComputation: no particles");
+        return true;
+    }
+
+    VoxelizerFloat RadMult = settings.RadiusMultiplier;
+    MaxRad = -FLT_MAX;
+    MinRad = FLT_MAX;
+    for (SIZE_T l = 0; l < numParticles; l++) {
+        VoxelizerFloat currRad = particles[4 * l + 3];
+        if (currRad > MaxRad) {
+            MaxRad = currRad;
+        }
+        if (currRad < MinRad) {
+            MinRad = currRad;
+        }
+    }
+    MaxRad *= RadMult;
+    MinRad *= RadMult;
+    VoxelizerFloat cellSize = MinRad * settings.CellSizeRatio;
+    if (!(cellSize > 0)) {
+        Log::DefaultLog.WriteError("VoluMetricComputation: particles need a positive radius");
+        return false;
+    }
+
+    vislib::math::Cuboid<VoxelizerFloat> b = bounds;
+    int subVolCells = settings.SubVolumeResolution;
+    int resX = (int)((VoxelizerFloat)b.Width() / cellSize) + 2;
+    int resY = (int)((VoxelizerFloat)b.Height() / cellSize) + 2;
+    int resZ = (int)((VoxelizerFloat)b.Depth() / cellSize) + 2;
+    b.SetWidth(resX * cellSize);
+    b.SetHeight(resY * cellSize);
+    b.SetDepth(resZ * cellSize);
+    this->bounds = b;
+
+    divX = 1;
+    divY = 1;
+    divZ = 1;
+
+    while (divX == 1 && divY == 1 && divZ == 1) {
+        subVolCells /= 2;
+        divX = (int)ceil((VoxelizerFloat)resX / subVolCells);
+        divY = (int)ceil((VoxelizerFloat)resY / subVolCells);
+        divZ = (int)ceil((VoxelizerFloat)resZ / subVolCells);
+    }
+
+    Log::DefaultLog.WriteInfo("Grid: %ux%ux%u", divX, divY, divZ);
+    for (int x = 0; x < divX; x++) {
+        for (int y = 0; y < divY; y++) {
+            for (int z = 0; z < divZ; z++) {
+                VoxelizerFloat left = b.Left() + x * subVolCells * cellSize;
+                int restX = resX - x * subVolCells;
+                restX = (restX > subVolCells) ? subVolCells + 1 : restX;
+                VoxelizerFloat right = left + restX * cellSize;
+                VoxelizerFloat bottom = b.Bottom() + y * subVolCells * cellSize;
+                int restY = resY - y * subVolCells;
+                restY = (restY > subVolCells) ? subVolCells + 1 : restY;
+                VoxelizerFloat top = bottom + restY * cellSize;
+                VoxelizerFloat back = b.Back() + z * subVolCells * cellSize;
+                int restZ = resZ - z * subVolCells;
+                restZ = (restZ > subVolCells) ? subVolCells + 1 : restZ;
+                VoxelizerFloat front = back + restZ * cellSize;
+
+                SubJobData* sjd = new SubJobData();
+                sjd->parent = this;
+                sjd->Bounds = vislib::math::Cuboid<VoxelizerFloat>(left, bottom, back, right, top, front);
+                sjd->CellSize = cellSize;
+                sjd->resX = restX;
+                sjd->resY = restY;
+                sjd->resZ = restZ;
+                sjd->offsetX = x * subVolCells;
+                sjd->offsetY = y * subVolCells;
+                sjd->offsetZ = z * subVolCells;
+                sjd->gridX = x;
+                sjd->gridY = y;
+                sjd->gridZ = z;
+                sjd->RadMult = RadMult;
+                sjd->MaxRad = MaxRad / RadMult;
+                sjd->storeMesh = settings.StoreMesh;
+                sjd->storeVolume = settings.StoreVolume;
+                SubJobDataList.Add(sjd);
+            }
+        }
+    }
+
+    // bin the particles to the subvolumes whose cells they can reach, instead of having every job
+    // test all particles. The ranges are one cell wider than what the jobs sample.
+    auto jobRange = [subVolCells, cellSize](VoxelizerFloat lo, VoxelizerFloat hi, VoxelizerFloat origin, int div,
+                        int& first, int& last) {
+        int cellFirst = static_cast<int>(std::floor((lo - origin) / cellSize)) - 2;
+        int cellLast = static_cast<int>(std::floor((hi - origin) / cellSize)) + 3;
+        // a subvolume starting at cell j * subVolCells spans subVolCells + 1 cells
+        first = vislib::math::Max(0, static_cast<int>(std::floor(
+                                         static_cast<double>(cellFirst - 1) / static_cast<double>(subVolCells))));
+        last = vislib::math::Min(div - 1,
+            static_cast<int>(std::floor(static_cast<double>(cellLast) / static_cast<double>(subVolCells))));
+    };
+    for (SIZE_T l = 0; l < numParticles; l++) {
+        const float* part = particles.data() + 4 * l;
+        VoxelizerFloat currRad = part[3] * RadMult;
+        int x0, x1, y0, y1, z0, z1;
+        jobRange(part[0] - currRad, part[0] + currRad, b.Left(), divX, x0, x1);
+        jobRange(part[1] - currRad, part[1] + currRad, b.Bottom(), divY, y0, y1);
+        jobRange(part[2] - currRad, part[2] + currRad, b.Back(), divZ, z0, z1);
+        for (int x = x0; x <= x1; x++) {
+            for (int y = y0; y <= y1; y++) {
+                for (int z = z0; z <= z1; z++) {
+                    std::vector<float>& binned = SubJobDataList[(x * divY + y) * divZ + z]->Particles;
+                    binned.push_back(part[0]);
+                    binned.push_back(part[1]);
+                    binned.push_back(part[2]);
+                    binned.push_back(static_cast<float>(currRad));
+                }
+            }
+        }
+    }
+
+    core::utility::CancellationToken token;
+    {
+        std::lock_guard<std::mutex> lock(this->cancellationLock);
+        this->cancellation = core::utility::CancellationSource();
+        token = this->cancellation.Token();
+    }
+
+    const unsigned int total = static_cast<unsigned int>(SubJobDataList.Count());
+    unsigned int finished = 0;
+    std::mutex finishedLock;
+    std::condition_variable finishedCond;
+    // counts a subvolume as finished even if processing it throws, the progress loop below waits for all of them
+    struct FinishedGuard {
+        unsigned int& finished;
+        std::mutex& lock;
+        std::condition_variable& cond;
+        ~FinishedGuard() {
+            std::lock_guard<std::mutex> guard(this->lock);
+            ++this->finished;
+            this->cond.notify_all();
+        }
+    };
+
+    bool success = true;
+    {
+        core::utility::TaskGroup group;
+        for (unsigned int i = 0; i < total; i++) {
+            SubJobData* sjd = SubJobDataList[i];
+            group.Run([this, sjd, token, &finished, &finishedLock, &finishedCond]() {
+                FinishedGuard guard{finished, finishedLock, finishedCond};
+                if (!token.IsCancelled()) {
+                    std::unique_ptr<TetraVoxelizer> voxelizer = this->acquireVoxelizer();
+                    voxelizer->Run(sjd);
+                    // the particles are not needed any more
+                    std::vector<float>().swap(sjd->Particles);
+                    this->releaseVoxelizer(std::move(voxelizer));
+                }
+            });
+        }
+
+        if (progress) {
+            progress(0, total);
+        }
+        unsigned int reported = 0;
+        while (reported < total) {
+            unsigned int current;
+            {
+                std::unique_lock<std::mutex> lock(finishedLock);
+                finishedCond.wait_for(
+                    lock, std::chrono::milliseconds(500), [&finished, reported]() { return finished != reported; });
+                current = finished;
+            }
+            if (current != reported) {
+                reported = current;
+                if (progress) {
+                    progress(reported, total);
+                }
+            }
+        }
+
+        try {
+            group.Wait();
+        } catch (...) {
+            Log::DefaultLog.WriteError("VoluMetricComputation: a subvolume could not be processed");
+            success = false;
+        }
+    }
+
+    return success && !token.IsCancelled();
+}
+
+
+/*
+ * VoluMetricComputation::Cancel
+ */
+void VoluMetricComputation::Cancel(void) {
+    std::lock_guard<std::mutex> lock(this->cancellationLock);
+    this->cancellation.Cancel();
+}
+
+
+/*
+ * VoluMetricComputation::Clear
+ */
+void VoluMetricComputation::Clear(void) {
+    while (SubJobDataList.Count() > 0) {
+        delete SubJobDataList[0];
+        SubJobDataList.RemoveAt(0);
+    }
+    this->globalIdBoxes.Clear();
+}
+
+
+/*
+ * VoluMetricComputation::acquireVoxelizer
+ */
+std::unique_ptr<TetraVoxelizer> VoluMetricComputation::acquireVoxelizer(void) {
+    std::lock_guard<std::mutex> lock(this->voxelizerLock);
+    if (this->idleVoxelizers.empty()) {
+        return std::make_unique<TetraVoxelizer>();
+    }
+    std::unique_ptr<TetraVoxelizer> voxelizer = std::move(this->idleVoxelizers.back());
+    this->idleVoxelizers.pop_back();
+    return voxelizer;
+}
+
+
+/*
+ * VoluMetricComputation::releaseVoxelizer
+ */
+void VoluMetricComputation::releaseVoxelizer(std::unique_ptr<TetraVoxelizer> voxelizer) {
+    std::lock_guard<std::mutex> lock(this->voxelizerLock);
+    this->idleVoxelizers.push_back(std::move(voxelizer));
+}
+
+
+bool VoluMetricComputation::areSurfacesJoinable(int sjdIdx1, int surfIdx1, int sjdIdx2, int surfIdx2) {
+
+    if (SubJobDataList[sjdIdx1]->Result.surfaces[surfIdx1].globalID !=
+        SubJobDataList[sjdIdx2]->Result.surfaces[surfIdx2].globalID) {
+        if (SubJobDataList[sjdIdx1]->Result.surfaces[surfIdx1].surface == 0.0 &&
+            SubJobDataList[sjdIdx2]->Result.surfaces[surfIdx2].surface == 0.0) {
+            // both are full, can be joined trivially
+            return true;
+        } else if (SubJobDataList[sjdIdx1]->Result.surfaces[surfIdx1].surface == 0.0) {
+            if (isSurfaceJoinableWithSubvolume(SubJobDataList[sjdIdx2], surfIdx2, SubJobDataList[sjdIdx1])) {
+                return true;
+            }
+        } else if (SubJobDataList[sjdIdx2]->Result.surfaces[surfIdx2].surface == 0.0) {
+            if (isSurfaceJoinableWithSubvolume(SubJobDataList[sjdIdx1], surfIdx1, SubJobDataList[sjdIdx2])) {
+                return true;
+            }
+        } else {
+            if (SubJobDataList[sjdIdx1]->Result.surfaces[surfIdx1].border != NULL &&
+                SubJobDataList[sjdIdx2]->Result.surfaces[surfIdx2].border != NULL) {
+                if (doBordersTouch(*SubJobDataList[sjdIdx1]->Result.surfaces[surfIdx1].border,
+                        *SubJobDataList[sjdIdx2]->Result.surfaces[surfIdx2].border)) {
+                    return true;
+                }
+            } else {
+                //ASSERT(false);
+#ifdef ULTRADEBUG
+                megamol::core::utility::log::Log::DefaultLog.WriteInfo(
+                    "tried to compare (%u,%u,%u)[%u,%u][%u]%s with (%u,%u,%u)[%u,%u][%u]%s",
+                    SubJobDataList[sjdIdx1]->gridX, SubJobDataList[sjdIdx1]->gridY, SubJobDataList[sjdIdx1]->gridZ,
+                    sjdIdx1, surfIdx1, SubJobDataList[sjdIdx1]->Result.surfaces[surfIdx1].globalID,
+                    (SubJobDataList[sjdIdx1]->Result.surfaces[surfIdx1].border == NULL ? " (NULL)" : ""),
+                    SubJobDataList[sjdIdx2]->gridX, SubJobDataList[sjdIdx2]->gridY, SubJobDataList[sjdIdx2]->gridZ,
+                    sjdIdx2, surfIdx2, SubJobDataList[sjdIdx2]->Result.surfaces[surfIdx2].globalID,
+                    (SubJobDataList[sjdIdx2]->Result.surfaces[surfIdx2].border == NULL ? " (NULL)" : ""));
+#endif /* ULTRADEBUG */
+            }
+        }
+    }
+    return false;
+}
+
+
+bool VoluMetricComputation::doBordersTouch(
+    BorderVoxelArray& border1, BorderVoxelArray& border2) {
+    for (SIZE_T i = 0; i < border1.Count(); i++) {
+        for (SIZE_T j = 0; j < border2.Count(); j++) {
+            if (border1[i]->doesTouch(border2[j])) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+//VISLIB_FORCEINLINE void VoluMetricComputation::joinSurfaces(vislib::Array<vislib::Array<unsigned int> > &globalSurfaceIDs,
+//                                 int i, int j, int k, int l) {
+//    megamol::core::utility::log::Log::DefaultLog.WriteInfo("joined global IDs %u and %u", globalSurfaceIDs[i][j], globalSurfaceIDs[k][l]);
+//    if (globalSurfaceIDs[k][l] < globalSurfaceIDs[i][j]) {
+//        globalSurfaceIDs[i][j] = globalSurfaceIDs[k][l];
+//    } else {
+//        globalSurfaceIDs[k][l] = globalSurfaceIDs[i][j];
+//    }
+//}
+
+VISLIB_FORCEINLINE void VoluMetricComputation::joinSurfaces(int sjdIdx1, int surfIdx1, int sjdIdx2, int surfIdx2) {
+
+    RewriteGlobalID.Lock();
+
+#ifdef ULTRADEBUG
+    megamol::core::utility::log::Log::DefaultLog.WriteInfo(
+        "joining global IDs (%u,%u,%u)[%u,%u][%u] and (%u,%u,%u)[%u,%u][%u]", SubJobDataList[sjdIdx1]->gridX,
+        SubJobDataList[sjdIdx1]->gridY, SubJobDataList[sjdIdx1]->gridZ, sjdIdx1, surfIdx1,
+        SubJobDataList[sjdIdx1]->Result.surfaces[surfIdx1].globalID, SubJobDataList[sjdIdx2]->gridX,
+        SubJobDataList[sjdIdx2]->gridY, SubJobDataList[sjdIdx2]->gridZ, sjdIdx2, surfIdx2,
+        SubJobDataList[sjdIdx2]->Result.surfaces[surfIdx2].globalID);
+#endif ULTRADEBUG
+    Surface *srcSurf, *dstSurf;
+
+    if (SubJobDataList[sjdIdx2]->Result.surfaces[surfIdx2].globalID <
+        SubJobDataList[sjdIdx1]->Result.surfaces[surfIdx1].globalID) {
+        //SubJobDataList[sjdIdx1]->Result.surfaces[surfIdx1].globalID = SubJobDataList[sjdIdx2]->Result.surfaces[surfIdx2].globalID;
+        srcSurf = &SubJobDataList[sjdIdx2]->Result.surfaces[surfIdx2];
+        dstSurf = &SubJobDataList[sjdIdx1]->Result.surfaces[surfIdx1];
+    } else {
+        //subJobDataList[sjdIdx2]->Result.surfaces[surfIdx2].globalID = subJobDataList[sjdIdx1]->Result.surfaces[surfIdx1].globalID;
+        srcSurf = &SubJobDataList[sjdIdx1]->Result.surfaces[surfIdx1];
+        dstSurf = &SubJobDataList[sjdIdx2]->Result.surfaces[surfIdx2];
+    }
+
+#ifdef PARALLEL_BBOX_COLLECT // cs: RewriteGlobalID
+    if (this->globalIdBoxes.Count() <= srcSurf->globalID)
+        this->globalIdBoxes.SetCount(srcSurf->globalID + 1);
+#endif
+
+    for (unsigned int x = 0; x < SubJobDataList.Count(); x++) {
+        //if (SubJobDataList[x]->Result.done) {
+        for (unsigned int y = 0; y < SubJobDataList[x]->Result.surfaces.Count(); y++) {
+            Surface& surf = SubJobDataList[x]->Result.surfaces[y];
+            if (surf.globalID == dstSurf->globalID) {
+#ifdef PARALLEL_BBOX_COLLECT
+                // thomasbm: gather global surface-bounding boxes
+                this->globalIdBoxes[srcSurf->globalID].Union(srcSurf->boundingBox);
+                this->globalIdBoxes[srcSurf->globalID].Union(surf.boundingBox);
+#endif
+                surf.globalID = srcSurf->globalID;
+            }
+        }
+        //}
+    }
+#ifdef ULTRADEBUG
+    megamol::core::utility::log::Log::DefaultLog.WriteInfo(
+        "joined global IDs (%u,%u,%u)[%u,%u][%u] and (%u,%u,%u)[%u,%u][%u]", SubJobDataList[sjdIdx1]->gridX,
+        SubJobDataList[sjdIdx1]->gridY, SubJobDataList[sjdIdx1]->gridZ, sjdIdx1, surfIdx1,
+        SubJobDataList[sjdIdx1]->Result.surfaces[surfIdx1].globalID, SubJobDataList[sjdIdx2]->gridX,
+        SubJobDataList[sjdIdx2]->gridY, SubJobDataList[sjdIdx2]->gridZ, sjdIdx2, surfIdx2,
+        SubJobDataList[sjdIdx2]->Result.surfaces[surfIdx2].globalID);
+#endif
+    RewriteGlobalID.Unlock();
+}
+
+VISLIB_FORCEINLINE bool VoluMetricComputation::isSurfaceJoinableWithSubvolume(
+    SubJobData* surfJob, int surfIdx, SubJobData* volume) {
+    for (unsigned int i = 0; i < 6; i++) {
+        if (surfJob->Result.surfaces[surfIdx].fullFaces & (1 << i)) {
+            // are they located accordingly to each other?
+            int x = surfJob->offsetX + TetraVoxelizer::moreNeighbors[i].X() * (surfJob->resX - 1);
+            int y = surfJob->offsetY + TetraVoxelizer::moreNeighbors[i].Y() * (surfJob->resY - 1);
+            int z = surfJob->offsetZ + TetraVoxelizer::moreNeighbors[i].Z() * (surfJob->resZ - 1);
+            if (volume->offsetX == x && volume->offsetY == y && volume->offsetZ == z) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void VoluMetricComputation::GenerateStatistics(Statistics& stats) {
+    vislib::Array<unsigned int>& uniqueIDs = stats.UniqueIDs;
+    vislib::Array<SIZE_T>& countPerID = stats.CountPerID;
+    vislib::Array<VoxelizerFloat>& surfPerID = stats.SurfPerID;
+    vislib::Array<VoxelizerFloat>& volPerID = stats.VolPerID;
+    vislib::Array<VoxelizerFloat>& voidVolPerID = stats.VoidVolPerID;
+
+    //globalSurfaceIDs.Clear();
+    uniqueIDs.Clear();
+    countPerID.Clear();
+    surfPerID.Clear();
+    volPerID.Clear();
+    voidVolPerID.Clear();
+
+    vislib::Array<unsigned int> todos;
+    todos.SetCapacityIncrement(10);
+    for (unsigned int i = 0; i < SubJobDataList.Count(); i++) {
+        if (SubJobDataList[i]->Result.done) {
+            todos.Add(i);
+        }
+    }
+
+    if (todos.Count() == 0) {
+        return;
+    }
+
+    //globalSurfaceIDs.SetCount(todos.Count());
+    //unsigned int gsi = 0;
+    for (unsigned int todoIdx = 0; todoIdx < todos.Count(); todoIdx++) {
+        unsigned int todo = todos[todoIdx];
+        SubJobData* sjdTodo = this->SubJobDataList[todo];
+        SIZE_T surfaceCount = sjdTodo->Result.surfaces.Count();
+        //globalSurfaceIDs[todo].SetCount(surfaceCount);
+        for (unsigned int surfIdx = 0; surfIdx < surfaceCount; surfIdx++) {
+            Surface& surf = sjdTodo->Result.surfaces[surfIdx];
+            //globalSurfaceIDs[todo][surfIdx] = gsi++;
+            if (surf.globalID == UINT_MAX) {
+                AccessMaxGlobalID.Lock();
+                if (surf.globalID == UINT_MAX) {
+                    //surf.globalID = this->MaxGlobalID++;
+                    throw new vislib::Exception("surface with no globalID encountered", __FILE__, __LINE__);
+                }
+                AccessMaxGlobalID.Unlock();
+            }
+        }
+    }
+
+restart:
+    for (unsigned int todoIdx = 0; todoIdx < todos.Count(); todoIdx++) {
+        unsigned int todo = todos[todoIdx];
+        SubJobData* sjdTodo = this->SubJobDataList[todo];
+        for (unsigned int surfIdx = 0; surfIdx < sjdTodo->Result.surfaces.Count(); surfIdx++) {
+            for (unsigned int todoIdx2 = todoIdx; todoIdx2 < todos.Count(); todoIdx2++) {
+                unsigned int todo2 = todos[todoIdx2];
+                SubJobData* sjdTodo2 = this->SubJobDataList[todo2];
+                vislib::math::Cuboid<VoxelizerFloat> box = sjdTodo->Bounds;
+                box.Union(sjdTodo2->Bounds);
+                // are these neighbors or in the same subvolume?
+                //if ((todoIdx == todoIdx2) || (c.Volume() <= sjdTodo->Bounds.Volume()
+                if (todo != todo2 && (box.Volume() <= sjdTodo->Bounds.Volume() + sjdTodo2->Bounds.Volume())) {
+                    for (unsigned int surfIdx2 = 0; surfIdx2 < sjdTodo2->Result.surfaces.Count(); surfIdx2++) {
+                        if (areSurfacesJoinable(todo, surfIdx, todo2, surfIdx2)) {
+                            joinSurfaces(todo, surfIdx, todo2, surfIdx2);
+                            goto restart;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    for (unsigned int todoIdx = 0; todoIdx < todos.Count(); todoIdx++) {
+        unsigned int todo = todos[todoIdx];
+        SubJobData* sjdTodo = this->SubJobDataList[todo];
+        for (unsigned int surfIdx = 0; surfIdx < sjdTodo->Result.surfaces.Count(); surfIdx++) {
+            Surface& surf = sjdTodo->Result.surfaces[surfIdx];
+            if (surf.border != NULL && surf.border->Count() > 0) {
+                // TODO: destroy border geometry in cells ALL of whose neighbors are already processed.
+                int numProcessed = 0;
+
+                for (unsigned int neighbIdx = 0; neighbIdx < 6; neighbIdx++) {
+                    int x = sjdTodo->gridX + TetraVoxelizer::moreNeighbors[neighbIdx].X();
+                    int y = sjdTodo->gridY + TetraVoxelizer::moreNeighbors[neighbIdx].Y();
+                    int z = sjdTodo->gridZ + TetraVoxelizer::moreNeighbors[neighbIdx].Z();
+                    if (x == -1 || y == -1 || z == -1 || x >= divX || y >= divY || z >= divZ) {
+                        numProcessed++;
+                    } else {
+                        for (unsigned int todoIdx2 = 0; todoIdx2 < todos.Count(); todoIdx2++) {
+                            SubJobData* sjdTodo2 = this->SubJobDataList[todos[todoIdx2]];
+                            if (sjdTodo2->gridX == x && sjdTodo2->gridY == y && sjdTodo2->gridZ == z) {
+                                ASSERT(sjdTodo2->Result.done);
+                                numProcessed++;
+                                break;
+                            }
+                        }
+                    }
+                }
+                if (numProcessed == 6) {
+                    surf.border = NULL; //->Clear();
+#ifdef ULTRADEBUG
+                    megamol::core::utility::log::Log::DefaultLog.WriteInfo("deleted border of (%u,%u,%u)[%u,%u][%u]",
+                        sjdTodo->gridX, sjdTodo->gridY, sjdTodo->gridZ, todo, surfIdx, surf.globalID);
+#endif /* ULTRADEBUG */
+                }
+            }
+        }
+    }
+
+    for (unsigned int todoIdx = 0; todoIdx < todos.Count(); todoIdx++) {
+        unsigned int todo = todos[todoIdx];
+        SubJobData* sjdTodo = this->SubJobDataList[todo];
+        for (unsigned int surfIdx = 0; surfIdx < sjdTodo->Result.surfaces.Count(); surfIdx++) {
+            Surface& surf = sjdTodo->Result.surfaces[surfIdx];
+            SIZE_T pos = uniqueIDs.IndexOf(surf.globalID);
+            if (pos == vislib::Array<unsigned int>::INVALID_POS) {
+                uniqueIDs.Add(surf.globalID);
+                countPerID.Add(surf.mesh.Count() / 9);
+                surfPerID.Add(surf.surface);
+                volPerID.Add(surf.volume);
+                voidVolPerID.Add(surf.voidVolume);
+                //#ifndef PARALLEL_BBOX_COLLECT
+                //                globalIdBoxes.Add(surf.boundingBox);
+                //#endif
+            } else {
+                countPerID[pos] = countPerID[pos] + (surf.mesh.Count() / 9);
+                surfPerID[pos] = surfPerID[pos] + surf.surface;
+                volPerID[pos] = volPerID[pos] + surf.volume;
+                voidVolPerID[pos] = voidVolPerID[pos] + surf.voidVolume;
+                //#ifndef PARALLEL_BBOX_COLLECT
+                //                globalIdBoxes[pos].Union(surf.boundingBox);
+                //#endif
+            }
+        }
+    }
+}
+
+/**
+ * TODO: sinnvolle erklaerung
+ */
+bool VoluMetricComputation::testFullEnclosing(
+    int enclosingIdx, int enclosedIdx, vislib::Array<vislib::Array<Surface*>>& globaIdSurfaces) {
+    // find a random enlosed surface and ise its first triangle as starting point
+    Surface* enclosedSeed = 0;
+    /*  for(int sjdIdx = 0; sjdIdx < SubJobDataList.Count(); sjdIdx++) {
+            SubJobData *subJob = SubJobDataList[sjdIdx];
+            for (int surfIdx = 0; surfIdx < subJob->Result.surfaces.Count(); surfIdx++)
+                if (subJob->Result.surfaces[surfIdx].globalID==enclosedIdx)
+                    enclosedSeed = &subJob->Result.surfaces[surfIdx];
+        }*/
+    vislib::Array<Surface*> enclosedSurfaces = globaIdSurfaces[enclosedIdx];
+    vislib::Array<Surface*> enclosingSurfaces = globaIdSurfaces[enclosingIdx];
+
+    if (enclosedSurfaces.Count() > 0)
+        enclosedSeed = enclosedSurfaces[0];
+
+    if (!enclosedSeed)
+        return false;
+
+    ASSERT(enclosedSeed->mesh.Count() >= 3);
+
+    vislib::math::ShallowPoint<VoxelizerFloat, 3> seedPoint(
+        /*enclosedSeed->mesh.PeekElements()*/ &enclosedSeed->mesh[0]);
+    // some random direction ...
+    VoxelizerFloat tmpVal(
+        /*static_cast<VoxelizerFloat>(1.0 / sqrt(3.0))*/ 0.34524356);
+    vislib::math::Vector<VoxelizerFloat, 3> direction(tmpVal, 1.2 * tmpVal, -0.86 * tmpVal);
+    direction.Normalise();
+
+    int hitCount = 0;
+
+    for (unsigned int enclosingSIdx = 0; enclosingSIdx < enclosingSurfaces.Count(); enclosingSIdx++) {
+        Surface* surf = enclosingSurfaces[enclosingSIdx];
+        VoxelizerFloat hitFactor;
+        // TODO use surface bounding boxes to speed this up ...
+        // if (surf->boundingBox.Intersect(seedPoint, direction, &hitFactor) && hitFactor > 0){
+        if (hitTriangleMesh(surf->mesh, seedPoint, direction, &hitFactor) && hitFactor > 0) {
+            hitCount++;
+            //    seedPoint = trangleCenter(hitTriangle); // dazu müsste man ein "walkthrough" programmieren ?!
+            // seedPoint += direction*hitFactor; // alternative
+        }
+        //}
+    }
+
+
+    /*    while(true) {
+            SubJobData *sjd = getSubJobForPos(seedPoint);
+            for(int surfIdx = 0; surfIdx < sjd->Result.surfaces.Count(); surfIdx++) {
+                Surface& surf = sjd->Result.surfaces[surfIdx];
+                if (surf.globalID != enclosingIdx)
+                    continue;
+
+                VoxelizerFloat hitFactor;
+                // try bounding box hit first
+                if (surf.boundingBox.Intersect(seedPoint, direction, &hitFactor) && hitFactor > 0) {
+                    if(hitTriangleMesh(seedPoint, direction)) {
+                        hitCount++;
+                        seedPoint = trangleCenter(hitTriangle);
+                    }
+                }
+            }
+            if(hitCount==oldHitCount)
+                gotoNextSubJob();
+            if(borderReached())
+                break
+        }*/
+
+    return (hitCount % 2) != 0;
+}
+
+void VoluMetricComputation::OutputStatistics(unsigned int frameNumber, Statistics& stats, vislib::sys::File* file) {
+    vislib::Array<unsigned int>& uniqueIDs = stats.UniqueIDs;
+    vislib::Array<SIZE_T>& countPerID = stats.CountPerID;
+    vislib::Array<VoxelizerFloat>& surfPerID = stats.SurfPerID;
+    vislib::Array<VoxelizerFloat>& volPerID = stats.VolPerID;
+    vislib::Array<VoxelizerFloat>& voidVolPerID = stats.VoidVolPerID;
+
+#if 0
+    VoxelizerFloat mesh[] = {
+        1, 0, 0, 
+        0, 1, 1,
+        0, -1, 1
+    };
+    vislib::Array<VoxelizerFloat> meshArray(9);
+    for(int i = 0; i < 9; i++)
+        meshArray.Add(mesh[i]);
+    VoxelizerFloat seed[] = {0, 0, 0};
+    vislib::math::ShallowPoint<VoxelizerFloat,3> seedPoint(seed);
+    vislib::math::Vector<VoxelizerFloat,3> direction(-1/sqrt(2.0), 0, -1/sqrt(2.0));
+    VoxelizerFloat hitFactor;
+    hitTriangleMesh(meshArray, seedPoint, direction, &hitFactor);
+#endif
+    // thomasbm: testing ...
+#ifndef PARALLEL_BBOX_COLLECT
+    globalIdBoxes.SetCount(uniqueIDs.Count());
+    vislib::Array<vislib::Array<Surface*>>
+        globaIdSurfaces /*(uniqueIDs.Count(), vislib::Array<Surface*>(10)?)*/;
+    globaIdSurfaces.SetCount(uniqueIDs.Count());
+    for (unsigned int sjdIdx = 0; sjdIdx < SubJobDataList.Count(); sjdIdx++) {
+        SubJobData* subJob = SubJobDataList[sjdIdx];
+        for (unsigned int surfIdx = 0; surfIdx < subJob->Result.surfaces.Count(); surfIdx++) {
+            Surface& surface = subJob->Result.surfaces[surfIdx];
+            int globalId = surface.globalID;
+            int uniqueIdPos = static_cast<int>(uniqueIDs.IndexOf(globalId));
+            globalIdBoxes[uniqueIdPos].Union(surface.boundingBox);
+            globaIdSurfaces[uniqueIdPos].Add(&surface);
+        }
+    }
+#endif
+
+    // thomasbm: final step: find volumes of unique surface id's that contain each other
+    for (unsigned int uidIdx = 0; uidIdx < uniqueIDs.Count(); uidIdx++) {
+        unsigned int gid = uniqueIDs[uidIdx];
+
+#ifndef PARALLEL_BBOX_COLLECT
+        //if (globaIdSurfaces[uidIdx].Count() == 0)
+        //    continue;
+#endif
+
+        for (unsigned int uidIdx2 = uidIdx + 1; uidIdx2 < uniqueIDs.Count(); uidIdx2++) {
+            unsigned int gid2 = uniqueIDs[uidIdx2];
+            if (/*uidIdx2==uidIdx*/ gid == gid2)
+                continue;
+#ifdef PARALLEL_BBOX_COLLECT
+            BoundingBox<unsigned int>& box = globalIdBoxes[gid];
+            BoundingBox<unsigned int>& box2 = globalIdBoxes[gid2];
+#else
+            //if (globaIdSurfaces[uidIdx2].Count() == 0)
+            //    continue;
+            BoundingBox<unsigned int>& box = globalIdBoxes[uidIdx];
+            BoundingBox<unsigned int>& box2 = globalIdBoxes[uidIdx2];
+            if (!box.IsInitialized() || !box2.IsInitialized())
+                continue;
+#endif
+            BoundingBox<unsigned int>::CLASSIFY_STATUS cls = box.Classify(box2);
+            int enclosedIdx, enclosingIdx;
+            if (cls == BoundingBox<unsigned int>::CONTAINS_OTHER) {
+                enclosedIdx = uidIdx2;
+                enclosingIdx = uidIdx;
+            } else if (cls == BoundingBox<unsigned int>::IS_CONTAINED_BY_OTHER) {
+                enclosedIdx = uidIdx;
+                enclosingIdx = uidIdx2;
+            } else
+                continue;
+
+#if 0 // thomasbm: das kann solange nicht funktionieren, wie die Dreiecke nicht richtig orientiert sind (innen/aussen)
+                // full, triangle based test here ... (meshes need to be stored to do so)
+            if(SubJobDataList[0]->storeMesh && !testFullEnclosing(enclosingIdx, enclosedIdx, globaIdSurfaces)) {
+                continue;
+            }
+#endif
+
+#ifdef _DEBUG
+            megamol::core::utility::log::Log::DefaultLog.WriteInfo(
+                "surface %d enclosed by %d:\n\tenclosed-volume: %f, enclosed-voidVol: %f, enclosed-sum: "
+                "%f\n\tenclosing-volume: %f, enclosing-voidVol: %f",
+                gid2, gid, volPerID[enclosedIdx], voidVolPerID[enclosedIdx],
+                volPerID[enclosedIdx] + voidVolPerID[enclosedIdx], volPerID[enclosingIdx], voidVolPerID[enclosingIdx]);
+#endif
+
+            //countPerID[enclosingIdx] += countPerID[enclosedIdx];
+            //surfPerID[enclosingIdx] += surfPerID[enclosedIdx];
+            volPerID[enclosingIdx] += volPerID[enclosedIdx] + voidVolPerID[enclosedIdx];
+            //countPerID[enclosedIdx] = 0;
+            //surfPerID[enclosedIdx] = 0;
+            volPerID[enclosedIdx] = 0;
+        }
+    }
+
+    //SIZE_T numTriangles = 0;
+    for (unsigned int i = 0; i < uniqueIDs.Count(); i++) {
+        //numTriangles += countPerID[i];
+        megamol::core::utility::log::Log::DefaultLog.WriteInfo(
+            "surface %u: %u triangles, surface %f, volume %f, voidVol %f, entire volume %f", uniqueIDs[i],
+            countPerID[i], surfPerID[i], volPerID[i], voidVolPerID[i], volPerID[i] + voidVolPerID[i]);
+        if (file != NULL) {
+            vislib::sys::WriteFormattedLineToFile(*file, "%u\t%u\t%u\t%f\t%f\n", frameNumber,
+                uniqueIDs[i], countPerID[i], surfPerID[i], volPerID[i]);
+        }
+    }
+}
@@ -0,0 +1,151 @@
+/*
+ * VoluMetricStatisticsJob.cpp
+ *
+ * Copyright (C) 2010 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+#include "VoluMetricStatisticsJob.h"
+#include "geometry_calls/MultiParticleDataCall.h"
+#include "mmcore/param/FilePathParam.h"
+#include "mmcore/param/FloatParam.h"
+#include "mmcore/param/IntParam.h"
+#include "mmcore/utility/log/Log.h"
+#include "mmcore/utility/sys/Thread.h"
+#include "stdafx.h"
+
+using namespace megamol::trisoup::volumetrics;
+
+/*
+ * VoluMetricStatisticsJob::VoluMetricStatisticsJob
+ */
+VoluMetricStatisticsJob::VoluMetricStatisticsJob(void)
+        : core::job::AbstractThreadedJob()
+        , core::Module()
+        , getDataSlot("getData", "Slot that connects to a MultiParticleDataCall to fetch the particles in the scene")
+        , metricsFilenameSlot("metricsFilenameSlot", "File that will contain the "
+                                                     "surfaces and volumes of each particle list per frame")
+        , radiusMultiplierSlot("radiusMultiplierSlot", "multiplier for the particle radius")
+        , cellSizeRatioSlot("cellSizeRatioSlot", "Fraction of the minimal particle radius that is used as cell size")
+        , subVolumeResolutionSlot(
+              "subVolumeResolutionSlot", "maximum edge length of a subvolume processed as a separate job") {
+
+    this->getDataSlot.SetCompatibleCall<geocalls::MultiParticleDataCallDescription>();
+    this->MakeSlotAvailable(&this->getDataSlot);
+
+    this->metricsFilenameSlot << new core::param::FilePathParam("");
+    this->MakeSlotAvailable(&this->metricsFilenameSlot);
+
+    this->radiusMultiplierSlot << new core::param::FloatParam(1.0f, 0.0001f, 10000.f);
+    this->MakeSlotAvailable(&this->radiusMultiplierSlot);
+
+    this->cellSizeRatioSlot << new core::param::FloatParam(0.5f, 0.01f, 10.0f);
+    this->MakeSlotAvailable(&this->cellSizeRatioSlot);
+
+    this->subVolumeResolutionSlot << new core::param::IntParam(128, 16, 2048);
+    this->MakeSlotAvailable(&this->subVolumeResolutionSlot);
+}
+
+
+/*
+ * VoluMetricStatisticsJob::~VoluMetricStatisticsJob
+ */
+VoluMetricStatisticsJob::~VoluMetricStatisticsJob(void) {
+    this->Release();
+}
+
+
+/*
+ * VoluMetricStatisticsJob::Terminate
+ */
+bool VoluMetricStatisticsJob::Terminate(void) {
+    this->computation.Cancel();
+    return core::job::AbstractThreadedJob::Terminate();
+}
+
+
+/*
+ * VoluMetricStatisticsJob::create
+ */
+bool VoluMetricStatisticsJob::create(void) {
+
+    // Intentionally empty
+
+    return true;
+}
+
+
+/*
+ * VoluMetricStatisticsJob::release
+ */
+void VoluMetricStatisticsJob::release(void) {
+    this->computation.Clear();
+}
+
+
+/*
+ * VoluMetricStatisticsJob::Run
+ */
+DWORD VoluMetricStatisticsJob::Run(void* userData) {
+    using megamol::core::utility::log::Log;
+
+    geocalls::MultiParticleDataCall* datacall = this->getDataSlot.CallAs<geocalls::MultiParticleDataCall>();
+    if (datacall == NULL) {
+        Log::DefaultLog.WriteError("No data source connected to VoluMetricStatisticsJob");
+        return -1;
+    }
+    if (!(*datacall)(1)) {
+        Log::DefaultLog.WriteError("Data source does not answer to extent request");
+        return -2;
+    }
+
+    unsigned int frameCnt = datacall->FrameCount();
+    Log::DefaultLog.WriteInfo("Data source with %u frame(s)", frameCnt);
+
+    vislib::sys::File statisticsFile;
+    const bool writeFile = !metricsFilenameSlot.Param<core::param::FilePathParam>()->Value().empty();
+    if (writeFile) {
+        if (!statisticsFile.Open(metricsFilenameSlot.Param<core::param::FilePathParam>()->Value().native().c_str(),
+                vislib::sys::File::WRITE_ONLY, vislib::sys::File::SHARE_READ, vislib::sys::File::CREATE_OVERWRITE)) {
+            Log::DefaultLog.WriteError("Could not open statistics file for writing");
+            return -3;
+        }
+    }
+
+    VoluMetricComputation::Settings settings;
+    settings.RadiusMultiplier = this->radiusMultiplierSlot.Param<core::param::FloatParam>()->Value();
+    settings.CellSizeRatio = this->cellSizeRatioSlot.Param<core::param::FloatParam>()->Value();
+    settings.SubVolumeResolution = this->subVolumeResolutionSlot.Param<core::param::IntParam>()->Value();
+
+    VoluMetricComputation::Statistics stats;
+    DWORD result = 0;
+    for (unsigned int frameI = 0; frameI < frameCnt && !this->shouldTerminate(); frameI++) {
+        datacall->SetFrameID(frameI, true);
+        do {
+            if (!(*datacall)(0)) {
+                Log::DefaultLog.WriteError("No data for frame %u", frameI);
+                result = -3;
+                break;
+            }
+        } while (datacall->FrameID() != frameI && (vislib::sys::Thread::Sleep(100), true));
+        if (result != 0) {
+            break;
+        }
+
+        if (!this->computation.Compute(*datacall, settings)) {
+            Log::DefaultLog.WriteWarn("Computation of frame %u did not finish", frameI);
+            datacall->Unlock();
+            continue;
+        }
+        datacall->Unlock();
+
+        this->computation.GenerateStatistics(stats);
+        this->computation.OutputStatistics(frameI, stats, writeFile ? &statisticsFile : NULL);
+        // the surfaces are not needed any more, free them before fetching the next frame
+        this->computation.Clear();
+    }
+
+    if (writeFile) {
+        statisticsFile.Close();
+    }
+    return result;
+}
@@ -0,0 +1,115 @@
+/*
+ * VoluMetricStatisticsJob.h
+ *
+ * Copyright (C) 2010 by VISUS (Universitaet Stuttgart)
+ * Alle Rechte vorbehalten.
+ */
+
+#ifndef MEGAMOLCORE_VOLUMETRICSTATISTICSJOB_H_INCLUDED
+#define MEGAMOLCORE_VOLUMETRICSTATISTICSJOB_H_INCLUDED
+#if (defined(_MSC_VER) && (_MSC_VER > 1000))
+#pragma once
+#endif /* (defined(_MSC_VER) && (_MSC_VER > 1000)) */
+
+#include "mmcore/CallerSlot.h"
+#include "mmcore/Module.h"
+#include "mmcore/job/AbstractThreadedJob.h"
+#include "mmcore/param/ParamSlot.h"
+#include "trisoup/volumetrics/VoluMetricComputation.h"
+#include "vislib/sys/File.h"
+
+namespace megamol {
+namespace trisoup {
+namespace volumetrics {
+
+/**
+ * Headless variant of the VoluMetricJob: computes the surface and volume metrics of all frames of a
+ * multiparticle dataset and writes them to the metrics file, without any debug geometry. Runs
+ * without a graphics context, e.g. over whole trajectories on a compute node.
+ */
+class VoluMetricStatisticsJob : public core::job::AbstractThreadedJob, public core::Module {
+public:
+    /**
+     * Answer the name of this module.
+     *
+     * @return The name of this module.
+     */
+    static const char* ClassName(void) {
+        return "VoluMetricStatisticsJob";
+    }
+
+    /**
+     * Answer a human readable description of this module.
+     *
+     * @return A human readable description of this module.
+     */
+    static const char* Description(void) {
+        return "Computes volumetric metrics of all frames of a multiparticle dataset, i.e. surface and volume"
+               ", assuming a spacefilling spheres geometry, without rendering";
+    }
+
+    /**
+     * Answers whether this module is available on the current system.
+     *
+     * @return 'true' if the module is available, 'false' otherwise.
+     */
+    static bool IsAvailable(void) {
+        return true;
+    }
+
+    /** Ctor. */
+    VoluMetricStatisticsJob(void);
+
+    /** Dtor. */
+    virtual ~VoluMetricStatisticsJob(void);
+
+    /**
+     * Terminates the job thread, subvolumes not yet started are skipped.
+     *
+     * @return true to acknowledge that the job will finish as soon
+     *         as possible.
+     */
+    virtual bool Terminate(void);
+
+protected:
+    /**
+     * Implementation of 'Create'.
+     *
+     * @return 'true' on success, 'false' otherwise.
+     */
+    virtual bool create(void);
+
+    /**
+     * Implementation of 'Release'.
+     */
+    virtual void release(void);
+
+    /**
+     * Perform the work of a thread.
+     *
+     * @param userData Unused.
+     *
+     * @return 0 on success, negative on error.
+     */
+    virtual DWORD Run(void* userData);
+
+private:
+    core::CallerSlot getDataSlot;
+
+    core::param::ParamSlot metricsFilenameSlot;
+
+    core::param::ParamSlot radiusMultiplierSlot;
+
+    core::param::ParamSlot cellSizeRatioSlot;
+
+    core::param::ParamSlot subVolumeResolutionSlot;
+
+    /** the subvolumes and their surfaces */
+    VoluMetricComputation computation;
+};
+
+} /* end namespace volumetrics */
+} /* end namespace trisoup */
+} /* end namespace megamol */
+
+#endif /* MEGAMOLCORE_VOLUMETRICSTATISTICSJOB_H_INCLUDED */
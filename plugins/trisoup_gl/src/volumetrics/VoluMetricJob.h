@@ -20,6 +20,7 @@
 #include "mmcore/param/ParamSlot.h"
 #include "trisoup/trisoupVolumetricDataCall.h"
 #include "trisoup/volumetrics/JobStructures.h"
+#include "trisoup/volumetrics/VoluMetricComputation.h"
 #include "vislib/math/Cuboid.h"
 #include "vislib/sys/File.h"
 
@@ -30,6 +31,8 @@ namespace volumetrics {
  * Megamol job that computes metrics about the volume occupied by a number
  * of (spherical) glyphs. Several threaded jobs are generated for a number of
  * subvolumes to speed up computation and make your machine feel the pain.
+ * The computation itself is trisoup::volumetrics::VoluMetricComputation, this
+ * module adds the debug geometry for rendering.
  */
 class VoluMetricJob : public core::job::AbstractThreadedJob, public core::Module {
 public:
@@ -67,22 +70,13 @@ public:
     /** Dtor. */
     virtual ~VoluMetricJob(void);
 
-    bool areSurfacesJoinable(int sjdIdx1, int surfIdx1, int sjdIdx2, int surfIdx2);
-
-    // thomasbm: full enclosing test for two surfaces specified by global-id
-    bool testFullEnclosing(int enclosingIdx, int enclosedIdx,
-        vislib::Array<vislib::Array<trisoup::volumetrics::Surface*>>& globaIdSurfaces);
-
-    unsigned int MaxGlobalID;
-
-    vislib::sys::CriticalSection AccessMaxGlobalID;
-
-    vislib::sys::CriticalSection RewriteGlobalID;
-
-    // thomasbm: TODO: use hash table here!? STL-version?
-    vislib::Array<trisoup::volumetrics::BoundingBox<unsigned>> globalIdBoxes;
-
-    vislib::Array<trisoup::volumetrics::SubJobData*> SubJobDataList;
+    /**
+     * Terminates the job thread, subvolumes not yet started are skipped.
+     *
+     * @return true to acknowledge that the job will finish as soon
+     *         as possible.
+     */
+    virtual bool Terminate(void);
 
 protected:
     /**
@@ -110,17 +104,6 @@ protected:
     virtual DWORD Run(void* userData);
 
 private:
-    /**
-     * Answer whether two BorderVoxel arrays touch at least in one place.
-     *
-     * @param border1 the first BorderVoxel array
-     * @param border2 the second BorderVoxel array
-     *
-     * @return whether they touch
-     */
-    bool doBordersTouch(
-        trisoup::volumetrics::BorderVoxelArray& border1, trisoup::volumetrics::BorderVoxelArray& border2);
-
     /**
      * Provide some line geometry for rendering. Currently outputs the bounding
      * boxes of the subvolumes that are computed in parallel.
@@ -183,6 +166,12 @@ private:
      */
     void appendBoxIndices(vislib::RawStorage& data, unsigned int& numOffset);
 
+    /**
+     * Publishes the bounding boxes of the whole domain and of the subvolumes as line geometry
+     * and performs a buffer swap. Increases hash to indicate this.
+     */
+    void updateBoundingBoxes(void);
+
     /**
      * Connects the partial geometries of completed jobs and copies the result
      * to the current backbuffer and performs a buffer swap. Increases hash to indicate this.
@@ -196,24 +185,6 @@ private:
      */
     void copyVolumesToBackBuffer(void);
 
-    void generateStatistics(vislib::Array<unsigned int>& uniqueIDs, vislib::Array<SIZE_T>& countPerID,
-        vislib::Array<trisoup::volumetrics::VoxelizerFloat>& surfPerID,
-        vislib::Array<trisoup::volumetrics::VoxelizerFloat>& volPerID,
-        vislib::Array<trisoup::volumetrics::VoxelizerFloat>& voidVolPerID);
-
-    void outputStatistics(unsigned int frameNumber, vislib::Array<unsigned int>& uniqueIDs,
-        vislib::Array<SIZE_T>& countPerID, vislib::Array<trisoup::volumetrics::VoxelizerFloat>& surfPerID,
-        vislib::Array<trisoup::volumetrics::VoxelizerFloat>& volPerID,
-        vislib::Array<trisoup::volumetrics::VoxelizerFloat>& voidVolPerID);
-
-    bool isSurfaceJoinableWithSubvolume(
-        trisoup::volumetrics::SubJobData* surfJob, int surfIdx, trisoup::volumetrics::SubJobData* volume);
-
-    //void joinSurfaces(vislib::Array<vislib::Array<unsigned int> > &globalSurfaceIDs,
-    //    int i, int j, int k, int l);
-
-    void joinSurfaces(int sjdIdx1, int surfIdx1, int sjdIdx2, int surfIdx2);
-
     core::CallerSlot getDataSlot;
 
     core::param::ParamSlot cellSizeRatioSlot;
@@ -240,9 +211,8 @@ private:
 
     core::CalleeSlot outVolDataSlot;
 
-    trisoup::volumetrics::VoxelizerFloat MaxRad;
-
-    trisoup::volumetrics::VoxelizerFloat MinRad;
+    /** the subvolumes and their surfaces */
+    trisoup::volumetrics::VoluMetricComputation computation;
 
     /** the data hash, i.e. the front buffer frame available from the slots */
     SIZE_T hash;
@@ -255,10 +225,6 @@ private:
 
     char meshBackBufferIndex;
 
-    int divX;
-    int divY;
-    int divZ;
-
     vislib::sys::File statisticsFile;
 
     /**
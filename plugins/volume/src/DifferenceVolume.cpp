@@ -10,6 +10,8 @@
 
 #include <limits>
 
+#include "geometry_calls/VolumetricBrickSampler.h"
+
 #include "mmcore/param/BoolParam.h"
 
 #include "mmcore/utility/log/Log.h"
@@ -132,6 +134,41 @@ bool megamol::volume::DifferenceVolume::create(void) {
 }
 
 
+/*
+ * megamol::volume::DifferenceVolume::loadFrame
+ */
+bool megamol::volume::DifferenceVolume::loadFrame(
+    geocalls::VolumetricDataCall& src, std::vector<std::uint8_t>& dst) {
+    using geocalls::VolumetricDataCall;
+    using megamol::core::utility::log::Log;
+
+    /* Prefer bricks, which spares the source holding the whole frame. */
+    geocalls::VolumetricBrickSampler sampler;
+    if (sampler.Open(src)) {
+        const auto* resolution = sampler.GetResolution();
+        const std::size_t first[3] = {0, 0, 0};
+        const std::size_t size[3] = {resolution[0], resolution[1], resolution[2]};
+        dst.resize(size[0] * size[1] * size[2] * sampler.GetIndex().GetVoxelSize());
+        if (sampler.Read(first, size, dst.data())) {
+            return true;
+        }
+        Log::DefaultLog.WriteWarn("%hs could not read the bricks of frame %u, falling back to %hs.",
+            DifferenceVolume::ClassName(), src.FrameID(),
+            VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_GET_DATA));
+    }
+
+    if (!src(VolumetricDataCall::IDX_GET_DATA)) {
+        Log::DefaultLog.WriteError("%hs failed to call %hs.", DifferenceVolume::ClassName(),
+            VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_GET_DATA));
+        return false;
+    }
+
+    dst.resize(src.GetFrameSize());
+    ::memcpy(dst.data(), src.GetData(), src.GetFrameSize());
+    return true;
+}
+
+
 /*
  * megamol::volume::DifferenceVolume::onGetData
  */
@@ -220,16 +257,11 @@ bool megamol::volume::DifferenceVolume::onGetData(core::Call& call) {
             return false;
         }
 
-        if (!(*src)(VolumetricDataCall::IDX_GET_DATA)) {
-            Log::DefaultLog.WriteError("%hs failed to call %hs.", DifferenceVolume::ClassName(),
-                VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_GET_DATA));
-            return false;
-        }
-
         /* Prepare a cache location for the current frame. */
         auto& cur = this->cache[this->frameIdx];
-        cur.resize(src->GetFrameSize());
-        ::memcpy(cur.data(), src->GetData(), src->GetFrameSize());
+        if (!this->loadFrame(*src, cur)) {
+            return false;
+        }
 
         /* Select the potential previous frame. */
         auto& prev = this->cache[increment(this->frameIdx)];
@@ -262,14 +294,9 @@ bool megamol::volume::DifferenceVolume::onGetData(core::Call& call) {
             }
 
             assert(src->IsFrameForced());
-            if (!(*src)(VolumetricDataCall::IDX_GET_DATA)) {
-                Log::DefaultLog.WriteError("%hs failed to call %hs.", DifferenceVolume::ClassName(),
-                    VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_GET_DATA));
+            if (!this->loadFrame(*src, prev)) {
                 return false;
             }
-
-            prev.resize(src->GetFrameSize());
-            ::memcpy(cur.data(), src->GetData(), src->GetFrameSize());
         }
         /* At this point, 'prev' contains the previous frame. */
         assert(cur.size() == this->data.size());
@@ -392,6 +419,9 @@ bool megamol::volume::DifferenceVolume::onGetData(core::Call& call) {
             return false;
         }
 
+        /* The value ranges come with the statistics, which consumers can reuse. */
+        this->metadata.UpdateStatistics(this->data.data(), this->getHash(), dst->FrameID());
+
         this->frameID = src->FrameID();
         this->frameIdx = increment(this->frameIdx);
     } /* end if (this->frameID != src->FrameID()) */
@@ -19,6 +19,7 @@
 #include "mmcore/CalleeSlot.h"
 #include "mmcore/CallerSlot.h"
 #include "mmcore/Module.h"
+#include "mmcore/utility/TaskScheduler.h"
 
 
 namespace megamol {
@@ -116,6 +117,14 @@ protected:
         return retval;
     }
 
+    /**
+     * Copies the current frame of 'src' into 'dst', reading it brick by
+     * brick if the source supports this and via the whole data otherwise.
+     *
+     * @return 'true' on success, 'false' on failure.
+     */
+    bool loadFrame(geocalls::VolumetricDataCall& src, std::vector<std::uint8_t>& dst);
+
     /**
      * Gets the data from the source.
      *
@@ -0,0 +1,211 @@
+/*
+ * VolumetricBrickFile.cpp
+ *
+ * Copyright (C) 2022 by Visualisierungsinstitut der Universität Stuttgart.
+ * Alle rechte vorbehalten.
+ */
+
+#include "VolumetricBrickFile.h"
+#include "stdafx.h"
+
+#include <cstring>
+
+
+namespace {
+
+/** The magic number at the begin of a brick file. */
+const char MAGIC[8] = {'M', 'M', 'V', 'B', 'R', 'I', 'C', 'K'};
+
+/** The version of the file format. */
+const uint32_t VERSION = 100;
+
+/** The header of a brick file as stored on disk. */
+#pragma pack(push, 1)
+struct Header {
+    char Magic[8];
+    uint32_t Version;
+    uint32_t ScalarType;
+    uint32_t ScalarLength;
+    uint32_t Components;
+    uint64_t Resolution[3];
+    uint32_t BrickSize;
+    uint32_t Levels;
+    uint32_t Frames;
+    uint32_t Reserved;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(Header) == 64, "The header of brick files has 64 bytes.");
+
+/** Answer the size of the value ranges of one frame in bytes. */
+uint64_t rangesSize(const megamol::geocalls::VolumetricBrickIndex& index) {
+    return static_cast<uint64_t>(index.GetRanges().size()) * sizeof(double);
+}
+
+} // namespace
+
+
+/*
+ * megamol::volume::VolumetricBrickFile::GetPath
+ */
+std::filesystem::path megamol::volume::VolumetricBrickFile::GetPath(const std::filesystem::path& datFile) {
+    auto retval = datFile;
+    retval.replace_extension(".bricks");
+    return retval;
+}
+
+
+/*
+ * megamol::volume::VolumetricBrickFile::GetRangesOffset
+ */
+uint64_t megamol::volume::VolumetricBrickFile::GetRangesOffset(
+    const geocalls::VolumetricBrickIndex& index, unsigned int frame) {
+    return sizeof(Header) + frame * rangesSize(index);
+}
+
+
+/*
+ * megamol::volume::VolumetricBrickFile::GetDataOffset
+ */
+uint64_t megamol::volume::VolumetricBrickFile::GetDataOffset(
+    const geocalls::VolumetricBrickIndex& index, unsigned int frames, unsigned int frame) {
+    return GetRangesOffset(index, frames) + frame * index.GetFrameSize();
+}
+
+
+/*
+ * megamol::volume::VolumetricBrickFile::WriteHeader
+ */
+bool megamol::volume::VolumetricBrickFile::WriteHeader(
+    std::ostream& stream, const geocalls::VolumetricBrickIndex& index, unsigned int frames) {
+    Header header;
+    ::memcpy(header.Magic, MAGIC, sizeof(MAGIC));
+    header.Version = VERSION;
+    header.ScalarType = static_cast<uint32_t>(index.GetScalarType());
+    header.ScalarLength = static_cast<uint32_t>(index.GetScalarLength());
+    header.Components = static_cast<uint32_t>(index.GetComponents());
+    for (int i = 0; i < 3; ++i) {
+        header.Resolution[i] = index.GetResolution(0)[i];
+    }
+    header.BrickSize = static_cast<uint32_t>(index.GetBrickSize());
+    header.Levels = index.GetLevels();
+    header.Frames = frames;
+    header.Reserved = 0;
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return stream.good();
+}
+
+
+/*
+ * megamol::volume::VolumetricBrickFile::VolumetricBrickFile
+ */
+megamol::volume::VolumetricBrickFile::VolumetricBrickFile(void) : frames(0), isRangesValid(false) {}
+
+
+/*
+ * megamol::volume::VolumetricBrickFile::~VolumetricBrickFile
+ */
+megamol::volume::VolumetricBrickFile::~VolumetricBrickFile(void) {
+    this->Close();
+}
+
+
+/*
+ * megamol::volume::VolumetricBrickFile::Open
+ */
+bool megamol::volume::VolumetricBrickFile::Open(const std::filesystem::path& path) {
+    this->Close();
+
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(path, ec)) {
+        return false;
+    }
+
+    this->file.open(path, std::ios_base::binary);
+    if (!this->file.is_open()) {
+        return false;
+    }
+
+    Header header;
+    this->file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!this->file.good() || (::memcmp(header.Magic, MAGIC, sizeof(MAGIC)) != 0) || (header.Version != VERSION)) {
+        this->Close();
+        return false;
+    }
+
+    const size_t resolution[3] = {static_cast<size_t>(header.Resolution[0]),
+        static_cast<size_t>(header.Resolution[1]), static_cast<size_t>(header.Resolution[2])};
+    if ((header.Levels == 0) || !this->index.Layout(resolution, static_cast<geocalls::ScalarType_t>(header.ScalarType),
+                                    header.ScalarLength, header.Components, header.BrickSize, header.Levels)) {
+        this->Close();
+        return false;
+    }
+    this->frames = header.Frames;
+
+    /* Reject truncated files, which would fail on reading bricks later. */
+    const auto expected = GetDataOffset(this->index, this->frames, this->frames);
+    if (std::filesystem::file_size(path, ec) < expected) {
+        this->Close();
+        return false;
+    }
+
+    return true;
+}
+
+
+/*
+ * megamol::volume::VolumetricBrickFile::Close
+ */
+void megamol::volume::VolumetricBrickFile::Close(void) {
+    if (this->file.is_open()) {
+        this->file.close();
+    }
+    this->file.clear();
+    this->frames = 0;
+    this->index.Clear();
+    this->isRangesValid = false;
+}
+
+
+/*
+ * megamol::volume::VolumetricBrickFile::ReadRanges
+ */
+bool megamol::volume::VolumetricBrickFile::ReadRanges(unsigned int frame) {
+    if (!this->file.is_open() || (frame >= this->frames)) {
+        return false;
+    }
+    if (this->isRangesValid && (this->index.GetFrameID() == frame)) {
+        return true;
+    }
+
+    auto& ranges = this->index.AccessRanges();
+    this->file.seekg(GetRangesOffset(this->index, frame));
+    this->file.read(reinterpret_cast<char*>(ranges.data()), rangesSize(this->index));
+    this->isRangesValid = this->file.good();
+    if (!this->isRangesValid) {
+        this->file.clear();
+        return false;
+    }
+
+    this->index.SetFrameID(frame);
+    return true;
+}
+
+
+/*
+ * megamol::volume::VolumetricBrickFile::ReadBrick
+ */
+bool megamol::volume::VolumetricBrickFile::ReadBrick(unsigned int frame, size_t brick, void* dst) {
+    if (!this->file.is_open() || (frame >= this->frames) || (brick >= this->index.Count())) {
+        return false;
+    }
+
+    this->file.seekg(GetDataOffset(this->index, this->frames, frame) + this->index.GetBrick(brick).Offset);
+    this->file.read(static_cast<char*>(dst), this->index.GetBrickBytes(brick));
+    if (!this->file.good()) {
+        this->file.clear();
+        return false;
+    }
+    return true;
+}
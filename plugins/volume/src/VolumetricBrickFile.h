@@ -0,0 +1,147 @@
+/*
+ * VolumetricBrickFile.h
+ *
+ * Copyright (C) 2022 by Visualisierungsinstitut der Universität Stuttgart.
+ * Alle rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <ostream>
+
+#include "geometry_calls/VolumetricBrickIndex.h"
+
+
+namespace megamol {
+namespace volume {
+
+/**
+ * Reads brick files, ie bricked multiresolution copies of dat/raw data sets
+ * that VolumetricBrickWriter stores next to the dat file. A brick file
+ * comprises
+ *
+ *   char     magic number "MMVBRICK"
+ *   UINT32   version (100)
+ *   UINT32   scalar type (geocalls::ScalarType_t)
+ *   UINT32   length of a scalar in bytes
+ *   UINT32   number of components
+ *   UINT64   resolution of level 0 (3 values)
+ *   UINT32   edge length of a brick
+ *   UINT32   number of levels
+ *   UINT32   number of frames
+ *   UINT32   reserved, 0
+ *   per frame: minimum and maximum of every component of every brick as
+ *              double, in the order of the brick index
+ *   per frame: the voxels of all bricks in the order of the brick index
+ *
+ * so that single bricks can be read without touching the rest of the file.
+ */
+class VolumetricBrickFile {
+
+public:
+    /**
+     * Answer the path of the brick file belonging to a dat file.
+     */
+    static std::filesystem::path GetPath(const std::filesystem::path& datFile);
+
+    /**
+     * Answer the offset of the value ranges of a frame in the file.
+     */
+    static uint64_t GetRangesOffset(const geocalls::VolumetricBrickIndex& index, unsigned int frame);
+
+    /**
+     * Answer the offset of the voxels of a frame in the file.
+     */
+    static uint64_t GetDataOffset(const geocalls::VolumetricBrickIndex& index, unsigned int frames, unsigned int frame);
+
+    /**
+     * Writes the header of a brick file.
+     *
+     * @param stream The stream to write to, positioned at the begin of the
+     *               file.
+     * @param index  The layout of the bricks.
+     * @param frames The number of frames.
+     *
+     * @return 'true' on success, 'false' otherwise.
+     */
+    static bool WriteHeader(std::ostream& stream, const geocalls::VolumetricBrickIndex& index, unsigned int frames);
+
+    /** Initialise a closed instance. */
+    VolumetricBrickFile(void);
+
+    /** Finalise the instance. */
+    ~VolumetricBrickFile(void);
+
+    /**
+     * Opens a brick file and lays out its brick index.
+     *
+     * @param path The brick file.
+     *
+     * @return 'true' on success, 'false' if the file does not exist or is
+     *         no valid brick file.
+     */
+    bool Open(const std::filesystem::path& path);
+
+    /** Closes the file. */
+    void Close(void);
+
+    /**
+     * Answer whether a file is open.
+     */
+    inline bool IsOpen(void) const {
+        return this->file.is_open();
+    }
+
+    /**
+     * Answer the brick index. The value ranges are the ones of the frame
+     * read by the last call to ReadRanges.
+     */
+    inline const geocalls::VolumetricBrickIndex& GetIndex(void) const {
+        return this->index;
+    }
+
+    /**
+     * Answer the number of frames in the file.
+     */
+    inline unsigned int GetFrames(void) const {
+        return this->frames;
+    }
+
+    /**
+     * Reads the value ranges of the bricks of a frame into the brick index.
+     *
+     * @return 'true' on success, 'false' otherwise.
+     */
+    bool ReadRanges(unsigned int frame);
+
+    /**
+     * Reads the voxels of a brick.
+     *
+     * @param frame The frame.
+     * @param brick The number of the brick.
+     * @param dst   Receives the voxels, must hold
+     *              GetIndex().GetBrickBytes(brick) bytes.
+     *
+     * @return 'true' on success, 'false' otherwise.
+     */
+    bool ReadBrick(unsigned int frame, size_t brick, void* dst);
+
+private:
+    /** The open file. */
+    std::ifstream file;
+
+    /** The number of frames in the file. */
+    unsigned int frames;
+
+    /** The layout of the bricks and the value ranges of one frame. */
+    geocalls::VolumetricBrickIndex index;
+
+    /** Whether the value ranges in 'index' are valid. */
+    bool isRangesValid;
+};
+
+} /* end namespace volume */
+} // namespace megamol
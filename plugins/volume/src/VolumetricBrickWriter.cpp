@@ -0,0 +1,347 @@
+/*
+ * VolumetricBrickWriter.cpp
+ *
+ * Copyright (C) 2022 by VISUS (Universitaet Stuttgart).
+ * Alle Rechte vorbehalten.
+ */
+#include "VolumetricBrickWriter.h"
+
+#include "VolumetricBrickFile.h"
+
+#include "mmcore/param/EnumParam.h"
+#include "mmcore/param/FilePathParam.h"
+#include "mmcore/param/IntParam.h"
+#include "mmcore/utility/TaskScheduler.h"
+#include "mmcore/utility/log/Log.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <type_traits>
+
+using namespace megamol;
+using namespace megamol::core;
+using namespace megamol::volume;
+
+namespace {
+
+/**
+ * Calls 'f' with a null pointer of the C++ type of the scalars.
+ *
+ * @return false if the scalar type is not supported, the result of 'f' otherwise.
+ */
+template<class F>
+bool dispatchScalarType(geocalls::ScalarType_t type, size_t length, F&& f) {
+    switch (type) {
+    case geocalls::SIGNED_INTEGER:
+        switch (length) {
+        case 1:
+            return f(static_cast<int8_t*>(nullptr));
+        case 2:
+            return f(static_cast<int16_t*>(nullptr));
+        case 4:
+            return f(static_cast<int32_t*>(nullptr));
+        case 8:
+            return f(static_cast<int64_t*>(nullptr));
+        }
+        break;
+
+    case geocalls::UNSIGNED_INTEGER:
+        switch (length) {
+        case 1:
+            return f(static_cast<uint8_t*>(nullptr));
+        case 2:
+            return f(static_cast<uint16_t*>(nullptr));
+        case 4:
+            return f(static_cast<uint32_t*>(nullptr));
+        case 8:
+            return f(static_cast<uint64_t*>(nullptr));
+        }
+        break;
+
+    case geocalls::FLOATING_POINT:
+        switch (length) {
+        case 4:
+            return f(static_cast<float*>(nullptr));
+        case 8:
+            return f(static_cast<double*>(nullptr));
+        }
+        break;
+
+    default:
+        break;
+    }
+    return false;
+}
+
+/**
+ * Halves the resolution of a volume by averaging 2x2x2 voxels. Voxels beyond the border of an odd resolution
+ * are replaced by the last voxel.
+ */
+template<class T>
+void downsample(const T* src, const size_t srcRes[3], T* dst, const size_t dstRes[3], size_t components) {
+    core::utility::ParallelFor<size_t>(0, dstRes[2], 1, [&](size_t begin, size_t end) {
+        for (size_t z = begin; z < end; ++z) {
+            const size_t zs[2] = {std::min(2 * z, srcRes[2] - 1), std::min(2 * z + 1, srcRes[2] - 1)};
+            for (size_t y = 0; y < dstRes[1]; ++y) {
+                const size_t ys[2] = {std::min(2 * y, srcRes[1] - 1), std::min(2 * y + 1, srcRes[1] - 1)};
+                for (size_t x = 0; x < dstRes[0]; ++x) {
+                    const size_t xs[2] = {std::min(2 * x, srcRes[0] - 1), std::min(2 * x + 1, srcRes[0] - 1)};
+                    for (size_t c = 0; c < components; ++c) {
+                        double sum = 0.0;
+                        for (auto sz : zs) {
+                            for (auto sy : ys) {
+                                const auto* row = src + (sz * srcRes[1] + sy) * srcRes[0] * components;
+                                sum += static_cast<double>(row[xs[0] * components + c]);
+                                sum += static_cast<double>(row[xs[1] * components + c]);
+                            }
+                        }
+                        auto& out = dst[((z * dstRes[1] + y) * dstRes[0] + x) * components + c];
+                        if constexpr (std::is_integral_v<T>) {
+                            out = static_cast<T>(std::llround(sum / 8.0));
+                        } else {
+                            out = static_cast<T>(sum / 8.0);
+                        }
+                    }
+                }
+            }
+        }
+    });
+}
+
+} // namespace
+
+/*
+ * VolumetricBrickWriter::VolumetricBrickWriter
+ */
+VolumetricBrickWriter::VolumetricBrickWriter(void)
+        : AbstractDataWriter()
+        , filenameSlot("filename", "The path of the brick file. VolumetricDataSource uses the brick file next to "
+                                   "the dat file with the ending .bricks")
+        , brickSizeSlot("brickSize", "The edge length of a brick in voxels")
+        , levelsSlot("levels", "The number of levels of detail, 0 adds levels until a single brick remains")
+        , dataSlot("data", "The slot requesting the data to be written") {
+
+    this->filenameSlot.SetParameter(
+        new param::FilePathParam("", megamol::core::param::FilePathParam::Flag_File_ToBeCreated));
+    this->MakeSlotAvailable(&this->filenameSlot);
+
+    auto* ep = new param::EnumParam(32);
+    ep->SetTypePair(16, "16");
+    ep->SetTypePair(32, "32");
+    ep->SetTypePair(64, "64");
+    ep->SetTypePair(128, "128");
+    this->brickSizeSlot.SetParameter(ep);
+    this->MakeSlotAvailable(&this->brickSizeSlot);
+
+    this->levelsSlot.SetParameter(new param::IntParam(0, 0, 32));
+    this->MakeSlotAvailable(&this->levelsSlot);
+
+    this->dataSlot.SetCompatibleCall<geocalls::VolumetricDataCallDescription>();
+    this->MakeSlotAvailable(&this->dataSlot);
+}
+
+/*
+ * VolumetricBrickWriter::~VolumetricBrickWriter
+ */
+VolumetricBrickWriter::~VolumetricBrickWriter(void) {
+    this->Release();
+}
+
+/*
+ * VolumetricBrickWriter::create
+ */
+bool VolumetricBrickWriter::create(void) {
+    return true;
+}
+
+/*
+ * VolumetricBrickWriter::release
+ */
+void VolumetricBrickWriter::release(void) {}
+
+/*
+ * VolumetricBrickWriter::run
+ */
+bool VolumetricBrickWriter::run(void) {
+    using megamol::core::utility::log::Log;
+    auto filepath = this->filenameSlot.Param<param::FilePathParam>()->Value();
+    if (filepath.empty()) {
+        Log::DefaultLog.WriteError("No file path specified. Abort.");
+        return false;
+    }
+
+    geocalls::VolumetricDataCall* vdc = this->dataSlot.CallAs<geocalls::VolumetricDataCall>();
+    if (vdc == nullptr) {
+        Log::DefaultLog.WriteError("No data source connected. Abort.");
+        return false;
+    }
+
+    vdc->SetFrameID(0, true);
+    if (!(*vdc)(geocalls::VolumetricDataCall::IDX_GET_EXTENTS)) {
+        Log::DefaultLog.WriteError("Bounding box retrieval failed. Abort");
+        return false;
+    }
+    const auto frames = static_cast<unsigned int>(vdc->FrameCount());
+    if (!geocalls::VolumetricDataCall::GetMetadata(*vdc)) {
+        Log::DefaultLog.WriteError("Metadata retrieval failed. Abort.");
+        return false;
+    }
+
+    const auto* meta = vdc->GetMetadata();
+    if ((meta->GridType != geocalls::CARTESIAN) && (meta->GridType != geocalls::RECTILINEAR)) {
+        Log::DefaultLog.WriteError("Only cartesian and rectilinear grids can be bricked. Abort.");
+        return false;
+    }
+
+    geocalls::VolumetricBrickIndex index;
+    if (!index.Layout(meta->Resolution, meta->ScalarType, meta->ScalarLength, meta->Components,
+            this->brickSizeSlot.Param<param::EnumParam>()->Value(),
+            this->levelsSlot.Param<param::IntParam>()->Value())) {
+        Log::DefaultLog.WriteError("The volume cannot be bricked. Abort.");
+        return false;
+    }
+    const auto type = meta->ScalarType;
+    const auto length = meta->ScalarLength;
+    const auto components = meta->Components;
+
+    std::ofstream file(filepath, std::ios_base::binary);
+    if (!file.is_open()) {
+        Log::DefaultLog.WriteError("Brick file \"%s\" could not be opened", filepath.generic_u8string().c_str());
+        return false;
+    }
+
+    /* The value ranges are written last, reserve their space. */
+    VolumetricBrickFile::WriteHeader(file, index, frames);
+    std::vector<std::vector<double>> ranges(frames);
+    std::vector<char> zeros(index.GetRanges().size() * sizeof(double), 0);
+    for (unsigned int f = 0; f < frames; ++f) {
+        file.write(zeros.data(), zeros.size());
+    }
+
+    const auto startTime = std::chrono::high_resolution_clock::now();
+    for (unsigned int f = 0; f < frames; ++f) {
+        vdc->SetFrameID(f, true);
+        vdc->SetData(nullptr);
+        if (!geocalls::VolumetricDataCall::GetMetadata(*vdc) ||
+            !(*vdc)(geocalls::VolumetricDataCall::IDX_GET_DATA) || (vdc->GetData() == nullptr)) {
+            Log::DefaultLog.WriteError("Data retrieval of frame %u failed. Abort.", f);
+            return false;
+        }
+        const auto* m = vdc->GetMetadata();
+        if ((m->ScalarType != type) || (m->ScalarLength != length) || (m->Components != components) ||
+            !std::equal(m->Resolution, m->Resolution + 3, meta->Resolution)) {
+            Log::DefaultLog.WriteError("The format of frame %u differs from the first frame. Abort.", f);
+            return false;
+        }
+
+        const bool ok = dispatchScalarType(type, length, [&](auto tag) {
+            using T = std::remove_pointer_t<decltype(tag)>;
+            return this->writeFrame(file, index, static_cast<const T*>(vdc->GetData()), ranges[f]);
+        });
+        if (!ok) {
+            Log::DefaultLog.WriteError("Writing frame %u to \"%s\" failed. Abort.", f,
+                filepath.generic_u8string().c_str());
+            return false;
+        }
+    }
+
+    file.seekp(VolumetricBrickFile::GetRangesOffset(index, 0));
+    for (const auto& r : ranges) {
+        file.write(reinterpret_cast<const char*>(r.data()), r.size() * sizeof(double));
+    }
+    file.close();
+    if (!file) {
+        Log::DefaultLog.WriteError("Writing \"%s\" failed.", filepath.generic_u8string().c_str());
+        return false;
+    }
+
+    const std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - startTime;
+    const auto bytes = static_cast<double>(index.GetFrameSize()) * frames;
+    Log::DefaultLog.WriteInfo("Brick file with %u bricks on %u levels successfully written to \"%s\" (%.1f MB/s).",
+        static_cast<unsigned int>(index.Count()), index.GetLevels(), filepath.generic_u8string().c_str(),
+        bytes / (1024.0 * 1024.0) / std::max(duration.count(), 1e-6));
+    return true;
+}
+
+/*
+ * VolumetricBrickWriter::getCapabilities
+ */
+bool VolumetricBrickWriter::getCapabilities(DataWriterCtrlCall& call) {
+    call.SetAbortable(false);
+    return true;
+}
+
+/*
+ * VolumetricBrickWriter::writeFrame
+ */
+template<class T>
+bool VolumetricBrickWriter::writeFrame(
+    std::ostream& file, const geocalls::VolumetricBrickIndex& index, const T* data, std::vector<double>& ranges) {
+    const auto components = index.GetComponents();
+    ranges.assign(index.GetRanges().size(), 0.0);
+
+    /* Every level is computed from the previous one, only two levels are kept at a time. */
+    std::vector<T> finer, coarser;
+    const T* level = data;
+    std::vector<std::vector<T>> layer;
+
+    for (unsigned int l = 0; l < index.GetLevels(); ++l) {
+        const auto* res = index.GetResolution(l);
+        if (l > 0) {
+            const auto* prevRes = index.GetResolution(l - 1);
+            coarser.resize(res[0] * res[1] * res[2] * components);
+            downsample(level, prevRes, coarser.data(), res, components);
+            finer.swap(coarser);
+            level = finer.data();
+        }
+
+        /* Gather the bricks of a layer in parallel, then write them in the order of the index. */
+        const auto* cnt = index.GetBrickCount(l);
+        layer.resize(cnt[0] * cnt[1]);
+        for (size_t bz = 0; bz < cnt[2]; ++bz) {
+            const auto first = index.GetBrick(l, 0, 0, bz);
+            core::utility::ParallelFor<size_t>(0, layer.size(), 1, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const auto& brick = index.GetBrick(first + i);
+                    auto& voxels = layer[i];
+                    voxels.resize(index.GetBrickBytes(first + i) / sizeof(T));
+                    auto* out = voxels.data();
+                    const auto rowLength = brick.Size[0] * components;
+                    for (size_t z = 0; z < brick.Size[2]; ++z) {
+                        for (size_t y = 0; y < brick.Size[1]; ++y) {
+                            const auto* row =
+                                level + (((brick.Origin[2] + z) * res[1] + brick.Origin[1] + y) * res[0] +
+                                            brick.Origin[0]) *
+                                            components;
+                            out = std::copy(row, row + rowLength, out);
+                        }
+                    }
+
+                    auto* r = ranges.data() + 2 * (first + i) * components;
+                    for (size_t c = 0; c < components; ++c) {
+                        double lo = std::numeric_limits<double>::max();
+                        double hi = std::numeric_limits<double>::lowest();
+                        for (size_t v = c; v < voxels.size(); v += components) {
+                            lo = std::min(lo, static_cast<double>(voxels[v]));
+                            hi = std::max(hi, static_cast<double>(voxels[v]));
+                        }
+                        r[2 * c] = lo;
+                        r[2 * c + 1] = hi;
+                    }
+                }
+            });
+
+            for (const auto& voxels : layer) {
+                file.write(reinterpret_cast<const char*>(voxels.data()), voxels.size() * sizeof(T));
+            }
+            if (!file) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
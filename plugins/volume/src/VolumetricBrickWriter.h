@@ -0,0 +1,129 @@
+/*
+ * VolumetricBrickWriter.h
+ *
+ * Copyright (C) 2022 by VISUS (Universitaet Stuttgart).
+ * Alle Rechte vorbehalten.
+ */
+
+#pragma once
+
+#include <ostream>
+#include <vector>
+
+#include "geometry_calls/VolumetricBrickIndex.h"
+#include "geometry_calls/VolumetricDataCall.h"
+#include "mmcore/AbstractDataWriter.h"
+#include "mmcore/CallerSlot.h"
+#include "mmcore/DataWriterCtrlCall.h"
+#include "mmcore/param/ParamSlot.h"
+
+namespace megamol {
+namespace volume {
+
+/*
+ * Converts volume data to a brick file, which VolumetricDataSource uses to
+ * load parts of a data set at a chosen level of detail.
+ */
+class VolumetricBrickWriter : public megamol::core::AbstractDataWriter {
+public:
+    /**
+     * Answer the name of this module.
+     *
+     * @return The name of this module.
+     */
+    static const char* ClassName(void) {
+        return "VolumetricBrickWriter";
+    }
+
+    /**
+     * Answer a human readable description of this module.
+     *
+     * @return A human readable description of this module.
+     */
+    static const char* Description(void) {
+        return "Writes volume data as bricked multiresolution file for out-of-core access";
+    }
+
+    /**
+     * Answers whether this module is available on the current system.
+     *
+     * @return 'true' if the module is available, 'false' otherwise.
+     */
+    static bool IsAvailable(void) {
+        return true;
+    }
+
+    /**
+     * Disallow usage in quickstarts
+     *
+     * @return false
+     */
+    static bool SupportQuickstart(void) {
+        return false;
+    }
+
+    /** Ctor. */
+    VolumetricBrickWriter(void);
+
+    /** Dtor. */
+    virtual ~VolumetricBrickWriter(void);
+
+protected:
+    /**
+     * Implementation of 'Create'.
+     *
+     * @return 'true' on success, 'false' otherwise.
+     */
+    virtual bool create(void);
+
+    /**
+     * Implementation of 'Release'.
+     */
+    virtual void release(void);
+
+    /**
+     * The main function
+     *
+     * @return True on success
+     */
+    virtual bool run(void);
+
+    /**
+     * Function querying the writers capabilities
+     *
+     * @param call The call to receive the capabilities
+     *
+     * @return True on success
+     */
+    virtual bool getCapabilities(core::DataWriterCtrlCall& call);
+
+private:
+    /**
+     * Writes the bricks of all levels of one frame.
+     *
+     * @param file   The file positioned at the data of the frame.
+     * @param index  The layout of the bricks.
+     * @param data   The voxels of the frame at full resolution.
+     * @param ranges Receives the value ranges of the bricks.
+     *
+     * @return True on success
+     */
+    template<class T>
+    bool writeFrame(std::ostream& file, const geocalls::VolumetricBrickIndex& index, const T* data,
+        std::vector<double>& ranges);
+
+    /** The file name of the file to be written */
+    core::param::ParamSlot filenameSlot;
+
+    /** The edge length of the bricks */
+    core::param::ParamSlot brickSizeSlot;
+
+    /** The number of levels of detail */
+    core::param::ParamSlot levelsSlot;
+
+    /** The slot asking for data */
+    core::CallerSlot dataSlot;
+};
+
+} // namespace volume
+} // namespace megamol
@@ -8,6 +8,9 @@
 #include "VolumetricDataSource.h"
 #include "stdafx.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "mmcore/param/BoolParam.h"
 #include "mmcore/param/EnumParam.h"
 #include "mmcore/param/FilePathParam.h"
@@ -36,11 +39,13 @@
  */
 megamol::volume::VolumetricDataSource::VolumetricDataSource(void)
         : Base()
+        , brickCacheBytes(0)
         , dataHash(-234895)
         , fileInfo(nullptr)
         , loaderThread(VolumetricDataSource::loadAsync)
         , paramAsyncSleep("AsyncSleep", "The time in milliseconds that the loader sleeps between two frames.")
         , paramAsyncWake("AsyncWake", "The time in milliseconds after that the loader wakes itself.")
+        , paramBrickCacheSize("BrickCacheSize", "The memory in MB for bricks loaded from the brick file.")
         , paramBuffers("Buffers", "The number of buffers for loading frames asynchronously.")
         , paramFileName("FileName", "The path to the dat file to be loaded.")
         , paramOutputDataSize("OutputDataSize", "Forces the scalar type to the specified size.")
@@ -58,6 +63,9 @@ megamol::volume::VolumetricDataSource::VolumetricDataSource(void)
     this->paramAsyncWake.SetParameter(new core::param::IntParam(0, 0));
     this->MakeSlotAvailable(&this->paramAsyncWake);
 
+    this->paramBrickCacheSize.SetParameter(new core::param::IntParam(1024, 1));
+    this->MakeSlotAvailable(&this->paramBrickCacheSize);
+
     this->paramBuffers.SetParameter(new core::param::IntParam(2, 2));
     this->MakeSlotAvailable(&this->paramBuffers);
 
@@ -99,6 +107,11 @@ megamol::volume::VolumetricDataSource::VolumetricDataSource(void)
         VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_STOP_ASYNC), &VolumetricDataSource::onStopAsync);
     this->slotGetData.SetCallback(VolumetricDataCall::ClassName(),
         VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_TRY_GET_DATA), &VolumetricDataSource::onTryGetData);
+    this->slotGetData.SetCallback(VolumetricDataCall::ClassName(),
+        VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_GET_BRICK_INDEX),
+        &VolumetricDataSource::onGetBrickIndex);
+    this->slotGetData.SetCallback(VolumetricDataCall::ClassName(),
+        VolumetricDataCall::FunctionName(VolumetricDataCall::IDX_GET_BRICKS), &VolumetricDataSource::onGetBricks);
     this->MakeSlotAvailable(&this->slotGetData);
 }
 
@@ -231,6 +244,11 @@ bool megamol::volume::VolumetricDataSource::onFileNameChanged(core::param::Param
                                   _T("in preparation for changing the data set."));
     }
 
+    this->brickFile.Close();
+    this->brickCache.clear();
+    this->brickCacheEntries.clear();
+    this->brickCacheBytes = 0;
+
     /* Read the header. */
     vislib::StringA fileName(
         this->paramFileName.Param<core::param::FilePathParam>()->Value().generic_u8string().c_str());
@@ -393,6 +411,25 @@ bool megamol::volume::VolumetricDataSource::onFileNameChanged(core::param::Param
             }
         }
 
+        /* Use a brick file next to the dat file for bricked access. */
+        auto brickPath = VolumetricBrickFile::GetPath(this->paramFileName.Param<core::param::FilePathParam>()->Value());
+        if (this->brickFile.Open(brickPath)) {
+            const auto& index = this->brickFile.GetIndex();
+            if ((this->brickFile.GetFrames() != this->metadata.NumberOfFrames) ||
+                (index.GetComponents() != this->metadata.Components) ||
+                !std::equal(this->metadata.Resolution, this->metadata.Resolution + 3, index.GetResolution(0))) {
+                Log::DefaultLog.WriteWarn(_T("Ignoring brick file %hs, ")
+                                          _T("which does not match the dat file."),
+                    brickPath.generic_u8string().c_str());
+                this->brickFile.Close();
+            } else {
+                Log::DefaultLog.WriteInfo(_T("Using brick file %hs with %u ")
+                                          _T("bricks on %u levels."),
+                    brickPath.generic_u8string().c_str(), static_cast<unsigned int>(index.Count()),
+                    index.GetLevels());
+            }
+        }
+
     } else {
         Log::DefaultLog.WriteError(1,
             _T("Failed to read and parse dat file ")
@@ -684,34 +721,57 @@ bool megamol::volume::VolumetricDataSource::onGetData(core::Call& call) {
 
         if (retval) {
             const VolumetricDataCall& vdc = dynamic_cast<VolumetricDataCall&>(call);
+
+            /*
+             * The statistics are cached for the data hash and frame, so the
+             * frame is only scanned once even if it is requested repeatedly.
+             * The scalar format is the one we deliver, not the one in the file.
+             */
+            auto outputFormat = this->metadata;
             switch (this->getOutputDataFormat()) {
             case DR_FORMAT_UCHAR:
-                this->calcMinMax<uint8_t>(vdc.GetData(), this->mins, this->maxes, *fileInfo, metadata);
+                outputFormat.ScalarType = VolumetricDataCall::ScalarType::UNSIGNED_INTEGER;
+                outputFormat.ScalarLength = sizeof(uint8_t);
                 break;
             case DR_FORMAT_FLOAT:
-                this->calcMinMax<float>(vdc.GetData(), this->mins, this->maxes, *fileInfo, metadata);
+                outputFormat.ScalarType = VolumetricDataCall::ScalarType::FLOATING_POINT;
+                outputFormat.ScalarLength = sizeof(float);
                 break;
             case DR_FORMAT_DOUBLE:
-                this->calcMinMax<double>(vdc.GetData(), this->mins, this->maxes, *fileInfo, metadata);
+                outputFormat.ScalarType = VolumetricDataCall::ScalarType::FLOATING_POINT;
+                outputFormat.ScalarLength = sizeof(double);
                 break;
             case DR_FORMAT_USHORT:
-                this->calcMinMax<uint16_t>(vdc.GetData(), this->mins, this->maxes, *fileInfo, metadata);
+                outputFormat.ScalarType = VolumetricDataCall::ScalarType::UNSIGNED_INTEGER;
+                outputFormat.ScalarLength = sizeof(uint16_t);
                 break;
             case DR_FORMAT_SHORT:
-                this->calcMinMax<int16_t>(vdc.GetData(), this->mins, this->maxes, *fileInfo, metadata);
+                outputFormat.ScalarType = VolumetricDataCall::ScalarType::SIGNED_INTEGER;
+                outputFormat.ScalarLength = sizeof(int16_t);
                 break;
-            case DR_FORMAT_RAW:
+            default:
+                outputFormat.ScalarType = VolumetricDataCall::ScalarType::UNKNOWN;
+                break;
+            }
+
+            this->statistics.Update(vdc.GetData(), outputFormat, this->dataHash, c.FrameID());
+            if (this->statistics.GetComponents() == this->metadata.Components) {
+                this->mins.resize(this->metadata.Components);
+                this->maxes.resize(this->metadata.Components);
+                for (size_t i = 0; i < this->metadata.Components; ++i) {
+                    this->mins[i] = this->statistics.GetMinValue(i);
+                    this->maxes[i] = this->statistics.GetMaxValue(i);
+                }
+            } else if (this->getOutputDataFormat() == DR_FORMAT_RAW) {
                 megamol::core::utility::log::Log::DefaultLog.WriteWarn(
                     "Cannot determine min/max of BITS volume. Setting to [0,1].");
                 this->mins.resize(this->metadata.Components, 0.0);
                 this->maxes.resize(this->metadata.Components, 1.0);
-                break;
-            default:
+            } else {
                 megamol::core::utility::log::Log::DefaultLog.WriteWarn(
                     "Cannot determine min/max of unknown volume. Setting to [0,1].");
                 this->mins.resize(this->metadata.Components, 0.0);
                 this->maxes.resize(this->metadata.Components, 1.0);
-                break;
             }
             this->metadata.MinValues = this->mins.data();
             this->metadata.MaxValues = this->maxes.data();
@@ -724,6 +784,144 @@ bool megamol::volume::VolumetricDataSource::onGetData(core::Call& call) {
 }
 
 
+/*
+ * megamol::volume::VolumetricDataSource::onGetBrickIndex
+ */
+bool megamol::volume::VolumetricDataSource::onGetBrickIndex(core::Call& call) {
+    using geocalls::VolumetricDataCall;
+    using megamol::core::utility::log::Log;
+
+    try {
+        VolumetricDataCall& c = dynamic_cast<VolumetricDataCall&>(call);
+        c.SetBrickIndex(nullptr);
+
+        /* Data sets without brick file are only available as a whole. */
+        if ((this->fileInfo == nullptr) || !this->brickFile.IsOpen()) {
+            return false;
+        }
+
+        if (!this->brickFile.ReadRanges(c.FrameID())) {
+            Log::DefaultLog.WriteError(_T("Reading the brick index of ")
+                                       _T("frame %u failed."),
+                c.FrameID());
+            return false;
+        }
+
+        /* The value range of the frame is the one of the full-resolution bricks. */
+        const auto& index = this->brickFile.GetIndex();
+        const auto* cnt = index.GetBrickCount(0);
+        this->mins.assign(this->metadata.Components, std::numeric_limits<double>::max());
+        this->maxes.assign(this->metadata.Components, std::numeric_limits<double>::lowest());
+        for (size_t b = 0; b < cnt[0] * cnt[1] * cnt[2]; ++b) {
+            for (size_t i = 0; i < this->metadata.Components; ++i) {
+                this->mins[i] = (std::min)(this->mins[i], index.GetMinValue(b, i));
+                this->maxes[i] = (std::max)(this->maxes[i], index.GetMaxValue(b, i));
+            }
+        }
+        this->metadata.MinValues = this->mins.data();
+        this->metadata.MaxValues = this->maxes.data();
+
+        c.SetDataHash(this->dataHash);
+        c.SetMetadata(&this->metadata);
+        c.SetBrickIndex(&index);
+        return true;
+
+    } catch (vislib::Exception e) {
+        Log::DefaultLog.WriteError(1, e.GetMsg());
+        return false;
+    } catch (...) {
+        Log::DefaultLog.WriteError(1, _T("Unexpected exception in callback ")
+                                      _T("onGetBrickIndex (please check the call)."));
+        return false;
+    }
+}
+
+
+/*
+ * megamol::volume::VolumetricDataSource::onGetBricks
+ */
+bool megamol::volume::VolumetricDataSource::onGetBricks(core::Call& call) {
+    using geocalls::VolumetricDataCall;
+    using megamol::core::utility::log::Log;
+
+    try {
+        VolumetricDataCall& c = dynamic_cast<VolumetricDataCall&>(call);
+        c.SetBricks({});
+
+        if ((this->fileInfo == nullptr) || !this->brickFile.IsOpen()) {
+            return false;
+        }
+
+        const auto& index = this->brickFile.GetIndex();
+        const auto& request = c.GetBrickRequest();
+        const auto frameID = c.FrameID();
+        if (frameID >= this->brickFile.GetFrames()) {
+            Log::DefaultLog.WriteError(_T("Bricks of frame %u requested, ")
+                                       _T("but the data set has only %u frames."),
+                frameID, this->brickFile.GetFrames());
+            return false;
+        }
+
+        std::vector<VolumetricDataCall::BrickData> bricks(request.size());
+        std::vector<size_t> missing;
+        for (size_t i = 0; i < request.size(); ++i) {
+            if (request[i] >= index.Count()) {
+                Log::DefaultLog.WriteError(_T("Brick %u requested, but ")
+                                           _T("the data set has only %u bricks."),
+                    static_cast<unsigned int>(request[i]), static_cast<unsigned int>(index.Count()));
+                return false;
+            }
+            const uint64_t key = static_cast<uint64_t>(frameID) * index.Count() + request[i];
+            auto it = this->brickCacheEntries.find(key);
+            if (it != this->brickCacheEntries.end()) {
+                this->brickCache.splice(this->brickCache.begin(), this->brickCache, it->second);
+                bricks[i] = it->second->second;
+            } else {
+                missing.push_back(i);
+            }
+        }
+
+        /* Bricks are stored in the order of their numbers, read missing ones in this order to avoid seeking back. */
+        std::sort(missing.begin(), missing.end(), [&request](size_t l, size_t r) { return request[l] < request[r]; });
+        for (size_t m = 0; m < missing.size(); ++m) {
+            const auto brick = request[missing[m]];
+            auto data = std::make_shared<std::vector<uint8_t>>(index.GetBrickBytes(brick));
+            if (!this->brickFile.ReadBrick(frameID, brick, data->data())) {
+                Log::DefaultLog.WriteError(_T("Reading brick %u of frame %u ")
+                                           _T("failed."),
+                    static_cast<unsigned int>(brick), frameID);
+                return false;
+            }
+            const uint64_t key = static_cast<uint64_t>(frameID) * index.Count() + brick;
+            this->brickCache.emplace_front(key, data);
+            this->brickCacheEntries[key] = this->brickCache.begin();
+            this->brickCacheBytes += data->size();
+
+            /* Bricks requested more than once are read once. */
+            bricks[missing[m]] = data;
+            while ((m + 1 < missing.size()) && (request[missing[m + 1]] == brick)) {
+                bricks[missing[++m]] = data;
+            }
+        }
+
+        /* The caller shares the bricks, so evicting them does not invalidate the result. */
+        this->trimBrickCache();
+
+        c.SetDataHash(this->dataHash);
+        c.SetBricks(std::move(bricks));
+        return true;
+
+    } catch (vislib::Exception e) {
+        Log::DefaultLog.WriteError(1, e.GetMsg());
+        return false;
+    } catch (...) {
+        Log::DefaultLog.WriteError(1, _T("Unexpected exception in callback ")
+                                      _T("onGetBricks (please check the call)."));
+        return false;
+    }
+}
+
+
 /*
  * megamol::volume::VolumetricDataSource::onGetExtents
  */
@@ -1018,6 +1216,11 @@ void megamol::volume::VolumetricDataSource::release(void) {
                                       _T("stopping volume loader thread during release of data source."));
     }
 
+    this->brickFile.Close();
+    this->brickCache.clear();
+    this->brickCacheEntries.clear();
+    this->brickCacheBytes = 0;
+
     if (this->fileInfo != nullptr) {
         Log::DefaultLog.WriteInfo(10, _T("Releasing dat file..."));
         ::datRaw_close(this->fileInfo);
@@ -1162,6 +1365,8 @@ DWORD megamol::volume::VolumetricDataSource::loadAsync(void* userData) {
 #endif /* (defined(DEBUG) || defined(_DEBUG)) */
                     if (::datRaw_loadStep(that->fileInfo, static_cast<int>(that->buffers[i]->FrameID), &dst, format)) {
                         that->buffers[i]->status.store(BUFFER_STATUS_READY);
+                        // consumers polling via TryGetData need to run again to pick up the frame
+                        that->NotifyOutputChanged();
                     } else {
                         Log::DefaultLog.WriteError(_T("Loading frame %u ")
                                                    _T("failed."),
@@ -1310,6 +1515,21 @@ size_t megamol::volume::VolumetricDataSource::assertBuffersUnsafe(size_t cntFram
 }
 
 
+/*
+ * megamol::volume::VolumetricDataSource::trimBrickCache
+ */
+void megamol::volume::VolumetricDataSource::trimBrickCache(void) {
+    const auto budget =
+        static_cast<size_t>(this->paramBrickCacheSize.Param<core::param::IntParam>()->Value()) * 1024 * 1024;
+    while ((this->brickCacheBytes > budget) && !this->brickCache.empty()) {
+        const auto& lru = this->brickCache.back();
+        this->brickCacheBytes -= lru.second->size();
+        this->brickCacheEntries.erase(lru.first);
+        this->brickCache.pop_back();
+    }
+}
+
+
 /*
  * megamol::volume::VolumetricDataSource::bufferForFrameIDUnsafe
  */
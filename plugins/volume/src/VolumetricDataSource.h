@@ -8,12 +8,17 @@
 #pragma once
 
 #include <atomic>
+#include <list>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "datRaw.h"
 
 #include "geometry_calls/VolumetricDataCall.h"
+#include "geometry_calls/VolumetricStatistics.h"
+
+#include "VolumetricBrickFile.h"
 
 #include "mmcore/param/ParamSlot.h"
 
@@ -115,6 +120,24 @@ protected:
      */
     bool onGetData(core::Call& call);
 
+    /**
+     * Gets the brick index of a bricked data set.
+     *
+     * @param caller The calling call.
+     *
+     * @return 'true' on success, 'false' if the data set is not bricked.
+     */
+    bool onGetBrickIndex(core::Call& call);
+
+    /**
+     * Gets bricks of a bricked data set.
+     *
+     * @param caller The calling call.
+     *
+     * @return 'true' on success, 'false' on failure.
+     */
+    bool onGetBricks(core::Call& call);
+
     /**
      * Gets the data extents.
      *
@@ -335,6 +358,24 @@ private:
      */
     int bufferForFrameIDUnsafe(const unsigned int frameID) const;
 
+    /**
+     * Evicts the least recently used bricks until the cache fits into
+     * 'paramBrickCacheSize'.
+     */
+    void trimBrickCache(void);
+
+    /** The bricks loaded from 'brickFile', most recently used first. */
+    std::list<std::pair<uint64_t, geocalls::VolumetricDataCall::BrickData>> brickCache;
+
+    /** The total size of the bricks in 'brickCache' in bytes. */
+    size_t brickCacheBytes;
+
+    /** Maps the keys of the cached bricks (frame and brick) to the cache entries. */
+    std::unordered_map<uint64_t, decltype(brickCache)::iterator> brickCacheEntries;
+
+    /** The brick file next to the dat file, if there is one. */
+    VolumetricBrickFile brickFile;
+
     /** The buffers that volume data can be loaded to. */
     vislib::PtrArray<BufferSlot> buffers;
 
@@ -372,6 +413,9 @@ private:
      */
     core::param::ParamSlot paramAsyncWake;
 
+    /** The memory in megabytes that bricks of a bricked data set may use. */
+    core::param::ParamSlot paramBrickCacheSize;
+
     /**
      * The number of buffers that should be allocated for (pre-) loading
      * frames.
@@ -401,29 +445,8 @@ private:
 
     std::vector<double> mins, maxes;
 
-    template<class T>
-    void calcMinMax(void const* vol_ptr, std::vector<double>& mins, std::vector<double>& maxes,
-        DatRawFileInfo const& fileinfo, geocalls::VolumetricDataCall::Metadata const& metadata) {
-        mins.resize(metadata.Components);
-        maxes.resize(metadata.Components);
-        for (auto c = 0; c < metadata.Components; ++c) {
-            double min = std::numeric_limits<double>::max();
-            double max = std::numeric_limits<double>::lowest();
-            size_t totalLength = 1;
-            for (int i = 0; i < fileinfo.dimensions; ++i) {
-                totalLength *= fileinfo.resolution[i];
-            }
-            auto* vol = reinterpret_cast<const T*>(vol_ptr);
-            for (size_t x = c; x < totalLength; x += metadata.Components) {
-                if (vol[x] < min)
-                    min = vol[x];
-                if (vol[x] > max)
-                    max = vol[x];
-            }
-            mins[c] = min;
-            maxes[c] = max;
-        }
-    }
+    /** The statistics of the frame delivered last. */
+    geocalls::VolumetricStatistics statistics;
 };
 
 } /* end namespace volume */
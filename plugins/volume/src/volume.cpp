@@ -10,6 +10,7 @@
 #include "BuckyBall.h"
 #include "DatRawWriter.h"
 #include "DifferenceVolume.h"
+#include "VolumetricBrickWriter.h"
 #include "VolumetricDataSource.h"
 
 namespace megamol::volume {
@@ -30,6 +31,7 @@ public:
         this->module_descriptions.RegisterAutoDescription<megamol::volume::BuckyBall>();
         this->module_descriptions.RegisterAutoDescription<megamol::volume::DatRawWriter>();
         this->module_descriptions.RegisterAutoDescription<megamol::volume::DifferenceVolume>();
+        this->module_descriptions.RegisterAutoDescription<megamol::volume::VolumetricBrickWriter>();
         this->module_descriptions.RegisterAutoDescription<megamol::volume::VolumetricDataSource>();
 
         // register calls
@@ -0,0 +1,200 @@
+// Reference consumer for the shared memory image sink of the MegaMol frontend (megamol --shm-sink NAME).
+// Prints information about received frames to stderr. With --raw the pixels of the selected image are written
+// to stdout once a consistent copy has been taken, e.g. for piping into a video encoder:
+//   ./shmimageconsumer megamol --raw | ffmpeg -f rawvideo -pixel_format rgba -video_size 1280x720 -i - out.mp4
+// The video size has to match the framebuffer size of MegaMol.
+
+#include "SharedMemoryImageRing.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ring = megamol::frontend_resources::shared_memory_image_ring;
+
+struct Segment {
+    int fd = -1;
+    void* mapping = MAP_FAILED;
+    std::size_t size = 0;
+
+    ring::RingHeader const* header() const {
+        return static_cast<ring::RingHeader const*>(mapping);
+    }
+
+    bool open(std::string const& name) {
+        fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(ring::RingHeader)) {
+            close();
+            return false;
+        }
+        size = static_cast<std::size_t>(info.st_size);
+        mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close();
+            return false;
+        }
+
+        if (header()->magic != ring::Magic || header()->version != ring::Version ||
+            header()->segment_size > size) {
+            std::cerr << "Shared memory segment " << name << " has an unknown layout" << std::endl;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (mapping != MAP_FAILED)
+            munmap(mapping, size);
+        if (fd >= 0)
+            ::close(fd);
+        mapping = MAP_FAILED;
+        fd = -1;
+        size = 0;
+    }
+
+    bool active() const {
+        return mapping != MAP_FAILED &&
+               header()->state.load(std::memory_order_acquire) == static_cast<uint32_t>(ring::RingState::Active);
+    }
+};
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "shmimageconsumer" << std::endl
+                  << "Usage: ./shmimageconsumer <segment name> [--raw] [--image <index>] [--frames <count>]"
+                  << std::endl;
+        return 1;
+    }
+
+    std::string name = argv[1];
+    if (name[0] != '/')
+        name = "/" + name;
+    bool raw = false;
+    uint32_t image_index = 0;
+    long max_frames = -1;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--raw") {
+            raw = true;
+        } else if (arg == "--image" && i + 1 < argc) {
+            image_index = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--frames" && i + 1 < argc) {
+            max_frames = std::stol(argv[++i]);
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    sem_t* semaphore = SEM_FAILED;
+    Segment segment;
+    uint64_t consumed = 0;
+    long frames = 0, dropped = 0;
+    // copy of the pixels of the current image, validated before it is written
+    std::vector<unsigned char> pixels;
+    // the producer overwriting the slot during every attempt means we cannot keep up, skip the frame then
+    constexpr int max_attempts = 3;
+
+    while (max_frames < 0 || frames < max_frames) {
+        // (re)connect, the producer may not run yet or may have replaced the segment
+        if (!segment.active()) {
+            segment.close();
+            if (semaphore != SEM_FAILED)
+                sem_close(semaphore);
+            semaphore = sem_open(ring::semaphore_name(name).c_str(), 0);
+            if (semaphore == SEM_FAILED || !segment.open(name) || !segment.active()) {
+                segment.close();
+                usleep(100 * 1000);
+                continue;
+            }
+            consumed = segment.header()->published.load(std::memory_order_acquire);
+            std::cerr << "Connected to " << name << ": " << segment.header()->slot_count << " slots of "
+                      << segment.header()->slot_capacity << " bytes" << std::endl;
+        }
+
+        timespec timeout;
+        clock_gettime(CLOCK_REALTIME, &timeout);
+        timeout.tv_sec += 1;
+        if (sem_timedwait(semaphore, &timeout) != 0)
+            continue;
+        // we are only interested in the newest images, drain notifications of frames we skip anyway
+        while (sem_trywait(semaphore) == 0) {}
+
+        auto const* header = segment.header();
+        const auto published = header->published.load(std::memory_order_acquire);
+        if (published == consumed)
+            continue;
+        if (published - consumed > header->slot_count)
+            dropped += static_cast<long>(published - consumed - header->slot_count);
+        consumed = published;
+
+        // search the newest complete image with the requested index. the pixels are copied before the sequence is
+        // validated, a torn copy is never emitted but retried with the then newest image.
+        bool torn = true;
+        for (int attempt = 0; attempt < max_attempts && torn; ++attempt) {
+            torn = false;
+            const auto newest = header->published.load(std::memory_order_acquire);
+            for (uint64_t back = 1; back <= header->slot_count && back <= newest; ++back) {
+                auto const& slot = header->slots[(newest - back) % header->slot_count];
+                const auto before = slot.sequence.load(std::memory_order_acquire);
+                if ((before & 1) != 0 || slot.image_index != image_index)
+                    continue;
+
+                const auto frame_id = slot.frame_id;
+                const auto width = slot.width, height = slot.height;
+                const auto format = static_cast<ring::PixelFormat>(slot.format);
+                const auto data_size = std::min(slot.data_size, header->slot_capacity);
+                const auto timestamp = slot.timestamp_ns;
+                const auto* data = reinterpret_cast<unsigned char const*>(header) + slot.data_offset;
+                if (raw)
+                    pixels.assign(data, data + data_size);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) != before) {
+                    // producer overwrote the slot while we were reading it
+                    torn = true;
+                    break;
+                }
+
+                const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                                     .count();
+                if (raw && !pixels.empty()) {
+                    std::fwrite(pixels.data(), 1, pixels.size(), stdout);
+                    std::fflush(stdout);
+                }
+
+                std::cerr << "frame " << frame_id << ": " << width << "x" << height << " "
+                          << (format == ring::PixelFormat::RGB8 ? "RGB8" : "RGBA8") << ", " << data_size << " bytes, "
+                          << (now - timestamp) / 1000 << " us latency, " << dropped << " dropped" << std::endl;
+                frames++;
+                break;
+            }
+        }
+        if (torn)
+            dropped++;
+    }
+
+    segment.close();
+    if (semaphore != SEM_FAILED)
+        sem_close(semaphore);
+
+    return 0;
+}